@@ -51,8 +51,11 @@ PRECOMPILED_HEADER += PreCompiledHeaders.h
 HEADERS += minimp3/minimp3.h
 HEADERS += midi/MidiDriver.h
 HEADERS += midi/MidiMessage.h
+HEADERS += midi/MidiInputQueue.h
 HEADERS += looper/Looper.h
 HEADERS += looper/LooperLayer.h
+HEADERS += looper/PeaksPyramid.h
+HEADERS += looper/LooperMixer.h
 HEADERS += looper/LooperStates.h
 HEADERS += looper/LooperPersistence.h
 HEADERS += audio/core/AudioDriver.h
@@ -62,6 +65,12 @@ HEADERS += audio/core/LocalInputGroup.h
 HEADERS += audio/core/AudioNodeProcessor.h
 HEADERS += audio/core/AudioMixer.h
 HEADERS += audio/core/SamplesBuffer.h
+HEADERS += audio/core/SamplesBufferView.h
+HEADERS += audio/core/SamplesKernels.h
+HEADERS += audio/core/SnapshotPublisher.h
+HEADERS += audio/core/RenderWorkers.h
+HEADERS += audio/core/SamplesRingBuffer.h
+HEADERS += audio/core/WakeupNotifier.h
 HEADERS += audio/core/AudioPeak.h
 HEADERS += audio/core/Plugins.h
 HEADERS += audio/core/Filters.h
@@ -71,6 +80,9 @@ HEADERS += audio/vorbis/VorbisDecoder.h
 HEADERS += audio/vorbis/VorbisEncoder.h
 HEADERS += audio/RoomStreamerNode.h
 HEADERS += audio/NinjamTrackNode.h
+HEADERS += audio/IntervalDecoder.h
+HEADERS += audio/DecodingService.h
+HEADERS += audio/EncodingService.h
 HEADERS += audio/MetronomeTrackNode.h
 HEADERS += audio/MidiSyncTrackNode.h
 HEADERS += audio/SamplesBufferResampler.h
@@ -79,18 +91,24 @@ HEADERS += audio/Mp3Decoder.h
 HEADERS += audio/Resampler.h
 HEADERS += video/FFMpegMuxer.h
 HEADERS += video/FFMpegDemuxer.h
+HEADERS += video/VideoFrameConverter.h
+HEADERS += video/VideoFramesPool.h
+HEADERS += video/VideoStreamPlayer.h
 HEADERS += video/VideoFrameGrabber.h
 HEADERS += video/VideoWidget.h
 HEADERS += file/FileReader.h
 HEADERS += file/FileReaderFactory.h
 HEADERS += file/WaveFileReader.h
 HEADERS += file/WaveFileWriter.h
+HEADERS += file/StreamingWaveFileWriter.h
 HEADERS += file/OggFileReader.h
 HEADERS += file/Mp3FileReader.h
 HEADERS += file/FileUtils.h
 HEADERS += recorder/JamRecorder.h
 HEADERS += recorder/ReaperProjectGenerator.h
 HEADERS += recorder/ClipSortLogGenerator.h
+HEADERS += recorder/MultitrackWaveWriter.h
+HEADERS += recorder/RecorderIOExecutor.h
 HEADERS += loginserver/LoginService.h
 HEADERS += loginserver/Version.h
 HEADERS += loginserver/MainChat.h
@@ -99,15 +117,19 @@ HEADERS += MainController.h
 HEADERS += NinjamController.h
 HEADERS += MetronomeUtils.h
 HEADERS += ninjam/Ninjam.h
+HEADERS += ninjam/ByteRope.h
+HEADERS += ninjam/MessageFramer.h
 HEADERS += ninjam/client/User.h
 HEADERS += ninjam/client/UserChannel.h
 HEADERS += ninjam/client/Service.h
+HEADERS += ninjam/client/OutgoingMessagesQueue.h
 HEADERS += ninjam/client/ServerInfo.h
 HEADERS += ninjam/client/ServerMessages.h
 HEADERS += ninjam/client/ClientMessages.h
 HEADERS += ninjam/client/ServerMessagesHandler.h
 HEADERS += ninjam/common/CommonMessages.h
 HEADERS += ninjam/server/Server.h
+HEADERS += ninjam/server/ClientConnection.h
 HEADERS += gui/plugins/Guis.h
 HEADERS += gui/PluginScanDialog.h
 HEADERS += gui/PreferencesDialog.h
@@ -171,6 +193,7 @@ HEADERS += persistence/Settings.h
 HEADERS += persistence/UsersDataCache.h
 HEADERS += persistence/CacheHeader.h
 HEADERS += log/Logging.h
+HEADERS += log/RealTimeAllocationTracker.h
 HEADERS += UploadIntervalData.h
 HEADERS += performance/PerformanceMonitor.h
 HEADERS += upnp/UPnPManager.h
@@ -182,10 +205,14 @@ SOURCES += NinjamController.cpp
 SOURCES += MetronomeUtils.cpp
 SOURCES += midi/MidiDriver.cpp
 SOURCES += midi/MidiMessage.cpp
+SOURCES += midi/MidiInputQueue.cpp
 SOURCES += looper/Looper.cpp
 SOURCES += looper/LooperLayer.cpp
+SOURCES += looper/PeaksPyramid.cpp
+SOURCES += looper/LooperMixer.cpp
 SOURCES += looper/LooperStates.cpp
 SOURCES += file/WaveFileWriter.cpp
+SOURCES += file/StreamingWaveFileWriter.cpp
 SOURCES += looper/LooperPersistence.cpp
 SOURCES += audio/core/AudioDriver.cpp
 SOURCES += audio/core/AudioNode.cpp
@@ -198,9 +225,17 @@ SOURCES += audio/RoomStreamerNode.cpp
 SOURCES += audio/core/Plugins.cpp
 SOURCES += audio/Mp3Decoder.cpp
 SOURCES += audio/NinjamTrackNode.cpp
+SOURCES += audio/IntervalDecoder.cpp
+SOURCES += audio/DecodingService.cpp
+SOURCES += audio/EncodingService.cpp
 SOURCES += audio/MetronomeTrackNode.cpp
 SOURCES += audio/MidiSyncTrackNode.cpp
 SOURCES += audio/core/SamplesBuffer.cpp
+SOURCES += audio/core/SamplesKernels.cpp
+SOURCES += audio/core/SnapshotPublisher.cpp
+SOURCES += audio/core/RenderWorkers.cpp
+SOURCES += audio/core/SamplesRingBuffer.cpp
+SOURCES += audio/core/WakeupNotifier.cpp
 SOURCES += audio/core/PluginDescriptor.cpp
 SOURCES += audio/SamplesBufferResampler.cpp
 SOURCES += audio/vorbis/VorbisDecoder.cpp
@@ -209,6 +244,9 @@ SOURCES += audio/core/AudioPeak.cpp
 SOURCES += audio/Resampler.cpp
 SOURCES += video/FFMpegMuxer.cpp
 SOURCES += video/FFMpegDemuxer.cpp
+SOURCES += video/VideoFrameConverter.cpp
+SOURCES += video/VideoFramesPool.cpp
+SOURCES += video/VideoStreamPlayer.cpp
 SOURCES += video/VideoFrameGrabber.cpp
 SOURCES += video/VideoWidget.cpp
 SOURCES += file/FileReaderFactory.cpp
@@ -219,9 +257,14 @@ SOURCES += file/FileUtils.cpp
 SOURCES += recorder/JamRecorder.cpp
 SOURCES += recorder/ReaperProjectGenerator.cpp
 SOURCES += recorder/ClipSortLogGenerator.cpp
+SOURCES += recorder/MultitrackWaveWriter.cpp
+SOURCES += recorder/RecorderIOExecutor.cpp
 SOURCES += ninjam/Ninjam.cpp
+SOURCES += ninjam/ByteRope.cpp
+SOURCES += ninjam/MessageFramer.cpp
 SOURCES += ninjam/client/ServerInfo.cpp
 SOURCES += ninjam/client/Service.cpp
+SOURCES += ninjam/client/OutgoingMessagesQueue.cpp
 SOURCES += ninjam/client/User.cpp
 SOURCES += ninjam/client/ServerMessages.cpp
 SOURCES += ninjam/client/ClientMessages.cpp
@@ -229,6 +272,7 @@ SOURCES += ninjam/client/ServerMessagesHandler.cpp
 SOURCES += ninjam/client/UserChannel.cpp
 SOURCES += ninjam/common/CommonMessages.cpp
 SOURCES += ninjam/server/Server.cpp
+SOURCES += ninjam/server/ClientConnection.cpp
 SOURCES += gui/widgets/PeakMeter.cpp
 SOURCES += gui/widgets/WavePeakPanel.cpp
 SOURCES += gui/widgets/ChatTabWidget.cpp
@@ -295,6 +339,7 @@ SOURCES += gui/UsersColorsPool.cpp
 SOURCES += gui/GuiUtils.cpp
 SOURCES += gui/ThemeLoader.cpp
 SOURCES += log/logging.cpp
+SOURCES += log/RealTimeAllocationTracker.cpp
 SOURCES += loginserver/LoginService.cpp
 SOURCES += loginserver/Version.cpp
 SOURCES += loginserver/MainChat.cpp
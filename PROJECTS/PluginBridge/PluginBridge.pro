@@ -0,0 +1,82 @@
+QT += core
+QT -= gui
+
+TARGET = PluginBridge
+CONFIG -= app_bundle #in MAC create just a binary, not a complete bundle
+CONFIG += c++11
+DEFINES += VST_FORCE_DEPRECATED=0 #enable VST 2.3 features
+
+linux{
+    DEFINES += __cdecl="" #avoid tons of errors in VST_SDK in linux
+}
+
+# the PluginBridge executable is generated in the Standalone folder, as the VstScanner
+macx:DESTDIR = $$OUT_PWD/../Standalone/Jamtaba2.app/Contents/MacOS
+linux:DESTDIR = $$OUT_PWD/../Standalone
+win32{
+    CONFIG(debug, debug|release) {
+        DESTDIR = $$OUT_PWD/../Standalone/debug
+    } else {
+        DESTDIR = $$OUT_PWD/../Standalone/release
+    }
+}
+
+TEMPLATE = app
+
+ROOT_PATH = "../.."
+SOURCE_PATH = $$ROOT_PATH/src
+
+INCLUDEPATH += $$SOURCE_PATH/Common
+INCLUDEPATH += $$SOURCE_PATH/PluginBridge
+INCLUDEPATH += $$SOURCE_PATH/Standalone/vst #to allow the '#include "../audio/Host.h"' in vst/VstHost.h
+INCLUDEPATH += $$ROOT_PATH/VST_SDK/VST2_SDK/pluginterfaces/vst2.x
+
+VPATH       += $$SOURCE_PATH/Common
+VPATH       += $$SOURCE_PATH/PluginBridge
+
+HEADERS += vst/VstHost.h
+HEADERS += vst/Utils.h
+HEADERS += audio/bridge/BridgeProtocol.h
+HEADERS += audio/bridge/BridgeSignal.h
+HEADERS += audio/bridge/PluginBridgeChild.h
+HEADERS += audio/bridge/BridgeTestProcessor.h
+HEADERS += VstChainProcessor.h
+
+SOURCES += main.cpp
+SOURCES += VstChainProcessor.cpp
+SOURCES += audio/bridge/BridgeSignal.cpp
+SOURCES += audio/bridge/PluginBridgeChild.cpp
+SOURCES += audio/bridge/BridgeTestProcessor.cpp
+SOURCES += vst/VstHost.cpp
+SOURCES += vst/VstLoader.cpp
+SOURCES += vst/Utils.cpp
+SOURCES += audio/core/PluginDescriptor.cpp
+SOURCES += midi/MidiMessage.cpp
+SOURCES += log/logging.cpp
+
+win32{
+
+    win32-msvc*{#all msvc compilers
+        #windows XP support
+        QMAKE_LFLAGS_WINDOWS = /SUBSYSTEM:WINDOWS,5.01 /SUBSYSTEM:CONSOLE,5.01
+
+        CONFIG(release, debug|release) {
+            QMAKE_CXXFLAGS_RELEASE +=  -GL -Gy -Gw
+            QMAKE_LFLAGS_RELEASE += /LTCG
+        }
+    }
+
+    LIBS +=  -lwinmm -lole32 -lws2_32 -ladvapi32 -luser32
+    RC_FILE = ../Jamtaba2.rc #windows icon
+}
+
+linux{
+    LIBS += -lrt #shm_open and sem_open in old glibc
+}
+
+macx{
+    QMAKE_CXXFLAGS_WARN_ON += -Wno-reorder
+    LIBS+= -dead_strip
+    LIBS += -framework Cocoa
+    CONFIG += console
+}
@@ -9,6 +9,12 @@ JAMTABA_BUILDER = $$(JAMTABA_BUILDER)
 
 DEFINES += APP_VERSION=\"\\\"$${JAMTABA_VERSION}\\\"\"
 
+# 'qmake CONFIG+=rt_alloc_tracker' report (with stack traces) all memory allocations in audio thread. Debug builds only.
+rt_alloc_tracker:CONFIG(debug, debug|release) {
+    DEFINES += JAMTABA_RT_ALLOC_TRACKER
+    linux:QMAKE_LFLAGS += -rdynamic # function names in stack traces
+}
+
 VPATH += $$SOURCE_PATH
 VPATH += $$SOURCE_PATH/Standalone
 
@@ -38,10 +44,15 @@ HEADERS += audio/PortAudioDriver.h
 HEADERS += audio/Host.h
 HEADERS += midi/RtMidiDriver.h
 HEADERS += vst/VstPlugin.h
+HEADERS += vst/BridgedPlugin.h
+HEADERS += audio/bridge/BridgeProtocol.h
+HEADERS += audio/bridge/BridgeSignal.h
+HEADERS += audio/bridge/PluginBridgeHost.h
 HEADERS += vst/VstHost.h
 HEADERS += vst/VstLoader.h
 HEADERS += PluginFinder.h
 HEADERS += vst/VstPluginFinder.h
+HEADERS += persistence/PluginScanCache.h
 HEADERS += vst/Utils.h
 HEADERS += Libs/SingleApplication/singleapplication.h
 HEADERS += Libs/RtMidi/RtMidi.h
@@ -62,9 +73,13 @@ SOURCES += gui/FxPanelItem.cpp
 SOURCES += gui/MidiToolsDialog.cpp
 SOURCES += midi/RtMidiDriver.cpp
 SOURCES += vst/VstPlugin.cpp
+SOURCES += vst/BridgedPlugin.cpp
+SOURCES += audio/bridge/BridgeSignal.cpp
+SOURCES += audio/bridge/PluginBridgeHost.cpp
 SOURCES += vst/VstHost.cpp
 SOURCES += PluginFinder.cpp
 SOURCES += vst/VstPluginFinder.cpp
+SOURCES += persistence/PluginScanCache.cpp
 SOURCES += vst/Utils.cpp
 SOURCES += vst/VstLoader.cpp
 SOURCES += Libs/SingleApplication/singleapplication.cpp
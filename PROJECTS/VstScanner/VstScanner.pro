@@ -39,6 +39,7 @@ HEADERS += vst/VstHost.h
 HEADERS += vst/Utils.h
 HEADERS += VstScanner/VstPluginScanner.h
 HEADERS += BaseScanner.h
+HEADERS += persistence/PluginScanCache.h
 
 SOURCES += VstScanner/main.cpp
 SOURCES += BaseScanner.cpp
@@ -49,6 +50,8 @@ SOURCES += vst/Utils.cpp
 SOURCES += audio/core/PluginDescriptor.cpp
 SOURCES += midi/MidiMessage.cpp
 SOURCES += log/logging.cpp
+SOURCES += persistence/PluginScanCache.cpp
+SOURCES += persistence/CacheHeader.cpp
 
 
 #including the correct implementation for VstPluginChecker
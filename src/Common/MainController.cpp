@@ -16,6 +16,7 @@
 #include "recorder/JamRecorder.h"
 #include "recorder/ReaperProjectGenerator.h"
 #include "recorder/ClipSortLogGenerator.h"
+#include "recorder/MultitrackWaveWriter.h"
 #include "gui/MainWindow.h"
 #include "gui/ThemeLoader.h"
 #include "log/Logging.h"
@@ -50,6 +51,7 @@ MainController::MainController(const Settings &settings) :
     currentStreamingRoomID(-1000),
     started(false),
     masterGain(1),
+    incomingMidiFrames(0),
     usersDataCache(Configurator::getInstance()->getCacheDir()),
     lastInputTrackID(0),
     lastFrameTimeStamp(0),
@@ -57,9 +59,13 @@ MainController::MainController(const Settings &settings) :
 {
     QDir cacheDir = Configurator::getInstance()->getCacheDir();
 
+    incomingMidi.reserve(midi::MAX_MESSAGES_PER_BUFFER); // filled in audio thread
+    incomingMidiSlice.reserve(midi::MAX_MESSAGES_PER_BUFFER);
+
     // Register known JamRecorders here:
     jamRecorders.append(new recorder::JamRecorder(new recorder::ReaperProjectGenerator()));
     jamRecorders.append(new recorder::JamRecorder(new recorder::ClipSortLogGenerator()));
+    jamRecorders.append(new recorder::JamRecorder(new recorder::MultitrackWaveWriter()));
 
     connect(&videoEncoder, &FFMpegMuxer::dataEncoded, this, &MainController::enqueueVideoDataToUpload);
 
@@ -178,6 +184,18 @@ void MainController::setEncodingQuality(float newEncodingQuality)
         ninjamController->recreateEncoders();
 }
 
+void MainController::setAudioRenderThreads(int threads)
+{
+    settings.setAudioRenderThreads(threads);
+    audioMixer.setRenderThreads(threads);
+}
+
+void MainController::setDecodingLookAhead(int milliseconds)
+{
+    settings.setDecodingLookAhead(milliseconds);
+    decodingService.setLookAhead(milliseconds);
+}
+
 void MainController::finishUploads()
 {
     for (int channelIndex : audioIntervalsToUpload.keys()) {
@@ -233,8 +251,10 @@ void MainController::connectInNinjamServer(const ServerInfo &server)
 
     stopNinjamController();
 
-    auto newNinjamController = createNinjamController();
-    ninjamController.reset(newNinjamController);
+    QScopedPointer<controller::NinjamController> oldNinjamController(ninjamController.take());
+    ninjamController.reset(createNinjamController());
+    audio::SnapshotReadSection::waitForReaders(); // the audio thread can be reading the old controller
+    oldNinjamController.reset();
 
     setupNinjamControllerSignals();
 
@@ -254,9 +274,10 @@ void MainController::connectInNinjamServer(const ServerInfo &server)
         quint16 bpm = server.getBpm();
         quint16 bpi = server.getBpi();
         float sampleRate = getSampleRate();
+        recorder::JamServer jamServer(server.getHostName(), server.getPort(), server.getUniqueName());
 
         for (auto jamRecorder : getActiveRecorders())
-            jamRecorder->startRecording(userName, recordBasePath, bpm, bpi, sampleRate);
+            jamRecorder->startRecording(userName, recordBasePath, jamServer, bpm, bpi, sampleRate);
     }
 }
 
@@ -280,6 +301,11 @@ void MainController::handleNewNinjamInterval()
 
     if (mainWindow->cameraIsActivated())
         videoEncoder.startNewInterval();
+
+    if (ninjamController) {
+        for (auto inputTrack : inputTracks.values())
+            inputTrack->getLooper()->prepareMixer(ninjamController->getSamplesPerInterval()); // the looper mixer is not allocating in audio thread
+    }
 }
 
 void MainController::processCapturedFrame(int frameID, const QImage &frame)
@@ -407,8 +433,9 @@ void MainController::enqueueVideoDataToUpload(const QByteArray &encodedData, boo
 
 int MainController::getMaxAudioChannelsForEncoding(uint trackGroupIndex) const
 {
-    auto it = trackGroups.find(trackGroupIndex);
-    if (it != trackGroups.end()) {
+    const auto &groups = trackGroupsSnapshot.read(); // no locks, called in audio thread
+    auto it = groups.find(trackGroupIndex);
+    if (it != groups.end()) {
         return it.value()->getMaxInputChannelsForEncoding();
     }
     return 0;
@@ -469,14 +496,15 @@ login::Location MainController::getGeoLocation(const QString &ip)
 
 void MainController::mixGroupedInputs(int groupIndex, audio::SamplesBuffer &out)
 {
-    auto it = trackGroups.find(groupIndex);
-    if (it != trackGroups.end()) {
+    const auto &groups = trackGroupsSnapshot.read(); // no locks, called in audio thread
+    auto it = groups.find(groupIndex);
+    if (it != groups.end()) {
         it.value()->mixGroupedInputs(out);
     }
 }
 
 // this is called when a new ninjam interval is received and the 'record multi track' option is enabled
-void MainController::saveEncodedAudio(const QString &userName, quint8 channelIndex, const QByteArray &encodedAudio)
+void MainController::saveEncodedAudio(const QString &userName, quint8 channelIndex, const ninjam::ByteRope &encodedAudio)
 {
     if (settings.isSaveMultiTrackActivated()) { // just in case
         for (auto jamRecorder : getActiveRecorders())
@@ -507,6 +535,7 @@ void MainController::removeInputTrackNode(int inputTrackIndex)
         }
 
         inputTracks.remove(inputTrackIndex);
+        publishInputTracks(); // the audio thread can't reach the removed input and group after this call
         removeTrack(inputTrackIndex);
     }
 }
@@ -525,9 +554,17 @@ int MainController::addInputTrackNode(QSharedPointer<audio::LocalInputNode> inpu
         trackGroups.insert(trackGroupIndex, QSharedPointer<audio::LocalInputGroup>::create(trackGroupIndex, inputTrackNode));
     }
 
+    publishInputTracks();
+
     return inputTrackID;
 }
 
+void MainController::publishInputTracks()
+{
+    inputTracksSnapshot.publish(inputTracks.values());
+    trackGroupsSnapshot.publish(trackGroups);
+}
+
 QSharedPointer<audio::LocalInputNode> MainController::getInputTrack(int localInputIndex)
 {
     if (inputTracks.contains(localInputIndex))
@@ -582,6 +619,11 @@ QMap<QString, QString> MainController::getJamRecoders() const
     return jamRecoderMap;
 }
 
+recorder::RecorderIOMetrics MainController::getRecorderIOMetrics() const
+{
+    return recorder::RecorderIOExecutor::getAllExecutorsMetrics();
+}
+
 void MainController::storeJamRecorderStatus(const QString &writerId, bool status)
 {
     if (settings.isSaveMultiTrackActivated()) { // recording is active and changing the jamRecorder status
@@ -593,7 +635,9 @@ void MainController::storeJamRecorderStatus(const QString &writerId, bool status
                         auto ninjamController = getNinjamController();
                         int bpi = ninjamController->getCurrentBpi();
                         int bpm = ninjamController->getCurrentBpm();
-                        jamRecorder->startRecording(getUserName(), recordingPath, bpm, bpi, getSampleRate());
+                        auto server = getNinjamService()->getCurrentServer();
+                        recorder::JamServer jamServer(server->getHostName(), server->getPort(), server->getUniqueName());
+                        jamRecorder->startRecording(getUserName(), recordingPath, jamServer, bpm, bpi, getSampleRate());
                     }
                 } else {
                     jamRecorder->stopRecording();
@@ -686,9 +730,9 @@ void MainController::removeTrack(long trackID)
 {
     QSharedPointer<audio::AudioNode> trackNode;
     {
-        /** remove Track is called from ninjam service thread,
-         *  and cause a crash if the process callback (audio Thread)
-         *  is iterating over tracksNodes to render audio */
+        /** remove Track is called from ninjam service thread. The audio thread
+         *  is not using tracksNodes, the mixer snapshot keep the node alive
+         *  until the process callback is finished */
         QMutexLocker locker(&mutex);
         auto iterator = tracksNodes.find(trackID);
         if (iterator != tracksNodes.end()) {
@@ -708,10 +752,26 @@ void MainController::setAllLoopersStatus(bool activated)
         inputTrack->getLooper()->setActivated(activated);
 }
 
-void MainController::doAudioProcess(const audio::SamplesBuffer &in, audio::SamplesBuffer &out, int sampleRate)
+const std::vector<midi::MidiMessage> &MainController::getIncomingMidi(quint32 framesOffset, quint32 frames)
 {
-    auto incommingMidi = pullMidiMessagesFromDevices();
-    audioMixer.process(in, out, sampleRate, incommingMidi);
+    if (framesOffset == 0 && frames >= incomingMidiFrames)
+        return incomingMidi; // the whole callback buffer, no copies
+
+    incomingMidiSlice.clear();
+    for (const auto &message : incomingMidi) {
+        const quint32 offset = message.getSampleOffset();
+        if (offset >= framesOffset && offset < framesOffset + frames) {
+            incomingMidiSlice.push_back(message);
+            incomingMidiSlice.back().setSampleOffset(offset - framesOffset);
+        }
+    }
+
+    return incomingMidiSlice;
+}
+
+void MainController::doAudioProcess(const audio::SamplesBuffer &in, audio::SamplesBuffer &out, int sampleRate, quint32 framesOffset)
+{
+    audioMixer.process(in, out, sampleRate, getIncomingMidi(framesOffset, out.getFrameLenght()));
 
     out.applyGain(masterGain, 1.0f); // using 1 as boost factor/multiplier (no boost)
     masterPeak.update(out.computePeak());
@@ -719,11 +779,15 @@ void MainController::doAudioProcess(const audio::SamplesBuffer &in, audio::Sampl
 
 void MainController::process(const audio::SamplesBuffer &in, audio::SamplesBuffer &out, int sampleRate)
 {
-    QMutexLocker locker(&mutex);
+    audio::SnapshotReadSection readSection; // no locks in audio thread, nodes and ninjam controller are released only after this callback
 
     if (!started)
         return;
 
+    incomingMidi.clear(); // keep the reserved capacity
+    incomingMidiFrames = out.getFrameLenght();
+    pullMidiMessagesFromDevices(incomingMidi, incomingMidiFrames, sampleRate);
+
     try
     {
         if (!isPlayingInNinjamRoom()) {
@@ -748,7 +812,7 @@ void MainController::process(const audio::SamplesBuffer &in, audio::SamplesBuffe
 
 void MainController::syncWithNinjamIntervalStart(uint intervalLenght)
 {
-    for (auto inputTrack : inputTracks.values())
+    for (const auto &inputTrack : inputTracksSnapshot.read()) // no locks and no copies, called in audio thread
         inputTrack->startNewLoopCycle(intervalLenght);
 }
 
@@ -800,8 +864,9 @@ void MainController::setTransmitingStatus(int channelID, bool transmiting)
 
 bool MainController::isTransmiting(int channelID) const
 {
-    auto it = trackGroups.find(channelID);
-    if (it != trackGroups.end()) {
+    const auto &groups = trackGroupsSnapshot.read(); // no locks, called in audio thread
+    auto it = groups.find(channelID);
+    if (it != groups.end()) {
         return it.value()->isTransmiting();
     }
     return false;
@@ -925,6 +990,8 @@ MainController::~MainController()
 
     trackGroups.clear();
 
+    publishInputTracks(); // release the snapshots, the audio driver is stopped
+
     qCDebug(jtCore()) << "cleaning tracksNodes done!";
 
     qCDebug(jtCore()) << "cleaning jamRecorders...";
@@ -1067,6 +1134,9 @@ void MainController::start()
         roomStreamer = QSharedPointer<audio::NinjamRoomStreamerNode>::create(); // new Audio::AudioFileStreamerNode(":/teste.mp3");
         this->audioMixer.addNode(roomStreamer);
 
+        audioMixer.setRenderThreads(settings.getAudioRenderThreads());
+        decodingService.setLookAhead(settings.getDecodingLookAhead());
+
         connect(ninjamService.data(), &Service::connectedInServer, this, &MainController::connectInNinjamServer);
 
         connect(ninjamService.data(), &Service::disconnectedFromServer, this, &MainController::disconnectFromNinjamServer);
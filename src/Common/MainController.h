@@ -9,8 +9,10 @@
 #include "persistence/Settings.h"
 #include "persistence/UsersDataCache.h"
 #include "audio/core/AudioMixer.h"
+#include "audio/DecodingService.h"
 #include "midi/MidiDriver.h"
 #include "video/FFMpegMuxer.h"
+#include "recorder/RecorderIOExecutor.h"
 #include "gui/chat/EmojiManager.h"
 
 class MainWindow;
@@ -95,7 +97,7 @@ public:
 
     MainWindow *getMainWindow() const;
 
-    virtual std::vector<midi::MidiMessage> pullMidiMessagesFromPlugins() = 0;     // pull midi messages generated by plugins. This function can be called many times in each audio processing cicle because every VSTi can be a midi messages generator, and we need get the generated messages after call the plugin 'process' function.
+    virtual void pullMidiMessagesFromPlugins(std::vector<midi::MidiMessage> &pulledMessages) = 0;     // append in 'pulledMessages' the midi messages generated by plugins. This function can be called many times in each audio processing cicle because every VSTi can be a midi messages generator, and we need get the generated messages after call the plugin 'process' function.
 
     void saveLastUserSettings(const LocalInputTrackSettings &inputsSettings);
 
@@ -155,6 +157,8 @@ public:
 
     Service *getNinjamService();
 
+    audio::DecodingService *getDecodingService();
+
     static QStringList getBotNames();
 
     // tracks
@@ -199,6 +203,9 @@ public:
 
     float getEncodingQuality() const;
 
+    int getAudioRenderThreads() const;
+    int getDecodingLookAhead() const;
+
     static QByteArray newGUID();
 
     const Settings &getSettings() const;
@@ -243,7 +250,7 @@ public:
     QString getMetronomeAccentBeatFile() const;
 
     void saveEncodedAudio(const QString &userName, quint8 channelIndex,
-                          const QByteArray &encodedAudio);
+                          const ninjam::ByteRope &encodedAudio);
 
     AbstractMp3Streamer *getRoomStreamer() const;
 
@@ -273,6 +280,7 @@ public:
     static QString getSuggestedUserName();
 
     QMap<QString, QString> getJamRecoders() const;
+    recorder::RecorderIOMetrics getRecorderIOMetrics() const; // queued bytes, latency and dropped writes in all record disks
 
     void setChannelReceiveStatus(const QString &userFullName, quint8 channelIndex,
                                  bool receiveChannel);
@@ -323,6 +331,8 @@ signals:
 public slots:
     virtual void setSampleRate(int newSampleRate);
     void setEncodingQuality(float newEncodingQuality);
+    void setAudioRenderThreads(int threads);
+    void setDecodingLookAhead(int milliseconds);
     void storeLooperBitDepth(quint8 bitDepth);
 
     void storeRemoteUserRememberSettings(bool boost, bool level, bool pan, bool mute, bool lowCut);
@@ -348,6 +358,8 @@ protected:
 
     AudioMixer audioMixer;
 
+    audio::DecodingService decodingService; // used by ninjam track nodes, destroyed after the ninjam controller
+
     // ninjam
     QScopedPointer<Service> ninjamService;
     QScopedPointer<controller::NinjamController> ninjamController;
@@ -355,6 +367,7 @@ protected:
     Settings settings;
 
     QMap<int, QSharedPointer<LocalInputNode>> inputTracks;
+    audio::SnapshotPublisher<QList<QSharedPointer<LocalInputNode>>> inputTracksSnapshot; // inputTracks values used in audio thread
 
     virtual controller::NinjamController *createNinjamController() = 0;
 
@@ -370,11 +383,11 @@ protected:
 
     virtual void setCSS(const QString &css) = 0;
 
-    virtual std::vector<midi::MidiMessage> pullMidiMessagesFromDevices() = 0;     // pull midi messages generated by midi controllers. This function is called just one time in each audio processing cicle.
+    virtual void pullMidiMessagesFromDevices(std::vector<midi::MidiMessage> &pulledMessages, quint32 frames, int sampleRate) = 0;     // append in 'pulledMessages' the midi messages generated by midi controllers, with sample offsets in the next 'frames'. This function is called just one time in each audio processing cicle.
 
-    // audio process is here too (see MainController::process)
+    // audio process is here too (see MainController::process). 'framesOffset' is the position of 'out' in the audio callback buffer, the ninjam intervals can split the callback buffer.
     virtual void doAudioProcess(const SamplesBuffer &in, SamplesBuffer &out,
-                                int sampleRate);
+                                int sampleRate, quint32 framesOffset = 0);
 
     virtual void syncWithNinjamIntervalStart(uint intervalLenght);
 
@@ -387,6 +400,9 @@ private:
     QString currentStreamingRoomID;
 
     QMap<int, QSharedPointer<LocalInputGroup>> trackGroups;
+    audio::SnapshotPublisher<QMap<int, QSharedPointer<LocalInputGroup>>> trackGroupsSnapshot; // trackGroups used in audio thread, the removed groups and inputs are released after the audio callback
+
+    void publishInputTracks(); // called after changing inputTracks or trackGroups
 
     QMap<int, bool> getXmitChannelsFlags() const;
 
@@ -405,6 +421,13 @@ private:
     float masterGain;
     AudioPeak masterPeak;
 
+    // midi messages received in current audio callback, the capacity is reserved and the same messages are read by all nodes
+    std::vector<midi::MidiMessage> incomingMidi;
+    std::vector<midi::MidiMessage> incomingMidiSlice; // messages in a part of the callback buffer (ninjam interval start)
+    quint32 incomingMidiFrames;
+
+    const std::vector<midi::MidiMessage> &getIncomingMidi(quint32 framesOffset, quint32 frames);
+
     UsersDataCache usersDataCache;
 
     int lastInputTrackID;     // used to generate a unique key/ID for each input track
@@ -544,6 +567,16 @@ inline float MainController::getEncodingQuality() const
     return settings.getEncodingQuality();
 }
 
+inline int MainController::getAudioRenderThreads() const
+{
+    return settings.getAudioRenderThreads();
+}
+
+inline int MainController::getDecodingLookAhead() const
+{
+    return settings.getDecodingLookAhead();
+}
+
 inline int MainController::getInputTracksCount() const
 {
     return inputTracks.size();     // return the individual tracks (subchannels) count
@@ -551,7 +584,7 @@ inline int MainController::getInputTracksCount() const
 
 inline int MainController::getInputTrackGroupsCount() const
 {
-    return trackGroups.size();     // return the track groups (channels) count
+    return trackGroupsSnapshot.read().size();     // return the track groups (channels) count, called in audio thread
 }
 
 inline bool MainController::isStarted() const
@@ -579,6 +612,11 @@ inline Service *MainController::getNinjamService()
     return ninjamService.data();
 }
 
+inline audio::DecodingService *MainController::getDecodingService()
+{
+    return &decodingService;
+}
+
 inline QString MainController::getCurrentStreamingRoomID() const
 {
     return currentStreamingRoomID;
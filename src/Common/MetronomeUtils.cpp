@@ -3,7 +3,8 @@
 #include "audio/core/SamplesBuffer.h"
 #include "file/FileReaderFactory.h"
 #include "file/FileReader.h"
-#include "audio/Resampler.h"
+#include "file/WaveFileReader.h"
+#include "audio/SamplesBufferResampler.h"
 #include <QString>
 #include <QFileInfo>
 #include <QFile>
@@ -131,6 +132,13 @@ void metronomeUtils::removeSilenceInBufferStart(SamplesBuffer &buffer)
 
 void metronomeUtils::createBuffer(const QString &audioFilePath, SamplesBuffer &outBuffer, quint32 localSampleRate)
 {
+    if (QFileInfo(audioFilePath).suffix() == "wav") { // custom metronome sounds, resampled while reading
+        outBuffer.setFrameLenght(0); // load the entire file
+        audio::WaveFileReader waveReader;
+        waveReader.readResampled(audioFilePath, outBuffer, localSampleRate);
+        return;
+    }
+
     std::unique_ptr<FileReader> reader = FileReaderFactory::createFileReader(audioFilePath);
     quint32 audioFileSampleRate; //will be changed inside reader->read
     SamplesBuffer originalBuffer(1);//assuming mono for while
@@ -151,17 +159,5 @@ void metronomeUtils::createBuffer(const QString &audioFilePath, SamplesBuffer &o
 void metronomeUtils::createResampledBuffer(const SamplesBuffer &buffer, SamplesBuffer &outBuffer, int originalSampleRate,
                                      int finalSampleRate)
 {
-    int finalSize = (double)finalSampleRate/originalSampleRate * buffer.getFrameLenght();
-    int channels = buffer.getChannels();
-    if (channels > 1)
-        outBuffer.setToStereo();
-    else
-        outBuffer.setToMono();
-    outBuffer.setFrameLenght(finalSize);
-
-    for (int c = 0; c < channels; ++c) {
-        SimpleResampler resampler;
-        resampler.process(buffer.getSamplesArray(c),
-                          buffer.getFrameLenght(), outBuffer.getSamplesArray(c), finalSize);
-    }
+    SamplesBufferResampler::resample(buffer, outBuffer, originalSampleRate, finalSampleRate);
 }
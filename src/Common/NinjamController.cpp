@@ -30,203 +30,13 @@
 #include <QDebug>
 #include <QThread>
 #include <QFileInfo>
-#include <QWaitCondition>
 
 #include <cmath>
 #include <cassert>
-#include <vector>
 
 using controller::NinjamController;
 using ninjam::client::ServerInfo;
 
-// +++++++++++++  ENCODING THREAD  +++++++++++++
-
-class NinjamController::EncodingThread : public QThread // TODO: use better thread approach, avoid inheritance form QThread
-{
-public:
-
-    explicit EncodingThread(NinjamController *controller) :
-        stopRequested(false),
-        controller(controller)
-    {
-        qCDebug(jtNinjamCore) << "Starting Encoding Thread";
-        start();
-    }
-
-    ~EncodingThread()
-    {
-        stop();
-    }
-
-    void addSamplesToEncode(const audio::SamplesBuffer &samplesToEncode, quint8 channelIndex,
-                            bool isFirstPart, bool isLastPart)
-    {
-        if (samplesToEncode.isEmpty()) return;
-        // qCDebug(jtNinjamCore) << "Adding samples to encode";
-        QMutexLocker locker(&mutex);
-        chunksToEncode.push_back(EncodingChunk(samplesToEncode, channelIndex, isFirstPart,
-                                               isLastPart));
-        // this method is called by Qt main thread (the producer thread).
-        hasAvailableChunksToEncode.wakeAll();// wakeup the encoding thread (consumer thread)
-    }
-
-    void stop()
-    {
-        if (!stopRequested) {
-            QMutexLocker locker(&mutex);
-            if (!stopRequested) {
-                stopRequested = true;
-                hasAvailableChunksToEncode.wakeAll();
-                qCDebug(jtNinjamCore) << "Stopping Encoding Thread";
-            }
-        }
-    }
-
-protected:
-
-    void run()
-    {
-        while (!stopRequested) {
-            {
-                QMutexLocker locker(&mutex);
-                while (!stopRequested && chunksToEncode.empty()) {
-                    hasAvailableChunksToEncode.wait(&mutex);
-                }
-                if (stopRequested){
-                    break;
-                }
-                std::swap(chunksProcessing, chunksToEncode);
-            }
-            for (const auto& chunk : chunksProcessing) {
-                QByteArray encodedBytes(controller->encode(chunk.buffer, chunk.channelIndex, chunk.lastPart));
-                if (!encodedBytes.isEmpty()) {
-                    emit controller->encodedAudioAvailableToSend(encodedBytes, chunk.channelIndex,
-                                                                 chunk.firstPart, chunk.lastPart);
-                }
-                if (stopRequested) {
-                    break;
-                }
-            }
-            chunksProcessing.clear();
-        }
-        qCDebug(jtNinjamCore) << "Encoding thread stopped!";
-    }
-
-private:
-
-    class EncodingChunk
-    {
-    public:
-        EncodingChunk(const audio::SamplesBuffer &buffer, quint8 channelIndex, bool firstPart,
-                      bool lastPart) :
-            buffer(buffer),
-            channelIndex(channelIndex),
-            firstPart(firstPart),
-            lastPart(lastPart)
-        {
-        }
-
-        audio::SamplesBuffer buffer;
-        quint8 channelIndex;
-        bool firstPart;
-        bool lastPart;
-    };
-
-    std::vector<EncodingChunk> chunksToEncode;
-    std::vector<EncodingChunk> chunksProcessing;
-    QMutex mutex;
-    volatile bool stopRequested;
-    NinjamController *controller;
-    QWaitCondition hasAvailableChunksToEncode;
-};
-
-// +++++++++++++++++ Nested classes to handle schedulable events ++++++++++++++++
-
-class NinjamController::SchedulableEvent // an event scheduled to be processed in next interval
-{
-public:
-    explicit SchedulableEvent(NinjamController *controller) :
-        controller(controller)
-    {
-        //
-    }
-
-    virtual void process() = 0;
-
-    virtual ~SchedulableEvent()
-    {
-    }
-
-protected:
-    NinjamController *controller;
-};
-
-// ++++++++++++++++++++++++++++++++++++++++++++
-
-class NinjamController::BpiChangeEvent : public SchedulableEvent
-{
-public:
-    BpiChangeEvent(NinjamController *controller, quint16 newBpi) :
-        SchedulableEvent(controller),
-        newBpi(newBpi)
-    {
-    }
-
-    void process() override
-    {
-        controller->currentBpi = newBpi;
-        controller->samplesInInterval = controller->computeTotalSamplesInInterval();
-        emit controller->currentBpiChanged(controller->currentBpi);
-    }
-
-private:
-    quint16 newBpi;
-};
-
-// +++++++++++++++++++++++++++++++++++++++++
-
-class NinjamController::BpmChangeEvent : public SchedulableEvent
-{
-public:
-    BpmChangeEvent(NinjamController *controller, quint16 newBpm) :
-        SchedulableEvent(controller),
-        newBpm(newBpm)
-    {
-    }
-
-    void process() override
-    {
-        controller->setBpm(newBpm);
-    }
-
-private:
-    quint16 newBpm;
-};
-
-// +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
-
-class NinjamController::InputChannelChangedEvent : public SchedulableEvent
-{
-public:
-    InputChannelChangedEvent(NinjamController *controller, int channelIndex, bool voiceChannelActivated) :
-        SchedulableEvent(controller),
-        channelIndex(channelIndex),
-        voiceChannelActivated(voiceChannelActivated)
-    {
-    }
-
-    void process() override
-    {
-        controller->recreateEncoderForChannel(channelIndex, voiceChannelActivated);
-    }
-
-private:
-    int channelIndex;
-    bool voiceChannelActivated;
-};
-
-// +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
-
 std::atomic<int> NinjamController::trackIds(100);
 
 NinjamController::NinjamController(controller::MainController *mainController) :
@@ -235,16 +45,27 @@ NinjamController::NinjamController(controller::MainController *mainController) :
     mainController(mainController),
     metronomeTrackNode(createMetronomeTrackNode(mainController->getSampleRate())),
     midiSyncTrackNode(new audio::MidiSyncTrackNode(mainController)),
+    running(false),
     lastBeat(0),
     currentBpi(0),
     currentBpm(0),
     mutex(QMutex::Recursive),
     encodersMutex(QMutex::Recursive),
-    encodingThread(nullptr),
+    lastEncoderGeneration(0),
+    scheduledChanges(16),
+    encodingService(nullptr),
+    tempInBuffer(2),
+    tempOutBuffer(2),
+    inputMixBuffer(2),
     preparedForTransmit(false),
     waitingIntervals(0) // waiting for start transmit
 {
-    running = false;
+    tempInBuffer.reserve(audio::MAX_BUFFER_SIZE);
+    tempOutBuffer.reserve(audio::MAX_BUFFER_SIZE);
+    inputMixBuffer.reserve(audio::MAX_BUFFER_SIZE);
+
+    for (auto &activeGeneration : activeEncoderGenerations)
+        activeGeneration = 0;
 }
 
 User NinjamController::getUserByName(const QString &userName) const
@@ -294,6 +115,7 @@ void NinjamController::removeEncoder(int groupChannelIndex)
 {
     QMutexLocker locker(&encodersMutex);
     encoders.remove(groupChannelIndex);
+    publishEncoders();
 }
 
 // +++++++++++++++++++++++++ THE MAIN LOGIC IS HERE  ++++++++++++++++++++++++++++++++++++++++++++++++
@@ -301,12 +123,15 @@ void NinjamController::removeEncoder(int groupChannelIndex)
 void NinjamController::process(const audio::SamplesBuffer &in, audio::SamplesBuffer &out,
                                int sampleRate)
 {
-    QMutexLocker locker(&mutex);
+    // called inside MainController::process() read section, trackNodes and encodingService are not released while this function is running
+
+    if (!running)
+        return;
 
     if (currentBpi == 0 || currentBpm == 0)
         processScheduledChanges(); // check if we have the initial bpm and bpi change pending
 
-    if (!running || samplesInInterval <= 0)
+    if (samplesInInterval <= 0)
         return; // not initialized
 
     int totalSamplesToProcess = out.getFrameLenght();
@@ -324,11 +149,14 @@ void NinjamController::process(const audio::SamplesBuffer &in, audio::SamplesBuf
 
         assert(samplesToProcessInThisStep);
 
-        static audio::SamplesBuffer tempOutBuffer(out.getChannels(), samplesToProcessInThisStep);
+        if (tempOutBuffer.getChannels() != out.getChannels())
+            tempOutBuffer = audio::SamplesBuffer(out.getChannels()); // only when output channels changed, the reserved capacity is kept
         tempOutBuffer.setFrameLenght(samplesToProcessInThisStep);
         tempOutBuffer.zero();
 
-        audio::SamplesBuffer tempInBuffer(in.getChannels(), samplesToProcessInThisStep);
+        if (tempInBuffer.getChannels() != in.getChannels())
+            tempInBuffer = audio::SamplesBuffer(in.getChannels()); // only when input channels changed, the reserved capacity is kept
+        tempInBuffer.setFrameLenght(samplesToProcessInThisStep);
         tempInBuffer.set(in, offset, samplesToProcessInThisStep, 0);
 
         bool newInterval = intervalPosition == 0;
@@ -348,7 +176,7 @@ void NinjamController::process(const audio::SamplesBuffer &in, audio::SamplesBuf
         bool isLastPart = intervalPosition + samplesToProcessInThisStep >= samplesInInterval;
         //for (NinjamTrackNode *track : trackNodes)
         //    track->setProcessingLastPartOfInterval(isLastPart); // TODO resampler still need a flag indicating the last part?
-        mainController->doAudioProcess(tempInBuffer, tempOutBuffer, sampleRate);
+        mainController->doAudioProcess(tempInBuffer, tempOutBuffer, sampleRate, offset);
         out.add(tempOutBuffer, offset); // generate audio output
         // ++++++++++++++++++++++++++++++++++++++++++++++++++++++
 
@@ -364,21 +192,21 @@ void NinjamController::process(const audio::SamplesBuffer &in, audio::SamplesBuf
                     int channels = mainController->getMaxAudioChannelsForEncoding(groupIndex);
                     if (channels > 0)
                     {
-                        audio::SamplesBuffer inputMixBuffer(channels, samplesToProcessInThisStep);
-
-                        bool containEncoder;
-                        {
-                            QMutexLocker locker(&encodersMutex);
-                            containEncoder = encoders.contains(groupIndex);
-                        }
-                        if (containEncoder)
+                        if (channels == 1)
+                            inputMixBuffer.setToMono();
+                        else
+                            inputMixBuffer.setToStereo(); // no allocation, the 2 channels are preallocated
+                        inputMixBuffer.setFrameLenght(samplesToProcessInThisStep);
+
+                        auto encoder = getEncoder(groupIndex);
+                        if (encoder)
                         {
                             inputMixBuffer.zero();
                             mainController->mixGroupedInputs(groupIndex, inputMixBuffer);
 
-                            // encoding is running in another thread to avoid slow down the audio thread
-                            encodingThread->addSamplesToEncode(inputMixBuffer, groupIndex,
-                                                               isFirstPart, isLastPart);
+                            // encoding is running in other threads to avoid slow down the audio thread
+                            encodingService->addSamplesToEncode(inputMixBuffer, groupIndex, std::move(encoder),
+                                                                isFirstPart, isLastPart);
                         }
                     }
                 }
@@ -473,6 +301,7 @@ void NinjamController::stop(bool emitDisconnectedSignal)
                    &NinjamController::topicMessageReceived);
 
         this->running = false;
+        audio::SnapshotReadSection::waitForReaders(); // wait until the audio thread leave process(), the tracks and encoding thread are released below
 
         // stop midi sync track
         this->midiSyncTrackNode->stop();
@@ -498,6 +327,7 @@ void NinjamController::stop(bool emitDisconnectedSignal)
                 trackNodesList.append(iterator.value());
             }
             trackNodes.clear();
+            publishTrackNodes();
         }
 
         // clear all tracks
@@ -506,21 +336,34 @@ void NinjamController::stop(bool emitDisconnectedSignal)
         }
     }
 
-    if (encodingThread)
+    if (encodingService)
     {
-        encodingThread->stop();
-        encodingThread->wait(); // wait the encoding thread to finish
-        encodingThread.reset();
+        int channels = mainController->getInputTrackGroupsCount();
+        for (int channelIndex = 0; channelIndex < channels; ++channelIndex) {
+            auto metrics = encodingService->getMetrics(channelIndex);
+            if (metrics.encodedBlocks > 0) {
+                qCDebug(jtNinjamCore) << "Channel" << channelIndex << "encoding:" << metrics.encodedBlocks << "blocks, average latency"
+                                      << metrics.averageLatency << "ms, max latency" << metrics.maxLatency << "ms, dropped frames" << metrics.droppedFrames;
+            }
+        }
+
+        encodingService.reset(); // wait the encoding threads to finish
     }
 
     {
         QMutexLocker locker(&encodersMutex);
         encoders.clear();
+        publishEncoders();
+        for (auto &activeGeneration : activeEncoderGenerations)
+            activeGeneration = 0;
     }
 
     {
-        QMutexLocker locker(&scheduledEventsMutex);
-        scheduledEvents.clear();
+        QMutexLocker locker(&scheduledChangesMutex); // the audio thread is not processing the changes when the controller is stopped
+        ScheduledChange change;
+        while (scheduledChanges.try_dequeue(change)) {
+            // discarding the changes
+        }
     }
 
     qCDebug(jtNinjamCore) << "NinjamController destructor - disconnecting...";
@@ -553,18 +396,23 @@ void NinjamController::start(const ServerInfo &server)
     preparedForTransmit = false; // the xmit start after the first interval is received
     emit preparingTransmission();
 
-    // schedule the encoders creation (one encoder for each channel)
+    // create the encoders (one encoder for each channel), the audio thread start using them in the first interval
     int channels = mainController->getInputTrackGroupsCount();
     for (int channelIndex = 0; channelIndex < channels; ++channelIndex) {
         bool voiceChannelActivated = mainController->isVoiceChatActivated(channelIndex);
         scheduleEncoderChangeForChannel(channelIndex, voiceChannelActivated);
     }
 
-    processScheduledChanges();
+    if (!running)
+        processScheduledChanges(); // the audio thread is not processing the changes yet, the initial bpm and bpi are applied now
 
     if (!running)
     {
-        encodingThread.reset(new NinjamController::EncodingThread(this));
+        auto handler = [this](quint8 channelIndex, const QByteArray &encodedData, bool firstPart, bool lastPart) {
+            emit encodedAudioAvailableToSend(encodedData, channelIndex, firstPart, lastPart);
+        };
+        encodingService.reset(new audio::EncodingService(handler, channels));
+        qCDebug(jtNinjamCore) << "Encoding" << channels << "channels using" << encodingService->getThreads() << "threads";
 
         // add a sine wave generator as input to test audio transmission
         // mainController->addInputTrackNode(new Audio::LocalInputTestStreamer(440, mainController->getAudioDriverSampleRate()));
@@ -683,12 +531,13 @@ void NinjamController::addTrack(const User &user, const UserChannel &channel)
         return;
 
     QString uniqueKey = getUniqueKeyForChannel(channel, user.getFullName());
-    auto trackNode = QSharedPointer<NinjamTrackNode>::create(generateNewTrackID());
+    auto trackNode = QSharedPointer<NinjamTrackNode>::create(generateNewTrackID(), mainController->getDecodingService());
 
     // checkThread("addTrack();");
     {
         QMutexLocker locker(&mutex);
         trackNodes.insert(uniqueKey, trackNode);
+        publishTrackNodes();
     } // release the mutex before emit the signal
 
     bool trackAdded = mainController->addTrack(trackNode->getID(), trackNode);
@@ -700,9 +549,15 @@ void NinjamController::addTrack(const User &user, const UserChannel &channel)
     {
         QMutexLocker locker(&mutex);
         trackNodes.remove(uniqueKey);
+        publishTrackNodes();
     }
 }
 
+void NinjamController::publishTrackNodes()
+{
+    trackNodesSnapshot.publish(trackNodes.values());
+}
+
 void NinjamController::removeTrack(const User &user, const UserChannel &channel)
 {
     QString uniqueKey = getUniqueKeyForChannel(channel, user.getFullName());
@@ -715,6 +570,7 @@ void NinjamController::removeTrack(const User &user, const UserChannel &channel)
         if (iterator != trackNodes.end()) {
             trackNodeId = iterator.value()->getID();
             trackNodes.erase(iterator);
+            publishTrackNodes();
         }
     }
 
@@ -781,14 +637,9 @@ void NinjamController::handleNewInterval()
     }
 
     processScheduledChanges();
+    activateScheduledEncoders();
 
-    QList<QSharedPointer<NinjamTrackNode>> trackNodesList;
-    {
-        QMutexLocker locker(&mutex);
-        trackNodesList = trackNodes.values();
-    }
-
-    for (const auto& track : qAsConst(trackNodesList)) {
+    for (const auto& track : trackNodesSnapshot.read()) {
         bool trackWasPlaying = track->isPlaying();
         bool trackIsPlaying = track->startNewInterval();
         if (trackWasPlaying != trackIsPlaying) {
@@ -803,14 +654,17 @@ void NinjamController::handleNewInterval()
 
 void NinjamController::processScheduledChanges()
 {
-    if (!scheduledEvents.isEmpty()) {
-        QList<QSharedPointer<SchedulableEvent>> events;
-        {
-            QMutexLocker locker(&scheduledEventsMutex);
-            std::swap(events, scheduledEvents);
-        }
-        for (const auto& event : qAsConst(events)) {
-            event->process();
+    ScheduledChange change;
+    while (scheduledChanges.try_dequeue(change)) { // lock-free, the changes are values and nothing is released here
+        switch (change.type) {
+        case ScheduledChange::BpiChange:
+            currentBpi = change.value;
+            samplesInInterval = computeTotalSamplesInInterval();
+            emit currentBpiChanged(currentBpi);
+            break;
+        case ScheduledChange::BpmChange:
+            setBpm(change.value);
+            break;
         }
     }
 }
@@ -868,24 +722,25 @@ void NinjamController::updateNinjamRemoteChannel(const User &user, const UserCha
     }
 }
 
-void NinjamController::scheduleEvent(QSharedPointer<SchedulableEvent>&& event) {
-    QMutexLocker locker(&scheduledEventsMutex);
-    scheduledEvents.append(std::move(event));
+void NinjamController::scheduleChange(ScheduledChange::Type type, quint16 value)
+{
+    QMutexLocker locker(&scheduledChangesMutex);
+    scheduledChanges.enqueue(ScheduledChange{type, value}); // the queue grows here, in main thread
 }
 
 void NinjamController::scheduleBpiChangeEvent(quint16 newBpi, quint16 oldBpi)
 {
     Q_UNUSED(oldBpi);
-    scheduleEvent(QSharedPointer<BpiChangeEvent>::create(this, newBpi));
+    scheduleChange(ScheduledChange::BpiChange, newBpi);
 }
 
 void NinjamController::scheduleBpmChangeEvent(quint16 newBpm)
 {
-    scheduleEvent(QSharedPointer<BpmChangeEvent>::create(this, newBpm));
+    scheduleChange(ScheduledChange::BpmChange, newBpm);
 }
 
 void NinjamController::handleIntervalCompleted(const User &user, quint8 channelIndex,
-                                               const QByteArray &encodedData)
+                                               const ninjam::ByteRope &encodedData)
 {
     if (mainController->isMultiTrackRecordingActivated())
     {
@@ -928,6 +783,7 @@ void NinjamController::reset()
             trackNodesList.append(iterator.value());
         }
         trackNodes.clear();
+        publishTrackNodes();
         intervalPosition = lastBeat = 0;
     }
     for (auto trackNode : trackNodesList) {
@@ -937,51 +793,94 @@ void NinjamController::reset()
 
 void NinjamController::scheduleEncoderChangeForChannel(int channelIndex, bool voiceChatActivated)
 {
-    scheduleEvent(QSharedPointer<InputChannelChangedEvent>::create(this, channelIndex, voiceChatActivated));
+    if (encodingService)
+        encodingService->reserveChannel(channelIndex); // new channels are allocated here, not in audio thread
+
+    QMutexLocker locker(&encodersMutex);
+    recreateEncoderForChannel(channelIndex, voiceChatActivated); // the encoder is allocated here, the audio thread switch to it in the next interval
+    publishEncoders();
 }
 
-QByteArray NinjamController::encode(const audio::SamplesBuffer &buffer, uint channelIndex, bool lastPart)
+audio::EncodingMetrics NinjamController::getEncodingMetrics(quint8 channelIndex) const
 {
-    QMutexLocker locker(&encodersMutex);
-    auto iterator = encoders.find(channelIndex);
-    if (iterator != encoders.end()) {
-        auto& encoder = iterator.value();
-        QByteArray encodedBytes(encoder->encode(buffer));
-        if (lastPart) {
-            encodedBytes.append(encoder->finishIntervalEncoding());
-        }
-        return encodedBytes;
-    }
-    return QByteArray();
+    if (encodingService)
+        return encodingService->getMetrics(channelIndex);
+
+    return audio::EncodingMetrics();
 }
 
 void NinjamController::recreateEncoderForChannel(int channelIndex, bool voiceChannelActivated)
 {
-    QMutexLocker locker(&encodersMutex);
     int maxChannelsForEncoding = mainController->getMaxAudioChannelsForEncoding(channelIndex);
     if (maxChannelsForEncoding <= 0) { // input track is setted as noInput?
         return;
     }
-    auto iterator = encoders.find(channelIndex);
-    if (iterator == encoders.end() || (iterator.value()->getChannels() != maxChannelsForEncoding ||
-                                       iterator.value()->getSampleRate() != mainController->getSampleRate())) {   // a new encoder is necessary?
-        int sampleRate = mainController->getSampleRate();
+
+    auto &channelEncoders = encoders[channelIndex];
+
+    // release the encoders older than the active encoder, the audio thread never go back to them
+    const quint32 activeGeneration = channelIndex < audio::EncodingService::MAX_CHANNELS ? activeEncoderGenerations[channelIndex].load() : 0;
+    while (!channelEncoders.isEmpty() && channelEncoders.first().generation < activeGeneration)
+        channelEncoders.removeFirst();
+
+    int sampleRate = mainController->getSampleRate();
+    if (channelEncoders.isEmpty() || (channelEncoders.last().encoder->getChannels() != maxChannelsForEncoding ||
+                                      channelEncoders.last().encoder->getSampleRate() != sampleRate)) {   // a new encoder is necessary?
         float encodingQuality = voiceChannelActivated ? vorbis::EncoderQualityLow : mainController->getEncodingQuality();
-        encoders[channelIndex] = QSharedPointer<vorbis::Encoder>::create(maxChannelsForEncoding, sampleRate, encodingQuality);
+        channelEncoders.append({QSharedPointer<vorbis::Encoder>::create(maxChannelsForEncoding, sampleRate, encodingQuality), ++lastEncoderGeneration});
     }
 }
 
+void NinjamController::publishEncoders()
+{
+    encodersSnapshot.publish(encoders); // the replaced encoders are released here, when the audio thread is not using them
+}
+
+void NinjamController::activateScheduledEncoders()
+{
+    const auto &currentEncoders = encodersSnapshot.read();
+    for (auto iterator = currentEncoders.constBegin(); iterator != currentEncoders.constEnd(); ++iterator) {
+        const int channelIndex = iterator.key();
+        if (channelIndex < audio::EncodingService::MAX_CHANNELS && !iterator.value().isEmpty())
+            activeEncoderGenerations[channelIndex].store(iterator.value().last().generation);
+    }
+}
+
+QSharedPointer<AudioEncoder> NinjamController::getEncoder(quint8 channelIndex) const
+{
+    if (channelIndex >= audio::EncodingService::MAX_CHANNELS)
+        return QSharedPointer<AudioEncoder>();
+
+    const auto &currentEncoders = encodersSnapshot.read(); // the snapshot is holding the encoders, the returned copy is never the last reference
+    auto iterator = currentEncoders.constFind(channelIndex);
+    if (iterator == currentEncoders.constEnd() || iterator.value().isEmpty())
+        return QSharedPointer<AudioEncoder>();
+
+    const auto &channelEncoders = iterator.value();
+    const quint32 activeGeneration = activeEncoderGenerations[channelIndex].load();
+    for (const auto &scheduledEncoder : channelEncoders) {
+        if (scheduledEncoder.generation == activeGeneration)
+            return scheduledEncoder.encoder;
+    }
+
+    // the active encoder was replaced without scheduling (encoders recreated after a sample rate change), or the channel is new and
+    // no interval was started yet. The oldest encoder is used until the next interval, so the encoder is not changed in the middle of an interval
+    return channelEncoders.first().encoder;
+}
+
 void NinjamController::recreateEncoders()
 {
     if (isRunning())
     {
-        QMutexLocker locker(&encodersMutex); // this method is called from main thread, and the encoders are used in audio thread every time
-        encoders.clear(); // new encoders will be create on demand
+        QMutexLocker locker(&encodersMutex); // this method is called from main thread, the audio thread is using the published snapshot
+        encoders.clear(); // the new encoders are used immediately
 
         int trackGroupsCount = mainController->getInputTrackGroupsCount();
         for (int channelIndex = 0; channelIndex < trackGroupsCount; ++channelIndex) {
             recreateEncoderForChannel(channelIndex, mainController->isVoiceChatActivated(channelIndex));
         }
+
+        publishEncoders();
     }
 }
 
@@ -1006,7 +905,7 @@ void NinjamController::handleIntervalDownloading(const User &user, quint8 channe
         QSharedPointer<NinjamTrackNode> track;
         {
             QMutexLocker locker(&mutex);
-            track = trackNodes[channelKey];
+            track = trackNodes.value(channelKey); // operator[] would insert a null track
         }
         if (track) {
             if (!track->isPlaying()) {   // track is not playing yet and receive the first interval bytes
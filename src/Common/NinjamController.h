@@ -8,6 +8,11 @@
 #include <QSharedPointer>
 
 #include "audio/Encoder.h"
+#include "audio/core/SamplesBuffer.h"
+#include "audio/core/SnapshotPublisher.h"
+#include "audio/EncodingService.h"
+#include "audio/readerwriterqueue.h"
+#include "ninjam/ByteRope.h"
 
 class NinjamTrackNode;
 
@@ -20,7 +25,6 @@ class UserChannel;
 namespace audio {
     class MetronomeTrackNode;
     class MidiSyncTrackNode;
-    class SamplesBuffer;
 }
 
 namespace controller {
@@ -68,9 +72,7 @@ public:
 
     void recreateEncoders();
 
-    QByteArray encode(const SamplesBuffer &buffer, uint channelIndex, bool lastPart);
-
-    void scheduleEncoderChangeForChannel(int channelIndex, bool voiceChatActivated);
+    void scheduleEncoderChangeForChannel(int channelIndex, bool voiceChatActivated); // the encoder is created now and used in the next interval
     void removeEncoder(int groupChannelIndex);
 
     void scheduleXmitChange(int channelID, bool transmiting);     // schedule the change for the next interval
@@ -91,6 +93,8 @@ public:
 
     QList<QSharedPointer<NinjamTrackNode>> getTrackNodes() const;
 
+    audio::EncodingMetrics getEncodingMetrics(quint8 channelIndex) const; // queue depth and encoding latency of a transmited channel
+
 signals:
     void currentBpiChanged(int newBpi);     // emitted when a scheduled bpi change is processed in interval start (first beat).
     void currentBpmChanged(int newBpm);
@@ -123,7 +127,10 @@ protected:
     long intervalPosition;
     long samplesInInterval;
 
-    QMap<QString, QSharedPointer<NinjamTrackNode>> trackNodes;     // the other users channels
+    QMap<QString, QSharedPointer<NinjamTrackNode>> trackNodes;     // the other users channels, protected by mutex
+    audio::SnapshotPublisher<QList<QSharedPointer<NinjamTrackNode>>> trackNodesSnapshot; // trackNodes values used in audio thread
+
+    void publishTrackNodes(); // called with the mutex locked
 
     MainController *mainController;
 
@@ -136,20 +143,19 @@ private:
     void addTrack(const User &user, const UserChannel &channel);
     void removeTrack(const User &user, const UserChannel &channel);
 
-    bool running;
+    std::atomic<bool> running;
     int lastBeat;
 
     int currentBpi;
     int currentBpm;
 
-    QMutex mutex;
-    QMutex encodersMutex;
+    QMutex mutex; // protect trackNodes, never locked in audio thread
+    QMutex encodersMutex; // protect the encoders map, never locked in audio thread
 
     long computeTotalSamplesInInterval();
     long getSamplesPerBeat();
 
-    void processScheduledChanges();
-    bool hasScheduledChanges() const;
+    void processScheduledChanges(); // called from audio thread
 
     static std::atomic<int> trackIds;
 
@@ -157,39 +163,62 @@ private:
 
     QSharedPointer<MetronomeTrackNode> createMetronomeTrackNode(int sampleRate);
 
-    QMap<int, QSharedPointer<AudioEncoder>> encoders;
-    AudioEncoder *getEncoder(quint8 channelIndex);
+    struct ScheduledEncoder
+    {
+        QSharedPointer<AudioEncoder> encoder;
+        quint32 generation; // the audio thread switch to the last generation in the first beat of each interval
+    };
+
+    typedef QMap<int, QList<ScheduledEncoder>> EncodersMap; // the encoders of each channel, the last one is the newest
+
+    EncodersMap encoders; // created in main thread, protected by encodersMutex
+    audio::SnapshotPublisher<EncodersMap> encodersSnapshot; // the encoders map used in audio thread
+    quint32 lastEncoderGeneration;
+    std::atomic<quint32> activeEncoderGenerations[audio::EncodingService::MAX_CHANNELS]; // written by audio thread, read in main thread to release the old encoders
+
+    QSharedPointer<AudioEncoder> getEncoder(quint8 channelIndex) const; // called from audio thread
+    void activateScheduledEncoders(); // called from audio thread in the first beat of each interval
 
     void handleNewInterval();
-    void recreateEncoderForChannel(int channelIndex, bool voiceChannelActivated);
+    void recreateEncoderForChannel(int channelIndex, bool voiceChannelActivated); // called with encodersMutex locked
+    void publishEncoders(); // called with encodersMutex locked
 
     void setXmitStatus(int channelID, bool transmiting);
 
-    // ++++++++++++++++++++ nested classes to handle scheduled events +++++++++++++++++
+    struct ScheduledChange // bpi and bpm changes, processed in the first beat of the next interval
+    {
+        enum Type
+        {
+            BpiChange,
+            BpmChange
+        };
+
+        Type type;
+        quint16 value;
+    };
 
-    class SchedulableEvent;     // the interface for all events
-    class BpiChangeEvent;
-    class BpmChangeEvent;
-    class InputChannelChangedEvent;    // user change the channel input selection from mono to stereo or vice-versa, or user added a new channel, both cases requires a new encoder in next interval
-    QList<QSharedPointer<SchedulableEvent>> scheduledEvents;
-    QMutex scheduledEventsMutex;
+    moodycamel::ReaderWriterQueue<ScheduledChange> scheduledChanges; // main thread -> audio thread, no locks and no memory allocations in audio thread
+    QMutex scheduledChangesMutex; // serialize the producers, never locked in audio thread
 
-    class EncodingThread;
+    QScopedPointer<audio::EncodingService> encodingService;
 
-    QScopedPointer<EncodingThread> encodingThread;
+    // buffers reused in every process() call, preallocated to avoid memory allocations in audio thread
+    SamplesBuffer tempInBuffer;
+    SamplesBuffer tempOutBuffer;
+    SamplesBuffer inputMixBuffer;
 
     bool preparedForTransmit;
     int waitingIntervals;
     static const int TOTAL_PREPARED_INTERVALS = 2;     // how many intervals Jamtaba will wait to start trasmiting?
 
-    void scheduleEvent(QSharedPointer<SchedulableEvent>&& event);
+    void scheduleChange(ScheduledChange::Type type, quint16 value);
 
 private slots:
     // ninjam events
     void scheduleBpmChangeEvent(quint16 newBpm);
     void scheduleBpiChangeEvent(quint16 newBpi, quint16 oldBpi);
     void handleIntervalCompleted(const ninjam::client::User &user, quint8 channelIndex,
-                                 const QByteArray &encodedAudioData);
+                                 const ninjam::ByteRope &encodedAudioData);
     void handleIntervalDownloading(const ninjam::client::User &user, quint8 channelIndex, const QByteArray &encodedAudio, bool isFirstPart, bool isLastPart);
     void addNinjamRemoteChannel(const ninjam::client::User &user, const ninjam::client::UserChannel &channel);
     void removeNinjamRemoteChannel(const ninjam::client::User &user, const ninjam::client::UserChannel &channel);
@@ -0,0 +1,167 @@
+#include "DecodingService.h"
+
+#include <QThread>
+#include <QElapsedTimer>
+#include <QMutexLocker>
+
+#include "IntervalDecoder.h"
+#include "core/SnapshotPublisher.h"
+#include "log/Logging.h"
+
+using audio::DecodingService;
+using audio::IntervalDecoder;
+using audio::SnapshotReadSection;
+
+namespace {
+
+const uint DECODING_CHUNK_SIZE = 2048; // frames decoded in each step, small chunks to switch fast to the decoders with less buffered audio
+const uint LOOK_AHEAD_SAMPLE_RATE = 48000; // used to convert the look-ahead milliseconds in frames
+const unsigned long IDLE_TIME = 5; // milliseconds, the audio thread is consuming frames without notify the decoding thread
+const qint64 UNDERRUNS_REPORT_INTERVAL = 5000; // milliseconds
+
+} // namespace
+
+class DecodingService::Thread : public QThread
+{
+public:
+    explicit Thread(DecodingService *service) :
+        service(service)
+    {
+        setObjectName("Decoding service");
+    }
+
+protected:
+    void run() override
+    {
+        service->run();
+    }
+
+private:
+    DecodingService *service;
+};
+
+// +++++++++++++++++++++++++++++++++++++++
+
+DecodingService::DecodingService() :
+    stopRequested(false),
+    lookAhead(DEFAULT_DECODING_LOOK_AHEAD),
+    playbackSampleRate(0),
+    thread(new Thread(this))
+{
+    thread->start(QThread::HighPriority);
+}
+
+DecodingService::~DecodingService()
+{
+    {
+        QMutexLocker locker(&mutex);
+        stopRequested = true;
+        wakeCondition.wakeAll();
+    }
+
+    thread->wait();
+}
+
+void DecodingService::setLookAhead(int milliseconds)
+{
+    milliseconds = qBound(MIN_DECODING_LOOK_AHEAD, milliseconds, MAX_DECODING_LOOK_AHEAD);
+    lookAhead = milliseconds;
+
+    qCDebug(jtAudio) << "Decoding" << milliseconds << "ms ahead of the playback";
+}
+
+std::shared_ptr<IntervalDecoder> DecodingService::createDecoder(const ninjam::ByteRope &vorbisData, bool inputComplete)
+{
+    const uint lookAheadFrames = static_cast<uint>(lookAhead) * LOOK_AHEAD_SAMPLE_RATE / 1000;
+    auto decoder = std::make_shared<IntervalDecoder>(lookAheadFrames, vorbisData, inputComplete);
+
+    QMutexLocker locker(&mutex);
+    decoders.append(decoder);
+    wakeCondition.wakeAll();
+
+    return decoder;
+}
+
+void DecodingService::wakeUp()
+{
+    QMutexLocker locker(&mutex);
+    wakeCondition.wakeAll();
+}
+
+std::shared_ptr<IntervalDecoder> DecodingService::findNextDecoder(QList<std::shared_ptr<IntervalDecoder>> &releasedDecoders)
+{
+    std::shared_ptr<IntervalDecoder> nextDecoder;
+
+    for (int i = decoders.size() - 1; i >= 0; --i) {
+        const auto &decoder = decoders.at(i);
+        if (decoder.use_count() == 1) { // only the service is using this decoder (played, discarded or track removed)
+            releasedDecoders.append(decoders.takeAt(i));
+            continue;
+        }
+
+        const bool needsTables = needsResamplerTables(*decoder); // the audio thread can't play the interval without the table
+        if (needsTables || decoder->needsDecoding()) {
+            if (!nextDecoder || needsTables || decoder->getBufferedFrames() < nextDecoder->getBufferedFrames())
+                nextDecoder = decoder;
+        }
+    }
+
+    return nextDecoder;
+}
+
+bool DecodingService::needsResamplerTables(const IntervalDecoder &decoder) const
+{
+    const int targetSampleRate = playbackSampleRate.load(std::memory_order_relaxed);
+    if (targetSampleRate <= 0 || !decoder.isInitialized() || decoder.getSampleRate() == targetSampleRate)
+        return false;
+
+    return !Resampler::hasTables(decoder.getSampleRate(), targetSampleRate, DECODED_INTERVALS_RESAMPLER_QUALITY);
+}
+
+void DecodingService::run()
+{
+    QList<std::shared_ptr<IntervalDecoder>> releasedDecoders;
+    uint underruns = 0;
+    QElapsedTimer reportTimer;
+    reportTimer.start();
+
+    forever {
+        std::shared_ptr<IntervalDecoder> decoder;
+        {
+            QMutexLocker locker(&mutex);
+            if (stopRequested)
+                break;
+
+            decoder = findNextDecoder(releasedDecoders);
+            if (!decoder && releasedDecoders.isEmpty())
+                wakeCondition.wait(&mutex, IDLE_TIME);
+        }
+
+        if (!releasedDecoders.isEmpty()) {
+            for (const auto &releasedDecoder : qAsConst(releasedDecoders))
+                underruns += releasedDecoder->takeUnderruns();
+
+            SnapshotReadSection::waitForReaders(); // other threads can be reading the current decoder of a track (NinjamTrackNode::isStereo, etc.)
+            releasedDecoders.clear(); // deleting the decoders out of the lock
+        }
+
+        if (decoder) {
+            underruns += decoder->takeUnderruns();
+            decoder->decodeAhead(DECODING_CHUNK_SIZE);
+
+            if (needsResamplerTables(*decoder)) // the first decoded frames are initializing the decoder
+                Resampler::prepareTables(decoder->getSampleRate(), playbackSampleRate.load(), DECODED_INTERVALS_RESAMPLER_QUALITY);
+        }
+
+        if (reportTimer.elapsed() >= UNDERRUNS_REPORT_INTERVAL) {
+            if (underruns > 0)
+                qCWarning(jtAudio) << "Decoding thread is late," << underruns << "audio callbacks without decoded frames";
+
+            underruns = 0;
+            reportTimer.restart();
+        }
+    }
+
+    QMutexLocker locker(&mutex);
+    decoders.clear();
+}
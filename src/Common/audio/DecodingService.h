@@ -0,0 +1,84 @@
+#ifndef DECODING_SERVICE_H
+#define DECODING_SERVICE_H
+
+#include <QMutex>
+#include <QWaitCondition>
+#include <QList>
+#include <QScopedPointer>
+#include <QByteArray>
+#include "ninjam/ByteRope.h"
+#include "Resampler.h"
+#include <memory>
+#include <atomic>
+
+namespace audio {
+
+class IntervalDecoder;
+
+const int MIN_DECODING_LOOK_AHEAD = 50; // in milliseconds
+const int MAX_DECODING_LOOK_AHEAD = 10000;
+const int DEFAULT_DECODING_LOOK_AHEAD = 1000;
+const ResamplerQuality DECODED_INTERVALS_RESAMPLER_QUALITY = ResamplerQuality::Medium; // used by the tracks to play the decoded intervals
+
+/**
+    A dedicated thread decoding the downloaded ninjam intervals ahead of the playback, so the
+    vorbis decoding cost is not paid in the audio callback (mainly in the first beat of
+    the intervals, when all tracks start a new interval at same time).
+
+    Every decoder keep 'look-ahead' milliseconds of decoded audio in a ring buffer. The decoders
+    with less buffered audio are decoded first. The service keep a reference to the decoders
+    and release them when nobody else is using them, so the decoders are not deleted in audio thread.
+
+    The resampler tables for the intervals sample rate (and the playback sample rate) are computed
+    in the decoding thread when the decoders are initialized, the tracks only look up the tables.
+*/
+
+class DecodingService
+{
+public:
+    DecodingService();
+    ~DecodingService();
+
+    std::shared_ptr<IntervalDecoder> createDecoder(const ninjam::ByteRope &vorbisData, bool inputComplete);
+
+    void wakeUp(); // more encoded data available (voice chat chunks)
+
+    void setLookAhead(int milliseconds); // used in the next created decoders
+    int getLookAhead() const;
+
+    void setPlaybackSampleRate(int sampleRate); // lock-free, called by the tracks in audio thread
+
+private:
+    Q_DISABLE_COPY(DecodingService)
+
+    class Thread;
+
+    void run();
+    std::shared_ptr<IntervalDecoder> findNextDecoder(QList<std::shared_ptr<IntervalDecoder>> &releasedDecoders); // called with the mutex locked, the unused decoders are moved to releasedDecoders
+    bool needsResamplerTables(const IntervalDecoder &decoder) const;
+
+    QList<std::shared_ptr<IntervalDecoder>> decoders;
+
+    QMutex mutex; // protect the decoders list, never locked in audio thread
+    QWaitCondition wakeCondition;
+    bool stopRequested;
+
+    std::atomic<int> lookAhead;
+    std::atomic<int> playbackSampleRate; // zero until the first track report the sample rate
+
+    QScopedPointer<Thread> thread;
+};
+
+inline int DecodingService::getLookAhead() const
+{
+    return lookAhead;
+}
+
+inline void DecodingService::setPlaybackSampleRate(int sampleRate)
+{
+    playbackSampleRate.store(sampleRate, std::memory_order_relaxed);
+}
+
+} // namespace
+
+#endif // DECODING_SERVICE_H
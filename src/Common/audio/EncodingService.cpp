@@ -0,0 +1,376 @@
+#include "EncodingService.h"
+
+#include <QThread>
+
+#include "audio/Encoder.h"
+#include "audio/core/SamplesRingBuffer.h"
+#include "audio/readerwriterqueue.h"
+
+using audio::EncodingService;
+using audio::EncodingMetrics;
+using audio::SamplesBuffer;
+using audio::SamplesRingBuffer;
+
+namespace {
+
+const int MAX_THREADS = 4;
+const uint RING_CAPACITY = 1 << 16; // frames per channel, more than 1 second of encoding delay
+const int MAX_MARKERS = 64; // per channel
+const qint64 LATENCY_SMOOTHING = 16; // the average latency is a moving average, the last block has weight 1/16
+
+} // namespace
+
+const uint EncodingService::ENCODING_BLOCK_SIZE = 1024;
+
+struct EncodingService::Marker
+{
+    enum Type
+    {
+        EncoderChange, // a new interval or a new encoder
+        IntervalEnd
+    };
+
+    Type type = EncoderChange;
+    uint frame = 0; // position in channel samples stream, the marker is processed when all frames before this position are encoded
+    QSharedPointer<AudioEncoder> encoder; // released by the workers, not in audio thread
+    bool firstPart = false;
+};
+
+// +++++++++++++++++++++++++++++++++++++++
+
+class EncodingService::Channel
+{
+public:
+    Channel() :
+        ring(2, RING_CAPACITY),
+        markers(MAX_MARKERS),
+        producedFrames(0),
+        lastEncoder(nullptr),
+        intervalEndPending(false),
+        intervalEndFrame(0),
+        block(2),
+        consumedFrames(0),
+        firstPartPending(false),
+        pendingRequests(0),
+        writeTimestamp(0),
+        averageLatency(0),
+        maxLatency(0),
+        encodedBlocks(0),
+        droppedFrames(0)
+    {
+        block.reserve(ENCODING_BLOCK_SIZE);
+    }
+
+    SamplesRingBuffer ring; // audio thread -> workers
+    moodycamel::ReaderWriterQueue<Marker> markers; // audio thread -> workers
+
+    bool enqueueIntervalEnd(); // called from audio thread, return false if the markers queue is full
+
+    // used only in audio thread
+    uint producedFrames;
+    AudioEncoder *lastEncoder; // just to detect encoder changes, the markers are holding the encoders
+    bool intervalEndPending; // the interval end marker was not enqueued yet, the queue was full
+    uint intervalEndFrame;
+
+    // used only by the worker encoding this channel
+    SamplesBuffer block;
+    QSharedPointer<AudioEncoder> encoder;
+    uint consumedFrames;
+    bool firstPartPending; // the first encoded data of the interval is not sent yet
+
+    std::atomic<int> pendingRequests; // incremented after each write, the channel is scheduled when this counter leaves zero
+    std::atomic<qint64> writeTimestamp;
+
+    std::atomic<qint64> averageLatency; // nanoseconds
+    std::atomic<qint64> maxLatency;
+    std::atomic<quint64> encodedBlocks;
+    std::atomic<quint64> droppedFrames;
+};
+
+bool EncodingService::Channel::enqueueIntervalEnd()
+{
+    Marker marker;
+    marker.type = Marker::IntervalEnd;
+    marker.frame = intervalEndFrame;
+    if (!markers.try_enqueue(std::move(marker))) // preallocated queue, no allocation
+        return false;
+
+    intervalEndPending = false;
+    return true;
+}
+
+// +++++++++++++++++++++++++++++++++++++++
+
+class EncodingService::Worker : public QThread
+{
+public:
+    Worker(EncodingService *service, int index) :
+        service(service)
+    {
+        setObjectName(QString("Encoding worker %1").arg(index));
+    }
+
+protected:
+    void run() override
+    {
+        service->run();
+    }
+
+private:
+    EncodingService *service;
+};
+
+// +++++++++++++++++++++++++++++++++++++++
+
+EncodingService::EncodingService(const EncodedDataHandler &handler, int reservedChannels, int threads) :
+    handler(handler),
+    readyChannels(0),
+    stopRequested(false)
+{
+    for (int c = 0; c < MAX_CHANNELS; ++c)
+        channels[c] = c < reservedChannels ? new Channel() : nullptr;
+
+    clock.start();
+
+    threads = qBound(1, threads, MAX_THREADS);
+    for (int t = 0; t < threads; ++t) {
+        auto worker = new Worker(this, t);
+        workers.append(worker);
+        worker->start();
+    }
+}
+
+EncodingService::~EncodingService()
+{
+    stopRequested = true;
+    notifier.notifyAll(workers.size());
+
+    for (auto worker : workers) {
+        worker->wait();
+        delete worker;
+    }
+
+    for (auto &channel : channels)
+        delete channel.load();
+}
+
+int EncodingService::getDefaultThreads()
+{
+    return qBound(1, QThread::idealThreadCount() / 2, MAX_THREADS); // the other cores are used by audio and GUI threads
+}
+
+void EncodingService::reserveChannel(quint8 channelIndex)
+{
+    if (channelIndex < MAX_CHANNELS && !channels[channelIndex].load())
+        channels[channelIndex] = new Channel(); // published to audio thread, the ring is not allocated in audio thread
+}
+
+void EncodingService::addSamplesToEncode(const SamplesBuffer &samples, quint8 channelIndex, QSharedPointer<AudioEncoder> encoder, bool firstPart, bool lastPart)
+{
+    if (samples.isEmpty() || !encoder || channelIndex >= MAX_CHANNELS)
+        return;
+
+    auto channel = channels[channelIndex].load();
+    if (!channel)
+        return; // channel not reserved
+
+    if (channel->intervalEndPending && !channel->enqueueIntervalEnd()) { // the end of the previous interval is always enqueued before the next samples
+        channel->droppedFrames += samples.getFrameLenght();
+        return;
+    }
+
+    if (firstPart || encoder.data() != channel->lastEncoder) {
+        Marker marker;
+        marker.type = Marker::EncoderChange;
+        marker.frame = channel->producedFrames;
+        marker.firstPart = firstPart;
+        channel->lastEncoder = encoder.data();
+        marker.encoder.swap(encoder);
+        if (!channel->markers.try_enqueue(std::move(marker))) { // preallocated queue, no allocation
+            channel->lastEncoder = nullptr; // trying again in the next samples
+            channel->droppedFrames += samples.getFrameLenght();
+            return;
+        }
+    }
+
+    const uint writtenFrames = channel->ring.write(samples);
+    channel->producedFrames += writtenFrames;
+    if (writtenFrames < samples.getFrameLenght())
+        channel->droppedFrames += samples.getFrameLenght() - writtenFrames;
+
+    if (lastPart) {
+        channel->intervalEndPending = true;
+        channel->intervalEndFrame = channel->producedFrames;
+        channel->enqueueIntervalEnd(); // if the queue is full the marker is enqueued in the next call, the interval is finished a little later
+    }
+
+    channel->writeTimestamp.store(clock.nsecsElapsed(), std::memory_order_relaxed);
+
+    if (channel->pendingRequests.fetch_add(1) == 0) // the channel is not waiting for a worker and no worker is encoding it
+        schedule(channelIndex);
+}
+
+void EncodingService::schedule(int channelIndex)
+{
+    readyChannels.fetch_or(1u << channelIndex);
+    notifier.notify();
+}
+
+int EncodingService::takeReadyChannel(int &firstChannel)
+{
+    quint32 ready = readyChannels.load();
+    while (ready) {
+        int channelIndex = -1;
+        for (int c = 0; c < MAX_CHANNELS; ++c) { // round robin, the first channels are not always preferred
+            const int index = (firstChannel + c) % MAX_CHANNELS;
+            if (ready & (1u << index)) {
+                channelIndex = index;
+                break;
+            }
+        }
+
+        if (readyChannels.compare_exchange_weak(ready, ready & ~(1u << channelIndex))) {
+            firstChannel = (channelIndex + 1) % MAX_CHANNELS;
+            return channelIndex;
+        }
+    }
+
+    return -1;
+}
+
+void EncodingService::run()
+{
+    int firstChannel = 0;
+
+    while (!stopRequested) {
+        const int channelIndex = takeReadyChannel(firstChannel);
+        if (channelIndex >= 0) {
+            encodeChannel(channelIndex);
+            continue;
+        }
+
+        notifier.waitUntil([this]() {
+            return readyChannels.load() != 0 || stopRequested.load();
+        });
+    }
+}
+
+void EncodingService::encodeChannel(int channelIndex)
+{
+    auto &channel = *channels[channelIndex].load();
+
+    // only one worker is encoding this channel, the blocks are encoded in order and the metrics have just one writer
+    int requests = channel.pendingRequests.load();
+    forever {
+        const qint64 timestamp = channel.writeTimestamp.load(std::memory_order_relaxed);
+        while (encodeNextBlock(channel, static_cast<quint8>(channelIndex), timestamp)) {
+        }
+
+        const int previousRequests = channel.pendingRequests.fetch_sub(requests);
+        if (previousRequests == requests)
+            return; // the next write will schedule the channel again
+
+        requests = previousRequests - requests; // samples written while encoding
+    }
+}
+
+bool EncodingService::encodeNextBlock(Channel &channel, quint8 channelIndex, qint64 timestamp)
+{
+    // the available frames are read before the markers, a marker is always enqueued before the frames after it
+    const uint availableFrames = channel.ring.getAvailableFrames();
+    const Marker *marker = channel.markers.peek();
+
+    uint frames = qMin(availableFrames, ENCODING_BLOCK_SIZE);
+    if (marker) {
+        const uint framesToMarker = marker->frame - channel.consumedFrames;
+        if (framesToMarker == 0) {
+            processMarker(channel, channelIndex);
+            return true;
+        }
+
+        frames = qMin(frames, framesToMarker); // the last block before a marker can be smaller
+    }
+    else if (frames < ENCODING_BLOCK_SIZE) {
+        return false; // waiting for a complete block
+    }
+
+    if (frames == 0)
+        return false;
+
+    if (channel.encoder && channel.encoder->getChannels() == 1)
+        channel.block.setToMono();
+    else
+        channel.block.setToStereo();
+
+    channel.block.setFrameLenght(frames);
+    channel.ring.read(channel.block, frames);
+    channel.consumedFrames += frames;
+
+    if (!channel.encoder)
+        return true; // samples without encoder are discarded
+
+    QByteArray encodedData(channel.encoder->encode(channel.block));
+
+    bool lastPart = false;
+    marker = channel.markers.peek();
+    if (marker && marker->type == Marker::IntervalEnd && marker->frame == channel.consumedFrames) {
+        encodedData.append(channel.encoder->finishIntervalEncoding()); // the last block and the interval end are sent together
+        channel.markers.pop();
+        lastPart = true;
+    }
+
+    const qint64 latency = clock.nsecsElapsed() - timestamp;
+    const qint64 average = channel.averageLatency.load(std::memory_order_relaxed);
+    channel.averageLatency.store(average + (latency - average) / LATENCY_SMOOTHING, std::memory_order_relaxed);
+    if (latency > channel.maxLatency.load(std::memory_order_relaxed))
+        channel.maxLatency.store(latency, std::memory_order_relaxed);
+
+    channel.encodedBlocks++;
+
+    sendEncodedData(channel, channelIndex, encodedData, lastPart);
+
+    return true;
+}
+
+void EncodingService::processMarker(Channel &channel, quint8 channelIndex)
+{
+    Marker marker;
+    channel.markers.try_dequeue(marker);
+
+    if (marker.type == Marker::EncoderChange) {
+        channel.encoder.swap(marker.encoder); // the previous encoder is released here, in the worker thread
+        if (marker.firstPart)
+            channel.firstPartPending = true;
+    }
+    else if (channel.encoder) {
+        sendEncodedData(channel, channelIndex, channel.encoder->finishIntervalEncoding(), true);
+    }
+}
+
+void EncodingService::sendEncodedData(Channel &channel, quint8 channelIndex, const QByteArray &encodedData, bool lastPart)
+{
+    if (encodedData.isEmpty())
+        return; // the encoder is buffering, the 'first part' flag is sent with the first data
+
+    handler(channelIndex, encodedData, channel.firstPartPending, lastPart);
+    channel.firstPartPending = false;
+}
+
+EncodingMetrics EncodingService::getMetrics(quint8 channelIndex) const
+{
+    EncodingMetrics metrics;
+    if (channelIndex >= MAX_CHANNELS)
+        return metrics;
+
+    const auto channel = channels[channelIndex].load();
+    if (!channel)
+        return metrics;
+
+    metrics.queuedFrames = channel->ring.getAvailableFrames();
+    metrics.averageLatency = channel->averageLatency.load() / 1000000.0;
+    metrics.maxLatency = channel->maxLatency.load() / 1000000.0;
+    metrics.encodedBlocks = channel->encodedBlocks.load();
+    metrics.droppedFrames = channel->droppedFrames.load();
+
+    return metrics;
+}
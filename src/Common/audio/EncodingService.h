@@ -0,0 +1,97 @@
+#ifndef ENCODING_SERVICE_H
+#define ENCODING_SERVICE_H
+
+#include <QList>
+#include <QByteArray>
+#include <QSharedPointer>
+#include <QElapsedTimer>
+#include <functional>
+#include <atomic>
+
+#include "audio/core/SamplesBuffer.h"
+#include "audio/core/WakeupNotifier.h"
+
+class AudioEncoder;
+
+namespace audio {
+
+struct EncodingMetrics
+{
+    uint queuedFrames = 0; // frames waiting to be encoded
+    double averageLatency = 0; // ms, from the audio thread to the encoded data
+    double maxLatency = 0; // ms
+    quint64 encodedBlocks = 0;
+    quint64 droppedFrames = 0; // the encoding is too slow and the ring is full
+};
+
+/**
+    Encode the transmited channels in a pool of threads. Each channel is a pipeline: the samples
+    of the same channel are encoded one block at a time and in order (the vorbis stream of a
+    channel is sequential), but different channels are encoded in parallel, so a slow channel is
+    not delaying the others.
+
+    The audio thread write the samples in a preallocated ring per channel (wait-free, no locks
+    and no memory allocations) and the workers drain the rings in blocks of ENCODING_BLOCK_SIZE
+    frames. The interval boundaries and the encoder changes are sent in a small queue of markers,
+    so the last block of an interval is encoded even when it is smaller than a block.
+*/
+
+class EncodingService
+{
+public:
+    typedef std::function<void(quint8 channelIndex, const QByteArray &encodedData, bool firstPart, bool lastPart)> EncodedDataHandler;
+
+    explicit EncodingService(const EncodedDataHandler &handler, int reservedChannels, int threads = getDefaultThreads());
+    ~EncodingService();
+
+    void reserveChannel(quint8 channelIndex); // allocate the channel ring, called from main thread
+
+    // called from audio thread
+    void addSamplesToEncode(const SamplesBuffer &samples, quint8 channelIndex, QSharedPointer<AudioEncoder> encoder, bool firstPart, bool lastPart);
+
+    EncodingMetrics getMetrics(quint8 channelIndex) const;
+
+    int getThreads() const;
+
+    static int getDefaultThreads();
+
+    static const int MAX_CHANNELS = 32;
+    static const uint ENCODING_BLOCK_SIZE; // frames, the samples are encoded in blocks with this size
+
+private:
+    Q_DISABLE_COPY(EncodingService)
+
+    struct Marker;
+    class Channel;
+    class Worker;
+
+    void run(); // workers loop
+    int takeReadyChannel(int &firstChannel);
+    void encodeChannel(int channelIndex);
+    bool encodeNextBlock(Channel &channel, quint8 channelIndex, qint64 timestamp); // return false when there is no complete block to encode
+    void processMarker(Channel &channel, quint8 channelIndex);
+    void sendEncodedData(Channel &channel, quint8 channelIndex, const QByteArray &encodedData, bool lastPart);
+    void schedule(int channelIndex);
+
+    EncodedDataHandler handler;
+
+    std::atomic<Channel *> channels[MAX_CHANNELS]; // created in main thread, deleted only in destructor
+
+    std::atomic<quint32> readyChannels; // one bit for each channel with samples to encode and without a worker
+    std::atomic<bool> stopRequested;
+
+    WakeupNotifier notifier; // the audio thread is never blocked waking up the workers
+
+    QElapsedTimer clock; // latency metrics
+
+    QList<Worker *> workers;
+};
+
+inline int EncodingService::getThreads() const
+{
+    return workers.size();
+}
+
+} // namespace
+
+#endif // ENCODING_SERVICE_H
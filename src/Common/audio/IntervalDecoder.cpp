@@ -0,0 +1,124 @@
+#include "IntervalDecoder.h"
+
+#include <QMutexLocker>
+
+using audio::IntervalDecoder;
+using audio::SamplesBuffer;
+
+namespace {
+
+/** Incomplete inputs (voice chat chunks) are decoded only when this amount of encoded bytes is
+    available, otherwise vorbisfile can read the end of the received data and report EOF before
+    the next chunks arrive. */
+const int MIN_PENDING_INPUT_BYTES = 2048;
+
+} // namespace
+
+IntervalDecoder::IntervalDecoder(uint lookAheadFrames, const ninjam::ByteRope &vorbisData, bool inputComplete) :
+    inputComplete(inputComplete),
+    decodedFrames(2, lookAheadFrames), // vorbis decoder output is always stereo
+    initialized(false),
+    finished(false),
+    valid(true),
+    sampleRate(44100),
+    stereo(false),
+    underruns(0)
+{
+    vorbisDecoder.setInputData(vorbisData);
+}
+
+void IntervalDecoder::addEncodedData(const QByteArray &vorbisData)
+{
+    QMutexLocker locker(&mutex);
+    vorbisDecoder.addInputData(vorbisData);
+}
+
+void IntervalDecoder::setInputComplete()
+{
+    QMutexLocker locker(&mutex);
+    inputComplete = true;
+}
+
+void IntervalDecoder::stopDecoding()
+{
+    QMutexLocker locker(&mutex);
+    vorbisDecoder.setInputData(ninjam::ByteRope()); // empty data
+    inputComplete = true;
+}
+
+bool IntervalDecoder::needsDecoding()
+{
+    if (finished || !valid || decodedFrames.getFreeFrames() == 0)
+        return false;
+
+    QMutexLocker locker(&mutex);
+    return inputComplete || vorbisDecoder.getPendingInputBytes() >= MIN_PENDING_INPUT_BYTES;
+}
+
+uint IntervalDecoder::decodeAhead(uint maxFrames)
+{
+    QMutexLocker locker(&mutex);
+
+    if (!inputComplete && vorbisDecoder.getPendingInputBytes() < MIN_PENDING_INPUT_BYTES)
+        return 0;
+
+    const uint framesToDecode = qMin(maxFrames, decodedFrames.getFreeFrames());
+    if (framesToDecode == 0)
+        return 0;
+
+    const uint writtenFrames = decodedFrames.write(decode(framesToDecode));
+
+    finished = vorbisDecoder.isFinished(); // set only after the last frames are written in the ring
+
+    return writtenFrames;
+}
+
+const SamplesBuffer &IntervalDecoder::decode(uint maxFrames)
+{
+    const auto &decodedSamples = vorbisDecoder.decode(static_cast<int>(maxFrames));
+
+    if (!initialized && vorbisDecoder.isInitialized()) {
+        sampleRate = vorbisDecoder.getSampleRate();
+        stereo = vorbisDecoder.isStereo();
+        initialized = true;
+    }
+
+    valid = vorbisDecoder.isValid();
+
+    return decodedSamples;
+}
+
+uint IntervalDecoder::getDecodedSamples(SamplesBuffer &outBuffer, uint samplesToDecode)
+{
+    outBuffer.setFrameLenght(samplesToDecode);
+
+    uint totalSamples = decodedFrames.read(outBuffer, samplesToDecode);
+
+    if (totalSamples < samplesToDecode && valid && !finished) { // the decoding thread is late, or was not started yet for this interval
+        if (mutex.tryLock()) { // never waiting in audio thread, if the decoding thread is decoding this interval the next callback will have more frames
+            totalSamples += decodedFrames.read(outBuffer, samplesToDecode - totalSamples, totalSamples); // frames written before the lock
+
+            if (inputComplete || vorbisDecoder.getPendingInputBytes() >= MIN_PENDING_INPUT_BYTES) {
+                while (totalSamples < samplesToDecode) { // decoding in audio thread (the decoder is initialized here if necessary), the same behavior before the pre decoding
+                    const auto &decodedSamples = decode(samplesToDecode - totalSamples);
+                    if (decodedSamples.isEmpty())
+                        break; // no more samples to decode
+
+                    outBuffer.set(decodedSamples, 0, decodedSamples.getFrameLenght(), totalSamples);
+                    totalSamples += decodedSamples.getFrameLenght();
+                }
+
+                finished = vorbisDecoder.isFinished(); // the last frames are already copied in outBuffer
+            }
+
+            mutex.unlock();
+        }
+
+        if (totalSamples < samplesToDecode && !finished)
+            underruns++;
+    }
+
+    outBuffer.setFrameLenght(totalSamples);
+
+    return totalSamples;
+}
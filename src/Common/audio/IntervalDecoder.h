@@ -0,0 +1,107 @@
+#ifndef INTERVAL_DECODER_H
+#define INTERVAL_DECODER_H
+
+#include <QMutex>
+#include <QByteArray>
+#include <atomic>
+
+#include "audio/core/SamplesRingBuffer.h"
+#include "audio/vorbis/VorbisDecoder.h"
+
+namespace audio {
+
+/**
+    Decode one downloaded ninjam interval (or one voice chat chunk sequence). The DecodingService
+    thread decode ahead of the playback into a ring buffer, the audio thread only copy the decoded
+    frames in getDecodedSamples().
+
+    Threads:
+        GUI thread: addEncodedData(), setInputComplete(), stopDecoding()
+        Decoding thread: decodeAhead(), needsDecoding()
+        Audio thread: getDecodedSamples(), isFullyDecoded(), isValid(), getSampleRate(), isStereo()
+
+    The mutex protect the vorbis decoder and the encoded input, the audio thread never wait for it.
+*/
+
+class IntervalDecoder
+{
+public:
+    IntervalDecoder(uint lookAheadFrames, const ninjam::ByteRope &vorbisData, bool inputComplete);
+
+    void addEncodedData(const QByteArray &vorbisData);
+    void setInputComplete(); // no more encoded data, the remaining input can be fully decoded
+    void stopDecoding();
+
+    bool needsDecoding();
+    uint decodeAhead(uint maxFrames); // return the decoded frames
+    uint getBufferedFrames() const;
+
+    uint getDecodedSamples(SamplesBuffer &outBuffer, uint samplesToDecode);
+
+    int getSampleRate() const;
+    bool isStereo() const;
+    bool isInitialized() const; // the sample rate and channels are known
+    bool isFullyDecoded() const; // all frames were decoded and consumed by the audio thread
+    bool isValid() const;
+
+    uint takeUnderruns(); // how many times the audio thread consumed all decoded frames before the end of the interval, the counter is reset
+
+private:
+    Q_DISABLE_COPY(IntervalDecoder)
+
+    const SamplesBuffer &decode(uint maxFrames); // called with the mutex locked
+
+    vorbis::Decoder vorbisDecoder;
+    bool inputComplete;
+    QMutex mutex;
+
+    SamplesRingBuffer decodedFrames;
+
+    // decoder state published to the audio thread
+    std::atomic<bool> initialized;
+    std::atomic<bool> finished;
+    std::atomic<bool> valid;
+    std::atomic<int> sampleRate;
+    std::atomic<bool> stereo;
+
+    std::atomic<uint> underruns;
+};
+
+inline uint IntervalDecoder::getBufferedFrames() const
+{
+    return decodedFrames.getAvailableFrames();
+}
+
+inline int IntervalDecoder::getSampleRate() const
+{
+    return sampleRate;
+}
+
+inline bool IntervalDecoder::isStereo() const
+{
+    return stereo;
+}
+
+inline bool IntervalDecoder::isInitialized() const
+{
+    return initialized;
+}
+
+inline bool IntervalDecoder::isValid() const
+{
+    return valid;
+}
+
+inline bool IntervalDecoder::isFullyDecoded() const
+{
+    return finished && decodedFrames.getAvailableFrames() == 0;
+}
+
+inline uint IntervalDecoder::takeUnderruns()
+{
+    return underruns.exchange(0);
+}
+
+} // namespace
+
+#endif // INTERVAL_DECODER_H
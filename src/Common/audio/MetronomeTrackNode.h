@@ -14,7 +14,7 @@ public:
     MetronomeTrackNode(const audio::SamplesBuffer &firstBeatSamples, const audio::SamplesBuffer &offBeatSamples, const SamplesBuffer &accentBeatSamples);
 
     ~MetronomeTrackNode();
-    void processReplacing(const SamplesBuffer &in, SamplesBuffer &out, int sampleRate, std::vector<midi::MidiMessage> &midiBuffer) override;
+    void processReplacing(const SamplesBuffer &in, SamplesBuffer &out, int sampleRate, const std::vector<midi::MidiMessage> &midiBuffer) override;
     void setSamplesPerBeat(long samplesPerBeat);
     void setIntervalPosition(long intervalPosition);
     void resetInterval();
@@ -64,7 +64,7 @@ void MidiSyncTrackNode::stop()
 }
 
 void MidiSyncTrackNode::processReplacing(const SamplesBuffer &in, SamplesBuffer &out,
-                                          int SampleRate, std::vector<midi::MidiMessage> &midiBuffer)
+                                          int SampleRate, const std::vector<midi::MidiMessage> &midiBuffer)
 {
     if (pulsesPerInterval <= 0 || samplesPerPulse <= 0)
         return;
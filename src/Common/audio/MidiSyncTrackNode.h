@@ -18,7 +18,8 @@ public:
     MidiSyncTrackNode(MainController *controller);
 
     ~MidiSyncTrackNode();
-    void processReplacing(const SamplesBuffer &in, SamplesBuffer &out, int sampleRate, std::vector<midi::MidiMessage> &midiBuffer) override;
+    void processReplacing(const SamplesBuffer &in, SamplesBuffer &out, int sampleRate, const std::vector<midi::MidiMessage> &midiBuffer) override;
+    inline bool canBeRenderedInParallel() const override { return false; } // midi clock is sent using the main controller
     void setPulseTiming(long pulsesPerInterval, double samplesPerPulse);
     void setIntervalPosition(long intervalPosition);
     void resetInterval();
@@ -4,13 +4,13 @@
 #include <QDebug>
 #include <QList>
 #include <QByteArray>
-#include <QMutexLocker>
 #include <QDateTime>
-#include <QtConcurrent/QtConcurrent>
 
 #include "audio/core/Filters.h"
 #include "audio/core/AudioDriver.h"
-#include "audio/vorbis/VorbisDecoder.h"
+#include "audio/IntervalDecoder.h"
+#include "audio/DecodingService.h"
+#include "audio/core/SnapshotPublisher.h"
 
 
 const double NinjamTrackNode::LOW_CUT_DRASTIC_FREQUENCY = 220.0; // in Hertz
@@ -91,85 +91,23 @@ public:
 
 //--------------------------------------------------------------------------
 
-class NinjamTrackNode::IntervalDecoder
-{
-public:
-    explicit IntervalDecoder(const QByteArray &vorbisData = QByteArray());
-    void decode(quint32 maxSamplesToDecode);
-    void addEncodedData(const QByteArray &vorbisData);
-    quint32 getDecodedSamples(audio::SamplesBuffer &outBuffer, uint samplesToDecode);
-    inline int getSampleRate() const { return vorbisDecoder.getSampleRate(); }
-    inline bool isStereo() const { return vorbisDecoder.isStereo(); }
-    void stopDecoding();
-    bool isFullyDecoded() const { return vorbisDecoder.isFinished(); }
-    bool isValid() const { return vorbisDecoder.isValid(); }
-private:
-    vorbis::Decoder vorbisDecoder;
-    audio::SamplesBuffer decodedBuffer;
-    QMutex mutex;
-};
-
-NinjamTrackNode::IntervalDecoder::IntervalDecoder(const QByteArray &vorbisData)
-    :decodedBuffer(2)
-{
-    vorbisDecoder.setInputData(vorbisData);
-}
-
-void NinjamTrackNode::IntervalDecoder::addEncodedData(const QByteArray &vorbisData)
-{
-    // this funcion is called from GUI thread
-    QMutexLocker locker(&mutex);
-    vorbisDecoder.addInputData(vorbisData);
-}
-
-void NinjamTrackNode::IntervalDecoder::decode(quint32 maxSamplesToDecode)
-{
-    QMutexLocker locker(&mutex);
-    decodedBuffer.append(vorbisDecoder.decode(maxSamplesToDecode));
-}
-
-void NinjamTrackNode::IntervalDecoder::stopDecoding()
-{
-    // this funcion is called from GUI thread
-    QMutexLocker locker(&mutex);
-    vorbisDecoder.setInputData(QByteArray()); // empty data
-}
-
-quint32 NinjamTrackNode::IntervalDecoder::getDecodedSamples(audio::SamplesBuffer &outBuffer, uint samplesToDecode)
-{
-    QMutexLocker locker(&mutex);
-    while (decodedBuffer.getFrameLenght() < samplesToDecode) { //need decode more samples to fill outBuffer?
-        quint32 toDecode = samplesToDecode - decodedBuffer.getFrameLenght();
-        const auto &decodedSamples = vorbisDecoder.decode(toDecode);
-        decodedBuffer.append(decodedSamples);
-        if (decodedSamples.isEmpty())
-            break; //no more samples to decode
-    }
-
-    quint32 totalSamples = qMin(samplesToDecode, decodedBuffer.getFrameLenght());
-    outBuffer.setFrameLenght(totalSamples);
-    outBuffer.set(decodedBuffer);
-    decodedBuffer.discardFirstSamples(totalSamples);
-
-    return totalSamples;
-}
-
-//-------------------------------------------------------------
-
-NinjamTrackNode::NinjamTrackNode(int ID) :
+NinjamTrackNode::NinjamTrackNode(int ID, audio::DecodingService *decodingService) :
     ID(ID),
+    resampler(audio::DECODED_INTERVALS_RESAMPLER_QUALITY),
     lowCut(new NinjamTrackNode::LowCutFilter(44100)),
     nodeDestroying(false),
+    decodingService(decodingService),
+    firstDecoderStarted(false),
     currentDecoder(nullptr),
-    decodersMutex(QMutex::NonRecursive),
     receiveState(true)
 {
-
+    decoders.reserve(16); // QVector keep the capacity when decoders are removed, no allocations in audio thread
 }
 
 bool NinjamTrackNode::isStereo() const
 {
-    auto decoder = std::atomic_load(&currentDecoder);
+    audio::SnapshotReadSection readSection; // the decoder is not released while we are reading
+    auto decoder = currentDecoder.load();
     if (decoder) {
         return decoder->isStereo();
     }
@@ -178,9 +116,12 @@ bool NinjamTrackNode::isStereo() const
 
 void NinjamTrackNode::stopDecoding()
 {
-    auto decoder = std::atomic_load(&currentDecoder);
-    if (decoder) {
-        decoder->stopDecoding();
+    {
+        audio::SnapshotReadSection readSection;
+        auto decoder = currentDecoder.load();
+        if (decoder) {
+            decoder->stopDecoding();
+        }
     }
     discardDownloadedIntervals();
 }
@@ -219,7 +160,8 @@ void NinjamTrackNode::setLowCutState(LowCutState newState)
 
 int NinjamTrackNode::getSampleRate() const
 {
-    auto decoder = std::atomic_load(&currentDecoder);
+    audio::SnapshotReadSection readSection;
+    auto decoder = currentDecoder.load();
     if (decoder) {
         return decoder->getSampleRate();
     }
@@ -230,15 +172,17 @@ NinjamTrackNode::~NinjamTrackNode()
 {
     //qDebug() << "Destrutor NinjamTrackNode";
     nodeDestroying = true;
-    QMutexLocker locker(&decodersMutex);
-    discardDownloadedIntervalsLocked();
+    consumeDecoderEvents(); // the audio thread is not using this node anymore
+    clearDecoders();
     consumePendingEvents(false);
 }
 
 void NinjamTrackNode::discardDownloadedIntervals()
 {
-    QMutexLocker locker(&decodersMutex);
-    discardDownloadedIntervalsLocked();
+    lastVoiceChatDecoder.reset();
+    decoderEvents.enqueue(nullptr); // audio thread will clear the decoders list in next processReplacing() or startNewInterval()
+    currentDecoder = nullptr; // stop playing immediately, the decoder is released by the audio thread
+    //qDebug() << "intervals discarded";
 }
 
 bool NinjamTrackNode::isReceiveState() const {
@@ -251,8 +195,27 @@ void NinjamTrackNode::setReceiveState(bool state) {
 
 bool NinjamTrackNode::isPlaying()
 {
-    QMutexLocker locker(&decodersMutex);
-    return isPlayingLocked();
+    return currentDecoder.load() || mode == VoiceChat;
+}
+
+void NinjamTrackNode::consumeDecoderEvents()
+{
+    std::shared_ptr<IntervalDecoder> decoder;
+    while (decoderEvents.try_dequeue(decoder)) {
+        if (decoder) {
+            decoders.append(decoder);
+        }
+        else { // discarding downloaded intervals
+            clearDecoders();
+        }
+    }
+}
+
+void NinjamTrackNode::clearDecoders()
+{
+    currentDecoder = nullptr;
+    firstDecoderStarted = false;
+    decoders.clear(); // the decoding service release the decoders, no locks or deallocations in audio thread
 }
 
 void NinjamTrackNode::consumePendingEvents(bool process)
@@ -270,16 +233,16 @@ bool NinjamTrackNode::startNewInterval()
 {
     //qDebug() << "--------START INTERVAL------------";
 
-    QMutexLocker locker(&decodersMutex);
+    consumeDecoderEvents();
     consumePendingEvents(true);
     if (mode == Intervalic) {
-        std::shared_ptr<IntervalDecoder> decoder; //discard the previous interval decoder
-        if (!decoders.isEmpty()) {
-            decoder = decoders.takeFirst(); //using the next buffered decoder (next interval)
-        }
-        std::atomic_store(&currentDecoder, decoder);
+        if (firstDecoderStarted && !decoders.isEmpty())
+            decoders.removeFirst(); // discard the previous interval decoder
+
+        firstDecoderStarted = !decoders.isEmpty();
+        currentDecoder = firstDecoderStarted ? decoders.first().get() : nullptr; // using the next buffered decoder (next interval)
     }
-    return isPlayingLocked();
+    return isPlaying();
 }
 
 // this function is used only for voice chat mode. The parameter is not a full Ogg Vorbis interval, it's just a chunk of data.
@@ -291,53 +254,43 @@ void NinjamTrackNode::addVorbisEncodedChunk(const QByteArray &chunkBytes, bool i
         return;
 
 
-    QMutexLocker locker(&decodersMutex);
+    if (!lastVoiceChatDecoder) {
 
-    if (decoders.isEmpty()) {
-
-        if (!isFirstPart) { // if decoders are empty and the chunk is not the first part we are receinving partial data of the previous interval, we must wait until receive a new interval
+        if (!isFirstPart) { // if no decoder is receiving chunks and the chunk is not the first part we are receinving partial data of the previous interval, we must wait until receive a new interval
             //qDebug() << "Returning, not the first part of an interval";
             return;
         }
 
        // qDebug() << "First interval part received, creating new interval";
-        decoders.push_back(std::make_shared<IntervalDecoder>());
+        lastVoiceChatDecoder = decodingService->createDecoder(ninjam::ByteRope(), false); // the input is completed when the last part is received
+        decoderEvents.enqueue(lastVoiceChatDecoder);
     }
 
 
-    decoders.last()->addEncodedData(chunkBytes);
+    lastVoiceChatDecoder->addEncodedData(chunkBytes);
 
     if (isLastPart) {
         //qDebug() << "Last part received, creating new IntervalDecoder";
-        decoders.push_back(std::make_shared<IntervalDecoder>());
+        lastVoiceChatDecoder->setInputComplete();
+        lastVoiceChatDecoder = decodingService->createDecoder(ninjam::ByteRope(), false);
+        decoderEvents.enqueue(lastVoiceChatDecoder);
     }
 
+    decodingService->wakeUp();
 }
 
  // this function is used only for Intervalic mode. The parameter is a full Ogg Vorbis Interval data
-void NinjamTrackNode::addVorbisEncodedInterval(const QByteArray &fullIntervalBytes)
+void NinjamTrackNode::addVorbisEncodedInterval(const ninjam::ByteRope &fullIntervalBytes)
 {
     //qDebug() << "Full Interval received " << fullIntervalBytes.left(4);
 
     if (mode != Intervalic)
         return;
 
-    auto decoder = std::make_shared<IntervalDecoder>(fullIntervalBytes);
-
-    {
-        QMutexLocker locker(&decodersMutex);
-        decoders.append(decoder);
-    }
+    // the decoding service start decoding in background, the first samples are decoded before the interval start (first beat)
+    auto decoder = decodingService->createDecoder(fullIntervalBytes, true);
 
-    //decoding the first samples in a separated thread to avoid slow down the audio thread in interval start (first beat)
-    auto decoderWeakPtr = std::weak_ptr<IntervalDecoder>(decoder);
-    QtConcurrent::run([](std::weak_ptr<IntervalDecoder> decoderWeakPtr) {
-        auto pdecoder = decoderWeakPtr.lock();
-        if (pdecoder) {
-            pdecoder->decode(256);
-        }
-        return 0;
-    }, decoderWeakPtr);
+    decoderEvents.enqueue(decoder);
 }
 
 // ++++++++++++++
@@ -360,19 +313,17 @@ void NinjamTrackNode::schefuleSetChannelMode(ChannelMode mode)
 }
 
 void NinjamTrackNode::processReplacing(const audio::SamplesBuffer &in, audio::SamplesBuffer &out,
-                                       int sampleRate, std::vector<midi::MidiMessage> &midiBuffer)
+                                       int sampleRate, const std::vector<midi::MidiMessage> &midiBuffer)
 {
     bool needResampling = false;
-    if (isPlayingLocked()) {
-        QMutexLocker locker(&decodersMutex);
-        if (!isPlayingLocked()) {
-            return;
-        }
-        auto decoder = std::atomic_load(&currentDecoder);
+    consumeDecoderEvents();
+    if (isPlaying()) {
+        auto decoder = currentDecoder.load();
         if (!decoder) {
             if (mode == VoiceChat && !decoders.isEmpty()) {
-                decoder = decoders.first();
-                std::atomic_store(&currentDecoder, decoder);
+                decoder = decoders.first().get();
+                firstDecoderStarted = true;
+                currentDecoder = decoder;
                 //qDebug() << "USING FIRST DECODER";
             } else {
                 //qDebug() << "Current decoder is null, not playing!";
@@ -380,28 +331,29 @@ void NinjamTrackNode::processReplacing(const audio::SamplesBuffer &in, audio::Sa
             }
         }
 
-        if (!decoder || !decoder->isValid()) {
-            if (decoder && !decoder->isValid()){
-                //qDebug() << "Current decoder is not valid, returning!";
-                std::atomic_store(&currentDecoder, {}); // the current decoder is corrupted, setting to nullptr to force a new decoder usage
-                decoders.clear();
-                internalInputBuffer.zero();
-            }
+        if (!decoder->isValid()) {
+            //qDebug() << "Current decoder is not valid, returning!";
+            clearDecoders(); // the current decoder is corrupted, setting to nullptr to force a new decoder usage
+            internalInputBuffer.zero();
             return;
         }
 
         if (!receiveState) {
-            std::atomic_store(&currentDecoder, {});
-            decoder->stopDecoding();
-            decoders.clear();
+            clearDecoders();
             internalInputBuffer.zero();
             return;
         }
 
+        decodingService->setPlaybackSampleRate(sampleRate); // the decoding thread prepare the resampler tables
+
         int outFrameLenght = out.getFrameLenght();
-        needResampling = decoder && decoder->getSampleRate() != sampleRate;
-        auto framesToProcess = needResampling ? getInputResamplingLength(
-             decoder ? decoder->getSampleRate() : 44100, sampleRate, outFrameLenght) : outFrameLenght;
+        needResampling = decoder->getSampleRate() != sampleRate;
+        if (needResampling && !resampler.trySetSampleRates(decoder->getSampleRate(), sampleRate)) { // the resampler keep the state (and the fractional position) between intervals
+            internalInputBuffer.zero(); // unusual sample rate, the table is computed in the decoding thread
+            return;
+        }
+
+        auto framesToProcess = needResampling ? resampler.getRequiredInputFrames(outFrameLenght) : outFrameLenght;
         internalInputBuffer.setFrameLenght(framesToProcess);
 
         if (decoder) {
@@ -409,11 +361,12 @@ void NinjamTrackNode::processReplacing(const audio::SamplesBuffer &in, audio::Sa
             if (mode == VoiceChat) { // in voice chat we will not wait until startInterval to use the next available downloaded decoder
                 if (framesToProcess >= 0 && decoder->isFullyDecoded()) {
                     //qDebug() << "current decoder consumed, using the next decoder";
-                    std::atomic_store(&currentDecoder, {});
+                    currentDecoder = nullptr;
                     needResampling = false;
-                    if (!decoders.isEmpty()) {
-                        decoders.takeFirst();
+                    if (firstDecoderStarted && !decoders.isEmpty()) {
+                        decoders.removeFirst();
                     }
+                    firstDecoderStarted = false;
                 }
             }
         }
@@ -436,12 +389,3 @@ void NinjamTrackNode::processReplacing(const audio::SamplesBuffer &in, audio::Sa
     }
 }
 
-bool NinjamTrackNode::isPlayingLocked() {
-    return std::atomic_load(&currentDecoder) || mode == VoiceChat;
-}
-
-void NinjamTrackNode::discardDownloadedIntervalsLocked() {
-    decoders.clear();
-    std::atomic_store(&currentDecoder, {});
-    //qDebug() << "intervals discarded";
-}
@@ -3,12 +3,17 @@
 
 #include "core/AudioNode.h"
 #include <QByteArray>
+#include "ninjam/ByteRope.h"
 #include "SamplesBufferResampler.h"
 #include "readerwriterqueue.h"
 
+#include <atomic>
+
 namespace audio {
 class SamplesBuffer;
 class StreamBuffer;
+class IntervalDecoder;
+class DecodingService;
 }
 
 class NinjamTrackNode final : public audio::AudioNode
@@ -27,12 +32,12 @@ public:
         Changing // used when waiting for the next interval do change the mode. Nothing is played in this 'transition state mode'
     };
 
-    explicit NinjamTrackNode(int ID);
+    NinjamTrackNode(int ID, audio::DecodingService *decodingService);
     virtual ~NinjamTrackNode();
-    void addVorbisEncodedInterval(const QByteArray &fullIntervalBytes);
+    void addVorbisEncodedInterval(const ninjam::ByteRope &fullIntervalBytes);
     void addVorbisEncodedChunk(const QByteArray &chunkBytes, bool isFirstPart, bool isLastPart);
     void processReplacing(const audio::SamplesBuffer &in, audio::SamplesBuffer &out, int sampleRate,
-                          std::vector<midi::MidiMessage> &midiBuffer) override;
+                          const std::vector<midi::MidiMessage> &midiBuffer) override;
 
     void setLowCutState(LowCutState newState);
     LowCutState setLowCutToNextState();
@@ -89,16 +94,27 @@ private:
     const static double LOW_CUT_NORMAL_FREQUENCY;
     const static double LOW_CUT_DRASTIC_FREQUENCY;
 
-    bool isPlayingLocked();
-    void discardDownloadedIntervalsLocked();
-
     bool nodeDestroying;
 
-    class IntervalDecoder;
+    audio::DecodingService *decodingService; // decode the downloaded intervals ahead of the playback
+
+    using IntervalDecoder = audio::IntervalDecoder;
+
+    QVector<std::shared_ptr<IntervalDecoder>> decoders; // owned by audio thread, filled with the decoders received in decoderEvents
+    bool firstDecoderStarted; // used in audio thread, the first decoder in 'decoders' is (or was) the current decoder
+
+    /** The current decoder is owned by 'decoders' and published to other threads. Other threads read
+     *  the decoder inside a SnapshotReadSection, the decoding service release the decoders only
+     *  after the read sections are closed. */
+    std::atomic<IntervalDecoder *> currentDecoder;
+
+    /** Downloaded intervals are passed from GUI thread to audio thread using this queue,
+     *  a null decoder means 'discard all downloaded intervals'. */
+    moodycamel::ReaderWriterQueue<std::shared_ptr<IntervalDecoder>> decoderEvents;
+    std::shared_ptr<IntervalDecoder> lastVoiceChatDecoder; // used in GUI thread only, the decoder receiving the voice chat chunks
 
-    QList<std::shared_ptr<IntervalDecoder>> decoders;
-    std::shared_ptr<IntervalDecoder> currentDecoder;
-    QMutex decodersMutex;
+    void consumeDecoderEvents(); // called in audio thread
+    void clearDecoders(); // called in audio thread
 
     ChannelMode mode = Intervalic;
 
@@ -1,18 +1,346 @@
 #include "Resampler.h"
 
-SimpleResampler::SimpleResampler()
+#include <QMutex>
+#include <QMutexLocker>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <memory>
+
+#include "audio/core/SamplesKernels.h"
+
+namespace {
+
+const double PI = 3.14159265358979323846;
+
+const int CHUNK_SIZE = 1024; // input frames copied to history in each step
+const int MAX_TABLE_PHASES = 1024; // ratios with more phases (unusual sample rates) are using the nearest phase
+const int MAX_TABLES = 256; // less than 48 tables are precomputed (common ratios in all qualities)
+const int MAX_DOWNSAMPLING_RATIO = 4; // 192 KHz -> 48 KHz. Stronger ratios are using a shorter filter, so the history is never reallocated
+
+const int COMMON_SAMPLE_RATES[] = {44100, 48000, 88200, 96000};
+
+struct QualitySettings
+{
+    int halfTaps; // zero crossings in each side of the sinc (when upsampling)
+    double kaiserBeta; // stopband attenuation, bigger = more attenuation and larger transition band
+    double rolloff; // cutoff frequency (relative to nyquist), the transition band is finished near the nyquist
+};
+
+QualitySettings getQualitySettings(ResamplerQuality quality)
+{
+    switch (quality) {
+    case ResamplerQuality::Fast:
+        return {8, 6.0, 0.85};
+    case ResamplerQuality::Medium:
+        return {16, 8.0, 0.90};
+    case ResamplerQuality::Best:
+        break;
+    }
+
+    return {32, 10.0, 0.95};
+}
+
+int getMaxTaps(ResamplerQuality quality)
+{
+    return 2 * getQualitySettings(quality).halfTaps * MAX_DOWNSAMPLING_RATIO; // multiple of 8
+}
+
+int greatestCommonDivisor(int a, int b)
+{
+    while (b != 0) {
+        int remainder = a % b;
+        a = b;
+        b = remainder;
+    }
+
+    return a;
+}
+
+double besselI0(double x) // modified bessel function (first kind, order 0), used in kaiser window
+{
+    double sum = 1.0;
+    double term = 1.0;
+    const double halfX = x / 2.0;
+    for (int k = 1; k < 50; ++k) {
+        term *= (halfX / k) * (halfX / k);
+        sum += term;
+        if (term < sum * 1e-12)
+            break;
+    }
+
+    return sum;
+}
+
+} // namespace
+
+// +++++++++++++++++++++++++++++++++++++++
+
+class Resampler::Table
+{
+public:
+    Table(int upFactor, int downFactor, ResamplerQuality quality);
+
+    const float *getCoefficients(qint64 phase) const; // phase in 1/upFactor units
+
+    const int upFactor; // L
+    const int downFactor; // M
+    const ResamplerQuality quality;
+    int taps;
+    int phases;
+
+    std::vector<float> coefficients; // phases * taps
+
+    static const Table *find(int sourceSampleRate, int targetSampleRate, ResamplerQuality quality); // lock-free, nullptr if the table was not computed yet
+    static const Table *get(int sourceSampleRate, int targetSampleRate, ResamplerQuality quality); // compute the table if necessary, not used in audio thread
+
+private:
+    static const Table *lookup(int upFactor, int downFactor, ResamplerQuality quality);
+
+    // append only cache, the tables are never deleted and can be read without locks (audio thread)
+    static std::atomic<const Table *> tables[MAX_TABLES];
+    static std::atomic<int> tablesCount;
+};
+
+std::atomic<const Resampler::Table *> Resampler::Table::tables[MAX_TABLES];
+std::atomic<int> Resampler::Table::tablesCount(0);
+
+Resampler::Table::Table(int upFactor, int downFactor, ResamplerQuality quality) :
+    upFactor(upFactor),
+    downFactor(downFactor),
+    quality(quality)
+{
+    const auto settings = getQualitySettings(quality);
+
+    const double ratio = qMin(1.0, static_cast<double>(upFactor) / downFactor); // downsampling is reducing the cutoff
+    const double cutoff = upFactor == downFactor ? 1.0 : settings.rolloff * ratio; // same sample rate = identity filter
+
+    taps = static_cast<int>(std::ceil(2.0 * settings.halfTaps / ratio));
+    taps = (taps + 7) & ~7; // multiple of 8, no tails in SIMD loops
+    taps = qMin(taps, getMaxTaps(quality)); // the resamplers history is reserved for this length
+    phases = qMin(upFactor, MAX_TABLE_PHASES);
+
+    coefficients.resize(static_cast<size_t>(phases) * taps);
+
+    const double halfLength = taps / 2.0;
+    const double windowNormalization = 1.0 / besselI0(settings.kaiserBeta);
+
+    for (int p = 0; p < phases; ++p) {
+        float *phaseCoefficients = &coefficients[static_cast<size_t>(p) * taps];
+        const double fraction = static_cast<double>(p) / phases;
+        double sum = 0;
+        for (int j = 0; j < taps; ++j) {
+            const double t = fraction + halfLength - 1 - j; // distance (in input samples) between the output and the input sample j
+            const double x = cutoff * t;
+            const double sinc = (std::abs(x) < 1e-12) ? 1.0 : std::sin(PI * x) / (PI * x);
+            const double w = t / halfLength;
+            const double window = (std::abs(w) < 1.0) ? besselI0(settings.kaiserBeta * std::sqrt(1.0 - w * w)) * windowNormalization : 0.0;
+            const double value = cutoff * sinc * window;
+            phaseCoefficients[j] = static_cast<float>(value);
+            sum += value;
+        }
+
+        for (int j = 0; j < taps; ++j) // unity gain in DC for all phases
+            phaseCoefficients[j] = static_cast<float>(phaseCoefficients[j] / sum);
+    }
+}
+
+inline const float *Resampler::Table::getCoefficients(qint64 phase) const
+{
+    const qint64 index = (phases == upFactor) ? phase : (phase * phases) / upFactor;
+    return &coefficients[static_cast<size_t>(index) * taps];
+}
+
+const Resampler::Table *Resampler::Table::lookup(int upFactor, int downFactor, ResamplerQuality quality)
+{
+    const int count = tablesCount.load();
+    for (int i = 0; i < count; ++i) {
+        const Table *table = tables[i].load();
+        if (table->upFactor == upFactor && table->downFactor == downFactor && table->quality == quality)
+            return table;
+    }
+
+    return nullptr;
+}
+
+const Resampler::Table *Resampler::Table::find(int sourceSampleRate, int targetSampleRate, ResamplerQuality quality)
+{
+    Q_ASSERT(sourceSampleRate > 0 && targetSampleRate > 0);
+
+    const int divisor = greatestCommonDivisor(sourceSampleRate, targetSampleRate);
+    return lookup(targetSampleRate / divisor, sourceSampleRate / divisor, quality);
+}
+
+const Resampler::Table *Resampler::Table::get(int sourceSampleRate, int targetSampleRate, ResamplerQuality quality)
+{
+    static QMutex writersMutex;
+
+    const Table *table = find(sourceSampleRate, targetSampleRate, quality);
+    if (table)
+        return table;
+
+    QMutexLocker locker(&writersMutex);
+
+    table = find(sourceSampleRate, targetSampleRate, quality); // created by other thread?
+    if (table)
+        return table;
+
+    const int divisor = greatestCommonDivisor(sourceSampleRate, targetSampleRate);
+    table = new Table(targetSampleRate / divisor, sourceSampleRate / divisor, quality);
+
+    const int count = tablesCount.load();
+    if (count < MAX_TABLES) {
+        tables[count].store(table);
+        tablesCount.store(count + 1);
+    }
+    else {
+        static std::vector<std::unique_ptr<const Table>> uncachedTables; // very unusual, many different sample rates in same session (not found by the audio thread)
+        uncachedTables.emplace_back(table);
+    }
+
+    return table;
+}
+
+// +++++++++++++++++++++++++++++++++++++++
+
+namespace {
+
+bool precomputeCommonTables()
+{
+    for (auto quality : {ResamplerQuality::Fast, ResamplerQuality::Medium, ResamplerQuality::Best})
+        Resampler::precomputeTables(quality);
+
+    return true;
+}
+
+} // namespace
+
+Resampler::Resampler(ResamplerQuality quality) :
+    Resampler(44100, 44100, quality)
+{
+
+}
+
+Resampler::Resampler(int sourceSampleRate, int targetSampleRate, ResamplerQuality quality) :
+    quality(quality),
+    sourceSampleRate(0),
+    targetSampleRate(0),
+    table(nullptr),
+    kernels(&audio::SamplesKernels::get()),
+    history(static_cast<size_t>(getMaxTaps(quality) + CHUNK_SIZE)), // the longest filter, setSampleRates() never allocate
+    historyFrames(0),
+    position(0),
+    phase(0)
+{
+    static const bool tablesPrecomputed = precomputeCommonTables(); // only once, the resamplers are created out of audio thread
+    Q_UNUSED(tablesPrecomputed)
+
+    setSampleRates(sourceSampleRate, targetSampleRate);
+}
+
+void Resampler::precomputeTables(ResamplerQuality quality)
+{
+    for (int source : COMMON_SAMPLE_RATES) {
+        for (int target : COMMON_SAMPLE_RATES)
+            prepareTables(source, target, quality);
+    }
+}
+
+void Resampler::prepareTables(int sourceSampleRate, int targetSampleRate, ResamplerQuality quality)
+{
+    Table::get(sourceSampleRate, targetSampleRate, quality);
+}
+
+bool Resampler::hasTables(int sourceSampleRate, int targetSampleRate, ResamplerQuality quality)
+{
+    return Table::find(sourceSampleRate, targetSampleRate, quality) != nullptr;
+}
+
+void Resampler::setSampleRates(int sourceSampleRate, int targetSampleRate)
+{
+    if (table && sourceSampleRate == this->sourceSampleRate && targetSampleRate == this->targetSampleRate)
+        return;
+
+    setTable(Table::get(sourceSampleRate, targetSampleRate, quality), sourceSampleRate, targetSampleRate);
+}
+
+bool Resampler::trySetSampleRates(int sourceSampleRate, int targetSampleRate)
+{
+    if (table && sourceSampleRate == this->sourceSampleRate && targetSampleRate == this->targetSampleRate)
+        return true;
+
+    const Table *newTable = Table::find(sourceSampleRate, targetSampleRate, quality);
+    if (!newTable)
+        return false; // the table must be computed out of audio thread (prepareTables)
+
+    setTable(newTable, sourceSampleRate, targetSampleRate);
+    return true;
+}
+
+void Resampler::setTable(const Table *table, int sourceSampleRate, int targetSampleRate)
+{
+    this->sourceSampleRate = sourceSampleRate;
+    this->targetSampleRate = targetSampleRate;
+    this->table = table;
+
+    Q_ASSERT(history.size() >= static_cast<size_t>(table->taps + CHUNK_SIZE)); // reserved in constructor
+
+    reset();
+}
+
+void Resampler::reset()
 {
+    // the first output frame is centered in the first input frame, the previous frames are silence
+    historyFrames = table->taps / 2 - 1;
+    std::fill(history.begin(), history.begin() + historyFrames, 0.0f);
+    position = 0;
+    phase = 0;
+}
+
+int Resampler::getRequiredInputFrames(int outFrames) const
+{
+    if (outFrames <= 0)
+        return 0;
+
+    const qint64 lastOutputPosition = position + (phase + static_cast<qint64>(outFrames - 1) * table->downFactor) / table->upFactor;
+    const qint64 requiredFrames = lastOutputPosition + table->taps - historyFrames;
 
+    return static_cast<int>(qMax(requiredFrames, static_cast<qint64>(0)));
 }
 
-void SimpleResampler::process(const float *in, int inLength, float *out, int outLenght)
+int Resampler::process(const float *in, int inFrames, float *out, int outFrames)
 {
-    double step = static_cast<double>(inLength)/static_cast<double>(outLenght);
-    double doubleCursor = 0;
-    for (int i = 0; i < outLenght; ++i) {
-        int cursor = (int)doubleCursor;
-        double frac = (cursor < inLength-1) ? doubleCursor - cursor : 0; // the last input samples are just copied
-        out[i] = in[cursor] * (1.0-frac) + in[cursor+1] * frac;
-        doubleCursor += step;
+    inFrames = qMin(inFrames, getRequiredInputFrames(outFrames)); // more frames can't be stored in history
+
+    const int taps = table->taps;
+    const qint64 upFactor = table->upFactor;
+    const qint64 downFactor = table->downFactor;
+
+    int producedFrames = 0;
+    int consumedFrames = 0;
+    forever {
+        const int chunk = qMin(inFrames - consumedFrames, CHUNK_SIZE);
+        std::memcpy(&history[historyFrames], in + consumedFrames, chunk * sizeof(float));
+        historyFrames += chunk;
+        consumedFrames += chunk;
+
+        while (producedFrames < outFrames && position + taps <= historyFrames) {
+            out[producedFrames++] = kernels->dotProduct(&history[position], table->getCoefficients(phase), taps);
+
+            phase += downFactor;
+            position += static_cast<int>(phase / upFactor);
+            phase %= upFactor;
+        }
+
+        // discarding the frames not used by the next output frames
+        const int discardedFrames = qMin(position, historyFrames);
+        std::memmove(&history[0], &history[discardedFrames], (historyFrames - discardedFrames) * sizeof(float));
+        historyFrames -= discardedFrames;
+        position -= discardedFrames; // not zero when the next output frame is skipping input frames (downsampling)
+
+        if (consumedFrames >= inFrames)
+            break;
     }
+
+    return producedFrames;
 }
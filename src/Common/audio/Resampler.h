@@ -1,13 +1,89 @@
 #ifndef RESAMPLER_H
 #define RESAMPLER_H
 
-class SimpleResampler
+#include <QtGlobal>
+#include <vector>
+
+namespace audio {
+struct SamplesKernels;
+}
+
+enum class ResamplerQuality
 {
+    Fast,   // 16 taps
+    Medium, // 32 taps
+    Best    // 64 taps
+};
+
+/**
+    Band-limited (windowed sinc) polyphase resampler for one channel. The conversion ratio is
+    handled as an exact fraction (L/M), so the resampler keep the fractional position between
+    blocks and the audio nodes don't need to correct the drift when requesting input samples.
+
+    Use getRequiredInputFrames() to know how many input frames are necessary to produce N output
+    frames, and pass exactly (or less) frames to process(). The output is aligned with the input
+    (no delay), the filter look-ahead is included in the required frames of the first call.
+
+    The coefficient tables are shared by all resamplers. The common ratios (44.1, 48, 88.2 and
+    96 KHz) are computed when the first resampler is created, other ratios are computed (and
+    cached) in the first setSampleRates() or prepareTables() call using them. The audio thread
+    use trySetSampleRates(), it never compute tables. The filter history is allocated in the
+    constructor for the longest filter, downsampling more than 4x uses a shorter filter.
+*/
 
+class Resampler
+{
 public:
-    explicit SimpleResampler();
-    void process(const float *in, int inLength, float *out, int outLenght);
+    explicit Resampler(ResamplerQuality quality = ResamplerQuality::Medium);
+    Resampler(int sourceSampleRate, int targetSampleRate, ResamplerQuality quality = ResamplerQuality::Medium);
+
+    void setSampleRates(int sourceSampleRate, int targetSampleRate); // reset the state when the sample rates are changed, no allocations for the common ratios
+    bool trySetSampleRates(int sourceSampleRate, int targetSampleRate); // lock-free, return false (nothing is changed) if the table was not computed yet
+    void reset(); // discard the internal state (the filter history)
+
+    int getRequiredInputFrames(int outFrames) const;
+
+    int process(const float *in, int inFrames, float *out, int outFrames); // return the produced frames, inFrames is limited by getRequiredInputFrames(outFrames)
+
+    ResamplerQuality getQuality() const;
+    int getSourceSampleRate() const;
+    int getTargetSampleRate() const;
 
+    static void precomputeTables(ResamplerQuality quality); // compute the tables for the common ratios
+    static void prepareTables(int sourceSampleRate, int targetSampleRate, ResamplerQuality quality); // compute (and cache) the table, not used in audio thread
+    static bool hasTables(int sourceSampleRate, int targetSampleRate, ResamplerQuality quality); // lock-free
+
+private:
+    class Table;
+
+    void setTable(const Table *table, int sourceSampleRate, int targetSampleRate);
+
+    ResamplerQuality quality;
+    int sourceSampleRate;
+    int targetSampleRate;
+
+    const Table *table;
+    const audio::SamplesKernels *kernels;
+
+    std::vector<float> history; // the last input frames (used by the next output frames) + the current input block
+    int historyFrames;
+    int position; // the first input frame (in history) used by the next output frame
+    qint64 phase; // the fractional part of the position, in 1/L units
 };
 
+inline ResamplerQuality Resampler::getQuality() const
+{
+    return quality;
+}
+
+inline int Resampler::getSourceSampleRate() const
+{
+    return sourceSampleRate;
+}
+
+inline int Resampler::getTargetSampleRate() const
+{
+    return targetSampleRate;
+}
+
 #endif // RESAMPLER_H
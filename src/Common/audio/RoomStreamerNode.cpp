@@ -63,12 +63,14 @@ void AbstractMp3Streamer::stopCurrentStream()
 int AbstractMp3Streamer::getSamplesToRender(int targetSampleRate, int outLenght)
 {
     bool needResampling = needResamplingFor(targetSampleRate);
-    int samplesToRender = needResampling ? getInputResamplingLength(
-        getSampleRate(), targetSampleRate, outLenght) : outLenght;
-    return samplesToRender;
+    if (!needResampling)
+        return outLenght;
+
+    resampler.setSampleRates(getSampleRate(), targetSampleRate);
+    return resampler.getRequiredInputFrames(outLenght);
 }
 
-void AbstractMp3Streamer::processReplacing(const SamplesBuffer &in, SamplesBuffer &out, int targetSampleRate, std::vector<midi::MidiMessage> &)
+void AbstractMp3Streamer::processReplacing(const SamplesBuffer &in, SamplesBuffer &out, int targetSampleRate, const std::vector<midi::MidiMessage> &)
 {
     Q_UNUSED(in);
 
@@ -219,7 +221,7 @@ NinjamRoomStreamerNode::~NinjamRoomStreamerNode()
 }
 
 void NinjamRoomStreamerNode::processReplacing(const SamplesBuffer &in, SamplesBuffer &out,
-                                              int sampleRate, std::vector<midi::MidiMessage> &midiBuffer)
+                                              int sampleRate, const std::vector<midi::MidiMessage> &midiBuffer)
 {
     Q_UNUSED(in)
     QMutexLocker locker(&mutex);
@@ -274,7 +276,7 @@ AudioFileStreamerNode::~AudioFileStreamerNode()
 }
 
 void AudioFileStreamerNode::processReplacing(const SamplesBuffer &in, SamplesBuffer &out,
-                                             int sampleRate, std::vector<midi::MidiMessage> &midiBuffer)
+                                             int sampleRate, const std::vector<midi::MidiMessage> &midiBuffer)
 {
     while (bufferedSamples.getFrameLenght() < out.getFrameLenght())
         decode(1024 + 1024);
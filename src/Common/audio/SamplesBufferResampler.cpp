@@ -1,9 +1,10 @@
 #include "SamplesBufferResampler.h"
 #include <algorithm>
-#include <QDebug>
+#include <vector>
 
-SamplesBufferResampler::SamplesBufferResampler() :
-    outBuffer(2, 4096 * 2)
+SamplesBufferResampler::SamplesBufferResampler(ResamplerQuality quality) :
+    outBuffer(2, 4096 * 2),
+    resamplers{Resampler(quality), Resampler(quality)}
 {
     //
 }
@@ -13,17 +14,65 @@ SamplesBufferResampler::~SamplesBufferResampler()
 
 }
 
+void SamplesBufferResampler::setSampleRates(int sourceSampleRate, int targetSampleRate)
+{
+    for (auto &resampler : resamplers)
+        resampler.setSampleRates(sourceSampleRate, targetSampleRate);
+}
+
+bool SamplesBufferResampler::trySetSampleRates(int sourceSampleRate, int targetSampleRate)
+{
+    for (auto &resampler : resamplers) {
+        if (!resampler.trySetSampleRates(sourceSampleRate, targetSampleRate))
+            return false; // all channels are using the same table, the first channel is failing if the table is not available
+    }
+
+    return true;
+}
+
+int SamplesBufferResampler::getRequiredInputFrames(int outFrames) const
+{
+    return resamplers[0].getRequiredInputFrames(outFrames); // all channels have the same state
+}
+
 const audio::SamplesBuffer &SamplesBufferResampler::resample(const audio::SamplesBuffer &in,
                                                              int desiredOutLenght)
 {
     outBuffer.zero();
-    outBuffer.setFrameLenght(desiredOutLenght * 2); // enough space
-    uint channels = std::min(in.getChannels(), outBuffer.getChannels());
-    for (uint c = 0; c < channels; ++c) {
+    outBuffer.setFrameLenght(desiredOutLenght);
+    int channels = std::min(in.getChannels(), outBuffer.getChannels());
+    int producedFrames = desiredOutLenght;
+    for (int c = 0; c < channels; ++c) {
         float *input = in.getSamplesArray(c);
         float *output = outBuffer.getSamplesArray(c);
-        resamplers[c].process(input, in.getFrameLenght(), output, desiredOutLenght);
+        producedFrames = resamplers[c].process(input, in.getFrameLenght(), output, desiredOutLenght);
     }
-    outBuffer.setFrameLenght(desiredOutLenght);
+    outBuffer.setFrameLenght(producedFrames); // less frames when the input is shorter than getRequiredInputFrames()
     return outBuffer;
 }
+
+void SamplesBufferResampler::resample(const audio::SamplesBuffer &in, audio::SamplesBuffer &out, int sourceSampleRate,
+                                      int targetSampleRate, ResamplerQuality quality)
+{
+    const int outFrames = static_cast<int>(static_cast<qint64>(in.getFrameLenght()) * targetSampleRate / sourceSampleRate);
+
+    if (in.getChannels() > 1)
+        out.setToStereo();
+    else
+        out.setToMono();
+
+    out.setFrameLenght(outFrames);
+
+    for (int c = 0; c < in.getChannels(); ++c) {
+        Resampler resampler(sourceSampleRate, targetSampleRate, quality);
+        int producedFrames = resampler.process(in.getSamplesArray(c), in.getFrameLenght(), out.getSamplesArray(c), outFrames);
+
+        const int lookAheadFrames = resampler.getRequiredInputFrames(outFrames - producedFrames);
+        if (lookAheadFrames > 0) { // the last output frames are using the filter look-ahead, the input is finished with silence
+            std::vector<float> silence(lookAheadFrames, 0.0f);
+            producedFrames += resampler.process(silence.data(), lookAheadFrames, out.getSamplesArray(c) + producedFrames, outFrames - producedFrames);
+        }
+
+        Q_ASSERT(producedFrames == outFrames);
+    }
+}
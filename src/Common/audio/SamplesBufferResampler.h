@@ -4,17 +4,32 @@
 #include "Resampler.h"
 #include "core/SamplesBuffer.h"
 
+/**
+    Stereo (or mono) resampler for SamplesBuffer. Streaming users (audio nodes) keep one instance
+    and call resample() in every audio callback with exactly getRequiredInputFrames() input frames,
+    the filter state and the fractional position are kept between callbacks.
+*/
+
 class SamplesBufferResampler
 {
 
 public:
-    SamplesBufferResampler();
+    explicit SamplesBufferResampler(ResamplerQuality quality = ResamplerQuality::Medium);
     ~SamplesBufferResampler();
+
+    void setSampleRates(int sourceSampleRate, int targetSampleRate); // no allocations for the common sample rates
+    bool trySetSampleRates(int sourceSampleRate, int targetSampleRate); // used in audio thread, false if the table was not prepared (Resampler::prepareTables)
+    int getRequiredInputFrames(int outFrames) const;
+
     const audio::SamplesBuffer &resample(const audio::SamplesBuffer &in, int desiredOutLenght);
 
+    // resample a complete buffer (audio files, loops), the output lenght is proportional to the sample rates ratio
+    static void resample(const audio::SamplesBuffer &in, audio::SamplesBuffer &out, int sourceSampleRate, int targetSampleRate,
+                         ResamplerQuality quality = ResamplerQuality::Best);
+
 private:
     audio::SamplesBuffer outBuffer;
-    SimpleResampler resamplers[2];
+    Resampler resamplers[2];
 };
 
 #endif // SAMPLESBUFFERRESAMPLER_H
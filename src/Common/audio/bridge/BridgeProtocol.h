@@ -0,0 +1,129 @@
+#ifndef BRIDGE_PROTOCOL_H
+#define BRIDGE_PROTOCOL_H
+
+#include <QtGlobal>
+#include <atomic>
+
+/**
+    Shared memory layout used by PluginBridgeHost (Jamtaba process) and PluginBridgeChild (the
+    PluginBridge process running the plugins chain).
+
+    The audio blocks are exchanged in a ring of SLOTS: the host writes the input samples and the
+    MIDI events in the slot 'requested % SLOTS' and increments 'requested', the child processes the
+    slots in order, writes the output samples in the same slot and increments 'completed'. Only
+    these two counters are synchronizing the processes, each counter has just one writer.
+
+    The commands (sample rate, bypass, plugin state, ...) are sent by the host main thread and
+    executed by the child between two audio blocks.
+*/
+
+namespace audio {
+
+namespace bridge {
+
+const quint32 MAGIC = 0x4A544252; // JTBR
+const quint32 VERSION = 2;
+const int SLOTS = 4; // blocks in flight, a late child can be SLOTS - 1 blocks behind the host
+const int MAX_CHANNELS = 2; // SamplesBuffer is mono or stereo
+const int MAX_MIDI_EVENTS = 64;
+const int MAX_COMMAND_DATA = 8 * 1024 * 1024; // plugin chunks
+
+enum class Command : qint32
+{
+    None,
+    SetSampleRate,
+    SetBypass,
+    Suspend,
+    Resume,
+    GetState,
+    SetState,
+    Quit
+};
+
+enum class ChildState : qint32
+{
+    Starting,
+    Ready,
+    Failed, // the plugins are not loaded
+    Stopped
+};
+
+enum PluginFlags : quint32
+{
+    VirtualInstrument = 1,
+    GeneratesMidi = 2
+};
+
+struct Slot
+{
+    qint32 frames;
+    qint32 midiEvents;
+    qint32 midiData[MAX_MIDI_EVENTS]; // status, data1 and data2, as in midi::MidiMessage
+    quint32 midiOffsets[MAX_MIDI_EVENTS]; // sample offsets in the block
+};
+
+struct Header
+{
+    quint32 magic;
+    quint32 version;
+    qint32 channels;
+    qint32 maxFrames;
+
+    std::atomic<qint32> childState;
+    std::atomic<quint32> pluginFlags;
+
+    alignas(64) std::atomic<quint32> requested; // written by the host audio thread
+    std::atomic<quint32> childSignal; // incremented after each request or command, the child is waiting this counter
+    std::atomic<quint32> childWaiting;
+
+    alignas(64) std::atomic<quint32> completed; // written by the child, the host audio thread is waiting this counter
+    std::atomic<quint32> hostWaiting;
+
+    alignas(64) std::atomic<quint32> commandSequence; // written by the host main thread
+    std::atomic<quint32> commandCompleted; // written by the child
+    Command command;
+    qint32 commandArgument;
+    qint32 commandResult;
+    qint32 commandDataSize;
+
+    Slot slots[SLOTS];
+};
+
+static_assert(ATOMIC_INT_LOCK_FREE == 2, "the atomic counters are shared by processes, they must be lock free");
+
+inline int getAudioOffset()
+{
+    return (static_cast<int>(sizeof(Header)) + 63) & ~63;
+}
+
+inline int getSlotSamples(int channels, int maxFrames) // input + output samples
+{
+    return channels * maxFrames * 2;
+}
+
+inline int getCommandDataOffset(int channels, int maxFrames)
+{
+    return getAudioOffset() + static_cast<int>(sizeof(float)) * getSlotSamples(channels, maxFrames) * SLOTS;
+}
+
+inline int getSharedMemorySize(int channels, int maxFrames)
+{
+    return getCommandDataOffset(channels, maxFrames) + MAX_COMMAND_DATA;
+}
+
+inline float *getSlotInput(char *sharedMemory, int slot, int channel, int channels, int maxFrames)
+{
+    float *audio = reinterpret_cast<float *>(sharedMemory + getAudioOffset());
+    return audio + slot * getSlotSamples(channels, maxFrames) + channel * maxFrames;
+}
+
+inline float *getSlotOutput(char *sharedMemory, int slot, int channel, int channels, int maxFrames)
+{
+    return getSlotInput(sharedMemory, slot, channel, channels, maxFrames) + channels * maxFrames;
+}
+
+} // namespace
+
+} // namespace
+
+#endif // BRIDGE_PROTOCOL_H
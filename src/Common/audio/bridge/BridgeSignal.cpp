@@ -0,0 +1,218 @@
+#include "BridgeSignal.h"
+
+#if defined(Q_OS_LINUX)
+    #include <linux/futex.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+    #include <cerrno>
+    #include <climits>
+    #include <ctime>
+#elif defined(Q_OS_WIN)
+    #include <windows.h>
+    #include <climits>
+#else
+    #include <QElapsedTimer>
+    #include <semaphore.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+using audio::BridgeSignal;
+
+static_assert(sizeof(std::atomic<quint32>) == sizeof(quint32), "the shared counters are used as futex words");
+
+#if defined(Q_OS_LINUX)
+
+namespace {
+
+long futex(std::atomic<quint32> *word, int operation, quint32 value, const timespec *timeout)
+{
+    // not FUTEX_PRIVATE_FLAG, the word is in memory shared with other process
+    return syscall(SYS_futex, reinterpret_cast<quint32 *>(word), operation, value, timeout, nullptr, 0);
+}
+
+} // namespace
+
+class BridgeSignal::Semaphore
+{
+};
+
+#elif defined(Q_OS_WIN)
+
+class BridgeSignal::Semaphore
+{
+public:
+    Semaphore(const QString &name, bool create)
+    {
+        const QString fullName = QString("Local\\%1").arg(name);
+        const auto wideName = reinterpret_cast<LPCWSTR>(fullName.utf16());
+        if (create)
+            handle = CreateSemaphoreW(nullptr, 0, LONG_MAX, wideName);
+        else
+            handle = OpenSemaphoreW(SEMAPHORE_MODIFY_STATE | SYNCHRONIZE, FALSE, wideName);
+    }
+
+    ~Semaphore()
+    {
+        if (handle)
+            CloseHandle(handle);
+    }
+
+    bool isValid() const
+    {
+        return handle != nullptr;
+    }
+
+    void post()
+    {
+        ReleaseSemaphore(handle, 1, nullptr);
+    }
+
+    bool wait(qint64 timeout)
+    {
+        const DWORD milliseconds = timeout < 0 ? INFINITE : static_cast<DWORD>(qMax(Q_INT64_C(1), (timeout + 999999) / 1000000));
+        return WaitForSingleObject(handle, milliseconds) == WAIT_OBJECT_0;
+    }
+
+private:
+    HANDLE handle;
+};
+
+#else
+
+class BridgeSignal::Semaphore
+{
+public:
+    Semaphore(const QString &name, bool create) :
+        name(QString("/%1").arg(name).toUtf8()),
+        created(create)
+    {
+        semaphore = sem_open(this->name.constData(), create ? O_CREAT : 0, 0600, 0);
+    }
+
+    ~Semaphore()
+    {
+        if (semaphore == SEM_FAILED)
+            return;
+
+        sem_close(semaphore);
+        if (created)
+            sem_unlink(name.constData());
+    }
+
+    bool isValid() const
+    {
+        return semaphore != SEM_FAILED;
+    }
+
+    void post()
+    {
+        sem_post(semaphore);
+    }
+
+    bool tryWait()
+    {
+        return sem_trywait(semaphore) == 0;
+    }
+
+    void wait()
+    {
+        sem_wait(semaphore);
+    }
+
+private:
+    QByteArray name;
+    bool created;
+    sem_t *semaphore;
+};
+
+#endif
+
+// +++++++++++++++++++++++++++++++++++++++
+
+BridgeSignal::BridgeSignal() :
+    counter(nullptr)
+{
+
+}
+
+BridgeSignal::~BridgeSignal()
+{
+    close();
+}
+
+bool BridgeSignal::open(std::atomic<quint32> *counter, const QString &name, bool create)
+{
+    close();
+
+    this->counter = counter;
+
+#ifdef Q_OS_LINUX
+    Q_UNUSED(name)
+    Q_UNUSED(create)
+#else
+    semaphore.reset(new Semaphore(name, create));
+    if (!semaphore->isValid()) {
+        semaphore.reset();
+        this->counter = nullptr;
+        return false;
+    }
+#endif
+
+    return true;
+}
+
+void BridgeSignal::close()
+{
+    semaphore.reset();
+    counter = nullptr;
+}
+
+void BridgeSignal::wake()
+{
+    if (!counter)
+        return;
+
+#ifdef Q_OS_LINUX
+    futex(counter, FUTEX_WAKE, INT_MAX, nullptr);
+#else
+    semaphore->post();
+#endif
+}
+
+bool BridgeSignal::wait(quint32 currentValue, qint64 timeout)
+{
+    if (!counter || counter->load() != currentValue)
+        return true;
+
+#if defined(Q_OS_LINUX)
+    timespec time;
+    time.tv_sec = static_cast<time_t>(timeout / 1000000000);
+    time.tv_nsec = static_cast<long>(timeout % 1000000000);
+
+    const long result = futex(counter, FUTEX_WAIT, currentValue, timeout < 0 ? nullptr : &time);
+
+    return result == 0 || errno != ETIMEDOUT;
+#elif defined(Q_OS_WIN)
+    return semaphore->wait(timeout) || counter->load() != currentValue;
+#else
+    if (timeout < 0) {
+        semaphore->wait();
+        return true;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    while (!semaphore->tryWait()) {
+        if (counter->load() != currentValue)
+            return true;
+
+        if (timer.nsecsElapsed() >= timeout)
+            return false;
+
+        usleep(50);
+    }
+
+    return true;
+#endif
+}
@@ -0,0 +1,45 @@
+#ifndef BRIDGE_SIGNAL_H
+#define BRIDGE_SIGNAL_H
+
+#include <QtGlobal>
+#include <QString>
+#include <QScopedPointer>
+#include <atomic>
+
+namespace audio {
+
+/**
+    Wake up a thread in another process waiting for a change in a 32 bits counter placed in the
+    shared memory. In Linux the counter itself is the futex word, so wake() is one system call and
+    wait() returns immediately when the counter was changed. Windows uses a named semaphore, other
+    platforms a POSIX named semaphore (timed waits are polling the counter, sem_timedwait is not
+    available in Mac).
+
+    wait() can return without a change in the counter (stale semaphore posts), the callers always
+    check the counter again.
+*/
+
+class BridgeSignal
+{
+public:
+    BridgeSignal();
+    ~BridgeSignal();
+
+    bool open(std::atomic<quint32> *counter, const QString &name, bool create); // the creator removes the named objects in close()
+    void close();
+
+    void wake(); // never blocks
+    bool wait(quint32 currentValue, qint64 timeout); // ns, -1 is infinite. Return false after the timeout
+
+private:
+    Q_DISABLE_COPY(BridgeSignal)
+
+    class Semaphore; // the platform named semaphore, not used in Linux
+
+    std::atomic<quint32> *counter;
+    QScopedPointer<Semaphore> semaphore;
+};
+
+} // namespace
+
+#endif // BRIDGE_SIGNAL_H
@@ -0,0 +1,119 @@
+#include "BridgeTestProcessor.h"
+
+#include <QDataStream>
+#include <QElapsedTimer>
+#include <QThread>
+#include <cstring>
+
+using audio::BridgeTestProcessor;
+
+const QString BridgeTestProcessor::PATH("builtin:test");
+
+BridgeTestProcessor::BridgeTestProcessor() :
+    gain(1.0f),
+    load(0),
+    stallTime(0),
+    sampleRate(44100),
+    bypassed(false),
+    suspended(false),
+    midiEvents(0)
+{
+
+}
+
+void BridgeTestProcessor::process(const float * const *inputs, float * const *outputs, int channels, int frames,
+                                  const std::vector<midi::MidiMessage> &midiMessages)
+{
+    midiEvents += static_cast<qint32>(midiMessages.size());
+
+    const int stall = stallTime.exchange(0);
+    if (stall > 0)
+        QThread::msleep(static_cast<unsigned long>(stall));
+
+    const qint64 loadTime = static_cast<qint64>(load.load()) * frames;
+    if (loadTime > 0) {
+        QElapsedTimer timer;
+        timer.start();
+        while (timer.nsecsElapsed() < loadTime) {
+            // simulating the plugin processing
+        }
+    }
+
+    const float g = bypassed ? 1.0f : gain.load();
+    for (int c = 0; c < channels; ++c) {
+        if (suspended) {
+            std::memset(outputs[c], 0, static_cast<size_t>(frames) * sizeof(float));
+            continue;
+        }
+
+        for (int i = 0; i < frames; ++i)
+            outputs[c][i] = inputs[c][i] * g;
+    }
+}
+
+void BridgeTestProcessor::setSampleRate(int sampleRate)
+{
+    this->sampleRate = sampleRate;
+}
+
+int BridgeTestProcessor::getSampleRate() const
+{
+    return sampleRate;
+}
+
+void BridgeTestProcessor::setBypass(bool bypass)
+{
+    bypassed = bypass;
+}
+
+void BridgeTestProcessor::suspend()
+{
+    suspended = true;
+}
+
+void BridgeTestProcessor::resume()
+{
+    suspended = false;
+}
+
+QByteArray BridgeTestProcessor::getState() const
+{
+    QByteArray state;
+    QDataStream stream(&state, QIODevice::WriteOnly);
+    stream << gain.load() << midiEvents;
+    return state;
+}
+
+bool BridgeTestProcessor::restoreState(const QByteArray &state)
+{
+    QDataStream stream(state);
+    float newGain;
+    qint32 newMidiEvents;
+    stream >> newGain >> newMidiEvents;
+    if (stream.status() != QDataStream::Ok)
+        return false;
+
+    gain = newGain;
+    midiEvents = newMidiEvents;
+    return true;
+}
+
+quint32 BridgeTestProcessor::getFlags() const
+{
+    return 0;
+}
+
+void BridgeTestProcessor::setGain(float gain)
+{
+    this->gain = gain;
+}
+
+void BridgeTestProcessor::setLoad(int load)
+{
+    this->load = load;
+}
+
+void BridgeTestProcessor::stall(int time)
+{
+    stallTime = time;
+}
@@ -0,0 +1,57 @@
+#ifndef BRIDGE_TEST_PROCESSOR_H
+#define BRIDGE_TEST_PROCESSOR_H
+
+#include "PluginBridgeChild.h"
+
+#include <atomic>
+
+namespace audio {
+
+/**
+    The built-in plugin used to test and measure the bridge without third party plugins (the
+    'builtin:test' path in the PluginBridge command line). The output is the input multiplied by
+    the gain, the received MIDI events are counted, and the processing can be loaded or stalled
+    to simulate heavy and misbehaving plugins.
+
+    The state is the gain and the MIDI events counter.
+*/
+
+class BridgeTestProcessor : public BridgeProcessor
+{
+public:
+    BridgeTestProcessor();
+
+    void process(const float * const *inputs, float * const *outputs, int channels, int frames,
+                 const std::vector<midi::MidiMessage> &midiMessages) override;
+
+    void setSampleRate(int sampleRate) override;
+    void setBypass(bool bypass) override;
+    void suspend() override;
+    void resume() override;
+
+    QByteArray getState() const override;
+    bool restoreState(const QByteArray &state) override;
+
+    quint32 getFlags() const override;
+
+    void setGain(float gain);
+    void setLoad(int load); // ns of busy processing per frame
+    void stall(int time); // ms, the next block is delayed
+
+    int getSampleRate() const;
+
+    static const QString PATH;
+
+private:
+    std::atomic<float> gain;
+    std::atomic<int> load;
+    std::atomic<int> stallTime;
+    std::atomic<int> sampleRate;
+    std::atomic<bool> bypassed;
+    std::atomic<bool> suspended;
+    qint32 midiEvents;
+};
+
+} // namespace
+
+#endif // BRIDGE_TEST_PROCESSOR_H
@@ -0,0 +1,207 @@
+#include "PluginBridgeChild.h"
+
+#include <QDebug>
+#include <cstring>
+
+using audio::PluginBridgeChild;
+using namespace audio::bridge;
+
+const int PluginBridgeChild::HOST_CHECK_PERIOD = 500;
+
+PluginBridgeChild::PluginBridgeChild() :
+    data(nullptr),
+    header(nullptr)
+{
+    midiMessages.reserve(MAX_MIDI_EVENTS);
+}
+
+PluginBridgeChild::~PluginBridgeChild()
+{
+    detach();
+}
+
+bool PluginBridgeChild::attach(const QString &key)
+{
+    detach();
+
+    sharedMemory.setKey(key);
+    if (!sharedMemory.attach()) {
+        qCritical() << "Can't attach the plugin bridge shared memory" << sharedMemory.errorString();
+        return false;
+    }
+
+    data = static_cast<char *>(sharedMemory.data());
+    header = reinterpret_cast<Header *>(data);
+
+    if (header->magic != MAGIC || header->version != VERSION || sharedMemory.size() < getSharedMemorySize(header->channels, header->maxFrames)) {
+        qCritical() << "Invalid plugin bridge shared memory";
+        detach();
+        return false;
+    }
+
+    if (!childSignal.open(&header->childSignal, key + "_c", false) || !completedSignal.open(&header->completed, key + "_h", false)) {
+        qCritical() << "Can't open the plugin bridge signals";
+        detach();
+        return false;
+    }
+
+    return true;
+}
+
+void PluginBridgeChild::detach()
+{
+    childSignal.close();
+    completedSignal.close();
+
+    header = nullptr;
+    data = nullptr;
+
+    if (sharedMemory.isAttached())
+        sharedMemory.detach();
+}
+
+int PluginBridgeChild::getChannels() const
+{
+    return header ? header->channels : 0;
+}
+
+int PluginBridgeChild::getMaxFrames() const
+{
+    return header ? header->maxFrames : 0;
+}
+
+void PluginBridgeChild::setReady(quint32 pluginFlags)
+{
+    if (!header)
+        return;
+
+    header->pluginFlags = pluginFlags;
+    header->childState = static_cast<qint32>(ChildState::Ready);
+}
+
+void PluginBridgeChild::setFailed()
+{
+    if (header)
+        header->childState = static_cast<qint32>(ChildState::Failed);
+}
+
+void PluginBridgeChild::run(BridgeProcessor *processor, const HostAliveChecker &isHostAlive)
+{
+    if (!header || !processor)
+        return;
+
+    quint32 processed = header->completed.load();
+    quint32 executedCommand = header->commandCompleted.load();
+    bool running = true;
+
+    while (running) {
+        const quint32 signal = header->childSignal.load();
+
+        const quint32 commandSequence = header->commandSequence.load(std::memory_order_acquire);
+        if (commandSequence != executedCommand) {
+            running = executeCommand(processor);
+            executedCommand = commandSequence;
+            header->commandCompleted.store(commandSequence, std::memory_order_release);
+        }
+
+        // the blocks are processed in order, late blocks included
+        quint32 requested = header->requested.load(std::memory_order_acquire);
+        while (running && processed != requested) {
+            processSlot(processor, static_cast<int>(processed % SLOTS));
+            header->completed = ++processed;
+            if (header->hostWaiting.load())
+                completedSignal.wake();
+
+            requested = header->requested.load(std::memory_order_acquire);
+        }
+
+        if (!running || signal != header->childSignal.load()) // new requests or commands
+            continue;
+
+        header->childWaiting = 1; // the host reads childWaiting after incrementing childSignal
+        if (signal == header->childSignal.load()) {
+            if (!childSignal.wait(signal, HOST_CHECK_PERIOD * Q_INT64_C(1000000)) && isHostAlive && !isHostAlive()) {
+                qWarning() << "The plugin bridge host is not running";
+                running = false;
+            }
+        }
+        header->childWaiting = 0;
+    }
+
+    header->childState = static_cast<qint32>(ChildState::Stopped);
+}
+
+void PluginBridgeChild::processSlot(BridgeProcessor *processor, int slotIndex)
+{
+    const int channels = header->channels;
+    const int maxFrames = header->maxFrames;
+    const Slot &slot = header->slots[slotIndex];
+    const int frames = qBound(0, slot.frames, maxFrames);
+
+    const float *inputs[MAX_CHANNELS];
+    float *outputs[MAX_CHANNELS];
+    for (int c = 0; c < channels; ++c) {
+        inputs[c] = getSlotInput(data, slotIndex, c, channels, maxFrames);
+        outputs[c] = getSlotOutput(data, slotIndex, c, channels, maxFrames);
+    }
+
+    midiMessages.clear();
+    const int midiEvents = qBound(0, slot.midiEvents, MAX_MIDI_EVENTS);
+    for (int m = 0; m < midiEvents; ++m) {
+        midiMessages.push_back(midi::MidiMessage(slot.midiData[m], -1));
+        midiMessages.back().setSampleOffset(qMin(slot.midiOffsets[m], static_cast<quint32>(qMax(frames - 1, 0))));
+    }
+
+    processor->process(inputs, outputs, channels, frames, midiMessages);
+}
+
+bool PluginBridgeChild::executeCommand(BridgeProcessor *processor)
+{
+    char *commandArea = data + getCommandDataOffset(header->channels, header->maxFrames);
+    const qint32 argument = header->commandArgument;
+    qint32 result = 1;
+    qint32 resultDataSize = 0;
+
+    switch (header->command) {
+    case Command::SetSampleRate:
+        processor->setSampleRate(argument);
+        break;
+    case Command::SetBypass:
+        processor->setBypass(argument != 0);
+        break;
+    case Command::Suspend:
+        processor->suspend();
+        break;
+    case Command::Resume:
+        processor->resume();
+        break;
+    case Command::GetState: {
+        const QByteArray state = processor->getState();
+        if (state.size() > MAX_COMMAND_DATA) {
+            result = 0;
+        }
+        else {
+            std::memcpy(commandArea, state.constData(), static_cast<size_t>(state.size()));
+            resultDataSize = state.size();
+        }
+        break;
+    }
+    case Command::SetState: {
+        const int size = qBound(0, header->commandDataSize, MAX_COMMAND_DATA);
+        result = processor->restoreState(QByteArray(commandArea, size)) ? 1 : 0;
+        break;
+    }
+    case Command::Quit:
+        header->commandResult = 1;
+        header->commandDataSize = 0;
+        return false;
+    case Command::None:
+        result = 0;
+        break;
+    }
+
+    header->commandResult = result;
+    header->commandDataSize = resultDataSize;
+
+    return true;
+}
@@ -0,0 +1,85 @@
+#ifndef PLUGIN_BRIDGE_CHILD_H
+#define PLUGIN_BRIDGE_CHILD_H
+
+#include "BridgeProtocol.h"
+#include "BridgeSignal.h"
+#include "midi/MidiMessage.h"
+
+#include <QSharedMemory>
+#include <QByteArray>
+#include <vector>
+#include <functional>
+
+namespace audio {
+
+/**
+    The audio processing running in the PluginBridge process: a plugins chain or the built-in
+    BridgeTestProcessor. All methods are called in the PluginBridgeChild::run() thread.
+*/
+
+class BridgeProcessor
+{
+public:
+    virtual ~BridgeProcessor() {}
+
+    virtual void process(const float * const *inputs, float * const *outputs, int channels, int frames,
+                         const std::vector<midi::MidiMessage> &midiMessages) = 0;
+
+    virtual void setSampleRate(int sampleRate) = 0;
+    virtual void setBypass(bool bypass) = 0;
+    virtual void suspend() = 0;
+    virtual void resume() = 0;
+
+    virtual QByteArray getState() const = 0;
+    virtual bool restoreState(const QByteArray &state) = 0;
+
+    virtual quint32 getFlags() const = 0; // bridge::PluginFlags
+};
+
+// +++++++++++++++++++++++++++++++++++++++++
+
+/**
+    The plugin side of the bridge: attach to the shared memory created by PluginBridgeHost and
+    process the audio blocks and commands until the Quit command or the host process dies.
+*/
+
+class PluginBridgeChild
+{
+public:
+    typedef std::function<bool()> HostAliveChecker;
+
+    PluginBridgeChild();
+    ~PluginBridgeChild();
+
+    bool attach(const QString &key);
+    void detach();
+
+    int getChannels() const;
+    int getMaxFrames() const;
+
+    void setReady(quint32 pluginFlags); // the plugins are loaded, the host can send audio blocks
+    void setFailed();
+
+    void run(BridgeProcessor *processor, const HostAliveChecker &isHostAlive);
+
+    static const int HOST_CHECK_PERIOD; // ms, the host is checked when no blocks are received in this period
+
+private:
+    Q_DISABLE_COPY(PluginBridgeChild)
+
+    void processSlot(BridgeProcessor *processor, int slotIndex);
+    bool executeCommand(BridgeProcessor *processor); // return false in Quit
+
+    QSharedMemory sharedMemory;
+    char *data;
+    bridge::Header *header;
+
+    BridgeSignal childSignal;
+    BridgeSignal completedSignal;
+
+    std::vector<midi::MidiMessage> midiMessages; // reused in all blocks, no allocations in the audio path
+};
+
+} // namespace
+
+#endif // PLUGIN_BRIDGE_CHILD_H
@@ -0,0 +1,250 @@
+#include "PluginBridgeHost.h"
+
+#include <QElapsedTimer>
+#include <QThread>
+#include <QDebug>
+#include <cstring>
+#include <new>
+
+using audio::PluginBridgeHost;
+using namespace audio::bridge;
+
+const int PluginBridgeHost::COMMAND_TIMEOUT = 5000;
+const int PluginBridgeHost::SPIN_TIME = 20000;
+
+namespace {
+
+inline bool reached(quint32 counter, quint32 target) // the counters can wrap
+{
+    return static_cast<qint32>(counter - target) >= 0;
+}
+
+} // namespace
+
+PluginBridgeHost::PluginBridgeHost() :
+    data(nullptr),
+    header(nullptr),
+    requested(0),
+    lateBlocks(0),
+    droppedBlocks(0)
+{
+
+}
+
+PluginBridgeHost::~PluginBridgeHost()
+{
+    destroy();
+}
+
+bool PluginBridgeHost::create(const QString &key, int channels, int maxFrames)
+{
+    destroy();
+
+    channels = qBound(1, channels, MAX_CHANNELS);
+    const int size = getSharedMemorySize(channels, maxFrames);
+
+    sharedMemory.setKey(key);
+    if (!sharedMemory.create(size)) {
+        if (sharedMemory.error() == QSharedMemory::AlreadyExists && sharedMemory.attach()) { // a segment leaked by a crashed Jamtaba, removed in the last detach (Unix)
+            sharedMemory.detach();
+            sharedMemory.create(size);
+        }
+
+        if (!sharedMemory.isAttached()) {
+            qCritical() << "Can't create the plugin bridge shared memory" << sharedMemory.errorString();
+            return false;
+        }
+    }
+
+    data = static_cast<char *>(sharedMemory.data());
+    std::memset(data, 0, static_cast<size_t>(getAudioOffset()));
+    header = new (data) Header();
+    header->magic = MAGIC;
+    header->version = VERSION;
+    header->channels = channels;
+    header->maxFrames = maxFrames;
+    header->childState = static_cast<qint32>(ChildState::Starting);
+
+    if (!childSignal.open(&header->childSignal, key + "_c", true) || !completedSignal.open(&header->completed, key + "_h", true)) {
+        qCritical() << "Can't create the plugin bridge signals";
+        destroy();
+        return false;
+    }
+
+    requested = 0;
+    lateBlocks = 0;
+    droppedBlocks = 0;
+
+    return true;
+}
+
+void PluginBridgeHost::destroy()
+{
+    if (isChildReady())
+        sendCommand(Command::Quit);
+
+    childSignal.close();
+    completedSignal.close();
+
+    if (header) {
+        header->~Header();
+        header = nullptr;
+    }
+
+    data = nullptr;
+
+    if (sharedMemory.isAttached())
+        sharedMemory.detach();
+}
+
+QString PluginBridgeHost::getKey() const
+{
+    return sharedMemory.key();
+}
+
+bool PluginBridgeHost::isChildReady() const
+{
+    return header && header->childState.load() == static_cast<qint32>(ChildState::Ready);
+}
+
+void PluginBridgeHost::setChildFinished()
+{
+    if (header)
+        header->childState = static_cast<qint32>(ChildState::Stopped);
+}
+
+quint32 PluginBridgeHost::getPluginFlags() const
+{
+    return header ? header->pluginFlags.load() : 0;
+}
+
+bool PluginBridgeHost::waitChildReady(int timeout)
+{
+    if (!header)
+        return false;
+
+    QElapsedTimer timer;
+    timer.start();
+    while (header->childState.load() == static_cast<qint32>(ChildState::Starting) && timer.elapsed() < timeout)
+        QThread::msleep(5);
+
+    return isChildReady();
+}
+
+void PluginBridgeHost::writeSilence(float * const *outputs, int channels, int frames)
+{
+    for (int c = 0; c < channels; ++c)
+        std::memset(outputs[c], 0, static_cast<size_t>(frames) * sizeof(float));
+}
+
+bool PluginBridgeHost::process(const float * const *inputs, float * const *outputs, int channels, int frames,
+                               const std::vector<midi::MidiMessage> &midiMessages, qint64 timeout)
+{
+    QElapsedTimer timer; // the timeout includes the copies to the shared memory
+    timer.start();
+
+    if (!isChildReady() || frames > header->maxFrames || channels < 1) {
+        writeSilence(outputs, channels, frames);
+        return false;
+    }
+
+    if (requested - header->completed.load(std::memory_order_acquire) >= static_cast<quint32>(SLOTS)) { // the child is stalled, the ring is full
+        droppedBlocks++;
+        writeSilence(outputs, channels, frames);
+        return false;
+    }
+
+    // writing the request in the free slot
+    const int slotIndex = static_cast<int>(requested % SLOTS);
+    const int sharedChannels = header->channels;
+    const int maxFrames = header->maxFrames;
+    Slot &slot = header->slots[slotIndex];
+
+    slot.frames = frames;
+    for (int c = 0; c < sharedChannels; ++c) // mono inputs are copied in all bridge channels
+        std::memcpy(getSlotInput(data, slotIndex, c, sharedChannels, maxFrames), inputs[qMin(c, channels - 1)], static_cast<size_t>(frames) * sizeof(float));
+
+    slot.midiEvents = qMin(static_cast<int>(midiMessages.size()), MAX_MIDI_EVENTS);
+    for (int m = 0; m < slot.midiEvents; ++m) {
+        const auto &message = midiMessages[static_cast<size_t>(m)];
+        slot.midiData[m] = message.getStatus() | (message.getData1() << 8) | (message.getData2() << 16);
+        slot.midiOffsets[m] = message.getSampleOffset();
+    }
+
+    header->requested.store(++requested, std::memory_order_release);
+    header->childSignal++;
+    if (header->childWaiting.load())
+        childSignal.wake();
+
+    // waiting the child until the deadline
+    const qint64 spinTime = qMin(timeout, static_cast<qint64>(SPIN_TIME));
+    quint32 completed = header->completed.load(std::memory_order_acquire);
+    while (!reached(completed, requested) && timer.nsecsElapsed() < spinTime)
+        completed = header->completed.load(std::memory_order_acquire);
+
+    if (!reached(completed, requested)) {
+        header->hostWaiting = 1; // the child reads hostWaiting after incrementing 'completed' (both seq_cst, no lost wake up)
+        completed = header->completed.load();
+        while (!reached(completed, requested)) {
+            const qint64 remainingTime = timeout - timer.nsecsElapsed();
+            if (remainingTime <= 0)
+                break;
+
+            completedSignal.wait(completed, remainingTime);
+            completed = header->completed.load();
+        }
+        header->hostWaiting = 0;
+    }
+
+    if (!reached(completed, requested)) { // the output is discarded when this block is processed
+        lateBlocks++;
+        writeSilence(outputs, channels, frames);
+        return false;
+    }
+
+    for (int c = 0; c < channels; ++c)
+        std::memcpy(outputs[c], getSlotOutput(data, slotIndex, qMin(c, sharedChannels - 1), sharedChannels, maxFrames), static_cast<size_t>(frames) * sizeof(float));
+
+    return true;
+}
+
+bool PluginBridgeHost::sendCommand(Command command, qint32 argument, const QByteArray &commandData, QByteArray *result)
+{
+    if (!isChildReady())
+        return false;
+
+    char *commandArea = data + getCommandDataOffset(header->channels, header->maxFrames);
+    const int dataSize = qMin(commandData.size(), MAX_COMMAND_DATA);
+    if (dataSize > 0)
+        std::memcpy(commandArea, commandData.constData(), static_cast<size_t>(dataSize));
+
+    header->command = command;
+    header->commandArgument = argument;
+    header->commandDataSize = dataSize;
+    header->commandResult = 0;
+
+    const quint32 sequence = header->commandSequence.load() + 1;
+    header->commandSequence.store(sequence, std::memory_order_release);
+    header->childSignal++;
+    if (header->childWaiting.load())
+        childSignal.wake();
+
+    QElapsedTimer timer;
+    timer.start();
+    while (header->commandCompleted.load(std::memory_order_acquire) != sequence) {
+        if (timer.elapsed() > COMMAND_TIMEOUT || header->childState.load() != static_cast<qint32>(ChildState::Ready)) {
+            if (command == Command::Quit)
+                return true;
+
+            qCritical() << "Plugin bridge command timeout" << static_cast<int>(command);
+            return false;
+        }
+
+        QThread::usleep(100);
+    }
+
+    if (result)
+        *result = QByteArray(commandArea, qBound(0, header->commandDataSize, MAX_COMMAND_DATA));
+
+    return header->commandResult != 0;
+}
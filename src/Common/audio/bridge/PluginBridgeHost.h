@@ -0,0 +1,85 @@
+#ifndef PLUGIN_BRIDGE_HOST_H
+#define PLUGIN_BRIDGE_HOST_H
+
+#include "BridgeProtocol.h"
+#include "BridgeSignal.h"
+#include "midi/MidiMessage.h"
+
+#include <QSharedMemory>
+#include <QByteArray>
+#include <vector>
+
+namespace audio {
+
+/**
+    The Jamtaba side of the plugin bridge. The shared memory is created here and the PluginBridge
+    process (started by the caller) attach to it with PluginBridgeChild.
+
+    process() is called in the audio thread and never waits more than the timeout (the time
+    remaining until the audio callback deadline, shared by all the bridged inserts): when the
+    child is late, stalled or crashed the output is silence and the audio callback continues.
+    The late blocks are still processed by the child (the plugins have a continuous input) and
+    their output is discarded. When the child is SLOTS - 1 blocks behind the new blocks are
+    dropped.
+*/
+
+class PluginBridgeHost
+{
+public:
+    PluginBridgeHost();
+    ~PluginBridgeHost();
+
+    bool create(const QString &key, int channels, int maxFrames);
+    void destroy();
+
+    QString getKey() const;
+
+    bool waitChildReady(int timeout); // ms, called in main thread after starting the child process
+    bool isChildReady() const;
+    void setChildFinished(); // the child process crashed or finished, process() returns silence without waiting
+    quint32 getPluginFlags() const; // bridge::PluginFlags
+
+    // audio thread, return false when the output is silence (late or dropped block)
+    bool process(const float * const *inputs, float * const *outputs, int channels, int frames,
+                 const std::vector<midi::MidiMessage> &midiMessages, qint64 timeout); // ns
+
+    // main thread, the commands are executed by the child between audio blocks
+    bool sendCommand(bridge::Command command, qint32 argument = 0, const QByteArray &data = QByteArray(), QByteArray *result = nullptr);
+
+    quint64 getLateBlocks() const;
+    quint64 getDroppedBlocks() const;
+
+    static const int COMMAND_TIMEOUT; // ms
+    static const int SPIN_TIME; // ns, busy waiting before sleeping in the futex/semaphore
+
+private:
+    Q_DISABLE_COPY(PluginBridgeHost)
+
+    void writeSilence(float * const *outputs, int channels, int frames);
+
+    QSharedMemory sharedMemory;
+    char *data;
+    bridge::Header *header;
+
+    BridgeSignal childSignal;
+    BridgeSignal completedSignal;
+
+    quint32 requested;
+
+    std::atomic<quint64> lateBlocks;
+    std::atomic<quint64> droppedBlocks;
+};
+
+inline quint64 PluginBridgeHost::getLateBlocks() const
+{
+    return lateBlocks.load();
+}
+
+inline quint64 PluginBridgeHost::getDroppedBlocks() const
+{
+    return droppedBlocks.load();
+}
+
+} // namespace
+
+#endif // PLUGIN_BRIDGE_HOST_H
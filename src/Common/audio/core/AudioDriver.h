@@ -18,6 +18,10 @@ class MainController;
 
 namespace audio {
 
+// the biggest buffer size (in samples) offered in audio preferences. Buffers used in the audio thread
+// reserve this size in constructors to avoid memory allocations when processing audio.
+const uint MAX_BUFFER_SIZE = 4096;
+
 class ChannelRange
 {
 
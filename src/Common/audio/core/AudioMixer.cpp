@@ -10,22 +10,71 @@ using audio::AudioMixer;
 using audio::AudioNode;
 using audio::SamplesBuffer;
 
+class AudioMixer::RenderContext
+{
+public:
+    RenderContext() :
+        output(2),
+        processed(false)
+    {
+        output.reserve(MAX_BUFFER_SIZE);
+    }
+
+    SamplesBuffer output; // the node output, summed in the audio thread after all nodes are rendered
+    bool processed; // false for muted nodes, the output is rendered but discarded
+};
+
+// ++++++++++++++++++++++++++++++++++++++++++++++++
+
 AudioMixer::AudioMixer(int sampleRate) :
-    sampleRate(sampleRate)
+    renderThreads(1),
+    sampleRate(sampleRate),
+    discardedOutputBuffer(2)
 {
+    discardedOutputBuffer.reserve(MAX_BUFFER_SIZE);
 
 }
 
 void AudioMixer::addNode(QSharedPointer<AudioNode> node)
 {
-    nodes.append(node);
+    QMutexLocker locker(&nodesMutex);
+
+    nodes.append({node, QSharedPointer<RenderContext>::create()}); // render buffers are allocated here, not in audio thread
     resamplers.insert(node, SamplesBufferResampler());
+
+    nodesSnapshot.publish(nodes);
 }
 
 void AudioMixer::removeNode(QSharedPointer<AudioNode> node)
 {
-    nodes.removeOne(node);
+    QMutexLocker locker(&nodesMutex);
+
+    for (int i = 0; i < nodes.size(); ++i) {
+        if (nodes.at(i).node == node) {
+            nodes.removeAt(i);
+            break;
+        }
+    }
     resamplers.remove(node);
+
+    nodesSnapshot.publish(nodes); // the removed node is released only when the audio thread is not using the old snapshot
+}
+
+void AudioMixer::setRenderThreads(int threads)
+{
+    threads = qBound(1, threads, MAX_RENDER_THREADS);
+    if (threads == renderThreads)
+        return;
+
+    renderThreads = threads;
+
+    QSharedPointer<RenderWorkers> workers;
+    if (threads > 1)
+        workers = QSharedPointer<RenderWorkers>::create(threads);
+
+    renderWorkers.publish(workers); // the old workers are stopped when the audio thread is not using them
+
+    qCDebug(jtAudio) << "Rendering audio nodes using" << threads << "threads";
 }
 
 AudioMixer::~AudioMixer()
@@ -38,35 +87,115 @@ AudioMixer::~AudioMixer()
     qCDebug(jtAudio) << "Audio mixer destructor finished!";
 }
 
+bool AudioMixer::canProcess(const AudioNode &node, bool hasSoloedBuffers)
+{
+    return (!hasSoloedBuffers && !node.isMuted()) || (hasSoloedBuffers && node.isSoloed());
+}
+
 void AudioMixer::process(const SamplesBuffer &in, SamplesBuffer &out, int sampleRate, const std::vector<midi::MidiMessage> &midiBuffer, bool attenuateAfterSumming)
 {
     static int soloedBuffersInLastProcess = 0;
+
+    SnapshotReadSection readSection;
+    const auto &currentNodes = nodesSnapshot.read(); // nodes added or removed in other threads are visible only in the next process() call
+    const auto &workers = renderWorkers.read();
     // --------------------------------------
     bool hasSoloedBuffers = soloedBuffersInLastProcess > 0;
-    soloedBuffersInLastProcess = 0;
-    for (const auto& node : qAsConst(nodes)) {
-        bool canProcess = (!hasSoloedBuffers && !node->isMuted()) || (hasSoloedBuffers && node->isSoloed());
-        if (canProcess) {
 
-            // each channel (not subchannel) will receive a full copy of incomming midi messages
-            std::vector<midi::MidiMessage> midiMessages(midiBuffer.size());
-            midiMessages.insert(midiMessages.begin(), midiBuffer.begin(), midiBuffer.end());
+    if (workers && currentNodes.size() > 1 && out.getChannels() <= 2)
+        processParallel(*workers, currentNodes, in, out, sampleRate, midiBuffer, hasSoloedBuffers);
+    else
+        processSerial(currentNodes, in, out, sampleRate, midiBuffer, hasSoloedBuffers);
 
-            node->processReplacing(in, out, sampleRate, midiMessages);
-        }
-        else { // just discard the samples if node is muted, the internalBuffer is not copyed to out buffer
-            static audio::SamplesBuffer internalBuffer(2);
-            static std::vector<midi::MidiMessage> emptyMidiBuffer;
-            internalBuffer.setFrameLenght(out.getFrameLenght());
-            node->processReplacing(in, internalBuffer, sampleRate, emptyMidiBuffer);
-        }
-        if (node->isSoloed())
+    soloedBuffersInLastProcess = 0;
+    for (const auto &mixerNode : currentNodes) {
+        if (mixerNode.node->isSoloed())
             soloedBuffersInLastProcess++;
     }
 
     if (attenuateAfterSumming) {
-        int nodesConnected = nodes.size();
+        int nodesConnected = currentNodes.size();
         if (nodesConnected > 1) // attenuate
             out.applyGain(1.0/nodesConnected, 0.0);
     }
 }
+
+void AudioMixer::processSerial(const QList<MixerNode> &nodesToProcess, const SamplesBuffer &in, SamplesBuffer &out, int sampleRate, const std::vector<midi::MidiMessage> &midiBuffer, bool hasSoloedBuffers)
+{
+    for (const auto &mixerNode : nodesToProcess) {
+        const auto &node = mixerNode.node;
+        if (canProcess(*node, hasSoloedBuffers)) {
+            node->processReplacing(in, out, sampleRate, midiBuffer); // all nodes are reading the same incomming midi messages, no copies
+        }
+        else { // just discard the samples if node is muted, the internalBuffer is not copyed to out buffer
+            discardedOutputBuffer.setFrameLenght(out.getFrameLenght());
+            node->processReplacing(in, discardedOutputBuffer, sampleRate, emptyMidiBuffer);
+        }
+    }
+}
+
+/**
+    Every node is rendered in your own buffer (RenderContext), by a worker or by the audio thread.
+    Nodes touching other nodes or shared objects (canBeRenderedInParallel() == false) are rendered
+    by the audio thread while the workers are busy. The flag is evaluated only once, before the
+    fork, because it can be changed by the GUI while the nodes are rendered. The outputs are summed in the nodes order, so
+    the result is the same produced by processSerial().
+*/
+void AudioMixer::processParallel(RenderWorkers &workers, const QList<MixerNode> &nodesToProcess, const SamplesBuffer &in, SamplesBuffer &out, int sampleRate, const std::vector<midi::MidiMessage> &midiBuffer, bool hasSoloedBuffers)
+{
+    parallelJob.nodes = &nodesToProcess;
+    parallelJob.in = &in;
+    parallelJob.midiBuffer = &midiBuffer;
+    parallelJob.sampleRate = sampleRate;
+    parallelJob.frames = out.getFrameLenght();
+    parallelJob.channels = out.getChannels();
+    parallelJob.hasSoloedBuffers = hasSoloedBuffers;
+
+    for (const auto &mixerNode : nodesToProcess)
+        mixerNode.node->setRenderingInParallel(mixerNode.node->canBeRenderedInParallel());
+
+    workers.fork(nodesToProcess.size(), &AudioMixer::renderParallelNode, this); // the flags are visible to the workers after the fork
+
+    for (const auto &mixerNode : nodesToProcess) {
+        if (!mixerNode.node->isRenderingInParallel())
+            renderNode(mixerNode);
+    }
+
+    workers.join();
+
+    for (const auto &mixerNode : nodesToProcess) { // deterministic summing pass
+        mixerNode.node->setRenderingInParallel(false); // the node can be rendered by processSerial() in the next callback
+
+        const auto &renderContext = *mixerNode.renderContext;
+        if (renderContext.processed)
+            out.add(renderContext.output);
+    }
+}
+
+void AudioMixer::renderParallelNode(void *mixer, int nodeIndex)
+{
+    auto audioMixer = static_cast<AudioMixer *>(mixer);
+    const auto &mixerNode = audioMixer->parallelJob.nodes->at(nodeIndex);
+    if (mixerNode.node->isRenderingInParallel())
+        audioMixer->renderNode(mixerNode);
+}
+
+void AudioMixer::renderNode(const MixerNode &mixerNode) const
+{
+    auto &renderContext = *mixerNode.renderContext;
+    auto &output = renderContext.output;
+
+    if (parallelJob.channels == 1)
+        output.setToMono();
+    else
+        output.setToStereo(); // no allocation, 2 channels are preallocated
+
+    output.setFrameLenght(parallelJob.frames);
+    output.zero();
+
+    renderContext.processed = canProcess(*mixerNode.node, parallelJob.hasSoloedBuffers);
+
+    // the incomming midi messages are read (never changed) by all nodes, in parallel
+    const auto &midiBuffer = renderContext.processed ? *parallelJob.midiBuffer : emptyMidiBuffer;
+    mixerNode.node->processReplacing(*parallelJob.in, output, parallelJob.sampleRate, midiBuffer);
+}
@@ -7,15 +7,14 @@
 #include <QScopedPointer>
 #include <QSharedPointer>
 #include "audio/SamplesBufferResampler.h"
-
-namespace midi {
-class MidiMessage;
-}
+#include "audio/core/SamplesBuffer.h"
+#include "audio/core/SnapshotPublisher.h"
+#include "audio/core/RenderWorkers.h"
+#include "midi/MidiMessage.h"
 
 namespace audio {
 
 class AudioNode;
-class SamplesBuffer;
 class LocalInputNode;
 
 class AudioMixer
@@ -33,11 +32,52 @@ public:
 
     void setSampleRate(int newSampleRate);
 
+    void setRenderThreads(int threads); // 1 = render all nodes in audio thread (default), more threads = render independent nodes in parallel
+    int getRenderThreads() const;
+
 private:
-    QList<QSharedPointer<AudioNode>> nodes;
+    class RenderContext; // buffers used to render one node in a worker thread
+
+    struct MixerNode
+    {
+        QSharedPointer<AudioNode> node;
+        QSharedPointer<RenderContext> renderContext;
+    };
+
+    QList<MixerNode> nodes; // changed in GUI and ninjam threads, the audio thread is iterating over nodesSnapshot
+    SnapshotPublisher<QList<MixerNode>> nodesSnapshot;
+    QMutex nodesMutex; // serialize the writers, never locked in audio thread
+
+    SnapshotPublisher<QSharedPointer<RenderWorkers>> renderWorkers; // null when rendering in audio thread only
+    int renderThreads;
+
+    void processSerial(const QList<MixerNode> &nodesToProcess, const SamplesBuffer &in, SamplesBuffer &out, int sampleRate, const std::vector<midi::MidiMessage> &midiBuffer, bool hasSoloedBuffers);
+    void processParallel(RenderWorkers &workers, const QList<MixerNode> &nodesToProcess, const SamplesBuffer &in, SamplesBuffer &out, int sampleRate, const std::vector<midi::MidiMessage> &midiBuffer, bool hasSoloedBuffers);
+
+    static bool canProcess(const AudioNode &node, bool hasSoloedBuffers);
+    static void renderParallelNode(void *mixer, int nodeIndex); // RenderWorkers task
+    void renderNode(const MixerNode &mixerNode) const;
+
+    struct ParallelJob // parameters used by the workers in current process() call
+    {
+        const QList<MixerNode> *nodes;
+        const SamplesBuffer *in;
+        const std::vector<midi::MidiMessage> *midiBuffer;
+        int sampleRate;
+        uint frames;
+        uint channels;
+        bool hasSoloedBuffers;
+    };
+
+    ParallelJob parallelJob;
+
     int sampleRate;
     QMap<QSharedPointer<AudioNode>, SamplesBufferResampler> resamplers;
 
+    // preallocated buffers reused in every process() call
+    const std::vector<midi::MidiMessage> emptyMidiBuffer; // muted nodes are not receiving midi
+    SamplesBuffer discardedOutputBuffer; // used to process muted nodes
+
 };
 
 inline void AudioMixer::setSampleRate(int newSampleRate)
@@ -45,6 +85,11 @@ inline void AudioMixer::setSampleRate(int newSampleRate)
     sampleRate = newSampleRate;
 }
 
+inline int AudioMixer::getRenderThreads() const
+{
+    return renderThreads;
+}
+
 } // namespace
 
 #endif
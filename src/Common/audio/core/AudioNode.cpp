@@ -19,51 +19,51 @@ using audio::AudioNodeProcessor;
 const double AudioNode::ROOT_2_OVER_2 = 1.414213562373095 * 0.5;
 const double AudioNode::PI_OVER_2 = 3.141592653589793238463 * 0.5;
 
-void AudioNode::processReplacing(const SamplesBuffer &in, SamplesBuffer &out, int sampleRate, std::vector<midi::MidiMessage> &midiBuffer)
+void AudioNode::processReplacing(const SamplesBuffer &in, SamplesBuffer &out, int sampleRate, const std::vector<midi::MidiMessage> &midiBuffer)
 {
     Q_UNUSED(in);
+    Q_UNUSED(midiBuffer); // the incoming midi messages are filtered and sended to plugins only in input tracks (LocalInputNode)
 
+    processorsMidiBuffer.clear(); // keep the reserved capacity, plugins can append the generated messages
+    processNode(out, sampleRate, processorsMidiBuffer);
+}
+
+void AudioNode::processNode(SamplesBuffer &out, int sampleRate, std::vector<midi::MidiMessage> &midiBuffer)
+{
     if (!isActivated())
         return;
 
     internalInputBuffer.setFrameLenght(out.getFrameLenght());
     internalOutputBuffer.setFrameLenght(out.getFrameLenght());
 
-    {
-        QMutexLocker locker(&mutex);
-        for (auto node : qAsConst(connections)) { // ask connected nodes to generate audio
-            node->processReplacing(internalInputBuffer, internalOutputBuffer, sampleRate, midiBuffer);
-        }
+    for (auto node : connectionsSnapshot.read()) { // ask connected nodes to generate audio
+        node->processReplacing(internalInputBuffer, internalOutputBuffer, sampleRate, midiBuffer);
     }
 
     internalOutputBuffer.set(internalInputBuffer); // if we have no plugins inserted the input samples are just copied  to output buffer.
 
-    static SamplesBuffer tempInputBuffer(2);
-
     // process inserted plugins
-    for (int i=0; i < MAX_PROCESSORS_PER_TRACK; ++i) {
-        auto processor = processors[i];
+    for (const auto &processor : processorsSnapshot.read()) {
         if (processor && !processor->isBypassed()) {
-            tempInputBuffer.setFrameLenght(internalOutputBuffer.getFrameLenght());
-            tempInputBuffer.set(internalOutputBuffer); // the output from previous plugin is used as input to the next plugin in the chain
+            if (renderingInParallel)
+                break; // inserted after the parallel render was started, processed in the next audio callback
+
+            pluginInputBuffer.setFrameLenght(internalOutputBuffer.getFrameLenght());
+            pluginInputBuffer.set(internalOutputBuffer); // the output from previous plugin is used as input to the next plugin in the chain
 
-            processor->process(tempInputBuffer, internalOutputBuffer, midiBuffer);
+            processor->process(pluginInputBuffer, internalOutputBuffer, midiBuffer);
 
             // some plugins are blocking the midi messages. If a VSTi can't generate messages the previous messages list will be sended for the next plugin in the chain. The messages list is cleared only when the plugin can generate midi messages.
             if (processor->isVirtualInstrument() && processor->canGenerateMidiMessages())
                 midiBuffer.clear(); // only the fresh messages will be passed by the next plugin in the chain
 
-
-            auto pulledMessages = pullMidiMessagesGeneratedByPlugins();
-            midiBuffer.insert(midiBuffer.end(), pulledMessages.begin(), pulledMessages.end());
+            pullMidiMessagesGeneratedByPlugins(midiBuffer);
         }
     }
 
     preFaderProcess(internalOutputBuffer); //call overrided preFaderProcess in subclasses to allow some preFader process.
 
-    internalOutputBuffer.applyGain(gain, leftGain, rightGain, boost);
-
-    lastPeak.update(internalOutputBuffer.computePeak());
+    lastPeak.update(internalOutputBuffer.applyGainAndComputePeak(gain, leftGain, rightGain, boost));
 
     postFaderProcess(internalOutputBuffer);
 
@@ -78,6 +78,7 @@ void AudioNode::setRmsWindowSize(int samples)
 AudioNode::AudioNode() :
     internalInputBuffer(2),
     internalOutputBuffer(2),
+    pluginInputBuffer(2),
     lastPeak(),
     pan(0),
     leftGain(1.0),
@@ -85,35 +86,39 @@ AudioNode::AudioNode() :
     muted(false),
     soloed(false),
     activated(true),
+    renderingInParallel(false),
     gain(1),
     boost(1),
-    resamplingCorrection(0)
+    processorsSnapshot(QVector<QSharedPointer<AudioNodeProcessor>>(MAX_PROCESSORS_PER_TRACK))
 {
+    internalInputBuffer.reserve(MAX_BUFFER_SIZE);
+    internalOutputBuffer.reserve(MAX_BUFFER_SIZE);
+    pluginInputBuffer.reserve(MAX_BUFFER_SIZE);
+    processorsMidiBuffer.reserve(midi::MAX_MESSAGES_PER_BUFFER);
 
     for (int i=0; i < MAX_PROCESSORS_PER_TRACK; ++i) {
         processors[i] = nullptr;
     }
 }
 
-std::vector<midi::MidiMessage> AudioNode::pullMidiMessagesGeneratedByPlugins() const
+bool AudioNode::canBeRenderedInParallel() const
 {
-    return std::vector<midi::MidiMessage>(); // returning empty vector by default, is overrided in LocalInputNode
+    return !hasProcessors(); // all plugins are sharing the same host (generated midi messages)
 }
 
-int AudioNode::getInputResamplingLength(int sourceSampleRate, int targetSampleRate, int outFrameLenght)
+bool AudioNode::hasProcessors() const
 {
-    double doubleValue = static_cast<double>(sourceSampleRate) * static_cast<double>(outFrameLenght) / static_cast<double>(targetSampleRate);
-    int intValue = static_cast<int>(doubleValue);
-    resamplingCorrection += doubleValue - intValue;
-    if (qAbs(resamplingCorrection) > 1) {
-        intValue += resamplingCorrection;
-        if (resamplingCorrection > 0)
-            resamplingCorrection--;
-        else
-            resamplingCorrection++;
+    for (const auto &processor : processorsSnapshot.read()) {
+        if (processor)
+            return true;
     }
 
-    return intValue;
+    return false;
+}
+
+void AudioNode::pullMidiMessagesGeneratedByPlugins(std::vector<midi::MidiMessage> &pulledMessages) const
+{
+    Q_UNUSED(pulledMessages); // no messages by default, is overrided in LocalInputNode
 }
 
 AudioPeak AudioNode::getLastPeak() const
@@ -194,34 +199,59 @@ AudioNode::~AudioNode()
 
 bool AudioNode::connect(AudioNode &other)
 {
-    QMutexLocker(&(other.mutex));
+    QMutexLocker locker(&(other.mutex));
 
     other.connections.insert(this);
+    other.publishConnections();
 
     return true;
 }
 
 bool AudioNode::disconnect(AudioNode &otherNode)
 {
-    QMutexLocker(&(otherNode.mutex));
+    QMutexLocker locker(&(otherNode.mutex));
+
     otherNode.connections.remove(this);
+    otherNode.publishConnections();
+
     return true;
 }
 
+void AudioNode::publishConnections()
+{
+    connectionsSnapshot.publish(connections.values());
+}
+
+void AudioNode::publishProcessors()
+{
+    QVector<QSharedPointer<AudioNodeProcessor>> processorsChain;
+    processorsChain.reserve(MAX_PROCESSORS_PER_TRACK);
+    for (int i = 0; i < MAX_PROCESSORS_PER_TRACK; ++i)
+        processorsChain.append(processors[i]);
+
+    processorsSnapshot.publish(processorsChain); // the removed processors are released here, after the audio thread stop using them
+}
+
 void AudioNode::addProcessor(const QSharedPointer<AudioNodeProcessor> &newProcessor, quint32 slotIndex)
 {
     assert(newProcessor);
     assert(slotIndex < MAX_PROCESSORS_PER_TRACK);
+
+    QMutexLocker locker(&mutex);
     processors[slotIndex] = newProcessor;
+    publishProcessors();
 }
 
 void AudioNode::removeProcessor(const QSharedPointer<AudioNodeProcessor> &processor)
 {
     assert(processor);
     processor->suspend();
+
+    QMutexLocker locker(&mutex);
     for (int i = 0; i < MAX_PROCESSORS_PER_TRACK; ++i) {
         if (processors[i] == processor){
             processors[i] = nullptr;
+            publishProcessors();
             break;
         }
     }
@@ -229,6 +259,7 @@ void AudioNode::removeProcessor(const QSharedPointer<AudioNodeProcessor> &proces
 
 void AudioNode::suspendProcessors()
 {
+    QMutexLocker locker(&mutex);
     for (int i = 0; i < MAX_PROCESSORS_PER_TRACK; ++i) {
         if (processors[i])
             processors[i]->suspend();
@@ -246,6 +277,7 @@ void AudioNode::updateProcessorsGui()
 
 void AudioNode::resumeProcessors()
 {
+    QMutexLocker locker(&mutex);
     for (int i = 0; i < MAX_PROCESSORS_PER_TRACK; ++i) {
         if (processors[i])
             processors[i]->resume();
@@ -3,7 +3,9 @@
 
 #include <QSet>
 #include <QMutex>
+#include <QVector>
 #include "SamplesBuffer.h"
+#include "SnapshotPublisher.h"
 #include "AudioDriver.h"
 #include "midi/MidiMessage.h"
 #include <QDebug>
@@ -21,9 +23,10 @@ public:
     AudioNode();
     virtual ~AudioNode();
 
-    virtual void processReplacing(const SamplesBuffer &in, SamplesBuffer &out, int sampleRate, std::vector<midi::MidiMessage> &midiBuffer);
+    // 'midiBuffer' is a read only view of the midi messages received in current audio block, the same messages are read by all nodes
+    virtual void processReplacing(const SamplesBuffer &in, SamplesBuffer &out, int sampleRate, const std::vector<midi::MidiMessage> &midiBuffer);
 
-    virtual std::vector<midi::MidiMessage> pullMidiMessagesGeneratedByPlugins() const;
+    virtual void pullMidiMessagesGeneratedByPlugins(std::vector<midi::MidiMessage> &pulledMessages) const; // append the pulled messages
 
     virtual void setMute(bool muted);
 
@@ -62,6 +65,12 @@ public:
 
     virtual bool isActivated() const;
 
+    virtual bool canBeRenderedInParallel() const; // false when processReplacing() is touching other nodes or shared objects (used in audio thread)
+
+    // set by AudioMixer before the workers are started. Processors inserted while the node is rendered in parallel are skipped until the next audio callback
+    void setRenderingInParallel(bool renderingInParallel);
+    bool isRenderingInParallel() const;
+
     virtual void reset(); // reset pan, gain, boost, etc
 
     static const quint8 MAX_PROCESSORS_PER_TRACK = 4;
@@ -71,15 +80,19 @@ protected:
     inline virtual void preFaderProcess(audio::SamplesBuffer &out){ Q_UNUSED(out) } // called after process all input and plugins, and just before compute gain, pan and boost.
     inline virtual void postFaderProcess(audio::SamplesBuffer &out){ Q_UNUSED(out) } // called after compute gain, pan and boost.
 
-    int getInputResamplingLength(int sourceSampleRate, int targetSampleRate, int outFrameLenght);
+    // render connected nodes and inserted plugins. 'processorsMidiBuffer' is the midi input of the first plugin, changed by the plugins in the chain
+    void processNode(SamplesBuffer &out, int sampleRate, std::vector<midi::MidiMessage> &processorsMidiBuffer);
 
+    // connections and processors are changed by GUI/network threads (protected by mutex), the audio thread read the published snapshots
     QSet<AudioNode *> connections;
     QSharedPointer<AudioNodeProcessor> processors[MAX_PROCESSORS_PER_TRACK];
     SamplesBuffer internalInputBuffer;
     SamplesBuffer internalOutputBuffer;
+    SamplesBuffer pluginInputBuffer; // the output from previous plugin is copied to this buffer and used as input to the next plugin in the chain
+    std::vector<midi::MidiMessage> processorsMidiBuffer; // reused in every processReplacing() call
 
     mutable audio::AudioPeak lastPeak;
-    QMutex mutex; // used to protected connections manipulation because nodes can be added or removed by different threads
+    QMutex mutex; // used to protect connections and processors manipulation, never locked in audio thread
 
     // pan
     float pan;
@@ -95,13 +108,21 @@ private:
 
     bool activated; // used when room stream is played. All tracks are disabled, except the room streamer.
 
+    bool renderingInParallel; // changed only in audio thread
+
     float gain;
     float boost;
 
     static const double ROOT_2_OVER_2;
     static const double PI_OVER_2;
 
-    double resamplingCorrection;
+    SnapshotPublisher<QList<AudioNode *>> connectionsSnapshot;
+    SnapshotPublisher<QVector<QSharedPointer<AudioNodeProcessor>>> processorsSnapshot;
+
+    void publishConnections(); // called with the mutex locked
+    void publishProcessors();
+
+    bool hasProcessors() const; // used in audio thread
 
     void updateGains();
 
@@ -129,6 +150,16 @@ inline bool AudioNode::isActivated() const
     return activated;
 }
 
+inline void AudioNode::setRenderingInParallel(bool renderingInParallel)
+{
+    this->renderingInParallel = renderingInParallel;
+}
+
+inline bool AudioNode::isRenderingInParallel() const
+{
+    return renderingInParallel;
+}
+
 inline float AudioNode::getPan() const
 {
     return pan;
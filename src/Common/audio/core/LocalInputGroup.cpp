@@ -21,6 +21,7 @@ LocalInputGroup::~LocalInputGroup()
 void LocalInputGroup::addInputNode(QSharedPointer<LocalInputNode> input)
 {
     groupedInputs.append(input);
+    groupedInputsSnapshot.publish(groupedInputs);
 }
 
 QSharedPointer<LocalInputNode> LocalInputGroup::getInputNode(quint8 index) const
@@ -34,8 +35,8 @@ QSharedPointer<LocalInputNode> LocalInputGroup::getInputNode(quint8 index) const
 
 void LocalInputGroup::mixGroupedInputs(SamplesBuffer &out)
 {
-    for (auto inputTrack : groupedInputs) {
-        auto lastBuffer = inputTrack->getLastBuffer();
+    for (const auto &inputTrack : groupedInputsSnapshot.read()) {
+        const auto &lastBuffer = inputTrack->getLastBuffer(); // no copy, the samples are only read
         if (lastBuffer.getChannels() == out.getChannels()) {
             out.add(lastBuffer);
         }
@@ -49,15 +50,18 @@ void LocalInputGroup::removeInput(QSharedPointer<LocalInputNode> input)
 {
     if (!groupedInputs.removeOne(input))
         qCritical() << "the input track was not removed!";
+
+    groupedInputsSnapshot.publish(groupedInputs);
 }
 
 int LocalInputGroup::getMaxInputChannelsForEncoding() const
 {
-    if (groupedInputs.size() > 1)
+    const auto &inputs = groupedInputsSnapshot.read(); // no locks, called in audio thread
+    if (inputs.size() > 1)
         return 2;    // stereo encoding
 
-    if (!groupedInputs.isEmpty()) {
-        const auto& inputNode = groupedInputs.first();
+    if (!inputs.isEmpty()) {
+        const auto& inputNode = inputs.first();
         if (inputNode->isMidi()) {
             return 2;    // just one midi track, use stereo encoding
         }
@@ -4,6 +4,8 @@
 #include <QList>
 #include <QSharedPointer>
 
+#include "SnapshotPublisher.h"
+
 namespace audio {
 
 class LocalInputNode;
@@ -22,11 +24,11 @@ public:
 
     int getIndex() const;
 
-    void mixGroupedInputs(audio::SamplesBuffer &out);
+    void mixGroupedInputs(audio::SamplesBuffer &out); // audio thread
 
     void removeInput(QSharedPointer<audio::LocalInputNode> input);
 
-    int getMaxInputChannelsForEncoding() const;
+    int getMaxInputChannelsForEncoding() const; // audio thread
 
     bool isTransmiting() const;
 
@@ -41,6 +43,7 @@ public:
 private:
     int groupIndex;
     QList<QSharedPointer<audio::LocalInputNode>> groupedInputs;
+    SnapshotPublisher<QList<QSharedPointer<audio::LocalInputNode>>> groupedInputsSnapshot; // groupedInputs used in audio thread, the removed inputs are released after the audio callback
     bool transmiting;
     bool voiceChatActivated;
 };
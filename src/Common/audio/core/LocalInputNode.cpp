@@ -89,6 +89,7 @@ LocalInputNode::LocalInputNode(controller::MainController *controller, int paren
     looper(LocalInputNode::createLooper(controller))
 {
     Q_UNUSED(isMono)
+    filteredMidiBuffer.reserve(midi::MAX_MESSAGES_PER_BUFFER);
     setToNoInput();
 }
 
@@ -148,6 +149,7 @@ bool LocalInputNode::isAudio() const
 
 void LocalInputNode::setProcessorsSampleRate(int newSampleRate)
 {
+    QMutexLocker locker(&mutex);
     for (int i = 0; i < MAX_PROCESSORS_PER_TRACK; ++i) {
         if (processors[i])
             processors[i]->setSampleRate(newSampleRate);
@@ -156,6 +158,7 @@ void LocalInputNode::setProcessorsSampleRate(int newSampleRate)
 
 void LocalInputNode::closeProcessorsWindows()
 {
+    QMutexLocker locker(&mutex);
     for (int i = 0; i < MAX_PROCESSORS_PER_TRACK; ++i) {
         if (processors[i])
             processors[i]->closeEditor();
@@ -224,7 +227,7 @@ bool LocalInputNode::isReceivingAllMidiChannels() const
 }
 
 void LocalInputNode::processReplacing(const SamplesBuffer &in, SamplesBuffer &out,
-                                           int sampleRate, std::vector<midi::MidiMessage> &midiBuffer)
+                                           int sampleRate, const std::vector<midi::MidiMessage> &midiBuffer)
 {
     Q_UNUSED(sampleRate);
 
@@ -238,7 +241,8 @@ void LocalInputNode::processReplacing(const SamplesBuffer &in, SamplesBuffer &ou
     *
     */
 
-    std::vector<midi::MidiMessage> filteredMidiBuffer(midiBuffer.size());
+    filteredMidiBuffer.clear(); // keep the reserved capacity
+    const LocalInputNode *midiReceiver = nullptr;
     internalInputBuffer.setFrameLenght(out.getFrameLenght());
     internalOutputBuffer.setFrameLenght(out.getFrameLenght());
     internalInputBuffer.zero();
@@ -253,6 +257,7 @@ void LocalInputNode::processReplacing(const SamplesBuffer &in, SamplesBuffer &ou
         }
         else if (isMidi() && !midiBuffer.empty()) {
             processIncommingMidi(midiBuffer, filteredMidiBuffer);
+            midiReceiver = this;
         }
     }
 
@@ -260,7 +265,7 @@ void LocalInputNode::processReplacing(const SamplesBuffer &in, SamplesBuffer &ou
         quint8 subchannelIndex = 1; // second subchannel
         auto secondSubchannel = mainController->getInputTrackInGroup(channelGroupIndex, subchannelIndex);
         if (secondSubchannel && secondSubchannel->isMidi()) {
-            secondSubchannel->processIncommingMidi(midiBuffer, filteredMidiBuffer);
+            secondSubchannel->processIncommingMidi(midiBuffer, filteredMidiBuffer, midiReceiver); // the messages used by this subchannel are not used again
         }
     }
 
@@ -270,7 +275,7 @@ void LocalInputNode::processReplacing(const SamplesBuffer &in, SamplesBuffer &ou
         return; // when routing midi this track will not render midi data, this data will be rendered by first subchannel. But the midi data is processed above to update MIDI activity meter
     }
 
-    AudioNode::processReplacing(in, out, sampleRate, filteredMidiBuffer); // only the filtered midi messages are sended to rendering code
+    AudioNode::processNode(out, sampleRate, filteredMidiBuffer); // only the filtered midi messages are sended to rendering code
 }
 
 void LocalInputNode::setRoutingMidiInput(bool routeMidiInput)
@@ -302,27 +307,33 @@ void LocalInputNode::setReceivingRoutedMidiInput(bool receiveRoutedMidiInput)
         routingMidiInput = false;
 }
 
-void LocalInputNode::processIncommingMidi(std::vector<midi::MidiMessage> &inBuffer, std::vector<midi::MidiMessage> &outBuffer)
+void LocalInputNode::processIncommingMidi(const std::vector<midi::MidiMessage> &inBuffer, std::vector<midi::MidiMessage> &outBuffer, const LocalInputNode *previousReceiver)
 {
-    auto iterator = inBuffer.begin();
-    while(iterator != inBuffer.end()) {
-        auto message(*iterator);
-        if (canProcessMidiMessage(message)) {
+    for (const auto &inMessage : inBuffer) {
+        if (previousReceiver && previousReceiver->isAcceptingMidiMessage(inMessage))
+            continue; // already used by the previous subchannel
+
+        if (canProcessMidiMessage(inMessage) && outBuffer.size() < outBuffer.capacity()) {
+            auto message(inMessage);
             message.transpose(getTranspose());
 
-            outBuffer.push_back(message);
+            // the messages of both subchannels are kept ordered by sample offset (no allocation, the capacity is checked above)
+            auto position = outBuffer.end();
+            while (position != outBuffer.begin() && (position - 1)->getSampleOffset() > message.getSampleOffset())
+                --position;
+            outBuffer.insert(position, message);
 
             // save the midi activity peak value for notes or controls
             midiInput.updateActivity(message);
-
-            iterator = inBuffer.erase(iterator);
-        }
-        else {
-            ++iterator;
         }
     }
 }
 
+bool LocalInputNode::isAcceptingMidiMessage(const midi::MidiMessage &message) const
+{
+    return !midiInput.isLearning() && midiInput.accept(message); // the same messages accepted in canProcessMidiMessage(), without the learning side effect
+}
+
 qint8 LocalInputNode::getTranspose() const
 {
     if (!receivingRoutedMidiInput) {
@@ -387,9 +398,9 @@ bool LocalInputNode::canProcessMidiMessage(const midi::MidiMessage &message) con
     return midiInput.accept(message);
 }
 
-std::vector<midi::MidiMessage> LocalInputNode::pullMidiMessagesGeneratedByPlugins() const
+void LocalInputNode::pullMidiMessagesGeneratedByPlugins(std::vector<midi::MidiMessage> &pulledMessages) const
 {
-    return mainController->pullMidiMessagesFromPlugins();
+    mainController->pullMidiMessagesFromPlugins(pulledMessages);
 }
 
 void LocalInputNode::startMidiNoteLearn()
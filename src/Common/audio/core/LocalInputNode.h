@@ -21,7 +21,8 @@ class LocalInputNode : public AudioNode
 public:
     LocalInputNode(controller::MainController *controller, int parentChannelIndex, bool isMono = true);
     ~LocalInputNode();
-    void processReplacing(const SamplesBuffer &in, SamplesBuffer &out, int sampleRate, std::vector<midi::MidiMessage> &midiBuffer) override;
+    void processReplacing(const SamplesBuffer &in, SamplesBuffer &out, int sampleRate, const std::vector<midi::MidiMessage> &midiBuffer) override;
+    bool canBeRenderedInParallel() const override;
     virtual int getSampleRate() const;
 
     int getChannels() const;
@@ -52,7 +53,7 @@ public:
 
     bool isReceivingAllMidiChannels() const;
 
-    std::vector<midi::MidiMessage> pullMidiMessagesGeneratedByPlugins() const override;
+    void pullMidiMessagesGeneratedByPlugins(std::vector<midi::MidiMessage> &pulledMessages) const override;
 
     ChannelRange getAudioInputRange() const;
 
@@ -162,7 +163,11 @@ private:
 
     bool canProcessMidiMessage(const midi::MidiMessage &msg) const;
 
-    void processIncommingMidi(std::vector<midi::MidiMessage> &inBuffer, std::vector<midi::MidiMessage> &outBuffer);
+    // 'previousReceiver' is the subchannel filtering the same messages before, the messages accepted by this subchannel are skipped
+    void processIncommingMidi(const std::vector<midi::MidiMessage> &inBuffer, std::vector<midi::MidiMessage> &outBuffer, const LocalInputNode *previousReceiver = nullptr);
+    bool isAcceptingMidiMessage(const midi::MidiMessage &message) const;
+
+    std::vector<midi::MidiMessage> filteredMidiBuffer; // reused in every processReplacing() call
 
     audio::Looper* looper;
 
@@ -185,6 +190,14 @@ inline bool LocalInputNode::isReceivingRoutedMidiInput() const
     return receivingRoutedMidiInput;
 }
 
+inline bool LocalInputNode::canBeRenderedInParallel() const
+{
+    if (receivingRoutedMidiInput || isRoutingMidiInput())
+        return false; // the first subchannel is processing the midi messages of the second subchannel
+
+    return AudioNode::canBeRenderedInParallel();
+}
+
 inline bool LocalInputNode::isLearningMidiNote() const
 {
     return midiInput.learning;
@@ -0,0 +1,195 @@
+#include "RenderWorkers.h"
+
+#include <QThread>
+
+#include "log/RealTimeAllocationTracker.h"
+
+#if defined(Q_PROCESSOR_X86)
+    #include <emmintrin.h>
+#endif
+
+#if defined(Q_OS_LINUX)
+    #include <pthread.h>
+    #include <sched.h>
+#elif defined(Q_OS_WIN)
+    #include <windows.h>
+#endif
+
+using audio::RenderWorkers;
+
+namespace {
+
+const int SPIN_ITERATIONS = 20000; // busy waiting with 'pause', the fastest wake up. The workers are parked after that
+
+// state layout: generation (32 bits) | tasks count (16 bits) | next task index (16 bits)
+inline quint32 generationOf(quint64 state) { return static_cast<quint32>(state >> 32); }
+inline int tasksOf(quint64 state) { return static_cast<int>((state >> 16) & 0xFFFF); }
+inline int nextTaskOf(quint64 state) { return static_cast<int>(state & 0xFFFF); }
+
+inline void cpuRelax()
+{
+#if defined(Q_PROCESSOR_X86)
+    _mm_pause();
+#elif defined(Q_PROCESSOR_ARM) && (defined(Q_CC_GNU) || defined(Q_CC_CLANG))
+    __asm__ __volatile__("yield");
+#endif
+}
+
+void pinCurrentThreadToCore(int core)
+{
+    const int cores = RenderWorkers::getAvailableCores();
+
+#if defined(Q_OS_LINUX)
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    CPU_SET(core % cores, &cpuSet);
+    pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuSet); // errors are ignored, the thread is just not pinned
+#elif defined(Q_OS_WIN)
+    SetThreadAffinityMask(GetCurrentThread(), static_cast<DWORD_PTR>(1) << (core % cores));
+#else
+    Q_UNUSED(core) // no thread affinity API in mac, only affinity tags (hints)
+    Q_UNUSED(cores)
+#endif
+}
+
+} // namespace
+
+// +++++++++++++++++++++++++++++++++++++++
+
+class RenderWorkers::Worker : public QThread
+{
+public:
+    Worker(RenderWorkers *pool, int index) :
+        pool(pool),
+        index(index)
+    {
+        setObjectName(QString("Render worker %1").arg(index));
+    }
+
+protected:
+    void run() override
+    {
+        pool->workerLoop(index);
+    }
+
+private:
+    RenderWorkers *pool;
+    int index;
+};
+
+// +++++++++++++++++++++++++++++++++++++++
+
+RenderWorkers::RenderWorkers(int threads) :
+    state(0),
+    finishedTasks(0),
+    stopping(false),
+    task(nullptr),
+    context(nullptr)
+{
+    threads = qBound(1, threads, audio::MAX_RENDER_THREADS);
+
+    for (int i = 0; i < threads - 1; ++i) { // the audio thread is also executing tasks
+        auto worker = new Worker(this, i);
+        workers.append(worker);
+        worker->start(QThread::TimeCriticalPriority);
+    }
+}
+
+RenderWorkers::~RenderWorkers()
+{
+    stopping = true;
+    wakeupNotifier.notifyAll(workers.size());
+
+    for (auto worker : qAsConst(workers)) {
+        worker->wait();
+        delete worker;
+    }
+}
+
+int RenderWorkers::getAvailableCores()
+{
+    return qMax(1, QThread::idealThreadCount());
+}
+
+void RenderWorkers::fork(int tasks, Task task, void *context)
+{
+    Q_ASSERT(finishedTasks.load() == tasksOf(state.load())); // previous fork was joined
+    Q_ASSERT(tasks >= 0 && tasks <= audio::MAX_RENDER_TASKS);
+
+    this->task = task;
+    this->context = context;
+    finishedTasks = 0;
+
+    const quint64 nextGeneration = generationOf(state.load()) + 1;
+    state.store((nextGeneration << 32) | (static_cast<quint64>(tasks) << 16)); // wake up the spinning workers, the task index is zero
+
+    wakeupNotifier.notifyWaiting(); // wake up the parked workers, just an atomic load if all workers are spinning
+}
+
+void RenderWorkers::join()
+{
+    const quint64 currentState = state.load();
+    const quint32 generation = generationOf(currentState);
+
+    while (executeNextTask(generation)) {
+        // the audio thread is working too
+    }
+
+    const int tasks = tasksOf(currentState);
+    while (finishedTasks.load() < tasks)
+        cpuRelax();
+}
+
+bool RenderWorkers::executeNextTask(quint32 generation)
+{
+    quint64 current = state.load();
+    forever {
+        if (generationOf(current) != generation)
+            return false;
+
+        const int taskIndex = nextTaskOf(current);
+        if (taskIndex >= tasksOf(current))
+            return false;
+
+        if (state.compare_exchange_weak(current, current + 1)) {
+            task(context, taskIndex); // task and context are not changed until all tasks are finished
+            finishedTasks.fetch_add(1);
+            return true;
+        }
+    }
+}
+
+void RenderWorkers::workerLoop(int workerIndex)
+{
+    pinCurrentThreadToCore(workerIndex + 1); // the audio thread is not pinned, the audio driver own this thread
+
+    quint32 lastGeneration = generationOf(state.load());
+    int spinIterations = 0;
+
+    while (!stopping.load()) {
+        const quint32 generation = generationOf(state.load());
+        if (generation == lastGeneration) {
+            if (spinIterations < SPIN_ITERATIONS) {
+                spinIterations++;
+                cpuRelax();
+            }
+            else { // parked until the next fork() or the destructor
+                wakeupNotifier.waitUntil([this, lastGeneration]() {
+                    return stopping.load() || generationOf(state.load()) != lastGeneration;
+                });
+            }
+            continue;
+        }
+
+        lastGeneration = generation;
+
+        {
+            RealTimeScope realTimeScope; // report memory allocations in worker threads when JAMTABA_RT_ALLOC_TRACKER is defined
+            while (executeNextTask(generation)) {
+                // executing tasks until the generation is finished
+            }
+        }
+
+        spinIterations = 0;
+    }
+}
@@ -0,0 +1,74 @@
+#ifndef RENDER_WORKERS_H
+#define RENDER_WORKERS_H
+
+#include <QtGlobal>
+#include <QVector>
+#include <atomic>
+
+#include "WakeupNotifier.h"
+
+namespace audio {
+
+const int MAX_RENDER_THREADS = 16;
+const int MAX_RENDER_TASKS = 0xFFFF; // tasks per fork
+
+/**
+    A pool of real time threads used to render independent audio nodes in parallel. In every
+    audio callback the audio thread call fork() (non blocking), render what can't be rendered in
+    parallel, and call join(). The audio thread also execute tasks in join(), so a pool with
+    N threads is using N-1 workers plus the audio thread.
+
+    The workers are pinned to different cores and spin for a short time after each task, so
+    in small audio buffers they wake up without any system call. After that the workers are
+    parked in a WakeupNotifier and fork() post the semaphore, the cores are never burned by
+    idle workers.
+
+    fork() and join() are called only by the audio thread. Tasks are executed exactly once.
+*/
+
+class RenderWorkers
+{
+public:
+    typedef void (*Task)(void *context, int taskIndex);
+
+    explicit RenderWorkers(int threads); // threads including the audio thread
+    ~RenderWorkers();
+
+    int getThreads() const;
+
+    void fork(int tasks, Task task, void *context);
+    void join(); // execute the remaining tasks and wait (spinning) until all tasks are finished
+
+    static int getAvailableCores();
+
+private:
+    Q_DISABLE_COPY(RenderWorkers)
+
+    class Worker;
+
+    bool executeNextTask(quint32 generation); // return false if there is no task available in this generation
+
+    void workerLoop(int workerIndex);
+
+    QVector<Worker *> workers;
+
+    /** The generation (incremented in every fork), the tasks count and the next task index are packed
+     *  in the same atomic, so a late worker can't take a task from the next generation using old parameters. */
+    std::atomic<quint64> state;
+    std::atomic<int> finishedTasks;
+    std::atomic<bool> stopping;
+
+    WakeupNotifier wakeupNotifier; // the parked workers are waiting here
+
+    Task task;
+    void *context;
+};
+
+inline int RenderWorkers::getThreads() const
+{
+    return workers.size() + 1; // workers + audio thread
+}
+
+} // namespace
+
+#endif // RENDER_WORKERS_H
@@ -1,11 +1,14 @@
 #include "SamplesBuffer.h"
+#include "SamplesKernels.h"
 #include <QDebug>
+#include <QtGlobal>
 #include <cmath>
 #include <algorithm>
 #include <cstring>
 
 using audio::SamplesBuffer;
 using audio::AudioPeak;
+using audio::SamplesKernels;
 
 const SamplesBuffer SamplesBuffer::ZERO_BUFFER(1, 0);
 
@@ -20,10 +23,12 @@ SamplesBuffer::SamplesBuffer(unsigned int channels, unsigned int frameLenght) :
     frameLenght(frameLenght),
     rmsRunningSum(0.0f),
     summedSamples(0),
-    rmsWindowSize(13230) // 300 ms in 44100 KHz
+    rmsWindowSize(13230), // 300 ms in 44100 KHz
+    data(nullptr),
+    capacity(0),
+    allocatedChannels(0)
 {
-    for (unsigned int c = 0; c < channels; ++c)
-        samples.emplace_back(frameLenght);
+    reallocate(channels, computeAlignedCapacity(frameLenght));
 
     squaredSums[0] = squaredSums[1] = 0.0f;
     lastRmsValues[0] = lastRmsValues[1] = 0.0f;
@@ -36,9 +41,15 @@ SamplesBuffer::SamplesBuffer(const SamplesBuffer &other) :
       rmsRunningSum(other.rmsRunningSum),
       summedSamples(other.summedSamples),
       rmsWindowSize(other.rmsWindowSize),
-      samples(other.samples)
+      data(nullptr),
+      capacity(0),
+      allocatedChannels(0)
 {
     // qWarning() << "Samples Buffer copy constructor!";
+    reallocate(other.channels, computeAlignedCapacity(other.frameLenght));
+    for (unsigned int c = 0; c < channels; ++c)
+        std::memcpy(getSamplesArray(c), other.getSamplesArray(c), frameLenght * sizeof(float));
+
     squaredSums[0] = other.squaredSums[0];
     squaredSums[1] = other.squaredSums[1];
 
@@ -48,6 +59,16 @@ SamplesBuffer::SamplesBuffer(const SamplesBuffer &other) :
 
 SamplesBuffer &SamplesBuffer::operator=(const SamplesBuffer &other)
 {
+    if (this == &other)
+        return *this;
+
+    // the current block is reused when it is big enough, so assigning buffers with the same layout never allocates
+    if (other.channels > allocatedChannels || other.frameLenght > capacity)
+        reallocate(qMax(other.channels, allocatedChannels), qMax(computeAlignedCapacity(other.frameLenght), capacity));
+
+    for (unsigned int c = 0; c < other.channels; ++c)
+        std::memcpy(getSamplesArray(c), other.getSamplesArray(c), other.frameLenght * sizeof(float));
+
     this->channels = other.channels;
     this->frameLenght = other.frameLenght;
     this->rmsRunningSum = other.rmsRunningSum;
@@ -60,12 +81,48 @@ SamplesBuffer &SamplesBuffer::operator=(const SamplesBuffer &other)
     lastRmsValues[0] = other.lastRmsValues[0];
     lastRmsValues[1] = other.lastRmsValues[1];
 
-    this->samples = other.samples;
-
     return *this;
 }
 
-SamplesBuffer::~SamplesBuffer() = default;
+SamplesBuffer::~SamplesBuffer()
+{
+    qFreeAligned(data);
+}
+
+unsigned int SamplesBuffer::computeAlignedCapacity(unsigned int frames)
+{
+    return (frames + SAMPLES_ALIGNMENT - 1) / SAMPLES_ALIGNMENT * SAMPLES_ALIGNMENT;
+}
+
+void SamplesBuffer::reallocate(unsigned int newChannels, unsigned int newCapacity)
+{
+    Q_ASSERT(newCapacity % SAMPLES_ALIGNMENT == 0);
+
+    float *newData = nullptr;
+    const size_t bytes = static_cast<size_t>(newChannels) * newCapacity * sizeof(float);
+    if (bytes) {
+        newData = static_cast<float *>(qMallocAligned(bytes, BYTES_ALIGNMENT));
+        Q_CHECK_PTR(newData);
+        std::memset(newData, 0, bytes); // new samples are always silent
+    }
+
+    const unsigned int channelsToKeep = std::min(newChannels, allocatedChannels);
+    const unsigned int framesToKeep = std::min(newCapacity, capacity);
+    for (unsigned int c = 0; framesToKeep > 0 && c < channelsToKeep; ++c)
+        std::memcpy(newData + c * newCapacity, data + c * capacity, framesToKeep * sizeof(float));
+
+    qFreeAligned(data);
+
+    data = newData;
+    capacity = newCapacity;
+    allocatedChannels = newChannels;
+}
+
+void SamplesBuffer::reserve(unsigned int frames)
+{
+    if (frames > capacity)
+        reallocate(allocatedChannels, computeAlignedCapacity(frames));
+}
 
 void SamplesBuffer::setRmsWindowSize(int samples)
 {
@@ -77,7 +134,7 @@ void SamplesBuffer::invertStereo()
     if (channels != 2)
         return; // trying invert a non stereo buffer
 
-    std::iter_swap(samples.begin(), samples.begin() + 1); // swap first and second channels
+    std::swap_ranges(getSamplesArray(0), getSamplesArray(0) + frameLenght, getSamplesArray(1)); // swap first and second channels
 }
 
 void SamplesBuffer::discardFirstSamples(unsigned int samplesToDiscard)
@@ -86,7 +143,8 @@ void SamplesBuffer::discardFirstSamples(unsigned int samplesToDiscard)
     int toCopy = frameLenght - toDiscard;
     uint newFrameLenght = frameLenght - toDiscard;
     for (uint c = 0; c < channels; ++c) {
-        std::copy_n(samples[c].begin() + toDiscard, toCopy, samples[c].begin());
+        float *chanSamples = getSamplesArray(c);
+        std::memmove(chanSamples, chanSamples + toDiscard, toCopy * sizeof(float));
     }
     setFrameLenght(newFrameLenght);
 }
@@ -99,70 +157,49 @@ void SamplesBuffer::append(const SamplesBuffer &other)
     set(other, 0, other.frameLenght, internalOffset);
 }
 
-float *SamplesBuffer::getSamplesArray(unsigned int channel) const
-{
-    Q_ASSERT(channel < samples.size());
-
-    return const_cast<float *>(&(samples[channel][0]));
-}
-
 void SamplesBuffer::applyGain(float gainFactor, float boostFactor)
 {
+    const auto &kernels = SamplesKernels::get();
     const float scaleFactor = gainFactor * boostFactor;
-    for (unsigned int c = 0; c < channels; ++c) {
-        for (unsigned int i = 0; i < frameLenght; ++i)
-            samples[c][i] *= scaleFactor;
-    }
+    for (unsigned int c = 0; c < channels; ++c)
+        kernels.scale(getSamplesArray(c), frameLenght, scaleFactor);
 }
 
 void SamplesBuffer::fadeOut(int fadeFrameLenght, float endGain)
 {
+    const auto &kernels = SamplesKernels::get();
     uint lenght = std::min(fadeFrameLenght, (int)frameLenght);
     float gainStep = (1 - endGain)/lenght;
-    for (unsigned int c = 0; c < channels; ++c) {
-        float gain = 1;
-        for (unsigned int s = 0; s < lenght; ++s) {
-            samples[c][s] *= gain;
-            gain -= gainStep;
-        }
-    }
+    for (unsigned int c = 0; c < channels; ++c)
+        kernels.ramp(getSamplesArray(c), lenght, 1, -gainStep);
 }
 
 void SamplesBuffer::fadeIn(int fadeFrameLenght, float beginGain)
 {
+    const auto &kernels = SamplesKernels::get();
     uint lenght = std::min(fadeFrameLenght, (int)frameLenght);
     float gainStep = (1 - beginGain)/lenght;
-    for (unsigned int c = 0; c < channels; ++c) {
-        float gain = beginGain;
-        for (unsigned int s = 0; s < lenght; ++s) {
-            samples[c][s] *= gain;
-            gain += gainStep;
-        }
-    }
+    for (unsigned int c = 0; c < channels; ++c)
+        kernels.ramp(getSamplesArray(c), lenght, beginGain, gainStep);
 }
 
 void SamplesBuffer::fade(float beginGain, float endGain)
 {
+    const auto &kernels = SamplesKernels::get();
     float gainStep = (endGain - beginGain)/frameLenght;
-    for (unsigned int c = 0; c < channels; ++c) {
-        float gain = beginGain;
-        for (unsigned int s = 0; s < frameLenght; ++s) {
-            samples[c][s] *= gain;
-            gain += gainStep;
-        }
-    }
+    for (unsigned int c = 0; c < channels; ++c)
+        kernels.ramp(getSamplesArray(c), frameLenght, beginGain, gainStep);
 }
 
 void SamplesBuffer::applyGain(float gainFactor, float leftGain, float rightGain, float boostFactor)
 {
+    const auto &kernels = SamplesKernels::get();
     if (!isMono()) {
         float commonGain = gainFactor * boostFactor;
         float finalLeftGain = commonGain * leftGain;
         float finalRightGain = commonGain * rightGain;
-        for (unsigned int i = 0; i < frameLenght; ++i) {
-            samples[0][i] *= finalLeftGain;
-            samples[1][i] *= finalRightGain;
-        }
+        kernels.scale(getSamplesArray(0), frameLenght, finalLeftGain);
+        kernels.scale(getSamplesArray(1), frameLenght, finalRightGain);
     }
     else {
         applyGain(gainFactor, boostFactor);
@@ -174,36 +211,54 @@ void SamplesBuffer::zero()
     if (!frameLenght)
         return;
 
+    Q_ASSERT(capacity >= frameLenght);
+
     const uint bytesToProcess = frameLenght * sizeof(float);
-    for (unsigned int c = 0; c < channels; ++c) {
-        Q_ASSERT(samples[c].size() >= frameLenght);
-        memset(&(samples[c][0]), 0, bytesToProcess);
+    if (frameLenght == capacity) {
+        memset(data, 0, bytesToProcess * channels); // channels are contiguous, clear all in one call
+        return;
     }
+
+    for (unsigned int c = 0; c < channels; ++c)
+        memset(getSamplesArray(c), 0, bytesToProcess);
 }
 
 AudioPeak SamplesBuffer::computePeak()
 {
-    float abs; // max peak absolute value
+    const auto &kernels = SamplesKernels::get();
     float maxPeaks[2] = {0};// left and right peaks
-	unsigned maxChan = isMono() ? 1 : channels; // don't loop and mul/add twice if only one channel
+    unsigned maxChan = isMono() ? 1 : qMin(channels, 2u); // don't loop and mul/add twice if only one channel
 
     for (unsigned int c = 0; c < maxChan; ++c) {
-        float maxPeak = 0;
-		const std::vector<float>& chanSamples = samples[c]; // optimize costly stl vector access out of the inner loop
-        for (unsigned int i = 0; i < frameLenght; ++i) {
-            // max peak
-            abs = chanSamples[i]; // access inner std:svector array only once, use it for square value below
-			if(abs<0) abs = -abs; // std::fabs is very slow, just negate if needed
+        maxPeaks[c] = kernels.peak(getSamplesArray(c), frameLenght, &squaredSums[c]);
+        summedSamples += frameLenght;
+    }
 
-            if (abs > maxPeak) maxPeak = abs;
+    return updateRms(maxPeaks);
+}
 
-            // rms running squared sum
-            squaredSums[c] += abs * abs; // squaring every sample and summing
-        }
-		maxPeaks[c] = maxPeak;
+AudioPeak SamplesBuffer::applyGainAndComputePeak(float gainFactor, float leftGain, float rightGain, float boostFactor)
+{
+    const auto &kernels = SamplesKernels::get();
+    if (channels > 2) { // the fused pass is used only in mono and stereo buffers
+        applyGain(gainFactor, leftGain, rightGain, boostFactor);
+        return computePeak();
+    }
+
+    const float commonGain = gainFactor * boostFactor;
+    const float gains[2] = { isMono() ? commonGain : commonGain * leftGain, commonGain * rightGain };
+
+    float maxPeaks[2] = {0};
+    for (unsigned int c = 0; c < channels; ++c) {
+        maxPeaks[c] = kernels.scaleAndPeak(getSamplesArray(c), frameLenght, gains[c], &squaredSums[c]);
         summedSamples += frameLenght;
     }
 
+    return updateRms(maxPeaks);
+}
+
+AudioPeak SamplesBuffer::updateRms(float maxPeaks[2])
+{
     if (isMono()) {
         maxPeaks[1] = maxPeaks[0];
         squaredSums[1] = squaredSums[0];
@@ -226,60 +281,47 @@ int SamplesBuffer::computeRmsWindowSize(int sampleRate, int windowTimeInMs)
     return sampleRate * windowTimeInMs/1000.0f;
 }
 
-void SamplesBuffer::add(const SamplesBuffer &buffer, int internalWriteOffset)
+void SamplesBuffer::add(const SamplesBufferView &view, int internalWriteOffset)
 {
-	const uint framesToProcess = std::min(static_cast<uint>(frameLenght), buffer.getFrameLenght());
+    const auto &kernels = SamplesKernels::get();
+    Q_ASSERT(internalWriteOffset >= 0 && static_cast<uint>(internalWriteOffset) <= frameLenght);
 
-    if (buffer.channels >= channels) {
-        for (unsigned int c = 0; c < channels; ++c) {
-	        auto& chanSamples = samples[c]; // save costly loop access to vector sub float array
-			const auto& bufChanSamples = buffer.samples[c]; // save costly loop access to vector sub float array
+    const uint framesToProcess = std::min(frameLenght - internalWriteOffset, view.getFrameLenght());
 
-            for (unsigned int s = 0; s < framesToProcess; ++s) {
-                Q_ASSERT(s + internalWriteOffset < chanSamples.size());
-                chanSamples[s + internalWriteOffset] += bufChanSamples[s];
-            }
-        }
+    if (view.getChannels() >= channels) {
+        for (unsigned int c = 0; c < channels; ++c)
+            kernels.add(getSamplesArray(c) + internalWriteOffset, view.getSamplesArray(c), framesToProcess);
     }
     else { // samples is stereo and buffer is mono
-	    auto& chanSamples0 = samples[0]; // save costly loop access to vector sub float array
-	    auto& chanSamples1 = samples[1]; // save costly loop access to vector sub float array
-		const auto& bufChanSamples0 = buffer.samples[0]; // save costly loop access to vector sub float array
-
-        for (unsigned int s = 0; s < framesToProcess; ++s) {
-            Q_ASSERT(s + internalWriteOffset < chanSamples0.size());
-            Q_ASSERT(s + internalWriteOffset < chanSamples1.size());
-	        const auto monoBufferSampleAtIndex  = bufChanSamples0[s];
-            chanSamples0[s + internalWriteOffset] += monoBufferSampleAtIndex;
-            chanSamples1[s + internalWriteOffset] += monoBufferSampleAtIndex;
-        }
+        kernels.add(getSamplesArray(0) + internalWriteOffset, view.getSamplesArray(0), framesToProcess);
+        kernels.add(getSamplesArray(1) + internalWriteOffset, view.getSamplesArray(0), framesToProcess);
     }
 }
 
 void SamplesBuffer::add(uint channel, float *samples, uint samplesToAdd)
 {
-    Q_ASSERT(channel < channels && channels == this->samples.size());
-    Q_ASSERT(samplesToAdd <= frameLenght && samplesToAdd <= this->samples[channel].size());
+    Q_ASSERT(channel < channels && channels <= allocatedChannels);
+    Q_ASSERT(samplesToAdd <= frameLenght && samplesToAdd <= capacity);
 
-    void *dest = &(this->samples[channel][0]);
+    void *dest = getSamplesArray(channel);
     const uint bytesToCopy = std::min(static_cast<uint>(frameLenght), samplesToAdd) * sizeof(float);
     memcpy(dest, samples, bytesToCopy);
 }
 
 void SamplesBuffer::add(uint channel, uint sampleIndex, float sampleValue)
 {
-    Q_ASSERT(channel < channels && channels == samples.size());
-    Q_ASSERT(sampleIndex < samples[channel].size());
+    Q_ASSERT(channel < channels && channels <= allocatedChannels);
+    Q_ASSERT(sampleIndex < capacity);
 
-    samples[channel][sampleIndex] += sampleValue;
+    getSamplesArray(channel)[sampleIndex] += sampleValue;
 }
 
 void SamplesBuffer::set(uint channel, uint sampleIndex, float sampleValue)
 {
-    Q_ASSERT(channel < channels && channels <= samples.size());
-    Q_ASSERT(sampleIndex < samples[channel].size());
+    Q_ASSERT(channel < channels && channels <= allocatedChannels);
+    Q_ASSERT(sampleIndex < capacity);
 
-    samples[channel][sampleIndex] = sampleValue;
+    getSamplesArray(channel)[sampleIndex] = sampleValue;
 }
 
 void SamplesBuffer::setToMono()
@@ -290,14 +332,8 @@ void SamplesBuffer::setToMono()
 
 void SamplesBuffer::setToStereo()
 {
-    if (this->samples.size() < 2) {
-        size_t channelsToAdd = 2 - this->samples.size();
-        for (uint c = 0; c < channelsToAdd; ++c)
-            samples.push_back(std::vector<float>(frameLenght));
-    }
-
-    for (unsigned int c = 0; c < samples.size(); ++c)
-        samples[c].resize(frameLenght);
+    if (allocatedChannels < 2)
+        reallocate(2, qMax(capacity, computeAlignedCapacity(frameLenght)));
 
     this->channels = 2;
 }
@@ -307,12 +343,31 @@ void SamplesBuffer::set(const SamplesBuffer &buffer)
     set(buffer, 0, std::min(buffer.frameLenght, frameLenght), 0);
 }
 
+void SamplesBuffer::set(const SamplesBufferView &view)
+{
+    if (view.getChannels() == 0 || channels == 0)
+        return;
+
+    const uint bytesToCopy = std::min(view.getFrameLenght(), frameLenght) * sizeof(float);
+    if (!bytesToCopy)
+        return;
+
+    if (view.getChannels() >= channels) {
+        for (unsigned int c = 0; c < channels; ++c)
+            std::memcpy(getSamplesArray(c), view.getSamplesArray(c), bytesToCopy);
+    }
+    else { // mono view, copy the same samples to all channels
+        for (unsigned int c = 0; c < channels; ++c)
+            std::memcpy(getSamplesArray(c), view.getSamplesArray(0), bytesToCopy);
+    }
+}
+
 float SamplesBuffer::get(uint channel, uint sampleIndex) const
 {
     Q_ASSERT(channel < channels);
-    Q_ASSERT(sampleIndex < samples[channel].capacity());
+    Q_ASSERT(sampleIndex < capacity);
 
-    return samples[channel][sampleIndex];
+    return getSamplesArray(channel)[sampleIndex];
 }
 
 void SamplesBuffer::setFrameLenght(unsigned int newFrameLenght)
@@ -320,10 +375,9 @@ void SamplesBuffer::setFrameLenght(unsigned int newFrameLenght)
     if (newFrameLenght == frameLenght)
         return;
 
-    if (newFrameLenght > frameLenght) {
-        for (unsigned int c = 0; c < channels; ++c)
-            samples[c].resize(newFrameLenght);
-    }
+    if (newFrameLenght > capacity)
+        reallocate(qMax(channels, allocatedChannels), computeAlignedCapacity(newFrameLenght));
+
     this->frameLenght = newFrameLenght;
 }
 
@@ -362,7 +416,7 @@ void SamplesBuffer::set(const SamplesBuffer &buffer, uint bufferOffset, uint sam
 
     if (channels == buffer.channels) {// channels number are equal
         for (unsigned int c = 0; c < channels; ++c) {
-            std::memcpy(&(samples[c][internalOffset]), &(buffer.samples[c][bufferOffset]), bytesToProcess);
+            std::memcpy(getSamplesArray(c) + internalOffset, buffer.getSamplesArray(c) + bufferOffset, bytesToProcess);
         }
     }
     else { // different number of channels
@@ -370,22 +424,20 @@ void SamplesBuffer::set(const SamplesBuffer &buffer, uint bufferOffset, uint sam
             if (!buffer.isMono()) {
                 int channelsToCopy = qMin(channels, buffer.channels);
                 for (int c = 0; c < channelsToCopy; ++c) {
-                    Q_ASSERT(internalOffset < samples[c].size());
-                    Q_ASSERT(bufferOffset < buffer.samples[c].size());
-                    Q_ASSERT(bufferOffset + framesToProcess < buffer.samples[c].size());
-                    Q_ASSERT(internalOffset + framesToProcess < samples[c].size());
-                    std::memcpy(&(samples[c][internalOffset]), &(buffer.samples[c][bufferOffset]), bytesToProcess);
+                    Q_ASSERT(internalOffset + framesToProcess <= capacity);
+                    Q_ASSERT(bufferOffset + framesToProcess <= buffer.capacity);
+                    std::memcpy(getSamplesArray(c) + internalOffset, buffer.getSamplesArray(c) + bufferOffset, bytesToProcess);
                 }
             } else {
-                std::memcpy(&(samples[0][internalOffset]), &(buffer.samples[0][bufferOffset]), bytesToProcess);
-                std::memcpy(&(samples[1][internalOffset]), &(buffer.samples[0][bufferOffset]), bytesToProcess);
+                std::memcpy(getSamplesArray(0) + internalOffset, buffer.getSamplesArray(0) + bufferOffset, bytesToProcess);
+                std::memcpy(getSamplesArray(1) + internalOffset, buffer.getSamplesArray(0) + bufferOffset, bytesToProcess);
             }
         } else { // this buffer is mono, but the buffer in parameter is not! Mix down the stereo samples in one mono sample value.
-            for (unsigned int s = 0; s < framesToProcess; ++s) {
-                const int index = s + bufferOffset;
-                float v = (buffer.samples[0][index] + buffer.samples[1][index])/2.0f;
-                samples[0][s + internalOffset] = v;
-            }
+            const float *leftSamples = buffer.getSamplesArray(0) + bufferOffset;
+            const float *rightSamples = buffer.getSamplesArray(1) + bufferOffset;
+            float *monoSamples = getSamplesArray(0) + internalOffset;
+            for (unsigned int s = 0; s < framesToProcess; ++s)
+                monoSamples[s] = (leftSamples[s] + rightSamples[s])/2.0f;
         }
     }
 }
@@ -2,7 +2,7 @@
 #define SAMPLESBUFFER_H
 
 #include "AudioPeak.h"
-#include <vector>
+#include "SamplesBufferView.h"
 
 #include <QtGlobal>
 
@@ -23,7 +23,19 @@ private:
     int rmsWindowSize; // how many samples until have enough data to compute rms?
     float lastRmsValues[2];
 
-    std::vector<std::vector<float>> samples;
+    // all channels are stored in one planar block: channel 'c' starts at data + c * capacity
+    float *data;
+    unsigned int capacity; // allocated frames per channel, always a multiple of SAMPLES_ALIGNMENT
+    unsigned int allocatedChannels;
+
+    void reallocate(unsigned int newChannels, unsigned int newCapacity); // preserve the current samples
+
+    static unsigned int computeAlignedCapacity(unsigned int frames);
+
+    audio::AudioPeak updateRms(float maxPeaks[2]); // called after the squared sums are updated
+
+    static const unsigned int BYTES_ALIGNMENT = 64; // cache line size, also good for SIMD loads
+    static const unsigned int SAMPLES_ALIGNMENT = BYTES_ALIGNMENT / sizeof(float);
 
 public:
     explicit SamplesBuffer(unsigned int channels);
@@ -41,6 +53,9 @@ public:
 
     float *getSamplesArray(unsigned int channel) const;
 
+    SamplesBufferView getView() const;
+    SamplesBufferView getView(unsigned int offset, unsigned int frames) const;
+
     void discardFirstSamples(unsigned int samplesToDiscard); // discard N samples and set frame lenght to new size
     void append(const SamplesBuffer &other);
 
@@ -63,23 +78,31 @@ public:
 
     audio::AudioPeak computePeak();
 
+    // applyGain(gainFactor, leftGain, rightGain, boostFactor) and computePeak() fused in one pass, the samples are read only once
+    audio::AudioPeak applyGainAndComputePeak(float gainFactor, float leftGain, float rightGain, float boostFactor);
+
     void add(const SamplesBuffer &buffer);
 
     void add(uint channel, uint sampleIndex, float sampleValue);
     void add(const SamplesBuffer &buffer, int internalWriteOffset);// the offset is used in internal buffer, not in parameter buffer
     void add(uint channel, float *samples, uint samplesToAdd);
+    void add(const SamplesBufferView &view, int internalWriteOffset = 0);
 
     // copy samplesToCopy' samples starting from bufferOffset to internal buffer starting in 'internalOffset'
     void set(const SamplesBuffer &buffer, uint bufferOffset, uint samplesToCopy, uint internalOffset);
     void set(const SamplesBuffer &buffer);
     void set(const SamplesBuffer &buffer, int bufferChannelOffset, int channelsToCopy);
     void set(uint channel, uint sampleIndex, float sampleValue);
+    void set(const SamplesBufferView &view);
 
     float get(uint channel, uint sampleIndex) const;
 
     unsigned int getFrameLenght() const;
     void setFrameLenght(unsigned int newFrameLenght);
 
+    void reserve(unsigned int frames); // preallocate, setFrameLenght() will not allocate while frames <= capacity
+    unsigned int getCapacity() const;
+
     int getChannels() const;
 
     bool isEmpty() const;
@@ -98,7 +121,34 @@ inline bool SamplesBuffer::isEmpty() const
 
 inline void SamplesBuffer::add(const SamplesBuffer &buffer)
 {
-    add(buffer, 0);
+    add(buffer.getView(), 0);
+}
+
+inline void SamplesBuffer::add(const SamplesBuffer &buffer, int internalWriteOffset)
+{
+    add(buffer.getView(), internalWriteOffset);
+}
+
+inline float *SamplesBuffer::getSamplesArray(unsigned int channel) const
+{
+    Q_ASSERT(channel < allocatedChannels);
+
+    return data + channel * capacity;
+}
+
+inline SamplesBufferView SamplesBuffer::getView() const
+{
+    return SamplesBufferView(data, channels, frameLenght, capacity);
+}
+
+inline SamplesBufferView SamplesBuffer::getView(unsigned int offset, unsigned int frames) const
+{
+    return getView().slice(offset, frames);
+}
+
+inline unsigned int SamplesBuffer::getCapacity() const
+{
+    return capacity;
 }
 
 inline bool SamplesBuffer::isMono() const
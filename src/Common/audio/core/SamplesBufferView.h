@@ -0,0 +1,109 @@
+#ifndef SAMPLESBUFFERVIEW_H
+#define SAMPLESBUFFERVIEW_H
+
+#include <QtGlobal>
+
+namespace audio {
+
+/**
+    A non-owning window over planar float samples (usually the storage of a SamplesBuffer).
+    Views are cheap to copy and are used to pass audio between nodes without duplicating
+    the samples. A view is only valid while the underlying buffer is alive and not resized.
+*/
+
+class SamplesBufferView
+{
+public:
+    SamplesBufferView();
+    SamplesBufferView(float *data, uint channels, uint frameLenght, uint channelStride);
+
+    float *getSamplesArray(uint channel) const;
+
+    float get(uint channel, uint sampleIndex) const;
+
+    uint getChannels() const;
+    uint getFrameLenght() const;
+    uint getChannelStride() const;
+
+    bool isMono() const;
+    bool isEmpty() const;
+
+    SamplesBufferView slice(uint offset, uint frames) const; // sub range view, clamped to this view lenght
+
+private:
+    float *data;
+    uint channels;
+    uint frameLenght;
+    uint channelStride; // distance (in samples) between the first sample of two consecutive channels
+};
+
+inline SamplesBufferView::SamplesBufferView() :
+    data(nullptr),
+    channels(0),
+    frameLenght(0),
+    channelStride(0)
+{
+
+}
+
+inline SamplesBufferView::SamplesBufferView(float *data, uint channels, uint frameLenght, uint channelStride) :
+    data(data),
+    channels(channels),
+    frameLenght(frameLenght),
+    channelStride(channelStride)
+{
+
+}
+
+inline float *SamplesBufferView::getSamplesArray(uint channel) const
+{
+    Q_ASSERT(channel < channels);
+
+    return data + channel * channelStride;
+}
+
+inline float SamplesBufferView::get(uint channel, uint sampleIndex) const
+{
+    Q_ASSERT(sampleIndex < frameLenght);
+
+    return getSamplesArray(channel)[sampleIndex];
+}
+
+inline uint SamplesBufferView::getChannels() const
+{
+    return channels;
+}
+
+inline uint SamplesBufferView::getFrameLenght() const
+{
+    return frameLenght;
+}
+
+inline uint SamplesBufferView::getChannelStride() const
+{
+    return channelStride;
+}
+
+inline bool SamplesBufferView::isMono() const
+{
+    return channels == 1;
+}
+
+inline bool SamplesBufferView::isEmpty() const
+{
+    return frameLenght == 0;
+}
+
+inline SamplesBufferView SamplesBufferView::slice(uint offset, uint frames) const
+{
+    if (offset >= frameLenght)
+        return SamplesBufferView(data, channels, 0, channelStride);
+
+    const uint framesInSlice = qMin(frames, frameLenght - offset);
+
+    return SamplesBufferView(data + offset, channels, framesInSlice, channelStride);
+}
+
+} // namespace
+
+#endif // SAMPLESBUFFERVIEW_H
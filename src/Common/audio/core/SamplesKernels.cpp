@@ -0,0 +1,1023 @@
+#include "SamplesKernels.h"
+
+#include <QtEndian>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    #define KERNELS_X86
+    #include <immintrin.h>
+    #if defined(_MSC_VER)
+        #include <intrin.h>
+    #endif
+#elif (defined(__ARM_NEON) || defined(__ARM_NEON__)) && Q_BYTE_ORDER == Q_LITTLE_ENDIAN // the conversion kernels are reading little endian samples
+    #define KERNELS_NEON
+    #include <arm_neon.h>
+#endif
+
+#if defined(KERNELS_X86) && (defined(__GNUC__) || defined(__clang__))
+    #define TARGET_SSE2 __attribute__((target("sse2")))
+    #define TARGET_AVX2 __attribute__((target("avx2")))
+#else
+    #define TARGET_SSE2 // MSVC can compile intrinsics without special flags
+    #define TARGET_AVX2
+#endif
+
+using audio::SamplesKernels;
+
+namespace {
+
+const float INT16_SCALE = 1.0f / 32768.0f;
+const float INT32_SCALE = 1.0f / 2147483648.0f;
+
+// the max values are the biggest floats converted without overflow
+const float INT16_MIN_VALUE = -32768.0f;
+const float INT16_MAX_VALUE = 32767.0f;
+const float INT32_MIN_VALUE = -2147483648.0f;
+const float INT32_MAX_VALUE = 2147483520.0f;
+
+// ------------------------------------------------------------------------------------------
+// scalar reference, also used to process the tail samples in SIMD implementations
+
+void scaleScalar(float *samples, uint count, float gain)
+{
+    for (uint i = 0; i < count; ++i)
+        samples[i] *= gain;
+}
+
+void rampScalar(float *samples, uint count, float beginGain, float gainStep)
+{
+    float gain = beginGain;
+    for (uint i = 0; i < count; ++i) {
+        samples[i] *= gain;
+        gain += gainStep;
+    }
+}
+
+void addScalar(float *dest, const float *source, uint count)
+{
+    for (uint i = 0; i < count; ++i)
+        dest[i] += source[i];
+}
+
+float peakScalar(const float *samples, uint count, float *squaredSum)
+{
+    float maxPeak = 0;
+    float sum = 0;
+    for (uint i = 0; i < count; ++i) {
+        float abs = samples[i];
+        if (abs < 0) abs = -abs; // std::fabs is very slow, just negate if needed
+
+        if (abs > maxPeak) maxPeak = abs;
+
+        sum += abs * abs;
+    }
+
+    *squaredSum += sum;
+
+    return maxPeak;
+}
+
+float scaleAndPeakScalar(float *samples, uint count, float gain, float *squaredSum)
+{
+    float maxPeak = 0;
+    float sum = 0;
+    for (uint i = 0; i < count; ++i) {
+        float value = samples[i] * gain;
+        samples[i] = value;
+
+        if (value < 0) value = -value;
+
+        if (value > maxPeak) maxPeak = value;
+
+        sum += value * value;
+    }
+
+    *squaredSum += sum;
+
+    return maxPeak;
+}
+
+float dotProductScalar(const float *samples, const float *coefficients, uint count)
+{
+    float sum = 0;
+    for (uint i = 0; i < count; ++i)
+        sum += samples[i] * coefficients[i];
+
+    return sum;
+}
+
+void mixRangeScalar(float *dest, const float * const *sources, const float *beginGains, const float *gainSteps, uint sourcesCount, uint first, uint count)
+{
+    for (uint i = first; i < count; ++i) {
+        float sum = dest[i];
+        for (uint s = 0; s < sourcesCount; ++s)
+            sum += sources[s][i] * (beginGains[s] + gainSteps[s] * i); // not accumulating the gain, all implementations compute the same ramp
+        dest[i] = sum;
+    }
+}
+
+void mixScalar(float *dest, const float * const *sources, const float *beginGains, const float *gainSteps, uint sourcesCount, uint count)
+{
+    mixRangeScalar(dest, sources, beginGains, gainSteps, sourcesCount, 0, count);
+}
+
+void int16ToFloatRangeScalar(const void *input, uint inputChannels, float * const *outputs, uint outputsCount, uint first, uint frames)
+{
+    const uchar *bytes = static_cast<const uchar *>(input);
+    for (uint c = 0; c < outputsCount; ++c) {
+        float *output = outputs[c];
+        for (uint i = first; i < frames; ++i)
+            output[i] = qFromLittleEndian<qint16>(bytes + (i * inputChannels + c) * sizeof(qint16)) * INT16_SCALE;
+    }
+}
+
+void int32ToFloatRangeScalar(const void *input, uint inputChannels, float * const *outputs, uint outputsCount, uint first, uint frames)
+{
+    const uchar *bytes = static_cast<const uchar *>(input);
+    for (uint c = 0; c < outputsCount; ++c) {
+        float *output = outputs[c];
+        for (uint i = first; i < frames; ++i)
+            output[i] = qFromLittleEndian<qint32>(bytes + (i * inputChannels + c) * sizeof(qint32)) * INT32_SCALE;
+    }
+}
+
+void deinterleaveRangeScalar(const void *input, uint inputChannels, float * const *outputs, uint outputsCount, uint first, uint frames)
+{
+    const uchar *bytes = static_cast<const uchar *>(input);
+    for (uint c = 0; c < outputsCount; ++c) {
+        float *output = outputs[c];
+        for (uint i = first; i < frames; ++i) {
+            const quint32 bits = qFromLittleEndian<quint32>(bytes + (i * inputChannels + c) * sizeof(float));
+            std::memcpy(output + i, &bits, sizeof(float));
+        }
+    }
+}
+
+void int16ToFloatScalar(const void *input, uint inputChannels, float * const *outputs, uint outputsCount, uint frames)
+{
+    int16ToFloatRangeScalar(input, inputChannels, outputs, outputsCount, 0, frames);
+}
+
+void int32ToFloatScalar(const void *input, uint inputChannels, float * const *outputs, uint outputsCount, uint frames)
+{
+    int32ToFloatRangeScalar(input, inputChannels, outputs, outputsCount, 0, frames);
+}
+
+void deinterleaveScalar(const void *input, uint inputChannels, float * const *outputs, uint outputsCount, uint frames)
+{
+    deinterleaveRangeScalar(input, inputChannels, outputs, outputsCount, 0, frames);
+}
+
+inline float clip(float value, float minValue, float maxValue)
+{
+    value = value > minValue ? value : minValue; // same NaN handling of SSE max/min
+    return value < maxValue ? value : maxValue;
+}
+
+void floatToInt16RangeScalar(const float * const *inputs, uint channels, void *output, uint first, uint frames)
+{
+    uchar *bytes = static_cast<uchar *>(output);
+    for (uint i = first; i < frames; ++i) {
+        for (uint c = 0; c < channels; ++c) {
+            const float value = clip(inputs[c][i] * 32768.0f, INT16_MIN_VALUE, INT16_MAX_VALUE);
+            qToLittleEndian(static_cast<qint16>(std::lrint(value)), bytes + (i * channels + c) * sizeof(qint16));
+        }
+    }
+}
+
+void floatToInt32RangeScalar(const float * const *inputs, uint channels, void *output, uint first, uint frames)
+{
+    uchar *bytes = static_cast<uchar *>(output);
+    for (uint i = first; i < frames; ++i) {
+        for (uint c = 0; c < channels; ++c) {
+            const float value = clip(inputs[c][i] * 2147483648.0f, INT32_MIN_VALUE, INT32_MAX_VALUE);
+            qToLittleEndian(static_cast<qint32>(std::lrint(value)), bytes + (i * channels + c) * sizeof(qint32));
+        }
+    }
+}
+
+void interleaveRangeScalar(const float * const *inputs, uint channels, void *output, uint first, uint frames)
+{
+    uchar *bytes = static_cast<uchar *>(output);
+    for (uint i = first; i < frames; ++i) {
+        for (uint c = 0; c < channels; ++c) {
+            quint32 bits;
+            std::memcpy(&bits, inputs[c] + i, sizeof(float));
+            qToLittleEndian(bits, bytes + (i * channels + c) * sizeof(float));
+        }
+    }
+}
+
+void floatToInt16Scalar(const float * const *inputs, uint channels, void *output, uint frames)
+{
+    floatToInt16RangeScalar(inputs, channels, output, 0, frames);
+}
+
+void floatToInt32Scalar(const float * const *inputs, uint channels, void *output, uint frames)
+{
+    floatToInt32RangeScalar(inputs, channels, output, 0, frames);
+}
+
+void interleaveScalar(const float * const *inputs, uint channels, void *output, uint frames)
+{
+    interleaveRangeScalar(inputs, channels, output, 0, frames);
+}
+
+const SamplesKernels scalarKernels = {
+    "Scalar",
+    scaleScalar,
+    rampScalar,
+    addScalar,
+    peakScalar,
+    scaleAndPeakScalar,
+    dotProductScalar,
+    mixScalar,
+    int16ToFloatScalar,
+    int32ToFloatScalar,
+    deinterleaveScalar,
+    floatToInt16Scalar,
+    floatToInt32Scalar,
+    interleaveScalar
+};
+
+#ifdef KERNELS_X86
+
+// ------------------------------------------------------------------------------------------
+// SSE2, 4 samples per iteration
+
+TARGET_SSE2 inline float horizontalMax(__m128 v)
+{
+    v = _mm_max_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+    v = _mm_max_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+    return _mm_cvtss_f32(v);
+}
+
+TARGET_SSE2 inline float horizontalSum(__m128 v)
+{
+    v = _mm_add_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+    v = _mm_add_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+    return _mm_cvtss_f32(v);
+}
+
+TARGET_SSE2 void scaleSse2(float *samples, uint count, float gain)
+{
+    const __m128 g = _mm_set1_ps(gain);
+    uint i = 0;
+    for (; i + 4 <= count; i += 4)
+        _mm_storeu_ps(samples + i, _mm_mul_ps(_mm_loadu_ps(samples + i), g));
+
+    scaleScalar(samples + i, count - i, gain);
+}
+
+TARGET_SSE2 void rampSse2(float *samples, uint count, float beginGain, float gainStep)
+{
+    __m128 gains = _mm_add_ps(_mm_set1_ps(beginGain), _mm_mul_ps(_mm_set1_ps(gainStep), _mm_set_ps(3, 2, 1, 0)));
+    const __m128 increment = _mm_set1_ps(gainStep * 4);
+    uint i = 0;
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_ps(samples + i, _mm_mul_ps(_mm_loadu_ps(samples + i), gains));
+        gains = _mm_add_ps(gains, increment);
+    }
+
+    rampScalar(samples + i, count - i, beginGain + gainStep * i, gainStep);
+}
+
+TARGET_SSE2 void addSse2(float *dest, const float *source, uint count)
+{
+    uint i = 0;
+    for (; i + 4 <= count; i += 4)
+        _mm_storeu_ps(dest + i, _mm_add_ps(_mm_loadu_ps(dest + i), _mm_loadu_ps(source + i)));
+
+    addScalar(dest + i, source + i, count - i);
+}
+
+TARGET_SSE2 float peakSse2(const float *samples, uint count, float *squaredSum)
+{
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+    __m128 maxPeak = _mm_setzero_ps();
+    __m128 sum = _mm_setzero_ps();
+    uint i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 v = _mm_and_ps(_mm_loadu_ps(samples + i), absMask);
+        maxPeak = _mm_max_ps(maxPeak, v);
+        sum = _mm_add_ps(sum, _mm_mul_ps(v, v));
+    }
+
+    *squaredSum += horizontalSum(sum);
+
+    return std::max(horizontalMax(maxPeak), peakScalar(samples + i, count - i, squaredSum));
+}
+
+TARGET_SSE2 float scaleAndPeakSse2(float *samples, uint count, float gain, float *squaredSum)
+{
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+    const __m128 g = _mm_set1_ps(gain);
+    __m128 maxPeak = _mm_setzero_ps();
+    __m128 sum = _mm_setzero_ps();
+    uint i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 v = _mm_mul_ps(_mm_loadu_ps(samples + i), g);
+        _mm_storeu_ps(samples + i, v);
+        v = _mm_and_ps(v, absMask);
+        maxPeak = _mm_max_ps(maxPeak, v);
+        sum = _mm_add_ps(sum, _mm_mul_ps(v, v));
+    }
+
+    *squaredSum += horizontalSum(sum);
+
+    return std::max(horizontalMax(maxPeak), scaleAndPeakScalar(samples + i, count - i, gain, squaredSum));
+}
+
+TARGET_SSE2 float dotProductSse2(const float *samples, const float *coefficients, uint count)
+{
+    __m128 sum0 = _mm_setzero_ps();
+    __m128 sum1 = _mm_setzero_ps(); // two accumulators to hide the add latency
+    uint i = 0;
+    for (; i + 8 <= count; i += 8) {
+        sum0 = _mm_add_ps(sum0, _mm_mul_ps(_mm_loadu_ps(samples + i), _mm_loadu_ps(coefficients + i)));
+        sum1 = _mm_add_ps(sum1, _mm_mul_ps(_mm_loadu_ps(samples + i + 4), _mm_loadu_ps(coefficients + i + 4)));
+    }
+
+    return horizontalSum(_mm_add_ps(sum0, sum1)) + dotProductScalar(samples + i, coefficients + i, count - i);
+}
+
+TARGET_SSE2 void mixSse2(float *dest, const float * const *sources, const float *beginGains, const float *gainSteps, uint sourcesCount, uint count)
+{
+    const __m128 offsets = _mm_set_ps(3, 2, 1, 0);
+    uint i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128 positions = _mm_add_ps(_mm_set1_ps(static_cast<float>(i)), offsets);
+        __m128 sum = _mm_loadu_ps(dest + i); // dest is loaded and stored once for all sources
+        for (uint s = 0; s < sourcesCount; ++s) {
+            const __m128 gains = _mm_add_ps(_mm_set1_ps(beginGains[s]), _mm_mul_ps(_mm_set1_ps(gainSteps[s]), positions));
+            sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(sources[s] + i), gains));
+        }
+        _mm_storeu_ps(dest + i, sum);
+    }
+
+    mixRangeScalar(dest, sources, beginGains, gainSteps, sourcesCount, i, count);
+}
+
+// the mono and stereo files are converted with SIMD, other channel layouts are using the scalar code
+
+TARGET_SSE2 inline __m128 int16ToFloat(__m128i samples, __m128 scale, bool high)
+{
+    const __m128i expanded = high ? _mm_unpackhi_epi16(samples, samples) : _mm_unpacklo_epi16(samples, samples);
+    return _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(expanded, 16)), scale); // sign extended
+}
+
+TARGET_SSE2 inline void storeStereo(__m128 first, __m128 second, float *left, float *right)
+{
+    // first = L0 R0 L1 R1, second = L2 R2 L3 R3
+    _mm_storeu_ps(left, _mm_shuffle_ps(first, second, _MM_SHUFFLE(2, 0, 2, 0)));
+    _mm_storeu_ps(right, _mm_shuffle_ps(first, second, _MM_SHUFFLE(3, 1, 3, 1)));
+}
+
+TARGET_SSE2 void int16ToFloatSse2(const void *input, uint inputChannels, float * const *outputs, uint outputsCount, uint frames)
+{
+    const qint16 *samples = static_cast<const qint16 *>(input);
+    const __m128 scale = _mm_set1_ps(INT16_SCALE);
+    uint i = 0;
+    if (inputChannels == 1 && outputsCount == 1) {
+        for (; i + 8 <= frames; i += 8) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(samples + i));
+            _mm_storeu_ps(outputs[0] + i, int16ToFloat(v, scale, false));
+            _mm_storeu_ps(outputs[0] + i + 4, int16ToFloat(v, scale, true));
+        }
+    }
+    else if (inputChannels == 2 && outputsCount == 2) {
+        for (; i + 4 <= frames; i += 4) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(samples + i * 2));
+            storeStereo(int16ToFloat(v, scale, false), int16ToFloat(v, scale, true), outputs[0] + i, outputs[1] + i);
+        }
+    }
+
+    int16ToFloatRangeScalar(input, inputChannels, outputs, outputsCount, i, frames);
+}
+
+TARGET_SSE2 void int32ToFloatSse2(const void *input, uint inputChannels, float * const *outputs, uint outputsCount, uint frames)
+{
+    const qint32 *samples = static_cast<const qint32 *>(input);
+    const __m128 scale = _mm_set1_ps(INT32_SCALE);
+    uint i = 0;
+    if (inputChannels == 1 && outputsCount == 1) {
+        for (; i + 4 <= frames; i += 4) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(samples + i));
+            _mm_storeu_ps(outputs[0] + i, _mm_mul_ps(_mm_cvtepi32_ps(v), scale));
+        }
+    }
+    else if (inputChannels == 2 && outputsCount == 2) {
+        for (; i + 4 <= frames; i += 4) {
+            const __m128i first = _mm_loadu_si128(reinterpret_cast<const __m128i *>(samples + i * 2));
+            const __m128i second = _mm_loadu_si128(reinterpret_cast<const __m128i *>(samples + i * 2 + 4));
+            storeStereo(_mm_mul_ps(_mm_cvtepi32_ps(first), scale), _mm_mul_ps(_mm_cvtepi32_ps(second), scale), outputs[0] + i, outputs[1] + i);
+        }
+    }
+
+    int32ToFloatRangeScalar(input, inputChannels, outputs, outputsCount, i, frames);
+}
+
+TARGET_SSE2 void deinterleaveSse2(const void *input, uint inputChannels, float * const *outputs, uint outputsCount, uint frames)
+{
+    const float *samples = static_cast<const float *>(input);
+    uint i = 0;
+    if (inputChannels == 1 && outputsCount == 1) {
+        if (frames > 0)
+            std::memcpy(outputs[0], samples, frames * sizeof(float));
+        return;
+    }
+
+    if (inputChannels == 2 && outputsCount == 2) {
+        for (; i + 4 <= frames; i += 4)
+            storeStereo(_mm_loadu_ps(samples + i * 2), _mm_loadu_ps(samples + i * 2 + 4), outputs[0] + i, outputs[1] + i);
+    }
+
+    deinterleaveRangeScalar(input, inputChannels, outputs, outputsCount, i, frames);
+}
+
+TARGET_SSE2 inline __m128i floatToInt(__m128 samples, __m128 scale, __m128 minValue, __m128 maxValue)
+{
+    return _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(samples, scale), minValue), maxValue)); // rounding to nearest
+}
+
+TARGET_SSE2 void floatToInt16Sse2(const float * const *inputs, uint channels, void *output, uint frames)
+{
+    qint16 *samples = static_cast<qint16 *>(output);
+    const __m128 scale = _mm_set1_ps(32768.0f);
+    const __m128 minValue = _mm_set1_ps(INT16_MIN_VALUE);
+    const __m128 maxValue = _mm_set1_ps(INT16_MAX_VALUE);
+    uint i = 0;
+    if (channels == 1) {
+        for (; i + 8 <= frames; i += 8) {
+            const __m128i first = floatToInt(_mm_loadu_ps(inputs[0] + i), scale, minValue, maxValue);
+            const __m128i second = floatToInt(_mm_loadu_ps(inputs[0] + i + 4), scale, minValue, maxValue);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(samples + i), _mm_packs_epi32(first, second));
+        }
+    }
+    else if (channels == 2) {
+        for (; i + 4 <= frames; i += 4) {
+            const __m128 left = _mm_loadu_ps(inputs[0] + i);
+            const __m128 right = _mm_loadu_ps(inputs[1] + i);
+            const __m128i first = floatToInt(_mm_unpacklo_ps(left, right), scale, minValue, maxValue); // L0 R0 L1 R1
+            const __m128i second = floatToInt(_mm_unpackhi_ps(left, right), scale, minValue, maxValue); // L2 R2 L3 R3
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(samples + i * 2), _mm_packs_epi32(first, second));
+        }
+    }
+
+    floatToInt16RangeScalar(inputs, channels, output, i, frames);
+}
+
+TARGET_SSE2 void floatToInt32Sse2(const float * const *inputs, uint channels, void *output, uint frames)
+{
+    qint32 *samples = static_cast<qint32 *>(output);
+    const __m128 scale = _mm_set1_ps(2147483648.0f);
+    const __m128 minValue = _mm_set1_ps(INT32_MIN_VALUE);
+    const __m128 maxValue = _mm_set1_ps(INT32_MAX_VALUE);
+    uint i = 0;
+    if (channels == 1) {
+        for (; i + 4 <= frames; i += 4)
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(samples + i), floatToInt(_mm_loadu_ps(inputs[0] + i), scale, minValue, maxValue));
+    }
+    else if (channels == 2) {
+        for (; i + 4 <= frames; i += 4) {
+            const __m128 left = _mm_loadu_ps(inputs[0] + i);
+            const __m128 right = _mm_loadu_ps(inputs[1] + i);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(samples + i * 2), floatToInt(_mm_unpacklo_ps(left, right), scale, minValue, maxValue));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(samples + i * 2 + 4), floatToInt(_mm_unpackhi_ps(left, right), scale, minValue, maxValue));
+        }
+    }
+
+    floatToInt32RangeScalar(inputs, channels, output, i, frames);
+}
+
+TARGET_SSE2 void interleaveSse2(const float * const *inputs, uint channels, void *output, uint frames)
+{
+    float *samples = static_cast<float *>(output);
+    uint i = 0;
+    if (channels == 1) {
+        if (frames > 0)
+            std::memcpy(samples, inputs[0], frames * sizeof(float));
+        return;
+    }
+
+    if (channels == 2) {
+        for (; i + 4 <= frames; i += 4) {
+            const __m128 left = _mm_loadu_ps(inputs[0] + i);
+            const __m128 right = _mm_loadu_ps(inputs[1] + i);
+            _mm_storeu_ps(samples + i * 2, _mm_unpacklo_ps(left, right));
+            _mm_storeu_ps(samples + i * 2 + 4, _mm_unpackhi_ps(left, right));
+        }
+    }
+
+    interleaveRangeScalar(inputs, channels, output, i, frames);
+}
+
+const SamplesKernels sse2Kernels = {
+    "SSE2",
+    scaleSse2,
+    rampSse2,
+    addSse2,
+    peakSse2,
+    scaleAndPeakSse2,
+    dotProductSse2,
+    mixSse2,
+    int16ToFloatSse2,
+    int32ToFloatSse2,
+    deinterleaveSse2,
+    floatToInt16Sse2,
+    floatToInt32Sse2,
+    interleaveSse2
+};
+
+// ------------------------------------------------------------------------------------------
+// AVX2, 8 samples per iteration
+
+TARGET_AVX2 inline __m128 reduceMax(__m256 v)
+{
+    return _mm_max_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+}
+
+TARGET_AVX2 inline __m128 reduceSum(__m256 v)
+{
+    return _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+}
+
+TARGET_AVX2 void scaleAvx2(float *samples, uint count, float gain)
+{
+    const __m256 g = _mm256_set1_ps(gain);
+    uint i = 0;
+    for (; i + 8 <= count; i += 8)
+        _mm256_storeu_ps(samples + i, _mm256_mul_ps(_mm256_loadu_ps(samples + i), g));
+
+    scaleScalar(samples + i, count - i, gain);
+}
+
+TARGET_AVX2 void rampAvx2(float *samples, uint count, float beginGain, float gainStep)
+{
+    __m256 gains = _mm256_add_ps(_mm256_set1_ps(beginGain), _mm256_mul_ps(_mm256_set1_ps(gainStep), _mm256_set_ps(7, 6, 5, 4, 3, 2, 1, 0)));
+    const __m256 increment = _mm256_set1_ps(gainStep * 8);
+    uint i = 0;
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_ps(samples + i, _mm256_mul_ps(_mm256_loadu_ps(samples + i), gains));
+        gains = _mm256_add_ps(gains, increment);
+    }
+
+    rampScalar(samples + i, count - i, beginGain + gainStep * i, gainStep);
+}
+
+TARGET_AVX2 void addAvx2(float *dest, const float *source, uint count)
+{
+    uint i = 0;
+    for (; i + 8 <= count; i += 8)
+        _mm256_storeu_ps(dest + i, _mm256_add_ps(_mm256_loadu_ps(dest + i), _mm256_loadu_ps(source + i)));
+
+    addScalar(dest + i, source + i, count - i);
+}
+
+TARGET_AVX2 float peakAvx2(const float *samples, uint count, float *squaredSum)
+{
+    const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+    __m256 maxPeak = _mm256_setzero_ps();
+    __m256 sum = _mm256_setzero_ps();
+    uint i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 v = _mm256_and_ps(_mm256_loadu_ps(samples + i), absMask);
+        maxPeak = _mm256_max_ps(maxPeak, v);
+        sum = _mm256_add_ps(sum, _mm256_mul_ps(v, v));
+    }
+
+    *squaredSum += horizontalSum(reduceSum(sum));
+
+    return std::max(horizontalMax(reduceMax(maxPeak)), peakScalar(samples + i, count - i, squaredSum));
+}
+
+TARGET_AVX2 float scaleAndPeakAvx2(float *samples, uint count, float gain, float *squaredSum)
+{
+    const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+    const __m256 g = _mm256_set1_ps(gain);
+    __m256 maxPeak = _mm256_setzero_ps();
+    __m256 sum = _mm256_setzero_ps();
+    uint i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 v = _mm256_mul_ps(_mm256_loadu_ps(samples + i), g);
+        _mm256_storeu_ps(samples + i, v);
+        v = _mm256_and_ps(v, absMask);
+        maxPeak = _mm256_max_ps(maxPeak, v);
+        sum = _mm256_add_ps(sum, _mm256_mul_ps(v, v));
+    }
+
+    *squaredSum += horizontalSum(reduceSum(sum));
+
+    return std::max(horizontalMax(reduceMax(maxPeak)), scaleAndPeakScalar(samples + i, count - i, gain, squaredSum));
+}
+
+TARGET_AVX2 float dotProductAvx2(const float *samples, const float *coefficients, uint count)
+{
+    __m256 sum0 = _mm256_setzero_ps();
+    __m256 sum1 = _mm256_setzero_ps();
+    uint i = 0;
+    for (; i + 16 <= count; i += 16) {
+        sum0 = _mm256_add_ps(sum0, _mm256_mul_ps(_mm256_loadu_ps(samples + i), _mm256_loadu_ps(coefficients + i)));
+        sum1 = _mm256_add_ps(sum1, _mm256_mul_ps(_mm256_loadu_ps(samples + i + 8), _mm256_loadu_ps(coefficients + i + 8)));
+    }
+
+    if (i + 8 <= count) {
+        sum0 = _mm256_add_ps(sum0, _mm256_mul_ps(_mm256_loadu_ps(samples + i), _mm256_loadu_ps(coefficients + i)));
+        i += 8;
+    }
+
+    return horizontalSum(reduceSum(_mm256_add_ps(sum0, sum1))) + dotProductScalar(samples + i, coefficients + i, count - i);
+}
+
+TARGET_AVX2 void mixAvx2(float *dest, const float * const *sources, const float *beginGains, const float *gainSteps, uint sourcesCount, uint count)
+{
+    const __m256 offsets = _mm256_set_ps(7, 6, 5, 4, 3, 2, 1, 0);
+    uint i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256 positions = _mm256_add_ps(_mm256_set1_ps(static_cast<float>(i)), offsets);
+        __m256 sum = _mm256_loadu_ps(dest + i);
+        for (uint s = 0; s < sourcesCount; ++s) {
+            const __m256 gains = _mm256_add_ps(_mm256_set1_ps(beginGains[s]), _mm256_mul_ps(_mm256_set1_ps(gainSteps[s]), positions));
+            sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_loadu_ps(sources[s] + i), gains));
+        }
+        _mm256_storeu_ps(dest + i, sum);
+    }
+
+    mixRangeScalar(dest, sources, beginGains, gainSteps, sourcesCount, i, count);
+}
+
+const SamplesKernels avx2Kernels = {
+    "AVX2",
+    scaleAvx2,
+    rampAvx2,
+    addAvx2,
+    peakAvx2,
+    scaleAndPeakAvx2,
+    dotProductAvx2,
+    mixAvx2,
+    int16ToFloatSse2, // the conversions are memory bound, AVX2 is not faster
+    int32ToFloatSse2,
+    deinterleaveSse2,
+    floatToInt16Sse2,
+    floatToInt32Sse2,
+    interleaveSse2
+};
+
+bool cpuHasSse2()
+{
+#if defined(__x86_64__) || defined(_M_X64)
+    return true; // always available in x64
+#elif defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[3] & (1 << 26)) != 0;
+#else
+    return __builtin_cpu_supports("sse2");
+#endif
+}
+
+bool cpuHasAvx2()
+{
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7)
+        return false;
+
+    __cpuid(info, 1);
+    const bool osUsesXSave = (info[2] & (1 << 27)) != 0;
+    const bool cpuHasAvx = (info[2] & (1 << 28)) != 0;
+    if (!osUsesXSave || !cpuHasAvx)
+        return false;
+
+    if ((_xgetbv(0) & 0x6) != 0x6) // OS is saving the YMM registers?
+        return false;
+
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif // KERNELS_X86
+
+#ifdef KERNELS_NEON
+
+// ------------------------------------------------------------------------------------------
+// NEON, 4 samples per iteration
+
+inline float horizontalMax(float32x4_t v)
+{
+    float32x2_t m = vmax_f32(vget_low_f32(v), vget_high_f32(v));
+    m = vpmax_f32(m, m);
+    return vget_lane_f32(m, 0);
+}
+
+inline float horizontalSum(float32x4_t v)
+{
+    float32x2_t s = vadd_f32(vget_low_f32(v), vget_high_f32(v));
+    s = vpadd_f32(s, s);
+    return vget_lane_f32(s, 0);
+}
+
+void scaleNeon(float *samples, uint count, float gain)
+{
+    uint i = 0;
+    for (; i + 4 <= count; i += 4)
+        vst1q_f32(samples + i, vmulq_n_f32(vld1q_f32(samples + i), gain));
+
+    scaleScalar(samples + i, count - i, gain);
+}
+
+void rampNeon(float *samples, uint count, float beginGain, float gainStep)
+{
+    const float offsets[4] = {0, 1, 2, 3};
+    float32x4_t gains = vmlaq_n_f32(vdupq_n_f32(beginGain), vld1q_f32(offsets), gainStep);
+    const float32x4_t increment = vdupq_n_f32(gainStep * 4);
+    uint i = 0;
+    for (; i + 4 <= count; i += 4) {
+        vst1q_f32(samples + i, vmulq_f32(vld1q_f32(samples + i), gains));
+        gains = vaddq_f32(gains, increment);
+    }
+
+    rampScalar(samples + i, count - i, beginGain + gainStep * i, gainStep);
+}
+
+void addNeon(float *dest, const float *source, uint count)
+{
+    uint i = 0;
+    for (; i + 4 <= count; i += 4)
+        vst1q_f32(dest + i, vaddq_f32(vld1q_f32(dest + i), vld1q_f32(source + i)));
+
+    addScalar(dest + i, source + i, count - i);
+}
+
+float peakNeon(const float *samples, uint count, float *squaredSum)
+{
+    float32x4_t maxPeak = vdupq_n_f32(0);
+    float32x4_t sum = vdupq_n_f32(0);
+    uint i = 0;
+    for (; i + 4 <= count; i += 4) {
+        float32x4_t v = vabsq_f32(vld1q_f32(samples + i));
+        maxPeak = vmaxq_f32(maxPeak, v);
+        sum = vmlaq_f32(sum, v, v);
+    }
+
+    *squaredSum += horizontalSum(sum);
+
+    return std::max(horizontalMax(maxPeak), peakScalar(samples + i, count - i, squaredSum));
+}
+
+float scaleAndPeakNeon(float *samples, uint count, float gain, float *squaredSum)
+{
+    float32x4_t maxPeak = vdupq_n_f32(0);
+    float32x4_t sum = vdupq_n_f32(0);
+    uint i = 0;
+    for (; i + 4 <= count; i += 4) {
+        float32x4_t v = vmulq_n_f32(vld1q_f32(samples + i), gain);
+        vst1q_f32(samples + i, v);
+        v = vabsq_f32(v);
+        maxPeak = vmaxq_f32(maxPeak, v);
+        sum = vmlaq_f32(sum, v, v);
+    }
+
+    *squaredSum += horizontalSum(sum);
+
+    return std::max(horizontalMax(maxPeak), scaleAndPeakScalar(samples + i, count - i, gain, squaredSum));
+}
+
+float dotProductNeon(const float *samples, const float *coefficients, uint count)
+{
+    float32x4_t sum0 = vdupq_n_f32(0);
+    float32x4_t sum1 = vdupq_n_f32(0);
+    uint i = 0;
+    for (; i + 8 <= count; i += 8) {
+        sum0 = vmlaq_f32(sum0, vld1q_f32(samples + i), vld1q_f32(coefficients + i));
+        sum1 = vmlaq_f32(sum1, vld1q_f32(samples + i + 4), vld1q_f32(coefficients + i + 4));
+    }
+
+    return horizontalSum(vaddq_f32(sum0, sum1)) + dotProductScalar(samples + i, coefficients + i, count - i);
+}
+
+void mixNeon(float *dest, const float * const *sources, const float *beginGains, const float *gainSteps, uint sourcesCount, uint count)
+{
+    const float offsets[4] = {0, 1, 2, 3};
+    const float32x4_t offsetsVector = vld1q_f32(offsets);
+    uint i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const float32x4_t positions = vaddq_f32(vdupq_n_f32(static_cast<float>(i)), offsetsVector);
+        float32x4_t sum = vld1q_f32(dest + i);
+        for (uint s = 0; s < sourcesCount; ++s) {
+            const float32x4_t gains = vmlaq_n_f32(vdupq_n_f32(beginGains[s]), positions, gainSteps[s]);
+            sum = vmlaq_f32(sum, vld1q_f32(sources[s] + i), gains);
+        }
+        vst1q_f32(dest + i, sum);
+    }
+
+    mixRangeScalar(dest, sources, beginGains, gainSteps, sourcesCount, i, count);
+}
+
+inline float32x4_t int16ToFloat(int16x4_t samples)
+{
+    return vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(samples)), INT16_SCALE);
+}
+
+void int16ToFloatNeon(const void *input, uint inputChannels, float * const *outputs, uint outputsCount, uint frames)
+{
+    const int16_t *samples = static_cast<const int16_t *>(input);
+    uint i = 0;
+    if (inputChannels == 1 && outputsCount == 1) {
+        for (; i + 8 <= frames; i += 8) {
+            const int16x8_t v = vld1q_s16(samples + i);
+            vst1q_f32(outputs[0] + i, int16ToFloat(vget_low_s16(v)));
+            vst1q_f32(outputs[0] + i + 4, int16ToFloat(vget_high_s16(v)));
+        }
+    }
+    else if (inputChannels == 2 && outputsCount == 2) {
+        for (; i + 8 <= frames; i += 8) {
+            const int16x8x2_t v = vld2q_s16(samples + i * 2); // deinterleaved load
+            for (uint c = 0; c < 2; ++c) {
+                vst1q_f32(outputs[c] + i, int16ToFloat(vget_low_s16(v.val[c])));
+                vst1q_f32(outputs[c] + i + 4, int16ToFloat(vget_high_s16(v.val[c])));
+            }
+        }
+    }
+
+    int16ToFloatRangeScalar(input, inputChannels, outputs, outputsCount, i, frames);
+}
+
+void int32ToFloatNeon(const void *input, uint inputChannels, float * const *outputs, uint outputsCount, uint frames)
+{
+    const int32_t *samples = static_cast<const int32_t *>(input);
+    uint i = 0;
+    if (inputChannels == 1 && outputsCount == 1) {
+        for (; i + 4 <= frames; i += 4)
+            vst1q_f32(outputs[0] + i, vmulq_n_f32(vcvtq_f32_s32(vld1q_s32(samples + i)), INT32_SCALE));
+    }
+    else if (inputChannels == 2 && outputsCount == 2) {
+        for (; i + 4 <= frames; i += 4) {
+            const int32x4x2_t v = vld2q_s32(samples + i * 2);
+            vst1q_f32(outputs[0] + i, vmulq_n_f32(vcvtq_f32_s32(v.val[0]), INT32_SCALE));
+            vst1q_f32(outputs[1] + i, vmulq_n_f32(vcvtq_f32_s32(v.val[1]), INT32_SCALE));
+        }
+    }
+
+    int32ToFloatRangeScalar(input, inputChannels, outputs, outputsCount, i, frames);
+}
+
+void deinterleaveNeon(const void *input, uint inputChannels, float * const *outputs, uint outputsCount, uint frames)
+{
+    const float *samples = static_cast<const float *>(input);
+    uint i = 0;
+    if (inputChannels == 1 && outputsCount == 1) {
+        if (frames > 0)
+            std::memcpy(outputs[0], samples, frames * sizeof(float));
+        return;
+    }
+
+    if (inputChannels == 2 && outputsCount == 2) {
+        for (; i + 4 <= frames; i += 4) {
+            const float32x4x2_t v = vld2q_f32(samples + i * 2);
+            vst1q_f32(outputs[0] + i, v.val[0]);
+            vst1q_f32(outputs[1] + i, v.val[1]);
+        }
+    }
+
+    deinterleaveRangeScalar(input, inputChannels, outputs, outputsCount, i, frames);
+}
+
+inline int32x4_t floatToInt(float32x4_t samples, float scale, float minValue, float maxValue)
+{
+    const float32x4_t value = vminq_f32(vmaxq_f32(vmulq_n_f32(samples, scale), vdupq_n_f32(minValue)), vdupq_n_f32(maxValue));
+#ifdef __aarch64__
+    return vcvtnq_s32_f32(value); // rounding to nearest
+#else
+    const uint32x4_t half = vorrq_u32(vandq_u32(vreinterpretq_u32_f32(value), vdupq_n_u32(0x80000000)), vreinterpretq_u32_f32(vdupq_n_f32(0.5f)));
+    return vcvtq_s32_f32(vaddq_f32(value, vreinterpretq_f32_u32(half))); // ARMv7 is truncating, rounding half away from zero
+#endif
+}
+
+inline int16x8_t floatToInt16(const float *samples)
+{
+    const int32x4_t first = floatToInt(vld1q_f32(samples), 32768.0f, INT16_MIN_VALUE, INT16_MAX_VALUE);
+    const int32x4_t second = floatToInt(vld1q_f32(samples + 4), 32768.0f, INT16_MIN_VALUE, INT16_MAX_VALUE);
+    return vcombine_s16(vqmovn_s32(first), vqmovn_s32(second));
+}
+
+void floatToInt16Neon(const float * const *inputs, uint channels, void *output, uint frames)
+{
+    int16_t *samples = static_cast<int16_t *>(output);
+    uint i = 0;
+    if (channels == 1) {
+        for (; i + 8 <= frames; i += 8)
+            vst1q_s16(samples + i, floatToInt16(inputs[0] + i));
+    }
+    else if (channels == 2) {
+        for (; i + 8 <= frames; i += 8) {
+            int16x8x2_t v;
+            v.val[0] = floatToInt16(inputs[0] + i);
+            v.val[1] = floatToInt16(inputs[1] + i);
+            vst2q_s16(samples + i * 2, v); // interleaved store
+        }
+    }
+
+    floatToInt16RangeScalar(inputs, channels, output, i, frames);
+}
+
+void floatToInt32Neon(const float * const *inputs, uint channels, void *output, uint frames)
+{
+    int32_t *samples = static_cast<int32_t *>(output);
+    uint i = 0;
+    if (channels == 1) {
+        for (; i + 4 <= frames; i += 4)
+            vst1q_s32(samples + i, floatToInt(vld1q_f32(inputs[0] + i), 2147483648.0f, INT32_MIN_VALUE, INT32_MAX_VALUE));
+    }
+    else if (channels == 2) {
+        for (; i + 4 <= frames; i += 4) {
+            int32x4x2_t v;
+            v.val[0] = floatToInt(vld1q_f32(inputs[0] + i), 2147483648.0f, INT32_MIN_VALUE, INT32_MAX_VALUE);
+            v.val[1] = floatToInt(vld1q_f32(inputs[1] + i), 2147483648.0f, INT32_MIN_VALUE, INT32_MAX_VALUE);
+            vst2q_s32(samples + i * 2, v);
+        }
+    }
+
+    floatToInt32RangeScalar(inputs, channels, output, i, frames);
+}
+
+void interleaveNeon(const float * const *inputs, uint channels, void *output, uint frames)
+{
+    float *samples = static_cast<float *>(output);
+    uint i = 0;
+    if (channels == 1) {
+        if (frames > 0)
+            std::memcpy(samples, inputs[0], frames * sizeof(float));
+        return;
+    }
+
+    if (channels == 2) {
+        for (; i + 4 <= frames; i += 4) {
+            float32x4x2_t v;
+            v.val[0] = vld1q_f32(inputs[0] + i);
+            v.val[1] = vld1q_f32(inputs[1] + i);
+            vst2q_f32(samples + i * 2, v);
+        }
+    }
+
+    interleaveRangeScalar(inputs, channels, output, i, frames);
+}
+
+const SamplesKernels neonKernels = {
+    "NEON",
+    scaleNeon,
+    rampNeon,
+    addNeon,
+    peakNeon,
+    scaleAndPeakNeon,
+    dotProductNeon,
+    mixNeon,
+    int16ToFloatNeon,
+    int32ToFloatNeon,
+    deinterleaveNeon,
+    floatToInt16Neon,
+    floatToInt32Neon,
+    interleaveNeon
+};
+
+#endif // KERNELS_NEON
+
+} // namespace
+
+std::vector<const SamplesKernels *> SamplesKernels::getSupported()
+{
+    std::vector<const SamplesKernels *> kernels;
+    kernels.push_back(&scalarKernels);
+
+#ifdef KERNELS_X86
+    if (cpuHasSse2())
+        kernels.push_back(&sse2Kernels);
+
+    if (cpuHasAvx2())
+        kernels.push_back(&avx2Kernels);
+#endif
+
+#ifdef KERNELS_NEON
+    kernels.push_back(&neonKernels); // NEON is mandatory in all ARM cpus we support
+#endif
+
+    return kernels;
+}
+
+const SamplesKernels &SamplesKernels::get()
+{
+    static const SamplesKernels &best = *getSupported().back(); // the last is the faster
+
+    return best;
+}
+
+const SamplesKernels &SamplesKernels::getScalar()
+{
+    return scalarKernels;
+}
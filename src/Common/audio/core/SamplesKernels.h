@@ -0,0 +1,52 @@
+#ifndef SAMPLES_KERNELS_H
+#define SAMPLES_KERNELS_H
+
+#include <QtGlobal>
+#include <vector>
+
+namespace audio {
+
+/**
+    Inner loops used by SamplesBuffer and Resampler. Every instruction set (scalar, SSE2, AVX2, NEON)
+    provides the same set of functions, the best supported implementation is detected
+    only once (in the first get() call) and used for the rest of the session.
+
+    All functions work in one channel (planar samples). The 'squaredSum' parameter is
+    an accumulator, the sum of squared samples is added to the previous value.
+
+    The conversion functions (audio files) are the exception, the input is interleaved
+    little endian samples (wave file data) and the first 'outputsCount' channels are
+    written in 'outputs' (planar). The input is not aligned, it can be a memory mapped file.
+    The inverse functions (writing wave files) interleave 'channels' planar inputs in the
+    output, the integer samples are clipped and rounded to the nearest value.
+*/
+
+struct SamplesKernels
+{
+    const char *name;
+
+    void (*scale)(float *samples, uint count, float gain);
+    void (*ramp)(float *samples, uint count, float beginGain, float gainStep); // fades, gain is incremented by gainStep after every sample
+    void (*add)(float *dest, const float *source, uint count);
+    float (*peak)(const float *samples, uint count, float *squaredSum); // return the max absolute value
+    float (*scaleAndPeak)(float *samples, uint count, float gain, float *squaredSum); // scale + peak in one pass
+    float (*dotProduct)(const float *samples, const float *coefficients, uint count); // FIR filters
+    void (*mix)(float *dest, const float * const *sources, const float *beginGains, const float *gainSteps, uint sourcesCount, uint count); // dest += sources * gains in one pass for all sources (looper layers), gain ramps as in 'ramp'
+
+    void (*int16ToFloat)(const void *input, uint inputChannels, float * const *outputs, uint outputsCount, uint frames); // scaled by 1/32768
+    void (*int32ToFloat)(const void *input, uint inputChannels, float * const *outputs, uint outputsCount, uint frames); // scaled by 1/2^31, 24 and 8 bits are expanded to 32 bits
+    void (*deinterleave)(const void *input, uint inputChannels, float * const *outputs, uint outputsCount, uint frames); // 32 bits float samples
+
+    void (*floatToInt16)(const float * const *inputs, uint channels, void *output, uint frames); // scaled by 32768
+    void (*floatToInt32)(const float * const *inputs, uint channels, void *output, uint frames); // scaled by 2^31, 24 bits files use the 3 high bytes
+    void (*interleave)(const float * const *inputs, uint channels, void *output, uint frames); // 32 bits float samples
+
+    static const SamplesKernels &get();
+    static const SamplesKernels &getScalar(); // reference implementation
+
+    static std::vector<const SamplesKernels *> getSupported(); // all implementations supported by the running CPU, used in tests and benchmarks
+};
+
+} // namespace
+
+#endif // SAMPLES_KERNELS_H
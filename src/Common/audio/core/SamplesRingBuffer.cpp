@@ -0,0 +1,80 @@
+#include "SamplesRingBuffer.h"
+
+#include <cstring>
+
+using audio::SamplesRingBuffer;
+using audio::SamplesBuffer;
+
+namespace {
+
+uint roundToPowerOfTwo(uint value) // the counters are wrapping around in 2^32, the positions are continuous only when capacity is a power of two
+{
+    uint powerOfTwo = 1;
+    while (powerOfTwo < value)
+        powerOfTwo <<= 1;
+
+    return powerOfTwo;
+}
+
+} // namespace
+
+SamplesRingBuffer::SamplesRingBuffer(uint channels, uint capacity) :
+    capacity(roundToPowerOfTwo(qMax(capacity, 1u))),
+    storage(channels, this->capacity),
+    writeCount(0),
+    readCount(0)
+{
+
+}
+
+uint SamplesRingBuffer::write(const SamplesBuffer &samples)
+{
+    const uint written = writeCount.load(std::memory_order_relaxed); // only the producer change writeCount
+    const uint frames = qMin(samples.getFrameLenght(), capacity - (written - readCount.load(std::memory_order_acquire)));
+    if (frames == 0)
+        return 0;
+
+    const uint writePosition = written & (capacity - 1);
+    const uint firstPart = qMin(frames, capacity - writePosition);
+    const uint secondPart = frames - firstPart; // wrapping around
+
+    const uint channels = static_cast<uint>(storage.getChannels());
+    for (uint c = 0; c < channels; ++c) {
+        const float *source = samples.getSamplesArray(qMin(c, static_cast<uint>(samples.getChannels()) - 1)); // mono samples are copied to all channels
+        float *destination = storage.getSamplesArray(c);
+        std::memcpy(destination + writePosition, source, firstPart * sizeof(float));
+        if (secondPart)
+            std::memcpy(destination, source + firstPart, secondPart * sizeof(float));
+    }
+
+    writeCount.store(written + frames, std::memory_order_release); // publish the frames to the consumer
+
+    return frames;
+}
+
+uint SamplesRingBuffer::read(SamplesBuffer &out, uint frames, uint outOffset)
+{
+    Q_ASSERT(outOffset + frames <= out.getFrameLenght());
+
+    const uint consumed = readCount.load(std::memory_order_relaxed); // only the consumer change readCount
+    frames = qMin(frames, writeCount.load(std::memory_order_acquire) - consumed);
+    if (frames == 0)
+        return 0;
+
+    const uint readPosition = consumed & (capacity - 1);
+    const uint firstPart = qMin(frames, capacity - readPosition);
+    const uint secondPart = frames - firstPart;
+
+    const uint channels = static_cast<uint>(qMin(out.getChannels(), storage.getChannels()));
+    for (uint c = 0; c < channels; ++c) {
+        const float *source = storage.getSamplesArray(c);
+        float *destination = out.getSamplesArray(c) + outOffset;
+        std::memcpy(destination, source + readPosition, firstPart * sizeof(float));
+        if (secondPart)
+            std::memcpy(destination + firstPart, source, secondPart * sizeof(float));
+    }
+
+    readCount.store(consumed + frames, std::memory_order_release); // release the space to the producer
+
+    return frames;
+}
@@ -0,0 +1,65 @@
+#ifndef SAMPLES_RING_BUFFER_H
+#define SAMPLES_RING_BUFFER_H
+
+#include <QtGlobal>
+#include <atomic>
+
+#include "SamplesBuffer.h"
+
+namespace audio {
+
+/**
+    Single producer, single consumer ring of planar float frames. The producer (a decoding thread)
+    write() frames while the consumer (the audio thread) read() them, without locks or memory
+    allocations. The capacity is allocated in the constructor (rounded up to a power of two) and
+    never changes.
+*/
+
+class SamplesRingBuffer
+{
+public:
+    SamplesRingBuffer(uint channels, uint capacity);
+
+    int getChannels() const;
+    uint getCapacity() const;
+
+    uint getAvailableFrames() const; // frames ready to be read
+    uint getFreeFrames() const; // frames that can be written
+
+    uint write(const SamplesBuffer &samples); // producer thread, return the written frames (limited by getFreeFrames())
+    uint read(SamplesBuffer &out, uint frames, uint outOffset = 0); // consumer thread, return the copied frames (limited by getAvailableFrames())
+
+private:
+    Q_DISABLE_COPY(SamplesRingBuffer)
+
+    const uint capacity;
+    SamplesBuffer storage;
+
+    // incremented forever (wrapping around), the difference is the number of available frames
+    std::atomic<uint> writeCount;
+    std::atomic<uint> readCount;
+};
+
+inline int SamplesRingBuffer::getChannels() const
+{
+    return storage.getChannels();
+}
+
+inline uint SamplesRingBuffer::getCapacity() const
+{
+    return capacity;
+}
+
+inline uint SamplesRingBuffer::getAvailableFrames() const
+{
+    return writeCount.load() - readCount.load();
+}
+
+inline uint SamplesRingBuffer::getFreeFrames() const
+{
+    return capacity - getAvailableFrames();
+}
+
+} // namespace
+
+#endif // SAMPLES_RING_BUFFER_H
@@ -0,0 +1,75 @@
+#include "SnapshotPublisher.h"
+
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+
+using audio::SnapshotReadSection;
+
+/**
+    The grace period is detected using two reader counters. Read sections are counted in the
+    current phase, waitForReaders() flips the phase and wait until the old phase counter reach zero.
+    New read sections are counted in the new phase and don't delay the writer.
+*/
+
+namespace {
+
+std::atomic<uint> currentPhase(0);
+std::atomic<int> activeReaders[2];
+
+QMutex gracePeriodMutex; // serialize the phase flips, used only by writers
+
+#ifdef QT_DEBUG
+thread_local int readSectionsInThisThread = 0; // used to detect waitForReaders() called inside a read section (dead lock)
+#endif
+
+void waitUntilZero(const std::atomic<int> &readers)
+{
+    while (readers.load() > 0)
+        QThread::usleep(50); // the audio callbacks are short, readers are leaving soon
+}
+
+} // namespace
+
+SnapshotReadSection::SnapshotReadSection()
+{
+    forever {
+        phase = currentPhase.load();
+        activeReaders[phase].fetch_add(1);
+        if (currentPhase.load() == phase)
+            break;
+
+        activeReaders[phase].fetch_sub(1); // a writer flipped the phase in the meantime, try again in the new phase
+    }
+
+#ifdef QT_DEBUG
+    readSectionsInThisThread++;
+#endif
+}
+
+SnapshotReadSection::~SnapshotReadSection()
+{
+#ifdef QT_DEBUG
+    readSectionsInThisThread--;
+#endif
+
+    activeReaders[phase].fetch_sub(1);
+}
+
+void SnapshotReadSection::waitForReaders()
+{
+#ifdef QT_DEBUG
+    Q_ASSERT(readSectionsInThisThread == 0);
+#endif
+
+    QMutexLocker locker(&gracePeriodMutex);
+
+    const uint oldPhase = currentPhase.load();
+    const uint newPhase = oldPhase ^ 1;
+
+    waitUntilZero(activeReaders[newPhase]); // readers retrying after the previous flip
+
+    currentPhase.store(newPhase);
+
+    waitUntilZero(activeReaders[oldPhase]);
+}
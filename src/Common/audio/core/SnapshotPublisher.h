@@ -0,0 +1,82 @@
+#ifndef SNAPSHOT_PUBLISHER_H
+#define SNAPSHOT_PUBLISHER_H
+
+#include <QtGlobal>
+#include <atomic>
+
+namespace audio {
+
+/**
+    Read-copy-update used to share the audio graph (mixer nodes, node connections, plugins chain, etc.)
+    with the audio thread without locks. The audio thread opens a SnapshotReadSection in the beginning
+    of the callback and reads immutable snapshots. Other threads build a new snapshot, publish it with
+    an atomic pointer swap and wait the end of all read sections that can still see the old snapshot
+    (the grace period) before delete it.
+
+    Readers never block, allocate or free memory. Writers can wait (usually less than one audio
+    callback), so snapshots can't be published from the audio thread or inside a read section.
+*/
+
+class SnapshotReadSection
+{
+public:
+    SnapshotReadSection();
+    ~SnapshotReadSection();
+
+    static void waitForReaders(); // return when all read sections opened before this call are closed
+
+private:
+    Q_DISABLE_COPY(SnapshotReadSection)
+
+    uint phase;
+};
+
+template <typename T>
+class SnapshotPublisher
+{
+public:
+    explicit SnapshotPublisher(const T &initialValue = T());
+    ~SnapshotPublisher();
+
+    const T &read() const; // used in audio thread, the returned reference is valid until the read section is closed
+
+    void publish(const T &newValue); // the writers are serialized by the caller (usually using the same mutex protecting the original data)
+
+private:
+    Q_DISABLE_COPY(SnapshotPublisher)
+
+    std::atomic<const T *> current;
+};
+
+template <typename T>
+SnapshotPublisher<T>::SnapshotPublisher(const T &initialValue) :
+    current(new T(initialValue))
+{
+
+}
+
+template <typename T>
+SnapshotPublisher<T>::~SnapshotPublisher()
+{
+    delete current.load(); // the owner is destroyed when the audio thread can't reach it anymore
+}
+
+template <typename T>
+inline const T &SnapshotPublisher<T>::read() const
+{
+    return *current.load();
+}
+
+template <typename T>
+void SnapshotPublisher<T>::publish(const T &newValue)
+{
+    const T *oldValue = current.exchange(new T(newValue));
+
+    SnapshotReadSection::waitForReaders();
+
+    delete oldValue;
+}
+
+} // namespace
+
+#endif // SNAPSHOT_PUBLISHER_H
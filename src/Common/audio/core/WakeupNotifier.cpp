@@ -0,0 +1,151 @@
+#include "WakeupNotifier.h"
+
+#if defined(Q_OS_LINUX)
+    #include <sys/eventfd.h>
+    #include <unistd.h>
+    #include <cerrno>
+#elif defined(Q_OS_WIN)
+    #include <windows.h>
+    #include <climits>
+#elif defined(Q_OS_MAC)
+    #include <dispatch/dispatch.h>
+#else
+    #include <QSemaphore>
+#endif
+
+using audio::WakeupNotifier;
+
+class WakeupNotifier::Semaphore
+{
+public:
+#if defined(Q_OS_LINUX)
+    Semaphore() :
+        fd(eventfd(0, EFD_SEMAPHORE | EFD_CLOEXEC)) // each read() consume one post
+    {
+        Q_ASSERT(fd >= 0);
+    }
+
+    ~Semaphore()
+    {
+        close(fd);
+    }
+
+    void post()
+    {
+        const quint64 value = 1;
+        while (::write(fd, &value, sizeof(value)) < 0 && errno == EINTR) {
+        }
+    }
+
+    void wait()
+    {
+        quint64 value = 0;
+        while (::read(fd, &value, sizeof(value)) < 0 && errno == EINTR) {
+        }
+    }
+
+private:
+    int fd;
+
+#elif defined(Q_OS_WIN)
+    Semaphore() :
+        handle(CreateSemaphore(nullptr, 0, LONG_MAX, nullptr))
+    {
+        Q_ASSERT(handle);
+    }
+
+    ~Semaphore()
+    {
+        CloseHandle(handle);
+    }
+
+    void post()
+    {
+        ReleaseSemaphore(handle, 1, nullptr);
+    }
+
+    void wait()
+    {
+        WaitForSingleObject(handle, INFINITE);
+    }
+
+private:
+    HANDLE handle;
+
+#elif defined(Q_OS_MAC)
+    Semaphore() :
+        semaphore(dispatch_semaphore_create(0))
+    {
+    }
+
+    ~Semaphore()
+    {
+        dispatch_release(semaphore);
+    }
+
+    void post()
+    {
+        dispatch_semaphore_signal(semaphore);
+    }
+
+    void wait()
+    {
+        dispatch_semaphore_wait(semaphore, DISPATCH_TIME_FOREVER);
+    }
+
+private:
+    dispatch_semaphore_t semaphore;
+
+#else
+    void post()
+    {
+        semaphore.release(); // fallback, QSemaphore is locking a mutex internally
+    }
+
+    void wait()
+    {
+        semaphore.acquire();
+    }
+
+private:
+    QSemaphore semaphore;
+#endif
+};
+
+// +++++++++++++++++++++++++++++++++++++++
+
+WakeupNotifier::WakeupNotifier() :
+    semaphore(new Semaphore()),
+    waitingThreads(0)
+{
+
+}
+
+WakeupNotifier::~WakeupNotifier()
+{
+
+}
+
+void WakeupNotifier::notify()
+{
+    if (waitingThreads.load() > 0) // no system call when all consumers are busy
+        semaphore->post();
+}
+
+void WakeupNotifier::notifyAll(int threads)
+{
+    for (int t = 0; t < threads; ++t)
+        semaphore->post();
+}
+
+void WakeupNotifier::notifyWaiting()
+{
+    const int threads = waitingThreads.load(); // no system call when all consumers are busy
+    for (int t = 0; t < threads; ++t)
+        semaphore->post();
+}
+
+void WakeupNotifier::wait()
+{
+    semaphore->wait();
+}
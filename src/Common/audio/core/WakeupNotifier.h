@@ -0,0 +1,57 @@
+#ifndef WAKEUP_NOTIFIER_H
+#define WAKEUP_NOTIFIER_H
+
+#include <QtGlobal>
+#include <QScopedPointer>
+#include <atomic>
+
+namespace audio {
+
+/**
+    Wake up sleeping consumer threads from the audio thread. notify() never blocks: it is just an
+    atomic load when no consumer is waiting, and a semaphore post (eventfd in Linux, kernel
+    semaphores in Windows and Mac) when some consumer is sleeping. QWaitCondition is not used
+    because waking it requires locking a mutex that the sleeping threads are also using.
+
+    The consumers wait with waitUntil(), the waiting threads are counted before checking the
+    condition, so a notify() after a change in the condition is never lost.
+*/
+
+class WakeupNotifier
+{
+public:
+    WakeupNotifier();
+    ~WakeupNotifier();
+
+    void notify(); // wake up one waiting thread, never blocks
+    void notifyAll(int threads); // used to stop the consumers
+    void notifyWaiting(); // wake up all waiting threads, never blocks
+
+    template <typename Condition>
+    void waitUntil(Condition condition);
+
+private:
+    Q_DISABLE_COPY(WakeupNotifier)
+
+    class Semaphore; // the platform semaphore
+
+    QScopedPointer<Semaphore> semaphore;
+    std::atomic<int> waitingThreads;
+
+    void wait(); // wait for a semaphore post
+};
+
+template <typename Condition>
+void WakeupNotifier::waitUntil(Condition condition)
+{
+    waitingThreads++; // counted before check the condition, the producers change the condition and after that check the waiting threads
+
+    while (!condition())
+        wait(); // can return without a change in condition (a post for a thread that was not sleeping yet), the condition is checked again
+
+    waitingThreads--;
+}
+
+} // namespace
+
+#endif // WAKEUP_NOTIFIER_H
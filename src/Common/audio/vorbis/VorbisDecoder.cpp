@@ -55,13 +55,8 @@ int Decoder::getSampleRate() const
 
 //+++++++++++++++++++++++++++++++++++++++++++
 size_t Decoder::consumeTo(void *oggOutBuffer, size_t bytesToConsume){
-    size_t len = qMin( bytesToConsume, (size_t)vorbisInput.size());
-    if (len > 0) {
-        memcpy(oggOutBuffer, vorbisInput.data(), len);
-        vorbisInput.remove(0, (uint)len);
-    }
-
-    return len;
+    int len = static_cast<int>(qMin(bytesToConsume, static_cast<size_t>(vorbisInput.bytesAvailable())));
+    return static_cast<size_t>(vorbisInput.read(static_cast<char *>(oggOutBuffer), len));
 }
 
 //vorbisfile read callback
@@ -87,7 +82,7 @@ const audio::SamplesBuffer &Decoder::decode(int maxSamplesToDecode)
 
     static const int MIN_BUFFER_SIZE = 8192;
 
-    if (!initialized && vorbisInput.size() >= MIN_BUFFER_SIZE) {
+    if (!initialized && vorbisInput.bytesAvailable() >= MIN_BUFFER_SIZE) {
 
         initialize();
     }
@@ -129,7 +124,7 @@ const audio::SamplesBuffer &Decoder::decode(int maxSamplesToDecode)
     return internalBuffer;
 }
 
-void Decoder::setInputData(const QByteArray &vorbisData)
+void Decoder::setInputData(const ninjam::ByteRope &vorbisData)
 {
     vorbisInput.clear();
     vorbisInput.append(vorbisData);
@@ -4,6 +4,7 @@
 #include <vorbis/vorbisfile.h>
 #include "audio/core/SamplesBuffer.h"
 #include <QByteArray>
+#include "ninjam/ByteRope.h"
 
 namespace vorbis {
 
@@ -26,7 +27,7 @@ public:
 
     bool isInitialized() const;
 
-    void setInputData(const QByteArray &vorbisData);
+    void setInputData(const ninjam::ByteRope &vorbisData);
 
     void addInputData(const QByteArray &vorbisData);
 
@@ -36,12 +37,14 @@ public:
 
     bool isValid() const { return valid; }
 
+    int getPendingInputBytes() const { return vorbisInput.bytesAvailable(); } // encoded bytes not consumed by vorbisfile yet
+
 private:
 
     audio::SamplesBuffer internalBuffer;
     OggVorbis_File vorbisFile;
     bool initialized;
-    QByteArray vorbisInput;
+    ninjam::ByteRopeReader vorbisInput; // the consumed bytes are not removed from the input, avoiding shift the remaining bytes in every read
     static size_t readOgg(void *oggOutBuffer, size_t size, size_t nmemb, void *decoderInstance);
 
     size_t consumeTo(void *oggOutBuffer, size_t bytesToConsume);
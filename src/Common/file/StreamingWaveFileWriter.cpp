@@ -0,0 +1,242 @@
+#include "StreamingWaveFileWriter.h"
+
+#include "audio/core/SamplesBuffer.h"
+#include "audio/core/SamplesKernels.h"
+
+#include <QDebug>
+#include <QtEndian>
+#include <cstring>
+#include <vector>
+
+using audio::StreamingWaveFileWriter;
+using audio::SamplesBuffer;
+using audio::SamplesKernels;
+
+const int StreamingWaveFileWriter::HEADER_SIZE = 94; // RIFF (12) + JUNK/ds64 (36) + fmt (26) + fact (12) + data chunk header (8)
+const int StreamingWaveFileWriter::WRITE_BUFFER_SIZE = 1024 * 1024;
+const quint64 StreamingWaveFileWriter::MAX_RIFF_SIZE = 0xFFFFFFFF;
+
+namespace {
+
+const int DS64_CHUNK_SIZE = 28; // RIFF size, data size and sample count (64 bits) + table lenght (32 bits)
+const int FMT_CHUNK_SIZE = 18; // the non PCM formats have the cbSize field
+const int FACT_CHUNK_SIZE = 4; // sample count (32 bits), required in the non PCM formats
+
+void putTag(char *dest, const char *tag)
+{
+    std::memcpy(dest, tag, 4);
+}
+
+void putUInt16(char *dest, quint16 value)
+{
+    qToLittleEndian(value, reinterpret_cast<uchar *>(dest));
+}
+
+void putUInt32(char *dest, quint32 value)
+{
+    qToLittleEndian(value, reinterpret_cast<uchar *>(dest));
+}
+
+void putUInt64(char *dest, quint64 value)
+{
+    qToLittleEndian(value, reinterpret_cast<uchar *>(dest));
+}
+
+} // namespace
+
+StreamingWaveFileWriter::StreamingWaveFileWriter(quint64 maxRiffSize) :
+    sampleRate(44100),
+    channels(2),
+    writtenFrames(0),
+    frames(0),
+    rf64(false),
+    maxRiffSize(maxRiffSize)
+{
+
+}
+
+StreamingWaveFileWriter::~StreamingWaveFileWriter()
+{
+    close();
+}
+
+bool StreamingWaveFileWriter::open(const QString &filePath, quint32 sampleRate, quint8 channels, quint64 framesToKeep)
+{
+    close();
+
+    this->sampleRate = sampleRate;
+    this->channels = qMax(channels, static_cast<quint8>(1));
+    writtenFrames = 0;
+    rf64 = false;
+
+    file.setFileName(filePath);
+    const bool resuming = framesToKeep > 0 && file.exists();
+    if (!file.open(resuming ? QFile::ReadWrite : (QFile::WriteOnly | QFile::Truncate))) {
+        qCritical() << "Failed to open WAV file ..." << filePath << file.errorString();
+        return false;
+    }
+
+    if (resuming) {
+        char riffTag[4] = {};
+        file.read(riffTag, 4);
+        rf64 = std::memcmp(riffTag, "RF64", 4) == 0;
+
+        const quint64 framesInFile = file.size() > HEADER_SIZE ? (file.size() - HEADER_SIZE) / getBlockAlign() : 0;
+        writtenFrames = qMin(framesToKeep, framesInFile); // the samples written after the last flush are discarded
+        if (!file.resize(HEADER_SIZE + writtenFrames * getBlockAlign())) {
+            qCritical() << "Failed to truncate WAV file ..." << filePath << file.errorString();
+            file.close();
+            return false;
+        }
+    }
+
+    frames = writtenFrames;
+    buffer.reserve(WRITE_BUFFER_SIZE);
+    buffer.clear();
+
+    return writeHeader();
+}
+
+void StreamingWaveFileWriter::close()
+{
+    if (!file.isOpen())
+        return;
+
+    flush();
+    file.close();
+}
+
+char *StreamingWaveFileWriter::reserveBufferFrames(uint &frames)
+{
+    uint availableFrames = (WRITE_BUFFER_SIZE - buffer.size()) / getBlockAlign();
+    if (!availableFrames) {
+        writeBuffer();
+        availableFrames = WRITE_BUFFER_SIZE / getBlockAlign();
+    }
+
+    frames = qMin(frames, availableFrames);
+
+    const int position = buffer.size();
+    buffer.resize(position + frames * getBlockAlign()); // not reallocating, the capacity is WRITE_BUFFER_SIZE
+    return buffer.data() + position;
+}
+
+void StreamingWaveFileWriter::write(const SamplesBuffer &samples, uint offset, uint framesToWrite)
+{
+    if (!file.isOpen() || offset >= samples.getFrameLenght())
+        return;
+
+    framesToWrite = qMin(framesToWrite, samples.getFrameLenght() - offset);
+
+    std::vector<const float *> channelSamples(channels);
+    for (quint8 c = 0; c < channels; ++c)
+        channelSamples[c] = samples.getSamplesArray(samples.isMono() ? 0 : qMin(c, static_cast<quint8>(1))) + offset;
+
+    const auto &kernels = SamplesKernels::get();
+    while (framesToWrite > 0) {
+        uint chunkFrames = framesToWrite;
+        char *dest = reserveBufferFrames(chunkFrames);
+        kernels.interleave(channelSamples.data(), channels, dest, chunkFrames);
+
+        for (auto &channel : channelSamples)
+            channel += chunkFrames;
+
+        framesToWrite -= chunkFrames;
+        frames += chunkFrames;
+    }
+}
+
+void StreamingWaveFileWriter::writeSilence(quint64 silenceFrames)
+{
+    if (!file.isOpen())
+        return;
+
+    while (silenceFrames > 0) {
+        uint chunkFrames = static_cast<uint>(qMin(silenceFrames, static_cast<quint64>(WRITE_BUFFER_SIZE)));
+        char *dest = reserveBufferFrames(chunkFrames);
+        std::memset(dest, 0, chunkFrames * getBlockAlign()); // zero bits are 0.0f
+        silenceFrames -= chunkFrames;
+        frames += chunkFrames;
+    }
+}
+
+bool StreamingWaveFileWriter::flush()
+{
+    if (!file.isOpen())
+        return false;
+
+    if (!writeBuffer() || !writeHeader())
+        return false;
+
+    return file.flush();
+}
+
+bool StreamingWaveFileWriter::writeBuffer()
+{
+    if (buffer.isEmpty())
+        return true;
+
+    const qint64 written = file.write(buffer);
+    const bool success = written == buffer.size();
+    if (!success)
+        qCritical() << "Failed writing WAV file ..." << file.fileName() << file.errorString();
+
+    writtenFrames += qMax(written, qint64(0)) / getBlockAlign();
+    frames = writtenFrames;
+    buffer.resize(0);
+
+    return success;
+}
+
+bool StreamingWaveFileWriter::writeHeader()
+{
+    const quint64 dataSize = writtenFrames * getBlockAlign();
+    const quint64 riffSize = HEADER_SIZE - 8 + dataSize;
+    if (riffSize > maxRiffSize)
+        rf64 = true; // the file is never changed back to RIFF
+
+    char header[HEADER_SIZE] = {};
+    char *chunk = header;
+
+    putTag(chunk, rf64 ? "RF64" : "RIFF");
+    putUInt32(chunk + 4, rf64 ? 0xFFFFFFFF : static_cast<quint32>(riffSize));
+    putTag(chunk + 8, "WAVE");
+    chunk += 12;
+
+    putTag(chunk, rf64 ? "ds64" : "JUNK");
+    putUInt32(chunk + 4, DS64_CHUNK_SIZE);
+    if (rf64) {
+        putUInt64(chunk + 8, riffSize);
+        putUInt64(chunk + 16, dataSize);
+        putUInt64(chunk + 24, writtenFrames);
+        putUInt32(chunk + 32, 0); // no table
+    }
+    chunk += 8 + DS64_CHUNK_SIZE;
+
+    putTag(chunk, "fmt ");
+    putUInt32(chunk + 4, FMT_CHUNK_SIZE);
+    putUInt16(chunk + 8, 3); // IEEE float
+    putUInt16(chunk + 10, channels);
+    putUInt32(chunk + 12, sampleRate);
+    putUInt32(chunk + 16, sampleRate * getBlockAlign()); // bytes per second
+    putUInt16(chunk + 20, getBlockAlign());
+    putUInt16(chunk + 22, 32); // bits per sample
+    putUInt16(chunk + 24, 0); // cbSize, no extension
+    chunk += 8 + FMT_CHUNK_SIZE;
+
+    putTag(chunk, "fact");
+    putUInt32(chunk + 4, FACT_CHUNK_SIZE);
+    putUInt32(chunk + 8, rf64 ? 0xFFFFFFFF : static_cast<quint32>(writtenFrames)); // RF64 sample count is in ds64 chunk
+    chunk += 8 + FACT_CHUNK_SIZE;
+
+    putTag(chunk, "data");
+    putUInt32(chunk + 4, rf64 ? 0xFFFFFFFF : static_cast<quint32>(dataSize));
+
+    const qint64 endPosition = HEADER_SIZE + dataSize;
+    if (!file.seek(0) || file.write(header, HEADER_SIZE) != HEADER_SIZE || !file.seek(endPosition)) {
+        qCritical() << "Failed writing WAV header ..." << file.fileName() << file.errorString();
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,89 @@
+#ifndef STREAMING_WAVE_FILE_WRITER_H
+#define STREAMING_WAVE_FILE_WRITER_H
+
+#include <QFile>
+#include <QByteArray>
+
+namespace audio {
+
+class SamplesBuffer;
+
+/**
+    A 32 bits float WAV file growing while the samples are appended. The samples are interleaved
+    in a WRITE_BUFFER_SIZE buffer and written in large sequential writes, the header sizes are
+    updated in each flush(), so the file is valid (until the last flush) if the application crash.
+
+    A JUNK chunk is reserved after the RIFF header. When the data is bigger than 4GB the JUNK
+    chunk is replaced by a ds64 chunk and the file is promoted to RF64 (EBU Tech 3306).
+*/
+
+class StreamingWaveFileWriter
+{
+public:
+    explicit StreamingWaveFileWriter(quint64 maxRiffSize = MAX_RIFF_SIZE);
+    ~StreamingWaveFileWriter();
+
+    // 'framesToKeep' > 0 reopen an existing file and discard the frames after 'framesToKeep' (resuming a crashed session)
+    bool open(const QString &filePath, quint32 sampleRate, quint8 channels, quint64 framesToKeep = 0);
+    void close();
+
+    void write(const SamplesBuffer &samples, uint offset, uint frames); // mono buffers are written in all channels
+    void writeSilence(quint64 frames);
+
+    bool flush(); // write the buffered samples and update the header
+
+    bool isOpen() const;
+    bool isRf64() const;
+    quint64 getFrames() const; // written and buffered frames
+    QString getFilePath() const;
+
+    static const int HEADER_SIZE; // bytes before the samples
+    static const int WRITE_BUFFER_SIZE; // bytes
+    static const quint64 MAX_RIFF_SIZE; // bigger files are promoted to RF64
+
+private:
+    Q_DISABLE_COPY(StreamingWaveFileWriter)
+
+    QFile file;
+    QByteArray buffer;
+    quint32 sampleRate;
+    quint8 channels;
+    quint64 writtenFrames; // frames in file, the buffered frames are not included
+    quint64 frames;
+    bool rf64;
+    const quint64 maxRiffSize;
+
+    uint getBlockAlign() const;
+    char *reserveBufferFrames(uint &frames); // return the buffer position to write 'frames', 'frames' is reduced to the available space
+    bool writeBuffer();
+    bool writeHeader();
+};
+
+inline bool StreamingWaveFileWriter::isOpen() const
+{
+    return file.isOpen();
+}
+
+inline bool StreamingWaveFileWriter::isRf64() const
+{
+    return rf64;
+}
+
+inline quint64 StreamingWaveFileWriter::getFrames() const
+{
+    return frames;
+}
+
+inline QString StreamingWaveFileWriter::getFilePath() const
+{
+    return file.fileName();
+}
+
+inline uint StreamingWaveFileWriter::getBlockAlign() const
+{
+    return channels * sizeof(float);
+}
+
+} // namespace
+
+#endif // STREAMING_WAVE_FILE_WRITER_H
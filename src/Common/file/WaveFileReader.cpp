@@ -1,222 +1,333 @@
 #include "WaveFileReader.h"
+
+#include "audio/core/SamplesKernels.h"
+#include "audio/SamplesBufferResampler.h"
+
 #include <QDebug>
-#include <QFile>
-#include <QFileInfo>
-#include <cmath>
 #include <QtEndian>
-#include <QDataStream>
-#include <memory>
+#include <cstring>
+#include <limits>
 
 using audio::SamplesBuffer;
+using audio::SamplesKernels;
 using audio::WaveFileReader;
 
-class SampleExtractor
-{
+const uint WaveFileReader::BLOCK_SIZE = 4096;
 
-public:
-    explicit SampleExtractor(QDataStream *stream) :
-        stream(stream)
-    {
-    }
-    
-    virtual ~SampleExtractor()
-    {
-        
-    }
+namespace {
 
-    virtual float nextSample() = 0;
+const quint16 FORMAT_PCM = 1;
+const quint16 FORMAT_IEEE_FLOAT = 3;
+const quint16 FORMAT_EXTENSIBLE = 0xFFFE;
 
-protected:
-    QDataStream *stream;
-};
+const uint MAX_OUTPUTS = 2; // SamplesBuffer is mono or stereo
 
-class SampleExtractor16Bits : public SampleExtractor
+bool hasTag(const uchar *data, const char *tag)
 {
-    public:
+    return std::memcmp(data, tag, 4) == 0;
+}
 
-        explicit SampleExtractor16Bits(QDataStream *stream)
-            :SampleExtractor(stream)
-        {
+} // namespace
+
+WaveFileReader::WaveFileReader() :
+    fileData(nullptr),
+    fileSize(0),
+    dataOffset(0),
+    frames(0),
+    position(0),
+    sampleRate(0),
+    channels(0),
+    bitsPerSample(0),
+    floatSamples(false)
+{
 
-        }
+}
 
-        float nextSample() override
-        {
-            qint16 sampleValue;
-            *stream >> sampleValue;
-            return sampleValue / 32767.0f;
-        }
-};
+WaveFileReader::~WaveFileReader()
+{
+    close();
+}
 
-class SampleExtractor32Bits : public SampleExtractor
+bool WaveFileReader::open(const QString &filePath)
 {
-    public:
-        explicit SampleExtractor32Bits(QDataStream *stream)
-            :SampleExtractor(stream)
-        {
+    close();
 
-        }
+    file.setFileName(filePath);
+    if (!file.open(QFile::ReadOnly)) {
+        qCritical() << "Failed to open WAV file ..." << filePath;
+        return false;
+    }
 
-        float nextSample() override
-        {
-            char buffer[4];
-            stream->readRawData(buffer, 4);
+    fileSize = static_cast<quint64>(file.size());
+    fileData = fileSize > 0 ? file.map(0, file.size()) : nullptr;
+    if (!fileData) { // compressed resources, pipes, ...
+        fileContent = file.readAll();
+        fileData = reinterpret_cast<const uchar *>(fileContent.constData());
+        fileSize = static_cast<quint64>(fileContent.size());
+    }
 
-            float sample = 0;
-            memcpy(&sample, &buffer, sizeof(sample));
-            return sample;
-        }
-};
+    if (!parseHeader()) {
+        close();
+        return false;
+    }
 
-class SampleExtractor24Bits : public SampleExtractor
-{
-    public:
-        explicit SampleExtractor24Bits(QDataStream *stream)
-            :SampleExtractor(stream)
-        {
+    position = 0;
 
-        }
+    return true;
+}
 
-        float nextSample() override
-        {
-            char buffer[3];
-            stream->readRawData(buffer, 3);
-            return ((buffer[0] & 0xFF) | ((buffer[1] & 0xFF) << 8) | (buffer[2] << 16)) / 8388606.0F;
-        }
-};
+void WaveFileReader::close()
+{
+    if (fileData && fileContent.isEmpty())
+        file.unmap(const_cast<uchar *>(fileData));
+
+    file.close();
+    fileContent.clear();
+    fileData = nullptr;
+    fileSize = 0;
+    frames = 0;
+    position = 0;
+}
 
-class SampleExtractor8Bits : public SampleExtractor
+bool WaveFileReader::parseHeader()
 {
-    public:
-        explicit SampleExtractor8Bits(QDataStream *stream)
-            :SampleExtractor(stream)
-        {
+    const QString filePath = file.fileName();
 
-        }
+    if (fileSize < 12 || !(hasTag(fileData, "RIFF") || hasTag(fileData, "RF64"))) {
+        qCritical() << "Error loading " << filePath << ", 'RIFF' chunk not founded!";
+        return false;
+    }
 
-        float nextSample() override
-        {
-            qint8 byte;
-            *stream >> byte;
-            return byte / 127.0;
+    if (!hasTag(fileData + 8, "WAVE")) {
+        qCritical() << "Error loading " << filePath << ", 'WAVE' chunk not founded!";
+        return false;
+    }
+
+    const bool rf64 = hasTag(fileData, "RF64");
+    quint64 ds64DataSize = 0;
+    quint16 formatTag = 0;
+    bool fmtFound = false;
+
+    quint64 chunkPosition = 12;
+    while (chunkPosition + 8 <= fileSize) {
+        const uchar *chunk = fileData + chunkPosition;
+        const quint32 chunkSize = qFromLittleEndian<quint32>(chunk + 4);
+        const quint64 chunkDataPosition = chunkPosition + 8;
+        const quint64 availableBytes = fileSize - chunkDataPosition;
+
+        if (hasTag(chunk, "ds64") && chunkSize >= 24 && availableBytes >= 24) {
+            ds64DataSize = qFromLittleEndian<quint64>(chunk + 16); // after the RIFF size
+        }
+        else if (hasTag(chunk, "fmt ") && chunkSize >= 16 && availableBytes >= 16) {
+            formatTag = qFromLittleEndian<quint16>(chunk + 8);
+            channels = qFromLittleEndian<quint16>(chunk + 10);
+            sampleRate = qFromLittleEndian<quint32>(chunk + 12);
+            bitsPerSample = qFromLittleEndian<quint16>(chunk + 22);
+            if (formatTag == FORMAT_EXTENSIBLE && chunkSize >= 40 && availableBytes >= 40)
+                formatTag = qFromLittleEndian<quint16>(chunk + 32); // the first bytes of the subformat GUID
+            fmtFound = true;
         }
-};
+        else if (hasTag(chunk, "data")) {
+            if (!fmtFound) {
+                qCritical() << "Error loading " << filePath << ", 'fmt' chunk not founded!";
+                return false;
+            }
+
+            floatSamples = formatTag == FORMAT_IEEE_FLOAT;
+            const bool supportedPcm = formatTag == FORMAT_PCM && (bitsPerSample == 8 || bitsPerSample == 16 || bitsPerSample == 24 || bitsPerSample == 32);
+            const bool supportedFloat = floatSamples && bitsPerSample == 32;
+            if (!(supportedPcm || supportedFloat) || channels == 0 || sampleRate == 0) {
+                qCritical() << "Error loading " << filePath << ", unsupported format " << formatTag << bitsPerSample << " bits, " << channels << " channels";
+                return false;
+            }
+
+            quint64 dataSize = chunkSize;
+            if (rf64 && chunkSize == 0xFFFFFFFF)
+                dataSize = ds64DataSize;
+
+            dataOffset = chunkDataPosition;
+            dataSize = qMin(dataSize, availableBytes); // files not finished (crash while recording) are loaded until the last sample
+            frames = dataSize / getBlockAlign();
+
+            return true;
+        }
+
+        chunkPosition = chunkDataPosition + chunkSize + (chunkSize & 1); // chunks are word aligned
+    }
 
-class NullSampleExtractor : public SampleExtractor
+    qCritical() << "Error loading " << filePath << ", 'data' chunk not founded!";
+    return false;
+}
+
+bool WaveFileReader::seek(quint64 frame)
 {
-    public:
-        NullSampleExtractor()
-            :SampleExtractor(nullptr)
-        {
-        }
+    if (!isOpen() || frame > frames)
+        return false;
 
-        float nextSample() override
-        {
-            return 0.0;
-        }
-};
+    position = frame;
+    return true;
+}
 
-class SampleExtractorFactory
+uint WaveFileReader::readFrames(SamplesBuffer &outBuffer, uint outOffset, uint framesToRead)
 {
-public:
-    static std::unique_ptr<SampleExtractor> createExtractor(QDataStream *stream, quint8 bitsPerSample)
-    {
-        switch (bitsPerSample/8) {
-            case 1: return std::unique_ptr<SampleExtractor8Bits>(new SampleExtractor8Bits(stream));
-            case 2: return std::unique_ptr<SampleExtractor16Bits>(new SampleExtractor16Bits(stream));
-            case 3: return std::unique_ptr<SampleExtractor24Bits>(new SampleExtractor24Bits(stream));
-            case 4: return std::unique_ptr<SampleExtractor32Bits>(new SampleExtractor32Bits(stream));
-        }
-        qCritical() << "Can't create a SampleExtractor to handle " << bitsPerSample << " bits per sample!";
-        return std::unique_ptr<NullSampleExtractor>(new NullSampleExtractor());
+    if (!isOpen() || outOffset >= outBuffer.getFrameLenght())
+        return 0;
+
+    framesToRead = static_cast<uint>(qMin(static_cast<quint64>(framesToRead), frames - position));
+    framesToRead = qMin(framesToRead, outBuffer.getFrameLenght() - outOffset);
+    if (!framesToRead)
+        return 0;
+
+    const uint outChannels = static_cast<uint>(outBuffer.getChannels());
+    const uint outputsCount = qMin(qMin(static_cast<uint>(channels), outChannels), MAX_OUTPUTS);
+
+    float *outputs[MAX_OUTPUTS];
+    for (uint c = 0; c < outputsCount; ++c)
+        outputs[c] = outBuffer.getSamplesArray(c) + outOffset;
+
+    convert(fileData + dataOffset + position * getBlockAlign(), outputs, outputsCount, framesToRead);
+
+    for (uint c = outputsCount; c < outChannels; ++c) {
+        float *channel = outBuffer.getSamplesArray(c) + outOffset;
+        if (channels == 1)
+            std::memcpy(channel, outputs[0], framesToRead * sizeof(float)); // mono file in stereo buffer
+        else
+            std::memset(channel, 0, framesToRead * sizeof(float));
     }
-};
 
-bool WaveFileReader::read(const QString &filePath, audio::SamplesBuffer &outBuffer, quint32 &sampleRate)
+    position += framesToRead;
+
+    return framesToRead;
+}
+
+void WaveFileReader::convert(const uchar *input, float * const *outputs, uint outputsCount, uint framesToConvert)
 {
-    // Open the wave file
-    QFile wavFile(filePath);
-    if (!wavFile.open(QFile::ReadOnly)) {
-        qCritical() << "Failed to open WAV file ..." << filePath;
-        return false; // Done, out buffer is not changed
-    }
+    const auto &kernels = SamplesKernels::get();
 
-    // Read in the whole thing
-    QByteArray wavFileContent = wavFile.readAll();
-
-    // Define the header components
-    char fileType[4];
-    quint32 fileSize;
-    char waveName[4];
-    char fmtName[4];
-    quint32 fmtLength;
-    quint16 fmtType;
-    quint16 channels;
-    quint32 sampleRateXBitsPerSampleXChanngelsDivEight;
-    quint16 bitsPerSampleXChannelsDivEightPointOne;
-    quint16 bitsPerSample;
-    char dataHeader[4];
-    quint32 dataSize = 0;
-
-    // Create a data stream to analyze the data
-    QDataStream stream(&wavFileContent, QIODevice::ReadOnly);
-    stream.setByteOrder(QDataStream::LittleEndian);
-
-    // Now pop off the appropriate data into each header field defined above
-    stream.readRawData((char *)fileType, 4); // "RIFF"
-    if (QString::fromLocal8Bit(fileType, 4) != "RIFF") {
-        qCritical() << "Error loading " << filePath << ", 'RIFF' chunk not founded!";
-        return false;
+    if (floatSamples) {
+        kernels.deinterleave(input, channels, outputs, outputsCount, framesToConvert);
+        return;
     }
 
-    stream >> fileSize; // File Size
-
-    stream.readRawData((char *)waveName, 4); // "WAVE"
-    if (QString::fromLocal8Bit(waveName, 4) != "WAVE") {
-        qCritical() << "Error loading " << filePath << ", 'WAVE' chunk not founded!";
-        return false;
+    if (bitsPerSample == 16) {
+        kernels.int16ToFloat(input, channels, outputs, outputsCount, framesToConvert);
+        return;
     }
 
-    stream.readRawData((char *)fmtName, 4); // "fmt"
-    if (QString::fromLocal8Bit(fmtName, 4) != "fmt ") {
-        qCritical() << "Error loading " << filePath << ", 'fmt' chunk not founded!";
-        return false;
+    if (bitsPerSample == 32) {
+        kernels.int32ToFloat(input, channels, outputs, outputsCount, framesToConvert);
+        return;
     }
 
-    stream >> fmtLength;  // Format length
-    stream >> fmtType;    // Format type
-    stream >> channels;   // Number of channels
-    stream >> sampleRate; // Sample rate
-    stream >> sampleRateXBitsPerSampleXChanngelsDivEight; // (Sample Rate * BitsPerSample * Channels) / 8
-    stream >> bitsPerSampleXChannelsDivEightPointOne; // (BitsPerSample * Channels) / 8.1
-    stream >> bitsPerSample; // Bits per sample
-    while (QString::fromLocal8Bit(dataHeader, 4) != "data" && !stream.atEnd()) {
-        stream.readRawData((char *)dataHeader, 4); // "data" header
-        stream >> dataSize; // Data Size
-        if (QString::fromLocal8Bit(dataHeader, 4) != "data")
-            stream.skipRawData(dataSize);
+    // 8 and 24 bits are expanded to 32 bits (in blocks) and converted by int32ToFloat
+    const uint bytesPerSample = bitsPerSample / 8;
+    expandedSamples.resize(BLOCK_SIZE * channels);
+
+    for (uint convertedFrames = 0; convertedFrames < framesToConvert;) {
+        const uint blockFrames = qMin(BLOCK_SIZE, framesToConvert - convertedFrames);
+        const uint blockSamples = blockFrames * channels;
+        const uchar *blockInput = input + static_cast<quint64>(convertedFrames) * channels * bytesPerSample;
+        qint32 *expanded = expandedSamples.data();
+
+        if (bytesPerSample == 3) {
+            for (uint s = 0; s < blockSamples; ++s, blockInput += 3)
+                expanded[s] = static_cast<qint32>((blockInput[0] << 8) | (blockInput[1] << 16) | (static_cast<quint32>(blockInput[2]) << 24));
+        }
+        else {
+            for (uint s = 0; s < blockSamples; ++s)
+                expanded[s] = (blockInput[s] - 128) * (1 << 24); // 8 bits samples are unsigned
+        }
+
+        float *blockOutputs[MAX_OUTPUTS];
+        for (uint c = 0; c < outputsCount; ++c)
+            blockOutputs[c] = outputs[c] + convertedFrames;
+
+        kernels.int32ToFloat(expanded, channels, blockOutputs, outputsCount, blockFrames);
+
+        convertedFrames += blockFrames;
     }
+}
+
+bool WaveFileReader::read(const QString &filePath, SamplesBuffer &outBuffer, quint32 &sampleRate)
+{
+    if (!open(filePath))
+        return false; // out buffer is not changed
 
-    uint samples = dataSize / channels / (bitsPerSample/ 8);
+    sampleRate = this->sampleRate;
 
     if (channels == 1)
         outBuffer.setToMono();
     else
         outBuffer.setToStereo();
 
+    uint framesToRead = static_cast<uint>(qMin(frames, static_cast<quint64>(std::numeric_limits<uint>::max())));
     if (outBuffer.getFrameLenght() > 0) // load only outBuffer.frameLenght samples?
-        samples = qMin(samples, outBuffer.getFrameLenght());
+        framesToRead = qMin(framesToRead, outBuffer.getFrameLenght());
 
-    outBuffer.setFrameLenght(samples);
+    outBuffer.setFrameLenght(framesToRead);
+    readFrames(outBuffer, 0, framesToRead);
 
-    // Now pull out the data
-    std::unique_ptr<SampleExtractor> sampleExtractor = SampleExtractorFactory::createExtractor(&stream, bitsPerSample);
-    for (uint s = 0; s < samples; ++s) {
-        for (int c = 0; c < channels; ++c) {
-            float sample = sampleExtractor->nextSample();
-            outBuffer.set(c, s, sample);
-        }
+    close();
+
+    return true;
+}
+
+bool WaveFileReader::readResampled(const QString &filePath, SamplesBuffer &outBuffer, quint32 targetSampleRate)
+{
+    if (!open(filePath))
+        return false;
+
+    if (channels == 1)
+        outBuffer.setToMono();
+    else
+        outBuffer.setToStereo();
+
+    quint64 outFrames = frames;
+    if (sampleRate != targetSampleRate)
+        outFrames = frames * targetSampleRate / sampleRate; // same lenght used in SamplesBufferResampler::resample()
+
+    if (outBuffer.getFrameLenght() > 0)
+        outFrames = qMin(outFrames, static_cast<quint64>(outBuffer.getFrameLenght()));
+
+    outFrames = qMin(outFrames, static_cast<quint64>(std::numeric_limits<uint>::max()));
+    outBuffer.setFrameLenght(static_cast<uint>(outFrames));
+
+    if (sampleRate == targetSampleRate) {
+        readFrames(outBuffer, 0, static_cast<uint>(outFrames));
+        close();
+        return true;
+    }
+
+    SamplesBufferResampler resampler(ResamplerQuality::Best);
+    resampler.setSampleRates(sampleRate, targetSampleRate);
+
+    SamplesBuffer block(outBuffer.getChannels(), BLOCK_SIZE);
+    const uint outChannels = static_cast<uint>(outBuffer.getChannels());
+    uint producedFrames = 0;
+    while (producedFrames < outFrames) {
+        const uint blockOutFrames = qMin(BLOCK_SIZE, static_cast<uint>(outFrames) - producedFrames);
+        const uint blockInFrames = static_cast<uint>(resampler.getRequiredInputFrames(static_cast<int>(blockOutFrames)));
+
+        block.setFrameLenght(blockInFrames);
+        const uint readedFrames = readFrames(block, 0, blockInFrames);
+        for (uint c = 0; c < outChannels && readedFrames < blockInFrames; ++c) // the last output frames are using the filter look-ahead, the input is finished with silence
+            std::memset(block.getSamplesArray(c) + readedFrames, 0, (blockInFrames - readedFrames) * sizeof(float));
+
+        const auto &resampled = resampler.resample(block, static_cast<int>(blockOutFrames));
+        const uint resampledFrames = qMin(resampled.getFrameLenght(), blockOutFrames);
+        if (!resampledFrames)
+            break;
+
+        for (uint c = 0; c < outChannels; ++c)
+            std::memcpy(outBuffer.getSamplesArray(c) + producedFrames, resampled.getSamplesArray(c), resampledFrames * sizeof(float));
+
+        producedFrames += resampledFrames;
     }
 
+    for (uint c = 0; c < outChannels && producedFrames < outFrames; ++c)
+        std::memset(outBuffer.getSamplesArray(c) + producedFrames, 0, (outFrames - producedFrames) * sizeof(float));
+
+    close();
+
     return true;
 }
@@ -3,16 +3,118 @@
 
 #include "FileReader.h"
 
+#include <QFile>
+#include <QByteArray>
+#include <vector>
+
 namespace audio {
 
+/**
+    The file is memory mapped (or loaded in memory when mapping is not possible, e.g. compressed
+    resources) and the samples are converted straight from the file data to the SamplesBuffer
+    channels with the SamplesKernels conversion functions.
+
+    Supported formats: RIFF and RF64, PCM 8, 16, 24 and 32 bits, IEEE float 32 bits and
+    WAVE_FORMAT_EXTENSIBLE with PCM or float subformat. The integer samples are scaled by
+    1/2^(bits - 1), so -1.0 is the minimum value.
+
+    Besides the FileReader::read() the file can be read in blocks (open(), readFrames(), seek()),
+    and readResampled() load the file resampling one block at time, without a second copy of the
+    whole file in the original sample rate.
+*/
+
 class WaveFileReader : public FileReader
 {
 
 public:
+    WaveFileReader();
+    ~WaveFileReader();
+
     bool read(const QString &filePath, audio::SamplesBuffer &outBuffer, quint32 &sampleRate) override;
 
+    // outBuffer lenght > 0 is the max lenght (in output sample rate), as in read()
+    bool readResampled(const QString &filePath, audio::SamplesBuffer &outBuffer, quint32 targetSampleRate);
+
+    bool open(const QString &filePath);
+    void close();
+    bool isOpen() const;
+
+    // return the number of read frames, less than 'framesToRead' in the end of file. A mono file is copied in all outBuffer channels.
+    uint readFrames(audio::SamplesBuffer &outBuffer, uint outOffset, uint framesToRead);
+    bool seek(quint64 frame);
+
+    quint64 getFrames() const;
+    quint64 getPosition() const;
+    quint32 getSampleRate() const;
+    quint16 getChannels() const;
+    quint16 getBitsPerSample() const;
+    bool isFloat() const;
+
+    static const uint BLOCK_SIZE; // frames converted in each step
+
+private:
+    Q_DISABLE_COPY(WaveFileReader)
+
+    bool parseHeader();
+    void convert(const uchar *input, float * const *outputs, uint outputsCount, uint framesToConvert);
+    quint32 getBlockAlign() const;
+
+    QFile file;
+    QByteArray fileContent; // used when the file can't be mapped
+    const uchar *fileData;
+    quint64 fileSize;
+
+    quint64 dataOffset;
+    quint64 frames;
+    quint64 position;
+    quint32 sampleRate;
+    quint16 channels;
+    quint16 bitsPerSample;
+    bool floatSamples;
+
+    std::vector<qint32> expandedSamples; // 8 and 24 bits samples are expanded to 32 bits before the conversion
 };
 
+inline bool WaveFileReader::isOpen() const
+{
+    return fileData != nullptr;
+}
+
+inline quint64 WaveFileReader::getFrames() const
+{
+    return frames;
+}
+
+inline quint64 WaveFileReader::getPosition() const
+{
+    return position;
+}
+
+inline quint32 WaveFileReader::getSampleRate() const
+{
+    return sampleRate;
+}
+
+inline quint16 WaveFileReader::getChannels() const
+{
+    return channels;
+}
+
+inline quint16 WaveFileReader::getBitsPerSample() const
+{
+    return bitsPerSample;
+}
+
+inline bool WaveFileReader::isFloat() const
+{
+    return floatSamples;
+}
+
+inline quint32 WaveFileReader::getBlockAlign() const
+{
+    return static_cast<quint32>(channels) * (bitsPerSample / 8);
+}
+
 } // namespace
 
 #endif // AUDIOFILEREADER_H
@@ -1,70 +1,257 @@
 #include "WaveFileWriter.h"
 
-#include <QFile>
+#include "audio/core/SamplesKernels.h"
+
 #include <QDebug>
-#include <QDataStream>
-#include <QThread>
-#include <climits>
+#include <QtEndian>
+#include <cstring>
 
 using audio::WaveFileWriter;
 using audio::SamplesBuffer;
+using audio::SamplesKernels;
+
+const int WaveFileWriter::HEADER_SIZE = 44;
+const int WaveFileWriter::STAGING_BUFFER_SIZE = 1024 * 1024;
+const quint64 WaveFileWriter::MAX_DATA_SIZE = 0xFFFFFFFF - (HEADER_SIZE - 8);
+
+namespace {
 
-void WaveFileWriter::write(const QString &filePath, const SamplesBuffer &buffer, quint32 sampleRate, quint8 bitDepth)
+const uint EXPANSION_BLOCK_SIZE = 4096; // frames
+
+void putTag(char *dest, const char *tag)
 {
-    QFile wavFile(filePath);
-    if (!wavFile.open(QFile::WriteOnly)) {
-        qCritical() << "Failed to create WAV file ..." << filePath;
-        return;
+    std::memcpy(dest, tag, 4);
+}
+
+void putUInt16(char *dest, quint16 value)
+{
+    qToLittleEndian(value, reinterpret_cast<uchar *>(dest));
+}
+
+void putUInt32(char *dest, quint32 value)
+{
+    qToLittleEndian(value, reinterpret_cast<uchar *>(dest));
+}
+
+} // namespace
+
+WaveFileWriter::WaveFileWriter() :
+    sampleRate(44100),
+    channels(2),
+    format(SampleFormat::Int16),
+    frames(0),
+    writtenFrames(0)
+{
+
+}
+
+WaveFileWriter::~WaveFileWriter()
+{
+    finalize();
+}
+
+WaveFileWriter::SampleFormat WaveFileWriter::getSampleFormat(quint8 bitDepth)
+{
+    switch (bitDepth) {
+    case 24: return SampleFormat::Int24;
+    case 32: return SampleFormat::Float32;
+    default: return SampleFormat::Int16;
+    }
+}
+
+quint8 WaveFileWriter::getBitsPerSample(SampleFormat format)
+{
+    switch (format) {
+    case SampleFormat::Int16: return 16;
+    case SampleFormat::Int24: return 24;
+    case SampleFormat::Int32: return 32;
+    case SampleFormat::Float32: return 32;
     }
 
-    const uint samples = buffer.getFrameLenght();
-    const uint dataChunkSize = buffer.getChannels() * buffer.getFrameLenght() * bitDepth/8;// bytes per sample
-    const uint fileSize = dataChunkSize + 44; // WAVE HEADER is 44 bytes
-
-    QDataStream out(&wavFile);
-    out.setByteOrder(QDataStream::LittleEndian);
-
-    // RIFF chunk
-    out.writeRawData("RIFF", 4);
-    out << quint32(fileSize - 8); // Placeholder for the RIFF chunk size (filled by close())
-    out.writeRawData("WAVE", 4);
-
-    const quint8 sampleSize = bitDepth;
-    // Format description chunk
-    out.writeRawData("fmt ", 4);
-    out << quint32(16); // "fmt " chunk size (always 16 for PCM)
-    out << quint16(bitDepth == 16 ? 1 : 3); // data format (1 => PCM, 3 => IEEE float) http://www-mmsp.ece.mcgill.ca/Documents/AudioFormats/WAVE/WAVE.html
-    out << quint16(buffer.getChannels());
-    out << quint32(sampleRate);
-    out << quint32(sampleRate * buffer.getChannels() * sampleSize / 8 ); // bytes per second
-    out << quint16(buffer.getChannels() * sampleSize / 8); // Block align
-    out << quint16(sampleSize); // Significant Bits Per Sample
-
-    // Data chunk
-    out.writeRawData("data", 4);
-    out << quint32(dataChunkSize); // Placeholder for the data chunk size (filled by close())
-
-    //write interleaved samples
-    if (bitDepth == 32)
-        out.setFloatingPointPrecision(QDataStream::SinglePrecision);
-
-    uint channels = buffer.getChannels();
-    for (uint s = 0; s < samples; ++s) {
-        for (uint c = 0; c < channels; ++c) {
-            if (bitDepth == 16) {
-                int sample = buffer.get(c, s) * SHRT_MAX;
-                // hard clip
-                if (sample > SHRT_MAX)
-                    sample = SHRT_MAX;
-                else if (sample < SHRT_MIN)
-                    sample = SHRT_MIN;
-
-                out << quint16(sample);
-            }
-            else { // 32 bits
-                out << buffer.get(c, s);
+    return 16;
+}
+
+bool WaveFileWriter::write(const QString &filePath, const SamplesBuffer &buffer, quint32 sampleRate, quint8 bitDepth)
+{
+    if (!open(filePath, sampleRate, static_cast<quint8>(buffer.getChannels()), getSampleFormat(bitDepth)))
+        return false;
+
+    const bool appended = append(buffer, 0, buffer.getFrameLenght());
+
+    return finalize() && appended;
+}
+
+bool WaveFileWriter::open(const QString &filePath, quint32 sampleRate, quint8 channels, SampleFormat format)
+{
+    finalize();
+
+    this->sampleRate = sampleRate;
+    this->channels = qMax(channels, static_cast<quint8>(1));
+    this->format = format;
+    frames = 0;
+    writtenFrames = 0;
+
+    file.setFileName(filePath);
+    if (!file.open(QFile::WriteOnly | QFile::Truncate | QFile::Unbuffered)) { // using the staging buffer
+        qCritical() << "Failed to create WAV file ..." << filePath << file.errorString();
+        return false;
+    }
+
+    stagingBuffer.reserve(STAGING_BUFFER_SIZE);
+    stagingBuffer.resize(0);
+    inputs.resize(this->channels);
+
+    if (!writeHeader()) { // the sizes are patched in flush() and finalize()
+        file.close();
+        return false;
+    }
+
+    return true;
+}
+
+bool WaveFileWriter::append(const SamplesBuffer &buffer, uint offset, uint framesToAppend)
+{
+    if (!isOpen())
+        return false;
+
+    if (offset >= buffer.getFrameLenght())
+        return true;
+
+    framesToAppend = qMin(framesToAppend, buffer.getFrameLenght() - offset);
+
+    const quint32 blockAlign = getBlockAlign();
+    if ((frames + framesToAppend) * blockAlign > MAX_DATA_SIZE) {
+        qCritical() << "WAV file is too big, can't append more samples in " << file.fileName();
+        return false;
+    }
+
+    const int bufferChannels = buffer.getChannels();
+    for (uint c = 0; c < channels; ++c)
+        inputs[c] = buffer.getSamplesArray(buffer.isMono() ? 0 : qMin(static_cast<int>(c), bufferChannels - 1)) + offset;
+
+    while (framesToAppend > 0) {
+        uint blockFrames = (STAGING_BUFFER_SIZE - stagingBuffer.size()) / blockAlign;
+        if (!blockFrames) {
+            if (!writeStagingBuffer())
+                return false;
+
+            blockFrames = STAGING_BUFFER_SIZE / blockAlign;
+        }
+
+        blockFrames = qMin(blockFrames, framesToAppend);
+
+        const int position = stagingBuffer.size();
+        stagingBuffer.resize(position + static_cast<int>(blockFrames * blockAlign)); // not reallocating, the capacity is STAGING_BUFFER_SIZE
+        convert(stagingBuffer.data() + position, blockFrames);
+
+        framesToAppend -= blockFrames;
+        frames += blockFrames;
+    }
+
+    return true;
+}
+
+void WaveFileWriter::convert(char *dest, uint framesToConvert)
+{
+    const auto &kernels = SamplesKernels::get();
+
+    if (format == SampleFormat::Int24) { // converted to 32 bits in blocks, the 3 high bytes are packed (rounding the discarded byte)
+        expandedSamples.resize(EXPANSION_BLOCK_SIZE * channels);
+        for (uint convertedFrames = 0; convertedFrames < framesToConvert;) {
+            const uint blockFrames = qMin(EXPANSION_BLOCK_SIZE, framesToConvert - convertedFrames);
+            kernels.floatToInt32(inputs.data(), channels, expandedSamples.data(), blockFrames);
+
+            const uint blockSamples = blockFrames * channels;
+            for (uint s = 0; s < blockSamples; ++s, dest += 3) {
+                const qint64 value = qMin((static_cast<qint64>(expandedSamples[s]) + 128) >> 8, static_cast<qint64>(0x7FFFFF));
+                dest[0] = static_cast<char>(value & 0xFF);
+                dest[1] = static_cast<char>((value >> 8) & 0xFF);
+                dest[2] = static_cast<char>((value >> 16) & 0xFF);
             }
+
+            for (auto &input : inputs)
+                input += blockFrames;
+
+            convertedFrames += blockFrames;
         }
+        return;
+    }
+
+    if (format == SampleFormat::Int16)
+        kernels.floatToInt16(inputs.data(), channels, dest, framesToConvert);
+    else if (format == SampleFormat::Int32)
+        kernels.floatToInt32(inputs.data(), channels, dest, framesToConvert);
+    else
+        kernels.interleave(inputs.data(), channels, dest, framesToConvert);
+
+    for (auto &input : inputs)
+        input += framesToConvert;
+}
+
+bool WaveFileWriter::flush()
+{
+    if (!isOpen())
+        return false;
+
+    return writeStagingBuffer() && writeHeader();
+}
+
+bool WaveFileWriter::finalize()
+{
+    if (!isOpen())
+        return false;
+
+    const bool success = flush();
+    file.close();
+
+    return success;
+}
+
+bool WaveFileWriter::writeStagingBuffer()
+{
+    if (stagingBuffer.isEmpty())
+        return true;
+
+    const qint64 written = file.write(stagingBuffer);
+    const bool success = written == stagingBuffer.size();
+    if (!success)
+        qCritical() << "Failed writing WAV file ..." << file.fileName() << file.errorString();
+
+    writtenFrames += qMax(written, qint64(0)) / getBlockAlign();
+    frames = writtenFrames;
+    stagingBuffer.resize(0);
+
+    return success;
+}
+
+bool WaveFileWriter::writeHeader()
+{
+    const quint32 dataSize = static_cast<quint32>(writtenFrames * getBlockAlign());
+    const quint16 bitsPerSample = getBitsPerSample(format);
+
+    char header[HEADER_SIZE];
+
+    putTag(header, "RIFF");
+    putUInt32(header + 4, HEADER_SIZE - 8 + dataSize);
+    putTag(header + 8, "WAVE");
+
+    putTag(header + 12, "fmt ");
+    putUInt32(header + 16, 16); // "fmt " chunk size (always 16 for PCM)
+    putUInt16(header + 20, format == SampleFormat::Float32 ? 3 : 1); // data format (1 => PCM, 3 => IEEE float) http://www-mmsp.ece.mcgill.ca/Documents/AudioFormats/WAVE/WAVE.html
+    putUInt16(header + 22, channels);
+    putUInt32(header + 24, sampleRate);
+    putUInt32(header + 28, sampleRate * getBlockAlign()); // bytes per second
+    putUInt16(header + 32, static_cast<quint16>(getBlockAlign()));
+    putUInt16(header + 34, bitsPerSample);
+
+    putTag(header + 36, "data");
+    putUInt32(header + 40, dataSize);
+
+    const qint64 endPosition = HEADER_SIZE + static_cast<qint64>(dataSize);
+    if (!file.seek(0) || file.write(header, HEADER_SIZE) != HEADER_SIZE || !file.seek(endPosition)) {
+        qCritical() << "Failed writing WAV header ..." << file.fileName() << file.errorString();
+        return false;
     }
 
+    return true;
 }
@@ -3,16 +3,90 @@
 
 #include "FileReader.h"
 
+#include <QFile>
+#include <QByteArray>
+#include <vector>
+
 namespace audio {
 
+/**
+    The samples are converted and interleaved with the SamplesKernels functions in a
+    STAGING_BUFFER_SIZE buffer, the file receives a few big writes instead of one write per sample.
+
+    write() save an entire buffer (looper layers). The streaming mode (open(), append(), finalize())
+    is used to write long recordings incrementally, the RIFF and data sizes are patched in flush() and
+    finalize(), so the file is valid after every flush. The file is limited to MAX_DATA_SIZE,
+    StreamingWaveFileWriter is writing RF64 files when the 4GB limit is not enough.
+*/
+
 class WaveFileWriter
 {
 
 public:
-    void write(const QString &filePath, const SamplesBuffer &buffer, quint32 sampleRate, quint8 bitDepth);
+    enum class SampleFormat
+    {
+        Int16,
+        Int24,
+        Int32,
+        Float32
+    };
+
+    WaveFileWriter();
+    ~WaveFileWriter(); // finalize() is called
+
+    // 32 bits are float samples, as in previous versions
+    bool write(const QString &filePath, const SamplesBuffer &buffer, quint32 sampleRate, quint8 bitDepth);
+
+    bool open(const QString &filePath, quint32 sampleRate, quint8 channels, SampleFormat format);
+    bool append(const SamplesBuffer &buffer, uint offset, uint framesToAppend); // mono buffers are copied in all file channels
+    bool flush(); // write the staged samples and update the header
+    bool finalize(); // flush and close the file
+
+    bool isOpen() const;
+    quint64 getFrames() const; // appended frames, including the frames not flushed
+
+    static SampleFormat getSampleFormat(quint8 bitDepth);
+    static quint8 getBitsPerSample(SampleFormat format);
+
+    static const int HEADER_SIZE;
+    static const int STAGING_BUFFER_SIZE; // bytes
+    static const quint64 MAX_DATA_SIZE; // bytes, RIFF sizes are 32 bits
 
+private:
+    Q_DISABLE_COPY(WaveFileWriter)
+
+    bool writeStagingBuffer();
+    bool writeHeader();
+    void convert(char *dest, uint framesToConvert); // convert from 'inputs' and advance them
+    quint32 getBlockAlign() const;
+
+    QFile file;
+    QByteArray stagingBuffer;
+    std::vector<qint32> expandedSamples; // 24 bits samples are converted to 32 bits before packing
+    std::vector<const float *> inputs; // one pointer for each file channel, advanced in every converted block
+
+    quint32 sampleRate;
+    quint8 channels;
+    SampleFormat format;
+    quint64 frames;
+    quint64 writtenFrames;
 };
 
+inline bool WaveFileWriter::isOpen() const
+{
+    return file.isOpen();
+}
+
+inline quint64 WaveFileWriter::getFrames() const
+{
+    return frames;
+}
+
+inline quint32 WaveFileWriter::getBlockAlign() const
+{
+    return static_cast<quint32>(channels) * (getBitsPerSample(format) / 8);
+}
+
 } // namespace
 
 #endif // WAVEFILEWHITER_H
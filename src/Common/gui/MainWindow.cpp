@@ -2465,6 +2465,14 @@ void MainWindow::openPreferencesDialog(QAction *action)
         qDebug(jtGUI) << "Initializing preferences dialog";
         dialog->initialize(initialTab, &mainController->getSettings(), mainController->getJamRecoders());// initializing here to avoid call virtual methods inside PreferencesDialog constructor
 
+        // the recorder disk writes counters are refreshed while the dialog is open
+        dialog->setRecordingIOMetrics(mainController->getRecorderIOMetrics());
+        auto recordingIOTimer = new QTimer(dialog);
+        connect(recordingIOTimer, &QTimer::timeout, dialog, [=]() {
+            dialog->setRecordingIOMetrics(mainController->getRecorderIOMetrics());
+        });
+        recordingIOTimer->start(1000);
+
         qCDebug(jtGUI) << "Showing preferences dialog";
         dialog->show();
         dialog->exec();
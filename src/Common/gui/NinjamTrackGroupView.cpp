@@ -1,7 +1,7 @@
 #include "NinjamTrackGroupView.h"
 #include "MainController.h"
 #include "NinjamController.h"
-#include "video/FFMpegDemuxer.h"
+#include "video/VideoFramesPool.h"
 #include "IconFactory.h"
 #include "ninjam/client/Service.h"
 #include "MainWindow.h"
@@ -10,7 +10,6 @@
 #include <QDateTime>
 #include <QLayout>
 #include <QStackedLayout>
-#include <QtConcurrent>
 
 const uint NinjamTrackGroupView::MAX_WIDTH_IN_GRID_LAYOUT = 350;
 const uint NinjamTrackGroupView::MAX_HEIGHT_IN_GRID_LAYOUT = 210;
@@ -26,7 +25,6 @@ NinjamTrackGroupView::NinjamTrackGroupView(MainController *mainController, long
     mainController(mainController),
     userIP(initialValues.getUserIP()),
     tracksLayoutEnum(TracksLayout::VerticalLayout),
-    videoFrameRate(10),
     intervalsWithoutReceiveVideo(0)
 {
 
@@ -136,28 +134,12 @@ void NinjamTrackGroupView::addVideoInterval(const QByteArray &encodedVideoData)
         }
     }
 
-    FFMpegDemuxer *videoDecoder = new FFMpegDemuxer(this, encodedVideoData);
-    connect(videoDecoder, &FFMpegDemuxer::imagesDecoded, this, [=](QList<QImage> images, uint frameRate){
-        if (!images.isEmpty()) {
-            videoFrameRate = frameRate;
-            decodedImages << images;
-
-            videoDecoder->deleteLater();
-        }
-    });
-
-    QtConcurrent::run(videoDecoder, &FFMpegDemuxer::decode);
+    videoPlayer.addInterval(encodedVideoData, QDateTime::currentMSecsSinceEpoch()); // the frames are decoded when played
 }
 
 void NinjamTrackGroupView::startVideoStream()
 {
-    lastVideoRender = 0;
-
-    if (!decodedImages.isEmpty()) {
-        while (decodedImages.size() > 1)
-            decodedImages.removeFirst(); // keep just the last decoded interval
-    }
-    else {
+    if (!videoPlayer.startNextInterval(QDateTime::currentMSecsSinceEpoch())) {
         intervalsWithoutReceiveVideo++;
         if (intervalsWithoutReceiveVideo > 1) {
             videoWidget->setVisible(false); // hide the video widget when transmition is stopped
@@ -467,21 +449,10 @@ void NinjamTrackGroupView::updateGuiElements()
     userNameLabel->updateMarquee();
 
     // video
-    if (!decodedImages.isEmpty()) {
-        quint64 now = QDateTime::currentMSecsSinceEpoch();
-
-        quint64 timePerFrame = 1000 / videoFrameRate;
-        quint64 diff = now - lastVideoRender;
-        if (diff >= timePerFrame) { // time to show a new video frame?
-            lastVideoRender = now - (diff % timePerFrame);
-            auto &currentImages = decodedImages.first();
-            if (!currentImages.isEmpty()) {
-                updateVideoFrame(currentImages.takeFirst());
-            }
-            else {
-                decodedImages.removeFirst(); // avoid show the last received frame forever
-            }
-        }
+    const QImage frame = videoPlayer.getFrameToShow(QDateTime::currentMSecsSinceEpoch());
+    if (!frame.isNull()) {
+        updateVideoFrame(frame);
+        VideoFramesPool::getInstance().releaseImage(frame); // reused by the decoders when not showed anymore
     }
 }
 
@@ -5,6 +5,7 @@
 #include "NinjamTrackView.h"
 #include "widgets/MarqueeLabel.h"
 #include "video/VideoWidget.h"
+#include "video/VideoStreamPlayer.h"
 
 #include <QLabel>
 #include <QBoxLayout>
@@ -74,10 +75,7 @@ private:
     TracksLayout tracksLayoutEnum;
 
     VideoWidget *videoWidget;
-    QByteArray encodedVideoData;
-    quint64 lastVideoRender;
-    QList<QList<QImage>> decodedImages;
-    uint videoFrameRate;
+    VideoStreamPlayer videoPlayer; // decoding the received video intervals a few frames ahead
     uint intervalsWithoutReceiveVideo;
 
     void setupHorizontalLayout();
@@ -283,6 +283,19 @@ void PreferencesDialog::populateLooperTab()
     ui->comboBoxBitRate->setCurrentIndex(comboBoxIndex);
 }
 
+void PreferencesDialog::setRecordingIOMetrics(const recorder::RecorderIOMetrics &metrics)
+{
+    QString text = tr("Disk writes: %1 KB queued, %2 ms average latency (max %3 ms)")
+            .arg(metrics.queuedBytes / 1024)
+            .arg(metrics.averageWriteLatency, 0, 'f', 1)
+            .arg(metrics.maxWriteLatency, 0, 'f', 0);
+
+    if (metrics.droppedWrites > 0)
+        text += ", " + tr("%1 dropped intervals (the disk is too slow)").arg(metrics.droppedWrites);
+
+    ui->labelRecordingIOStatus->setText(text);
+}
+
 void PreferencesDialog::selectRecordingTab()
 {
     ui->prefsTab->setCurrentWidget(ui->tabRecording);
@@ -34,6 +34,8 @@ public:
 
     virtual void initialize(PreferencesTab initialTab, const persistence::Settings *settings, const QMap<QString, QString> &jamRecorders);
 
+    void setRecordingIOMetrics(const recorder::RecorderIOMetrics &metrics); // disk writes counters in recording tab
+
 signals:
     void customMetronomeSelected(const QString &primaryBeatAudioFile, const QString &offBeatAudioFile, const QString &accentBeatAudioFile);
     void builtInMetronomeSelected(const QString &metronomeAlias);
@@ -0,0 +1,141 @@
+#include "RealTimeAllocationTracker.h"
+
+#ifdef JAMTABA_RT_ALLOC_TRACKER
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#ifdef Q_OS_WIN
+    #include <windows.h>
+#else
+    #include <execinfo.h>
+    #include <unistd.h>
+#endif
+
+namespace {
+
+thread_local bool insideRealTimeScope = false;
+thread_local bool reporting = false; // avoid recursion when the report code is allocating
+
+std::atomic<quint64> allocationsCount(0);
+
+const int MAX_STACK_FRAMES = 32;
+
+void reportAllocation(std::size_t size)
+{
+    if (!insideRealTimeScope || reporting)
+        return;
+
+    reporting = true;
+
+    const quint64 count = ++allocationsCount;
+
+    std::fprintf(stderr, "\n[RT ALLOCATION #%llu] %lu bytes allocated in real time thread\n",
+                 static_cast<unsigned long long>(count), static_cast<unsigned long>(size));
+
+    void *frames[MAX_STACK_FRAMES];
+
+#ifdef Q_OS_WIN
+    USHORT capturedFrames = CaptureStackBackTrace(2, MAX_STACK_FRAMES, frames, nullptr);
+    for (USHORT i = 0; i < capturedFrames; ++i)
+        std::fprintf(stderr, "    #%d %p\n", i, frames[i]); // resolve the addresses using the .pdb file
+#else
+    int capturedFrames = backtrace(frames, MAX_STACK_FRAMES);
+    std::fflush(stderr);
+    backtrace_symbols_fd(frames + 2, capturedFrames - 2, STDERR_FILENO); // skip the tracker internal frames, backtrace_symbols_fd() is not using malloc
+#endif
+
+    reporting = false;
+}
+
+void *allocate(std::size_t size)
+{
+    reportAllocation(size);
+
+    void *pointer = std::malloc(size ? size : 1);
+    if (!pointer)
+        throw std::bad_alloc();
+
+    return pointer;
+}
+
+} // namespace
+
+RealTimeScope::RealTimeScope() :
+    wasInsideRealTimeScope(insideRealTimeScope)
+{
+    insideRealTimeScope = true;
+}
+
+RealTimeScope::~RealTimeScope()
+{
+    insideRealTimeScope = wasInsideRealTimeScope;
+}
+
+bool RealTimeScope::isInsideRealTimeScope()
+{
+    return insideRealTimeScope;
+}
+
+quint64 RealTimeScope::getAllocationsCount()
+{
+    return allocationsCount;
+}
+
+// ++++++++++++++++ replaced global allocation functions ++++++++++++++++
+
+void *operator new(std::size_t size)
+{
+    return allocate(size);
+}
+
+void *operator new[](std::size_t size)
+{
+    return allocate(size);
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+    reportAllocation(size);
+    return std::malloc(size ? size : 1);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept
+{
+    reportAllocation(size);
+    return std::malloc(size ? size : 1);
+}
+
+void operator delete(void *pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete[](void *pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void *pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete[](void *pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void *pointer, const std::nothrow_t &) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete[](void *pointer, const std::nothrow_t &) noexcept
+{
+    std::free(pointer);
+}
+
+#endif // JAMTABA_RT_ALLOC_TRACKER
@@ -0,0 +1,53 @@
+#ifndef REALTIME_ALLOCATION_TRACKER_H
+#define REALTIME_ALLOCATION_TRACKER_H
+
+#include <QtGlobal>
+
+/**
+    Debug helper to find memory allocations in the audio thread. Build with 'CONFIG+=rt_alloc_tracker'
+    (debug builds only) to define JAMTABA_RT_ALLOC_TRACKER. In this mode the global operator new is
+    replaced and every allocation made while a RealTimeScope is alive is reported (with a stack trace)
+    in stderr. Qt containers allocating with malloc() directly are not detected.
+
+    In normal builds RealTimeScope is an empty class and have no cost.
+*/
+
+class RealTimeScope
+{
+public:
+    RealTimeScope();  // mark the current thread as real time until the scope ends
+    ~RealTimeScope();
+
+    static bool isInsideRealTimeScope();
+    static quint64 getAllocationsCount(); // allocations detected in real time scopes since the application start
+
+private:
+    bool wasInsideRealTimeScope; // scopes can be nested
+};
+
+#ifndef JAMTABA_RT_ALLOC_TRACKER
+
+inline RealTimeScope::RealTimeScope() :
+    wasInsideRealTimeScope(false)
+{
+
+}
+
+inline RealTimeScope::~RealTimeScope()
+{
+
+}
+
+inline bool RealTimeScope::isInsideRealTimeScope()
+{
+    return false;
+}
+
+inline quint64 RealTimeScope::getAllocationsCount()
+{
+    return 0;
+}
+
+#endif
+
+#endif // REALTIME_ALLOCATION_TRACKER_H
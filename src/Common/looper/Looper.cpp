@@ -23,6 +23,7 @@ Looper::Looper()
 Looper::Looper(Looper::Mode initialMode, quint8 maxLayers) :
     intervalLenght(0),
     intervalPosition(0),
+    mixerIntervalLenght(0),
     changed(false),
     loading(false),
     waitingToStop(false),
@@ -259,6 +260,8 @@ void Looper::setLayerLockedState(quint8 layerIndex, bool locked)
         if (locked && focusedLayerIndex == layerIndex)
             focusedLayerIndex = -1; // clear focused layer when locking
 
+        prepareMixer(mixerIntervalLenght); // allocate or release the locked layers submix
+
         setChanged(true);
 
         emit layerChanged(layerIndex);
@@ -492,6 +495,7 @@ void Looper::mixToBuffer(SamplesBuffer &samples)
 
     uint samplesToProcess = qMin(samples.getFrameLenght(), intervalLenght - intervalPosition);
     AudioPeak peakBeforeMix = samples.computePeak();
+    mixer.startBlock();
     state->mixTo(samples, samplesToProcess);
 
     AudioPeak peakAfterMix = samples.computePeak();
@@ -563,9 +567,17 @@ void Looper::startNewCycle(uint samplesInCycle)
         }
     }
 
+    mixer.prepareForNewCycle(samplesInCycle);
+
     state->handleNewCycle(samplesInCycle);
 }
 
+void Looper::prepareMixer(uint samplesInCycle)
+{
+    mixerIntervalLenght = samplesInCycle;
+    mixer.setSubmixLenght(hasLockedLayers() ? samplesInCycle : 0);
+}
+
 void Looper::setState(LooperState *newState)
 {
     if (state.data() != newState) {
@@ -611,29 +623,24 @@ void Looper::setMode(Mode mode)
 
 void Looper::mixLayer(quint8 layerIndex, SamplesBuffer &samples, uint samplesToMix)
 {
-    if (layerIndex >= maxLayers)
-        return;
-
-    LooperLayer *loopLayer = layers[layerIndex];
-    samplesToMix = qMin(samplesToMix, loopLayer->getAvailableSamples());
-    if (samplesToMix) {
-        loopLayer->mixTo(samples, samplesToMix, intervalPosition, mainGain); // mix buffered samples
-    }
+    if (layerIndex < maxLayers)
+        mixer.mix(samples, samplesToMix, intervalPosition, mainGain, layers, maxLayers, 1u << layerIndex);
 }
 
 void Looper::mixAllLayers(SamplesBuffer &samples, uint samplesToMix)
 {
-    for (uint layer = 0; layer < maxLayers; ++layer)
-        mixLayer(layer, samples, samplesToMix);
+    mixer.mix(samples, samplesToMix, intervalPosition, mainGain, layers, maxLayers, (1u << maxLayers) - 1); // all layers in one pass
 }
 
 void Looper::mixLockedLayers(SamplesBuffer &samples, uint samplesToMix)
 {
+    quint32 lockedLayers = 0;
     for (uint layer = 0; layer < maxLayers; ++layer) {
-        if (layerIsLocked(layer)) {
-            mixLayer(layer, samples, samplesToMix);
-        }
+        if (layerIsLocked(layer))
+            lockedLayers |= 1u << layer;
     }
+
+    mixer.mix(samples, samplesToMix, intervalPosition, mainGain, layers, maxLayers, lockedLayers);
 }
 
 void Looper::processBufferUsingCurrentLayerSettings(SamplesBuffer &buffer)
@@ -4,6 +4,7 @@
 #include "audio/core/SamplesBuffer.h"
 #include "LooperLayer.h"
 #include "LooperPersistence.h"
+#include "LooperMixer.h"
 
 #include <QtGlobal>
 #include <QObject>
@@ -12,8 +13,6 @@
 #include <QMap>
 #include <QMutex>
 
-#define MAX_LOOP_LAYERS 8
-
 namespace audio {
 
 class LooperState;
@@ -55,6 +54,7 @@ public:
     void setLayerSamples(quint8 layer, const SamplesBuffer &samples);
 
     void startNewCycle(uint samplesInCycle);
+    void prepareMixer(uint samplesInCycle); // GUI thread, allocate the locked layers submix used in the next cycles
 
     void selectLayer(quint8 layerIndex);
     bool canSelectLayers() const;
@@ -165,6 +165,7 @@ signals:
 private:
     uint intervalLenght; // in samples
     uint intervalPosition; // in samples
+    uint mixerIntervalLenght; // in samples, GUI thread
 
     bool changed; // used to decide if we can save or not layers content
     bool loading;
@@ -201,6 +202,8 @@ private:
 
     Options modeOptions[3]; // 3 modes
 
+    LooperMixer mixer;
+
     void mixLayer(quint8 layerIndex, SamplesBuffer &samples, uint samplesToMix);
     void mixAllLayers(SamplesBuffer &samples, uint samplesToMix);
     void mixLockedLayers(SamplesBuffer &samples, uint samplesToMix);
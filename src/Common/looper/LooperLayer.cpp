@@ -1,5 +1,6 @@
 #include "LooperLayer.h"
 #include "audio/core/SamplesBuffer.h"
+#include "audio/core/SamplesKernels.h"
 
 #include <cstring>
 #include <cmath>
@@ -11,10 +12,9 @@ using audio::LooperLayer;
 using audio::SamplesBuffer;
 
 LooperLayer::LooperLayer() :
-    lastSamplesPerPeak(0),
     availableSamples(0),
-    lastCacheComputationSample(0),
     lastCycleLenght(0),
+    revision(0),
     locked(false),
     gain(1.0),
     pan(0),
@@ -48,9 +48,8 @@ void LooperLayer::zero()
     std::fill(rightChannel.begin(), rightChannel.end(), static_cast<float>(0));
 
     availableSamples = 0;
-    lastSamplesPerPeak = 0;
-    lastCacheComputationSample = 0;
-    peaksCache.clear();
+    peaks.clear();
+    revision++;
 }
 
 void LooperLayer::setSamples(const SamplesBuffer &samples)
@@ -75,18 +74,8 @@ void LooperLayer::setSamples(const SamplesBuffer &samples)
 
     availableSamples = samplesToCopy;
 
-
-    // rebuild peaks cache
-    lastCacheComputationSample = 0;
-    peaksCache.clear();
-
-    if (lastSamplesPerPeak) {
-        while (availableSamples - lastCacheComputationSample >= lastSamplesPerPeak) { // enough samples to cache a new max peak?
-            peaksCache.push_back(computeMaxPeak(lastCacheComputationSample, lastSamplesPerPeak));
-            lastCacheComputationSample += lastSamplesPerPeak;
-        }
-    }
-
+    updatePeaks(0, samplesToCopy);
+    revision++;
 }
 
 void LooperLayer::setPan(float pan)
@@ -115,72 +104,27 @@ void LooperLayer::setGain(float gain)
 
 void LooperLayer::prepareForNewCycle(uint samplesInNewCycle, bool isOverdubbing)
 {
+    Q_UNUSED(isOverdubbing) // the overdubbed samples are updated in the peaks pyramid, no cache position to reset
+
     if (samplesInNewCycle > lastCycleLenght)
         resize(samplesInNewCycle);
 
-    if (isOverdubbing)
-        lastCacheComputationSample = 0; // reset max peak cache position to compute overdub peaks correctly
-
     lastCycleLenght = samplesInNewCycle;
 }
 
 void LooperLayer::overdub(const SamplesBuffer &samples, uint samplesToMix, uint startPosition)
 {
-    if (!samples.isMono()) {
-        float *internalChannels[] = {&(leftChannel[startPosition]), &(rightChannel[startPosition])};
-        float *samplesArray[] = {samples.getSamplesArray(0), samples.getSamplesArray(1)};
-        for (uint s = 0; s < samplesToMix; ++s) {
-            internalChannels[0][s] += samplesArray[0][s]; // left channel
-            internalChannels[1][s] += samplesArray[1][s]; // right channel
-        }
-    }
-    else {
-        float *internalChannels[] = {&(leftChannel[startPosition]), &(rightChannel[startPosition])};
-        float *samplesArray = samples.getSamplesArray(0);
-        for (uint s = 0; s < samplesToMix; ++s) {
-            internalChannels[0][s] += samplesArray[s];
-        }
-    }
+    const auto &kernels = SamplesKernels::get();
+
+    kernels.add(&(leftChannel[startPosition]), samples.getSamplesArray(0), samplesToMix);
+    if (!samples.isMono())
+        kernels.add(&(rightChannel[startPosition]), samples.getSamplesArray(1), samplesToMix); // mono samples are overdubbed in left channel only
 
     if (availableSamples < startPosition + samplesToMix)
         availableSamples = startPosition + samplesToMix;
 
-    // build peaks cache when overdubbing
-    if (lastSamplesPerPeak) {
-        const uint position = startPosition + samplesToMix;
-        while (position - lastCacheComputationSample >= lastSamplesPerPeak) { // enough samples to cache a new max peak?
-            const int peakIndex = (position/lastSamplesPerPeak) - 1;
-            float lastPeak = computeMaxPeak(lastCacheComputationSample, lastSamplesPerPeak);
-            if (peakIndex >= 0 && static_cast<uint>(peakIndex) < peaksCache.size())
-                peaksCache[peakIndex] = lastPeak;
-            else
-                peaksCache.push_back(lastPeak);
-
-            lastCacheComputationSample += lastSamplesPerPeak;
-        }
-    }
-}
-
-void LooperLayer::mixTo(SamplesBuffer &outBuffer, uint samplesToMix, uint intervalPosition, float looperMainGain)
-{
-    bool canMix = samplesToMix > 0 && (muteState == LooperLayer::Unmuted || muteState == LooperLayer::WaitingToMute);
-    if (canMix) {
-        float *internalChannels[] = {&(leftChannel[0]), &(rightChannel[0])};
-        const uint secondChannelIndex = (outBuffer.isMono()) ? 0 : 1;
-        float *bufferChannels[] = {outBuffer.getSamplesArray(0), outBuffer.getSamplesArray(secondChannelIndex)};
-        uint channels = outBuffer.getChannels();
-
-        const float mainGain = looperMainGain * gain;
-        const float finalLeftGain = mainGain * leftGain;
-        const float finalRightGain = mainGain * rightGain;
-        float gains[] = {finalLeftGain, finalRightGain};
-        for (uint c = 0; c < channels; ++c) {
-            for (uint s = 0; s < samplesToMix; ++s) {
-                const uint offset = s + intervalPosition;
-                bufferChannels[c][s] += internalChannels[c][offset] * gains[c];
-            }
-        }
-    }
+    updatePeaks(startPosition, samplesToMix);
+    revision++;
 }
 
 void LooperLayer::append(const SamplesBuffer &samples, uint samplesToAppend, uint startPosition)
@@ -202,52 +146,35 @@ void LooperLayer::append(const SamplesBuffer &samples, uint samplesToAppend, uin
 
     //Q_ASSERT(availableSamples <= leftChannel.capacity());
 
-    // build peaks cache
-    if (lastSamplesPerPeak) {
-        if (lastCacheComputationSample < startPosition - lastSamplesPerPeak)
-            lastCacheComputationSample = startPosition;
+    updatePeaks(startPosition, toAppend);
+    revision++;
+}
 
-        while ((startPosition + samplesToAppend) - lastCacheComputationSample >= lastSamplesPerPeak && lastCacheComputationSample  < leftChannel.size()) { // enough samples to cache a new max peak?
-            peaksCache.push_back(computeMaxPeak(lastCacheComputationSample, lastSamplesPerPeak));
-            lastCacheComputationSample += lastSamplesPerPeak;
-        }
-    }
+void LooperLayer::updatePeaks(uint from, uint samples)
+{
+    if (!leftChannel.empty())
+        peaks.update(leftChannel.data(), rightChannel.data(), from, samples);
 }
 
 float LooperLayer::computeMaxPeak(uint from, uint samplesPerPeak) const
 {
-    float maxPeak = 0;
-    uint limit = qMin(samplesPerPeak, availableSamples - from);
-    for (uint i = 0; i < limit; ++i) {
-        const uint offset = from + i;
-        if (offset < leftChannel.size()) {
-            float peak = qMax(qAbs(leftChannel[offset]), qAbs(rightChannel[offset]));
-            if (peak > maxPeak) {
-                maxPeak = peak;
-            }
-        }
-    }
-
-    return maxPeak;
+    return computePeak(from, samplesPerPeak).getMaxAbsolute();
 }
 
-std::vector<float> LooperLayer::getSamplesPeaks(uint samplesPerPeak)
+audio::PeaksPyramid::Peak LooperLayer::computePeak(uint from, uint samples) const
 {
-    if (lastSamplesPerPeak == samplesPerPeak && !peaksCache.empty()) { // cache hit?
-        return peaksCache;
-    }
+    if (from >= availableSamples || leftChannel.empty())
+        return PeaksPyramid::Peak();
 
-    // compute all peaks
-    peaksCache.clear();
-    if (samplesPerPeak) {
-        for (uint i = 0; i < availableSamples; i += samplesPerPeak) {
-            float maxPeak = computeMaxPeak(i, samplesPerPeak);
-            peaksCache.push_back(maxPeak);
-        }
-        lastSamplesPerPeak = samplesPerPeak;
-    }
+    return peaks.getPeak(leftChannel.data(), rightChannel.data(), from, qMin(samples, availableSamples - from));
+}
 
-    return peaksCache;
+std::vector<float> LooperLayer::getSamplesPeaks(uint samplesPerPeak) const
+{
+    if (leftChannel.empty())
+        return std::vector<float>();
+
+    return peaks.getMaxPeaks(leftChannel.data(), rightChannel.data(), availableSamples, samplesPerPeak);
 }
 
 void LooperLayer::resize(quint32 samplesPerCycle)
@@ -258,6 +185,12 @@ void LooperLayer::resize(quint32 samplesPerCycle)
     if (samplesPerCycle > rightChannel.capacity())
         rightChannel.resize(samplesPerCycle);
 
+    const uint previousSize = peaks.getSize();
+    if (leftChannel.size() > previousSize) {
+        peaks.resize(leftChannel.size());
+        updatePeaks(previousSize, leftChannel.size() - previousSize); // the new samples are zeros
+    }
+
     if (availableSamples && samplesPerCycle > availableSamples) { // need copy samples?
         uint initialAvailableSamples = availableSamples;
         uint totalSamplesToCopy = samplesPerCycle - initialAvailableSamples;
@@ -272,7 +205,8 @@ void LooperLayer::resize(quint32 samplesPerCycle)
 
         Q_ASSERT(availableSamples == samplesPerCycle);
 
-        peaksCache.clear(); // invalidate peaks cache
+        updatePeaks(initialAvailableSamples, samplesPerCycle - initialAvailableSamples);
+        revision++;
     }
 }
 
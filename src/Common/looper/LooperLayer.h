@@ -4,6 +4,10 @@
 #include <vector>
 #include <QtGlobal>
 
+#include "PeaksPyramid.h"
+
+#define MAX_LOOP_LAYERS 8
+
 namespace audio {
 
 class SamplesBuffer;
@@ -36,12 +40,14 @@ public:
     void prepareForNewCycle(uint samplesInNewCycle, bool isOverdubbing);
 
     float computeMaxPeak(uint from, uint samplesPerPeak) const;
+    PeaksPyramid::Peak computePeak(uint from, uint samples) const; // min, max and rms
 
-    std::vector<float> getSamplesPeaks(uint samplesPerPeak);
+    std::vector<float> getSamplesPeaks(uint samplesPerPeak) const; // computed from the peaks pyramid, O(peaks) for any samplesPerPeak
 
     SamplesBuffer getAllSamples() const;
+    const float *getSamples(quint8 channel) const; // used by LooperMixer, the layer is mixed without copies
 
-    void mixTo(SamplesBuffer &outBuffer, uint samplesToMix, uint intervalPosition, float looperMainGain);
+    quint32 getRevision() const; // incremented when the samples are changed
 
     void setLocked(bool locked);
     bool isLocked() const;
@@ -56,6 +62,7 @@ public:
     };
 
     bool isMuted() const;
+    bool isAudible() const; // unmuted or waiting to mute
     void setMuteState(MuteState newState);
     MuteState getMuteState() const;
 
@@ -65,11 +72,10 @@ private:
     std::vector<float> leftChannel;
     std::vector<float> rightChannel;
 
-    std::vector<float> peaksCache;
-    uint lastSamplesPerPeak;
+    PeaksPyramid peaks; // updated when samples are appended or overdubbed
     uint availableSamples;
-    uint lastCacheComputationSample;
     uint lastCycleLenght;
+    quint32 revision;
     bool locked;
 
     float gain;
@@ -81,6 +87,7 @@ private:
     MuteState muteState;
 
     void resize(quint32 samplesPerCycle);
+    void updatePeaks(uint from, uint samples);
 
 };
 
@@ -109,6 +116,21 @@ inline bool LooperLayer::isMuted() const
     return muteState == MuteState::Muted;
 }
 
+inline bool LooperLayer::isAudible() const
+{
+    return muteState == MuteState::Unmuted || muteState == MuteState::WaitingToMute;
+}
+
+inline const float *LooperLayer::getSamples(quint8 channel) const
+{
+    return channel == 0 ? leftChannel.data() : rightChannel.data();
+}
+
+inline quint32 LooperLayer::getRevision() const
+{
+    return revision;
+}
+
 inline float LooperLayer::getPan() const
 {
     return pan;
@@ -0,0 +1,255 @@
+#include "LooperMixer.h"
+
+#include "audio/core/SamplesBuffer.h"
+#include "audio/core/SamplesKernels.h"
+
+#include <algorithm>
+
+using audio::LooperMixer;
+using audio::LooperLayer;
+using audio::SamplesBuffer;
+
+const uint LooperMixer::TILE_SIZE = 256; // 256 samples * (8 layers + output) fit in L1 cache
+
+bool LooperMixer::SubmixKey::operator==(const SubmixKey &other) const
+{
+    if (lockedLayers != other.lockedLayers)
+        return false;
+
+    for (int l = 0; l < MAX_LOOP_LAYERS; ++l) {
+        if (lockedLayers & (1u << l)) {
+            if (revisions[l] != other.revisions[l] || gains[l][0] != other.gains[l][0] || gains[l][1] != other.gains[l][1])
+                return false;
+        }
+    }
+
+    return true;
+}
+
+LooperMixer::Submix::Submix(uint lenght) :
+    lenght(lenght),
+    validTiles((lenght + TILE_SIZE - 1) / TILE_SIZE, false)
+{
+    for (auto &channel : samples)
+        channel.assign(lenght, 0);
+}
+
+// +++++++++++++++++++++++++++++++++++++++
+
+LooperMixer::LooperMixer() :
+    block(1), // 'lastBlock' is zero in layers never mixed
+    submixLenght(0),
+    cycleLenght(0),
+    submixHits(0),
+    submixTilesComputed(0)
+{
+
+}
+
+void LooperMixer::setSubmixLenght(uint intervalLenght)
+{
+    if (intervalLenght == submixLenght)
+        return;
+
+    submixLenght = intervalLenght;
+    submixSnapshot.publish(intervalLenght ? QSharedPointer<Submix>::create(intervalLenght) : QSharedPointer<Submix>()); // the old submix is released after the audio thread read sections
+}
+
+void LooperMixer::prepareForNewCycle(uint intervalLenght)
+{
+    cycleLenght = intervalLenght; // the submix is used only when it's allocated for this interval lenght
+}
+
+void LooperMixer::startBlock()
+{
+    block++;
+}
+
+void LooperMixer::mix(SamplesBuffer &out, uint samplesToMix, uint intervalPosition, float mainGain, LooperLayer * const *layers, quint8 layersCount, quint32 layersMask)
+{
+    if (!samplesToMix)
+        return;
+
+    Source sources[MAX_LOOP_LAYERS + 1]; // all unlocked layers + locked layers submix
+    uint sourcesCount = 0;
+
+    Source lockedSources[MAX_LOOP_LAYERS];
+    uint lockedSourcesCount = 0;
+    quint32 lockedLayers = 0;
+    bool lockedGainsAreStable = true; // the submix can't be used while a locked layer gain is ramping
+
+    layersCount = qMin(layersCount, static_cast<quint8>(MAX_LOOP_LAYERS));
+    for (quint8 l = 0; l < layersCount; ++l) {
+        const LooperLayer *layer = layers[l];
+        if (layer->isLocked())
+            lockedLayers |= 1u << l;
+
+        if (!(layersMask & (1u << l)))
+            continue;
+
+        float targetGains[2] = {0, 0};
+        if (layer->isAudible()) {
+            const float gain = mainGain * layer->getGain();
+            targetGains[0] = gain * layer->getLeftGain();
+            targetGains[1] = gain * layer->getRightGain();
+        }
+
+        LayerGains &layerGain = layerGains[l];
+        const bool mixedInPreviousBlock = layerGain.lastBlock != 0 && layerGain.lastBlock + 1 >= block;
+
+        Source source;
+        bool silent = true;
+        for (int c = 0; c < 2; ++c) {
+            source.beginGains[c] = mixedInPreviousBlock ? layerGain.gains[c] : targetGains[c];
+            source.gainSteps[c] = (targetGains[c] - source.beginGains[c]) / samplesToMix;
+            source.samples[c] = layer->getSamples(c) + intervalPosition;
+            silent = silent && source.beginGains[c] == 0 && targetGains[c] == 0;
+
+            layerGain.gains[c] = targetGains[c];
+        }
+        layerGain.lastBlock = block;
+
+        const uint availableSamples = layer->getAvailableSamples();
+        source.samplesToMix = availableSamples > intervalPosition ? qMin(samplesToMix, availableSamples - intervalPosition) : 0;
+        if (silent || !source.samplesToMix)
+            continue;
+
+        if (layer->isLocked()) {
+            lockedSources[lockedSourcesCount++] = source;
+            if (source.gainSteps[0] != 0 || source.gainSteps[1] != 0)
+                lockedGainsAreStable = false;
+        }
+        else {
+            sources[sourcesCount++] = source;
+        }
+    }
+
+    // the submix is containing all locked layers, it's used when all locked layers are mixed
+    const bool canUseSubmix = lockedSourcesCount > 1 && lockedGainsAreStable && (lockedLayers & ~layersMask) == 0;
+    Submix *submix = canUseSubmix ? prepareSubmix(layers, layersCount, lockedLayers, intervalPosition, samplesToMix) : nullptr;
+    if (submix) {
+        Source &source = sources[sourcesCount++];
+        for (int c = 0; c < 2; ++c) {
+            source.samples[c] = submix->samples[c].data() + intervalPosition;
+            source.beginGains[c] = mainGain; // layers gain and pan are applied in submix
+            source.gainSteps[c] = 0;
+        }
+        source.samplesToMix = samplesToMix;
+        submixHits++;
+    }
+    else {
+        for (uint s = 0; s < lockedSourcesCount; ++s)
+            sources[sourcesCount++] = lockedSources[s];
+    }
+
+    if (!sourcesCount)
+        return;
+
+    const quint8 channels = out.isMono() ? 1 : 2; // mono output is using left channel and left gain
+    for (quint8 c = 0; c < channels; ++c)
+        mixSources(out.getSamplesArray(c), sources, sourcesCount, c, samplesToMix);
+}
+
+void LooperMixer::mixSources(float *dest, const Source *sources, uint sourcesCount, quint8 channel, uint samplesToMix)
+{
+    const auto &kernels = SamplesKernels::get();
+
+    const float *tileSamples[MAX_LOOP_LAYERS + 1];
+    float beginGains[MAX_LOOP_LAYERS + 1];
+    float gainSteps[MAX_LOOP_LAYERS + 1];
+
+    for (uint tileStart = 0; tileStart < samplesToMix; tileStart += TILE_SIZE) {
+        const uint tileLenght = qMin(TILE_SIZE, samplesToMix - tileStart);
+        uint tileSources = 0;
+        for (uint s = 0; s < sourcesCount; ++s) {
+            const Source &source = sources[s];
+            if (source.samplesToMix <= tileStart)
+                continue;
+
+            const float *samples = source.samples[channel] + tileStart;
+            const float beginGain = source.beginGains[channel] + source.gainSteps[channel] * tileStart;
+            const uint remainingSamples = source.samplesToMix - tileStart;
+            if (remainingSamples < tileLenght) { // the layer is ending inside this tile
+                kernels.mix(dest + tileStart, &samples, &beginGain, &source.gainSteps[channel], 1, remainingSamples);
+                continue;
+            }
+
+            tileSamples[tileSources] = samples;
+            beginGains[tileSources] = beginGain;
+            gainSteps[tileSources] = source.gainSteps[channel];
+            tileSources++;
+        }
+
+        if (tileSources)
+            kernels.mix(dest + tileStart, tileSamples, beginGains, gainSteps, tileSources, tileLenght);
+    }
+}
+
+LooperMixer::Submix *LooperMixer::prepareSubmix(LooperLayer * const *layers, quint8 layersCount, quint32 lockedLayers, uint intervalPosition, uint samplesToMix)
+{
+    Submix *submix = submixSnapshot.read().data(); // valid until the end of the audio callback
+    if (!submix || submix->lenght != cycleLenght || submix->lenght < intervalPosition + samplesToMix)
+        return nullptr; // the submix is allocated in GUI thread
+
+    SubmixKey key;
+    key.lockedLayers = lockedLayers;
+    for (quint8 l = 0; l < layersCount; ++l) {
+        if (!(lockedLayers & (1u << l)))
+            continue;
+
+        const LooperLayer *layer = layers[l];
+        key.revisions[l] = layer->getRevision();
+        key.gains[l][0] = layer->isAudible() ? layer->getGain() * layer->getLeftGain() : 0;
+        key.gains[l][1] = layer->isAudible() ? layer->getGain() * layer->getRightGain() : 0;
+    }
+
+    if (!(key == submixKey)) { // a locked layer was changed
+        std::fill(submix->validTiles.begin(), submix->validTiles.end(), false);
+        submixKey = key;
+    }
+
+    const uint firstTile = intervalPosition / TILE_SIZE;
+    const uint lastTile = (intervalPosition + samplesToMix - 1) / TILE_SIZE;
+    for (uint tile = firstTile; tile <= lastTile; ++tile) {
+        if (!submix->validTiles[tile]) {
+            computeSubmixTile(*submix, layers, layersCount, tile);
+            submix->validTiles[tile] = true;
+        }
+    }
+
+    return submix;
+}
+
+void LooperMixer::computeSubmixTile(Submix &submix, LooperLayer * const *layers, quint8 layersCount, uint tile)
+{
+    const uint tileStart = tile * TILE_SIZE;
+    const uint tileLenght = qMin(TILE_SIZE, submix.lenght - tileStart);
+
+    Source sources[MAX_LOOP_LAYERS];
+    uint sourcesCount = 0;
+    for (quint8 l = 0; l < layersCount; ++l) {
+        if (!(submixKey.lockedLayers & (1u << l)))
+            continue;
+
+        const LooperLayer *layer = layers[l];
+        const uint availableSamples = layer->getAvailableSamples();
+        if (availableSamples <= tileStart || (submixKey.gains[l][0] == 0 && submixKey.gains[l][1] == 0))
+            continue;
+
+        Source &source = sources[sourcesCount++];
+        for (int c = 0; c < 2; ++c) {
+            source.samples[c] = layer->getSamples(c) + tileStart;
+            source.beginGains[c] = submixKey.gains[l][c];
+            source.gainSteps[c] = 0;
+        }
+        source.samplesToMix = qMin(tileLenght, availableSamples - tileStart);
+    }
+
+    for (quint8 c = 0; c < 2; ++c) {
+        float *tileSamples = submix.samples[c].data() + tileStart;
+        std::fill(tileSamples, tileSamples + tileLenght, 0.0f);
+        mixSources(tileSamples, sources, sourcesCount, c, tileLenght);
+    }
+
+    submixTilesComputed++;
+}
@@ -0,0 +1,112 @@
+#ifndef _AUDIO_LOOPER_MIXER_
+#define _AUDIO_LOOPER_MIXER_
+
+#include <vector>
+#include <QtGlobal>
+#include <QSharedPointer>
+
+#include "LooperLayer.h"
+#include "audio/core/SnapshotPublisher.h"
+
+namespace audio {
+
+class SamplesBuffer;
+
+/**
+    Mix the looper layers in the output buffer. All selected layers are mixed in one pass
+    (SamplesKernels::mix) over tiles of TILE_SIZE samples, the output tile is loaded and stored
+    once for all layers.
+
+    The layer gains (main gain, layer gain, pan and mute) are ramped along the audio block when
+    they change, so moving the gain or pan knobs is not producing zipper noise.
+
+    The locked layers are not changing while they are locked, so they are mixed in a submix
+    (with layers gain and pan applied) and reused in every interval. The submix tiles are
+    computed when they are played for the first time, and invalidated when any locked layer is
+    changed (content, gain, pan, mute or the locked layers set). The submix is allocated in the
+    GUI thread (setSubmixLenght) and published to the audio thread, the audio thread is only
+    invalidating the tiles.
+*/
+
+class LooperMixer
+{
+public:
+    LooperMixer();
+
+    void setSubmixLenght(uint intervalLenght); // GUI thread, allocate (or release when zero) the locked layers submix
+
+    void prepareForNewCycle(uint intervalLenght); // audio thread, no allocations
+
+    void startBlock(); // called once in each audio callback, before mixing
+
+    // the bits in 'layersMask' are the layers to mix
+    void mix(SamplesBuffer &out, uint samplesToMix, uint intervalPosition, float mainGain, LooperLayer * const *layers, quint8 layersCount, quint32 layersMask);
+
+    uint getSubmixHits() const; // blocks mixed using the locked layers submix
+    uint getSubmixTilesComputed() const;
+
+    static const uint TILE_SIZE; // samples
+
+private:
+    struct LayerGains
+    {
+        float gains[2] = {0, 0}; // gains applied in the last block
+        quint64 lastBlock = 0; // the gains are ramped only if the layer was mixed in the previous block
+    };
+
+    struct Source
+    {
+        const float *samples[2];
+        float beginGains[2];
+        float gainSteps[2];
+        uint samplesToMix;
+    };
+
+    struct Submix
+    {
+        explicit Submix(uint lenght);
+
+        uint lenght;
+        std::vector<float> samples[2];
+        std::vector<bool> validTiles;
+    };
+
+    struct SubmixKey // everything changing the locked layers submix
+    {
+        quint32 lockedLayers = 0;
+        quint32 revisions[MAX_LOOP_LAYERS] = {};
+        float gains[MAX_LOOP_LAYERS][2] = {}; // layer gain and pan, zero when muted
+
+        bool operator==(const SubmixKey &other) const;
+    };
+
+    LayerGains layerGains[MAX_LOOP_LAYERS];
+    quint64 block;
+
+    SnapshotPublisher<QSharedPointer<Submix>> submixSnapshot; // null when there are no locked layers
+    uint submixLenght; // GUI thread
+    uint cycleLenght; // audio thread
+    SubmixKey submixKey;
+
+    uint submixHits;
+    uint submixTilesComputed;
+
+    Submix *prepareSubmix(LooperLayer * const *layers, quint8 layersCount, quint32 lockedLayers, uint intervalPosition, uint samplesToMix);
+    void computeSubmixTile(Submix &submix, LooperLayer * const *layers, quint8 layersCount, uint tile);
+
+    static void mixSources(float *dest, const Source *sources, uint sourcesCount, quint8 channel, uint samplesToMix);
+};
+
+inline uint LooperMixer::getSubmixHits() const
+{
+    return submixHits;
+}
+
+inline uint LooperMixer::getSubmixTilesComputed() const
+{
+    return submixTilesComputed;
+}
+
+} // namespace
+
+#endif
@@ -3,6 +3,7 @@
 #include "file/WaveFileWriter.h"
 #include "audio/vorbis/VorbisEncoder.h"
 #include "file/FileReaderFactory.h"
+#include "file/WaveFileReader.h"
 #include "audio/SamplesBufferResampler.h"
 #include "Utils.h"
 
@@ -204,6 +205,11 @@ bool LoopLoader::loadAudioFile(const QString &filePath, uint currentSampleRate,
         return false;
     }
 
+    if (QFileInfo(filePath).suffix() == "wav") { // resampled while reading, the out lenght is the max lenght in current sample rate
+        audio::WaveFileReader waveReader;
+        return waveReader.readResampled(filePath, out, currentSampleRate);
+    }
+
     auto fileReader = FileReaderFactory::createFileReader(filePath);
     quint32 audioFileSampleRate = 0;
     if (!fileReader->read(filePath, out, audioFileSampleRate))
@@ -211,11 +217,8 @@ bool LoopLoader::loadAudioFile(const QString &filePath, uint currentSampleRate,
 
     bool needResample = audioFileSampleRate > 0 && currentSampleRate != audioFileSampleRate;
     if (needResample) {
-        SamplesBufferResampler resampler;
-        uint desiredLenght = currentSampleRate/static_cast<float>(audioFileSampleRate) * out.getFrameLenght();
-        const SamplesBuffer resampledBuffer = resampler.resample(out, desiredLenght);
-        out.setFrameLenght(desiredLenght);
-        out.set(resampledBuffer);
+        const SamplesBuffer originalBuffer(out);
+        SamplesBufferResampler::resample(originalBuffer, out, audioFileSampleRate, currentSampleRate);
     }
 
     return true;
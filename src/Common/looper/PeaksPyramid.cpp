@@ -0,0 +1,217 @@
+#include "PeaksPyramid.h"
+
+#include <cmath>
+
+using audio::PeaksPyramid;
+
+namespace {
+
+const uint BASE_BLOCK_SHIFT = 6; // log2(BASE_BLOCK_SIZE)
+
+} // namespace
+
+const uint PeaksPyramid::BASE_BLOCK_SIZE;
+
+class PeaksPyramid::Accumulator
+{
+public:
+    Accumulator() :
+        min(0),
+        max(0),
+        sumOfSquares(0),
+        samples(0)
+    {
+    }
+
+    void add(const Block &block, uint blockSamples)
+    {
+        if (samples == 0) {
+            min = block.min;
+            max = block.max;
+        }
+        else {
+            min = qMin(min, block.min);
+            max = qMax(max, block.max);
+        }
+
+        sumOfSquares += block.sumOfSquares;
+        samples += blockSamples;
+    }
+
+    Peak getPeak() const
+    {
+        Peak peak;
+        if (samples > 0) {
+            peak.min = min;
+            peak.max = max;
+            peak.rms = static_cast<float>(std::sqrt(sumOfSquares / samples));
+        }
+        return peak;
+    }
+
+private:
+    float min;
+    float max;
+    double sumOfSquares;
+    uint samples;
+};
+
+// +++++++++++++++++++++++++++++++++++++++
+
+PeaksPyramid::PeaksPyramid() :
+    size(0)
+{
+
+}
+
+void PeaksPyramid::resize(uint samples)
+{
+    if (samples == size)
+        return;
+
+    size = samples;
+
+    if (size == 0) {
+        levels.clear();
+        return;
+    }
+
+    // the existing blocks are kept, the new samples are updated by the caller
+    uint blocks = (samples + BASE_BLOCK_SIZE - 1) >> BASE_BLOCK_SHIFT;
+    size_t level = 0;
+    forever {
+        if (level >= levels.size())
+            levels.push_back(std::vector<Block>());
+
+        levels[level].resize(blocks, Block{0, 0, 0});
+
+        if (blocks == 1)
+            break;
+
+        blocks = (blocks + 1) / 2;
+        level++;
+    }
+
+    levels.resize(level + 1);
+
+    // the upper levels are recomputed, the last blocks in each level can have new children
+    for (size_t l = 1; l < levels.size(); ++l) {
+        for (uint b = 0; b < levels[l].size(); ++b)
+            levels[l][b] = mergeChildren(levels[l - 1], b);
+    }
+}
+
+void PeaksPyramid::clear()
+{
+    for (auto &level : levels)
+        std::fill(level.begin(), level.end(), Block{0, 0, 0});
+}
+
+PeaksPyramid::Block PeaksPyramid::computeBlock(const float *left, const float *right, uint from, uint samples) const
+{
+    Block block{0, 0, 0};
+    if (samples == 0)
+        return block;
+
+    block.min = qMin(left[from], right[from]);
+    block.max = qMax(left[from], right[from]);
+
+    for (uint s = from; s < from + samples; ++s) {
+        const float l = left[s];
+        const float r = right[s];
+        block.min = qMin(block.min, qMin(l, r));
+        block.max = qMax(block.max, qMax(l, r));
+        block.sumOfSquares += (l * l + r * r) * 0.5f;
+    }
+
+    return block;
+}
+
+void PeaksPyramid::update(const float *left, const float *right, uint from, uint samples)
+{
+    if (levels.empty() || samples == 0 || from >= size)
+        return;
+
+    samples = qMin(samples, size - from);
+
+    uint firstBlock = from >> BASE_BLOCK_SHIFT;
+    uint lastBlock = (from + samples - 1) >> BASE_BLOCK_SHIFT;
+
+    auto &baseLevel = levels[0];
+    for (uint b = firstBlock; b <= lastBlock; ++b) {
+        const uint blockStart = b << BASE_BLOCK_SHIFT;
+        baseLevel[b] = computeBlock(left, right, blockStart, qMin(BASE_BLOCK_SIZE, size - blockStart));
+    }
+
+    // propagating the changes to the upper levels, only the parents of changed blocks are recomputed
+    for (size_t l = 1; l < levels.size(); ++l) {
+        const auto &children = levels[l - 1];
+        auto &level = levels[l];
+
+        firstBlock >>= 1;
+        lastBlock >>= 1;
+        for (uint b = firstBlock; b <= lastBlock; ++b)
+            level[b] = mergeChildren(children, b);
+    }
+}
+
+PeaksPyramid::Block PeaksPyramid::mergeChildren(const std::vector<Block> &children, uint parentIndex)
+{
+    Block block = children[parentIndex * 2];
+    if (parentIndex * 2 + 1 < children.size()) {
+        const Block &second = children[parentIndex * 2 + 1];
+        block.min = qMin(block.min, second.min);
+        block.max = qMax(block.max, second.max);
+        block.sumOfSquares += second.sumOfSquares;
+    }
+
+    return block;
+}
+
+PeaksPyramid::Peak PeaksPyramid::getPeak(const float *left, const float *right, uint from, uint samples) const
+{
+    Accumulator accumulator;
+    if (levels.empty() || from >= size)
+        return accumulator.getPeak();
+
+    const uint end = from + qMin(samples, size - from);
+    uint position = from;
+    while (position < end) {
+        // the biggest block aligned in current position and inside the range
+        int level = -1;
+        while (level + 1 < static_cast<int>(levels.size())) {
+            const uint blockSize = BASE_BLOCK_SIZE << (level + 1);
+            if (position % blockSize != 0 || position + blockSize > end)
+                break;
+            level++;
+        }
+
+        if (level >= 0) {
+            const uint blockSize = BASE_BLOCK_SIZE << level;
+            accumulator.add(levels[level][position >> (BASE_BLOCK_SHIFT + level)], blockSize);
+            position += blockSize;
+        }
+        else { // range start or end is not aligned with the level 0 blocks, scanning the samples
+            const uint nextBlockStart = ((position >> BASE_BLOCK_SHIFT) + 1) << BASE_BLOCK_SHIFT;
+            const uint samplesToScan = qMin(nextBlockStart, end) - position;
+            accumulator.add(computeBlock(left, right, position, samplesToScan), samplesToScan);
+            position += samplesToScan;
+        }
+    }
+
+    return accumulator.getPeak();
+}
+
+std::vector<float> PeaksPyramid::getMaxPeaks(const float *left, const float *right, uint availableSamples, uint samplesPerPeak) const
+{
+    std::vector<float> peaks;
+    if (samplesPerPeak == 0)
+        return peaks;
+
+    availableSamples = qMin(availableSamples, size);
+    peaks.reserve((availableSamples + samplesPerPeak - 1) / samplesPerPeak);
+    for (uint from = 0; from < availableSamples; from += samplesPerPeak)
+        peaks.push_back(getPeak(left, right, from, qMin(samplesPerPeak, availableSamples - from)).getMaxAbsolute());
+
+    return peaks;
+}
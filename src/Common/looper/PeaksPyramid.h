@@ -0,0 +1,80 @@
+#ifndef _AUDIO_PEAKS_PYRAMID_
+#define _AUDIO_PEAKS_PYRAMID_
+
+#include <vector>
+#include <QtGlobal>
+
+namespace audio {
+
+/**
+    Multi resolution peaks of a stereo samples array (like mip-maps for images). The level 0 is
+    summarizing blocks of BASE_BLOCK_SIZE samples, each next level is summarizing 2 blocks of the
+    previous level. The peaks are updated incrementally when samples are changed, and the peaks
+    of any range are computed using the biggest aligned blocks inside the range, so the peaks for
+    any zoom level are computed without scanning all samples again.
+
+    The pyramid is not owning the samples, the samples are passed in every call.
+*/
+
+class PeaksPyramid
+{
+public:
+    struct Peak
+    {
+        float min = 0;
+        float max = 0;
+        float rms = 0;
+
+        float getMaxAbsolute() const;
+    };
+
+    PeaksPyramid();
+
+    void resize(uint samples); // preallocate the levels (no allocations in update), the peaks of existing samples are kept
+    void clear();
+
+    void update(const float *left, const float *right, uint from, uint samples); // recompute the blocks containing the changed samples
+
+    Peak getPeak(const float *left, const float *right, uint from, uint samples) const;
+    std::vector<float> getMaxPeaks(const float *left, const float *right, uint availableSamples, uint samplesPerPeak) const;
+
+    uint getSize() const;
+    int getLevels() const;
+
+    static const uint BASE_BLOCK_SIZE = 64; // samples summarized in each level 0 block
+
+private:
+    struct Block
+    {
+        float min;
+        float max;
+        float sumOfSquares; // (left^2 + right^2)/2 for each sample
+    };
+
+    class Accumulator;
+
+    std::vector<std::vector<Block>> levels;
+    uint size;
+
+    Block computeBlock(const float *left, const float *right, uint from, uint samples) const;
+    static Block mergeChildren(const std::vector<Block> &children, uint parentIndex);
+};
+
+inline float PeaksPyramid::Peak::getMaxAbsolute() const
+{
+    return qMax(qAbs(min), qAbs(max));
+}
+
+inline uint PeaksPyramid::getSize() const
+{
+    return size;
+}
+
+inline int PeaksPyramid::getLevels() const
+{
+    return static_cast<int>(levels.size());
+}
+
+} // namespace
+
+#endif
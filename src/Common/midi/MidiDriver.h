@@ -31,7 +31,8 @@ public:
     virtual QString getInputDeviceName(uint index) const = 0;
     virtual QString getOutputDeviceName(uint index) const = 0;
 
-    virtual std::vector<MidiMessage> getBuffer() = 0;
+    // called in audio thread, append the received messages in 'messages' (without allocations, the capacity is reserved by the caller) with sample offsets in the next 'frames'
+    virtual void consumeMessages(std::vector<MidiMessage> &messages, quint32 frames, int sampleRate) = 0;
 
     virtual bool inputDeviceIsGloballyEnabled(int deviceIndex) const;
     virtual bool outputDeviceIsGloballyEnabled(int deviceIndex) const;
@@ -97,9 +98,11 @@ class NullMidiDriver : public MidiDriver
         return "";
     }
 
-    inline std::vector<MidiMessage> getBuffer() override
+    inline void consumeMessages(std::vector<MidiMessage> &messages, quint32 frames, int sampleRate) override
     {
-        return std::vector<MidiMessage>();
+        Q_UNUSED(messages)
+        Q_UNUSED(frames)
+        Q_UNUSED(sampleRate)
     }
 
     void sendClockStart() const override
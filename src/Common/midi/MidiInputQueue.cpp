@@ -0,0 +1,64 @@
+#include "MidiInputQueue.h"
+
+#include <QElapsedTimer>
+
+using midi::MidiInputQueue;
+using midi::MidiMessage;
+
+namespace {
+
+QElapsedTimer startClock()
+{
+    QElapsedTimer clock;
+    clock.start();
+    return clock;
+}
+
+} // namespace
+
+MidiInputQueue::MidiInputQueue(size_t capacity) :
+    events(capacity)
+{
+
+}
+
+qint64 MidiInputQueue::getTimestamp()
+{
+    static const QElapsedTimer clock = startClock(); // thread safe initialization, the first call can be in the MIDI or audio thread
+    return clock.nsecsElapsed();
+}
+
+bool MidiInputQueue::push(const MidiMessage &message, qint64 timestamp)
+{
+    return events.try_enqueue(Event{message, timestamp}); // never allocate, the capacity is reserved in constructor
+}
+
+void MidiInputQueue::consume(std::vector<MidiMessage> &messages, qint64 now, quint32 frames, int sampleRate)
+{
+    if (frames == 0 || sampleRate <= 0)
+        return;
+
+    const qint64 blockPeriod = Q_INT64_C(1000000000) * frames / sampleRate;
+    const qint64 blockStart = now - blockPeriod;
+
+    Event *event;
+    while (messages.size() < messages.capacity() && (event = events.peek()) != nullptr) {
+        if (event->timestamp > now)
+            break; // received while consuming, played in the next block
+
+        quint32 offset = 0; // old messages (audio blocks lost, for example) are played in the block start
+        if (event->timestamp > blockStart)
+            offset = qMin(static_cast<quint32>((event->timestamp - blockStart) * sampleRate / Q_INT64_C(1000000000)), frames - 1);
+
+        MidiMessage message(event->message);
+        message.setSampleOffset(offset);
+
+        // insertion keeping the messages of all devices ordered, the VST events must be sorted by deltaFrames
+        auto position = messages.end();
+        while (position != messages.begin() && (position - 1)->getSampleOffset() > offset)
+            --position;
+        messages.insert(position, message); // no allocation, capacity is checked above
+
+        events.pop();
+    }
+}
@@ -0,0 +1,49 @@
+#ifndef MIDI_INPUT_QUEUE_H
+#define MIDI_INPUT_QUEUE_H
+
+#include <QtGlobal>
+#include <vector>
+
+#include "MidiMessage.h"
+#include "audio/readerwriterqueue.h"
+
+namespace midi {
+
+/**
+    Lock-free single producer, single consumer queue of timestamped MIDI messages. The messages
+    received by one MIDI input device are pushed by the MIDI driver thread and consumed by the
+    audio thread, without locks or memory allocations in both sides.
+
+    The messages received in the last audio block period are spread in the next block using
+    the receiving time, so the VSTi are playing the notes with the same timing of the player (with
+    a constant latency of one block) instead of quantizing them to the block start.
+*/
+
+class MidiInputQueue
+{
+public:
+    explicit MidiInputQueue(size_t capacity = MAX_MESSAGES_PER_BUFFER);
+
+    bool push(const MidiMessage &message, qint64 timestamp); // producer thread, false if the queue is full (the message is dropped)
+
+    // consumer thread, insert the messages received until 'now' in 'messages' (ordered by sample offset).
+    // Stop when the reserved capacity of 'messages' is used, the remaining messages are consumed in the next block
+    void consume(std::vector<MidiMessage> &messages, qint64 now, quint32 frames, int sampleRate);
+
+    static qint64 getTimestamp(); // ns, monotonic clock used by producer and consumer
+
+private:
+    Q_DISABLE_COPY(MidiInputQueue)
+
+    struct Event
+    {
+        MidiMessage message;
+        qint64 timestamp;
+    };
+
+    moodycamel::ReaderWriterQueue<Event> events;
+};
+
+} // namespace
+
+#endif // MIDI_INPUT_QUEUE_H
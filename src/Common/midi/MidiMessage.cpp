@@ -6,7 +6,8 @@ using midi::MidiMessage;
 
 MidiMessage::MidiMessage(qint32 data, int sourceID) :
     data(data),
-    sourceID(sourceID)
+    sourceID(sourceID),
+    sampleOffset(0)
 {
 
 }
@@ -6,6 +6,9 @@
 
 namespace midi {
 
+// capacity reserved in midi buffers used by the audio thread, so push_back() will not allocate memory while processing audio
+const size_t MAX_MESSAGES_PER_BUFFER = 512;
+
 class MidiMessage
 {
 
@@ -28,6 +31,9 @@ public:
 
     int getSourceDeviceIndex() const;
 
+    quint32 getSampleOffset() const; // position in the audio block, used by VSTi and AU to play the events sample accurate
+    void setSampleOffset(quint32 offset);
+
     int getStatus() const;
 
     int getData1() const;
@@ -39,6 +45,7 @@ public:
 private:
     qint32 data;
     int sourceID; // the id of the midi device generating the message.
+    quint32 sampleOffset;
 };
 
 inline int MidiMessage::getChannel() const
@@ -51,6 +58,16 @@ inline int MidiMessage::getSourceDeviceIndex() const
     return sourceID;
 }
 
+inline quint32 MidiMessage::getSampleOffset() const
+{
+    return sampleOffset;
+}
+
+inline void MidiMessage::setSampleOffset(quint32 offset)
+{
+    sampleOffset = offset;
+}
+
 inline int MidiMessage::getStatus() const
 {
     return data & 0xFF;
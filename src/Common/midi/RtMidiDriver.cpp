@@ -67,6 +67,7 @@ void RtMidiDriver::setDevicesStatus(const QList<bool> &inputStatuses, const QLis
 
     for (int s = 0; s < validInputStatuses.size(); ++s) {
         midiInStreams.append(new RtMidiIn());
+        midiInputs.append(new MidiInput(s));
     }
     for (int s = 0; s < validOutputStatuses.size(); ++s) {
         midiOutStreams.append(new RtMidiOut());
@@ -91,6 +92,7 @@ void RtMidiDriver::start(const QList<bool> &inputDeviceStatuses, const QList<boo
                     try {
                         qCInfo(jtMidi) << "Starting MIDI Input in " << QString::fromStdString(stream->getPortName(deviceIndex));
                         stream->ignoreTypes();// ignoring sysex, miditime and midi sense messages
+                        stream->setCallback(&RtMidiDriver::receiveMidiMessage, midiInputs.at(deviceIndex)); // the messages are pushed in RtMidi thread, the audio thread is not polling the devices
                         stream->openPort(deviceIndex);
                     }
                     catch (RtMidiError &e) {
@@ -165,6 +167,9 @@ void RtMidiDriver::release(){
     }
     midiInStreams.clear();
     midiOutStreams.clear();
+
+    qDeleteAll(midiInputs); // the callbacks are not called after the streams deletion
+    midiInputs.clear();
 }
 
 QString RtMidiDriver::getInputDeviceName(uint index) const{
@@ -197,22 +202,24 @@ void RtMidiDriver::sendClockPulse() const{
     sendMessageToOutputs({248});
 }
 
-void RtMidiDriver::consumeMessagesFromStream(RtMidiIn *stream, int deviceIndex, std::vector<midi::MidiMessage> &outBuffer)
+void RtMidiDriver::receiveMidiMessage(double deltaTime, std::vector<unsigned char> *message, void *midiInput)
 {
-    //qCDebug(jtMidi) << "consuming messages from stream - RtMidiDriver";
-    std::vector<unsigned char> messageBytes;
-    do {
-        messageBytes.clear();
-        stream->getMessage(&messageBytes);
-        if (messageBytes.size() == 3) { // Jamtaba is handling only the 3 bytes common midi messages. Uncommon midi messages will be ignored.
-            outBuffer.push_back(midi::MidiMessage::fromVector(messageBytes, deviceIndex));
-        }
-        else {
-            if (!messageBytes.empty())
-                qWarning() << "A midi message containing " << messageBytes.size() << " bytes was received!";
-        }
+    Q_UNUSED(deltaTime) // the audio thread is using the same clock to compute the sample offsets
+
+    const qint64 timestamp = MidiInputQueue::getTimestamp();
+
+    if (!message || !midiInput)
+        return;
+
+    if (message->size() != 3) { // Jamtaba is handling only the 3 bytes common midi messages. Uncommon midi messages will be ignored.
+        if (!message->empty())
+            qWarning() << "A midi message containing " << message->size() << " bytes was received!";
+        return;
     }
-    while (!messageBytes.empty());
+
+    auto input = static_cast<MidiInput *>(midiInput);
+    if (!input->queue.push(midi::MidiMessage::fromVector(*message, input->deviceIndex), timestamp))
+        qCWarning(jtMidi) << "MIDI input queue is full, message dropped!";
 }
 
 void RtMidiDriver::sendMessageToOutputs(const std::vector<unsigned char> message) const {
@@ -227,15 +234,11 @@ void RtMidiDriver::sendMessageToOutputs(const std::vector<unsigned char> message
     }
 }
 
-std::vector<MidiMessage> RtMidiDriver::getBuffer()
+void RtMidiDriver::consumeMessages(std::vector<MidiMessage> &messages, quint32 frames, int sampleRate)
 {
-    std::vector<midi::MidiMessage> buffer;
-    int deviceIndex = 0;
-    for (auto stream : midiInStreams) {
-        consumeMessagesFromStream(stream, deviceIndex, buffer);
-        deviceIndex++;
-    }
-    return buffer;
+    const qint64 now = MidiInputQueue::getTimestamp();
+    for (auto midiInput : midiInputs)
+        midiInput->queue.consume(messages, now, frames, sampleRate);
 }
 
 bool RtMidiDriver::hasInputDevices() const{
@@ -2,6 +2,7 @@
 #define RTMIDIDRIVER_H
 
 #include "MidiDriver.h"
+#include "MidiInputQueue.h"
 #include "RtMidi.h"
 
 namespace midi {
@@ -24,7 +25,7 @@ public:
     int getMaxOutputDevices() const override;
     QString getInputDeviceName(uint index) const override;
     QString getOutputDeviceName(uint index) const override;
-    std::vector<midi::MidiMessage> getBuffer() override;
+    void consumeMessages(std::vector<midi::MidiMessage> &messages, quint32 frames, int sampleRate) override;
 
     void sendClockStart() const override;
     void sendClockStop() const override;
@@ -32,10 +33,19 @@ public:
     void sendClockPulse() const override;
 
 private:
+    struct MidiInput // the messages are received in RtMidi thread and consumed in audio thread
+    {
+        explicit MidiInput(int deviceIndex) : deviceIndex(deviceIndex) {}
+
+        MidiInputQueue queue;
+        int deviceIndex;
+    };
+
     QList<RtMidiIn *> midiInStreams;
     QList<RtMidiOut *> midiOutStreams;
+    QList<MidiInput *> midiInputs; // one for each input stream
 
-    void consumeMessagesFromStream(RtMidiIn *stream, int deviceIndex, std::vector<MidiMessage> &outBuffer);
+    static void receiveMidiMessage(double deltaTime, std::vector<unsigned char> *message, void *midiInput); // RtMidiIn callback
     void sendMessageToOutputs(const std::vector<unsigned char> message) const;
 };
 }
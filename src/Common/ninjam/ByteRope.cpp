@@ -0,0 +1,129 @@
+#include "ByteRope.h"
+
+#include <QIODevice>
+#include <cstring>
+
+using ninjam::ByteRope;
+using ninjam::ByteRopeReader;
+
+ByteRope::ByteRope() :
+    totalBytes(0)
+{
+
+}
+
+ByteRope::ByteRope(const QByteArray &chunk) :
+    totalBytes(0)
+{
+    append(chunk);
+}
+
+void ByteRope::append(const QByteArray &chunk)
+{
+    if (chunk.isEmpty())
+        return;
+
+    chunks.append(chunk); // shared, not copied
+    totalBytes += chunk.size();
+}
+
+void ByteRope::append(const ByteRope &other)
+{
+    chunks.append(other.chunks);
+    totalBytes += other.totalBytes;
+}
+
+void ByteRope::clear()
+{
+    chunks.clear();
+    totalBytes = 0;
+}
+
+QByteArray ByteRope::toByteArray() const
+{
+    if (chunks.size() == 1)
+        return chunks.first(); // no copy
+
+    QByteArray array;
+    array.reserve(totalBytes);
+    for (const auto &chunk : chunks)
+        array.append(chunk);
+
+    return array;
+}
+
+bool ByteRope::writeTo(QIODevice *device) const
+{
+    for (const auto &chunk : chunks) {
+        if (device->write(chunk) != chunk.size())
+            return false;
+    }
+
+    return true;
+}
+
+// ++++++++++++++++++++++++++++++++++++++++
+
+ByteRopeReader::ByteRopeReader() :
+    chunkIndex(0),
+    chunkOffset(0),
+    availableBytes(0)
+{
+
+}
+
+ByteRopeReader::ByteRopeReader(const ByteRope &data) :
+    ByteRopeReader()
+{
+    append(data);
+}
+
+void ByteRopeReader::append(const ByteRope &data)
+{
+    chunks.append(data.getChunks());
+    availableBytes += data.size();
+}
+
+void ByteRopeReader::append(const QByteArray &chunk)
+{
+    if (chunk.isEmpty())
+        return;
+
+    chunks.append(chunk);
+    availableBytes += chunk.size();
+}
+
+void ByteRopeReader::clear()
+{
+    chunks.clear();
+    chunkIndex = 0;
+    chunkOffset = 0;
+    availableBytes = 0;
+}
+
+int ByteRopeReader::read(char *data, int maxBytes)
+{
+    int readedBytes = 0;
+    while (readedBytes < maxBytes && chunkIndex < chunks.size()) {
+        const QByteArray &chunk = chunks.at(chunkIndex);
+        const int bytesToCopy = qMin(maxBytes - readedBytes, chunk.size() - chunkOffset);
+        std::memcpy(data + readedBytes, chunk.constData() + chunkOffset, static_cast<size_t>(bytesToCopy));
+        readedBytes += bytesToCopy;
+        chunkOffset += bytesToCopy;
+
+        if (chunkOffset == chunk.size()) {
+            chunks[chunkIndex] = QByteArray(); // releasing the consumed chunk
+            chunkIndex++;
+            chunkOffset = 0;
+        }
+    }
+
+    if (chunkIndex == chunks.size()) { // all chunks consumed, the list can be reused
+        chunks.clear();
+        chunkIndex = 0;
+    }
+
+    availableBytes -= readedBytes;
+
+    return readedBytes;
+}
@@ -0,0 +1,89 @@
+#ifndef NINJAM_BYTE_ROPE_H
+#define NINJAM_BYTE_ROPE_H
+
+#include <QByteArray>
+#include <QVector>
+#include <QMetaType>
+
+class QIODevice;
+
+namespace ninjam {
+
+/**
+    The encoded data of a downloaded interval, stored as a list of chunks (the payload of each
+    DownloadIntervalWrite message) instead of a contiguous array. Appending a chunk never copy
+    the bytes, and copying a rope only increments reference counts (the chunks and the
+    chunks list are implicitly shared), so the downloads, the decoders and the recorder
+    can share the same interval without copies.
+*/
+
+class ByteRope
+{
+public:
+    ByteRope();
+    explicit ByteRope(const QByteArray &chunk);
+
+    void append(const QByteArray &chunk);
+    void append(const ByteRope &other);
+
+    void clear();
+
+    inline int size() const
+    {
+        return totalBytes;
+    }
+
+    inline bool isEmpty() const
+    {
+        return totalBytes == 0;
+    }
+
+    inline const QVector<QByteArray> &getChunks() const
+    {
+        return chunks;
+    }
+
+    QByteArray toByteArray() const; // copy all chunks in a contiguous array, use only when the consumer needs a contiguous array
+
+    bool writeTo(QIODevice *device) const;
+
+private:
+    QVector<QByteArray> chunks;
+    int totalBytes;
+};
+
+/**
+    Sequential reader for ByteRope, more chunks can be appended while reading (voice chat). The consumed
+    chunks are released, so the memory is freed while the interval is decoded.
+*/
+
+class ByteRopeReader
+{
+public:
+    ByteRopeReader();
+    explicit ByteRopeReader(const ByteRope &data);
+
+    void append(const ByteRope &data);
+    void append(const QByteArray &chunk);
+
+    void clear();
+
+    int read(char *data, int maxBytes); // return the readed bytes
+
+    inline int bytesAvailable() const
+    {
+        return availableBytes;
+    }
+
+private:
+    QVector<QByteArray> chunks;
+    int chunkIndex; // the chunk containing the read cursor
+    int chunkOffset;
+    int availableBytes;
+};
+
+} // namespace
+
+Q_DECLARE_METATYPE(ninjam::ByteRope)
+
+#endif // NINJAM_BYTE_ROPE_H
@@ -0,0 +1,140 @@
+#include "MessageFramer.h"
+
+#include <QIODevice>
+#include <QtEndian>
+#include <QDebug>
+#include <cstring>
+
+using ninjam::MessageFramer;
+using ninjam::MessageView;
+using ninjam::MessageType;
+
+const int MessageFramer::HEADER_SIZE = 5;
+const quint32 MessageFramer::MAX_PAYLOAD = 16 * 1024 * 1024;
+const int MessageFramer::READ_BLOCK_SIZE = 64 * 1024;
+
+MessageView::MessageView() :
+    messageType(MessageType::Invalid),
+    payload(nullptr),
+    payloadSize(0)
+{
+
+}
+
+MessageView::MessageView(MessageType messageType, const char *payload, quint32 payloadSize) :
+    messageType(messageType),
+    payload(payload),
+    payloadSize(payloadSize)
+{
+
+}
+
+QByteArray MessageView::toByteArray() const
+{
+    return QByteArray(payload, static_cast<int>(payloadSize));
+}
+
+// ++++++++++++++++++++++++++++++++++++++++
+
+MessageFramer::MessageFramer(quint32 maxPayload) :
+    readPosition(0),
+    writePosition(0),
+    maxPayload(qMin(maxPayload, MAX_PAYLOAD)),
+    error(false)
+{
+
+}
+
+void MessageFramer::clear()
+{
+    readPosition = 0;
+    writePosition = 0;
+    error = false;
+}
+
+int MessageFramer::getRequiredBytes() const
+{
+    const int bufferedBytes = getBufferedBytes();
+    if (bufferedBytes < HEADER_SIZE)
+        return HEADER_SIZE - bufferedBytes;
+
+    const quint32 payload = qFromLittleEndian<quint32>(reinterpret_cast<const uchar *>(buffer.constData() + readPosition + 1));
+    if (payload > maxPayload)
+        return 0;
+
+    return qMax(HEADER_SIZE + static_cast<int>(payload) - bufferedBytes, 0);
+}
+
+void MessageFramer::reserve(int bytes)
+{
+    if (buffer.size() - writePosition >= bytes)
+        return;
+
+    const int bufferedBytes = getBufferedBytes();
+    if (readPosition > 0) { // discard the consumed messages
+        std::memmove(buffer.data(), buffer.constData() + readPosition, static_cast<size_t>(bufferedBytes));
+        readPosition = 0;
+        writePosition = bufferedBytes;
+    }
+
+    if (buffer.size() - writePosition < bytes)
+        buffer.resize(qMax(buffer.size() * 2, writePosition + bytes));
+}
+
+qint64 MessageFramer::readFrom(QIODevice *device)
+{
+    Q_ASSERT(device);
+
+    const qint64 available = device->bytesAvailable();
+    if (available <= 0 || error)
+        return 0;
+
+    reserve(qMax(READ_BLOCK_SIZE, getRequiredBytes())); // the incomplete message is completed in one read when possible
+
+    const qint64 bytesToRead = qMin(available, static_cast<qint64>(buffer.size() - writePosition));
+    const qint64 readedBytes = device->read(buffer.data() + writePosition, bytesToRead);
+    if (readedBytes <= 0)
+        return 0;
+
+    writePosition += static_cast<int>(readedBytes);
+
+    return readedBytes;
+}
+
+void MessageFramer::append(const char *data, int size)
+{
+    if (size <= 0)
+        return;
+
+    reserve(size);
+    std::memcpy(buffer.data() + writePosition, data, static_cast<size_t>(size));
+    writePosition += size;
+}
+
+bool MessageFramer::next(MessageView &message)
+{
+    const int bufferedBytes = getBufferedBytes();
+    if (error || bufferedBytes < HEADER_SIZE)
+        return false;
+
+    const char *header = buffer.constData() + readPosition;
+    const quint32 payload = qFromLittleEndian<quint32>(reinterpret_cast<const uchar *>(header + 1));
+    if (payload > maxPayload) {
+        qCritical() << "Invalid NINJAM message, payload:" << payload << "bytes, message type:" << static_cast<quint8>(header[0]);
+        error = true;
+        return false;
+    }
+
+    if (static_cast<quint32>(bufferedBytes - HEADER_SIZE) < payload)
+        return false; // waiting for the complete payload
+
+    message = MessageView(static_cast<MessageType>(static_cast<quint8>(header[0])), header + HEADER_SIZE, payload);
+
+    readPosition += HEADER_SIZE + static_cast<int>(payload);
+    if (readPosition == writePosition) { // all messages consumed, the next read will use the buffer start (the bytes are not changed until the next read)
+        readPosition = 0;
+        writePosition = 0;
+    }
+
+    return true;
+}
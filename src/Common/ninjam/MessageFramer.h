@@ -0,0 +1,97 @@
+#ifndef NINJAM_MESSAGE_FRAMER_H
+#define NINJAM_MESSAGE_FRAMER_H
+
+#include <QByteArray>
+#include "ninjam/Ninjam.h"
+
+class QIODevice;
+
+namespace ninjam {
+
+/**
+    A complete received message: the message type and the payload bytes, still in the
+    MessageFramer receive buffer. The payload is parsed in place with NinjamInputDataStream.
+*/
+
+class MessageView
+{
+public:
+    MessageView();
+    MessageView(MessageType messageType, const char *payload, quint32 payloadSize);
+
+    inline MessageType getMessageType() const
+    {
+        return messageType;
+    }
+
+    inline const char *getPayload() const
+    {
+        return payload;
+    }
+
+    inline quint32 getPayloadSize() const
+    {
+        return payloadSize;
+    }
+
+    QByteArray toByteArray() const; // copy the payload, used when the message is handled after the next MessageFramer read
+
+private:
+    MessageType messageType;
+    const char *payload;
+    quint32 payloadSize;
+};
+
+/**
+    Split the bytes received from the socket in NINJAM messages. The socket is readed in big
+    blocks (one read for many messages) into a contiguous receive buffer, and the complete
+    messages are returned as views to this buffer.
+
+    The buffer is not a ring, a message crossing the ring end would need a copy to be parsed in
+    place. When the free space in the buffer end is not enough the incomplete message (the only
+    bytes not consumed) is moved to the buffer start, and the buffer grows only to fit messages
+    bigger than the buffer.
+
+    The views returned by next() are valid until the next readFrom() or append() call.
+*/
+
+class MessageFramer
+{
+public:
+    explicit MessageFramer(quint32 maxPayload = MAX_PAYLOAD);
+
+    qint64 readFrom(QIODevice *device); // read one block, return the readed bytes (0 when nothing is available)
+    void append(const char *data, int size); // the bytes are not received from a device (tests, replays)
+
+    bool next(MessageView &message); // return false when the next message is not complete
+
+    void clear();
+
+    inline bool hasError() const // received a header bigger than 'maxPayload', the connection is corrupted or malicious
+    {
+        return error;
+    }
+
+    inline int getBufferedBytes() const
+    {
+        return writePosition - readPosition;
+    }
+
+    static const int HEADER_SIZE; // message type (1 byte) + payload (4 bytes)
+    static const quint32 MAX_PAYLOAD;
+    static const int READ_BLOCK_SIZE; // min free space before each socket read
+
+private:
+    void reserve(int bytes); // free space for 'bytes' after the last received byte
+    int getRequiredBytes() const; // bytes to complete the incomplete message
+
+    QByteArray buffer;
+    int readPosition; // the first byte not consumed
+    int writePosition; // after the last received byte
+    const quint32 maxPayload;
+    bool error;
+};
+
+} // namespace
+
+#endif // NINJAM_MESSAGE_FRAMER_H
@@ -6,8 +6,11 @@
 #include <QDataStream>
 #include <QString>
 #include <QByteArray>
+#include <QStringList>
+#include <QtEndian>
 #include <array>
 #include <cstring>
+#include <type_traits>
 
 namespace ninjam {
 
@@ -138,22 +141,29 @@ public:
     }
 };
 
-class NinjamInputDataStream final : private QDataStream {
+/**
+    Read the fields of a received message directly from the payload bytes (a MessageView in the
+    MessageFramer receive buffer, or a QByteArray). Nothing is copied until the values are
+    materialized (QString, QByteArray), and the strings are converted from the payload bytes
+    without intermediate byte arrays.
+*/
+
+class NinjamInputDataStream final {
 private:
+    const char *data; // current read position
     quint32 remainingPayload;
 
     inline void consumeRemainingPayload(quint32 size) {
+        data += size;
         remainingPayload -= size;
     }
 
 public:
-    NinjamInputDataStream(const QByteArray& buffer, quint32 remainingPayload)
-        : QDataStream(buffer), remainingPayload(remainingPayload) {
-        setByteOrder(LittleEndian);
+    NinjamInputDataStream(const char *data, quint32 remainingPayload)
+        : data(data), remainingPayload(remainingPayload) {
     }
-    NinjamInputDataStream(QIODevice *device, quint32 remainingPayload)
-        : QDataStream(device), remainingPayload(remainingPayload) {
-        setByteOrder(LittleEndian);
+    NinjamInputDataStream(const QByteArray& buffer, quint32 remainingPayload)
+        : data(buffer.constData()), remainingPayload(qMin(remainingPayload, static_cast<quint32>(buffer.size()))) {
     }
     NinjamInputDataStream(const NinjamInputDataStream&) = delete;
     void operator=(const NinjamInputDataStream&) = delete;
@@ -163,38 +173,25 @@ public:
     inline bool hasRemainingPayload(quint32 size) const {
         return size <= remainingPayload;
     }
+    inline const char* getData() const {
+        return data;
+    }
     bool skipRemainingPayload() {
-        if (remainingPayload != 0) {
-            int skipped = QDataStream::skipRawData(remainingPayload);
-            if (skipped != -1) {
-                remainingPayload -= skipped;
-                return remainingPayload == 0;
-            }
-            qWarning() << "NinjamInputDataStream::skipRemainingPayload failed." <<
-                          "Len: " << remainingPayload;
-            return false;
-        }
+        consumeRemainingPayload(remainingPayload);
         return true;
     }
     bool skip(int len) {
-        if (hasRemainingPayload(len)) {
-            int skipped = QDataStream::skipRawData(len);
-            if (skipped != -1) {
-                consumeRemainingPayload(skipped);
-                return skipped == len;
-            }
-            qWarning() << "NinjamInputDataStream::skip failed." << "Len: " << len;
+        if (len >= 0 && hasRemainingPayload(len)) {
+            consumeRemainingPayload(len);
+            return true;
         }
         return false;
     }
-    bool readRawData(char* data, int len) {
-        if (hasRemainingPayload(len)) {
-            int readed = QDataStream::readRawData(data, len);
-            if (readed != -1) {
-                consumeRemainingPayload(readed);
-                return readed == len;
-            }
-            qWarning() << "NinjamInputDataStream::readRawData failed." << "Len: " << len;
+    bool readRawData(char* dest, int len) {
+        if (len >= 0 && hasRemainingPayload(len)) {
+            std::memcpy(dest, data, len);
+            consumeRemainingPayload(len);
+            return true;
         }
         return false;
     }
@@ -208,54 +205,36 @@ public:
     }
     template<class T>
     bool read(T& value) {
+        static_assert(std::is_integral<T>::value, "Only integer fields are supported");
         if (hasRemainingPayload(sizeof(T))) {
-            *this >> value;
-            QDataStream::Status result = status();
-            if (result == QDataStream::Ok) {
-                consumeRemainingPayload(sizeof(T));
-                return true;
-            }
-            qWarning() << "NinjamInputDataStream::read failed. Status: " << result;
+            value = qFromLittleEndian<T>(reinterpret_cast<const uchar *>(data));
+            consumeRemainingPayload(sizeof(T));
+            return true;
         }
         return false;
     }
     bool readAciiStringFixed(QString& value, quint32 size) {
-        QByteArray byteArray(size, Qt::Uninitialized);
-        if (readRawData(byteArray.data(), size)) {
-            value = byteArray;
-            return true;
-        }
-        return false;
+        return readUtf8StringFixed(value, size);
     }
     bool readUtf8StringFixed(QString& value, quint32 size) {
-        QByteArray byteArray(size, Qt::Uninitialized);
-        if (readRawData(byteArray.data(), size)) {
-            value = QString::fromUtf8(byteArray);
+        if (hasRemainingPayload(size)) {
+            value = QString::fromUtf8(data, static_cast<int>(qstrnlen(data, size))); // the fixed size strings can be NUL terminated
+            consumeRemainingPayload(size);
             return true;
         }
         return false;
     }
     bool readUtf8String(QString& value, bool allowNotTerminated = true) {
-        quint8 byte;
-        bool terminated = false;
-        QByteArray byteArray;
-        while (hasRemainingPayload(sizeof(byte))) {
-            *this >> byte;
-            QDataStream::Status result = status();
-            if (result != QDataStream::Ok) {
-                qWarning() << "NinjamInputDataStream::readUtf8String failed." <<
-                              " Status: " << result;
-                return false;
-            }
-            consumeRemainingPayload(sizeof(byte));
-            if (byte == '\0') {
-                terminated = true;
-                break;
-            }
-            byteArray.append(byte);
+        auto terminator = static_cast<const char *>(std::memchr(data, '\0', remainingPayload));
+        if (terminator) {
+            const quint32 size = static_cast<quint32>(terminator - data);
+            value = QString::fromUtf8(data, static_cast<int>(size));
+            consumeRemainingPayload(size + 1);
+            return true;
         }
-        if (terminated || allowNotTerminated) {
-            value = QString::fromUtf8(byteArray.data(), byteArray.size());
+        if (allowNotTerminated) {
+            value = QString::fromUtf8(data, static_cast<int>(remainingPayload));
+            consumeRemainingPayload(remainingPayload);
             return true;
         }
         qWarning() << "NinjamInputDataStream::readUtf8String failed." <<
@@ -263,24 +242,24 @@ public:
         return false;
     }
     bool readUtf8Strings(QStringList& value, quint32 size) {
-        QByteArray byteArray(size, Qt::Uninitialized);
-        if (!readRawData(byteArray.data(), size)) {
+        if (!hasRemainingPayload(size)) {
             return false;
         }
-        int index = byteArray.indexOf('\0');
-        if (index == -1) {
+        const char* end = data + size;
+        if (!std::memchr(data, '\0', size)) {
             qWarning() << "NinjamInputDataStream::readUtf8Strings failed. No zero terminator";
             return false; // or return single string?
         }
-        quint32 startIndex = 0;
-        do {
-            value.append(QString::fromUtf8(byteArray.data() + startIndex, index - startIndex));
-            startIndex = index + 1;
-            if (startIndex >= size) {
-                break;
+        const char* string = data;
+        while (string < end) {
+            auto terminator = static_cast<const char *>(std::memchr(string, '\0', static_cast<size_t>(end - string)));
+            if (!terminator) {
+                break; // not terminated bytes after the last string are ignored
             }
-            index = byteArray.indexOf('\0', startIndex);
-        } while (index != -1);
+            value.append(QString::fromUtf8(string, static_cast<int>(terminator - string)));
+            string = terminator + 1;
+        }
+        consumeRemainingPayload(size);
         return true;
     }
 };
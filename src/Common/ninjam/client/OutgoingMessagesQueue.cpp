@@ -0,0 +1,141 @@
+#include "OutgoingMessagesQueue.h"
+
+#include <QAbstractSocket>
+
+using ninjam::client::OutgoingMessagesQueue;
+using ninjam::MessageType;
+
+const qint64 OutgoingMessagesQueue::MAX_DEVICE_BUFFERED_BYTES = 32 * 1024;
+
+OutgoingMessagesQueue::OutgoingMessagesQueue(QObject *parent) :
+    QObject(parent),
+    flushScheduled(false)
+{
+    for (auto &queue : queues)
+        queue.data.reserve(4096); // the capacity is reused, no allocations in each flush
+}
+
+void OutgoingMessagesQueue::setDevice(QIODevice *device)
+{
+    if (this->device)
+        this->device->disconnect(this);
+
+    this->device = device;
+
+    if (device)
+        connect(device, &QIODevice::bytesWritten, this, &OutgoingMessagesQueue::handleBytesWritten);
+}
+
+OutgoingMessagesQueue::Priority OutgoingMessagesQueue::getPriority(MessageType messageType)
+{
+    switch (messageType) {
+    case MessageType::UploadIntervalBegin: // same priority of the interval chunks, the begin is sent before the chunks
+    case MessageType::UploadIntervalWrite:
+        return Priority::IntervalData;
+    case MessageType::ChatMessage:
+        return Priority::Chat;
+    default:
+        break;
+    }
+
+    return Priority::Control;
+}
+
+void OutgoingMessagesQueue::enqueue(const INetworkMessage &message)
+{
+    auto &queue = queues[static_cast<int>(getPriority(message.getMsgType()))];
+
+    message.serializeToBuffer(queue.data); // appending in the serialized messages of same priority
+    queue.messages++;
+
+    scheduleFlush();
+}
+
+void OutgoingMessagesQueue::scheduleFlush()
+{
+    if (!flushScheduled) {
+        flushScheduled = true;
+        QMetaObject::invokeMethod(this, "flush", Qt::QueuedConnection); // messages enqueued in this event loop iteration are sent together
+    }
+}
+
+void OutgoingMessagesQueue::handleBytesWritten()
+{
+    if (!isEmpty())
+        scheduleFlush(); // interval data waiting for space in socket buffer
+}
+
+qint64 OutgoingMessagesQueue::getDeviceBufferedBytes() const
+{
+    return device ? device->bytesToWrite() : 0;
+}
+
+void OutgoingMessagesQueue::flush()
+{
+    flushScheduled = false;
+
+    if (!device || !device->isOpen())
+        return; // not connected yet, the messages are sent in the next flush
+
+    int writtenMessages = 0;
+    for (int p = 0; p < PRIORITIES; ++p) {
+        auto &queue = queues[p];
+        if (queue.messages == 0)
+            continue;
+
+        if (p == static_cast<int>(Priority::IntervalData) && getDeviceBufferedBytes() >= MAX_DEVICE_BUFFERED_BYTES)
+            break; // upload is congested, interval data is written when the socket buffer is drained
+
+        device->write(queue.data);
+
+        writtenMessages += queue.messages;
+        statistics.bytes += queue.data.size();
+
+        queue.data.resize(0); // keeping the reserved capacity
+        queue.messages = 0;
+    }
+
+    if (writtenMessages == 0)
+        return;
+
+    auto socket = qobject_cast<QAbstractSocket *>(device.data());
+    if (socket)
+        socket->flush(); // all queued messages in one flush
+
+    statistics.messages += writtenMessages;
+    statistics.flushes++;
+    if (writtenMessages > 1)
+        statistics.coalescedMessages += writtenMessages;
+}
+
+void OutgoingMessagesQueue::clear()
+{
+    for (auto &queue : queues) {
+        queue.data.resize(0);
+        queue.messages = 0;
+    }
+}
+
+bool OutgoingMessagesQueue::isEmpty() const
+{
+    for (const auto &queue : queues) {
+        if (queue.messages > 0)
+            return false;
+    }
+
+    return true;
+}
+
+qint64 OutgoingMessagesQueue::getQueuedBytes() const
+{
+    qint64 bytes = 0;
+    for (const auto &queue : queues)
+        bytes += queue.data.size();
+
+    return bytes;
+}
+
+void OutgoingMessagesQueue::resetStatistics()
+{
+    statistics = Statistics();
+}
@@ -0,0 +1,104 @@
+#ifndef OUTGOING_MESSAGES_QUEUE_H
+#define OUTGOING_MESSAGES_QUEUE_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QPointer>
+#include <QIODevice>
+
+#include "ninjam/Ninjam.h"
+
+namespace ninjam {
+
+namespace client {
+
+/**
+    The messages sent to server are serialized in this queue and written in the socket at the end
+    of the current event loop iteration, so the messages produced in the same iteration (interval
+    chunks of all channels, chat, keep alive) are sent with one socket flush instead of one flush
+    per message.
+
+    Each message type has a priority. Control messages (authentication, channels, keep alive) and
+    chat are always written, the interval data is written only when the socket write buffer is
+    small. When the upload is congested the interval data waits in the queue and keep alives are
+    not delayed by the interval chunks already waiting in the socket buffer.
+*/
+
+class OutgoingMessagesQueue : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum class Priority
+    {
+        Control, // authentication, channels, keep alive
+        Chat,
+        IntervalData
+    };
+
+    struct Statistics
+    {
+        quint64 messages = 0;
+        quint64 bytes = 0;
+        quint64 flushes = 0; // socket flushes, one write syscall (or more for big buffers) in each flush
+        quint64 coalescedMessages = 0; // messages sent in a flush with other messages
+
+        inline quint64 getSavedFlushes() const
+        {
+            return messages - flushes;
+        }
+    };
+
+    explicit OutgoingMessagesQueue(QObject *parent = nullptr);
+
+    void setDevice(QIODevice *device);
+
+    void enqueue(const INetworkMessage &message);
+
+    void clear(); // discard the queued messages
+
+    bool isEmpty() const;
+    qint64 getQueuedBytes() const;
+
+    const Statistics &getStatistics() const;
+    void resetStatistics();
+
+    static Priority getPriority(MessageType messageType);
+
+    static const qint64 MAX_DEVICE_BUFFERED_BYTES; // interval data is not written when the device has more buffered bytes
+
+public slots:
+    void flush(); // write the queued messages now
+
+private slots:
+    void handleBytesWritten();
+
+private:
+    QPointer<QIODevice> device;
+
+    static const int PRIORITIES = 3;
+
+    struct PriorityQueue
+    {
+        QByteArray data; // serialized messages
+        int messages = 0;
+    };
+
+    PriorityQueue queues[PRIORITIES];
+
+    bool flushScheduled;
+    Statistics statistics;
+
+    qint64 getDeviceBufferedBytes() const;
+    void scheduleFlush();
+};
+
+inline const OutgoingMessagesQueue::Statistics &OutgoingMessagesQueue::getStatistics() const
+{
+    return statistics;
+}
+
+} // ns client
+} // ns ninjam
+
+#endif // OUTGOING_MESSAGES_QUEUE_H
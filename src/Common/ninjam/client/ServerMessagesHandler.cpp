@@ -20,47 +20,46 @@ void ServerMessagesHandler::initialize(QIODevice *device)
 {
     Q_ASSERT(device);
     this->device = device;
-    currentHeader = MessageHeader();
+    framer.clear();
 }
 
 void ServerMessagesHandler::handleAllMessages()
 {
     Q_ASSERT(device);
-    while (device->bytesAvailable() >= 5) { // consume all messages. Every ninjam message contains a 5 bytes header.
-        if (!currentHeader.isValid())
-            currentHeader = MessageHeader::from(device);
+    while (framer.readFrom(device) > 0) { // one block of received bytes, containing many messages
+        MessageView message;
+        while (framer.next(message)) // an incomplete message stay in the framer until more bytes are received
+            executeMessageHandler(message);
+    }
 
-        bool successfullyProcessed = executeMessageHandler(currentHeader);
-        if (successfullyProcessed)
-            currentHeader = MessageHeader(); // invalidate the current message header, a new header will be readed from socket in the next loop iteration
-        else
-            break; // an incomplete message was founded, break and wait until receive more bytes. The currentHeader will be used in the next iteration.
+    if (framer.hasError()) {
+        qCritical() << "Invalid data received from server, closing the connection";
+        framer.clear();
+        device->close();
     }
 }
 
-bool ServerMessagesHandler::executeMessageHandler(const MessageHeader &header)
+bool ServerMessagesHandler::executeMessageHandler(const MessageView &message)
 {
-    Q_ASSERT(header.isValid());
-
-    switch (header.getMessageType()) {
+    switch (message.getMessageType()) {
     case MessageType::AuthChallenge:
-        return handleMessage<AuthChallengeMessage>(header.getPayload());
+        return handleMessage<AuthChallengeMessage>(message);
     case MessageType::AuthReply:
-        return handleMessage<AuthReplyMessage>(header.getPayload());
+        return handleMessage<AuthReplyMessage>(message);
     case MessageType::ServerConfigChangeNotify:
-        return handleMessage<ConfigChangeNotifyMessage>(header.getPayload());
+        return handleMessage<ConfigChangeNotifyMessage>(message);
     case MessageType::UserInfoChangeNorify:
-        return handleMessage<UserInfoChangeNotifyMessage>(header.getPayload());
+        return handleMessage<UserInfoChangeNotifyMessage>(message);
     case MessageType::KeepAlive:
-        return handleMessage<common::KeepAliveMessage>(header.getPayload());
+        return handleMessage<common::KeepAliveMessage>(message);
     case MessageType::ChatMessage:
-        return handleMessage<ServerToClientChatMessage>(header.getPayload());
+        return handleMessage<ServerToClientChatMessage>(message);
     case MessageType::DownloadIntervalBegin:
-        return handleMessage<DownloadIntervalBegin>(header.getPayload());
+        return handleMessage<DownloadIntervalBegin>(message);
     case MessageType::DownloadIntervalWrite:
-        return handleMessage<DownloadIntervalWrite>(header.getPayload());
+        return handleMessage<DownloadIntervalWrite>(message);
     default:
-        qCritical() << "Can't handle the message code " << static_cast<quint8>(header.getMessageType());
+        qCritical() << "Can't handle the message code " << static_cast<quint8>(message.getMessageType());
     }
     return false;
 }
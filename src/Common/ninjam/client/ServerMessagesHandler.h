@@ -2,10 +2,10 @@
 #define SERVERMESSAGEPROCESSOR_H
 
 #include <QIODevice>
-#include <QDataStream>
 #include "log/Logging.h"
 #include "Service.h"
 #include "ninjam/Ninjam.h"
+#include "ninjam/MessageFramer.h"
 
 namespace ninjam
 {
@@ -26,29 +26,24 @@ namespace client
     protected:
         QIODevice *device;
         Service *service;
-        MessageHeader currentHeader; // the last messageHeader readed from socket
+        MessageFramer framer; // the received bytes, the messages are parsed in place
 
-        bool executeMessageHandler(const MessageHeader &header);
+        bool executeMessageHandler(const MessageView &message);
 
         template<class MessageClazz> // MessageClazz will be 'translated' to some class derived from ServerMessage
-        bool handleMessage(quint32 payload)
+        bool handleMessage(const MessageView &message)
         {
-            Q_ASSERT(device);
             Q_ASSERT(service);
 
-            bool allMessageDataIsAvailable = device->bytesAvailable() >= payload;
-            if (allMessageDataIsAvailable) {
-                MessageClazz msg;
-                NinjamInputDataStream stream(device, payload);
-                if (msg.unserializeFrom(stream)) {
-                    service->process(msg); // calling overload versions of 'process'
-                    return stream.skipRemainingPayload(); // the message was handled
-                }
-                qWarning() << "Failed parse message: " << (int)msg.getMsgType() <<
-                              " payload: " << payload;
-                stream.skipRemainingPayload();
+            MessageClazz msg;
+            NinjamInputDataStream stream(message.getPayload(), message.getPayloadSize());
+            if (msg.unserializeFrom(stream)) {
+                service->process(msg); // calling overload versions of 'process'
+                return true;
             }
-            return false; // the message was not handled
+            qWarning() << "Failed parse message: " << (int)msg.getMsgType() <<
+                          " payload: " << message.getPayloadSize();
+            return false;
         }
     };
 
@@ -71,7 +71,7 @@ public:
         return GUID;
     }
 
-    inline QByteArray getEncodedData() const
+    inline const ninjam::ByteRope &getEncodedData() const
     {
         return vorbisData;
     }
@@ -80,7 +80,7 @@ private:
     quint8 channelIndex;
     QString userFullName;
     MessageGuid GUID; // Global Unique ID
-    QByteArray vorbisData;
+    ninjam::ByteRope vorbisData; // the received chunks are shared with the decoders and recorders, not copied
     bool containsAudio; // audio or video?
 };
 
@@ -160,6 +160,7 @@ void Service::handleAllReceivedMessages()
 
 void Service::clear()
 {
+    outgoingMessages.clear();
     initialized = false;
     currentServer.reset();
 }
@@ -177,12 +178,17 @@ void Service::handleSocketConnection()
 {
     Q_ASSERT(socket);
     qCDebug(jtNinjamProtocol) << "socket connected on " << socket->peerName();
+    outgoingMessages.flush(); // messages enqueued before the connection
 }
 
 void Service::handleSocketDisconnection()
 {
     Q_ASSERT(socket);
     qCDebug(jtNinjamProtocol) << "socket disconnected from " << socket->peerName();
+
+    const auto &statistics = outgoingMessages.getStatistics();
+    qCDebug(jtNinjamProtocol) << statistics.messages << "messages sent in" << statistics.flushes << "flushes,"
+                              << statistics.getSavedFlushes() << "flushes saved";
     if (currentServer) {
         emit disconnectedFromServer(*currentServer);
     }
@@ -247,35 +253,17 @@ void Service::sendAdminCommand(const QString &message)
     sendMessageToServer(msg);
 }
 
-void Service::sendMessageToServer(const common::CommonMessage &message)
+void Service::sendMessageToServer(const INetworkMessage &message)
 {
     if (!socket) {
         return;
     }
 
-    NinjamOutputDataStream stream(socket);
-    message.serializeTo(stream);
+    outgoingMessages.enqueue(message); // written in the socket at the end of this event loop iteration
 
     QDebug debug = qDebug();
     message.printDebug(debug);
 
-    socket->flush();
-    lastSendTime = QDateTime::currentMSecsSinceEpoch();
-}
-
-void Service::sendMessageToServer(const ClientMessage &message)
-{
-    if (!socket) {
-        return;
-    }
-
-    NinjamOutputDataStream stream(socket);
-    message.serializeTo(stream);
-
-    QDebug debug = qDebug();
-    message.printDebug(debug);
-
-    socket->flush();
     lastSendTime = QDateTime::currentMSecsSinceEpoch();
 }
 
@@ -356,7 +344,7 @@ void Service::process(const DownloadIntervalWrite &msg)
             });
         }
         else if (msg.downloadIsComplete()) { // download is video
-            emit videoIntervalCompleted(user, download.getEncodedData());
+            emit videoIntervalCompleted(user, download.getEncodedData().toByteArray()); // the video decoder needs contiguous data
             downloads.remove(msg.getGUID());
         }
     } else {
@@ -437,9 +425,13 @@ void Service::startServerConnection(const QString &serverIp, int serverPort,
         socket->setSocketOption(QAbstractSocket::LowDelayOption, 1); // low delay socket, disabling Nagle's Algorithm
 
         setupSocketSignals();
+
+        outgoingMessages.setDevice(socket);
     }
     Q_ASSERT(socket);
 
+    outgoingMessages.resetStatistics();
+
     this->userName = userName;
     this->password = password;
     this->channels = channels;
@@ -457,6 +449,7 @@ void Service::disconnectFromServer(bool emitDisconnectedSignal)
         qCDebug(jtNinjamProtocol) << "disconnecting from " << socket->peerName();
         if (!emitDisconnectedSignal)
             socket->blockSignals(true); // avoid generate events when disconnecting/exiting
+        outgoingMessages.flush(); // the last enqueued messages are sent before disconnecting
         socket->disconnectFromHost();
     }
 }
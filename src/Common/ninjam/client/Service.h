@@ -3,7 +3,9 @@
 
 #include "log/Logging.h"
 #include "ninjam/Ninjam.h"
+#include "ninjam/ByteRope.h"
 #include "ninjam/common/CommonMessages.h"
+#include "ninjam/client/OutgoingMessagesQueue.h"
 
 #include <QtGlobal>
 #include <QScopedPointer>
@@ -78,6 +80,8 @@ namespace client
         long getTotalDownloadTransferRate() const;
         long getDownloadTransferRate(const QString userFullName, quint8 channelIndex) const;
 
+        const OutgoingMessagesQueue::Statistics &getOutgoingMessagesStatistics() const;
+
     signals:
         void userChannelCreated(const ninjam::client::User &user, const ninjam::client::UserChannel &channel);
         void userChannelRemoved(const ninjam::client::User &user, const ninjam::client::UserChannel &channel);
@@ -86,7 +90,7 @@ namespace client
         void serverBpiChanged(quint16 currentBpi, quint16 lastBpi);
         void serverBpmChanged(quint16 currentBpm);
         void serverInitialBpmBpiAvailable(quint16 bpm, quint16 bpi);
-        void audioIntervalCompleted(const ninjam::client::User &user, quint8 channelIndex, const QByteArray &encodedAudioData);
+        void audioIntervalCompleted(const ninjam::client::User &user, quint8 channelIndex, const ninjam::ByteRope &encodedAudioData);
         void videoIntervalCompleted(const ninjam::client::User &user, const QByteArray &encodedVideoData);
         void audioIntervalDownloading(const ninjam::client::User &user, quint8 channelIndex, const QByteArray &encodedAudioData, bool isFirstPart, bool isLastPart);
         void disconnectedFromServer(const ninjam::client::ServerInfo &server);
@@ -123,6 +127,7 @@ namespace client
         static const long DEFAULT_KEEP_ALIVE_PERIOD = 3000;
 
         QTcpSocket* socket;
+        OutgoingMessagesQueue outgoingMessages; // messages are coalesced and written once per event loop iteration
 
         static const QStringList botNames;
         static QStringList buildBotNamesList();
@@ -142,8 +147,7 @@ namespace client
         NetworkUsageMeasurer totalDownloadMeasurer;
         QMap<QString, QMap<quint8, NetworkUsageMeasurer>> channelDownloadMeasurers; // using userFullName as key in first QMap and channel ID as key in second map
 
-        void sendMessageToServer(const common::CommonMessage &message);
-        void sendMessageToServer(const ClientMessage &message);
+        void sendMessageToServer(const INetworkMessage &message);
         void handleUserChannels(const QString &userFullName, const QList<UserChannel> &remoteChannels);
         bool channelIsOutdate(const User &user, const UserChannel &serverChannel);
 
@@ -172,6 +176,11 @@ namespace client
         return totalUploadMeasurer.getTransferRate();
     }
 
+    inline const OutgoingMessagesQueue::Statistics &Service::getOutgoingMessagesStatistics() const
+    {
+        return outgoingMessages.getStatistics();
+    }
+
     inline QStringList Service::getBotNamesList()
     {
         return botNames;
@@ -0,0 +1,202 @@
+#include "ClientConnection.h"
+
+#include <QMutexLocker>
+#include <QtEndian>
+#include <QDebug>
+#include <cstring>
+
+using ninjam::server::ClientConnection;
+using ninjam::MessageFramer;
+using ninjam::MessageView;
+using ninjam::MessageType;
+
+namespace {
+
+const quint32 MAX_PAYLOAD = 4 * 1024 * 1024; // bigger messages are not sent by ninjam clients, the connection is corrupted or malicious
+const qint64 SOCKET_WRITE_BUFFER_SIZE = 64 * 1024; // the queued messages are moved to socket write buffer until this size
+
+} // namespace
+
+ClientConnection::ClientConnection(qintptr socketDescriptor, qint64 maxQueuedBytes) :
+    socketDescriptor(socketDescriptor),
+    socket(nullptr),
+    framer(MAX_PAYLOAD),
+    queuedBytes(0),
+    maxQueuedBytes(maxQueuedBytes),
+    flushScheduled(false),
+    evictedClient(false),
+    closed(false)
+{
+
+}
+
+ClientConnection::~ClientConnection()
+{
+
+}
+
+void ClientConnection::open()
+{
+    socket = new QTcpSocket(this);
+    if (!socket->setSocketDescriptor(socketDescriptor)) {
+        qCritical() << "Error opening client connection:" << socket->errorString();
+        emit disconnected(this);
+        return;
+    }
+
+    socket->setSocketOption(QAbstractSocket::LowDelayOption, 1); // the interval chunks are small, don't wait to group them
+
+    {
+        QMutexLocker locker(&mutex);
+        peerAddress = socket->peerAddress();
+    }
+
+    connect(socket, &QTcpSocket::readyRead, this, &ClientConnection::readMessages);
+    connect(socket, &QTcpSocket::disconnected, this, &ClientConnection::handleDisconnection);
+    connect(socket, &QTcpSocket::bytesWritten, this, [this](qint64 bytes) {
+        emit bytesSent(bytes);
+        flush(); // more space in socket write buffer
+    });
+
+    emit opened(this);
+
+    flush(); // messages sent before the socket creation
+    readMessages(); // data received before the signals are connected
+}
+
+void ClientConnection::close()
+{
+    bool slowClient = false;
+    {
+        QMutexLocker locker(&mutex);
+        closed = true;
+        slowClient = evictedClient;
+        sendQueue.clear();
+        queuedBytes = 0;
+    }
+
+    if (socket) {
+        socket->disconnect(this); // no more signals from this connection
+        if (slowClient)
+            socket->abort(); // don't wait to send the socket buffer to a slow client
+        else
+            socket->disconnectFromHost(); // pending data is sent before closing
+    }
+
+    emit connectionClosed(this);
+}
+
+QHostAddress ClientConnection::getPeerAddress() const
+{
+    QMutexLocker locker(&mutex);
+    return peerAddress;
+}
+
+qint64 ClientConnection::getQueuedBytes() const
+{
+    QMutexLocker locker(&mutex);
+    return queuedBytes;
+}
+
+bool ClientConnection::send(const QByteArray &messageData)
+{
+    QMutexLocker locker(&mutex);
+
+    if (closed || evictedClient)
+        return false;
+
+    if (queuedBytes + messageData.size() > maxQueuedBytes) {
+        evictedClient = true;
+        const qint64 bytes = queuedBytes;
+        sendQueue.clear();
+        queuedBytes = 0;
+        locker.unlock();
+
+        emit evicted(this, bytes);
+        return false;
+    }
+
+    sendQueue.enqueue(messageData);
+    queuedBytes += messageData.size();
+
+    if (!flushScheduled) {
+        flushScheduled = true;
+        QMetaObject::invokeMethod(this, "flush", Qt::QueuedConnection); // the socket is used only in I/O thread
+    }
+
+    return true;
+}
+
+void ClientConnection::flush()
+{
+    QMutexLocker locker(&mutex);
+    flushScheduled = false;
+
+    if (!socket || closed)
+        return;
+
+    while (!sendQueue.isEmpty() && socket->bytesToWrite() < SOCKET_WRITE_BUFFER_SIZE) {
+        const QByteArray messageData = sendQueue.dequeue();
+        queuedBytes -= messageData.size();
+
+        locker.unlock(); // other threads can enqueue while writing
+        socket->write(messageData);
+        locker.relock();
+    }
+}
+
+void ClientConnection::readMessages()
+{
+    if (!socket)
+        return;
+
+    qint64 receivedBytes = 0;
+    bool invalidMessage = false;
+
+    while (!invalidMessage) {
+        const qint64 readedBytes = framer.readFrom(socket);
+        if (readedBytes <= 0)
+            break;
+
+        receivedBytes += readedBytes;
+
+        MessageView message;
+        while (framer.next(message)) {
+            if (message.getMessageType() == MessageType::Invalid) {
+                invalidMessage = true;
+                break;
+            }
+
+            const quint32 payload = message.getPayloadSize();
+            if (message.getMessageType() == MessageType::UploadIntervalWrite) {
+                // UploadIntervalWrite and DownloadIntervalWrite payloads are identical, the payload is copied after
+                // a DownloadIntervalWrite header and the same buffer is sent to all clients
+                QByteArray messageData(MessageFramer::HEADER_SIZE + static_cast<int>(payload), Qt::Uninitialized);
+                messageData[0] = static_cast<char>(MessageType::DownloadIntervalWrite);
+                qToLittleEndian<quint32>(payload, reinterpret_cast<uchar *>(messageData.data() + 1));
+                std::memcpy(messageData.data() + MessageFramer::HEADER_SIZE, message.getPayload(), payload);
+
+                emit intervalDataReceived(this, messageData);
+            }
+            else {
+                emit messageReceived(this, static_cast<quint8>(message.getMessageType()), message.toByteArray()); // handled in the server thread, the payload is copied
+            }
+        }
+
+        invalidMessage = invalidMessage || framer.hasError();
+    }
+
+    if (invalidMessage) {
+        qWarning() << "Invalid message received from" << socket->peerAddress().toString() << ", closing the connection";
+        framer.clear();
+        socket->abort();
+    }
+
+    if (receivedBytes > 0)
+        emit bytesReceived(receivedBytes);
+}
+
+void ClientConnection::handleDisconnection()
+{
+    emit disconnected(this);
+}
@@ -0,0 +1,79 @@
+#ifndef _SERVER_CLIENT_CONNECTION_
+#define _SERVER_CLIENT_CONNECTION_
+
+#include <QObject>
+#include <QTcpSocket>
+#include <QHostAddress>
+#include <QQueue>
+#include <QMutex>
+
+#include "ninjam/Ninjam.h"
+#include "ninjam/MessageFramer.h"
+
+namespace ninjam {
+
+namespace server {
+
+/**
+    One connected client. The connection lives in one of the server I/O threads: the socket reads,
+    the message framing and the socket writes are executed in that thread, the server logic
+    (users, channels, votings) is executed in the server thread.
+
+    The messages sent to the client are stored in a bounded queue. The queue is drained when the
+    socket write buffer is small, so a client with a slow connection accumulate the messages in
+    the queue (shared buffers, not copies) instead of the socket buffer. When the queue is full the
+    client is evicted, otherwise a slow client would increase the server memory forever.
+*/
+
+class ClientConnection : public QObject
+{
+    Q_OBJECT
+
+public:
+    ClientConnection(qintptr socketDescriptor, qint64 maxQueuedBytes);
+    ~ClientConnection();
+
+    // thread safe, the data is shared by all receivers (serialized only once)
+    bool send(const QByteArray &messageData); // return false when the client was evicted
+
+    qint64 getQueuedBytes() const;
+    QHostAddress getPeerAddress() const;
+
+public slots:
+    void open(); // create the socket in the I/O thread
+    void close(); // connectionClosed is the last emitted signal, the connection can be deleted after it
+
+signals:
+    void opened(ninjam::server::ClientConnection *connection);
+    void messageReceived(ninjam::server::ClientConnection *connection, quint8 messageType, const QByteArray &payload);
+    void intervalDataReceived(ninjam::server::ClientConnection *connection, const QByteArray &downloadMessageData); // UploadIntervalWrite converted to DownloadIntervalWrite, ready to broadcast
+    void evicted(ninjam::server::ClientConnection *connection, qint64 queuedBytes);
+    void disconnected(ninjam::server::ClientConnection *connection);
+    void connectionClosed(ninjam::server::ClientConnection *connection);
+    void bytesReceived(qint64 bytes);
+    void bytesSent(qint64 bytes);
+
+private slots:
+    void readMessages();
+    void flush();
+    void handleDisconnection();
+
+private:
+    qintptr socketDescriptor;
+    QTcpSocket *socket;
+    MessageFramer framer; // the received bytes, an incomplete message is kept until the next read
+
+    mutable QMutex mutex; // protect the send queue and the peer address
+    QQueue<QByteArray> sendQueue;
+    qint64 queuedBytes;
+    const qint64 maxQueuedBytes;
+    bool flushScheduled;
+    bool evictedClient;
+    bool closed;
+    QHostAddress peerAddress;
+};
+
+} // ns server
+} // ns ninjam
+
+#endif
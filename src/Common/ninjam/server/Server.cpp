@@ -6,6 +6,7 @@
 #include <QNetworkInterface>
 #include <QDateTime>
 #include <QTcpServer>
+#include <QTcpSocket>
 
 #include "ninjam/Ninjam.h"
 #include "ninjam/common/CommonMessages.h"
@@ -17,6 +18,7 @@
 using ninjam::common::KeepAliveMessage;
 using ninjam::server::Server;
 using ninjam::server::Voting;
+using ninjam::server::ClientConnection;
 using ninjam::client::AuthChallengeMessage;     // TODO message used both in server and client
 using ninjam::client::ClientAuthUserMessage;    // todo message used both in server and client
 using ninjam::client::ClientSetChannel;         // used in both
@@ -45,6 +47,9 @@ enum AdminCommand
     kick
 };
 
+const int KEEP_ALIVE_CHECK_PERIOD = 1000; // ms
+const qint64 DEFAULT_MAX_QUEUED_BYTES_PER_CLIENT = 4 * 1024 * 1024;
+
 AdminCommand getAdminCommand(const QString &cmd)
 {
     QString command = cmd.split(" ").first();
@@ -65,7 +70,6 @@ AdminCommand getAdminCommand(const QString &cmd)
 }
 
 RemoteUser::RemoteUser() :
-    currentHeader(MessageHeader()),
     lastKeepAliveReceived(QDateTime::currentMSecsSinceEpoch()),
     receivedServerInfos(false)
 {
@@ -189,8 +193,33 @@ void Voting::reset()
 
 // -------------------------------------------------------------
 
+// accepting the socket descriptors, the sockets are created in the I/O threads
+class Server::Listener : public QTcpServer
+{
+public:
+    explicit Listener(Server *server) :
+        server(server)
+    {
+
+    }
+
+protected:
+    void incomingConnection(qintptr socketDescriptor) override
+    {
+        server->handleNewConnection(socketDescriptor);
+    }
+
+private:
+    Server *server;
+};
+
+// -------------------------------------------------------------
 
 Server::Server() :
+    tcpServer(new Listener(this)),
+    ioThreadsCount(0),
+    nextIOThread(0),
+    maxQueuedBytesPerClient(DEFAULT_MAX_QUEUED_BYTES_PER_CLIENT),
     bpm(120),
     bpi(16),
     topic("No topic!"),
@@ -200,13 +229,38 @@ Server::Server() :
     keepAlivePeriod(30),
     votingSettings({0.6, 10000}) // 60% for threshold, 60 seconds to vote expiration
 {
-    connect(&tcpServer, &QTcpServer::newConnection, this, &Server::handleNewConnection);
-    connect(&tcpServer, &QTcpServer::acceptError, this, &Server::handleAcceptError);
+    connect(tcpServer.data(), &QTcpServer::acceptError, this, &Server::handleAcceptError);
+
+    keepAliveTimer.setInterval(KEEP_ALIVE_CHECK_PERIOD);
+    connect(&keepAliveTimer, &QTimer::timeout, this, &Server::updateKeepAliveInfos);
 }
 
 Server::~Server()
 {
     shutdown();
+
+    for (auto thread : ioThreads) {
+        thread->quit();
+        thread->wait();
+    }
+
+    qDeleteAll(connections); // the I/O threads are finished, the closing connections can be deleted here
+    connections.clear();
+}
+
+void Server::setMaxUsers(quint16 maxUsers)
+{
+    this->maxUsers = maxUsers;
+}
+
+void Server::setIOThreads(int threads)
+{
+    ioThreadsCount = qMax(0, threads);
+}
+
+void Server::setMaxQueuedBytesPerClient(qint64 maxBytes)
+{
+    maxQueuedBytesPerClient = maxBytes;
 }
 
 void Server::bpiVotingIncremented(quint16 votingValue, quint16 currentVotes, quint16 requiredVotes, quint64 expirationTime)
@@ -269,7 +323,7 @@ void Server::bpmVotingExpired(quint16 bpmValue)
 
 bool Server::isStarted() const
 {
-    return tcpServer.isListening();
+    return tcpServer->isListening();
 }
 
 QHostAddress Server::getBestHostAddress()
@@ -281,41 +335,80 @@ void Server::start(quint16 port)
 {
     shutdown();
 
+    while (ioThreads.size() < ioThreadsCount) {
+        auto thread = new QThread(this);
+        thread->setObjectName(QString("Server I/O %1").arg(ioThreads.size()));
+        thread->start();
+        ioThreads.append(thread);
+    }
+
     QHostAddress address = Server::getBestHostAddress();
-    bool listening = tcpServer.listen(address, port);
-    if (listening)
+    bool listening = tcpServer->listen(address, port);
+    if (listening) {
+        keepAliveTimer.start();
         emit serverStarted();
-    else
-        emit errorStartingServer(tcpServer.errorString());
+    }
+    else {
+        emit errorStartingServer(tcpServer->errorString());
+    }
 }
 
-void Server::handleNewConnection()
+void Server::handleNewConnection(qintptr socketDescriptor)
 {
-    QTcpSocket *socket = tcpServer.nextPendingConnection();
-    if (!socket)
-        return;
-
     if (remoteUsers.size() >= maxUsers) {
+        auto socket = new QTcpSocket(this);
+        socket->setSocketDescriptor(socketDescriptor);
         socket->disconnectFromHost(); // reject the connection
+        socket->deleteLater();
         return;
     }
 
-    emit incommingConnection(socket->peerAddress().toString());
+    auto connection = new ClientConnection(socketDescriptor, maxQueuedBytesPerClient);
+
+    connect(connection, &ClientConnection::opened, this, &Server::handleConnectionOpened);
+    connect(connection, &ClientConnection::messageReceived, this, &Server::processMessage);
+    connect(connection, &ClientConnection::intervalDataReceived, this, &Server::processIntervalData);
+    connect(connection, &ClientConnection::disconnected, this, &Server::handleDisconnection);
+    connect(connection, &ClientConnection::connectionClosed, this, &Server::handleClosedConnection);
+
+    // always queued, the clients are evicted while broadcasting (iterating in remoteUsers)
+    connect(connection, &ClientConnection::evicted, this, &Server::handleEvictedClient, Qt::QueuedConnection);
 
-    connect(socket, &QTcpSocket::disconnected, this, &Server::handleDisconnection);
-    connect(socket, static_cast<void (QTcpSocket::*)(QAbstractSocket::SocketError)>(&QAbstractSocket::error), this, &Server::handleClientSocketError);
-    connect(socket, &QIODevice::readyRead, this, &Server::processReceivedBytes);
+    connect(connection, &ClientConnection::bytesReceived, this, [this](qint64 bytes){
+        totalDownloadMeasurer.addTransferedBytes(bytes);
+    });
 
-    connect(socket, &QTcpSocket::bytesWritten, [&](qint64 bytes){
+    connect(connection, &ClientConnection::bytesSent, this, [this](qint64 bytes){
         totalUploadMeasurer.addTransferedBytes(bytes);
     });
 
-    remoteUsers.insert(socket, RemoteUser());
+    if (!ioThreads.isEmpty()) {
+        connection->moveToThread(ioThreads.at(nextIOThread)); // round robin
+        nextIOThread = (nextIOThread + 1) % ioThreads.size();
+    }
+
+    connections.insert(connection);
+    remoteUsers.insert(connection, RemoteUser());
 
-    sendAuthChallenge(socket);
+    sendAuthChallenge(connection); // queued until the socket is opened
+
+    QMetaObject::invokeMethod(connection, "open", Qt::QueuedConnection);
+}
+
+void Server::handleConnectionOpened(ClientConnection *connection)
+{
+    if (remoteUsers.contains(connection))
+        emit incommingConnection(connection->getPeerAddress().toString());
+}
+
+void Server::sendMessage(ClientConnection *connection, const INetworkMessage &message)
+{
+    QByteArray messageData;
+    message.serializeToBuffer(messageData);
+    connection->send(messageData);
 }
 
-void Server::sendAuthChallenge(QTcpSocket *device)
+void Server::sendAuthChallenge(ClientConnection *connection)
 {
     QByteArray challenge("abcdabcd");
     quint32 protocolVersion = 0x00020000; // fixed value
@@ -323,29 +416,28 @@ void Server::sendAuthChallenge(QTcpSocket *device)
     if(!licence.isEmpty())
         serverCapabilities |= 1; // when server has licence the first bit is set.
 
-    auto msg = AuthChallengeMessage(challenge, licence, serverCapabilities, protocolVersion);
-    msg.serializeToDevice(device);
+    sendMessage(connection, AuthChallengeMessage(challenge, licence, serverCapabilities, protocolVersion));
 }
 
-void Server::processClientAuthUserMessage(QTcpSocket *socket, const ClientAuthUserMessage& msg)
+void Server::processClientAuthUserMessage(ClientConnection *connection, const ClientAuthUserMessage& msg)
 {
     // ignoring challenge and password for while
 
     quint8 flag = 1; // authentication suceeded
     QString newUserName(generateUniqueUserName(msg.getUserName())); // updated user name or error message;
-    newUserName += "@" + socket->peerAddress().toString();
+    newUserName += "@" + connection->getPeerAddress().toString();
 
-    remoteUsers[socket].setFullName(newUserName);
+    remoteUsers[connection].setFullName(newUserName);
 
     AuthReplyMessage authReply(flag, newUserName, maxChannels);
-    authReply.serializeToDevice(socket);
+    sendMessage(connection, authReply);
 
     if (authReply.userIsAuthenticated()) {
-        broadcastNetworkMessage(ServerToClientChatMessage::buildUserJoinMessage(newUserName), socket);
+        broadcastNetworkMessage(ServerToClientChatMessage::buildUserJoinMessage(newUserName), connection);
 
         emit userEntered(newUserName);
     } else {
-        disconnectClient(socket);
+        disconnectClient(connection);
     }
 }
 
@@ -381,27 +473,25 @@ QString Server::generateUniqueUserName(const QString &userName) const
     return newName;
 }
 
-void Server::sendServerInitialInfosTo(QTcpSocket *socket)
+void Server::sendServerInitialInfosTo(ClientConnection *connection)
 {
     // send server config change
-    auto configChange = ConfigChangeNotifyMessage(bpm, bpi);
-    configChange.serializeToDevice(socket);
+    sendMessage(connection, ConfigChangeNotifyMessage(bpm, bpi));
 
-    auto topicMessage = ServerToClientChatMessage::buildTopicMessage(topic);
-    topicMessage.serializeToDevice(socket);
+    sendMessage(connection, ServerToClientChatMessage::buildTopicMessage(topic));
 }
 
-void Server::processClientSetChannel(QTcpSocket *socket, const ClientSetChannel& msg)
+void Server::processClientSetChannel(ClientConnection *connection, const ClientSetChannel& msg)
 {
     /**
       ClientSetChannel is received after server/client handshake, it's the end of the initialization process. But this message is
       received while jamming too, when channels are added, removed or the channel name is changed.
     */
 
-    if (!remoteUsers.contains(socket))
+    if (!remoteUsers.contains(connection))
         return;
 
-    RemoteUser &user = remoteUsers[socket];
+    RemoteUser &user = remoteUsers[connection];
 
     // update remote user channels list
     user.updateChannels(msg.getChannels(), maxChannels);
@@ -410,23 +500,23 @@ void Server::processClientSetChannel(QTcpSocket *socket, const ClientSetChannel&
     broadcastUserChanges(user.getFullName(), user.getChannels());
     if (!user.receivedInitialServerInfos()) {
         // send everybody to connected remote user
-        sendConnectedUsersTo(socket);
+        sendConnectedUsersTo(connection);
 
         // send bpm, bpi and server topic to connected user
-        sendServerInitialInfosTo(socket);
+        sendServerInitialInfosTo(connection);
         user.setReceivedServerInfos();
 
         //QString message = QString("%1 has joined the room.").arg(user.getName());
-        //broadcastServerMessage(message, socket); // broadcast to everybody, except the connected user
+        //broadcastServerMessage(message, connection); // broadcast to everybody, except the connected user
     }
 }
 
-void Server::sendConnectedUsersTo(QTcpSocket *socket)
+void Server::sendConnectedUsersTo(ClientConnection *connection)
 {
-    if (!remoteUsers.contains(socket))
+    if (!remoteUsers.contains(connection))
         return;
 
-    const RemoteUser & connectedUser = remoteUsers[socket];
+    const RemoteUser & connectedUser = remoteUsers[connection];
 
     UserInfoChangeNotifyMessage msg;
 
@@ -439,22 +529,22 @@ void Server::sendConnectedUsersTo(QTcpSocket *socket)
         }
     }
 
-    msg.serializeToDevice(socket);
+    sendMessage(connection, msg);
 }
 
-void Server::broadcastNetworkData(const QByteArray& messageData, QTcpSocket *excludeSocket) {
+void Server::broadcastNetworkData(const QByteArray& messageData, ClientConnection *exclude) {
     for (auto iterator = remoteUsers.begin(); iterator != remoteUsers.end(); ++iterator) {
-        QTcpSocket* socket = iterator.key();
-        if (socket != excludeSocket) {
-            socket->write(messageData);
+        ClientConnection* connection = iterator.key();
+        if (connection != exclude) {
+            connection->send(messageData); // the data is shared, not copied
         }
     }
 }
 
-void Server::broadcastNetworkMessage(const INetworkMessage& message, QTcpSocket *excludeSocket) {
+void Server::broadcastNetworkMessage(const INetworkMessage& message, ClientConnection *exclude) {
     QByteArray broadcastMessageData;
     message.serializeToBuffer(broadcastMessageData);
-    broadcastNetworkData(broadcastMessageData, excludeSocket);
+    broadcastNetworkData(broadcastMessageData, exclude);
 }
 
 void Server::broadcastUserChanges(const QString userFullName, const QList<UserChannel> &userChannels)
@@ -467,29 +557,32 @@ void Server::broadcastUserChanges(const QString userFullName, const QList<UserCh
     QByteArray userChangesMessageData;
     msg.serializeToBuffer(userChangesMessageData);
 
-    for (auto socket : remoteUsers.keys()) {
-        if (remoteUsers[socket].getFullName() != userFullName) {
-            socket->write(userChangesMessageData);
+    for (auto iterator = remoteUsers.begin(); iterator != remoteUsers.end(); ++iterator) {
+        if (iterator.value().getFullName() != userFullName) {
+            iterator.key()->send(userChangesMessageData);
         }
     }
 }
 
-void Server::processUploadIntervalBegin(QTcpSocket *senderSocket, const UploadIntervalBegin &msg)
+void Server::processUploadIntervalBegin(ClientConnection *sender, const UploadIntervalBegin &msg)
 {
-    if (!remoteUsers.contains(senderSocket))
+    if (!remoteUsers.contains(sender))
         return;
 
-    auto senderFullName = remoteUsers[senderSocket].getFullName();
-    broadcastNetworkMessage(DownloadIntervalBegin::from(msg, senderFullName), senderSocket);
+    auto senderFullName = remoteUsers[sender].getFullName();
+    broadcastNetworkMessage(DownloadIntervalBegin::from(msg, senderFullName), sender);
 }
 
-void Server::processUploadIntervalWrite(QTcpSocket *senderSocket, const DownloadIntervalWrite &msg)
+void Server::processIntervalData(ClientConnection *sender, const QByteArray &downloadMessageData)
 {
-    if (!remoteUsers.contains(senderSocket))
+    auto iterator = remoteUsers.find(sender);
+    if (iterator == remoteUsers.end())
         return;
 
-    // parsing the DownloadIntervalWrite directly, because the message is identical to UploadIntervaWrite
-    broadcastNetworkMessage(msg, senderSocket);
+    iterator.value().setLastKeepAliveToNow();
+
+    // the UploadIntervalWrite was converted to DownloadIntervalWrite in the I/O thread, the message is not parsed here
+    broadcastNetworkData(downloadMessageData, sender);
 }
 
 void Server::broadcastVotingSystemMessage(const QString &message)
@@ -509,15 +602,13 @@ void Server::sendPrivateMessage(const QString &sender, const ClientToServerChatM
 {
     QString destinationUserName = receivedMessage.getArguments().at(0);
     if (!destinationUserName.contains("@"))
-        destinationUserName += "@" + tcpServer.serverAddress().toString();
+        destinationUserName += "@" + tcpServer->serverAddress().toString();
 
     QString text = receivedMessage.getArguments().at(1);
 
-    for (auto s : remoteUsers.keys()) {
-        const RemoteUser &user = remoteUsers[s];
-        if (user.getFullName() == destinationUserName) {
-            auto msg = ServerToClientChatMessage::buildPrivateMessage(sender, text);
-            msg.serializeToDevice(s);
+    for (auto iterator = remoteUsers.begin(); iterator != remoteUsers.end(); ++iterator) {
+        if (iterator.value().getFullName() == destinationUserName) {
+            sendMessage(iterator.key(), ServerToClientChatMessage::buildPrivateMessage(sender, text));
             break;
         }
     }
@@ -638,12 +729,12 @@ void Server::processBpmVoteMessage(const ninjam::client::ClientToServerChatMessa
     processVoteMessage(userFullName, voteValue, bpm, bpmVotings, std::bind(&Server::createBpmVoting, this));
 }
 
-void Server::processChatMessage(QTcpSocket *socket, const ClientToServerChatMessage &msg)
+void Server::processChatMessage(ClientConnection *connection, const ClientToServerChatMessage &msg)
 {
-    if (!remoteUsers.contains(socket))
+    if (!remoteUsers.contains(connection))
         return;
 
-    QString userFullName = remoteUsers[socket].getFullName();
+    QString userFullName = remoteUsers[connection].getFullName();
 
     if (msg.isPublicMessage()) {
         broadcastPublicChatMessage(msg, userFullName);
@@ -661,9 +752,9 @@ void Server::processChatMessage(QTcpSocket *socket, const ClientToServerChatMess
     }
 }
 
-void Server::processKeepAlive(QTcpSocket *socket)
+void Server::processKeepAlive(ClientConnection *connection)
 {
-    auto iterator = remoteUsers.find(socket);
+    auto iterator = remoteUsers.find(connection);
     if (iterator != remoteUsers.end()) {
         iterator.value().setLastKeepAliveToNow();
     }
@@ -675,126 +766,99 @@ void Server::updateKeepAliveInfos()
     KeepAliveMessage().serializeToBuffer(keepAliveMessageData); /// TODO: check serializeTo count and handle it
 
     // check if remote users need keep alive request
-    for (auto socket : remoteUsers.keys()) {
-        const auto &user = remoteUsers[socket];
-        auto now = QDateTime::currentMSecsSinceEpoch();
+    const auto now = QDateTime::currentMSecsSinceEpoch();
+    for (auto connection : remoteUsers.keys()) {
+        const auto &user = remoteUsers[connection];
         auto delta = (now - user.getLastKeepAliveReceived()) / 1000; // in seconds
         if (delta >= keepAlivePeriod) {
             if (delta >= keepAlivePeriod * 3) { // client is not responding
-                disconnectClient(socket);
+                disconnectClient(connection);
             } else {
-                socket->write(keepAliveMessageData); /// TODO: check write count and handle it
+                connection->send(keepAliveMessageData);
             }
         }
     }
 }
 
-void Server::processClientSetUserMask(QTcpSocket *socket, const ninjam::MessageHeader &header)
+void Server::processClientSetUserMask(ClientConnection *connection, const QByteArray &payload)
 {
-    //auto msg = ClientSetUserMask::from(socket, header.getPayload());
+    Q_UNUSED(connection)
+    Q_UNUSED(payload)
+    //auto msg = ClientSetUserMask::from(connection, payload);
 
 }
 
-void Server::processReceivedBytes()
+void Server::processMessage(ClientConnection *connection, quint8 messageType, const QByteArray &payload)
 {
-    updateKeepAliveInfos();
-
-    auto socket = qobject_cast<QTcpSocket *>(QObject::sender());
-    if (!socket) {
-        qCritical("Error, socket is NULL!");
-        return;
-    }
-
-    if (!remoteUsers.contains(socket)) {
-        qCritical("not contain socket!");
-        if (socket->isOpen()) {
-            socket->close();
-            socket->deleteLater();
-        }
-        return;
-    }
-
-    qint64 bytesAvailable = socket->bytesAvailable();
+    auto iterator = remoteUsers.find(connection);
+    if (iterator == remoteUsers.end())
+        return; // message received before the disconnection
 
-    RemoteUser &user = remoteUsers[socket];
-
-    while (socket->bytesAvailable() >= 5) { // all messages have minimum of 5 bytes
-
-        MessageHeader header = user.getCurrentHeader();
-        if (!header.isValid()) {
-            header = MessageHeader::from(socket);
-            user.setCurrentHeader(header);
-        }
-
-        Q_ASSERT(header.isValid());
-
-        if (socket->bytesAvailable() < header.getPayload()) {
-//            qDebug() << "not enough bytes " << socket->bytesAvailable() << "/" << header.getPayload()
-//                     << " bytes available  msg code:"<< QString::number(static_cast<quint8>(header.getMessageType()), 16);
-            return;
-        }
+    iterator.value().setLastKeepAliveToNow();
 
-        NinjamInputDataStream stream(socket, header.getPayload());
+    NinjamInputDataStream stream(payload, payload.size());
 
+    switch (static_cast<MessageType>(messageType)) {
+    case MessageType::ClientAuthUser: {
+        ClientAuthUserMessage message;
+        message.unserializeFrom(stream);
+        processClientAuthUserMessage(connection, message);
+        break;
+    }
+    case MessageType::ClientSetChannel: {
+        ClientSetChannel message;
+        message.unserializeFrom(stream);
+        processClientSetChannel(connection, message);
+        break;
+    }
+    case MessageType::KeepAlive:
+        processKeepAlive(connection);
+        break;
+    case MessageType::UploadIntervalBegin: {
+        UploadIntervalBegin message;
+        message.unserializeFrom(stream);
+        processUploadIntervalBegin(connection, message);
+        break;
+    }
+    case MessageType::ChatMessage: {
+        ClientToServerChatMessage message;
+        message.unserializeFrom(stream);
+        processChatMessage(connection, message);
+        break;
+    }
+    case MessageType::ClientSetUserMask:
+        processClientSetUserMask(connection, payload);
+        break;
 
-        switch (header.getMessageType()) {
-        case MessageType::ClientAuthUser: {
-            ClientAuthUserMessage message;
-            message.unserializeFrom(stream);
-            processClientAuthUserMessage(socket, message);
-            break;
-        }
-        case MessageType::ClientSetChannel: {
-            ClientSetChannel message;
-            message.unserializeFrom(stream);
-            processClientSetChannel(socket, message);
-            break;
-        }
-        case MessageType::KeepAlive:
-            processKeepAlive(socket);
-            break;
-        case MessageType::UploadIntervalBegin: {
-            UploadIntervalBegin message;
-            message.unserializeFrom(stream);
-            processUploadIntervalBegin(socket, message);
-            break;
-        }
-        case MessageType::UploadIntervalWrite: {
-            DownloadIntervalWrite message;
-            message.unserializeFrom(stream);
-            processUploadIntervalWrite(socket, message);
-            break;
-        }
-        case MessageType::ChatMessage: {
-            ClientToServerChatMessage message;
-            message.unserializeFrom(stream);
-            processChatMessage(socket, message);
-            break;
-        }
-        case MessageType::ClientSetUserMask:
-            processClientSetUserMask(socket, header);
-            break;
+    default:
+        qCritical() << "not handled message code:" << QString::number(messageType, 16);
+        disconnectClient(connection);
+    }
+}
 
-        default:
-            qFatal("not handled message code: %s",
-                   QString::number(static_cast<quint8>(header.getMessageType()), 16).toStdString().c_str());
-        }
-        //stream.skipRemainingPayload();
+void Server::handleDisconnection(ClientConnection *connection)
+{
+    disconnectClient(connection);
+}
 
-        user.setCurrentHeader(MessageHeader()); // invalidate header to force a new parsing in next loop iteration
-    }
+void Server::handleEvictedClient(ClientConnection *connection, qint64 queuedBytes)
+{
+    if (remoteUsers.contains(connection))
+        qWarning() << "Disconnecting slow client" << remoteUsers[connection].getFullName() << queuedBytes << "bytes queued";
 
-    user.setLastKeepAliveToNow();
+    disconnectClient(connection);
+}
 
-    qint64 bytesRemaining = socket->bytesAvailable();
-    totalDownloadMeasurer.addTransferedBytes(bytesAvailable - bytesRemaining);
+void Server::closeConnection(ClientConnection *connection)
+{
+    QMetaObject::invokeMethod(connection, "close", Qt::QueuedConnection);
 }
 
-void Server::handleDisconnection()
+void Server::handleClosedConnection(ClientConnection *connection)
 {
-    auto socket = qobject_cast<QTcpSocket *>(QObject::sender());
-    if (socket)
-        disconnectClient(socket);
+    // connectionClosed is the last signal, all messages received from this connection are already processed
+    if (connections.remove(connection))
+        connection->deleteLater();
 }
 
 QStringList Server::getConnectedUsersNames() const
@@ -807,10 +871,10 @@ QStringList Server::getConnectedUsersNames() const
     return names;
 }
 
-void Server::disconnectClient(QTcpSocket *socket)
+void Server::disconnectClient(ClientConnection *connection)
 {
-    if (remoteUsers.contains(socket)) {
-        const RemoteUser &user = remoteUsers[socket];
+    if (remoteUsers.contains(connection)) {
+        const RemoteUser &user = remoteUsers[connection];
 
         QString userFullName = user.getFullName();
 
@@ -820,43 +884,38 @@ void Server::disconnectClient(QTcpSocket *socket)
         QByteArray broadcastMsgData;
         partMsg.serializeToBuffer(broadcastMsgData);
         msg.serializeToBuffer(broadcastMsgData);
-        broadcastNetworkData(broadcastMsgData, socket);
+        broadcastNetworkData(broadcastMsgData, connection);
 
-        remoteUsers.remove(socket);
-        socket->deleteLater();
+        remoteUsers.remove(connection);
+        closeConnection(connection); // deleted when closed
 
         emit userLeave(userFullName);
     }
 }
 
-void Server::handleClientSocketError(QAbstractSocket::SocketError error)
-{
-    Q_UNUSED(error)
-    //qDebug() << qobject_cast<QTcpSocket *>(QObject::sender())->errorString();
-}
-
 void Server::handleAcceptError(QAbstractSocket::SocketError socketError)
 {
-    qCritical() << socketError <<  tcpServer.errorString();
+    qCritical() << socketError <<  tcpServer->errorString();
 }
 
 quint16 Server::getPort() const
 {
-    return tcpServer.serverPort();
+    return tcpServer->serverPort();
 }
 
 QString Server::getIP() const
 {
-    return tcpServer.serverAddress().toString();
+    return tcpServer->serverAddress().toString();
 }
 
 void Server::shutdown()
 {
-    if (tcpServer.isListening()) {
-        tcpServer.close();
+    if (tcpServer->isListening()) {
+        tcpServer->close();
+        keepAliveTimer.stop();
 
-        for (auto socket : remoteUsers.keys())
-            disconnectClient(socket);
+        for (auto connection : remoteUsers.keys())
+            disconnectClient(connection);
 
         remoteUsers.clear();
 
@@ -2,12 +2,15 @@
 #define _SERVER_SERVER_
 
 #include <QTcpServer>
-#include <QTcpSocket>
 #include <QObject>
 #include <QList>
+#include <QSet>
 #include <QTimer>
+#include <QScopedPointer>
+#include <QThread>
 
 #include "ninjam/Ninjam.h"
+#include "ninjam/server/ClientConnection.h"
 #include "ninjam/client/ClientMessages.h"
 #include "ninjam/client/ServerMessages.h"
 #include "ninjam/client/User.h"
@@ -37,8 +40,6 @@ public:
     RemoteUser();
     void setLastKeepAliveToNow();
     quint64 getLastKeepAliveReceived() const;
-    MessageHeader getCurrentHeader() const;
-    void setCurrentHeader(MessageHeader header);
     void setFullName(const QString &fullName);
     void updateChannels(const QList<UserChannel> &newChannels, quint8 maxChannels);
 
@@ -53,21 +54,10 @@ public:
     }
 
 private:
-    MessageHeader currentHeader;
     quint64 lastKeepAliveReceived;
     bool receivedServerInfos;
 };
 
-inline void RemoteUser::setCurrentHeader(MessageHeader header)
-{
-    currentHeader = header;
-}
-
-inline MessageHeader RemoteUser::getCurrentHeader() const
-{
-    return currentHeader;
-}
-
 inline quint64 RemoteUser::getLastKeepAliveReceived() const
 {
     return lastKeepAliveReceived;
@@ -98,6 +88,14 @@ private:
     void reset();
 };
 
+/**
+    The clients can be handled in N I/O threads (setIOThreads). The I/O threads are reading and
+    framing the messages and writing in the sockets, the server logic is executed in the server
+    thread, so the state (users, channels, votings) is not shared and the messages of each client
+    are processed in the received order. The interval data is received already serialized as a
+    DownloadIntervalWrite message and the same buffer is sent to all clients (no copies).
+*/
+
 class Server : public QObject
 {
     Q_OBJECT
@@ -108,6 +106,13 @@ public:
     virtual void start(quint16 port);
     void shutdown();
 
+    void setMaxUsers(quint16 maxUsers);
+    void setIOThreads(int threads); // 0 = the clients are handled in the server thread. Used in next start()
+    void setMaxQueuedBytesPerClient(qint64 maxBytes); // clients with more queued bytes (slow connections) are disconnected
+
+    int getIOThreads() const;
+    qint64 getMaxQueuedBytesPerClient() const;
+
     bool isStarted() const;
 
     quint16 getPort() const;
@@ -117,7 +122,7 @@ public:
     quint16 getBpm() const;
     QString getTopic() const;
     QString getLicence() const;
-    quint8 getMaxUsers() const;
+    quint16 getMaxUsers() const;
     quint8 getMaxChannels() const;
 
     QStringList getConnectedUsersNames() const;
@@ -134,14 +139,18 @@ signals:
     void userLeave(const QString &userName);
 
 protected:
-    void sendAuthChallenge(QTcpSocket *device);
+    void sendAuthChallenge(ClientConnection *connection);
 
 protected slots:
-    virtual void handleNewConnection();
+    virtual void handleNewConnection(qintptr socketDescriptor);
     void handleAcceptError(QAbstractSocket::SocketError socketError);
-    void processReceivedBytes();
-    void handleDisconnection();
-    void handleClientSocketError(QAbstractSocket::SocketError error);
+    void handleConnectionOpened(ClientConnection *connection);
+    void processMessage(ClientConnection *connection, quint8 messageType, const QByteArray &payload);
+    void processIntervalData(ClientConnection *connection, const QByteArray &downloadMessageData);
+    void handleDisconnection(ClientConnection *connection);
+    void handleEvictedClient(ClientConnection *connection, qint64 queuedBytes);
+    void handleClosedConnection(ClientConnection *connection);
+    void updateKeepAliveInfos();
 
     void bpiVotingExpired(quint16 bpiValue);
     void bpiVotingAccepted(quint16 acceptedValue);
@@ -152,14 +161,22 @@ protected slots:
     void bpmVotingIncremented(quint16 votingValue, quint16 currentVotes, quint16 requiredVotes, quint64 expirationTime);
 
 private:
-    QTcpServer tcpServer;
-    QMap<QTcpSocket *, RemoteUser> remoteUsers; // connected clients
+    class Listener;
+    QScopedPointer<Listener> tcpServer;
+    QMap<ClientConnection *, RemoteUser> remoteUsers; // connected clients
+    QSet<ClientConnection *> connections; // all connections, including the closing connections
+
+    QList<QThread *> ioThreads;
+    int ioThreadsCount;
+    int nextIOThread;
+    qint64 maxQueuedBytesPerClient;
+    QTimer keepAliveTimer;
 
     quint16 bpm;
     quint16 bpi;
     QString topic;
     QString licence;
-    quint8 maxUsers;
+    quint16 maxUsers;
     quint8 maxChannels;
     quint16 keepAlivePeriod;
 
@@ -178,14 +195,14 @@ private:
     VotingMap bpmVotings;
     VotingMap bpiVotings;
 
-    void broadcastNetworkData(const QByteArray& messageData, QTcpSocket *excludeSocket = nullptr);
-    void broadcastNetworkMessage(const INetworkMessage& message, QTcpSocket *excludeSocket = nullptr);
+    void broadcastNetworkData(const QByteArray& messageData, ClientConnection *exclude = nullptr);
+    void broadcastNetworkMessage(const INetworkMessage& message, ClientConnection *exclude = nullptr);
 
     void broadcastUserChanges(const QString userFullName, const QList<UserChannel> &userChannels);
-    void sendConnectedUsersTo(QTcpSocket *socket);
+    void sendConnectedUsersTo(ClientConnection *connection);
     void broadcastPublicChatMessage(const ClientToServerChatMessage &receivedMessage, const QString &userFullName);
     void broadcastVotingSystemMessage(const QString &message);
-    void broadcastServerMessage(const QString &serverMessage, QTcpSocket *exclude);
+    void broadcastServerMessage(const QString &serverMessage, ClientConnection *exclude);
 
     void processBpiVoteMessage(const ClientToServerChatMessage &msg, const QString &userFullName);
     void processBpmVoteMessage(const ClientToServerChatMessage &msg, const QString &userFullName);
@@ -193,15 +210,14 @@ private:
     Voting *createBpiVoting();
     Voting *createBpmVoting();
 
-    void processClientAuthUserMessage(QTcpSocket *socket, const ClientAuthUserMessage& msg);
-    void processClientSetChannel(QTcpSocket *socket, const ClientSetChannel& msg);
-    void processUploadIntervalBegin(QTcpSocket *socket, const UploadIntervalBegin &msg);
-    void processUploadIntervalWrite(QTcpSocket *socket, const DownloadIntervalWrite &msg);
-    void processChatMessage(QTcpSocket *socket, const ClientToServerChatMessage &msg);
-    void processKeepAlive(QTcpSocket *socket);
-    void processClientSetUserMask(QTcpSocket *socket, const MessageHeader &header);
+    void processClientAuthUserMessage(ClientConnection *connection, const ClientAuthUserMessage& msg);
+    void processClientSetChannel(ClientConnection *connection, const ClientSetChannel& msg);
+    void processUploadIntervalBegin(ClientConnection *connection, const UploadIntervalBegin &msg);
+    void processChatMessage(ClientConnection *connection, const ClientToServerChatMessage &msg);
+    void processKeepAlive(ClientConnection *connection);
+    void processClientSetUserMask(ClientConnection *connection, const QByteArray &payload);
 
-    void sendServerInitialInfosTo(QTcpSocket *socket);
+    void sendServerInitialInfosTo(ClientConnection *connection);
 
     void sendPrivateMessage(const QString &sender, const ClientToServerChatMessage &receivedMessage);
     void processAdminCommand(const QString &cmd);
@@ -209,11 +225,12 @@ private:
     void setBpi(quint16 newBpi);
     void setBpm(quint16 newBpm);
 
-    void disconnectClient(QTcpSocket *socket);
+    void sendMessage(ClientConnection *connection, const INetworkMessage &message);
 
-    QString generateUniqueUserName(const QString &userName) const; // return sanitized and unique username
+    void disconnectClient(ClientConnection *connection);
+    void closeConnection(ClientConnection *connection);
 
-    void updateKeepAliveInfos();
+    QString generateUniqueUserName(const QString &userName) const; // return sanitized and unique username
 
     static QHostAddress getBestHostAddress();
 };
@@ -233,7 +250,17 @@ inline quint8 Server::getMaxChannels() const
     return maxChannels;
 }
 
-inline quint8 Server::getMaxUsers() const
+inline int Server::getIOThreads() const
+{
+    return ioThreadsCount;
+}
+
+inline qint64 Server::getMaxQueuedBytesPerClient() const
+{
+    return maxQueuedBytesPerClient;
+}
+
+inline quint16 Server::getMaxUsers() const
 {
     return maxUsers;
 }
@@ -0,0 +1,229 @@
+#include "PluginScanCache.h"
+#include "CacheHeader.h"
+#include "log/Logging.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QDataStream>
+#include <QCryptographicHash>
+
+using persistence::PluginScanCache;
+using persistence::PluginScanResult;
+using persistence::PluginScanCacheHeader;
+
+const quint32 PluginScanCacheHeader::REVISION = 2; // revision 1 was caching the failed scans
+
+QDataStream &operator<<(QDataStream &stream, const PluginScanResult &result)
+{
+    return stream
+           << result.getPath()
+           << result.isValid()
+           << result.getName()
+           << result.getManufacturer()
+           << result.getFileSize()
+           << result.getLastModified()
+           << result.getHash();
+}
+
+QDataStream &operator>>(QDataStream &stream, PluginScanResult &result)
+{
+    QString path, name, manufacturer;
+    bool valid;
+    qint64 fileSize, lastModified;
+    QByteArray hash;
+
+    stream >> path >> valid >> name >> manufacturer >> fileSize >> lastModified >> hash;
+
+    result = PluginScanResult(path, valid, name, manufacturer);
+    result.setFingerprint(fileSize, lastModified, hash);
+
+    return stream;
+}
+
+// +++++++++++++++++++++++++++++++++++++++
+
+PluginScanResult::PluginScanResult() :
+    valid(false),
+    fileSize(-1),
+    lastModified(-1)
+{
+
+}
+
+PluginScanResult::PluginScanResult(const QString &path, bool valid, const QString &name, const QString &manufacturer) :
+    path(path),
+    valid(valid),
+    name(name),
+    manufacturer(manufacturer),
+    fileSize(-1),
+    lastModified(-1)
+{
+
+}
+
+void PluginScanResult::setFingerprint(qint64 fileSize, qint64 lastModified, const QByteArray &hash)
+{
+    this->fileSize = fileSize;
+    this->lastModified = lastModified;
+    this->hash = hash;
+}
+
+// +++++++++++++++++++++++++++++++++++++++
+
+PluginScanCache::PluginScanCache(const QDir &cacheDir) :
+    cacheDir(cacheDir),
+    modified(false),
+    CACHE_FILE_NAME("plugins_scan_cache.bin")
+{
+    loadFromFile();
+}
+
+PluginScanCache::~PluginScanCache()
+{
+    save();
+}
+
+QString PluginScanCache::getBinaryPath(const QString &pluginPath)
+{
+    QFileInfo pluginInfo(pluginPath);
+    if (!pluginInfo.isDir())
+        return pluginPath;
+
+    // Mac bundles, the executable is the only file in Contents/MacOS
+    QDir executableDir(pluginInfo.absoluteFilePath() + "/Contents/MacOS");
+    const QStringList executables = executableDir.entryList(QDir::Files);
+    if (executables.isEmpty())
+        return pluginPath;
+
+    return executableDir.absoluteFilePath(executables.first());
+}
+
+QByteArray PluginScanCache::computeHash(const QString &filePath)
+{
+    QFile file(filePath);
+    if (!file.open(QFile::ReadOnly))
+        return QByteArray();
+
+    QCryptographicHash hash(QCryptographicHash::Md5); // not used for security, just to detect changed binaries
+    if (!hash.addData(&file))
+        return QByteArray();
+
+    return hash.result();
+}
+
+bool PluginScanCache::lookup(const QString &pluginPath, PluginScanResult &result)
+{
+    auto iterator = results.find(pluginPath);
+    if (iterator == results.end())
+        return false;
+
+    const QFileInfo binaryInfo(getBinaryPath(pluginPath));
+    if (!binaryInfo.exists())
+        return false;
+
+    PluginScanResult &cachedResult = iterator.value();
+    const qint64 fileSize = binaryInfo.size();
+    const qint64 lastModified = binaryInfo.lastModified().toMSecsSinceEpoch();
+
+    if (fileSize != cachedResult.getFileSize())
+        return false;
+
+    if (lastModified != cachedResult.getLastModified()) { // touched, reinstalled or changed?
+        if (cachedResult.getHash().isEmpty())
+            return false; // the scanner didn't send the hash, can't compare
+
+        const QByteArray hash = computeHash(binaryInfo.absoluteFilePath());
+        if (hash.isEmpty() || hash != cachedResult.getHash())
+            return false;
+
+        cachedResult.setFingerprint(fileSize, lastModified, hash);
+        modified = true;
+    }
+
+    result = cachedResult;
+    return true;
+}
+
+void PluginScanCache::store(const PluginScanResult &result, const QByteArray &hash)
+{
+    if (!result.isValid()) { // the failure can be temporary (a missing runtime), the file is scanned again in the next scan
+        remove(result.getPath());
+        return;
+    }
+
+    const QFileInfo binaryInfo(getBinaryPath(result.getPath()));
+    if (!binaryInfo.exists())
+        return;
+
+    const qint64 fileSize = binaryInfo.size();
+    const qint64 lastModified = binaryInfo.lastModified().toMSecsSinceEpoch();
+
+    QByteArray binaryHash(hash);
+    if (binaryHash.isEmpty()) { // the binary is never hashed here, the previous hash is kept if the binary is not changed
+        auto iterator = results.constFind(result.getPath());
+        if (iterator != results.constEnd() && iterator->getFileSize() == fileSize && iterator->getLastModified() == lastModified)
+            binaryHash = iterator->getHash();
+    }
+
+    PluginScanResult cachedResult(result);
+    cachedResult.setFingerprint(fileSize, lastModified, binaryHash);
+
+    results.insert(result.getPath(), cachedResult);
+    modified = true;
+}
+
+void PluginScanCache::remove(const QString &pluginPath)
+{
+    if (results.remove(pluginPath) > 0)
+        modified = true;
+}
+
+void PluginScanCache::clear()
+{
+    if (results.isEmpty())
+        return;
+
+    results.clear();
+    modified = true;
+}
+
+void PluginScanCache::loadFromFile()
+{
+    QFile cacheFile(cacheDir.absoluteFilePath(CACHE_FILE_NAME));
+    if (cacheFile.open(QFile::ReadOnly)) {
+        QDataStream stream(&cacheFile);
+
+        CacheHeader cacheHeader;
+        stream >> cacheHeader;
+        if (cacheHeader.isValid(PluginScanCacheHeader::REVISION))
+            stream >> results;
+        else
+            qCritical() << "Invalid cache header when loading plugins scan cache.";
+
+        qCDebug(jtCache) << "Plugins scan results loaded from file: " << results.size();
+    }
+}
+
+void PluginScanCache::save()
+{
+    if (!modified)
+        return;
+
+    QFile cacheFile(cacheDir.absoluteFilePath(CACHE_FILE_NAME));
+    if (cacheFile.open(QFile::WriteOnly)) {
+        QDataStream stream(&cacheFile);
+
+        CacheHeader cacheHeader(PluginScanCacheHeader::REVISION);
+        stream << cacheHeader;
+
+        stream << results;
+
+        modified = false;
+
+        qCDebug(jtCache) << results.size() << " plugins scan results stored in cache file!";
+    } else {
+        qCritical() << "Can't open the plugins scan cache file in"
+                    << QFileInfo(cacheFile).absoluteFilePath();
+    }
+}
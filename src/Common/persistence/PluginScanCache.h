@@ -0,0 +1,124 @@
+#ifndef PLUGIN_SCAN_CACHE_H
+#define PLUGIN_SCAN_CACHE_H
+
+#include <QString>
+#include <QByteArray>
+#include <QMap>
+#include <QDir>
+
+/**
+
+  The plugins scan results, used to avoid loading the unchanged plugins in every rescan. The
+  entries are keyed by the plugin path and store the file size, last modification time and a
+  content hash. Size and modification time are checked first, the hash is computed only when
+  they are changed (a reinstalled or copied plugin with the same binary is not scanned again).
+  The hash of a new result is computed by the scanner process, not in the GUI thread.
+
+  Only the valid plugins are cached. Files failing to load (not a plugin, or a plugin missing a
+  runtime library) are scanned again in the next scan, and plugins crashing the scanner are in
+  the VST black list.
+
+ */
+
+namespace persistence {
+
+struct PluginScanCacheHeader {
+    static const quint32 REVISION;
+};
+
+class PluginScanResult
+{
+
+public:
+    PluginScanResult();
+    PluginScanResult(const QString &path, bool valid, const QString &name = QString(), const QString &manufacturer = QString());
+
+    inline QString getPath() const
+    {
+        return path;
+    }
+
+    inline bool isValid() const // false for files that are not plugins or failed to load, these results are not cached
+    {
+        return valid;
+    }
+
+    inline QString getName() const
+    {
+        return name;
+    }
+
+    inline QString getManufacturer() const
+    {
+        return manufacturer;
+    }
+
+    inline qint64 getFileSize() const
+    {
+        return fileSize;
+    }
+
+    inline qint64 getLastModified() const // ms since epoch
+    {
+        return lastModified;
+    }
+
+    inline QByteArray getHash() const
+    {
+        return hash;
+    }
+
+    void setFingerprint(qint64 fileSize, qint64 lastModified, const QByteArray &hash);
+
+private:
+    QString path;
+    bool valid;
+    QString name;
+    QString manufacturer;
+    qint64 fileSize;
+    qint64 lastModified;
+    QByteArray hash;
+};
+
+// ++++++++++++++++++++++++++++++++
+
+class PluginScanCache
+{
+public:
+    explicit PluginScanCache(const QDir &cacheDir);
+    ~PluginScanCache();
+
+    // return true when the plugin was scanned and not changed after the scan
+    bool lookup(const QString &pluginPath, PluginScanResult &result);
+
+    // size and modification time are read here, the hash is received from the scanner process. Invalid results are removed from the cache
+    void store(const PluginScanResult &result, const QByteArray &hash = QByteArray());
+    void remove(const QString &pluginPath);
+    void clear();
+
+    int size() const;
+
+    void save();
+
+    static QString getBinaryPath(const QString &pluginPath); // the executable inside the bundles (Mac)
+    static QByteArray computeHash(const QString &filePath);
+
+private:
+    QMap<QString, PluginScanResult> results;
+
+    QDir cacheDir;
+    bool modified;
+
+    void loadFromFile();
+
+    const QString CACHE_FILE_NAME;
+};
+
+inline int PluginScanCache::size() const
+{
+    return results.size();
+}
+
+} // namespace
+
+#endif // PLUGIN_SCAN_CACHE_H
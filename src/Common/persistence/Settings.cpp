@@ -12,6 +12,8 @@
 #include <QSettings>
 #include "log/Logging.h"
 #include "audio/vorbis/Vorbis.h"
+#include "audio/core/RenderWorkers.h"
+#include "audio/DecodingService.h"
 
 using namespace persistence;
 
@@ -245,7 +247,9 @@ AudioSettings::AudioSettings() :
     lastIn(-1),
     lastOut(-1),
     audioInputDevice(""),
-    audioOutputDevice("")
+    audioOutputDevice(""),
+    renderThreads(1),
+    decodingLookAhead(audio::DEFAULT_DECODING_LOOK_AHEAD)
 {
     qCDebug(jtSettings) << "AudioSettings ctor";
 }
@@ -269,6 +273,12 @@ void AudioSettings::read(const QJsonObject &in)
     else if(encodingQuality > vorbis::EncoderQualityHigh)
         encodingQuality = vorbis::EncoderQualityHigh;
 
+    renderThreads = getValueFromJson(in, "renderThreads", 1); // using only the audio thread as fallback value
+    renderThreads = qBound(1, renderThreads, audio::MAX_RENDER_THREADS);
+
+    decodingLookAhead = getValueFromJson(in, "decodingLookAhead", audio::DEFAULT_DECODING_LOOK_AHEAD);
+    decodingLookAhead = qBound(audio::MIN_DECODING_LOOK_AHEAD, decodingLookAhead, audio::MAX_DECODING_LOOK_AHEAD);
+
     qCDebug(jtSettings) << "AudioSettings: sampleRate " << sampleRate
                         << "; bufferSize " << bufferSize
                         << "; firstIn " << firstIn
@@ -277,7 +287,9 @@ void AudioSettings::read(const QJsonObject &in)
                         << "; lastOut " << lastOut
                         << "; audioInputDevice " << audioInputDevice
                         << "; audioOutputDevice " << audioOutputDevice
-                        << "; encodingQuality " << encodingQuality;
+                        << "; encodingQuality " << encodingQuality
+                        << "; renderThreads " << renderThreads
+                        << "; decodingLookAhead " << decodingLookAhead;
 }
 
 void AudioSettings::write(QJsonObject &out) const
@@ -294,6 +306,8 @@ void AudioSettings::write(QJsonObject &out) const
     out["audioOutputDevice"] = audioOutputDevice;
 
     out["encodingQuality"] = encodingQuality;
+    out["renderThreads"] = renderThreads;
+    out["decodingLookAhead"] = decodingLookAhead;
 }
 
 // +++++++++++++++++++++++++++++
@@ -571,7 +585,8 @@ void WindowSettings::write(QJsonObject &out) const
 // +++++++++++++++++++++++++++++++++++++++
 
 VstSettings::VstSettings() :
-    SettingsObject("VST")
+    SettingsObject("VST"),
+    bridgedPlugins(false)
 {
     qCDebug(jtSettings) << "VstSettings ctor";
 }
@@ -598,6 +613,7 @@ void VstSettings::write(QJsonObject &out) const
         BlackedArray.append(blackVst);
 
     out["BlackListPlugins"] = BlackedArray;
+    out["bridgedPlugins"] = bridgedPlugins;
 }
 
 void VstSettings::read(const QJsonObject &in)
@@ -625,6 +641,8 @@ void VstSettings::read(const QJsonObject &in)
             blackedPlugins.append(cacheArray.at(x).toString());
     }
 
+    bridgedPlugins = getValueFromJson(in, "bridgedPlugins", false);
+
     qCDebug(jtSettings) << "VstSettings: foldersToScan " << foldersToScan
                         << "; cachedPlugins " << cachedPlugins
                         << "; blackedPlugins " << blackedPlugins;
@@ -59,6 +59,8 @@ public:
     QString audioInputDevice;
     QString audioOutputDevice;
     float encodingQuality;
+    int renderThreads; // threads used to render the audio nodes, 1 = audio thread only
+    int decodingLookAhead; // milliseconds of ninjam intervals decoded ahead of the playback
 };
 
 // +++++++++++++++++++++++++++++++++++++
@@ -156,6 +158,7 @@ public:
     QStringList cachedPlugins;
     QStringList foldersToScan;
     QStringList blackedPlugins; // vst in blackbox....
+    bool bridgedPlugins; // VST plugins running out of process in the PluginBridge executable
 };
 
 class AudioUnitSettings  : public SettingsObject
@@ -450,6 +453,12 @@ public:
     float getEncodingQuality() const;
     void setEncodingQuality(float quality);
 
+    int getAudioRenderThreads() const;
+    void setAudioRenderThreads(int threads);
+
+    int getDecodingLookAhead() const;
+    void setDecodingLookAhead(int milliseconds);
+
     void setBuiltInMetronome(const QString &metronomeAlias);
     QString getBuiltInMetronome() const;
     void setCustomMetronome(const QString &primaryBeatAudioFile, const QString &offBeatAudioFile, const QString &accentBeatAudioFile);
@@ -521,6 +530,9 @@ public:
     void removeVstScanPath(const QString &path);
     QStringList getVstScanFolders() const;
 
+    bool isUsingBridgedPlugins() const;
+    void setUsingBridgedPlugins(bool usingBridgedPlugins);
+
     QStringList getRecentEmojis() const;
     void setRecentEmojis(const QStringList &emojis);
 
@@ -650,6 +662,16 @@ inline void Settings::setChatSectionCollapsed(bool collapsed)
     collapseSettings.chatSectionCollapsed = collapsed;
 }
 
+inline bool Settings::isUsingBridgedPlugins() const
+{
+    return vstSettings.bridgedPlugins;
+}
+
+inline void Settings::setUsingBridgedPlugins(bool usingBridgedPlugins)
+{
+    vstSettings.bridgedPlugins = usingBridgedPlugins;
+}
+
 inline bool Settings::isLocalChannelsCollapsed() const
 {
     return collapseSettings.localChannelsCollapsed;
@@ -1062,6 +1084,26 @@ inline void Settings::setEncodingQuality(float quality)
     audioSettings.encodingQuality = quality;
 }
 
+inline int Settings::getAudioRenderThreads() const
+{
+    return audioSettings.renderThreads;
+}
+
+inline void Settings::setAudioRenderThreads(int threads)
+{
+    audioSettings.renderThreads = threads;
+}
+
+inline int Settings::getDecodingLookAhead() const
+{
+    return audioSettings.decodingLookAhead;
+}
+
+inline void Settings::setDecodingLookAhead(int milliseconds)
+{
+    audioSettings.decodingLookAhead = milliseconds;
+}
+
 } // namespace
 
 #endif
@@ -1,7 +1,7 @@
 #include "JamRecorder.h"
 #include <QDateTime>
 #include <QDebug>
-#include <QtConcurrent/QtConcurrent>
+#include <QRegExp>
 #include "../log/Logging.h"
 
 using namespace recorder;
@@ -68,7 +68,36 @@ JamInterval::JamInterval() :
 
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 
-Jam::Jam(int bpm, int bpi, int sampleRate) :
+JamServer::JamServer(const QString &host, quint16 port, const QString &room) :
+    host(host),
+    port(port),
+    room(room)
+{
+    //
+}
+
+JamServer::JamServer() :
+    host(""),
+    port(0),
+    room("")
+{
+    //
+}
+
+bool JamServer::operator==(const JamServer &other) const
+{
+    return host == other.host && port == other.port && room == other.room;
+}
+
+bool JamServer::operator!=(const JamServer &other) const
+{
+    return !(*this == other);
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+Jam::Jam(const JamServer &server, int bpm, int bpi, int sampleRate) :
+    server(server),
     bpm(bpm),
     bpi(bpi),
     sampleRate(sampleRate)
@@ -127,15 +156,9 @@ QString JamRecorder::getNewJamName()
     return "Jam-" + nowString;
 }
 
-bool JamRecorder::writeEncodedFile(const QByteArray& encodedData, const QString &path)
+bool JamRecorder::writeEncodedFile(const ninjam::ByteRope &encodedData, const QString &path)
 {
-    QFile audioFile(path);
-    if (!audioFile.open(QFile::WriteOnly)) {
-        qCritical() << "can't open file " << path;
-        return false;
-    }
-    audioFile.write(encodedData.data(), encodedData.size());
-    return true;
+    return ioExecutor->write(path, encodedData); // false when the disk is too slow and the write is dropped
 }
 
 QString JamRecorder::buildVideoFileName(const QString &userName, int currentInterval, const QString &fileExtension)
@@ -187,11 +210,7 @@ void JamRecorder::appendLocalUserAudio(const QByteArray &encodedAudio, quint8 ch
 
     bool needSave = isFirstPartOfInterval && !interval.isEmpty();
     if (needSave) {
-        QString audioFileName = buildAudioFileName(localUserName, channelIndex, interval.getIntervalIndex());
-        QString audioFilePath = jamMetadataWritter->getAudioAbsolutePath(audioFileName);
-        QByteArray encodedData(interval.getEncodedData());
-        QtConcurrent::run(this, &JamRecorder::writeEncodedFile, encodedData, audioFilePath);
-        jam->addAudioFile(localUserName, channelIndex, audioFilePath, interval.getIntervalIndex());
+        writeAudioInterval(localUserName, channelIndex, interval.getIntervalIndex(), interval.getEncodedData());
         interval.clear();
     }
 
@@ -214,13 +233,13 @@ void JamRecorder::appendLocalUserVideo(const QByteArray &encodedVideo, bool isFi
     bool needSave = isFirstPartOfInterval && !videoInterval.isEmpty();
     if (needSave) {
 
-        QByteArray encodedData(videoInterval.getEncodedData());
+        ninjam::ByteRope encodedData(videoInterval.getEncodedData());
 
         QString videoFileName = buildVideoFileName(localUserName, videoInterval.getIntervalIndex(), "mp4");
         QString videoFilePath = jamMetadataWritter->getVideoAbsolutePath(videoFileName);
 
         if (!videoFilePath.isEmpty()) // some recorders (like ClipSort) can't save videos
-            QtConcurrent::run(this, &JamRecorder::writeEncodedFile, encodedData, videoFilePath);
+            writeEncodedFile(encodedData, videoFilePath);
 
         videoInterval.clear();
     }
@@ -228,21 +247,30 @@ void JamRecorder::appendLocalUserVideo(const QByteArray &encodedVideo, bool isFi
     videoInterval.appendEncodedData(encodedVideo);
 }
 
-void JamRecorder::addRemoteUserAudio(const QString &userName, const QByteArray &encodedAudio, quint8 channelIndex)
+void JamRecorder::addRemoteUserAudio(const QString &userName, const ninjam::ByteRope &encodedAudio, quint8 channelIndex)
 {
     if (!running) {
         qCritical() << "Illegal state! Recorder is not running!";
         return;
     }
 
-    int intervalIndex = globalIntervalIndex;
+    writeAudioInterval(userName, channelIndex, globalIntervalIndex, encodedAudio);
+}
+
+void JamRecorder::writeAudioInterval(const QString &userName, quint8 channelIndex, int intervalIndex, const ninjam::ByteRope &encodedData)
+{
+    if (jamMetadataWritter->isWritingAudioIntervals()) {
+        jamMetadataWritter->writeAudioInterval(userName, channelIndex, intervalIndex, encodedData, *jam);
+        return;
+    }
+
     QString audioFileName = buildAudioFileName(userName, channelIndex, intervalIndex);
     QString audioFilePath = jamMetadataWritter->getAudioAbsolutePath(audioFileName);
-    QtConcurrent::run(this, &JamRecorder::writeEncodedFile, encodedAudio, audioFilePath);
-    jam->addAudioFile(userName, channelIndex, audioFilePath, intervalIndex);
+    if (writeEncodedFile(encodedData, audioFilePath))
+        jam->addAudioFile(userName, channelIndex, audioFilePath, intervalIndex); // the dropped intervals are not in the project
 }
 
-void JamRecorder::startRecording(const QString &localUser, const QDir &recordBaseDir, int bpm, int bpi, int sampleRate)
+void JamRecorder::startRecording(const QString &localUser, const QDir &recordBaseDir, const JamServer &server, int bpm, int bpi, int sampleRate)
 {
     if (running)
         stopRecording();
@@ -250,8 +278,9 @@ void JamRecorder::startRecording(const QString &localUser, const QDir &recordBas
     this->localUserName = localUser;
     this->recordBaseDir = recordBaseDir;
     this->jamMetadataWritter->setJamDir(getNewJamName(), recordBaseDir.absolutePath());
+    this->ioExecutor = RecorderIOExecutor::getExecutor(recordBaseDir.absolutePath());
 
-    jam.reset(new Jam(bpm, bpi, sampleRate));
+    jam.reset(new Jam(server, bpm, bpi, sampleRate));
 
     running = true;
     qDebug(jtJamRecorder) << jamMetadataWritter->getWriterId() << "startRecording!";
@@ -262,7 +291,7 @@ void JamRecorder::setBpi(int newBpi)
 {
     if (running) {
         stopRecording();
-        startRecording(localUserName, recordBaseDir, jam->getBpm(), newBpi, jam->getSampleRate() );
+        startRecording(localUserName, recordBaseDir, jam->getServer(), jam->getBpm(), newBpi, jam->getSampleRate() );
     }
 }
 
@@ -270,7 +299,7 @@ void JamRecorder::setBpm(int newBpm)
 {
     if (running) {
         stopRecording();
-        startRecording(localUserName, recordBaseDir, newBpm, jam->getBpi(), jam->getSampleRate() );
+        startRecording(localUserName, recordBaseDir, jam->getServer(), newBpm, jam->getBpi(), jam->getSampleRate() );
     }
 }
 
@@ -279,7 +308,7 @@ void JamRecorder::setRecordPath(const QDir &newDir)
     recordBaseDir = newDir;
     if (running) {
         stopRecording();
-        startRecording(localUserName, recordBaseDir, jam->getBpm(), jam->getBpi(), jam->getSampleRate() );
+        startRecording(localUserName, recordBaseDir, jam->getServer(), jam->getBpm(), jam->getBpi(), jam->getSampleRate() );
     }
 }
 
@@ -288,7 +317,7 @@ void JamRecorder::setDirNameDateFormat(Qt::DateFormat newDateFormat)
     dirNameDateFormat = newDateFormat;
     if (running) {
         stopRecording();
-        startRecording(localUserName, recordBaseDir, jam->getBpm(), jam->getBpi(), jam->getSampleRate() );
+        startRecording(localUserName, recordBaseDir, jam->getServer(), jam->getBpm(), jam->getBpi(), jam->getSampleRate() );
     }
 }
 
@@ -296,7 +325,7 @@ void JamRecorder::setSampleRate(int newSampleRate)
 {
     if (running) {
         stopRecording();
-        startRecording(localUserName, recordBaseDir, jam->getBpm(), jam->getBpi(), newSampleRate );
+        startRecording(localUserName, recordBaseDir, jam->getServer(), jam->getBpm(), jam->getBpi(), newSampleRate );
     }
 }
 
@@ -306,6 +335,7 @@ void JamRecorder::stopRecording()
 {
     if (running) {
         writeProjectFile();
+        jamMetadataWritter->finish();
         this->running = false;
         this->globalIntervalIndex = 0;
         this->localUserIntervals.clear();
@@ -4,6 +4,9 @@
 #include <QDir>
 #include <QMap>
 
+#include "ninjam/ByteRope.h"
+#include "RecorderIOExecutor.h"
+
 #include <memory>
 
 namespace recorder {
@@ -112,11 +115,49 @@ private:
 
 // ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 
+class JamServer // the ninjam server (and room) where the jam is recorded
+{
+
+public:
+    JamServer(const QString &host, quint16 port, const QString &room);
+    JamServer(); // not connected
+
+    inline QString getHost() const
+    {
+        return host;
+    }
+
+    inline quint16 getPort() const
+    {
+        return port;
+    }
+
+    inline QString getRoom() const
+    {
+        return room;
+    }
+
+    bool operator==(const JamServer &other) const;
+    bool operator!=(const JamServer &other) const;
+
+private:
+    QString host;
+    quint16 port;
+    QString room;
+};
+
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
 class Jam
 {
 
 public:
-    Jam(int bpm, int bpi, int sampleRate);
+    Jam(const JamServer &server, int bpm, int bpi, int sampleRate);
+
+    inline JamServer getServer() const
+    {
+        return server;
+    }
 
     inline int getBpm() const
     {
@@ -145,6 +186,7 @@ public:
 
     QList<JamInterval> getJamIntervals() const;
 private:
+    JamServer server;
     int bpm;
     int bpi;
     int sampleRate;
@@ -172,6 +214,19 @@ public:
     virtual QString getAudioAbsolutePath(const QString &audioFileName) = 0;
 
     virtual QString getVideoAbsolutePath(const QString &videoFileName) = 0;
+
+    // writers storing the audio intervals by themselves, JamRecorder is not writing one ogg file per interval
+    virtual bool isWritingAudioIntervals() const { return false; }
+    virtual void writeAudioInterval(const QString &userName, quint8 channelIndex, int intervalIndex, const ninjam::ByteRope &encodedAudio, const Jam &jam)
+    {
+        Q_UNUSED(userName)
+        Q_UNUSED(channelIndex)
+        Q_UNUSED(intervalIndex)
+        Q_UNUSED(encodedAudio)
+        Q_UNUSED(jam)
+    }
+
+    virtual void finish() {} // called when the recording is stopped
 };
 
 // ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
@@ -193,7 +248,7 @@ public:
         encodedData.append(data);
     }
 
-    inline QByteArray getEncodedData() const
+    inline const ninjam::ByteRope &getEncodedData() const
     {
         return encodedData;
     }
@@ -215,7 +270,7 @@ public:
     }
 
 private:
-    QByteArray encodedData;
+    ninjam::ByteRope encodedData;
     int intervalIndex;
 };
 
@@ -229,8 +284,8 @@ public:
 
     void appendLocalUserVideo(const QByteArray &encodedVideo, bool isFirstPartOfInterval);
 
-    void addRemoteUserAudio(const QString &userName, const QByteArray &encodedAudio, quint8 channelIndex);
-    void startRecording(const QString &localUser, const QDir &recordBasePath, int bpm, int bpi, int sampleRate);
+    void addRemoteUserAudio(const QString &userName, const ninjam::ByteRope &encodedAudio, quint8 channelIndex);
+    void startRecording(const QString &localUser, const QDir &recordBasePath, const JamServer &server, int bpm, int bpi, int sampleRate);
 
     // these methods start a new recording
     void setRecordPath(const QDir &recordBasePath);
@@ -255,6 +310,7 @@ private:
     bool running;
     QDir recordBaseDir;
     Qt::DateFormat dirNameDateFormat;
+    std::shared_ptr<RecorderIOExecutor> ioExecutor; // shared by all recorders writing in the same disk
 
     /**
         Audio Intervals: Using channel index as key and store encoded bytes. When a full interval is stored the encoded bytes are store in a ogg file.
@@ -265,7 +321,8 @@ private:
 
     QString getNewJamName();
 
-    bool writeEncodedFile(const QByteArray &encodedData, const QString &path);
+    bool writeEncodedFile(const ninjam::ByteRope &encodedData, const QString &path);
+    void writeAudioInterval(const QString &userName, quint8 channelIndex, int intervalIndex, const ninjam::ByteRope &encodedData);
 
     static QString buildAudioFileName(const QString &userName, quint8 channelIndex, int currentInterval);
     static QString buildVideoFileName(const QString &userName, int currentInterval, const QString &fileExtension);
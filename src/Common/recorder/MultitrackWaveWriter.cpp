@@ -0,0 +1,497 @@
+#include "MultitrackWaveWriter.h"
+
+#include "audio/vorbis/VorbisDecoder.h"
+#include "audio/SamplesBufferResampler.h"
+#include "file/StreamingWaveFileWriter.h"
+#include "file/FileUtils.h"
+#include "../log/Logging.h"
+
+#include <QThread>
+#include <QDateTime>
+#include <QSaveFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QUuid>
+
+using recorder::MultitrackWaveWriter;
+using recorder::Jam;
+using recorder::JamServer;
+using audio::SamplesBuffer;
+
+const QString MultitrackWaveWriter::INDEX_FILE_NAME("session.json");
+const QString MultitrackWaveWriter::PROJECT_FILE_NAME("Reaper project.rpp");
+const int MultitrackWaveWriter::RESUME_TIMEOUT = 10 * 60;
+
+namespace {
+const int MAX_SAMPLES_PER_DECODE = 4096;
+const int INDEX_VERSION = 2; // version 2 stores the server
+}
+
+struct MultitrackWaveWriter::Track
+{
+    QString userName;
+    quint8 channelIndex;
+    QString fileName; // relative to session dir
+    int firstInterval;
+    int lastInterval;
+    audio::StreamingWaveFileWriter file;
+};
+
+struct MultitrackWaveWriter::Session
+{
+    QString dir;
+    JamServer server;
+    int bpm;
+    int bpi;
+    int sampleRate;
+    quint64 intervalFrames;
+    int intervalOffset = 0; // resumed sessions: the new intervals are appended after the intervals in the index
+    QMap<QString, Track *> tracks; // the key is the track name
+
+    ~Session()
+    {
+        qDeleteAll(tracks);
+    }
+};
+
+class MultitrackWaveWriter::WriterThread : public QThread
+{
+public:
+    explicit WriterThread(MultitrackWaveWriter *writer) :
+        writer(writer)
+    {
+        setObjectName("Multitrack wave writer");
+    }
+
+protected:
+    void run() override
+    {
+        writer->run();
+    }
+
+private:
+    MultitrackWaveWriter *writer;
+};
+
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+MultitrackWaveWriter::MultitrackWaveWriter() :
+    session(nullptr),
+    thread(new WriterThread(this)),
+    runningJob(false),
+    stopRequested(false)
+{
+    thread->start(QThread::LowPriority);
+}
+
+MultitrackWaveWriter::~MultitrackWaveWriter()
+{
+    finish();
+
+    {
+        QMutexLocker locker(&mutex);
+        stopRequested = true;
+        jobsAvailable.wakeAll();
+    }
+
+    thread->wait(); // the queued jobs are executed before the thread is finished
+    delete thread;
+}
+
+void MultitrackWaveWriter::enqueue(const Job &job)
+{
+    QMutexLocker locker(&mutex);
+    jobs.enqueue(job);
+    jobsAvailable.wakeOne();
+}
+
+void MultitrackWaveWriter::waitForPendingWrites()
+{
+    QMutexLocker locker(&mutex);
+    while (!jobs.isEmpty() || runningJob)
+        jobsFinished.wait(&mutex);
+}
+
+void MultitrackWaveWriter::run()
+{
+    forever {
+        QMutexLocker locker(&mutex);
+        while (jobs.isEmpty() && !stopRequested)
+            jobsAvailable.wait(&mutex);
+
+        if (jobs.isEmpty())
+            return; // stop requested and all jobs executed
+
+        Job job = jobs.dequeue();
+        runningJob = true;
+        locker.unlock();
+
+        job();
+
+        locker.relock();
+        runningJob = false;
+        if (jobs.isEmpty())
+            jobsFinished.wakeAll();
+    }
+}
+
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+void MultitrackWaveWriter::setJamDir(const QString &newJamName, const QString &recordBasePath)
+{
+    jamDir = QDir(QDir(recordBasePath).absoluteFilePath(newJamName)).absoluteFilePath("Multitrack");
+
+    const QString sessionDir = jamDir;
+    enqueue([=]() {
+        closeSession(true);
+        this->recordBasePath = recordBasePath;
+        newSessionDir = sessionDir;
+    });
+}
+
+void MultitrackWaveWriter::write(const Jam &jam)
+{
+    Q_UNUSED(jam) // the tracks are stored in the session
+
+    enqueue([=]() {
+        flushSession();
+    });
+}
+
+void MultitrackWaveWriter::finish()
+{
+    enqueue([=]() {
+        closeSession(true);
+    });
+}
+
+bool MultitrackWaveWriter::isWritingAudioIntervals() const
+{
+    return true;
+}
+
+void MultitrackWaveWriter::writeAudioInterval(const QString &userName, quint8 channelIndex, int intervalIndex, const ninjam::ByteRope &encodedAudio, const Jam &jam)
+{
+    const auto server = jam.getServer();
+    const int bpm = jam.getBpm();
+    const int bpi = jam.getBpi();
+    const int sampleRate = jam.getSampleRate();
+
+    enqueue([=]() {
+        startSession(server, bpm, bpi, sampleRate);
+        writeInterval(userName, channelIndex, intervalIndex, encodedAudio);
+    });
+}
+
+QString MultitrackWaveWriter::getAudioAbsolutePath(const QString &audioFileName)
+{
+    return QDir(jamDir).absoluteFilePath("audio/" + audioFileName); // not used, the audio intervals are written in the track files
+}
+
+QString MultitrackWaveWriter::getVideoAbsolutePath(const QString &videoFileName)
+{
+    QDir dir(jamDir);
+    if (!dir.mkpath("video")) {
+        qCritical() << "Could not create video directory in " << jamDir;
+        return QString();
+    }
+
+    return dir.absoluteFilePath("video/" + videoFileName);
+}
+
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+void MultitrackWaveWriter::startSession(const JamServer &server, int bpm, int bpi, int sampleRate)
+{
+    if (session) {
+        if (session->server == server && session->bpm == bpm && session->bpi == bpi && session->sampleRate == sampleRate)
+            return;
+
+        closeSession(true); // JamRecorder is starting a new jam when these parameters are changed
+    }
+
+    if (resumeSession(server, bpm, bpi, sampleRate))
+        return;
+
+    if (newSessionDir.isEmpty() || !QDir().mkpath(QDir(newSessionDir).absoluteFilePath("audio"))) {
+        qCritical() << "Could not create the multitrack session directory " << newSessionDir;
+        return;
+    }
+
+    session = new Session();
+    session->dir = newSessionDir;
+    session->server = server;
+    session->bpm = bpm;
+    session->bpi = bpi;
+    session->sampleRate = sampleRate;
+    session->intervalFrames = qRound64(60.0 / bpm * bpi * sampleRate);
+
+    writeIndex(false);
+}
+
+bool MultitrackWaveWriter::resumeSession(const JamServer &server, int bpm, int bpi, int sampleRate)
+{
+    if (recordBasePath.isEmpty())
+        return false;
+
+    const auto now = QDateTime::currentDateTime();
+    const auto jamDirs = QDir(recordBasePath).entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Time);
+    for (const auto &jamDirInfo : jamDirs) {
+        const QDir sessionDir(QDir(jamDirInfo.absoluteFilePath()).absoluteFilePath("Multitrack"));
+        const QFileInfo indexInfo(sessionDir.absoluteFilePath(INDEX_FILE_NAME));
+        if (!indexInfo.exists() || indexInfo.lastModified().secsTo(now) > RESUME_TIMEOUT)
+            continue;
+
+        QFile indexFile(indexInfo.absoluteFilePath());
+        if (!indexFile.open(QFile::ReadOnly))
+            continue;
+
+        const auto root = QJsonDocument::fromJson(indexFile.readAll()).object();
+        if (root["version"].toInt() != INDEX_VERSION || root["finished"].toBool(true))
+            continue;
+
+        const auto serverObject = root["server"].toObject();
+        const JamServer indexServer(serverObject["host"].toString(), static_cast<quint16>(serverObject["port"].toInt()), serverObject["room"].toString());
+        if (indexServer != server) // don't append a different jam in the session
+            continue;
+
+        if (root["bpm"].toInt() != bpm || root["bpi"].toInt() != bpi || root["sampleRate"].toInt() != sampleRate)
+            continue;
+
+        session = new Session();
+        session->dir = sessionDir.absolutePath();
+        session->server = server;
+        session->bpm = bpm;
+        session->bpi = bpi;
+        session->sampleRate = sampleRate;
+        session->intervalFrames = static_cast<quint64>(root["intervalFrames"].toDouble());
+        session->intervalOffset = root["nextInterval"].toInt();
+
+        for (const auto &value : root["tracks"].toArray()) {
+            const auto trackObject = value.toObject();
+            auto track = new Track();
+            track->userName = trackObject["user"].toString();
+            track->channelIndex = static_cast<quint8>(trackObject["channel"].toInt());
+            track->fileName = trackObject["file"].toString();
+            track->firstInterval = trackObject["firstInterval"].toInt();
+            track->lastInterval = trackObject["lastInterval"].toInt();
+
+            const auto frames = static_cast<quint64>(trackObject["frames"].toDouble());
+            track->file.open(sessionDir.absoluteFilePath(track->fileName), sampleRate, 2, frames); // the samples after the last index update are discarded
+
+            session->tracks.insert(buildTrackName(track->userName, track->channelIndex), track);
+        }
+
+        qCDebug(jtJamRecorder) << "Resuming multitrack session" << session->dir << "in interval" << session->intervalOffset;
+
+        return true;
+    }
+
+    return false;
+}
+
+void MultitrackWaveWriter::closeSession(bool finished)
+{
+    if (!session)
+        return;
+
+    for (auto track : session->tracks)
+        track->file.close();
+
+    writeIndex(finished);
+    writeProjectFile();
+
+    delete session;
+    session = nullptr;
+}
+
+void MultitrackWaveWriter::flushSession()
+{
+    if (!session)
+        return;
+
+    for (auto track : session->tracks)
+        track->file.flush();
+
+    writeIndex(false);
+    writeProjectFile();
+}
+
+MultitrackWaveWriter::Track *MultitrackWaveWriter::getTrack(const QString &userName, quint8 channelIndex, int intervalIndex)
+{
+    const QString trackName = buildTrackName(userName, channelIndex);
+    if (session->tracks.contains(trackName))
+        return session->tracks[trackName];
+
+    auto track = new Track();
+    track->userName = userName;
+    track->channelIndex = channelIndex;
+    track->fileName = "audio/" + buildTrackFileName(userName, channelIndex);
+    track->firstInterval = intervalIndex;
+    track->lastInterval = intervalIndex;
+    track->file.open(QDir(session->dir).absoluteFilePath(track->fileName), session->sampleRate, 2); // vorbis decoder output is always stereo
+
+    session->tracks.insert(trackName, track);
+
+    return track;
+}
+
+void MultitrackWaveWriter::writeInterval(const QString &userName, quint8 channelIndex, int intervalIndex, const ninjam::ByteRope &encodedAudio)
+{
+    if (!session)
+        return;
+
+    const int sessionInterval = intervalIndex + session->intervalOffset;
+    auto track = getTrack(userName, channelIndex, sessionInterval);
+    if (!track->file.isOpen())
+        return;
+
+    if (sessionInterval < track->firstInterval) {
+        qCWarning(jtJamRecorder) << "Discarding interval" << intervalIndex << "received after the next intervals in" << track->fileName;
+        return;
+    }
+
+    vorbis::Decoder decoder;
+    decoder.setInputData(encodedAudio);
+    if (!decoder.initialize()) {
+        qCWarning(jtJamRecorder) << "Can't decode the interval" << intervalIndex << "of" << track->fileName;
+        return;
+    }
+
+    SamplesBuffer samples(2);
+    uint decodedFrames = 0;
+    do {
+        const auto &decodedBuffer = decoder.decode(MAX_SAMPLES_PER_DECODE);
+        decodedFrames = decodedBuffer.getFrameLenght();
+        if (decodedFrames > 0)
+            samples.append(decodedBuffer);
+    }
+    while (decodedFrames > 0);
+
+    if (decoder.getSampleRate() != session->sampleRate) {
+        SamplesBuffer resampledSamples(2);
+        SamplesBufferResampler::resample(samples, resampledSamples, decoder.getSampleRate(), session->sampleRate);
+        samples = resampledSamples;
+    }
+
+    // the intervals are always starting in the interval position, the shorter intervals are padded with silence and the longer intervals are truncated
+    const quint64 intervalPosition = static_cast<quint64>(sessionInterval - track->firstInterval) * session->intervalFrames;
+    const quint64 trackFrames = track->file.getFrames();
+    quint64 offset = 0;
+    if (trackFrames > intervalPosition)
+        offset = trackFrames - intervalPosition; // the interval was already written
+    else
+        track->file.writeSilence(intervalPosition - trackFrames);
+
+    const quint64 framesToWrite = qMin(static_cast<quint64>(samples.getFrameLenght()), session->intervalFrames);
+    if (framesToWrite > offset)
+        track->file.write(samples, static_cast<uint>(offset), static_cast<uint>(framesToWrite - offset));
+
+    track->lastInterval = qMax(track->lastInterval, sessionInterval);
+}
+
+bool MultitrackWaveWriter::writeIndex(bool finished)
+{
+    int nextInterval = session->intervalOffset;
+    QJsonArray tracks;
+    for (auto track : session->tracks) {
+        QJsonObject trackObject;
+        trackObject["user"] = track->userName;
+        trackObject["channel"] = track->channelIndex;
+        trackObject["file"] = track->fileName;
+        trackObject["firstInterval"] = track->firstInterval;
+        trackObject["lastInterval"] = track->lastInterval;
+        trackObject["frames"] = static_cast<double>(track->file.getFrames()); // flushed frames, the index is updated after the flush
+        tracks.append(trackObject);
+
+        nextInterval = qMax(nextInterval, track->lastInterval + 1);
+    }
+
+    QJsonObject serverObject;
+    serverObject["host"] = session->server.getHost();
+    serverObject["port"] = session->server.getPort();
+    serverObject["room"] = session->server.getRoom();
+
+    QJsonObject root;
+    root["version"] = INDEX_VERSION;
+    root["server"] = serverObject;
+    root["bpm"] = session->bpm;
+    root["bpi"] = session->bpi;
+    root["sampleRate"] = session->sampleRate;
+    root["intervalFrames"] = static_cast<double>(session->intervalFrames);
+    root["nextInterval"] = nextInterval;
+    root["finished"] = finished;
+    root["tracks"] = tracks;
+
+    QSaveFile indexFile(QDir(session->dir).absoluteFilePath(INDEX_FILE_NAME)); // the previous index is kept if we crash while writing
+    if (!indexFile.open(QFile::WriteOnly)) {
+        qCritical() << "Can't write the multitrack session index in " << session->dir;
+        return false;
+    }
+
+    indexFile.write(QJsonDocument(root).toJson());
+    return indexFile.commit();
+}
+
+void MultitrackWaveWriter::writeProjectFile()
+{
+    int firstInterval = -1;
+    for (auto track : session->tracks) {
+        if (firstInterval < 0 || track->firstInterval < firstInterval)
+            firstInterval = track->firstInterval;
+    }
+
+    const double intervalLenght = static_cast<double>(session->intervalFrames) / session->sampleRate;
+
+    QString stringBuffer("");
+    stringBuffer.append("<REAPER_PROJECT 0.1 \"4.731\" 1416709867").append("\n");
+    stringBuffer.append("  RECORD_PATH \"audio\" \"\"").append("\n");
+    stringBuffer.append("  SAMPLERATE " + QString::number(session->sampleRate) + "  0 0").append("\n");
+    stringBuffer.append("  TEMPO " + QString::number(session->bpm) + " 4 4").append("\n");
+
+    for (auto track : session->tracks) {
+        const QString trackName = buildTrackName(track->userName, track->channelIndex);
+        const QString trackGUID = QUuid::createUuid().toString();
+        const double position = (track->firstInterval - firstInterval) * intervalLenght;
+        const double lenght = static_cast<double>(track->file.getFrames()) / session->sampleRate;
+
+        stringBuffer.append("  <TRACK " + trackGUID).append("\n");
+        stringBuffer.append("    NAME \"" + trackName + "\"").append("\n");
+        stringBuffer.append("    TRACKID " + trackGUID).append("\n");
+        stringBuffer.append("    <ITEM").append("\n");
+        stringBuffer.append("      POSITION " + QString::number(position)).append("\n");
+        stringBuffer.append("      LENGTH " + QString::number(lenght)).append("\n");
+        stringBuffer.append("      IID 1").append("\n");
+        stringBuffer.append("      IGUID " + QUuid::createUuid().toString()).append("\n");
+        stringBuffer.append("      NAME \"" + trackName + "\"").append("\n");
+        stringBuffer.append("      GUID " + trackGUID).append("\n");
+        stringBuffer.append("      <SOURCE WAVE").append("\n");
+        stringBuffer.append("        FILE \"" + track->fileName + "\"").append("\n");
+        stringBuffer.append("      >").append("\n"); // close SOURCE WAVE
+        stringBuffer.append("    >").append("\n"); // close item
+        stringBuffer.append("  >").append("\n"); // close track
+    }
+
+    stringBuffer.append(">"); // close the root tag
+
+    QSaveFile projectFile(QDir(session->dir).absoluteFilePath(PROJECT_FILE_NAME));
+    if (!projectFile.open(QFile::WriteOnly)) {
+        qCritical() << "Can't write the reaper project file in " << session->dir;
+        return;
+    }
+
+    projectFile.write(stringBuffer.toUtf8());
+    projectFile.commit();
+}
+
+QString MultitrackWaveWriter::buildTrackName(const QString &userName, quint8 channelIndex)
+{
+    return userName + " (Channel " + QString::number(channelIndex + 1) + ")";
+}
+
+QString MultitrackWaveWriter::buildTrackFileName(const QString &userName, quint8 channelIndex)
+{
+    QString fileName = buildTrackName(userName, channelIndex) + ".wav";
+    return file::sanitizeFileName(fileName);
+}
@@ -0,0 +1,103 @@
+#ifndef __MULTITRACK_WAVE_WRITER__
+#define __MULTITRACK_WAVE_WRITER__
+
+#include "JamRecorder.h"
+#include "QCoreApplication"
+
+#include <QMutex>
+#include <QWaitCondition>
+#include <QQueue>
+#include <functional>
+
+namespace recorder {
+
+/**
+    Record one WAV file per track (user channel) instead of one ogg file per interval. The
+    encoded intervals are decoded in a dedicated writer thread and appended sample aligned in the
+    track file, the missing intervals are filled with silence. All tracks files are starting in
+    the first interval recorded in the track.
+
+    A session index (INDEX_FILE_NAME, json) and the Reaper project are updated in every interval.
+    If Jamtaba crash the index is used to resume the session when the user is back in the same
+    jam (same server and room, bpm, bpi and sample rate) before RESUME_TIMEOUT, the new intervals are appended
+    after the last interval in the index.
+*/
+
+class MultitrackWaveWriter : public JamMetadataWriter
+{
+
+public:
+    MultitrackWaveWriter();
+    ~MultitrackWaveWriter();
+
+    void write(const Jam &jam) override;
+
+    inline QString getWriterId() const override
+    {
+        return "MultitrackWaveWriter";
+    }
+
+    inline QString getWriterName() const override // Localised
+    {
+        return QCoreApplication::translate("Recorder::MultitrackWaveWriter", "Generate one WAV file per track (Reaper project)");
+    }
+
+    void setJamDir(const QString &newJamName, const QString &recordBasePath) override;
+
+    QString getAudioAbsolutePath(const QString &audioFileName) override;
+    QString getVideoAbsolutePath(const QString &videoFileName) override;
+
+    bool isWritingAudioIntervals() const override;
+    void writeAudioInterval(const QString &userName, quint8 channelIndex, int intervalIndex, const ninjam::ByteRope &encodedAudio, const Jam &jam) override;
+
+    void finish() override;
+
+    void waitForPendingWrites(); // block until the queued intervals are written
+
+    static const QString INDEX_FILE_NAME;
+    static const QString PROJECT_FILE_NAME;
+    static const int RESUME_TIMEOUT; // seconds
+
+private:
+    Q_DISABLE_COPY(MultitrackWaveWriter)
+
+    class WriterThread;
+    struct Track;
+    struct Session;
+
+    typedef std::function<void()> Job;
+
+    void enqueue(const Job &job);
+    void run(); // writer thread loop
+
+    // all these functions are executed in writer thread
+    void startSession(const JamServer &server, int bpm, int bpi, int sampleRate);
+    bool resumeSession(const JamServer &server, int bpm, int bpi, int sampleRate);
+    void closeSession(bool finished);
+    void writeInterval(const QString &userName, quint8 channelIndex, int intervalIndex, const ninjam::ByteRope &encodedAudio);
+    void flushSession();
+    bool writeIndex(bool finished);
+    void writeProjectFile();
+    Track *getTrack(const QString &userName, quint8 channelIndex, int intervalIndex);
+
+    static QString buildTrackName(const QString &userName, quint8 channelIndex);
+    static QString buildTrackFileName(const QString &userName, quint8 channelIndex);
+
+    QString jamDir; // used in caller thread
+
+    Session *session; // used only in writer thread
+    QString recordBasePath; // used only in writer thread
+    QString newSessionDir; // used only in writer thread
+
+    WriterThread *thread;
+    QQueue<Job> jobs;
+    QMutex mutex;
+    QWaitCondition jobsAvailable;
+    QWaitCondition jobsFinished;
+    bool runningJob;
+    bool stopRequested;
+};
+
+} // namespace
+
+#endif
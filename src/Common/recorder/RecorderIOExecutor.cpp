@@ -0,0 +1,298 @@
+#include "RecorderIOExecutor.h"
+
+#include <QThread>
+#include <QMap>
+#include <QDir>
+#include <QStorageInfo>
+#include <QDebug>
+
+#ifdef Q_OS_WIN
+    #include <windows.h>
+    #include <io.h>
+#else
+    #include <unistd.h>
+#endif
+
+#include "../log/Logging.h"
+
+using recorder::RecorderIOExecutor;
+using recorder::RecorderIOMetrics;
+
+const quint64 RecorderIOExecutor::MAX_QUEUED_BYTES = 64 * 1024 * 1024; // minutes of intervals for all users, only reached when the disk is stalled
+const int RecorderIOExecutor::MAX_BLOCKING_TIME = 20; // the callers are the GUI and the encoding threads
+const int RecorderIOExecutor::COALESCING_BUFFER_SIZE = 256 * 1024;
+const int RecorderIOExecutor::SYNC_INTERVAL = 5000;
+
+namespace {
+
+QMutex executorsMutex;
+QMap<QString, std::weak_ptr<RecorderIOExecutor>> executors; // the key is the disk root path
+
+} // namespace
+
+class RecorderIOExecutor::WriterThread : public QThread
+{
+public:
+    explicit WriterThread(RecorderIOExecutor *executor) :
+        executor(executor)
+    {
+        setObjectName("Recorder IO " + executor->getDiskPath());
+    }
+
+protected:
+    void run() override
+    {
+        executor->run();
+    }
+
+private:
+    RecorderIOExecutor *executor;
+};
+
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+RecorderIOExecutor::RecorderIOExecutor(const QString &diskPath, quint64 maxQueuedBytes) :
+    diskPath(diskPath),
+    maxQueuedBytes(maxQueuedBytes),
+    queuedBytes(0),
+    writing(false),
+    stopRequested(false),
+    writtenBytes(0),
+    writtenRequests(0),
+    totalLatency(0),
+    maxLatency(0),
+    droppedWrites(0),
+    thread(new WriterThread(this))
+{
+    coalescingBuffer.reserve(COALESCING_BUFFER_SIZE);
+    clock.start();
+    lastSync.start();
+
+    thread->start(QThread::LowPriority);
+}
+
+RecorderIOExecutor::~RecorderIOExecutor()
+{
+    {
+        QMutexLocker locker(&mutex);
+        stopRequested = true;
+        requestsAvailable.wakeAll();
+    }
+
+    thread->wait();
+    delete thread;
+}
+
+std::shared_ptr<RecorderIOExecutor> RecorderIOExecutor::getExecutor(const QString &path)
+{
+    QStorageInfo storage(path);
+    const QString diskPath = storage.isValid() ? storage.rootPath() : QDir(path).absolutePath(); // the record path can be created later
+
+    QMutexLocker locker(&executorsMutex);
+    auto executor = executors.value(diskPath).lock();
+    if (!executor) {
+        executor = std::make_shared<RecorderIOExecutor>(diskPath);
+        executors.insert(diskPath, executor);
+        qCDebug(jtJamRecorder) << "Creating recorder IO executor for" << diskPath;
+    }
+
+    return executor;
+}
+
+RecorderIOMetrics RecorderIOExecutor::getAllExecutorsMetrics()
+{
+    RecorderIOMetrics allMetrics;
+    quint64 executorsCount = 0;
+
+    QMutexLocker locker(&executorsMutex);
+    for (const auto &weakExecutor : executors) {
+        auto executor = weakExecutor.lock();
+        if (!executor)
+            continue;
+
+        const auto metrics = executor->getMetrics();
+        allMetrics.queuedBytes += metrics.queuedBytes;
+        allMetrics.writtenBytes += metrics.writtenBytes;
+        allMetrics.averageWriteLatency += metrics.averageWriteLatency;
+        allMetrics.maxWriteLatency = qMax(allMetrics.maxWriteLatency, metrics.maxWriteLatency);
+        allMetrics.droppedWrites += metrics.droppedWrites;
+        executorsCount++;
+    }
+
+    if (executorsCount > 0)
+        allMetrics.averageWriteLatency /= executorsCount;
+
+    return allMetrics;
+}
+
+RecorderIOMetrics RecorderIOExecutor::getMetrics() const
+{
+    QMutexLocker locker(&mutex);
+
+    RecorderIOMetrics metrics;
+    metrics.queuedBytes = queuedBytes;
+    metrics.writtenBytes = writtenBytes;
+    metrics.averageWriteLatency = writtenRequests > 0 ? totalLatency / writtenRequests : 0;
+    metrics.maxWriteLatency = maxLatency;
+    metrics.droppedWrites = droppedWrites;
+
+    return metrics;
+}
+
+bool RecorderIOExecutor::write(const QString &filePath, const ninjam::ByteRope &data)
+{
+    const quint64 bytes = data.size();
+
+    QMutexLocker locker(&mutex);
+
+    // a write bigger than the queue is accepted when the queue is empty
+    if (queuedBytes > 0 && queuedBytes + bytes > maxQueuedBytes) {
+        QElapsedTimer waitTimer;
+        waitTimer.start();
+        while (queuedBytes > 0 && queuedBytes + bytes > maxQueuedBytes) {
+            const qint64 remainingTime = MAX_BLOCKING_TIME - waitTimer.elapsed();
+            if (remainingTime <= 0 || !spaceAvailable.wait(&mutex, static_cast<unsigned long>(remainingTime)))
+                break;
+        }
+
+        if (queuedBytes > 0 && queuedBytes + bytes > maxQueuedBytes) {
+            droppedWrites++;
+            qCWarning(jtJamRecorder) << "The disk is too slow, dropping" << filePath;
+            return false;
+        }
+    }
+
+    requests.enqueue({ filePath, data, clock.elapsed() });
+    queuedBytes += bytes;
+    requestsAvailable.wakeOne();
+
+    return true;
+}
+
+void RecorderIOExecutor::waitForPendingWrites()
+{
+    QMutexLocker locker(&mutex);
+    while (!requests.isEmpty() || writing)
+        requestsFinished.wait(&mutex);
+}
+
+void RecorderIOExecutor::run()
+{
+    forever {
+        QMutexLocker locker(&mutex);
+        while (requests.isEmpty() && !stopRequested) {
+            if (unsyncedFiles.isEmpty()) {
+                requestsAvailable.wait(&mutex);
+                continue;
+            }
+
+            const qint64 timeToSync = qMax(static_cast<qint64>(0), SYNC_INTERVAL - lastSync.elapsed());
+            if (!requestsAvailable.wait(&mutex, static_cast<unsigned long>(timeToSync))) {
+                locker.unlock();
+                syncClosedFiles(); // no more writes for now, the closed files are synced anyway
+                locker.relock();
+            }
+        }
+
+        if (requests.isEmpty()) {
+            locker.unlock();
+            closeCurrentFile();
+            syncClosedFiles();
+            return; // stop requested and all writes finished
+        }
+
+        const WriteRequest request = requests.dequeue();
+        const quint64 requestBytes = request.data.size();
+
+        writing = true;
+        locker.unlock();
+
+        writeRequest(request);
+
+        locker.relock();
+        const double latency = clock.elapsed() - request.timestamp;
+        queuedBytes -= requestBytes;
+        writtenBytes += requestBytes;
+        writtenRequests++;
+        totalLatency += latency;
+        maxLatency = qMax(maxLatency, latency);
+        writing = false;
+
+        const bool idle = requests.isEmpty();
+        spaceAvailable.wakeAll();
+        if (idle) {
+            locker.unlock();
+            closeCurrentFile(); // no more writes in this file for now
+            locker.relock();
+            requestsFinished.wakeAll();
+        }
+    }
+}
+
+bool RecorderIOExecutor::writeRequest(const WriteRequest &request)
+{
+    closeCurrentFile();
+
+    currentFile.setFileName(request.filePath);
+    if (!currentFile.open(QFile::WriteOnly | QFile::Truncate | QFile::Unbuffered)) { // using the coalescing buffer
+        qCritical() << "can't open file " << request.filePath << currentFile.errorString();
+        return false;
+    }
+
+    bool success = true;
+    for (const auto &chunk : request.data.getChunks()) {
+        if (coalescingBuffer.size() + chunk.size() > COALESCING_BUFFER_SIZE && !coalescingBuffer.isEmpty()) {
+            success = success && currentFile.write(coalescingBuffer) == coalescingBuffer.size();
+            coalescingBuffer.resize(0);
+        }
+
+        if (chunk.size() >= COALESCING_BUFFER_SIZE)
+            success = success && currentFile.write(chunk) == chunk.size(); // big chunks are not copied
+        else
+            coalescingBuffer.append(chunk);
+    }
+
+    if (!coalescingBuffer.isEmpty()) {
+        success = success && currentFile.write(coalescingBuffer) == coalescingBuffer.size();
+        coalescingBuffer.resize(0);
+    }
+
+    if (!success)
+        qCritical() << "Error writing " << request.filePath << currentFile.errorString();
+
+    return success;
+}
+
+void RecorderIOExecutor::closeCurrentFile()
+{
+    if (!currentFile.isOpen())
+        return;
+
+    currentFile.flush();
+    unsyncedFiles.append(currentFile.fileName());
+    currentFile.close();
+
+    if (lastSync.elapsed() >= SYNC_INTERVAL) // all files closed since the last sync are synced together
+        syncClosedFiles();
+}
+
+void RecorderIOExecutor::syncClosedFiles()
+{
+    for (const auto &filePath : qAsConst(unsyncedFiles)) {
+        QFile file(filePath);
+        if (!file.open(QFile::ReadWrite) || !syncFile(file)) // ReadWrite is not truncating the file
+            qCWarning(jtJamRecorder) << "Can't sync" << filePath << file.errorString();
+    }
+
+    unsyncedFiles.clear();
+    lastSync.restart();
+}
+
+bool RecorderIOExecutor::syncFile(QFile &file)
+{
+#ifdef Q_OS_WIN
+    return FlushFileBuffers(reinterpret_cast<HANDLE>(_get_osfhandle(file.handle()))) != 0;
+#else
+    return ::fsync(file.handle()) == 0;
+#endif
+}
@@ -0,0 +1,124 @@
+#ifndef __RECORDER_IO_EXECUTOR__
+#define __RECORDER_IO_EXECUTOR__
+
+#include <QString>
+#include <QStringList>
+#include <QQueue>
+#include <QFile>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QElapsedTimer>
+
+#include "ninjam/ByteRope.h"
+
+#include <memory>
+
+namespace recorder {
+
+struct RecorderIOMetrics
+{
+    quint64 queuedBytes = 0; // bytes waiting to be written
+    quint64 writtenBytes = 0;
+    double averageWriteLatency = 0; // ms, from the write request to the data written in disk
+    double maxWriteLatency = 0; // ms
+    quint64 droppedWrites = 0; // the queue was full, the interval was not recorded
+};
+
+/**
+    Write the recorded files in a dedicated thread, instead of the global thread pool used to
+    decode the intervals. There is one executor (and one writer thread) for each disk, shared
+    by all recorders writing in the disk, so the files are written in the requested order and
+    a slow disk is not delaying the writes in other disks.
+
+    The queue is bounded by MAX_QUEUED_BYTES. When the disk can't keep up the callers are
+    blocked at most MAX_BLOCKING_TIME waiting for free space, after that the write is dropped
+    (and counted in the metrics) instead of growing the queue forever.
+
+    The small chunks of each write (ninjam messages payloads) are copied in a
+    COALESCING_BUFFER_SIZE buffer, so the disk receives a few large writes instead of one write
+    per chunk. The closed files are synced (fsync) together, at most once each SYNC_INTERVAL, and
+    every file is synced at most SYNC_INTERVAL after it is closed (even if no more files are written).
+*/
+
+class RecorderIOExecutor
+{
+public:
+    explicit RecorderIOExecutor(const QString &diskPath, quint64 maxQueuedBytes = MAX_QUEUED_BYTES);
+    ~RecorderIOExecutor(); // the queued writes are finished
+
+    // the file is replaced, return false when the write is dropped because the queue is full
+    bool write(const QString &filePath, const ninjam::ByteRope &data);
+
+    void waitForPendingWrites();
+
+    RecorderIOMetrics getMetrics() const;
+
+    QString getDiskPath() const;
+
+    // one executor for each disk, the executor is deleted when the last recorder using the disk is deleted
+    static std::shared_ptr<RecorderIOExecutor> getExecutor(const QString &path);
+    static RecorderIOMetrics getAllExecutorsMetrics();
+
+    static const quint64 MAX_QUEUED_BYTES;
+    static const int MAX_BLOCKING_TIME; // ms
+    static const int COALESCING_BUFFER_SIZE; // bytes
+    static const int SYNC_INTERVAL; // ms
+
+private:
+    Q_DISABLE_COPY(RecorderIOExecutor)
+
+    struct WriteRequest
+    {
+        QString filePath;
+        ninjam::ByteRope data;
+        qint64 timestamp; // ms
+    };
+
+    class WriterThread;
+
+    void run(); // writer thread loop
+    bool writeRequest(const WriteRequest &request);
+    void closeCurrentFile();
+    void syncClosedFiles();
+
+    static bool syncFile(QFile &file);
+
+    const QString diskPath;
+    const quint64 maxQueuedBytes;
+
+    QQueue<WriteRequest> requests;
+    quint64 queuedBytes;
+    bool writing;
+    bool stopRequested;
+
+    mutable QMutex mutex;
+    QWaitCondition requestsAvailable;
+    QWaitCondition spaceAvailable;
+    QWaitCondition requestsFinished;
+
+    // metrics, protected by 'mutex'
+    quint64 writtenBytes;
+    quint64 writtenRequests;
+    double totalLatency;
+    double maxLatency;
+    quint64 droppedWrites;
+
+    // used only in writer thread
+    QFile currentFile;
+    QByteArray coalescingBuffer;
+    QStringList unsyncedFiles; // closed files waiting for the next sync
+    QElapsedTimer lastSync;
+
+    QElapsedTimer clock;
+
+    WriterThread *thread;
+};
+
+inline QString RecorderIOExecutor::getDiskPath() const
+{
+    return diskPath;
+}
+
+} // namespace
+
+#endif
@@ -1,4 +1,5 @@
 #include "FFMpegDemuxer.h"
+#include "VideoFramesPool.h"
 
 #include <QDebug>
 #include <QImage>
@@ -9,11 +10,10 @@ FFMpegDemuxer::FFMpegDemuxer(QObject *parent, const QByteArray &encodedData) :
     QObject(parent),
     formatContext(nullptr),
     avioContext(nullptr),
+    codecContext(nullptr),
     swsContext(nullptr),
     frame(nullptr),
-    frameRGB(nullptr),
-    rgbBuffer(nullptr),
-    buffer(nullptr),
+    draining(false),
     encodedData(encodedData)
 {
     av_register_all();
@@ -24,39 +24,41 @@ FFMpegDemuxer::FFMpegDemuxer(QObject *parent, const QByteArray &encodedData) :
 
 FFMpegDemuxer::~FFMpegDemuxer()
 {
-    close();
+    closeInput();
+    closeDecoder();
 }
 
-void FFMpegDemuxer::close()
+void FFMpegDemuxer::closeInput()
 {
     if (formatContext) {
         avformat_close_input(&formatContext);
         formatContext = nullptr;
-        avioContext = nullptr;
-        //codecContext = nullptr;
-        swsContext = nullptr;
     }
 
-    if (frame) {
-        av_free(frame);
-        frame = nullptr;
+    if (avioContext) { // custom IO context is not released by avformat_close_input
+        av_freep(&avioContext->buffer);
+        av_freep(&avioContext);
     }
 
-    if (frameRGB) {
-        av_free(frameRGB);
-        frameRGB = nullptr;
-    }
+    encodedBuffer.close();
+}
 
-    if (rgbBuffer) {
-        delete [] rgbBuffer;
-        rgbBuffer = nullptr;
+void FFMpegDemuxer::closeDecoder()
+{
+    if (codecContext) {
+        avcodec_free_context(&codecContext);
+        codecContext = nullptr;
     }
 
-    if (buffer) {
-        //av_free(buffer);
-        buffer = nullptr;
+    if (frame) {
+        av_frame_free(&frame);
+        frame = nullptr;
     }
 
+    if (swsContext) {
+        sws_freeContext(swsContext);
+        swsContext = nullptr;
+    }
 }
 
 int FFMpegDemuxer::readCallback(void *stream, uint8_t *buffer, int bufferSize)
@@ -66,21 +68,26 @@ int FFMpegDemuxer::readCallback(void *stream, uint8_t *buffer, int bufferSize)
 
     auto st = reinterpret_cast<QIODevice *>(stream);
 
-    if (st)
-        return st->read((char *)buffer, bufferSize);
+    if (st) {
+        auto bytesReaded = st->read((char *)buffer, bufferSize);
+        return bytesReaded > 0 ? static_cast<int>(bytesReaded) : AVERROR_EOF;
+    }
 
     return 0;
 }
 
-bool FFMpegDemuxer::open()
+bool FFMpegDemuxer::open(const QByteArray &encodedData)
 {
+    closeInput();
+
+    this->encodedData = encodedData;
     encodedBuffer.setBuffer(&(this->encodedData));
     if(!encodedBuffer.open(QIODevice::ReadOnly)) {
         qCritical() << "Error opening demuxer " << encodedBuffer.errorString();
         return false;
     }
 
-    buffer = (unsigned char*)av_malloc(FFMPEG_BUFFER_SIZE);
+    auto buffer = (unsigned char*)av_malloc(FFMPEG_BUFFER_SIZE);
 
     formatContext = avformat_alloc_context();
 
@@ -113,7 +120,19 @@ bool FFMpegDemuxer::open()
         return false;
     }
 
-    auto codecContext = stream->codec;
+    return openDecoder(stream);
+}
+
+bool FFMpegDemuxer::openDecoder(AVStream *stream)
+{
+    draining = false;
+
+    if (codecContext && codecContext->codec_id == stream->codecpar->codec_id) {
+        avcodec_flush_buffers(codecContext); // reusing the decoder opened in previous intervals
+        return true;
+    }
+
+    closeDecoder();
 
     /* find decoder for the stream */
     auto decoder = avcodec_find_decoder(stream->codecpar->codec_id);
@@ -122,11 +141,18 @@ bool FFMpegDemuxer::open()
         return false;
     }
 
+    codecContext = avcodec_alloc_context3(decoder);
     if (!codecContext) {
         qWarning() << "Error in FFMpegDemuxer::open, the codecContext is null";
         return false;
     }
 
+    int ret = avcodec_parameters_to_context(codecContext, stream->codecpar);
+    if (ret < 0) {
+        qCritical() << av_error_to_qt_string(ret);
+        return false;
+    }
+
     ret = avcodec_open2(codecContext, decoder, nullptr);
     if (ret < 0) {
         qCritical() << av_error_to_qt_string(ret);
@@ -146,108 +172,111 @@ uint FFMpegDemuxer::getFrameRate() const
 {
     if (formatContext && formatContext->nb_streams > 0) {
         auto firstStream = formatContext->streams[0];
-        if (firstStream && firstStream->codec) {
+        if (firstStream && firstStream->codec && firstStream->codec->framerate.num > 0) {
             return firstStream->codec->framerate.num;
         }
     }
 
+    if (codecContext)
+        return codecContext->framerate.num;
+
     return 0;
 }
 
-bool FFMpegDemuxer::decode()
+bool FFMpegDemuxer::decodeNextFrame(QImage &image, bool convert)
 {
-    QList<QImage> decodedImages;
-
-    if (!open()) {
-        qCritical() << "Can't open the video decoder!";
-        emit imagesDecoded(decodedImages, getFrameRate());
+    if (!formatContext || !codecContext || !frame)
         return false;
-    }
 
-    if (!formatContext || formatContext->nb_streams <= 0)
-        return false;
+    forever {
+        int ret = avcodec_receive_frame(codecContext, frame);  // got a frame?
+        if (ret == 0) {
+            if (!frame->width || !frame->height) // 0 size images are skipped
+                continue;
 
-    auto codecContext = formatContext->streams[0]->codec;
+            if (!convert)
+                return true;
 
-    if (!codecContext)
-        return false;
+            int width = (codecContext->width > 0) ? codecContext->width : frame->width;
+            int height = (codecContext->height > 0) ? codecContext->height : frame->height;
 
-    /* initialize packet, set data to NULL, let the demuxer fill it */
-    AVPacket packet;
-    packet.data = nullptr;
-    packet.size = 0;
+            // the images buffers are reused, the images already showed are released to the pool
+            if (image.size() != QSize(width, height) || image.format() != QImage::Format_RGB32)
+                image = VideoFramesPool::getInstance().takeImage(QSize(width, height), QImage::Format_RGB32);
 
-    int ret = 0;
-
-    /* read frames */
-    while ((ret = av_read_frame(formatContext, &packet)) == 0)
-    {
-
-        int framesDecoded = 0;
-
-        while (framesDecoded <= 0)
-        {
-            ret = avcodec_send_packet(codecContext, &packet);
-
-            if (ret != 0) { // error
-                if (ret != AVERROR(EAGAIN)) {
-                    qCritical() << "error decoding video frame" << av_error_to_qt_string(ret) << ret;
-                    emit imagesDecoded(decodedImages, getFrameRate());
-                }
+            if (!convertFrame(image)) {
+                qCritical() << "Cannot initialize the conversion context!";
                 return false;
             }
 
-            while((ret = avcodec_receive_frame(codecContext, frame)) == 0)  // got a frame?
-            {
-                int width = (codecContext->width > 0) ? codecContext->width : frame->width;
-                int height = (codecContext->height > 0) ? codecContext->height : frame->height;
-
-                if (!frameRGB) {
-                    frameRGB = av_frame_alloc();
+            return true;
+        }
 
-                    // Determine required buffer size and allocate buffer
-                    int numBytes = av_image_get_buffer_size(AV_PIX_FMT_RGB24, width, height, 1);
-                    rgbBuffer = new uint8_t[numBytes];
+        if (ret == AVERROR_EOF) // all frames decoded
+            return false;
 
-                    // Assign appropriate parts of buffer to image planes in pFrameRGB
-                    av_image_fill_arrays(frameRGB->data, frameRGB->linesize, rgbBuffer, AV_PIX_FMT_RGB24, width, height, 1);
-                }
+        if (ret != AVERROR(EAGAIN) || draining) {
+            qCritical() << "error decoding video frame in avcodec_receive_frame" << av_error_to_qt_string(ret) << ret;
+            return false;
+        }
 
-                // Convert the image format (init the context the first time)
-                AVPixelFormat sourcePixelFormat = codecContext->pix_fmt;
-                AVPixelFormat destinationPixelFormat = AV_PIX_FMT_RGB24;
+        // the decoder needs more packets
+        AVPacket packet = AVPacket();
+        av_init_packet(&packet);
+        packet.data = nullptr;
+        packet.size = 0;
 
-                if (!frame->width || !frame->height) // 0 size images are skipped
-                    continue;
+        if (av_read_frame(formatContext, &packet) != 0) {
+            avcodec_send_packet(codecContext, nullptr); // end of interval, draining the buffered frames
+            draining = true;
+            continue;
+        }
 
-                swsContext = sws_getCachedContext(swsContext, width, height, sourcePixelFormat, width, height, destinationPixelFormat, SWS_BICUBIC, nullptr, nullptr, nullptr);
+        ret = avcodec_send_packet(codecContext, &packet);
+        av_packet_unref(&packet);
 
-                if(!swsContext){
-                    qCritical() << "Cannot initialize the conversion context!";
-                    emit imagesDecoded(decodedImages, getFrameRate());
-                    return false;
-                }
-                sws_scale(swsContext, frame->data, frame->linesize, 0, height, frameRGB->data, frameRGB->linesize);
+        if (ret != 0) {
+            qCritical() << "error decoding video frame" << av_error_to_qt_string(ret) << ret;
+            return false;
+        }
+    }
+}
 
-                // Convert the frame to QImage
-                QImage img(width, height, QImage::Format_RGB888);
+bool FFMpegDemuxer::decode()
+{
+    QList<QImage> decodedImages;
 
-                for(int y=0; y < height; y++)
-                    memcpy(img.scanLine(y), frameRGB->data[0] + y * frameRGB->linesize[0], width * 3);
+    if (!open(encodedData)) {
+        qCritical() << "Can't open the video decoder!";
+        emit imagesDecoded(decodedImages, getFrameRate());
+        return false;
+    }
 
-                decodedImages << img;
+    QImage image;
+    while (decodeNextFrame(image)) {
+        decodedImages << image;
+        image = QImage(); // the next frame is decoded in a new image
+    }
 
-                framesDecoded++;
-            }
+    emit imagesDecoded(decodedImages, getFrameRate());
+    return true;
+}
 
-            if (ret != 0 && ret != AVERROR(EAGAIN)) {
-                qCritical() << "error decoding video frame in avcodec_receive_frame" << av_error_to_qt_string(ret) << ret;
-                emit imagesDecoded(decodedImages, getFrameRate());
-                return false;
-            }
-        }
+bool FFMpegDemuxer::convertFrame(QImage &image)
+{
+    if (frame->format == AV_PIX_FMT_YUV420P) { // converting (and scaling if necessary) straight to image scanlines
+        converter.yuv420ToRgb(frame->data, frame->linesize, frame->width, frame->height, image);
+        return true;
     }
 
-    emit imagesDecoded(decodedImages, getFrameRate());
+    auto sourcePixelFormat = static_cast<AVPixelFormat>(frame->format);
+    swsContext = sws_getCachedContext(swsContext, frame->width, frame->height, sourcePixelFormat, image.width(), image.height(), AV_PIX_FMT_RGB32, SWS_BICUBIC, nullptr, nullptr, nullptr);
+    if (!swsContext)
+        return false;
+
+    uint8_t *destination[4] = { image.bits(), nullptr, nullptr, nullptr };
+    int destinationStrides[4] = { image.bytesPerLine(), 0, 0, 0 };
+    sws_scale(swsContext, frame->data, frame->linesize, 0, frame->height, destination, destinationStrides);
+
     return true;
 }
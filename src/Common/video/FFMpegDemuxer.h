@@ -2,43 +2,60 @@
 #define FFMPEGDEMUXER_H
 
 #include "FFMpegCommon.h"
+#include "VideoFrameConverter.h"
 
 #include <QByteArray>
 #include <QDataStream>
 #include <QBuffer>
 #include <QImage>
 
+/**
+    Decode the video frames of one interval. The frames can be decoded all at once (decode) or
+    one by one (open and decodeNextFrame). The decoder is kept open when the next interval is
+    opened, so the same instance can be used to decode all intervals from a user.
+*/
+
 class FFMpegDemuxer : public QObject
 {
 
     Q_OBJECT
 
 public:
-    FFMpegDemuxer(QObject *parent, const QByteArray &encodedData);
+    FFMpegDemuxer(QObject *parent = nullptr, const QByteArray &encodedData = QByteArray());
     ~FFMpegDemuxer();
 
-    bool decode();
+    bool decode(); // decode all frames and emit imagesDecoded
+
+    bool open(const QByteArray &encodedData); // start a new interval, the decoder is reused
+
+    // 'image' is reused if it has the right size, or taken from the frames pool. The frame is
+    // decoded but not converted when 'convert' is false (frames dropped by the player)
+    bool decodeNextFrame(QImage &image, bool convert = true);
+
+    uint getFrameRate() const;
 
 signals:
     void imagesDecoded(QList<QImage> images, uint frameRate);
 private:
     AVFormatContext *formatContext;
     AVIOContext *avioContext;
-    SwsContext *swsContext;
+    AVCodecContext *codecContext; // shared by all intervals
+    SwsContext *swsContext; // used only when the decoded pictures are not YUV420P
     AVFrame *frame;
-    AVFrame *frameRGB;
-    uint8_t *rgbBuffer;
+    bool draining; // all packets sent to decoder
 
-    unsigned char *buffer; // avio buffer used in callback
+    VideoFrameConverter converter;
 
     QByteArray encodedData;
     QBuffer encodedBuffer;
 
     static int readCallback(void *stream, uint8_t *buffer, int bufferSize);
 
-    void close();
-    bool open();
-    uint getFrameRate() const;
+    void closeInput();
+    void closeDecoder();
+    bool openDecoder(AVStream *stream);
+
+    bool convertFrame(QImage &image);
 };
 
 #endif // FFMPEGDEMUXER_H
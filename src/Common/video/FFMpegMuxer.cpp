@@ -1,4 +1,5 @@
 #include "FFMpegMuxer.h"
+#include "VideoFramesPool.h"
 
 #include <cstring>
 
@@ -213,15 +214,13 @@ bool FFMpegMuxer::finishCurrentInterval()
     initialized = false;
     encodedFrames = 0;
 
-    if (frame) {
-        av_frame_free(&frame);
-        frame = nullptr;
-    }
+    // the pictures are returned to the pool and reused in the next interval
+    auto &pool = VideoFramesPool::getInstance();
+    pool.releasePicture(frame);
+    frame = nullptr;
 
-    if (tempFrame) {
-        av_frame_free(&tempFrame);
-        tempFrame = nullptr;
-    }
+    pool.releasePicture(tempFrame);
+    tempFrame = nullptr;
 
     if (codecContext) {
         avcodec_free_context(&codecContext);
@@ -422,26 +421,6 @@ bool FFMpegMuxer::doEncodeAudioFrame()
 /**************************************************************/
 /* video output */
 
-AVFrame *FFMpegMuxer::allocPicture(enum AVPixelFormat pixelFormat, int width, int height)
-{
-    auto picture = av_frame_alloc();
-    if (!picture)
-        return nullptr;
-
-    picture->format = pixelFormat;
-    picture->width  = width;
-    picture->height = height;
-
-    /* allocate the buffers for the frame data */
-    int ret = av_frame_get_buffer(picture, 32);
-    if (ret < 0) {
-        qCritical() << "Could not allocate frame data.";
-        return nullptr;
-    }
-
-    return picture;
-}
-
 bool FFMpegMuxer::openVideoCodec(AVCodec *codec, AVDictionary **opts)
 {
     if (!opts) {
@@ -455,8 +434,9 @@ bool FFMpegMuxer::openVideoCodec(AVCodec *codec, AVDictionary **opts)
         return false;
     }
 
-    /* allocate and init a re-usable frame */
-    frame = allocPicture(codecContext->pix_fmt, codecContext->width, codecContext->height);
+    /* the pictures are reused in all intervals, they are allocated only when the video resolution is changed */
+    auto &pool = VideoFramesPool::getInstance();
+    frame = pool.takePicture(codecContext->pix_fmt, codecContext->width, codecContext->height);
 
     if (!frame) {
         qCritical() << "Could not allocate video frame";
@@ -466,7 +446,7 @@ bool FFMpegMuxer::openVideoCodec(AVCodec *codec, AVDictionary **opts)
     /* If the output format is not YUV420P, then a temporary YUV420P picture is needed too. It is then converted to the required output format. */
     tempFrame = nullptr;
     if (codecContext->pix_fmt != AV_PIX_FMT_YUV420P) {
-        tempFrame = allocPicture(AV_PIX_FMT_YUV420P, codecContext->width, codecContext->height);
+        tempFrame = pool.takePicture(AV_PIX_FMT_YUV420P, codecContext->width, codecContext->height);
         if (!tempFrame) {
             qCritical() << "Could not allocate temporary picture";
             return false;
@@ -478,66 +458,13 @@ bool FFMpegMuxer::openVideoCodec(AVCodec *codec, AVDictionary **opts)
 
 void FFMpegMuxer::imageToYuvPicture(const QImage &image, AVFrame *picture, int width, int height)
 {
-
     if (!picture)
         return;
 
-    //avoiding crash when camera preview is resized
-    width = qMin(width, image.width());
-    height = qMin(height, image.height());
-
-    // Preparing the buffer to get YUV420P data
-    auto size = av_image_get_buffer_size(AV_PIX_FMT_YUV420P, width, height, 1);
-    auto pic_dat = (uint8_t *) av_malloc(size);
-
-    // Transforming data from RGB to YUV420P
-    RGBtoYUV420P(image.bits(), pic_dat, image.depth()/8, true, width, height);
+    // converting (and scaling when the image size is not the video resolution) straight to the picture buffers
+    converter.rgbToYuv420(image, picture->data, picture->linesize, width, height);
 
     picture->quality = 0;
-
-    // Filling AVFrame with YUV420P data
-    av_image_fill_arrays(picture->data, picture->linesize, pic_dat, AV_PIX_FMT_YUV420P, width, height, 1);
-}
-
-void FFMpegMuxer::RGBtoYUV420P(const uint8_t *bufferRGB, uint8_t *bufferYUV, uint rgbIncrement, bool swapRGB, int width, int height)
-{
-    if (!bufferRGB || !bufferYUV)
-        return;
-
-    const unsigned iPlaneSize = width * height;
-    const unsigned iHalfWidth = width >> 1;
-
-    // get pointers to the data
-    uint8_t *yplane  = bufferYUV;
-    uint8_t *uplane  = bufferYUV + iPlaneSize;
-    uint8_t *vplane  = bufferYUV + iPlaneSize + (iPlaneSize >> 2);
-    const uint8_t *bufferRGBIndex = bufferRGB;
-
-    int iRGBIdx[3];
-    iRGBIdx[0] = 0;
-    iRGBIdx[1] = 1;
-    iRGBIdx[2] = 2;
-    if (swapRGB)  {
-        iRGBIdx[0] = 2;
-        iRGBIdx[2] = 0;
-    }
-
-    for (int y = 0; y < (int) height; y++) {
-         uint8_t *yline  = yplane + (y * width);
-         uint8_t *uline  = uplane + ((y >> 1) * iHalfWidth);
-         uint8_t *vline  = vplane + ((y >> 1) * iHalfWidth);
-
-         for (int x=0; x<width; x+=2) {
-              RGBtoYUV(bufferRGBIndex[iRGBIdx[0]], bufferRGBIndex[iRGBIdx[1]], bufferRGBIndex[iRGBIdx[2]], *yline, *uline, *vline);
-              bufferRGBIndex += rgbIncrement;
-              yline++;
-              RGBtoYUV(bufferRGBIndex[iRGBIdx[0]], bufferRGBIndex[iRGBIdx[1]], bufferRGBIndex[iRGBIdx[2]], *yline, *uline, *vline);
-              bufferRGBIndex += rgbIncrement;
-              yline++;
-              uline++;
-              vline++;
-         }
-    }
 }
 
 void FFMpegMuxer::fillFrameWithImageData(const QImage &image)
@@ -555,7 +482,7 @@ void FFMpegMuxer::fillFrameWithImageData(const QImage &image)
 
     if (codecContext->pix_fmt != AV_PIX_FMT_YUV420P) { /* need image convertion? as we only generate a YUV420P picture, we must convert it to the codec pixel format if needed */
         if (!swsContext) {
-            swsContext = sws_getContext(image.width(), image.height(), AV_PIX_FMT_YUV420P, codecContext->width, codecContext->height, codecContext->pix_fmt, SWS_BICUBIC, NULL, NULL, NULL);
+            swsContext = sws_getContext(codecContext->width, codecContext->height, AV_PIX_FMT_YUV420P, codecContext->width, codecContext->height, codecContext->pix_fmt, SWS_BICUBIC, NULL, NULL, NULL);
             if (!swsContext) {
                 qCritical() << "Could not initialize the conversion context";
                 return;
@@ -607,14 +534,9 @@ bool FFMpegMuxer::doEncodeVideoFrame(const QImage &image)
     // send the image to encoder, send nullpr if finishing
     int ret = avcodec_send_frame(codecContext, (!image.isNull()) ? frame : nullptr);
 
-    if (!image.isNull()) {
-        // releasing the allocated memory - fix https://github.com/elieserdejesus/JamTaba/issues/951
-        av_freep(frame);
-
-        if (ret != 0 && ret != AVERROR_EOF) {
-            qCritical() << "Error encoding video frame: " << av_error_to_qt_string(ret) << ret;
-            return false;
-        }
+    if (!image.isNull() && ret != 0 && ret != AVERROR_EOF) {
+        qCritical() << "Error encoding video frame: " << av_error_to_qt_string(ret) << ret;
+        return false;
     }
 
     // get the encoded packet
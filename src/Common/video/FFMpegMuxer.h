@@ -9,6 +9,7 @@
 #include <QThreadPool>
 
 #include "FFMpegCommon.h"
+#include "VideoFrameConverter.h"
 
 #include <memory>
 
@@ -70,10 +71,8 @@ private:
     bool doEncodeAudioFrame(); // TODO add a SamplesBuffer parameter
 
     AVFrame *allocAudioFrame(enum AVSampleFormat sampleFormat, uint64_t channelLayout, int sampleRate, int nbSamples);
-    AVFrame *allocPicture(enum AVPixelFormat pixelFormat, int width, int height);
     void imageToYuvPicture(const QImage &image, AVFrame *picture, int width, int height);
     void fillFrameWithImageData(const QImage &image);
-    void RGBtoYUV420P(const uint8_t *bufferRGB, uint8_t *bufferYUV, uint rgbIncrement, bool swapRGB, int width, int height);
 
     void initialize();
 
@@ -96,6 +95,8 @@ private:
     AVFrame *tempFrame;
     SwsContext *swsContext;
 
+    VideoFrameConverter converter; // used only in encoder thread
+
     QSize videoResolution;
     qreal videoFrameRate;
     uint videoBitRate;
@@ -0,0 +1,355 @@
+#include "VideoFrameConverter.h"
+
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define VIDEO_SSE2
+    #include <emmintrin.h>
+#endif
+
+namespace {
+
+// BT.601 limited range, 8 bits fixed point. The SIMD implementations produce the same values.
+
+inline uint8_t clampToByte(int value)
+{
+    return static_cast<uint8_t>(value < 0 ? 0 : (value > 255 ? 255 : value));
+}
+
+inline uint8_t computeLuma(int r, int g, int b)
+{
+    return static_cast<uint8_t>(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+}
+
+inline uint8_t computeU(int r, int g, int b)
+{
+    return static_cast<uint8_t>(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+}
+
+inline uint8_t computeV(int r, int g, int b)
+{
+    return static_cast<uint8_t>(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+}
+
+inline quint32 computeRgb(int y, int u, int v)
+{
+    const int c = 298 * (y - 16) + 128;
+    const int d = u - 128;
+    const int e = v - 128;
+
+    const uint8_t r = clampToByte((c + 409 * e) >> 8);
+    const uint8_t g = clampToByte((c - 100 * d - 208 * e) >> 8);
+    const uint8_t b = clampToByte((c + 516 * d) >> 8);
+
+    return 0xFF000000u | (r << 16) | (g << 8) | b;
+}
+
+// ------------------------------------------------------------------------------------------
+// scalar reference, also used to process the tail pixels in SIMD implementations
+
+void rgbToYuvRowsRange(const quint32 *row0, const quint32 *row1, uint8_t *y0, uint8_t *y1, uint8_t *u, uint8_t *v, int first, int width)
+{
+    for (int x = first; x < width; x += 2) {
+        const int next = x + 1 < width ? x + 1 : x; // odd width, the last chroma sample is using one column
+        const quint32 pixels[4] = { row0[x], row0[next], row1[x], row1[next] };
+
+        int r = 0, g = 0, b = 0;
+        for (int p = 0; p < 4; ++p) {
+            r += (pixels[p] >> 16) & 0xFF;
+            g += (pixels[p] >> 8) & 0xFF;
+            b += pixels[p] & 0xFF;
+        }
+
+        y0[x] = computeLuma((pixels[0] >> 16) & 0xFF, (pixels[0] >> 8) & 0xFF, pixels[0] & 0xFF);
+        y1[x] = computeLuma((pixels[2] >> 16) & 0xFF, (pixels[2] >> 8) & 0xFF, pixels[2] & 0xFF);
+        if (next != x) {
+            y0[next] = computeLuma((pixels[1] >> 16) & 0xFF, (pixels[1] >> 8) & 0xFF, pixels[1] & 0xFF);
+            y1[next] = computeLuma((pixels[3] >> 16) & 0xFF, (pixels[3] >> 8) & 0xFF, pixels[3] & 0xFF);
+        }
+
+        r = (r + 2) >> 2; // average of 2x2 pixels
+        g = (g + 2) >> 2;
+        b = (b + 2) >> 2;
+        u[x / 2] = computeU(r, g, b);
+        v[x / 2] = computeV(r, g, b);
+    }
+}
+
+void yuvToRgbRowRange(const uint8_t *y, const uint8_t *u, const uint8_t *v, quint32 *dest, int first, int width)
+{
+    for (int x = first; x < width; ++x)
+        dest[x] = computeRgb(y[x], u[x / 2], v[x / 2]);
+}
+
+void rgbToYuvRowsScalar(const quint32 *row0, const quint32 *row1, uint8_t *y0, uint8_t *y1, uint8_t *u, uint8_t *v, int width)
+{
+    rgbToYuvRowsRange(row0, row1, y0, y1, u, v, 0, width);
+}
+
+void yuvToRgbRowScalar(const uint8_t *y, const uint8_t *u, const uint8_t *v, quint32 *dest, int width)
+{
+    yuvToRgbRowRange(y, u, v, dest, 0, width);
+}
+
+#ifdef VIDEO_SSE2
+
+// ------------------------------------------------------------------------------------------
+// SSE2, 16 pixels (8 chroma samples) in each step
+
+inline void unpackPixels(const quint32 *pixels, __m128i &r, __m128i &g, __m128i &b) // 8 pixels, 16 bits per component
+{
+    const __m128i mask = _mm_set1_epi32(0xFF);
+    const __m128i p0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(pixels));
+    const __m128i p1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(pixels + 4));
+
+    r = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(p0, 16), mask), _mm_and_si128(_mm_srli_epi32(p1, 16), mask));
+    g = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(p0, 8), mask), _mm_and_si128(_mm_srli_epi32(p1, 8), mask));
+    b = _mm_packs_epi32(_mm_and_si128(p0, mask), _mm_and_si128(p1, mask));
+}
+
+inline __m128i lumaSse2(__m128i r, __m128i g, __m128i b)
+{
+    // 255 * (66 + 129 + 25) + 128 fits in unsigned 16 bits, a logical shift is used
+    __m128i sum = _mm_add_epi16(_mm_mullo_epi16(r, _mm_set1_epi16(66)), _mm_mullo_epi16(g, _mm_set1_epi16(129)));
+    sum = _mm_add_epi16(sum, _mm_add_epi16(_mm_mullo_epi16(b, _mm_set1_epi16(25)), _mm_set1_epi16(128)));
+
+    return _mm_add_epi16(_mm_srli_epi16(sum, 8), _mm_set1_epi16(16));
+}
+
+inline __m128i chromaSse2(__m128i r, __m128i g, __m128i b, short cr, short cg, short cb)
+{
+    __m128i sum = _mm_add_epi16(_mm_mullo_epi16(r, _mm_set1_epi16(cr)), _mm_mullo_epi16(g, _mm_set1_epi16(cg)));
+    sum = _mm_add_epi16(sum, _mm_add_epi16(_mm_mullo_epi16(b, _mm_set1_epi16(cb)), _mm_set1_epi16(128)));
+
+    return _mm_add_epi16(_mm_srai_epi16(sum, 8), _mm_set1_epi16(128));
+}
+
+inline __m128i pairsSum(__m128i row0, __m128i row1) // 8 pixels in 2 rows -> 4 sums of 2x2 pixels (32 bits)
+{
+    return _mm_madd_epi16(_mm_add_epi16(row0, row1), _mm_set1_epi16(1));
+}
+
+inline __m128i average(__m128i sums0, __m128i sums1)
+{
+    return _mm_srli_epi16(_mm_add_epi16(_mm_packs_epi32(sums0, sums1), _mm_set1_epi16(2)), 2);
+}
+
+void rgbToYuvRowsSse2(const quint32 *row0, const quint32 *row1, uint8_t *y0, uint8_t *y1, uint8_t *u, uint8_t *v, int width)
+{
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        __m128i r[4], g[4], b[4]; // row0 (first and second 8 pixels) and row1
+        unpackPixels(row0 + x, r[0], g[0], b[0]);
+        unpackPixels(row0 + x + 8, r[1], g[1], b[1]);
+        unpackPixels(row1 + x, r[2], g[2], b[2]);
+        unpackPixels(row1 + x + 8, r[3], g[3], b[3]);
+
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(y0 + x), _mm_packus_epi16(lumaSse2(r[0], g[0], b[0]), lumaSse2(r[1], g[1], b[1])));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(y1 + x), _mm_packus_epi16(lumaSse2(r[2], g[2], b[2]), lumaSse2(r[3], g[3], b[3])));
+
+        const __m128i ar = average(pairsSum(r[0], r[2]), pairsSum(r[1], r[3]));
+        const __m128i ag = average(pairsSum(g[0], g[2]), pairsSum(g[1], g[3]));
+        const __m128i ab = average(pairsSum(b[0], b[2]), pairsSum(b[1], b[3]));
+
+        const __m128i uValues = chromaSse2(ar, ag, ab, -38, -74, 112);
+        const __m128i vValues = chromaSse2(ar, ag, ab, 112, -94, -18);
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(u + x / 2), _mm_packus_epi16(uValues, uValues));
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(v + x / 2), _mm_packus_epi16(vValues, vValues));
+    }
+
+    rgbToYuvRowsRange(row0, row1, y0, y1, u, v, x, width);
+}
+
+inline __m128i coefficientsPair(short first, short second)
+{
+    return _mm_set_epi16(second, first, second, first, second, first, second, first);
+}
+
+inline __m128i dotProducts(__m128i a, __m128i b, __m128i coefficients, __m128i bias) // 8 x (a * c0 + b * c1 + bias) >> 8
+{
+    const __m128i low = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(a, b), coefficients), bias), 8);
+    const __m128i high = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(a, b), coefficients), bias), 8);
+
+    return _mm_packs_epi32(low, high);
+}
+
+inline __m128i loadChroma(const uint8_t *samples) // 4 chroma samples duplicated to 8 pixels, 16 bits per sample
+{
+    qint32 value;
+    std::memcpy(&value, samples, sizeof(value));
+    const __m128i bytes = _mm_cvtsi32_si128(value);
+
+    return _mm_unpacklo_epi8(_mm_unpacklo_epi8(bytes, bytes), _mm_setzero_si128());
+}
+
+void yuvToRgbRowSse2(const uint8_t *y, const uint8_t *u, const uint8_t *v, quint32 *dest, int width)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i bias = _mm_set1_epi32(128);
+    const __m128i alpha = _mm_set1_epi8(static_cast<char>(0xFF));
+
+    int x = 0;
+    for (; x + 8 <= width; x += 8) {
+        const __m128i c = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(y + x)), zero), _mm_set1_epi16(16));
+        const __m128i d = _mm_sub_epi16(loadChroma(u + x / 2), _mm_set1_epi16(128));
+        const __m128i e = _mm_sub_epi16(loadChroma(v + x / 2), _mm_set1_epi16(128));
+
+        const __m128i r = dotProducts(c, e, coefficientsPair(298, 409), bias);
+        const __m128i b = dotProducts(c, d, coefficientsPair(298, 516), bias);
+
+        // G = 298c - 100d - 208e, computed as (298c - 100d) + (-208e + 0), both in 32 bits
+        const __m128i cd = coefficientsPair(298, -100);
+        const __m128i e0 = coefficientsPair(-208, 0);
+        const __m128i gLow = _mm_srai_epi32(_mm_add_epi32(_mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(c, d), cd), _mm_madd_epi16(_mm_unpacklo_epi16(e, zero), e0)), bias), 8);
+        const __m128i gHigh = _mm_srai_epi32(_mm_add_epi32(_mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(c, d), cd), _mm_madd_epi16(_mm_unpackhi_epi16(e, zero), e0)), bias), 8);
+        const __m128i g = _mm_packs_epi32(gLow, gHigh);
+
+        // saturated packing is clamping to [0, 255]
+        const __m128i r8 = _mm_packus_epi16(r, r);
+        const __m128i g8 = _mm_packus_epi16(g, g);
+        const __m128i b8 = _mm_packus_epi16(b, b);
+
+        const __m128i bg = _mm_unpacklo_epi8(b8, g8);
+        const __m128i ra = _mm_unpacklo_epi8(r8, alpha);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dest + x), _mm_unpacklo_epi16(bg, ra)); // 0xAARRGGBB in little endian
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dest + x + 4), _mm_unpackhi_epi16(bg, ra));
+    }
+
+    yuvToRgbRowRange(y, u, v, dest, x, width);
+}
+
+#endif
+
+inline bool isRgb32(QImage::Format format)
+{
+    return format == QImage::Format_RGB32 || format == QImage::Format_ARGB32 || format == QImage::Format_ARGB32_Premultiplied;
+}
+
+} // namespace
+
+// ++++++++++++++++++++++++++++++++++++++++++++++++++
+
+VideoFrameConverter::VideoFrameConverter(bool useSimd) :
+    usingSimd(useSimd && simdIsSupported()),
+    rgbToYuvRows(rgbToYuvRowsScalar),
+    yuvToRgbRow(yuvToRgbRowScalar),
+    sourceWidth(0),
+    destinationWidth(0)
+{
+#ifdef VIDEO_SSE2
+    if (usingSimd) {
+        rgbToYuvRows = rgbToYuvRowsSse2;
+        yuvToRgbRow = yuvToRgbRowSse2;
+    }
+#endif
+}
+
+bool VideoFrameConverter::simdIsSupported()
+{
+#ifdef VIDEO_SSE2
+    return true;
+#else
+    return false;
+#endif
+}
+
+int VideoFrameConverter::getSourceIndex(int index, int sourceSize, int destinationSize)
+{
+    if (sourceSize == destinationSize)
+        return index;
+
+    return static_cast<int>((static_cast<qint64>(2 * index + 1) * sourceSize) / (2 * destinationSize)); // sampling in the pixel center
+}
+
+void VideoFrameConverter::updateColumns(int sourceWidth, int destinationWidth)
+{
+    if (this->sourceWidth == sourceWidth && this->destinationWidth == destinationWidth)
+        return;
+
+    columns.resize(destinationWidth);
+    for (int x = 0; x < destinationWidth; ++x)
+        columns[x] = getSourceIndex(x, sourceWidth, destinationWidth);
+
+    this->sourceWidth = sourceWidth;
+    this->destinationWidth = destinationWidth;
+}
+
+const quint32 *VideoFrameConverter::getSourceRow(const QImage &image, int row, int height, bool scaleColumns, int index)
+{
+    const int sourceRow = getSourceIndex(row, image.height(), height);
+    const quint32 *pixels = reinterpret_cast<const quint32 *>(image.constScanLine(sourceRow));
+    if (!scaleColumns)
+        return pixels; // the image rows are used without copies
+
+    std::vector<quint32> &scaledRow = scaledRows[index];
+    scaledRow.resize(columns.size());
+    for (size_t x = 0; x < columns.size(); ++x)
+        scaledRow[x] = pixels[columns[x]];
+
+    return scaledRow.data();
+}
+
+void VideoFrameConverter::rgbToYuv420(const QImage &image, uint8_t * const planes[3], const int strides[3], int width, int height)
+{
+    if (image.isNull() || width <= 0 || height <= 0)
+        return;
+
+    if (!isRgb32(image.format())) {
+        rgbToYuv420(image.convertToFormat(QImage::Format_RGB32), planes, strides, width, height);
+        return;
+    }
+
+    const bool scaleColumns = image.width() != width;
+    if (scaleColumns)
+        updateColumns(image.width(), width);
+
+    for (int y = 0; y < height; y += 2) {
+        const int nextY = y + 1 < height ? y + 1 : y; // odd height, the last chroma row is using one row
+        const quint32 *row0 = getSourceRow(image, y, height, scaleColumns, 0);
+        const quint32 *row1 = getSourceRow(image, nextY, height, scaleColumns, 1);
+
+        rgbToYuvRows(row0, row1,
+                     planes[0] + y * strides[0], planes[0] + nextY * strides[0],
+                     planes[1] + (y / 2) * strides[1], planes[2] + (y / 2) * strides[2],
+                     width);
+    }
+}
+
+void VideoFrameConverter::yuv420ToRgb(const uint8_t * const planes[3], const int strides[3], int width, int height, QImage &image)
+{
+    if (image.isNull() || width <= 0 || height <= 0 || !isRgb32(image.format()))
+        return;
+
+    const int imageWidth = image.width();
+    const bool scaleColumns = imageWidth != width;
+    if (scaleColumns) {
+        updateColumns(width, imageWidth);
+        scaledPlanes[0].resize(imageWidth);
+        scaledPlanes[1].resize((imageWidth + 1) / 2);
+        scaledPlanes[2].resize((imageWidth + 1) / 2);
+    }
+
+    for (int y = 0; y < image.height(); ++y) {
+        const int sourceRow = getSourceIndex(y, height, image.height());
+        const uint8_t *rows[3] = {
+            planes[0] + sourceRow * strides[0],
+            planes[1] + (sourceRow / 2) * strides[1],
+            planes[2] + (sourceRow / 2) * strides[2]
+        };
+
+        if (scaleColumns) {
+            for (int x = 0; x < imageWidth; ++x)
+                scaledPlanes[0][x] = rows[0][columns[x]];
+
+            for (int x = 0; x < imageWidth; x += 2) { // the chroma of each pixels pair is taken from the first pixel
+                scaledPlanes[1][x / 2] = rows[1][columns[x] / 2];
+                scaledPlanes[2][x / 2] = rows[2][columns[x] / 2];
+            }
+
+            for (int p = 0; p < 3; ++p)
+                rows[p] = scaledPlanes[p].data();
+        }
+
+        yuvToRgbRow(rows[0], rows[1], rows[2], reinterpret_cast<quint32 *>(image.scanLine(y)), imageWidth);
+    }
+}
@@ -0,0 +1,59 @@
+#ifndef _VIDEO_FRAME_CONVERTER_
+#define _VIDEO_FRAME_CONVERTER_
+
+#include <QImage>
+#include <QtGlobal>
+
+#include <vector>
+
+/**
+    RGB <-> YUV420P conversion (BT.601, limited range) without libswscale. The scaling is done
+    in the same pass (nearest neighbour), so the camera frames are converted straight to the
+    encoder picture and the decoded pictures straight to the QImage scanlines.
+
+    Two rows are converted in each step (one chroma row), using SSE2 when available.
+    The instances are keeping the scaling buffers, reuse them to avoid allocations.
+*/
+
+class VideoFrameConverter
+{
+public:
+    explicit VideoFrameConverter(bool useSimd = true);
+
+    // 'image' is scaled to width x height, images not in RGB32/ARGB32 formats are converted first
+    void rgbToYuv420(const QImage &image, uint8_t * const planes[3], const int strides[3], int width, int height);
+
+    // the YUV picture is scaled to 'image' size, 'image' must be in RGB32 (or ARGB32) format
+    void yuv420ToRgb(const uint8_t * const planes[3], const int strides[3], int width, int height, QImage &image);
+
+    bool isUsingSimd() const;
+
+    static bool simdIsSupported();
+
+private:
+    typedef void (*RgbToYuvRows)(const quint32 *row0, const quint32 *row1, uint8_t *y0, uint8_t *y1, uint8_t *u, uint8_t *v, int width);
+    typedef void (*YuvToRgbRow)(const uint8_t *y, const uint8_t *u, const uint8_t *v, quint32 *dest, int width);
+
+    bool usingSimd;
+    RgbToYuvRows rgbToYuvRows;
+    YuvToRgbRow yuvToRgbRow;
+
+    std::vector<int> columns; // source column for each destination column when scaling
+    int sourceWidth;
+    int destinationWidth;
+
+    std::vector<quint32> scaledRows[2];
+    std::vector<uint8_t> scaledPlanes[3];
+
+    void updateColumns(int sourceWidth, int destinationWidth);
+    const quint32 *getSourceRow(const QImage &image, int row, int height, bool scaleColumns, int index);
+
+    static int getSourceIndex(int index, int sourceSize, int destinationSize);
+};
+
+inline bool VideoFrameConverter::isUsingSimd() const
+{
+    return usingSimd;
+}
+
+#endif
@@ -0,0 +1,107 @@
+#include "VideoFramesPool.h"
+
+#include <QDebug>
+
+const int VideoFramesPool::MAX_POOLED_IMAGES = 96; // two intervals of decoded frames for some users
+const int VideoFramesPool::MAX_POOLED_PICTURES = 4;
+
+VideoFramesPool &VideoFramesPool::getInstance()
+{
+    static VideoFramesPool pool;
+    return pool;
+}
+
+VideoFramesPool::~VideoFramesPool()
+{
+    for (AVFrame *picture : pictures)
+        av_frame_free(&picture);
+}
+
+QImage VideoFramesPool::takeImage(const QSize &size, QImage::Format format)
+{
+    {
+        QMutexLocker locker(&mutex);
+        for (int i = 0; i < images.size(); ++i) {
+            const QImage &image = images.at(i);
+            if (image.size() == size && image.format() == format && image.isDetached())  // still showed in screen when not detached
+                return images.takeAt(i);
+        }
+    }
+
+    return QImage(size, format);
+}
+
+void VideoFramesPool::releaseImage(const QImage &image)
+{
+    if (image.isNull())
+        return;
+
+    QMutexLocker locker(&mutex);
+    if (images.size() < MAX_POOLED_IMAGES)
+        images.append(image);
+}
+
+void VideoFramesPool::releaseImages(const QList<QImage> &images)
+{
+    for (const QImage &image : images)
+        releaseImage(image);
+}
+
+AVFrame *VideoFramesPool::takePicture(AVPixelFormat format, int width, int height)
+{
+    {
+        QMutexLocker locker(&mutex);
+        for (int i = 0; i < pictures.size(); ++i) {
+            AVFrame *picture = pictures.at(i);
+            if (picture->format == format && picture->width == width && picture->height == height) {
+                pictures.removeAt(i);
+                return picture;
+            }
+        }
+    }
+
+    auto picture = av_frame_alloc();
+    if (!picture)
+        return nullptr;
+
+    picture->format = format;
+    picture->width  = width;
+    picture->height = height;
+
+    /* allocate the buffers for the frame data */
+    int ret = av_frame_get_buffer(picture, 32);
+    if (ret < 0) {
+        qCritical() << "Could not allocate frame data.";
+        av_frame_free(&picture);
+        return nullptr;
+    }
+
+    return picture;
+}
+
+void VideoFramesPool::releasePicture(AVFrame *picture)
+{
+    if (!picture)
+        return;
+
+    QMutexLocker locker(&mutex);
+    if (pictures.size() < MAX_POOLED_PICTURES) {
+        pictures.append(picture);
+        return;
+    }
+
+    locker.unlock();
+    av_frame_free(&picture);
+}
+
+int VideoFramesPool::getPooledImages() const
+{
+    QMutexLocker locker(&mutex);
+    return images.size();
+}
+
+int VideoFramesPool::getPooledPictures() const
+{
+    QMutexLocker locker(&mutex);
+    return pictures.size();
+}
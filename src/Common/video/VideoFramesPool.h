@@ -0,0 +1,46 @@
+#ifndef _VIDEO_FRAMES_POOL_
+#define _VIDEO_FRAMES_POOL_
+
+#include "FFMpegCommon.h"
+
+#include <QImage>
+#include <QList>
+#include <QMutex>
+
+/**
+    Keep the video frame buffers allocated between frames and intervals. The YUV pictures used
+    by the encoder and the QImages filled by the decoders are taken from the pool and released
+    when not used anymore, so the camera frames are encoded and the remote videos are decoded
+    without allocating a new buffer for each frame.
+
+    The pool is shared by the muxer and all demuxers (one demuxer is created in each interval),
+    the methods are thread safe.
+*/
+
+class VideoFramesPool
+{
+public:
+    ~VideoFramesPool();
+
+    QImage takeImage(const QSize &size, QImage::Format format);
+    void releaseImage(const QImage &image); // the image buffer is reused when the image is not referenced anymore
+    void releaseImages(const QList<QImage> &images);
+
+    AVFrame *takePicture(AVPixelFormat format, int width, int height);
+    void releasePicture(AVFrame *picture);
+
+    int getPooledImages() const;
+    int getPooledPictures() const;
+
+    static VideoFramesPool &getInstance();
+
+    static const int MAX_POOLED_IMAGES;
+    static const int MAX_POOLED_PICTURES;
+
+private:
+    mutable QMutex mutex;
+    QList<QImage> images;
+    QList<AVFrame *> pictures;
+};
+
+#endif
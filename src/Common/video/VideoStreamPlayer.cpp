@@ -0,0 +1,193 @@
+#include "VideoStreamPlayer.h"
+#include "VideoFramesPool.h"
+
+#include <QtConcurrent/QtConcurrent>
+
+const int VideoStreamPlayer::FRAMES_AHEAD = 3;
+const uint VideoStreamPlayer::DEFAULT_FRAME_RATE = 10;
+
+VideoStreamPlayer::VideoStreamPlayer() :
+    intervalGeneration(0),
+    openedGeneration(0),
+    intervalStart(0),
+    frameRate(DEFAULT_FRAME_RATE),
+    decodedFrames(0),
+    playheadFrame(0),
+    intervalFinished(true), // no interval to play
+    droppedFrames(0),
+    decoding(false),
+    stopping(false)
+{
+
+}
+
+VideoStreamPlayer::~VideoStreamPlayer()
+{
+    {
+        QMutexLocker locker(&mutex);
+        stopping = true;
+    }
+
+    decodingTask.waitForFinished();
+
+    releaseFrames();
+}
+
+void VideoStreamPlayer::addInterval(const QByteArray &encodedData, quint64 now)
+{
+    QMutexLocker locker(&mutex);
+
+    if (intervalFinished && frames.isEmpty()) { // nothing playing, starting the received interval now
+        startInterval(encodedData, now);
+        return;
+    }
+
+    receivedIntervals.append(encodedData);
+}
+
+bool VideoStreamPlayer::startNextInterval(quint64 now)
+{
+    QMutexLocker locker(&mutex);
+
+    if (receivedIntervals.isEmpty())
+        return false;
+
+    QByteArray lastInterval = receivedIntervals.last(); // keep just the last received interval
+    receivedIntervals.clear();
+
+    startInterval(lastInterval, now);
+
+    return true;
+}
+
+void VideoStreamPlayer::startInterval(const QByteArray &encodedData, quint64 now)
+{
+    currentInterval = encodedData;
+    intervalGeneration++;
+    intervalStart = now;
+    decodedFrames = 0;
+    playheadFrame = 0;
+    intervalFinished = false;
+
+    releaseFrames();
+
+    scheduleDecoding();
+}
+
+void VideoStreamPlayer::releaseFrames()
+{
+    auto &pool = VideoFramesPool::getInstance();
+    for (const Frame &frame : frames)
+        pool.releaseImage(frame.image);
+
+    frames.clear();
+}
+
+QImage VideoStreamPlayer::getFrameToShow(quint64 now)
+{
+    QMutexLocker locker(&mutex);
+
+    const quint64 elapsed = now > intervalStart ? now - intervalStart : 0;
+    playheadFrame = static_cast<uint>(elapsed * frameRate / 1000);
+
+    // the frames behind the playhead are dropped, the last one is showed
+    auto &pool = VideoFramesPool::getInstance();
+    while (frames.size() > 1 && frames.at(1).index <= playheadFrame) {
+        pool.releaseImage(frames.takeFirst().image);
+        droppedFrames++;
+    }
+
+    QImage image;
+    if (!frames.isEmpty() && frames.first().index <= playheadFrame)
+        image = frames.takeFirst().image;
+
+    scheduleDecoding();
+
+    return image;
+}
+
+void VideoStreamPlayer::scheduleDecoding()
+{
+    if (decoding || stopping || intervalFinished || frames.size() >= FRAMES_AHEAD)
+        return;
+
+    decoding = true;
+    decodingTask = QtConcurrent::run(this, &VideoStreamPlayer::decodeFrames);
+}
+
+void VideoStreamPlayer::decodeFrames()
+{
+    QMutexLocker locker(&mutex);
+
+    forever {
+        if (stopping || intervalFinished || frames.size() >= FRAMES_AHEAD) {
+            decoding = false;
+            return;
+        }
+
+        const quint32 generation = intervalGeneration;
+
+        if (openedGeneration != generation) { // a new interval was started
+            const QByteArray encodedData = currentInterval;
+
+            locker.unlock();
+            const bool opened = demuxer.open(encodedData);
+            const uint intervalFrameRate = demuxer.getFrameRate();
+            locker.relock();
+
+            openedGeneration = generation;
+            if (generation != intervalGeneration)
+                continue;
+
+            if (intervalFrameRate > 0)
+                frameRate = intervalFrameRate;
+
+            if (!opened)
+                intervalFinished = true;
+
+            continue;
+        }
+
+        const uint index = decodedFrames;
+        const bool late = index < playheadFrame; // decoded but not converted, this frame will not be showed
+
+        locker.unlock();
+        QImage image;
+        const bool decoded = demuxer.decodeNextFrame(image, !late);
+        locker.relock();
+
+        if (generation != intervalGeneration) { // the interval was changed while decoding
+            VideoFramesPool::getInstance().releaseImage(image);
+            continue;
+        }
+
+        if (!decoded) {
+            intervalFinished = true;
+            continue;
+        }
+
+        decodedFrames++;
+
+        if (late) {
+            droppedFrames++;
+            continue;
+        }
+
+        Frame frame;
+        frame.image = image;
+        frame.index = index;
+        frames.append(frame);
+    }
+}
+
+quint64 VideoStreamPlayer::getDroppedFrames() const
+{
+    QMutexLocker locker(&mutex);
+    return droppedFrames;
+}
+
+int VideoStreamPlayer::getBufferedFrames() const
+{
+    QMutexLocker locker(&mutex);
+    return frames.size();
+}
@@ -0,0 +1,74 @@
+#ifndef _VIDEO_STREAM_PLAYER_
+#define _VIDEO_STREAM_PLAYER_
+
+#include "FFMpegDemuxer.h"
+
+#include <QByteArray>
+#include <QFuture>
+#include <QImage>
+#include <QList>
+#include <QMutex>
+
+/**
+    Play the video intervals received from one user. The frames are decoded lazily, a few frames
+    (FRAMES_AHEAD) ahead of the interval playhead, in a background task. The frames behind the
+    playhead are dropped when the decoder can't keep up, they are decoded (the next frames are
+    depending on them) but not converted to QImage.
+
+    The same demuxer (and decoder) is used in all intervals, and the decoded images are taken
+    from VideoFramesPool, so just a few frames are kept in memory for each user.
+*/
+
+class VideoStreamPlayer
+{
+public:
+    VideoStreamPlayer();
+    ~VideoStreamPlayer();
+
+    void addInterval(const QByteArray &encodedData, quint64 now); // 'now' in milliseconds
+
+    bool startNextInterval(quint64 now); // false when no video interval was received
+
+    QImage getFrameToShow(quint64 now); // null image if is not time to show a new frame
+
+    quint64 getDroppedFrames() const;
+    int getBufferedFrames() const;
+
+    static const int FRAMES_AHEAD;
+    static const uint DEFAULT_FRAME_RATE;
+
+private:
+    struct Frame
+    {
+        QImage image;
+        uint index; // frame index in the interval
+    };
+
+    mutable QMutex mutex;
+
+    FFMpegDemuxer demuxer; // used only in decoding task
+
+    QList<QByteArray> receivedIntervals;
+    QByteArray currentInterval;
+    quint32 intervalGeneration; // incremented in each started interval, frames decoded from old intervals are discarded
+    quint32 openedGeneration; // interval opened in demuxer
+    quint64 intervalStart;
+    uint frameRate;
+
+    QList<Frame> frames; // decoded frames ahead of the playhead
+    uint decodedFrames; // in current interval
+    uint playheadFrame;
+    bool intervalFinished; // all frames of current interval were decoded
+    quint64 droppedFrames;
+
+    bool decoding;
+    bool stopping;
+    QFuture<void> decodingTask;
+
+    void startInterval(const QByteArray &encodedData, quint64 now);
+    void releaseFrames();
+    void scheduleDecoding();
+    void decodeFrames(); // running in decoding task
+};
+
+#endif
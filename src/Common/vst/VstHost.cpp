@@ -33,6 +33,7 @@ VstHost *VstHost::getInstance()
 VstHost::VstHost() :
     blockSize(0)
 {
+    receivedMidiMessages.reserve(midi::MAX_MESSAGES_PER_BUFFER); // filled in audio thread
     clearVstTimeInfoFlags();
 }
 
@@ -66,11 +67,10 @@ void VstHost::setPlayingFlag(bool playing)
         clearVstTimeInfoFlags();
 }
 
-std::vector<midi::MidiMessage> VstHost::pullReceivedMidiMessages()
+void VstHost::pullReceivedMidiMessages(std::vector<midi::MidiMessage> &pulledMessages)
 {
-    std::vector<midi::MidiMessage> messages(receivedMidiMessages);
-    receivedMidiMessages.clear();
-    return messages;
+    pulledMessages.insert(pulledMessages.end(), receivedMidiMessages.begin(), receivedMidiMessages.end());
+    receivedMidiMessages.clear(); // keep the reserved capacity
 }
 
 void VstHost::setPositionInSamples(int intervalPosition)
@@ -205,6 +205,7 @@ VstIntPtr VSTCALLBACK VstHost::hostCallback(AEffect *effect, VstInt32 opcode, Vs
                 if (vstEvents->events[i]->type == kVstMidiType) {
                     VstMidiEvent *vstMidiEvent = (VstMidiEvent *)vstEvents->events[i];
                     auto msg = midi::MidiMessage::fromArray(vstMidiEvent->midiData);
+                    msg.setSampleOffset(static_cast<quint32>(qMax(vstMidiEvent->deltaFrames, 0)));
                     hostInstance->receivedMidiMessages.push_back(msg);
                 }
             }
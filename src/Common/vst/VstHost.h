@@ -30,7 +30,7 @@ public:
         return blockSize;
     }
 
-    std::vector<midi::MidiMessage> pullReceivedMidiMessages() override;
+    void pullReceivedMidiMessages(std::vector<midi::MidiMessage> &pulledMessages) override;
 
     void setSampleRate(int sampleRate) override;
     void setBlockSize(int blockSize) override;
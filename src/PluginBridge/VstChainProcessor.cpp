@@ -0,0 +1,239 @@
+#include "VstChainProcessor.h"
+
+#include "vst/VstHost.h"
+#include "vst/VstLoader.h"
+#include "log/Logging.h"
+
+#include <QDataStream>
+#include <QList>
+#include <cstring>
+
+using vst::VstChainProcessor;
+using vst::VstHost;
+
+VstChainProcessor::VstChainProcessor(int channels, int maxFrames, int sampleRate) :
+    host(VstHost::getInstance()),
+    channels(channels),
+    maxFrames(maxFrames),
+    bypassed(false),
+    turnedOn(false)
+{
+    host->setSampleRate(sampleRate);
+    host->setBlockSize(maxFrames);
+
+    vstMidiEvents.numEvents = 0;
+    vstMidiEvents.reserved = 0;
+    for (int i = 0; i < audio::bridge::MAX_MIDI_EVENTS; ++i)
+        vstMidiEvents.events[i] = reinterpret_cast<VstEvent *>(&midiEvents[i]);
+}
+
+VstChainProcessor::~VstChainProcessor()
+{
+    suspend();
+
+    for (auto &plugin : plugins)
+        VstLoader::unload(plugin.effect);
+}
+
+bool VstChainProcessor::load(const QStringList &pluginsPaths)
+{
+    for (const QString &path : pluginsPaths) {
+        AEffect *effect = VstLoader::load(path, host);
+        if (!effect) {
+            qCritical() << "Can't load" << path << "in the plugin bridge";
+            return false;
+        }
+
+        // same initialization used in VstPlugin::start()
+        effect->dispatcher(effect, effSetSampleRate, 0, 0, NULL, host->getSampleRate());
+        effect->dispatcher(effect, effSetBlockSize, 0, maxFrames, NULL, 0.0f);
+        effect->dispatcher(effect, effOpen, 0, 0, NULL, 0.0f);
+        effect->dispatcher(effect, effSetSampleRate, 0, 0, NULL, host->getSampleRate());
+        effect->dispatcher(effect, effSetBlockSize, 0, maxFrames, NULL, 0.0f);
+
+        Plugin plugin;
+        plugin.effect = effect;
+        plugin.wantMidi = effect->dispatcher(effect, effCanDo, 0, 0, (void*)"receiveVstMidiEvent", 0) == 1;
+        plugin.inputs.assign(static_cast<size_t>(qMax(effect->numInputs, 0)), std::vector<float>(static_cast<size_t>(maxFrames)));
+        plugin.outputs.assign(static_cast<size_t>(qMax(effect->numOutputs, 0)), std::vector<float>(static_cast<size_t>(maxFrames)));
+        for (auto &input : plugin.inputs)
+            plugin.inputsArray.push_back(input.data());
+        for (auto &output : plugin.outputs)
+            plugin.outputsArray.push_back(output.data());
+
+        plugins.push_back(std::move(plugin));
+
+        qCDebug(jtVstPlugin) << path << "loaded in the plugin bridge";
+    }
+
+    return !plugins.empty();
+}
+
+void VstChainProcessor::fillVstEventsList(const std::vector<midi::MidiMessage> &midiMessages)
+{
+    const int events = qMin(static_cast<int>(midiMessages.size()), audio::bridge::MAX_MIDI_EVENTS);
+    vstMidiEvents.numEvents = events;
+    for (int m = 0; m < events; ++m) {
+        const auto &message = midiMessages[static_cast<size_t>(m)];
+        VstMidiEvent &vstEvent = midiEvents[m];
+        vstEvent.type = kVstMidiType;
+        vstEvent.byteSize = sizeof(VstMidiEvent);
+        vstEvent.deltaFrames = static_cast<VstInt32>(message.getSampleOffset());
+        vstEvent.reserved1 = vstEvent.reserved2 = 0;
+        vstEvent.midiData[0] = static_cast<char>(message.getStatus());
+        vstEvent.midiData[1] = static_cast<char>(message.getData1());
+        vstEvent.midiData[2] = static_cast<char>(message.getData2());
+        vstEvent.midiData[3] = 0;
+        vstEvent.flags = kVstMidiEventIsRealtime;
+    }
+}
+
+void VstChainProcessor::process(const float * const *inputs, float * const *outputs, int channels, int frames,
+                                const std::vector<midi::MidiMessage> &midiMessages)
+{
+    const size_t bytes = static_cast<size_t>(frames) * sizeof(float);
+    for (int c = 0; c < channels; ++c) // the chain is processed in the output samples
+        std::memcpy(outputs[c], inputs[c], bytes);
+
+    if (bypassed || frames <= 0)
+        return;
+
+    if (!turnedOn)
+        resume();
+
+    fillVstEventsList(midiMessages);
+
+    for (auto &plugin : plugins) {
+        AEffect *effect = plugin.effect;
+        if (!(effect->flags & effFlagsCanReplacing))
+            continue;
+
+        if (plugin.wantMidi)
+            effect->dispatcher(effect, effProcessEvents, 0, 0, (void*)&vstMidiEvents, 0);
+
+        for (size_t c = 0; c < plugin.inputs.size(); ++c)
+            std::memcpy(plugin.inputsArray[c], outputs[c % static_cast<size_t>(channels)], bytes);
+
+        effect->processReplacing(effect, plugin.inputsArray.data(), plugin.outputsArray.data(), frames);
+
+        if (plugin.outputs.empty())
+            continue;
+
+        const bool virtualInstrument = effect->flags & effFlagsIsSynth;
+        for (int c = 0; c < channels; ++c) {
+            const float *pluginOutput = plugin.outputsArray[static_cast<size_t>(c) % plugin.outputs.size()];
+            if (virtualInstrument) { // VSTis add and preserve the samples generated by the previous plugins, as in VstPlugin
+                for (int i = 0; i < frames; ++i)
+                    outputs[c][i] += pluginOutput[i];
+            }
+            else {
+                std::memcpy(outputs[c], pluginOutput, bytes);
+            }
+        }
+    }
+}
+
+void VstChainProcessor::setSampleRate(int sampleRate)
+{
+    host->setSampleRate(sampleRate);
+    for (auto &plugin : plugins)
+        plugin.effect->dispatcher(plugin.effect, effSetSampleRate, 0, 0, NULL, sampleRate);
+}
+
+void VstChainProcessor::setBypass(bool bypass)
+{
+    bypassed = bypass;
+    for (auto &plugin : plugins)
+        plugin.effect->dispatcher(plugin.effect, effSetBypass, 0, bypass, NULL, 0);
+}
+
+void VstChainProcessor::resume()
+{
+    if (turnedOn)
+        return;
+
+    for (auto &plugin : plugins) {
+        plugin.effect->dispatcher(plugin.effect, effMainsChanged, 0, 1, NULL, 0.0f);
+        plugin.effect->dispatcher(plugin.effect, effStartProcess, 0, 1, NULL, 0.0f);
+    }
+
+    turnedOn = true;
+}
+
+void VstChainProcessor::suspend()
+{
+    if (!turnedOn)
+        return;
+
+    for (auto &plugin : plugins) {
+        plugin.effect->dispatcher(plugin.effect, effStopProcess, 0, 1, NULL, 0.0f);
+        plugin.effect->dispatcher(plugin.effect, effMainsChanged, 0, 0, NULL, 0.0f);
+    }
+
+    turnedOn = false;
+}
+
+QByteArray VstChainProcessor::getChunk(AEffect *effect)
+{
+    if (effect->flags & effFlagsProgramChunks) {
+        char *chunk = nullptr;
+        const VstIntPtr size = effect->dispatcher(effect, effGetChunk, false, 0, &chunk, 0);
+        if (size > 0 && chunk)
+            return QByteArray(chunk, static_cast<int>(size));
+    }
+
+    return QByteArray();
+}
+
+void VstChainProcessor::setChunk(AEffect *effect, const QByteArray &chunk)
+{
+    if (!chunk.isEmpty())
+        effect->dispatcher(effect, effSetChunk, false, chunk.size(), const_cast<char *>(chunk.constData()), 0);
+}
+
+QByteArray VstChainProcessor::getState() const
+{
+    if (plugins.size() == 1) // same serialized data used by VstPlugin, the presets are compatible
+        return getChunk(plugins.front().effect);
+
+    QList<QByteArray> chunks;
+    for (const auto &plugin : plugins)
+        chunks.append(getChunk(plugin.effect));
+
+    QByteArray state;
+    QDataStream stream(&state, QIODevice::WriteOnly);
+    stream << chunks;
+    return state;
+}
+
+bool VstChainProcessor::restoreState(const QByteArray &state)
+{
+    if (plugins.size() == 1) {
+        setChunk(plugins.front().effect, state);
+        return true;
+    }
+
+    QList<QByteArray> chunks;
+    QDataStream stream(state);
+    stream >> chunks;
+    if (stream.status() != QDataStream::Ok)
+        return false;
+
+    for (size_t p = 0; p < plugins.size() && static_cast<int>(p) < chunks.size(); ++p)
+        setChunk(plugins[p].effect, chunks.at(static_cast<int>(p)));
+
+    return true;
+}
+
+quint32 VstChainProcessor::getFlags() const
+{
+    quint32 flags = 0;
+    for (const auto &plugin : plugins) {
+        if (plugin.effect->flags & effFlagsIsSynth)
+            flags |= audio::bridge::VirtualInstrument;
+
+        if (plugin.effect->dispatcher(plugin.effect, effCanDo, 0, 0, (void*)"sendVstMidiEvent", 0) >= 0)
+            flags |= audio::bridge::GeneratesMidi;
+    }
+    return flags;
+}
@@ -0,0 +1,79 @@
+#ifndef VST_CHAIN_PROCESSOR_H
+#define VST_CHAIN_PROCESSOR_H
+
+#include "audio/bridge/PluginBridgeChild.h"
+#include "aeffectx.h"
+
+#include <QStringList>
+#include <vector>
+
+namespace vst {
+
+class VstHost;
+
+/**
+    The VST plugins chain running in the PluginBridge process. The plugins are processed in
+    series as in the Jamtaba insert slots: VSTs are replacing the chain samples and VSTis are
+    adding the generated samples.
+*/
+
+class VstChainProcessor : public audio::BridgeProcessor
+{
+public:
+    VstChainProcessor(int channels, int maxFrames, int sampleRate);
+    ~VstChainProcessor();
+
+    bool load(const QStringList &pluginsPaths);
+
+    void process(const float * const *inputs, float * const *outputs, int channels, int frames,
+                 const std::vector<midi::MidiMessage> &midiMessages) override;
+
+    void setSampleRate(int sampleRate) override;
+    void setBypass(bool bypass) override;
+    void suspend() override;
+    void resume() override;
+
+    QByteArray getState() const override; // the plugin chunk, a list of chunks when the chain has many plugins
+    bool restoreState(const QByteArray &state) override;
+
+    quint32 getFlags() const override;
+
+private:
+    Q_DISABLE_COPY(VstChainProcessor)
+
+    struct Plugin
+    {
+        AEffect *effect;
+        bool wantMidi;
+        std::vector<std::vector<float>> inputs;
+        std::vector<std::vector<float>> outputs;
+        std::vector<float *> inputsArray;
+        std::vector<float *> outputsArray;
+    };
+
+    template<int N>
+    struct VSTEventBlock
+    {
+        VstInt32 numEvents;
+        VstIntPtr reserved;
+        VstEvent *events[N];
+    };
+
+    void fillVstEventsList(const std::vector<midi::MidiMessage> &midiMessages);
+    static QByteArray getChunk(AEffect *effect);
+    static void setChunk(AEffect *effect, const QByteArray &chunk);
+
+    VstHost *host;
+    std::vector<Plugin> plugins;
+    int channels;
+    int maxFrames;
+    bool bypassed;
+    bool turnedOn;
+
+    VstMidiEvent midiEvents[audio::bridge::MAX_MIDI_EVENTS];
+    VSTEventBlock<audio::bridge::MAX_MIDI_EVENTS> vstMidiEvents;
+};
+
+} // namespace
+
+#endif // VST_CHAIN_PROCESSOR_H
@@ -0,0 +1,102 @@
+#include "VstChainProcessor.h"
+#include "audio/bridge/PluginBridgeChild.h"
+#include "audio/bridge/BridgeTestProcessor.h"
+
+#include <QCoreApplication>
+#include <QStringList>
+#include <QScopedPointer>
+#include <QThread>
+#include <QDebug>
+
+#ifdef Q_OS_WIN
+    #include <windows.h>
+#else
+    #include <signal.h>
+    #include <sys/types.h>
+#endif
+
+/**
+    The PluginBridge process hosts the plugins of one Jamtaba insert slot out of the Jamtaba
+    process, a crashing or stalled plugin can't take down the audio callback.
+
+    Usage: PluginBridge <shared memory key> <Jamtaba pid> <sample rate> <plugin path>...
+
+    The 'builtin:test' path loads the audio::BridgeTestProcessor.
+*/
+
+namespace {
+
+class HostProcessChecker
+{
+public:
+    explicit HostProcessChecker(qint64 pid)
+    {
+#ifdef Q_OS_WIN
+        handle = OpenProcess(SYNCHRONIZE, FALSE, static_cast<DWORD>(pid));
+#else
+        this->pid = static_cast<pid_t>(pid);
+#endif
+    }
+
+    bool isRunning() const
+    {
+#ifdef Q_OS_WIN
+        return handle && WaitForSingleObject(handle, 0) == WAIT_TIMEOUT;
+#else
+        return kill(pid, 0) == 0;
+#endif
+    }
+
+private:
+#ifdef Q_OS_WIN
+    HANDLE handle;
+#else
+    pid_t pid;
+#endif
+};
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    const QStringList args = app.arguments();
+    if (args.size() < 5) {
+        qCritical() << "Usage: PluginBridge <key> <host pid> <sample rate> <plugin path>...";
+        return 1;
+    }
+
+    const QString key = args.at(1);
+    const HostProcessChecker hostProcess(args.at(2).toLongLong());
+    const int sampleRate = args.at(3).toInt();
+    const QStringList pluginsPaths = args.mid(4);
+
+    audio::PluginBridgeChild child;
+    if (!child.attach(key))
+        return 2;
+
+    QScopedPointer<audio::BridgeProcessor> processor;
+    if (pluginsPaths.first() == audio::BridgeTestProcessor::PATH) {
+        processor.reset(new audio::BridgeTestProcessor());
+        processor->setSampleRate(sampleRate);
+    }
+    else {
+        auto chain = new vst::VstChainProcessor(child.getChannels(), child.getMaxFrames(), sampleRate);
+        processor.reset(chain);
+        if (!chain->load(pluginsPaths)) {
+            child.setFailed();
+            return 3;
+        }
+    }
+
+    // this thread is running the plugins, the same priority used in Jamtaba audio thread
+    QThread::currentThread()->setPriority(QThread::TimeCriticalPriority);
+
+    child.setReady(processor->getFlags());
+    child.run(processor.data(), [&hostProcess]() {
+        return hostProcess.isRunning();
+    });
+
+    return 0;
+}
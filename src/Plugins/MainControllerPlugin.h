@@ -65,9 +65,9 @@ public:
 
     Preset loadPreset(const QString &name) override;
 
-    inline std::vector<midi::MidiMessage> pullMidiMessagesFromPlugins() override
+    inline void pullMidiMessagesFromPlugins(std::vector<midi::MidiMessage> &pulledMessages) override
     {
-        return std::vector<midi::MidiMessage>(); // empty buffer
+        Q_UNUSED(pulledMessages); // no plugins
     }
 
     void startMidiClock() const override {};
@@ -76,9 +76,11 @@ public:
     void sendMidiClockPulse() const override {};
 
 protected:
-    inline std::vector<midi::MidiMessage> pullMidiMessagesFromDevices() override
+    inline void pullMidiMessagesFromDevices(std::vector<midi::MidiMessage> &pulledMessages, quint32 frames, int sampleRate) override
     {
-        return std::vector<midi::MidiMessage>(); // empty buffer
+        Q_UNUSED(pulledMessages) // no midi devices
+        Q_UNUSED(frames)
+        Q_UNUSED(sampleRate)
     }
 
     JamTabaPlugin *plugin;
@@ -5,6 +5,7 @@
 #include "vst/Utils.h"
 #include "VstPluginChecker.h"
 #include "log/Logging.h"
+#include "persistence/PluginScanCache.h"
 
 #include <QDataStream>
 #include <QDirIterator>
@@ -41,8 +42,30 @@ audio::PluginDescriptor VstPluginScanner::getPluginDescriptor(const QFileInfo &p
     return audio::PluginDescriptor(); // invalid descriptor
 }
 
+void VstPluginScanner::scanFile(const QFileInfo &pluginFileInfo)
+{
+    writeToProcessOutput("JT-Scanner-Scanning: "+ pluginFileInfo.absoluteFilePath());
+    auto descriptor = getPluginDescriptor(pluginFileInfo);
+    if (descriptor.isValid()) {
+        // the binary is hashed here, not in Jamtaba GUI thread. The hash is used in the scan cache
+        const QString binaryPath = persistence::PluginScanCache::getBinaryPath(pluginFileInfo.absoluteFilePath());
+        writeToProcessOutput("JT-Scanner-Hash: " + QString::fromLatin1(persistence::PluginScanCache::computeHash(binaryPath).toHex()));
+        writeToProcessOutput("JT-Scanner-Scan-Finished: " + descriptor.getPath());
+    }
+    else
+        writeToProcessOutput("JT-Scanner-Scan-Failed: " + pluginFileInfo.absoluteFilePath()); // not a plugin or failed to load, scanned again in the next scan
+}
+
 void VstPluginScanner::scan()
 {
+    if (!filesToScan.isEmpty()) {
+        writeToProcessOutput("JT-Scanner-Starting");
+        for (const QString &file : filesToScan)
+            scanFile(QFileInfo(file));
+        writeToProcessOutput("JT-Scanner-Finished");
+        return;
+    }
+
     if (foldersToScan.isEmpty()) {
         qCInfo(jtStandalonePluginFinder) << "Folders to scan is empty!";
         return;
@@ -61,12 +84,8 @@ void VstPluginScanner::scan()
 
             if (!skipList.contains(pluginFileInfo.absoluteFilePath()))
             {
-                if (canScan(pluginFileInfo)) {
-                    writeToProcessOutput("JT-Scanner-Scanning: "+ pluginFileInfo.absoluteFilePath());
-                    auto descriptor = getPluginDescriptor(pluginFileInfo);
-                    if (descriptor.isValid())
-                        writeToProcessOutput("JT-Scanner-Scan-Finished: " + descriptor.getPath());
-                }
+                if (canScan(pluginFileInfo))
+                    scanFile(pluginFileInfo);
             }
         }
     }
@@ -95,6 +114,12 @@ void VstPluginScanner::initialize(int argc, char *argv[])
     if (argc < 2)
         return;
 
+    if (QString::fromUtf8(argv[1]) == "--files") { // the plugins files are passed in the 2nd arg, separated using ';'
+        if (argc > 2)
+            this->filesToScan = QString::fromUtf8(argv[2]).split(";", QString::SkipEmptyParts);
+        return;
+    }
+
     QString foldersString = QString::fromUtf8(argv[1]);
 
     if (!foldersString.isEmpty())
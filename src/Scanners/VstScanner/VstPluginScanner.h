@@ -14,6 +14,9 @@ private:
 
     QStringList foldersToScan;
     QStringList skipList; // contain blackListed and cached plugins
+    QStringList filesToScan; // '--files' mode, used by the parallel scan in VSTPluginFinder
+
+    void scanFile(const QFileInfo &pluginFileInfo);
 
     void initialize(int argc, char *argv[]) override;
 
@@ -27,9 +27,9 @@ AudioUnitHost::AudioUnitHost()
 
 }
 
-std::vector<midi::MidiMessage> AudioUnitHost::pullReceivedMidiMessages()
+void AudioUnitHost::pullReceivedMidiMessages(std::vector<midi::MidiMessage> &pulledMessages)
 {
-    return std::vector<midi::MidiMessage>();
+    Q_UNUSED(pulledMessages);
 }
 
 void AudioUnitHost::setSampleRate(int sampleRate)
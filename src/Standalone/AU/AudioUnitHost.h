@@ -17,7 +17,7 @@ public:
     int getSampleRate() const override;
     int getBufferSize() const override;
 
-    std::vector<midi::MidiMessage> pullReceivedMidiMessages() override;
+    void pullReceivedMidiMessages(std::vector<midi::MidiMessage> &pulledMessages) override;
 
     void setSampleRate(int sampleRate) override;
     void setBlockSize(int blockSize) override;
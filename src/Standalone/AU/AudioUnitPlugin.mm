@@ -429,10 +429,9 @@ void AudioUnitPlugin::process(const audio::SamplesBuffer &inBuffer, audio::Sampl
     }
 
     if (wantsMidiMessages && !midiBuffer.empty()) {
-        UInt32 midiEventPosition = 0; // in jamtaba all MIDI messages are real time
         for (const midi::MidiMessage &message : midiBuffer) {
             MusicDeviceMIDIEvent(audioUnit, message.getStatus(), message.getData1(),
-                                                            message.getData2(), midiEventPosition);
+                                                            message.getData2(), message.getSampleOffset());
         }
     }
 
@@ -5,6 +5,7 @@
 #include "audio/PortAudioDriver.h"
 #include "audio/core/LocalInputNode.h"
 #include "vst/VstPlugin.h"
+#include "vst/BridgedPlugin.h"
 #include "vst/VstHost.h"
 #include "vst/VstPluginFinder.h"
 #include "audio/core/PluginDescriptor.h"
@@ -155,6 +156,9 @@ void MainControllerStandalone::clearPluginsCache()
 {
     settings.clearVstCache();
 
+    if (vstPluginFinder)
+        vstPluginFinder->clearScanCache(); // the scan results are discarded too, all plugins are scanned again
+
     #ifdef Q_OS_MAC
     settings.clearAudioUnitCache();
     #endif
@@ -296,6 +300,13 @@ void MainControllerStandalone::setBufferSize(int newBufferSize)
     settings.setBufferSize(newBufferSize);
 }
 
+void MainControllerStandalone::process(const audio::SamplesBuffer &in, audio::SamplesBuffer &out, int sampleRate)
+{
+    vst::BridgedPlugin::startAudioCallback(out.getFrameLenght(), sampleRate); // one deadline for all the bridged inserts in this callback
+
+    MainController::process(in, out, sampleRate);
+}
+
 void MainControllerStandalone::on_audioDriverStarted()
 {
     for (auto inputTrack : inputTracks)
@@ -487,7 +498,7 @@ void MainControllerStandalone::start()
         midiDriver->start(settings.getMidiInputDevicesStatus(), settings.getSyncOutputDevicesStatus());
 
     qCInfo(jtCore) << "Creating plugin finder...";
-    vstPluginFinder.reset(new audio::VSTPluginFinder());
+    vstPluginFinder.reset(new audio::VSTPluginFinder(Configurator::getInstance()->getCacheDir()));
 
 #ifdef Q_OS_MAC
 
@@ -546,6 +557,9 @@ QSharedPointer<audio::Plugin> MainControllerStandalone::createPluginInstance(
     else if (descriptor.isVST())
     {
         auto host = vst::VstHost::getInstance();
+        if (settings.isUsingBridgedPlugins())
+            return vst::BridgedPlugin::load(host, descriptor);
+
         return vst::VstPlugin::load(host, descriptor);
     }
 
@@ -748,18 +762,11 @@ void MainControllerStandalone::quit()
     application->quit();
 }
 
-std::vector<midi::MidiMessage> MainControllerStandalone::pullMidiMessagesFromPlugins()
+void MainControllerStandalone::pullMidiMessagesFromPlugins(std::vector<midi::MidiMessage> &pulledMessages)
 {
-    // return midi messages created by vst and AU plugins, not by midi controllers.
-    std::vector<midi::MidiMessage> receivedMidiMessages;
+    // midi messages created by vst and AU plugins, not by midi controllers.
     for (auto host : hosts)
-    {
-        std::vector<midi::MidiMessage> pulledMessages = host->pullReceivedMidiMessages();
-        receivedMidiMessages.insert(receivedMidiMessages.end(),
-                                    pulledMessages.begin(), pulledMessages.end());
-    }
-
-    return receivedMidiMessages;
+        host->pullReceivedMidiMessages(pulledMessages);
 }
 
 void MainControllerStandalone::startMidiClock() const
@@ -782,12 +789,10 @@ void MainControllerStandalone::sendMidiClockPulse() const
     midiDriver->sendClockPulse();
 }
 
-std::vector<midi::MidiMessage> MainControllerStandalone::pullMidiMessagesFromDevices()
+void MainControllerStandalone::pullMidiMessagesFromDevices(std::vector<midi::MidiMessage> &pulledMessages, quint32 frames, int sampleRate)
 {
-    if (!midiDriver)
-        return std::vector<midi::MidiMessage>();
-
-    return midiDriver->getBuffer();
+    if (midiDriver)
+        midiDriver->consumeMessages(pulledMessages, frames, sampleRate);
 }
 
 bool MainControllerStandalone::isUsingNullAudioDriver() const
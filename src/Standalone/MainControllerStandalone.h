@@ -113,13 +113,15 @@ namespace controller
         QSharedPointer<Plugin> addPlugin(quint32 inputTrackIndex, quint32 pluginSlotIndex,
                                          const PluginDescriptor &descriptor);
 
-        std::vector<midi::MidiMessage> pullMidiMessagesFromPlugins() override;
+        void pullMidiMessagesFromPlugins(std::vector<midi::MidiMessage> &pulledMessages) override;
 
         void startMidiClock() const override;
         void stopMidiClock() const override;
         void continueMidiClock() const override;
         void sendMidiClockPulse() const override;
 
+        void process(const SamplesBuffer &in, SamplesBuffer &out, int sampleRate) override;
+
 
     public slots:
         void setSampleRate(int newSampleRate) override;
@@ -150,7 +152,7 @@ namespace controller
 
         void setupNinjamControllerSignals() override;
 
-        std::vector<midi::MidiMessage> pullMidiMessagesFromDevices() override;
+        void pullMidiMessagesFromDevices(std::vector<midi::MidiMessage> &pulledMessages, quint32 frames, int sampleRate) override;
 
     protected slots:
         void updateBpm(int newBpm) override;
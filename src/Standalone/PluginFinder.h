@@ -16,8 +16,10 @@ class PluginFinder : public QObject
     Q_OBJECT
 
 public:
-    void scan(const QStringList &foldersToScan = QStringList(), const QStringList &skipList = QStringList());
-    void cancel();
+    virtual ~PluginFinder() {}
+
+    virtual void scan(const QStringList &foldersToScan = QStringList(), const QStringList &skipList = QStringList());
+    virtual void cancel();
 
 protected:
     QProcess scanProcess;
@@ -13,7 +13,7 @@ public:
     virtual int getSampleRate() const = 0;
     virtual int getBufferSize() const = 0;
 
-    virtual std::vector<midi::MidiMessage> pullReceivedMidiMessages() = 0;
+    virtual void pullReceivedMidiMessages(std::vector<midi::MidiMessage> &pulledMessages) = 0; // append the received messages in 'pulledMessages' (called in audio thread)
 
     virtual void setSampleRate(int sampleRate) = 0;
     virtual void setBlockSize(int blockSize) = 0;
@@ -7,6 +7,7 @@
 #include "persistence/Settings.h"
 #include "MainController.h"
 #include "log/Logging.h"
+#include "log/RealTimeAllocationTracker.h"
 
 #include <stdexcept>
 #include <algorithm>
@@ -199,6 +200,8 @@ PortAudioDriver::~PortAudioDriver()
 // this method just convert portaudio void* inputBuffer to a float[][] buffer, and do the same for outputs
 void PortAudioDriver::translatePortAudioCallBack(const void *in, void *out, unsigned long framesPerBuffer)
 {
+    RealTimeScope realTimeScope; // report memory allocations in audio thread when JAMTABA_RT_ALLOC_TRACKER is defined
+
     const uint bytesToProcess = framesPerBuffer * sizeof(float);
 
     // prepare buffers and expose then to application process
@@ -0,0 +1,191 @@
+#include "BridgedPlugin.h"
+
+#include "vst/VstHost.h"
+#include "audio/core/SamplesBuffer.h"
+#include "log/Logging.h"
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QDebug>
+#include <chrono>
+
+using vst::BridgedPlugin;
+using vst::VstHost;
+
+const int BridgedPlugin::MAX_FRAMES = 4096;
+const int BridgedPlugin::START_TIMEOUT = 10000;
+
+std::atomic<int> BridgedPlugin::bridgesCreated(0);
+std::atomic<qint64> BridgedPlugin::callbackDeadline(0);
+
+namespace {
+
+qint64 now() // ns
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+BridgedPlugin::BridgedPlugin(const audio::PluginDescriptor &pluginDescriptor, VstHost *host) :
+    audio::Plugin(pluginDescriptor),
+    host(host),
+    sampleRate(host->getSampleRate())
+{
+    QObject::connect(&bridgeProcess, static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished), this, [this](int exitCode, QProcess::ExitStatus exitStatus) {
+        qCWarning(jtVstPlugin) << "The plugin bridge for" << name << "finished, exit code" << exitCode << "crashed:" << (exitStatus == QProcess::CrashExit);
+        bridge.setChildFinished();
+    });
+}
+
+BridgedPlugin::~BridgedPlugin()
+{
+    qCDebug(jtVstPlugin) << name << "bridged plugin destructor";
+
+    bridgeProcess.disconnect();
+    bridge.destroy(); // send the Quit command
+
+    if (bridgeProcess.state() != QProcess::NotRunning && !bridgeProcess.waitForFinished(1000))
+        bridgeProcess.kill();
+}
+
+QString BridgedPlugin::getBridgeExecutablePath()
+{
+    QString bridgeExePath = QCoreApplication::applicationDirPath() + "/PluginBridge"; // in the same folder, as the VstScanner
+#ifdef Q_OS_WIN
+    bridgeExePath += ".exe";
+#endif
+    if (QFile(bridgeExePath).exists())
+        return bridgeExePath;
+
+    qCritical() << "Plugin bridge executable not founded in" << bridgeExePath;
+    return QString();
+}
+
+QSharedPointer<BridgedPlugin> BridgedPlugin::load(VstHost *host, const audio::PluginDescriptor &pluginDescriptor)
+{
+    if (!host)
+        return nullptr;
+
+    auto plugin = QSharedPointer<BridgedPlugin>::create(pluginDescriptor, host);
+    if (!plugin->startBridge())
+        return nullptr;
+
+    return plugin;
+}
+
+bool BridgedPlugin::startBridge()
+{
+    const QString exePath = getBridgeExecutablePath();
+    if (exePath.isEmpty())
+        return false;
+
+    // short keys, the POSIX semaphores names are limited to 31 chars in Mac
+    const QString key = QString("jtb%1_%2").arg(QCoreApplication::applicationPid()).arg(bridgesCreated++);
+    if (!bridge.create(key, 2, qMax(host->getBufferSize(), MAX_FRAMES)))
+        return false;
+
+    QStringList arguments;
+    arguments << key << QString::number(QCoreApplication::applicationPid()) << QString::number(sampleRate) << descriptor.getPath();
+
+    bridgeProcess.setProcessChannelMode(QProcess::ForwardedChannels);
+    bridgeProcess.start(exePath, arguments);
+
+    if (!bridge.waitChildReady(START_TIMEOUT)) {
+        qCritical() << "Can't start the plugin bridge for" << descriptor.getPath();
+        bridge.destroy();
+        bridgeProcess.kill();
+        return false;
+    }
+
+    qCDebug(jtVstPlugin) << name << "loaded in the plugin bridge" << key;
+
+    return true;
+}
+
+void BridgedPlugin::process(const audio::SamplesBuffer &in, audio::SamplesBuffer &out, std::vector<midi::MidiMessage> &midiBuffer)
+{
+    if (isBypassed())
+        return;
+
+    const int channels = qMin(out.getChannels(), audio::bridge::MAX_CHANNELS);
+    const int frames = out.getFrameLenght();
+    const int inChannels = in.getChannels();
+
+    const float *inputs[audio::bridge::MAX_CHANNELS];
+    float *outputs[audio::bridge::MAX_CHANNELS];
+    for (int c = 0; c < channels; ++c) {
+        inputs[c] = in.getSamplesArray(qMin(c, inChannels - 1));
+        outputs[c] = out.getSamplesArray(c);
+    }
+
+    // the chain output is computed in the bridge (VSTis are adding the input samples), the output is replaced
+    const qint64 remainingTime = qMax(callbackDeadline.load(std::memory_order_relaxed) - now(), Q_INT64_C(0)); // the previous bridged inserts used part of the deadline
+    bridge.process(inputs, outputs, channels, frames, midiBuffer, remainingTime);
+}
+
+void BridgedPlugin::startAudioCallback(int frames, int sampleRate)
+{
+    const qint64 halfBlockPeriod = Q_INT64_C(500000000) * frames / qMax(sampleRate, 1);
+    callbackDeadline.store(now() + halfBlockPeriod, std::memory_order_relaxed);
+}
+
+void BridgedPlugin::start()
+{
+    setSampleRate(host->getSampleRate());
+    resume();
+}
+
+void BridgedPlugin::openEditor(const QPoint &centerOfScreen)
+{
+    Q_UNUSED(centerOfScreen)
+
+    qCWarning(jtVstPlugin) << "The editor is not available for the bridged plugin" << name;
+}
+
+void BridgedPlugin::updateGui()
+{
+    // no editor
+}
+
+QByteArray BridgedPlugin::getSerializedData() const
+{
+    QByteArray data;
+    if (!bridge.sendCommand(audio::bridge::Command::GetState, 0, QByteArray(), &data))
+        return QByteArray();
+
+    return data;
+}
+
+void BridgedPlugin::restoreFromSerializedData(const QByteArray &dataToRestore)
+{
+    if (!dataToRestore.isEmpty())
+        bridge.sendCommand(audio::bridge::Command::SetState, 0, dataToRestore);
+}
+
+void BridgedPlugin::setSampleRate(int newSampleRate)
+{
+    sampleRate = newSampleRate;
+    bridge.sendCommand(audio::bridge::Command::SetSampleRate, newSampleRate);
+}
+
+void BridgedPlugin::setBypass(bool state)
+{
+    Plugin::setBypass(state);
+    bridge.sendCommand(audio::bridge::Command::SetBypass, state ? 1 : 0);
+}
+
+bool BridgedPlugin::isVirtualInstrument() const
+{
+    return bridge.getPluginFlags() & audio::bridge::VirtualInstrument;
+}
+
+void BridgedPlugin::resume()
+{
+    bridge.sendCommand(audio::bridge::Command::Resume);
+}
+
+void BridgedPlugin::suspend()
+{
+    bridge.sendCommand(audio::bridge::Command::Suspend);
+}
@@ -0,0 +1,85 @@
+#ifndef BRIDGED_PLUGIN_H
+#define BRIDGED_PLUGIN_H
+
+#include "audio/core/Plugins.h"
+#include "audio/bridge/PluginBridgeHost.h"
+
+#include <QProcess>
+#include <atomic>
+
+namespace vst {
+
+class VstHost;
+
+/**
+    A VST plugin running out of process, in the PluginBridge executable. The audio is exchanged
+    with the bridge in shared memory and all the bridged plugins share one deadline in each
+    audio callback (half of the audio block period, see startAudioCallback()): a slow, stalled
+    or crashed plugin produces silence instead of blocking the audio callback or crashing Jamtaba.
+
+    The serialized data is the same used by VstPlugin, the presets are restored in both modes.
+    The plugin editors and the MIDI messages generated by plugins are not available in the
+    bridged mode.
+*/
+
+class BridgedPlugin : public audio::Plugin
+{
+public:
+    BridgedPlugin(const audio::PluginDescriptor &pluginDescriptor, VstHost *host);
+    ~BridgedPlugin();
+
+    static QSharedPointer<BridgedPlugin> load(VstHost *host, const audio::PluginDescriptor &pluginDescriptor);
+
+    void process(const audio::SamplesBuffer &in, audio::SamplesBuffer &out, std::vector<midi::MidiMessage> &midiBuffer) override;
+
+    void openEditor(const QPoint &centerOfScreen) override;
+    void updateGui() override;
+
+    void start() override;
+
+    inline QString getPath() const override
+    {
+        return descriptor.getPath();
+    }
+
+    QByteArray getSerializedData() const override;
+    void restoreFromSerializedData(const QByteArray &dataToRestore) override;
+
+    void setSampleRate(int newSampleRate) override;
+    void setBypass(bool state) override;
+
+    bool isVirtualInstrument() const override;
+
+    quint64 getLateBlocks() const; // blocks replaced by silence
+
+    static QString getBridgeExecutablePath();
+
+    static void startAudioCallback(int frames, int sampleRate); // audio thread, compute the deadline used by all bridged plugins in this callback
+
+    static const int MAX_FRAMES; // the bridge shared memory is not resized when the audio buffer size changes
+    static const int START_TIMEOUT; // ms
+
+protected:
+    void resume() override;
+    void suspend() override;
+
+private:
+    bool startBridge();
+
+    VstHost *host;
+    QProcess bridgeProcess;
+    mutable audio::PluginBridgeHost bridge; // the commands are not changing the plugin state in getSerializedData()
+    std::atomic<int> sampleRate;
+
+    static std::atomic<int> bridgesCreated; // used in the shared memory keys
+    static std::atomic<qint64> callbackDeadline; // ns, steady clock
+};
+
+inline quint64 BridgedPlugin::getLateBlocks() const
+{
+    return bridge.getLateBlocks() + bridge.getDroppedBlocks();
+}
+
+} // namespace
+
+#endif // BRIDGED_PLUGIN_H
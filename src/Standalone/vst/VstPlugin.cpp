@@ -207,7 +207,8 @@ void VstPlugin::fillVstEventsList(const std::vector<midi::MidiMessage> &midiBuff
         VstMidiEvent* vstEvent = (VstMidiEvent*)vstMidiEvents.events[m];
         vstEvent->type = kVstMidiType;
         vstEvent->byteSize = sizeof(vstEvent);
-        vstEvent->deltaFrames = vstEvent->reserved1 = vstEvent->reserved2 = 0;
+        vstEvent->deltaFrames = message.getSampleOffset(); // sample accurate, the messages are ordered by offset
+        vstEvent->reserved1 = vstEvent->reserved2 = 0;
         vstEvent->midiData[0] = message.getStatus();
         vstEvent->midiData[1] = message.getData1();
         vstEvent->midiData[2] = message.getData2();
@@ -2,19 +2,283 @@
 
 #include <QApplication>
 #include <QLibraryInfo>
+#include <QDirIterator>
+#include <QThread>
 
 #include "log/Logging.h"
 
 using audio::VSTPluginFinder;
+using persistence::PluginScanResult;
 
-VSTPluginFinder::VSTPluginFinder()
+const int VSTPluginFinder::MAX_SCANNERS = 8;
+const int VSTPluginFinder::PLUGINS_PER_SCANNER = 8;
+const int VSTPluginFinder::PLUGIN_SCAN_TIMEOUT = 30000; // some plugins are checking licenses when loaded
+const int VSTPluginFinder::MAX_FAILED_SCANNERS = 3; // the scanner executable is broken, not a plugin
+
+VSTPluginFinder::VSTPluginFinder(const QDir &cacheDir) :
+    scanCache(cacheDir),
+    scanning(false),
+    cancelled(false),
+    scannerErrors(false),
+    failedScanners(0)
 {
-    //
+    timeoutTimer.setInterval(1000);
+    QObject::connect(&timeoutTimer, &QTimer::timeout, this, &VSTPluginFinder::checkScannersTimeout);
 }
 
 VSTPluginFinder::~VSTPluginFinder()
 {
-    //
+    for (Scanner *scanner : scanners) {
+        scanner->process->disconnect();
+        scanner->process->kill();
+        scanner->process->waitForFinished(1000);
+        delete scanner->process;
+        delete scanner;
+    }
+}
+
+bool VSTPluginFinder::canScan(const QFileInfo &pluginFileInfo)
+{
+    // same rule used in VstScanner, in Mac VST plugins are bundles, in windows these plugins are DLLs.
+    return pluginFileInfo.isBundle() || pluginFileInfo.suffix() == "dll";
+}
+
+QString VSTPluginFinder::getPluginPath(const QString &scannedLine)
+{
+    const int separatorIndex = scannedLine.indexOf(": ");
+    if (separatorIndex < 0)
+        return QString();
+
+    return scannedLine.mid(separatorIndex + 2);
+}
+
+void VSTPluginFinder::scan(const QStringList &foldersToScan, const QStringList &skipList)
+{
+    if (scanning) {
+        qCritical() << "VST scan is already running!";
+        return;
+    }
+
+    scannerExePath = getScannerExecutablePath();
+    if (scannerExePath.isEmpty())
+        return; // scanner executable not found!
+
+    scanning = true;
+    cancelled = false;
+    scannerErrors = false;
+    failedScanners = 0;
+    pendingPlugins.clear();
+
+    emit scanStarted();
+
+    QElapsedTimer timer;
+    timer.start();
+    int cachedPlugins = 0;
+
+    for (const QString &scanFolder : foldersToScan) {
+        QDirIterator folderIterator(scanFolder, QDir::AllEntries | QDir::NoDotAndDotDot | QDir::NoSymLinks, QDirIterator::Subdirectories);
+        while (folderIterator.hasNext()) {
+            folderIterator.next();
+            const QFileInfo pluginFileInfo(folderIterator.filePath());
+            const QString pluginPath = pluginFileInfo.absoluteFilePath();
+
+            if (skipList.contains(pluginPath) || !canScan(pluginFileInfo) || pendingPlugins.contains(pluginPath))
+                continue;
+
+            PluginScanResult result;
+            if (scanCache.lookup(pluginPath, result)) { // unchanged, the plugin is not loaded again
+                cachedPlugins++;
+                emit pluginScanFinished(result.getName(), pluginPath);
+                continue;
+            }
+
+            pendingPlugins.append(pluginPath);
+        }
+    }
+
+    qCInfo(jtStandalonePluginFinder) << cachedPlugins << "plugins recovered from scan cache," << pendingPlugins.size() << "plugins to scan (" << timer.elapsed() << "ms )";
+
+    if (pendingPlugins.isEmpty()) {
+        finishScanning();
+        return;
+    }
+
+    timeoutTimer.start();
+    startScanners();
+}
+
+void VSTPluginFinder::startScanners()
+{
+    const int maxScanners = qBound(1, QThread::idealThreadCount(), MAX_SCANNERS);
+    while (scanners.size() < maxScanners && !pendingPlugins.isEmpty() && !cancelled)
+        startScanner();
+}
+
+void VSTPluginFinder::startScanner()
+{
+    Scanner *scanner = new Scanner();
+    scanner->process = new QProcess(this);
+    scanner->plugins = pendingPlugins.mid(0, PLUGINS_PER_SCANNER);
+    scanner->timedOut = false;
+    scanner->scannedPlugins = false;
+    pendingPlugins = pendingPlugins.mid(PLUGINS_PER_SCANNER);
+
+    QObject::connect(scanner->process, &QProcess::readyReadStandardOutput, this, [=]() {
+        consumeScannerOutput(scanner);
+    });
+
+    QObject::connect(scanner->process, static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished), this, [=](int exitCode, QProcess::ExitStatus exitStatus) {
+        Q_UNUSED(exitCode)
+        consumeScannerOutput(scanner); // the last lines
+        handleScannerFinished(scanner, exitStatus == QProcess::CrashExit);
+    });
+
+    QObject::connect(scanner->process, static_cast<void (QProcess::*)(QProcess::ProcessError)>(&QProcess::error), this, [=](QProcess::ProcessError error) {
+        if (error != QProcess::FailedToStart)
+            return; // crashes are handled in 'finished'
+
+        qCritical() << "Can't start the VST scanner" << scanner->process->errorString();
+        scannerErrors = true;
+        pendingPlugins.clear();
+        removeScanner(scanner);
+    });
+
+    scanners.append(scanner);
+
+    scanner->pluginTimer.start();
+    scanner->process->start(scannerExePath, QStringList() << "--files" << buildCommaSeparatedString(scanner->plugins));
+
+    qCDebug(jtStandalonePluginFinder) << "Scan process started with" << scanner->plugins.size() << "plugins";
+}
+
+void VSTPluginFinder::consumeScannerOutput(Scanner *scanner)
+{
+    scanner->output.append(scanner->process->readAllStandardOutput());
+
+    int lineEnd;
+    while ((lineEnd = scanner->output.indexOf('\n')) >= 0) {
+        const QString line = QString::fromUtf8(scanner->output.constData(), lineEnd).trimmed();
+        scanner->output.remove(0, lineEnd + 1);
+
+        if (line.isEmpty() || cancelled)
+            continue;
+
+        const QString pluginPath = getPluginPath(line);
+        if (line.startsWith("JT-Scanner-Scanning:")) {
+            scanner->currentPlugin = pluginPath;
+            scanner->currentHash.clear();
+            scanner->scannedPlugins = true;
+            scanner->pluginTimer.start();
+            handleScanningStart(line);
+        }
+        else if (line.startsWith("JT-Scanner-Hash")) { // sent before the 'Scan-Finished' line
+            scanner->currentHash = QByteArray::fromHex(getPluginPath(line).toLatin1());
+        }
+        else if (line.startsWith("JT-Scanner-Scan-Finished")) {
+            const QString pluginName = audio::PluginDescriptor::getVstPluginNameFromPath(pluginPath);
+            scanCache.store(PluginScanResult(pluginPath, true, pluginName), scanner->currentHash);
+            scanner->plugins.removeOne(pluginPath);
+            scanner->currentPlugin.clear();
+            handleScanningFinished(line);
+        }
+        else if (line.startsWith("JT-Scanner-Scan-Failed")) { // not a VST plugin or failed to load, not cached
+            scanCache.remove(pluginPath);
+            scanner->plugins.removeOne(pluginPath);
+            scanner->currentPlugin.clear();
+        }
+    }
+}
+
+void VSTPluginFinder::handleScannerFinished(Scanner *scanner, bool crashed)
+{
+    if (!cancelled) {
+        if (crashed || scanner->timedOut)
+            scannerErrors = true;
+
+        if (!scanner->currentPlugin.isEmpty()) { // crash, timeout or exit() while loading this plugin
+            qCWarning(jtStandalonePluginFinder) << (scanner->timedOut ? "Timeout" : "Crash") << "scanning" << scanner->currentPlugin;
+            scannerErrors = true;
+            scanner->plugins.removeOne(scanner->currentPlugin);
+            emit badPluginDetected(scanner->currentPlugin);
+        }
+
+        if (!scanner->plugins.isEmpty()) { // the remaining plugins are scanned in a new process
+            failedScanners = scanner->scannedPlugins ? 0 : failedScanners + 1;
+            if (failedScanners <= MAX_FAILED_SCANNERS) {
+                pendingPlugins = scanner->plugins + pendingPlugins;
+            }
+            else {
+                qCritical() << "The VST scanner is failing before scanning any plugin," << scanner->plugins.size() << "plugins not scanned";
+                scannerErrors = true;
+            }
+        }
+        else if (scanner->scannedPlugins) {
+            failedScanners = 0;
+        }
+    }
+
+    removeScanner(scanner);
+}
+
+void VSTPluginFinder::removeScanner(Scanner *scanner)
+{
+    scanners.removeOne(scanner);
+    scanner->process->disconnect(this); // the lambdas are using the deleted scanner
+    scanner->process->deleteLater();
+    delete scanner;
+
+    if (!cancelled)
+        startScanners();
+
+    if (scanners.isEmpty() && scanning)
+        finishScanning();
+}
+
+void VSTPluginFinder::checkScannersTimeout()
+{
+    for (Scanner *scanner : scanners) {
+        if (!scanner->timedOut && scanner->pluginTimer.elapsed() > PLUGIN_SCAN_TIMEOUT) {
+            scanner->timedOut = true;
+            scanner->process->kill();
+        }
+    }
+}
+
+void VSTPluginFinder::finishScanning()
+{
+    timeoutTimer.stop();
+    scanning = false;
+
+    scanCache.save();
+
+    const bool finishedWithoutError = !scannerErrors && !cancelled;
+    qCDebug(jtStandalonePluginFinder) << "VST scan finished! without error:" << finishedWithoutError;
+
+    emit scanFinished(finishedWithoutError);
+}
+
+void VSTPluginFinder::cancel()
+{
+    if (!scanning)
+        return;
+
+    qCDebug(jtStandalonePluginFinder) << "Terminating scan processes!";
+
+    cancelled = true;
+    pendingPlugins.clear();
+    for (Scanner *scanner : scanners)
+        scanner->process->kill();
+}
+
+void VSTPluginFinder::clearScanCache()
+{
+    if (scanning) {
+        qCritical() << "Can't clear the VST scan cache while scanning!";
+        return;
+    }
+
+    scanCache.clear();
+    scanCache.save();
 }
 
 audio::PluginDescriptor VSTPluginFinder::getPluginDescriptor(const QFileInfo &f)
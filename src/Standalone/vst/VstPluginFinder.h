@@ -3,16 +3,39 @@
 
 #include "PluginFinder.h"
 #include "audio/core/PluginDescriptor.h"
+#include "persistence/PluginScanCache.h"
+
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QDir>
 
 namespace audio {
 
+/**
+    The VST plugins are scanned in a pool of VstScanner processes. The scan folders are walked
+    here, the unchanged plugins are recovered from the scan cache (not loaded again) and the new
+    or changed plugins are distributed to the scanner processes in small batches. A plugin
+    crashing or freezing a scanner (PLUGIN_SCAN_TIMEOUT) is reported as a bad plugin and the
+    remaining plugins of the batch are scanned by a new process. If a scanner dies before
+    starting a plugin, the whole batch is scanned again (MAX_FAILED_SCANNERS times at most).
+*/
+
 class VSTPluginFinder : public PluginFinder
 {
 
 public:
-    VSTPluginFinder();
+    explicit VSTPluginFinder(const QDir &cacheDir);
     virtual ~VSTPluginFinder();
 
+    void scan(const QStringList &foldersToScan = QStringList(), const QStringList &skipList = QStringList()) override;
+    void cancel() override;
+
+    void clearScanCache(); // all plugins are loaded again in the next scan
+
+    static const int MAX_SCANNERS;
+    static const int PLUGINS_PER_SCANNER; // a scanner process is restarted after this number of plugins
+    static const int PLUGIN_SCAN_TIMEOUT; // ms
+
 protected:
     QString getScannerExecutablePath() const override;
 
@@ -20,11 +43,44 @@ protected:
     void handleScanningFinished(const QString &scannedLine) override;
 
 private:
-    QProcess scanProcess;
-    QString lastScannedPlugin; // used to recover the last plugin path when the scanner process crash
+    struct Scanner
+    {
+        QProcess *process;
+        QStringList plugins; // the plugins not scanned yet
+        QString currentPlugin;
+        QByteArray currentHash; // the plugin binary hash, computed by the scanner
+        QElapsedTimer pluginTimer;
+        QByteArray output; // the incomplete output line
+        bool timedOut;
+        bool scannedPlugins; // at least one plugin was started in this process
+    };
+
+    void startScanners();
+    void startScanner();
+    void consumeScannerOutput(Scanner *scanner);
+    void handleScannerFinished(Scanner *scanner, bool crashed);
+    void removeScanner(Scanner *scanner);
+    void checkScannersTimeout();
+    void finishScanning();
 
     audio::PluginDescriptor getPluginDescriptor(const QFileInfo &f);
 
+    static bool canScan(const QFileInfo &pluginFileInfo);
+    static QString getPluginPath(const QString &scannedLine);
+
+    persistence::PluginScanCache scanCache;
+
+    QList<Scanner *> scanners;
+    QStringList pendingPlugins;
+    QString scannerExePath;
+    QTimer timeoutTimer;
+
+    bool scanning;
+    bool cancelled;
+    bool scannerErrors;
+    int failedScanners; // scanners finished with errors before scanning any plugin, in sequence
+
+    static const int MAX_FAILED_SCANNERS;
 };
 
 } // namespace
@@ -0,0 +1,121 @@
+#include "BenchmarkAudioMixer.h"
+
+#include "audio/core/AudioMixer.h"
+#include "audio/core/AudioNode.h"
+#include "audio/core/RenderWorkers.h"
+#include "audio/core/SamplesBuffer.h"
+#include <QElapsedTimer>
+#include <QTest>
+#include <QDebug>
+#include <cmath>
+
+using namespace audio;
+
+namespace {
+
+const int TRACKS = 16; // a full room
+const int FRAMES = 256;
+const int SAMPLE_RATE = 44100;
+const int CALLBACKS = 2000;
+const int FIR_TAPS = 32; // per sample work, similar to vorbis decoding + resampling + low cut in a real ninjam track
+
+/**
+    Simulate the NinjamTrackNode workload: the internal input buffer is filled with 'decoded'
+    samples (a filtered sine wave) and AudioNode::processReplacing apply gain, pan and compute peaks.
+*/
+class SyntheticNinjamTrackNode : public AudioNode
+{
+public:
+    explicit SyntheticNinjamTrackNode(float frequency) :
+        phase(0),
+        phaseIncrement(2.0 * 3.141592653589793 * frequency / SAMPLE_RATE)
+    {
+        for (int i = 0; i < FIR_TAPS; ++i) {
+            history[i] = 0;
+            coefficients[i] = 1.0f / FIR_TAPS;
+        }
+        setPan(frequency > 440 ? 0.5f : -0.5f);
+    }
+
+    void processReplacing(const SamplesBuffer &in, SamplesBuffer &out, int sampleRate, const std::vector<midi::MidiMessage> &midiBuffer) override
+    {
+        const uint frames = out.getFrameLenght();
+        internalInputBuffer.setFrameLenght(frames);
+
+        for (uint s = 0; s < frames; ++s) {
+            for (int i = FIR_TAPS - 1; i > 0; --i)
+                history[i] = history[i - 1];
+            history[0] = static_cast<float>(std::sin(phase));
+            phase += phaseIncrement;
+
+            float value = 0;
+            for (int i = 0; i < FIR_TAPS; ++i)
+                value += history[i] * coefficients[i];
+
+            internalInputBuffer.set(0, s, value);
+            internalInputBuffer.set(1, s, value);
+        }
+
+        AudioNode::processReplacing(in, out, sampleRate, midiBuffer);
+    }
+
+private:
+    double phase;
+    double phaseIncrement;
+    float history[FIR_TAPS];
+    float coefficients[FIR_TAPS];
+};
+
+double render(int threads, SamplesBuffer &out)
+{
+    AudioMixer mixer(SAMPLE_RATE);
+    mixer.setRenderThreads(threads);
+    for (int t = 0; t < TRACKS; ++t)
+        mixer.addNode(QSharedPointer<SyntheticNinjamTrackNode>::create(220.0f + t * 55.0f));
+
+    SamplesBuffer in(2, FRAMES);
+    std::vector<midi::MidiMessage> midiBuffer;
+
+    // warming up (workers are spinning, caches are hot)
+    for (int i = 0; i < 100; ++i) {
+        out.zero();
+        mixer.process(in, out, SAMPLE_RATE, midiBuffer);
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < CALLBACKS; ++i) {
+        out.zero();
+        mixer.process(in, out, SAMPLE_RATE, midiBuffer);
+    }
+
+    return static_cast<double>(timer.nsecsElapsed()) / (1000000.0 * CALLBACKS); // ms per callback
+}
+
+} // namespace
+
+void BenchmarkAudioMixer::parallelRendering()
+{
+    qInfo().noquote() << QString("%1 tracks, %2 frames per callback, %3 cores available")
+                         .arg(TRACKS).arg(FRAMES).arg(RenderWorkers::getAvailableCores());
+
+    SamplesBuffer serialOutput(2, FRAMES);
+    const double serialTime = render(1, serialOutput);
+
+    for (int threads : {1, 2, 4, 8}) {
+        SamplesBuffer output(2, FRAMES);
+        const double time = threads == 1 ? serialTime : render(threads, output);
+
+        if (threads > 1) { // the summing order is the same, the output must be identical
+            for (uint c = 0; c < 2; ++c) {
+                for (uint s = 0; s < FRAMES; ++s)
+                    QCOMPARE(output.get(c, s), serialOutput.get(c, s));
+            }
+        }
+
+        qInfo().noquote() << QString("%1 threads: %2 ms/callback (%3x)")
+                             .arg(threads)
+                             .arg(time, 0, 'f', 4)
+                             .arg(serialTime / time, 0, 'f', 2);
+    }
+}
@@ -0,0 +1,14 @@
+#ifndef BENCHMARKAUDIOMIXER_H
+#define BENCHMARKAUDIOMIXER_H
+
+#include <QObject>
+
+class BenchmarkAudioMixer: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void parallelRendering(); // N synthetic ninjam tracks rendered using 1 to 8 threads, print ms/callback and the speedup
+};
+
+#endif // BENCHMARKAUDIOMIXER_H
@@ -0,0 +1,165 @@
+#include "BenchmarkPluginBridge.h"
+
+#include "audio/bridge/PluginBridgeHost.h"
+#include "audio/bridge/PluginBridgeChild.h"
+#include "audio/bridge/BridgeTestProcessor.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QProcess>
+#include <QTest>
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+using namespace audio;
+
+const QString BenchmarkPluginBridge::CHILD_ARGUMENT("--bridge-child");
+
+namespace {
+
+enum class Hosting
+{
+    InProcess,
+    BridgedThread, // transport cost without process isolation
+    BridgedProcess
+};
+
+const int CHANNELS = 2;
+const int SAMPLE_RATE = 44100;
+const int SECONDS = 2; // of audio processed in each row
+const int MAX_FRAMES = 1024;
+
+QString createKey()
+{
+    static int bridges = 0;
+    return QString("jtbb%1_%2").arg(QCoreApplication::applicationPid()).arg(bridges++);
+}
+
+} // namespace
+
+int BenchmarkPluginBridge::runChild(const QString &key)
+{
+    PluginBridgeChild child;
+    if (!child.attach(key))
+        return 1;
+
+    BridgeTestProcessor processor;
+    child.setReady(processor.getFlags());
+    child.run(&processor, nullptr); // the benchmark always sends the Quit command
+
+    return 0;
+}
+
+void BenchmarkPluginBridge::roundTrip()
+{
+    QFETCH(int, hosting);
+    QFETCH(int, frames);
+
+    std::vector<std::vector<float>> inputs(CHANNELS, std::vector<float>(frames));
+    std::vector<std::vector<float>> outputs(CHANNELS, std::vector<float>(frames));
+    const float *inputsArray[CHANNELS];
+    float *outputsArray[CHANNELS];
+    for (int c = 0; c < CHANNELS; ++c) {
+        for (int i = 0; i < frames; ++i)
+            inputs[c][i] = std::sin(i * 0.01f);
+
+        inputsArray[c] = inputs[c].data();
+        outputsArray[c] = outputs[c].data();
+    }
+
+    const std::vector<midi::MidiMessage> midiMessages;
+    const qint64 deadline = Q_INT64_C(500000000) * frames / SAMPLE_RATE; // half block period, as in the bridged plugins
+
+    BridgeTestProcessor processor;
+    PluginBridgeHost host;
+    PluginBridgeChild child;
+    std::thread childThread;
+    QProcess childProcess;
+
+    const QString key = createKey();
+    if (static_cast<Hosting>(hosting) != Hosting::InProcess) {
+        QVERIFY(host.create(key, CHANNELS, MAX_FRAMES));
+
+        if (static_cast<Hosting>(hosting) == Hosting::BridgedThread) {
+            QVERIFY(child.attach(key));
+            child.setReady(processor.getFlags());
+            childThread = std::thread([&]() {
+                child.run(&processor, nullptr);
+            });
+        }
+        else {
+            childProcess.setProcessChannelMode(QProcess::ForwardedChannels);
+            childProcess.start(QCoreApplication::applicationFilePath(), QStringList() << CHILD_ARGUMENT << key);
+        }
+
+        QVERIFY(host.waitChildReady(5000));
+    }
+
+    auto processBlock = [&]() {
+        if (static_cast<Hosting>(hosting) == Hosting::InProcess)
+            processor.process(inputsArray, outputsArray, CHANNELS, frames, midiMessages);
+        else
+            host.process(inputsArray, outputsArray, CHANNELS, frames, midiMessages, deadline);
+    };
+
+    for (int i = 0; i < 1000; ++i) // warming up
+        processBlock();
+
+    const qint64 lateBlocksBefore = host.getLateBlocks() + host.getDroppedBlocks();
+    const int blocks = SECONDS * SAMPLE_RATE / frames;
+    std::vector<qint64> latencies;
+    latencies.reserve(static_cast<size_t>(blocks));
+
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < blocks; ++i) {
+        const qint64 start = timer.nsecsElapsed();
+        processBlock();
+        latencies.push_back(timer.nsecsElapsed() - start);
+    }
+    const double seconds = timer.nsecsElapsed() / 1000000000.0;
+
+    const qint64 lateBlocks = host.getLateBlocks() + host.getDroppedBlocks() - lateBlocksBefore;
+
+    // checking the output, without the deadline
+    if (static_cast<Hosting>(hosting) != Hosting::InProcess) {
+        QTest::qWait(10); // late blocks are processed
+        QVERIFY(host.process(inputsArray, outputsArray, CHANNELS, frames, midiMessages, Q_INT64_C(1000000000)));
+    }
+    QCOMPARE(outputs[0][frames - 1], inputs[0][frames - 1]); // gain is 1
+
+    host.destroy();
+    if (childThread.joinable())
+        childThread.join();
+    if (childProcess.state() != QProcess::NotRunning && !childProcess.waitForFinished(1000))
+        childProcess.kill();
+
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [&latencies](int p) {
+        return latencies[static_cast<size_t>(latencies.size() - 1) * p / 100] / 1000.0;
+    };
+
+    qInfo().noquote() << QString("latency p50 %1 us, p99 %2 us, max %3 us, %4 blocks/s (%5x realtime), %6 late blocks (deadline %7 us)")
+                         .arg(percentile(50), 0, 'f', 1)
+                         .arg(percentile(99), 0, 'f', 1)
+                         .arg(latencies.back() / 1000.0, 0, 'f', 1)
+                         .arg(blocks / seconds, 0, 'f', 0)
+                         .arg(static_cast<double>(blocks) * frames / (SAMPLE_RATE * seconds), 0, 'f', 1)
+                         .arg(lateBlocks)
+                         .arg(deadline / 1000);
+}
+
+void BenchmarkPluginBridge::roundTrip_data()
+{
+    QTest::addColumn<int>("hosting");
+    QTest::addColumn<int>("frames");
+
+    const QStringList hostings = {"in process", "bridged thread", "bridged process"};
+    for (int frames : {64, 256, 1024}) {
+        for (int hosting = 0; hosting < hostings.size(); ++hosting)
+            QTest::newRow(qPrintable(QString("%1, %2 frames").arg(hostings.at(hosting)).arg(frames))) << hosting << frames;
+    }
+}
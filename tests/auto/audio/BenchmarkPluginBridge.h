@@ -0,0 +1,20 @@
+#ifndef BENCHMARKPLUGINBRIDGE_H
+#define BENCHMARKPLUGINBRIDGE_H
+
+#include <QObject>
+
+class BenchmarkPluginBridge: public QObject
+{
+    Q_OBJECT
+
+public:
+    static int runChild(const QString &key); // the bridged plugin process, this executable started with CHILD_ARGUMENT
+
+    static const QString CHILD_ARGUMENT;
+
+private slots:
+    void roundTrip(); // the built-in test plugin in process, bridged to a thread and bridged to a child process. Print the latency percentiles and blocks/s
+    void roundTrip_data();
+};
+
+#endif // BENCHMARKPLUGINBRIDGE_H
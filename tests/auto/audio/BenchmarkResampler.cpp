@@ -0,0 +1,50 @@
+#include "BenchmarkResampler.h"
+
+#include "audio/SamplesBufferResampler.h"
+#include "audio/core/SamplesBuffer.h"
+#include <QTest>
+#include <cmath>
+
+Q_DECLARE_METATYPE(ResamplerQuality)
+
+using audio::SamplesBuffer;
+
+namespace {
+const int FRAMES = 256;
+}
+
+void BenchmarkResampler::stereoBlock()
+{
+    QFETCH(ResamplerQuality, quality);
+    QFETCH(int, sourceSampleRate);
+    QFETCH(int, targetSampleRate);
+
+    SamplesBufferResampler resampler(quality);
+    resampler.setSampleRates(sourceSampleRate, targetSampleRate);
+
+    SamplesBuffer in(2, FRAMES * 4);
+    for (int s = 0; s < FRAMES * 4; ++s) {
+        in.set(0, s, std::sin(s * 0.01f));
+        in.set(1, s, std::cos(s * 0.01f));
+    }
+
+    QBENCHMARK {
+        in.setFrameLenght(resampler.getRequiredInputFrames(FRAMES));
+        resampler.resample(in, FRAMES);
+    }
+}
+
+void BenchmarkResampler::stereoBlock_data()
+{
+    QTest::addColumn<ResamplerQuality>("quality");
+    QTest::addColumn<int>("sourceSampleRate");
+    QTest::addColumn<int>("targetSampleRate");
+
+    const QList<QPair<int, int>> ratios = {{44100, 48000}, {48000, 44100}, {96000, 44100}};
+    for (const auto &ratio : ratios) {
+        const QString name = QString("%1 -> %2").arg(ratio.first).arg(ratio.second);
+        QTest::newRow(qPrintable("fast " + name)) << ResamplerQuality::Fast << ratio.first << ratio.second;
+        QTest::newRow(qPrintable("medium " + name)) << ResamplerQuality::Medium << ratio.first << ratio.second;
+        QTest::newRow(qPrintable("best " + name)) << ResamplerQuality::Best << ratio.first << ratio.second;
+    }
+}
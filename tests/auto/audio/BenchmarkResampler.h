@@ -0,0 +1,15 @@
+#ifndef BENCHMARKRESAMPLER_H
+#define BENCHMARKRESAMPLER_H
+
+#include <QObject>
+
+class BenchmarkResampler: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void stereoBlock(); // resampling a stereo audio callback (256 frames), as NinjamTrackNode is doing
+    void stereoBlock_data();
+};
+
+#endif // BENCHMARKRESAMPLER_H
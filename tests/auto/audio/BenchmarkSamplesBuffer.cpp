@@ -0,0 +1,134 @@
+#include "BenchmarkSamplesBuffer.h"
+
+#include "audio/core/SamplesBuffer.h"
+#include "audio/core/SamplesKernels.h"
+#include <QElapsedTimer>
+#include <QTest>
+#include <QDebug>
+#include <vector>
+#include <cmath>
+
+using namespace audio;
+
+namespace {
+const int SAMPLES = 4096; // fit in L1 cache, we are measuring the arithmetic, not the memory
+const int ITERATIONS = 20000;
+}
+
+void BenchmarkSamplesBuffer::benchmarkKernel(const char *kernelName, std::function<void(const SamplesKernels &, float *, float *)> kernel)
+{
+    std::vector<float> samples(SAMPLES);
+    std::vector<float> otherSamples(SAMPLES);
+    for (int i = 0; i < SAMPLES; ++i) {
+        samples[i] = std::sin(i * 0.01f);
+        otherSamples[i] = std::cos(i * 0.01f);
+    }
+
+    double scalarNanosPerSample = 0;
+    for (auto kernels : SamplesKernels::getSupported()) {
+        QElapsedTimer timer;
+        timer.start();
+        for (int i = 0; i < ITERATIONS; ++i)
+            kernel(*kernels, samples.data(), otherSamples.data());
+
+        const double nanosPerSample = static_cast<double>(timer.nsecsElapsed()) / (static_cast<double>(SAMPLES) * ITERATIONS);
+        if (kernels == &SamplesKernels::getScalar())
+            scalarNanosPerSample = nanosPerSample;
+
+        qInfo().noquote() << QString("%1 %2: %3 ns/sample (%4x scalar)")
+                             .arg(kernelName)
+                             .arg(kernels->name, -6)
+                             .arg(nanosPerSample, 0, 'f', 4)
+                             .arg(scalarNanosPerSample / nanosPerSample, 0, 'f', 2);
+    }
+}
+
+void BenchmarkSamplesBuffer::scale()
+{
+    benchmarkKernel("scale", [](const SamplesKernels &k, float *samples, float *) {
+        k.scale(samples, SAMPLES, 0.99999f);
+    });
+}
+
+void BenchmarkSamplesBuffer::ramp()
+{
+    benchmarkKernel("ramp", [](const SamplesKernels &k, float *samples, float *) {
+        k.ramp(samples, SAMPLES, 1.0f, -0.000001f);
+    });
+}
+
+void BenchmarkSamplesBuffer::add()
+{
+    benchmarkKernel("add", [](const SamplesKernels &k, float *samples, float *otherSamples) {
+        k.add(samples, otherSamples, SAMPLES);
+    });
+}
+
+void BenchmarkSamplesBuffer::peak()
+{
+    benchmarkKernel("peak", [](const SamplesKernels &k, float *samples, float *) {
+        float squaredSum = 0;
+        k.peak(samples, SAMPLES, &squaredSum);
+    });
+}
+
+void BenchmarkSamplesBuffer::scaleAndPeak()
+{
+    benchmarkKernel("scaleAndPeak", [](const SamplesKernels &k, float *samples, float *) {
+        float squaredSum = 0;
+        k.scaleAndPeak(samples, SAMPLES, 0.99999f, &squaredSum);
+    });
+}
+
+void BenchmarkSamplesBuffer::dotProduct()
+{
+    benchmarkKernel("dotProduct", [](const SamplesKernels &k, float *samples, float *otherSamples) {
+        volatile float result = k.dotProduct(samples, otherSamples, SAMPLES);
+        Q_UNUSED(result)
+    });
+}
+
+void BenchmarkSamplesBuffer::mix()
+{
+    benchmarkKernel("mix", [](const SamplesKernels &k, float *samples, float *otherSamples) {
+        const float *sources[] = {otherSamples, otherSamples, otherSamples, otherSamples, otherSamples, otherSamples, otherSamples, otherSamples};
+        const float beginGains[] = {0.5f, 0.5f, 0.5f, 0.5f, 0.5f, 0.5f, 0.5f, 0.5f};
+        const float gainSteps[] = {0, 0, 0, 0, -0.000001f, -0.000001f, -0.000001f, -0.000001f};
+        k.mix(samples, sources, beginGains, gainSteps, 8, SAMPLES);
+    });
+}
+
+void BenchmarkSamplesBuffer::gainPanPeak()
+{
+    QFETCH(bool, fused);
+    QFETCH(int, frames);
+
+    SamplesBuffer buffer(2, frames);
+    for (int s = 0; s < frames; ++s) {
+        buffer.set(0, s, std::sin(s * 0.01f));
+        buffer.set(1, s, std::cos(s * 0.01f));
+    }
+
+    if (fused) {
+        QBENCHMARK {
+            buffer.applyGainAndComputePeak(0.99999f, 0.7f, 0.7f, 1.0f);
+        }
+    }
+    else {
+        QBENCHMARK {
+            buffer.applyGain(0.99999f, 0.7f, 0.7f, 1.0f);
+            buffer.computePeak();
+        }
+    }
+}
+
+void BenchmarkSamplesBuffer::gainPanPeak_data()
+{
+    QTest::addColumn<bool>("fused");
+    QTest::addColumn<int>("frames");
+
+    for (int frames : {32, 256, 4096}) {
+        QTest::newRow(qPrintable(QString("two passes - %1 frames").arg(frames))) << false << frames;
+        QTest::newRow(qPrintable(QString("fused - %1 frames").arg(frames))) << true << frames;
+    }
+}
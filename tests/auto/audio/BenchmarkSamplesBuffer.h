@@ -0,0 +1,32 @@
+#ifndef BENCHMARKSAMPLESBUFFER_H
+#define BENCHMARKSAMPLESBUFFER_H
+
+#include <QObject>
+#include <functional>
+
+namespace audio {
+struct SamplesKernels;
+}
+
+class BenchmarkSamplesBuffer: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void scale();
+    void ramp();
+    void add();
+    void peak();
+    void scaleAndPeak();
+    void dotProduct();
+    void mix(); // 8 looper layers, 4 with gain ramps
+
+    void gainPanPeak(); // applyGain + computePeak (as AudioNode did before) vs the fused pass
+    void gainPanPeak_data();
+
+private:
+    // run the kernel in all supported implementations and print ns/sample compared to scalar reference
+    void benchmarkKernel(const char *kernelName, std::function<void(const audio::SamplesKernels &, float *, float *)> kernel);
+};
+
+#endif // BENCHMARKSAMPLESBUFFER_H
@@ -0,0 +1,292 @@
+#include "TestEncodingService.h"
+
+#include <QTest>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QMap>
+#include <QVector>
+#include <QThread>
+#include <atomic>
+
+#include "audio/EncodingService.h"
+#include "audio/Encoder.h"
+
+using audio::EncodingService;
+using audio::SamplesBuffer;
+
+namespace {
+
+std::atomic<int> runningEncoders(0);
+std::atomic<int> maxRunningEncoders(0);
+
+class FakeEncoder : public AudioEncoder // keep the encoded samples, the 'encoded' data is the block size
+{
+public:
+    explicit FakeEncoder(int encodingTime = 0, bool buffering = false) :
+        encodingTime(encodingTime),
+        buffering(buffering)
+    {
+    }
+
+    QByteArray encode(const SamplesBuffer &audioBuffer) override
+    {
+        const int running = ++runningEncoders;
+        int maxRunning = maxRunningEncoders.load();
+        while (running > maxRunning && !maxRunningEncoders.compare_exchange_weak(maxRunning, running)) {
+        }
+
+        if (encodingTime > 0)
+            QThread::msleep(encodingTime);
+
+        for (uint i = 0; i < audioBuffer.getFrameLenght(); ++i)
+            samples.append(audioBuffer.get(0, i));
+
+        blocks.append(audioBuffer.getFrameLenght());
+
+        runningEncoders--;
+
+        if (buffering && blocks.size() == 1)
+            return QByteArray(); // the first block is not producing data, like vorbis
+
+        return QByteArray::number(audioBuffer.getFrameLenght()) + ";";
+    }
+
+    QByteArray finishIntervalEncoding() override
+    {
+        return QByteArray("end;");
+    }
+
+    int getChannels() const override { return 1; }
+    int getSampleRate() const override { return 44100; }
+
+    QVector<float> samples; // read after the service is destroyed
+    QVector<uint> blocks;
+
+private:
+    int encodingTime; // ms
+    bool buffering;
+};
+
+class EncodedData // collect the data encoded by the workers
+{
+public:
+    struct Part
+    {
+        QByteArray data;
+        bool firstPart;
+        bool lastPart;
+    };
+
+    EncodingService::EncodedDataHandler getHandler()
+    {
+        return [this](quint8 channelIndex, const QByteArray &encodedData, bool firstPart, bool lastPart) {
+            QMutexLocker locker(&mutex);
+            parts[channelIndex].append({encodedData, firstPart, lastPart});
+            if (lastPart)
+                finishedIntervals++;
+        };
+    }
+
+    bool waitForIntervals(int intervals)
+    {
+        for (int i = 0; i < 500; ++i) {
+            {
+                QMutexLocker locker(&mutex);
+                if (finishedIntervals >= intervals)
+                    return true;
+            }
+            QThread::msleep(10);
+        }
+        return false;
+    }
+
+    QList<Part> get(quint8 channelIndex)
+    {
+        QMutexLocker locker(&mutex);
+        return parts.value(channelIndex);
+    }
+
+    QByteArray getData(quint8 channelIndex)
+    {
+        QByteArray data;
+        for (const auto &part : get(channelIndex))
+            data.append(part.data);
+        return data;
+    }
+
+private:
+    QMutex mutex;
+    QMap<quint8, QList<Part>> parts;
+    int finishedIntervals = 0;
+};
+
+SamplesBuffer createRamp(uint frames, uint firstValue)
+{
+    SamplesBuffer buffer(1, frames);
+    for (uint i = 0; i < frames; ++i)
+        buffer.set(0, i, static_cast<float>(firstValue + i));
+    return buffer;
+}
+
+// send an interval with 'chunks' audio callbacks of 'chunkSize' frames
+void sendInterval(EncodingService &service, const QList<QSharedPointer<AudioEncoder>> &encoders, int chunks, uint chunkSize)
+{
+    for (int chunk = 0; chunk < chunks; ++chunk) { // the 'audio thread'
+        for (int c = 0; c < encoders.size(); ++c)
+            service.addSamplesToEncode(createRamp(chunkSize, chunk * chunkSize), c, encoders.at(c), chunk == 0, chunk == chunks - 1);
+    }
+}
+
+} // namespace
+
+void TestEncodingService::samplesAreEncodedInOrderPerChannel()
+{
+    const int channels = 4;
+    const int chunks = 500;
+    const uint chunkSize = 64;
+
+    QList<QSharedPointer<FakeEncoder>> encoders;
+    QList<QSharedPointer<AudioEncoder>> audioEncoders;
+    for (int c = 0; c < channels; ++c) {
+        encoders.append(QSharedPointer<FakeEncoder>::create());
+        audioEncoders.append(encoders.last());
+    }
+
+    {
+        EncodedData encodedData;
+        EncodingService service(encodedData.getHandler(), channels, 4);
+        sendInterval(service, audioEncoders, chunks, chunkSize);
+
+        QVERIFY(encodedData.waitForIntervals(channels));
+    }
+
+    for (const auto &encoder : encoders) {
+        QCOMPARE(encoder->samples.size(), chunks * static_cast<int>(chunkSize));
+        for (int i = 0; i < encoder->samples.size(); ++i)
+            QCOMPARE(encoder->samples.at(i), static_cast<float>(i));
+    }
+}
+
+void TestEncodingService::samplesAreEncodedInBlocks()
+{
+    auto encoder = QSharedPointer<FakeEncoder>::create();
+    {
+        EncodedData encodedData;
+        EncodingService service(encodedData.getHandler(), 1, 1);
+        sendInterval(service, {encoder}, 25, 100); // 2500 frames in small audio callbacks
+
+        QVERIFY(encodedData.waitForIntervals(1));
+    }
+
+    QCOMPARE(encoder->blocks, QVector<uint>({1024, 1024, 452})); // the last block is smaller, finishing the interval
+}
+
+void TestEncodingService::lastPartFinishesTheInterval()
+{
+    EncodedData encodedData;
+    EncodingService service(encodedData.getHandler(), 1, 1);
+    sendInterval(service, {QSharedPointer<FakeEncoder>::create()}, 2, 1024);
+    sendInterval(service, {QSharedPointer<FakeEncoder>::create()}, 1, 512);
+
+    QVERIFY(encodedData.waitForIntervals(2));
+    QCOMPARE(encodedData.getData(0), QByteArray("1024;1024;end;512;end;"));
+
+    const auto parts = encodedData.get(0);
+    QCOMPARE(parts.size(), 3);
+    QVERIFY(parts.at(0).firstPart && !parts.at(0).lastPart);
+    QVERIFY(!parts.at(1).firstPart && parts.at(1).lastPart); // the last block and the interval end are sent together
+    QVERIFY(parts.at(2).firstPart && parts.at(2).lastPart);
+}
+
+void TestEncodingService::intervalEndIsNotLostWhenMarkersQueueIsFull()
+{
+    const int intervals = 100; // 2 markers per interval, more than the markers queue capacity
+    const uint chunkSize = 16;
+
+    EncodedData encodedData;
+    EncodingService service(encodedData.getHandler(), 1, 1);
+
+    auto encoder = QSharedPointer<FakeEncoder>::create(5); // the worker is slow, the markers queue is full
+    for (int i = 0; i < intervals; ++i)
+        sendInterval(service, {encoder}, 1, chunkSize);
+
+    const int droppedIntervals = static_cast<int>(service.getMetrics(0).droppedFrames / chunkSize);
+    QVERIFY(droppedIntervals > 0);
+    QVERIFY(encodedData.waitForIntervals(intervals - droppedIntervals)); // every accepted interval is finished
+
+    for (const auto &part : encodedData.get(0)) {
+        QCOMPARE(part.data, QByteArray("16;end;"));
+        QVERIFY(part.firstPart && part.lastPart);
+    }
+}
+
+void TestEncodingService::firstPartIsSentWithFirstEncodedData()
+{
+    EncodedData encodedData;
+    EncodingService service(encodedData.getHandler(), 1, 1);
+    sendInterval(service, {QSharedPointer<FakeEncoder>::create(0, true)}, 3, 1024);
+
+    QVERIFY(encodedData.waitForIntervals(1));
+
+    const auto parts = encodedData.get(0);
+    QCOMPARE(parts.size(), 2); // the first block is buffered by the encoder
+    QVERIFY(parts.at(0).firstPart);
+    QVERIFY(!parts.at(1).firstPart);
+}
+
+void TestEncodingService::channelsAreEncodedInParallel()
+{
+    if (QThread::idealThreadCount() < 2)
+        QSKIP("Only one core available");
+
+    runningEncoders = 0;
+    maxRunningEncoders = 0;
+
+    const int channels = 4;
+
+    QList<QSharedPointer<AudioEncoder>> encoders;
+    for (int c = 0; c < channels; ++c)
+        encoders.append(QSharedPointer<FakeEncoder>::create(5));
+
+    EncodedData encodedData;
+    EncodingService service(encodedData.getHandler(), channels, 2);
+    sendInterval(service, encoders, 10, EncodingService::ENCODING_BLOCK_SIZE);
+
+    QVERIFY(encodedData.waitForIntervals(channels));
+
+    QCOMPARE(maxRunningEncoders.load(), 2); // more than one channel at same time, but not more than the pool threads
+}
+
+void TestEncodingService::notReservedChannelsAreIgnored()
+{
+    EncodedData encodedData;
+    EncodingService service(encodedData.getHandler(), 1, 1);
+
+    service.addSamplesToEncode(createRamp(512, 0), 1, QSharedPointer<FakeEncoder>::create(), true, true);
+    QCOMPARE(service.getMetrics(1).queuedFrames, 0u);
+
+    service.reserveChannel(1);
+    service.addSamplesToEncode(createRamp(512, 0), 1, QSharedPointer<FakeEncoder>::create(), true, true);
+
+    QVERIFY(encodedData.waitForIntervals(1));
+    QCOMPARE(encodedData.getData(1), QByteArray("512;end;"));
+}
+
+void TestEncodingService::metrics()
+{
+    EncodedData encodedData;
+    EncodingService service(encodedData.getHandler(), 1, 1);
+
+    sendInterval(service, {QSharedPointer<FakeEncoder>::create(2)}, 20, 1024);
+
+    QVERIFY(encodedData.waitForIntervals(1));
+
+    auto metrics = service.getMetrics(0);
+    QCOMPARE(metrics.encodedBlocks, quint64(20));
+    QCOMPARE(metrics.queuedFrames, 0u);
+    QCOMPARE(metrics.droppedFrames, quint64(0));
+    QVERIFY(metrics.averageLatency > 0);
+    QVERIFY(metrics.maxLatency >= metrics.averageLatency);
+
+    QCOMPARE(service.getMetrics(1).encodedBlocks, quint64(0));
+}
@@ -0,0 +1,21 @@
+#ifndef TESTENCODINGSERVICE_H
+#define TESTENCODINGSERVICE_H
+
+#include <QObject>
+
+class TestEncodingService: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void samplesAreEncodedInOrderPerChannel();
+    void samplesAreEncodedInBlocks();
+    void lastPartFinishesTheInterval();
+    void intervalEndIsNotLostWhenMarkersQueueIsFull();
+    void firstPartIsSentWithFirstEncodedData();
+    void channelsAreEncodedInParallel();
+    void notReservedChannelsAreIgnored();
+    void metrics();
+};
+
+#endif // TESTENCODINGSERVICE_H
@@ -0,0 +1,296 @@
+#include "TestLooperMixer.h"
+
+#include <QTest>
+#include <vector>
+#include <cmath>
+#include <memory>
+
+#include "looper/LooperMixer.h"
+#include "audio/core/SamplesBuffer.h"
+#include "audio/core/SamplesKernels.h"
+
+using audio::LooperMixer;
+using audio::LooperLayer;
+using audio::SamplesBuffer;
+using audio::SamplesKernels;
+
+namespace {
+
+const uint INTERVAL_LENGHT = 4000;
+
+SamplesBuffer createSamples(uint frames, float leftValue, float rightValue)
+{
+    SamplesBuffer buffer(2, frames);
+    for (uint i = 0; i < frames; ++i) {
+        buffer.set(0, i, leftValue * std::sin(i * 0.01f + leftValue));
+        buffer.set(1, i, rightValue * std::cos(i * 0.01f + rightValue));
+    }
+    return buffer;
+}
+
+SamplesBuffer createConstantSamples(uint frames, float value)
+{
+    SamplesBuffer buffer(2, frames);
+    for (uint i = 0; i < frames; ++i) {
+        buffer.set(0, i, value);
+        buffer.set(1, i, value);
+    }
+    return buffer;
+}
+
+struct Layers
+{
+    std::vector<std::unique_ptr<LooperLayer>> layers;
+    std::vector<LooperLayer *> pointers;
+
+    explicit Layers(int count)
+    {
+        for (int l = 0; l < count; ++l) {
+            layers.emplace_back(new LooperLayer());
+            layers.back()->prepareForNewCycle(INTERVAL_LENGHT, false);
+            layers.back()->setPan(-1); // avoiding pan law in expected values
+            pointers.push_back(layers.back().get());
+        }
+    }
+
+    LooperLayer *operator[](int index)
+    {
+        return pointers[index];
+    }
+};
+
+// the expected output, each layer mixed separately
+float computeExpectedSample(Layers &layers, quint32 layersMask, uint position, float mainGain, quint8 channel)
+{
+    float value = 0;
+    for (size_t l = 0; l < layers.pointers.size(); ++l) {
+        const LooperLayer *layer = layers.pointers[l];
+        if (!(layersMask & (1u << l)) || !layer->isAudible() || position >= layer->getAvailableSamples())
+            continue;
+
+        const float panGain = channel == 0 ? layer->getLeftGain() : layer->getRightGain();
+        value += layer->getSamples(channel)[position] * mainGain * layer->getGain() * panGain;
+    }
+
+    return value;
+}
+
+void checkOutput(Layers &layers, quint32 layersMask, const SamplesBuffer &out, uint intervalPosition, float mainGain)
+{
+    for (quint8 c = 0; c < 2; ++c) {
+        for (uint s = 0; s < out.getFrameLenght(); ++s) {
+            const float expected = computeExpectedSample(layers, layersMask, intervalPosition + s, mainGain, c);
+            if (std::abs(out.get(c, s) - expected) > 0.00001f)
+                QFAIL(qPrintable(QString("channel %1, sample %2: %3 != %4").arg(c).arg(s).arg(out.get(c, s)).arg(expected)));
+        }
+    }
+}
+
+SamplesBuffer mixBlock(LooperMixer &mixer, Layers &layers, quint32 layersMask, uint frames, uint intervalPosition, float mainGain = 1.0f)
+{
+    SamplesBuffer out(2, frames);
+    out.zero();
+    mixer.startBlock();
+    mixer.mix(out, frames, intervalPosition, mainGain, layers.pointers.data(), layers.pointers.size(), layersMask);
+    return out;
+}
+
+} // namespace
+
+void TestLooperMixer::mixKernelsMatchScalar()
+{
+    const uint count = 1003; // not multiple of SIMD width
+    const uint sourcesCount = 5;
+
+    std::vector<std::vector<float>> sources(sourcesCount, std::vector<float>(count));
+    const float *sourcesPointers[sourcesCount];
+    float beginGains[sourcesCount];
+    float gainSteps[sourcesCount];
+    for (uint s = 0; s < sourcesCount; ++s) {
+        for (uint i = 0; i < count; ++i)
+            sources[s][i] = std::sin(i * 0.05f * (s + 1));
+
+        sourcesPointers[s] = sources[s].data();
+        beginGains[s] = 0.2f * s;
+        gainSteps[s] = (s % 2) ? 0.0f : -0.0001f; // constant gains and ramps
+    }
+
+    std::vector<float> expected(count, 0.5f);
+    SamplesKernels::getScalar().mix(expected.data(), sourcesPointers, beginGains, gainSteps, sourcesCount, count);
+
+    for (auto kernels : SamplesKernels::getSupported()) {
+        std::vector<float> dest(count, 0.5f);
+        kernels->mix(dest.data(), sourcesPointers, beginGains, gainSteps, sourcesCount, count);
+        for (uint i = 0; i < count; ++i)
+            QVERIFY2(std::abs(dest[i] - expected[i]) < 0.00001f, kernels->name);
+    }
+}
+
+void TestLooperMixer::mixMatchesLayersSum()
+{
+    QFETCH(quint32, layersMask);
+    QFETCH(uint, intervalPosition);
+    QFETCH(uint, frames);
+
+    Layers layers(4);
+    layers[0]->setSamples(createSamples(INTERVAL_LENGHT, 0.5f, 0.4f));
+    layers[1]->setSamples(createSamples(INTERVAL_LENGHT / 2, 0.3f, 0.2f)); // layer shorter than interval
+    layers[2]->setSamples(createSamples(INTERVAL_LENGHT, 0.1f, 0.7f));
+    layers[2]->setGain(0.5f);
+    layers[3]->setSamples(createSamples(1000, 0.9f, 0.8f));
+    layers[3]->setPan(0.3f);
+
+    LooperMixer mixer;
+    const float mainGain = 0.8f;
+    const auto out = mixBlock(mixer, layers, layersMask, frames, intervalPosition, mainGain);
+
+    checkOutput(layers, layersMask, out, intervalPosition, mainGain);
+}
+
+void TestLooperMixer::mixMatchesLayersSum_data()
+{
+    QTest::addColumn<quint32>("layersMask");
+    QTest::addColumn<uint>("intervalPosition");
+    QTest::addColumn<uint>("frames");
+
+    QTest::newRow("All layers") << 0xFu << 0u << 512u;
+    QTest::newRow("One layer") << 0x4u << 100u << 256u;
+    QTest::newRow("Layer ending inside the block") << 0xFu << 1900u << 300u;
+    QTest::newRow("Unaligned block") << 0xBu << 777u << 333u;
+    QTest::newRow("Beyond layers end") << 0xAu << 3000u << 128u;
+}
+
+void TestLooperMixer::gainChangesAreRamped()
+{
+    Layers layers(1);
+    layers[0]->setSamples(createConstantSamples(INTERVAL_LENGHT, 1.0f));
+
+    LooperMixer mixer;
+    const uint frames = 256;
+    auto out = mixBlock(mixer, layers, 0x1, frames, 0);
+    QCOMPARE(out.get(0, frames - 1), 1.0f);
+
+    layers[0]->setGain(0.0f);
+    out = mixBlock(mixer, layers, 0x1, frames, frames);
+
+    // the gain is ramped from 1 to 0 along the block, no discontinuities
+    QVERIFY(out.get(0, 0) > 0.99f);
+    QVERIFY(out.get(0, frames - 1) < 0.01f);
+    for (uint s = 1; s < frames; ++s)
+        QVERIFY(out.get(0, s - 1) - out.get(0, s) < 2.0f / frames);
+
+    out = mixBlock(mixer, layers, 0x1, frames, frames * 2);
+    QCOMPARE(out.get(0, 0), 0.0f); // ramp finished
+}
+
+void TestLooperMixer::mutedLayersAreFadedOut()
+{
+    Layers layers(1);
+    layers[0]->setSamples(createConstantSamples(INTERVAL_LENGHT, 1.0f));
+
+    LooperMixer mixer;
+    mixBlock(mixer, layers, 0x1, 128, 0);
+
+    layers[0]->setMuteState(LooperLayer::Muted);
+    auto out = mixBlock(mixer, layers, 0x1, 128, 128);
+    QVERIFY(out.get(0, 0) > 0.99f); // fading out, not cutting
+    QVERIFY(out.get(0, 127) < 0.01f);
+
+    out = mixBlock(mixer, layers, 0x1, 128, 256);
+    QCOMPARE(out.get(0, 0), 0.0f);
+}
+
+void TestLooperMixer::lockedLayersSubmixIsReused()
+{
+    Layers layers(4);
+    for (int l = 0; l < 4; ++l) {
+        layers[l]->setSamples(createSamples(INTERVAL_LENGHT, 0.1f * (l + 1), 0.2f));
+        layers[l]->setLocked(l < 3); // 3 locked layers, 1 unlocked
+    }
+
+    LooperMixer mixer;
+    mixer.setSubmixLenght(INTERVAL_LENGHT);
+    mixer.prepareForNewCycle(INTERVAL_LENGHT);
+
+    const uint frames = 500;
+    for (uint position = 0; position + frames <= INTERVAL_LENGHT; position += frames) // first interval, computing the submix
+        checkOutput(layers, 0xF, mixBlock(mixer, layers, 0xF, frames, position), position, 1.0f);
+
+    const uint tiles = (INTERVAL_LENGHT + LooperMixer::TILE_SIZE - 1) / LooperMixer::TILE_SIZE;
+    QCOMPARE(mixer.getSubmixTilesComputed(), tiles);
+
+    for (uint position = 0; position + frames <= INTERVAL_LENGHT; position += frames) { // second interval, reusing the submix
+        checkOutput(layers, 0xF, mixBlock(mixer, layers, 0xF, frames, position), position, 1.0f);
+        checkOutput(layers, 0x7, mixBlock(mixer, layers, 0x7, frames, position), position, 1.0f); // locked layers only
+    }
+
+    QCOMPARE(mixer.getSubmixTilesComputed(), tiles);
+    QCOMPARE(mixer.getSubmixHits(), 3 * INTERVAL_LENGHT / frames);
+
+    // some locked layers are not mixed, the submix can't be used
+    checkOutput(layers, 0x3, mixBlock(mixer, layers, 0x3, frames, 0), 0, 1.0f);
+    QCOMPARE(mixer.getSubmixHits(), 3 * INTERVAL_LENGHT / frames);
+}
+
+void TestLooperMixer::lockedLayersSubmixIsInvalidatedWhenLockedLayerChanges()
+{
+    Layers layers(2);
+    for (int l = 0; l < 2; ++l) {
+        layers[l]->setSamples(createSamples(INTERVAL_LENGHT, 0.3f, 0.5f * (l + 1)));
+        layers[l]->setLocked(true);
+    }
+
+    LooperMixer mixer;
+    mixer.setSubmixLenght(INTERVAL_LENGHT);
+    mixer.prepareForNewCycle(INTERVAL_LENGHT);
+
+    const uint frames = LooperMixer::TILE_SIZE;
+    mixBlock(mixer, layers, 0x3, frames, 0);
+    mixBlock(mixer, layers, 0x3, frames, 0);
+    QCOMPARE(mixer.getSubmixTilesComputed(), 1u);
+
+    // new content in a locked layer
+    layers[1]->setSamples(createSamples(INTERVAL_LENGHT, 0.7f, 0.1f));
+    checkOutput(layers, 0x3, mixBlock(mixer, layers, 0x3, frames, 0), 0, 1.0f);
+    QCOMPARE(mixer.getSubmixTilesComputed(), 2u);
+
+    // pan change, the changed layer is ramped in one block (without submix) and the submix is computed again in the next block
+    layers[0]->setPan(0.5f);
+    mixBlock(mixer, layers, 0x3, frames, 0);
+    QCOMPARE(mixer.getSubmixTilesComputed(), 2u);
+    checkOutput(layers, 0x3, mixBlock(mixer, layers, 0x3, frames, 0), 0, 1.0f);
+    QCOMPARE(mixer.getSubmixTilesComputed(), 3u);
+
+    // unlocking a layer
+    layers[1]->setLocked(false);
+    checkOutput(layers, 0x3, mixBlock(mixer, layers, 0x3, frames, 0), 0, 1.0f);
+    QCOMPARE(mixer.getSubmixTilesComputed(), 3u); // one locked layer, no submix
+}
+
+void TestLooperMixer::lockedLayersSubmixIsUsedOnlyWhenAllocated()
+{
+    Layers layers(2);
+    for (int l = 0; l < 2; ++l) {
+        layers[l]->setSamples(createSamples(INTERVAL_LENGHT, 0.3f, 0.5f * (l + 1)));
+        layers[l]->setLocked(true);
+    }
+
+    const uint frames = LooperMixer::TILE_SIZE;
+
+    LooperMixer mixer;
+    mixer.prepareForNewCycle(INTERVAL_LENGHT);
+    checkOutput(layers, 0x3, mixBlock(mixer, layers, 0x3, frames, 0), 0, 1.0f); // not allocated, the locked layers are mixed directly
+    QCOMPARE(mixer.getSubmixHits(), 0u);
+
+    mixer.setSubmixLenght(INTERVAL_LENGHT / 2); // allocated for other interval lenght
+    checkOutput(layers, 0x3, mixBlock(mixer, layers, 0x3, frames, 0), 0, 1.0f);
+    QCOMPARE(mixer.getSubmixHits(), 0u);
+
+    mixer.setSubmixLenght(INTERVAL_LENGHT);
+    checkOutput(layers, 0x3, mixBlock(mixer, layers, 0x3, frames, 0), 0, 1.0f);
+    QCOMPARE(mixer.getSubmixHits(), 1u);
+
+    mixer.setSubmixLenght(0); // no locked layers, the submix is released
+    checkOutput(layers, 0x3, mixBlock(mixer, layers, 0x3, frames, 0), 0, 1.0f);
+    QCOMPARE(mixer.getSubmixHits(), 1u);
+}
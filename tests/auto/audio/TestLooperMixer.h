@@ -0,0 +1,21 @@
+#ifndef TESTLOOPERMIXER_H
+#define TESTLOOPERMIXER_H
+
+#include <QObject>
+
+class TestLooperMixer: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void mixKernelsMatchScalar();
+    void mixMatchesLayersSum();
+    void mixMatchesLayersSum_data();
+    void gainChangesAreRamped();
+    void mutedLayersAreFadedOut();
+    void lockedLayersSubmixIsReused();
+    void lockedLayersSubmixIsInvalidatedWhenLockedLayerChanges();
+    void lockedLayersSubmixIsUsedOnlyWhenAllocated(); // the submix is allocated out of audio thread
+};
+
+#endif // TESTLOOPERMIXER_H
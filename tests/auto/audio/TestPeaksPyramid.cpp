@@ -0,0 +1,180 @@
+#include "TestPeaksPyramid.h"
+
+#include <QTest>
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+
+#include "looper/PeaksPyramid.h"
+
+using audio::PeaksPyramid;
+
+namespace {
+
+std::vector<float> createNoise(uint samples, uint seed)
+{
+    std::srand(seed);
+    std::vector<float> noise(samples);
+    for (auto &sample : noise)
+        sample = (std::rand() / static_cast<float>(RAND_MAX)) * 2.0f - 1.0f;
+
+    return noise;
+}
+
+std::vector<float> computeMaxPeaks(const std::vector<float> &left, const std::vector<float> &right, uint availableSamples, uint samplesPerPeak)
+{
+    std::vector<float> peaks;
+    for (uint from = 0; from < availableSamples; from += samplesPerPeak) {
+        float maxPeak = 0;
+        for (uint s = from; s < qMin(from + samplesPerPeak, availableSamples); ++s)
+            maxPeak = qMax(maxPeak, qMax(qAbs(left[s]), qAbs(right[s])));
+
+        peaks.push_back(maxPeak);
+    }
+
+    return peaks;
+}
+
+void comparePeaks(const std::vector<float> &peaks, const std::vector<float> &expected)
+{
+    QCOMPARE(peaks.size(), expected.size());
+    for (size_t i = 0; i < peaks.size(); ++i)
+        QCOMPARE(peaks[i], expected[i]);
+}
+
+} // namespace
+
+void TestPeaksPyramid::peaksMatchBruteForce()
+{
+    QFETCH(uint, samples);
+    QFETCH(uint, samplesPerPeak);
+
+    const auto left = createNoise(samples, 1);
+    const auto right = createNoise(samples, 2);
+
+    PeaksPyramid pyramid;
+    pyramid.resize(samples);
+    pyramid.update(left.data(), right.data(), 0, samples);
+
+    comparePeaks(pyramid.getMaxPeaks(left.data(), right.data(), samples, samplesPerPeak),
+                 computeMaxPeaks(left, right, samples, samplesPerPeak));
+
+    // available samples smaller than the pyramid size (recording)
+    const uint availableSamples = samples * 2 / 3;
+    comparePeaks(pyramid.getMaxPeaks(left.data(), right.data(), availableSamples, samplesPerPeak),
+                 computeMaxPeaks(left, right, availableSamples, samplesPerPeak));
+}
+
+void TestPeaksPyramid::peaksMatchBruteForce_data()
+{
+    QTest::addColumn<uint>("samples");
+    QTest::addColumn<uint>("samplesPerPeak");
+
+    QTest::newRow("Aligned peaks") << 44100u << 256u;
+    QTest::newRow("Unaligned peaks") << 44100u << 333u;
+    QTest::newRow("Small peaks") << 1000u << 7u;
+    QTest::newRow("One peak") << 10000u << 10000u;
+    QTest::newRow("Peaks bigger than samples") << 100u << 1024u;
+    QTest::newRow("Odd size") << 12345u << 1001u;
+}
+
+void TestPeaksPyramid::incrementalUpdatesMatchFullRebuild()
+{
+    const uint samples = 48000;
+    const auto left = createNoise(samples, 3);
+    const auto right = createNoise(samples, 4);
+
+    PeaksPyramid incremental;
+    incremental.resize(samples);
+    const uint chunks[] = {128, 256, 100, 512, 37}; // audio callback sizes
+    uint position = 0;
+    int chunk = 0;
+    while (position < samples) {
+        const uint chunkSize = qMin(chunks[chunk++ % 5], samples - position);
+        incremental.update(left.data(), right.data(), position, chunkSize);
+        position += chunkSize;
+    }
+
+    PeaksPyramid full;
+    full.resize(samples);
+    full.update(left.data(), right.data(), 0, samples);
+
+    for (uint samplesPerPeak : {64u, 300u, 4096u}) {
+        comparePeaks(incremental.getMaxPeaks(left.data(), right.data(), samples, samplesPerPeak),
+                     full.getMaxPeaks(left.data(), right.data(), samples, samplesPerPeak));
+    }
+}
+
+void TestPeaksPyramid::overdubUpdatesOnlyChangedBlocks()
+{
+    const uint samples = 20000;
+    auto left = createNoise(samples, 5);
+    auto right = createNoise(samples, 6);
+    for (uint s = 0; s < samples; ++s) { // quiet layer
+        left[s] *= 0.1f;
+        right[s] *= 0.1f;
+    }
+
+    PeaksPyramid pyramid;
+    pyramid.resize(samples);
+    pyramid.update(left.data(), right.data(), 0, samples);
+
+    // overdubbing a loud sound in the left channel only (mono input)
+    const uint overdubStart = 5000;
+    const uint overdubSamples = 700;
+    for (uint s = overdubStart; s < overdubStart + overdubSamples; ++s)
+        left[s] += 0.8f;
+
+    pyramid.update(left.data(), right.data(), overdubStart, overdubSamples);
+
+    comparePeaks(pyramid.getMaxPeaks(left.data(), right.data(), samples, 512),
+                 computeMaxPeaks(left, right, samples, 512));
+
+    QVERIFY(pyramid.getPeak(left.data(), right.data(), overdubStart, overdubSamples).getMaxAbsolute() > 0.7f);
+    QVERIFY(pyramid.getPeak(left.data(), right.data(), 10000, 10000).getMaxAbsolute() <= 0.1f);
+}
+
+void TestPeaksPyramid::resizeKeepsExistingPeaks()
+{
+    const uint samples = 30000;
+    const auto left = createNoise(samples, 7);
+    const auto right = createNoise(samples, 8);
+
+    const uint initialSize = 10000;
+    PeaksPyramid pyramid;
+    pyramid.resize(initialSize);
+    pyramid.update(left.data(), right.data(), 0, initialSize);
+    const int initialLevels = pyramid.getLevels();
+
+    pyramid.resize(samples);
+    pyramid.update(left.data(), right.data(), initialSize, samples - initialSize); // only the new samples
+
+    QVERIFY(pyramid.getLevels() > initialLevels);
+    QCOMPARE(pyramid.getSize(), samples);
+
+    comparePeaks(pyramid.getMaxPeaks(left.data(), right.data(), samples, 1000),
+                 computeMaxPeaks(left, right, samples, 1000));
+}
+
+void TestPeaksPyramid::rms()
+{
+    const uint samples = 4096;
+    std::vector<float> left(samples);
+    std::vector<float> right(samples);
+    for (uint s = 0; s < samples; ++s) { // square wave, rms = amplitude
+        left[s] = (s % 2) ? 0.5f : -0.5f;
+        right[s] = -left[s];
+    }
+
+    PeaksPyramid pyramid;
+    pyramid.resize(samples);
+    pyramid.update(left.data(), right.data(), 0, samples);
+
+    const auto peak = pyramid.getPeak(left.data(), right.data(), 10, 3000); // unaligned range
+    QCOMPARE(peak.min, -0.5f);
+    QCOMPARE(peak.max, 0.5f);
+    QVERIFY(std::abs(peak.rms - 0.5f) < 0.0001f);
+
+    pyramid.clear();
+    QCOMPARE(pyramid.getPeak(left.data(), right.data(), 0, 1024).rms, 0.0f);
+}
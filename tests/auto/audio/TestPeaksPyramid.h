@@ -0,0 +1,19 @@
+#ifndef TESTPEAKSPYRAMID_H
+#define TESTPEAKSPYRAMID_H
+
+#include <QObject>
+
+class TestPeaksPyramid: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void peaksMatchBruteForce();
+    void peaksMatchBruteForce_data();
+    void incrementalUpdatesMatchFullRebuild();
+    void overdubUpdatesOnlyChangedBlocks();
+    void resizeKeepsExistingPeaks();
+    void rms();
+};
+
+#endif // TESTPEAKSPYRAMID_H
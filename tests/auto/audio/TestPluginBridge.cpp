@@ -0,0 +1,235 @@
+#include "TestPluginBridge.h"
+
+#include <QTest>
+#include <QCoreApplication>
+#include <QDataStream>
+#include <QElapsedTimer>
+#include <thread>
+#include <vector>
+
+#include "audio/bridge/PluginBridgeHost.h"
+#include "audio/bridge/PluginBridgeChild.h"
+#include "audio/bridge/BridgeTestProcessor.h"
+
+using audio::PluginBridgeHost;
+using audio::PluginBridgeChild;
+using audio::BridgeTestProcessor;
+using audio::bridge::Command;
+
+namespace {
+
+const int FRAMES = 256;
+const qint64 DEADLINE = 5000000; // ns, generous to avoid false positives in busy CI machines
+
+QString createKey()
+{
+    static int bridges = 0;
+    return QString("jtbt%1_%2").arg(QCoreApplication::applicationPid()).arg(bridges++);
+}
+
+class Bridge // host and child (running in a thread) connected in the same shared memory
+{
+public:
+    explicit Bridge(int channels)
+    {
+        const QString key = createKey();
+        created = host.create(key, channels, FRAMES) && child.attach(key);
+        if (!created)
+            return;
+
+        child.setReady(processor.getFlags());
+        childThread = std::thread([this]() {
+            child.run(&processor, nullptr);
+        });
+        created = host.waitChildReady(1000);
+    }
+
+    ~Bridge()
+    {
+        host.destroy(); // Quit
+        if (childThread.joinable())
+            childThread.join();
+    }
+
+    bool process(const std::vector<std::vector<float>> &inputs, std::vector<std::vector<float>> &outputs,
+                 const std::vector<midi::MidiMessage> &midiMessages = std::vector<midi::MidiMessage>(), qint64 deadline = DEADLINE)
+    {
+        std::vector<const float *> inputsArray;
+        std::vector<float *> outputsArray;
+        for (const auto &input : inputs)
+            inputsArray.push_back(input.data());
+        for (auto &output : outputs)
+            outputsArray.push_back(output.data());
+
+        return host.process(inputsArray.data(), outputsArray.data(), static_cast<int>(outputs.size()), FRAMES, midiMessages, deadline);
+    }
+
+    bool created;
+    PluginBridgeHost host;
+    PluginBridgeChild child;
+    BridgeTestProcessor processor;
+    std::thread childThread;
+};
+
+std::vector<std::vector<float>> createBuffer(int channels, float value = 0.0f)
+{
+    return std::vector<std::vector<float>>(static_cast<size_t>(channels), std::vector<float>(FRAMES, value));
+}
+
+qint32 getReceivedMidiEvents(PluginBridgeHost &host)
+{
+    QByteArray state;
+    if (!host.sendCommand(Command::GetState, 0, QByteArray(), &state))
+        return -1;
+
+    QDataStream stream(state);
+    float gain;
+    qint32 midiEvents;
+    stream >> gain >> midiEvents;
+    return midiEvents;
+}
+
+} // namespace
+
+void TestPluginBridge::processedBlockIsReturned()
+{
+    Bridge bridge(2);
+    QVERIFY(bridge.created);
+    bridge.processor.setGain(0.5f);
+
+    auto inputs = createBuffer(2);
+    auto outputs = createBuffer(2);
+    for (int block = 0; block < 100; ++block) {
+        for (int i = 0; i < FRAMES; ++i) {
+            inputs[0][i] = block + i;
+            inputs[1][i] = -(block + i);
+        }
+
+        QVERIFY(bridge.process(inputs, outputs));
+        for (int i = 0; i < FRAMES; ++i) {
+            QCOMPARE(outputs[0][i], (block + i) * 0.5f);
+            QCOMPARE(outputs[1][i], -(block + i) * 0.5f);
+        }
+    }
+
+    QCOMPARE(bridge.host.getLateBlocks(), quint64(0));
+}
+
+void TestPluginBridge::monoInputIsCopiedInAllChannels()
+{
+    Bridge bridge(2);
+    QVERIFY(bridge.created);
+
+    auto outputs = createBuffer(2);
+    QVERIFY(bridge.process(createBuffer(1, 0.25f), outputs));
+    QCOMPARE(outputs[0][FRAMES - 1], 0.25f);
+    QCOMPARE(outputs[1][FRAMES - 1], 0.25f);
+}
+
+void TestPluginBridge::midiMessagesAreDelivered()
+{
+    Bridge bridge(1);
+    QVERIFY(bridge.created);
+
+    std::vector<midi::MidiMessage> midiMessages;
+    midiMessages.push_back(midi::MidiMessage(0x90 | (60 << 8) | (100 << 16), 0)); // note on
+    midiMessages.push_back(midi::MidiMessage(0x80 | (60 << 8), 0)); // note off
+
+    auto outputs = createBuffer(1);
+    QVERIFY(bridge.process(createBuffer(1), outputs, midiMessages));
+    QVERIFY(bridge.process(createBuffer(1), outputs, midiMessages));
+
+    QCOMPARE(getReceivedMidiEvents(bridge.host), 4);
+}
+
+void TestPluginBridge::lateBlockIsSilenceAndNextBlocksAreProcessed()
+{
+    Bridge bridge(1);
+    QVERIFY(bridge.created);
+
+    const auto inputs = createBuffer(1, 1.0f);
+    auto outputs = createBuffer(1);
+
+    bridge.processor.stall(100);
+    QElapsedTimer timer;
+    timer.start();
+    QVERIFY(!bridge.process(inputs, outputs, std::vector<midi::MidiMessage>(), 1000000));
+    QVERIFY(timer.elapsed() < 50); // the deadline is respected, the host is not waiting the stalled child
+    QCOMPARE(outputs[0][0], 0.0f);
+    QCOMPARE(bridge.host.getLateBlocks(), quint64(1));
+
+    QTest::qWait(150); // the late block is processed and discarded
+
+    QVERIFY(bridge.process(inputs, outputs));
+    QCOMPARE(outputs[0][0], 1.0f);
+}
+
+void TestPluginBridge::stalledChildDropsBlocks()
+{
+    Bridge bridge(1);
+    QVERIFY(bridge.created);
+
+    const auto inputs = createBuffer(1, 1.0f);
+    auto outputs = createBuffer(1);
+
+    bridge.processor.stall(200);
+    for (int block = 0; block < audio::bridge::SLOTS * 2; ++block)
+        QVERIFY(!bridge.process(inputs, outputs, std::vector<midi::MidiMessage>(), 100000));
+
+    QCOMPARE(bridge.host.getLateBlocks(), quint64(audio::bridge::SLOTS));
+    QCOMPARE(bridge.host.getDroppedBlocks(), quint64(audio::bridge::SLOTS));
+
+    QTest::qWait(250);
+
+    QVERIFY(bridge.process(inputs, outputs));
+    QCOMPARE(outputs[0][0], 1.0f);
+}
+
+void TestPluginBridge::commandsAreExecutedByChild()
+{
+    Bridge bridge(1);
+    QVERIFY(bridge.created);
+
+    QVERIFY(bridge.host.sendCommand(Command::SetSampleRate, 48000));
+    QCOMPARE(bridge.processor.getSampleRate(), 48000);
+
+    // restoring the gain
+    QByteArray state;
+    QDataStream stream(&state, QIODevice::WriteOnly);
+    stream << 0.25f << qint32(0);
+    QVERIFY(bridge.host.sendCommand(Command::SetState, 0, state));
+
+    const auto inputs = createBuffer(1, 1.0f);
+    auto outputs = createBuffer(1);
+    QVERIFY(bridge.process(inputs, outputs));
+    QCOMPARE(outputs[0][0], 0.25f);
+
+    QVERIFY(bridge.host.sendCommand(Command::SetBypass, 1));
+    QVERIFY(bridge.process(inputs, outputs));
+    QCOMPARE(outputs[0][0], 1.0f);
+
+    QVERIFY(bridge.host.sendCommand(Command::SetBypass, 0));
+    QVERIFY(bridge.host.sendCommand(Command::Suspend));
+    QVERIFY(bridge.process(inputs, outputs));
+    QCOMPARE(outputs[0][0], 0.0f);
+
+    QVERIFY(bridge.host.sendCommand(Command::Resume));
+    QVERIFY(bridge.process(inputs, outputs));
+    QCOMPARE(outputs[0][0], 0.25f);
+}
+
+void TestPluginBridge::processIsSilenceWithoutChild()
+{
+    PluginBridgeHost host;
+    QVERIFY(host.create(createKey(), 1, FRAMES));
+
+    std::vector<float> input(FRAMES, 1.0f);
+    std::vector<float> output(FRAMES, 1.0f);
+    const float *inputs[] = {input.data()};
+    float *outputs[] = {output.data()};
+
+    QVERIFY(!host.waitChildReady(10));
+    QVERIFY(!host.process(inputs, outputs, 1, FRAMES, std::vector<midi::MidiMessage>(), DEADLINE));
+    QCOMPARE(output[0], 0.0f);
+    QVERIFY(!host.sendCommand(Command::Resume));
+}
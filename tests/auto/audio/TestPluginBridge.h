@@ -0,0 +1,20 @@
+#ifndef TESTPLUGINBRIDGE_H
+#define TESTPLUGINBRIDGE_H
+
+#include <QObject>
+
+class TestPluginBridge: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void processedBlockIsReturned(); // the child is running in a thread, using the BridgeTestProcessor
+    void monoInputIsCopiedInAllChannels();
+    void midiMessagesAreDelivered();
+    void lateBlockIsSilenceAndNextBlocksAreProcessed();
+    void stalledChildDropsBlocks();
+    void commandsAreExecutedByChild();
+    void processIsSilenceWithoutChild();
+};
+
+#endif // TESTPLUGINBRIDGE_H
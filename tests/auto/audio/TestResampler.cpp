@@ -0,0 +1,225 @@
+#include "TestResampler.h"
+
+#include <QTest>
+#include <vector>
+#include <cmath>
+
+#include "audio/Resampler.h"
+#include "audio/SamplesBufferResampler.h"
+
+Q_DECLARE_METATYPE(ResamplerQuality)
+
+using audio::SamplesBuffer;
+
+namespace {
+
+const double PI = 3.14159265358979323846;
+const int BLOCK_SIZE = 256;
+const int EDGE_FRAMES = 200; // ignored in THD+N measurement
+
+std::vector<float> createSine(double frequency, int sampleRate, int frames)
+{
+    std::vector<float> samples(frames);
+    for (int i = 0; i < frames; ++i)
+        samples[i] = static_cast<float>(0.5 * std::sin(2.0 * PI * frequency * i / sampleRate));
+
+    return samples;
+}
+
+// resample in blocks, as the audio nodes are doing in audio callbacks
+std::vector<float> resample(Resampler &resampler, const std::vector<float> &input, int blockSize)
+{
+    std::vector<float> output;
+    std::vector<float> block(blockSize);
+    size_t position = 0;
+    forever {
+        const int requiredFrames = resampler.getRequiredInputFrames(blockSize);
+        if (position + requiredFrames > input.size())
+            break;
+
+        const int producedFrames = resampler.process(&input[position], requiredFrames, block.data(), blockSize);
+        if (producedFrames != blockSize)
+            return std::vector<float>(); // failure
+
+        position += requiredFrames;
+        output.insert(output.end(), block.begin(), block.end());
+    }
+
+    return output;
+}
+
+// the best fit sine wave is computed (least squares), everything else is distortion or noise
+double computeThdPlusNoise(const std::vector<float> &samples, double frequency, int sampleRate)
+{
+    double ss = 0, cc = 0, sc = 0, ys = 0, yc = 0;
+    for (size_t i = EDGE_FRAMES; i < samples.size() - EDGE_FRAMES; ++i) {
+        const double s = std::sin(2.0 * PI * frequency * i / sampleRate);
+        const double c = std::cos(2.0 * PI * frequency * i / sampleRate);
+        ss += s * s;
+        cc += c * c;
+        sc += s * c;
+        ys += samples[i] * s;
+        yc += samples[i] * c;
+    }
+
+    const double det = ss * cc - sc * sc;
+    const double a = (ys * cc - yc * sc) / det;
+    const double b = (yc * ss - ys * sc) / det;
+
+    double noise = 0, signal = 0;
+    for (size_t i = EDGE_FRAMES; i < samples.size() - EDGE_FRAMES; ++i) {
+        const double fit = a * std::sin(2.0 * PI * frequency * i / sampleRate) + b * std::cos(2.0 * PI * frequency * i / sampleRate);
+        noise += (samples[i] - fit) * (samples[i] - fit);
+        signal += fit * fit;
+    }
+
+    return 10.0 * std::log10(noise / signal);
+}
+
+} // namespace
+
+void TestResampler::distortionPlusNoise()
+{
+    QFETCH(ResamplerQuality, quality);
+    QFETCH(int, sourceSampleRate);
+    QFETCH(int, targetSampleRate);
+    QFETCH(double, frequency);
+    QFETCH(double, maxThdPlusNoise);
+
+    Resampler resampler(sourceSampleRate, targetSampleRate, quality);
+    const auto output = resample(resampler, createSine(frequency, sourceSampleRate, sourceSampleRate), BLOCK_SIZE);
+
+    QVERIFY(output.size() > static_cast<size_t>(targetSampleRate - BLOCK_SIZE * 2));
+
+    const double thdPlusNoise = computeThdPlusNoise(output, frequency, targetSampleRate);
+    QVERIFY2(thdPlusNoise < maxThdPlusNoise, qPrintable(QString("THD+N = %1 dB").arg(thdPlusNoise)));
+}
+
+void TestResampler::distortionPlusNoise_data()
+{
+    QTest::addColumn<ResamplerQuality>("quality");
+    QTest::addColumn<int>("sourceSampleRate");
+    QTest::addColumn<int>("targetSampleRate");
+    QTest::addColumn<double>("frequency");
+    QTest::addColumn<double>("maxThdPlusNoise");
+
+    const QList<QPair<int, int>> ratios = {{44100, 48000}, {48000, 44100}, {44100, 96000}, {96000, 48000}};
+    for (const auto &ratio : ratios) {
+        for (double frequency : {1000.0, 10000.0}) {
+            const QString name = QString("%1 -> %2 - %3 Hz").arg(ratio.first).arg(ratio.second).arg(frequency);
+            QTest::newRow(qPrintable("fast " + name)) << ResamplerQuality::Fast << ratio.first << ratio.second << frequency << -65.0;
+            QTest::newRow(qPrintable("medium " + name)) << ResamplerQuality::Medium << ratio.first << ratio.second << frequency << -85.0;
+            QTest::newRow(qPrintable("best " + name)) << ResamplerQuality::Best << ratio.first << ratio.second << frequency << -105.0;
+        }
+    }
+}
+
+void TestResampler::sameSampleRateIsIdentity()
+{
+    const auto input = createSine(1000, 48000, 4800);
+
+    Resampler resampler(48000, 48000, ResamplerQuality::Best);
+    const auto output = resample(resampler, input, BLOCK_SIZE);
+
+    QVERIFY(!output.empty());
+    for (size_t i = 0; i < output.size(); ++i)
+        QVERIFY(std::abs(output[i] - input[i]) < 1e-6f); // no delay
+}
+
+void TestResampler::outputIsIndependentOfBlockSize()
+{
+    const auto input = createSine(1000, 44100, 44100);
+
+    Resampler resampler1(44100, 48000);
+    Resampler resampler2(44100, 48000);
+    const auto output1 = resample(resampler1, input, 4800);
+    const auto output2 = resample(resampler2, input, 37);
+
+    const size_t frames = qMin(output1.size(), output2.size());
+    QVERIFY(frames > 40000);
+    for (size_t i = 0; i < frames; ++i)
+        QCOMPARE(output1[i], output2[i]);
+}
+
+void TestResampler::requiredInputFramesFollowTheRatio()
+{
+    const int callbacks = 10000;
+    std::vector<float> input(BLOCK_SIZE * 2, 0.0f);
+    std::vector<float> output(BLOCK_SIZE);
+
+    Resampler resampler(44100, 48000, ResamplerQuality::Fast);
+
+    qint64 consumedFrames = 0;
+    for (int i = 0; i < callbacks; ++i) {
+        const int requiredFrames = resampler.getRequiredInputFrames(BLOCK_SIZE);
+        QCOMPARE(resampler.process(input.data(), requiredFrames, output.data(), BLOCK_SIZE), BLOCK_SIZE);
+        consumedFrames += requiredFrames;
+    }
+
+    const qint64 expectedFrames = static_cast<qint64>(callbacks) * BLOCK_SIZE * 44100 / 48000;
+    const qint64 filterLookAhead = consumedFrames - expectedFrames;
+    QVERIFY(filterLookAhead >= 0);
+    QVERIFY(filterLookAhead <= 64);
+}
+
+void TestResampler::shortInputProducesLessFrames()
+{
+    std::vector<float> input(BLOCK_SIZE, 0.0f);
+    std::vector<float> output(BLOCK_SIZE);
+
+    Resampler resampler(44100, 48000);
+    const int producedFrames = resampler.process(input.data(), 64, output.data(), BLOCK_SIZE); // less than required frames
+
+    QVERIFY(producedFrames > 0);
+    QVERIFY(producedFrames < BLOCK_SIZE);
+
+    QVERIFY(resampler.getRequiredInputFrames(BLOCK_SIZE - producedFrames) > 0); // the remaining frames are produced in the next call
+}
+
+void TestResampler::strongDownsamplingUsesReservedHistory()
+{
+    Resampler resampler(44100, 48000);
+    resampler.setSampleRates(192000, 8000); // 24x, the filter is limited to the reserved history
+
+    const auto output = resample(resampler, createSine(500, 192000, 192000), BLOCK_SIZE);
+
+    QVERIFY(output.size() > static_cast<size_t>(8000 - BLOCK_SIZE * 2));
+    QVERIFY(computeThdPlusNoise(output, 500, 8000) < -85.0);
+}
+
+void TestResampler::resampleCompleteBuffer()
+{
+    const auto sine = createSine(1000, 44100, 44100);
+
+    SamplesBuffer in(1, 44100);
+    for (int i = 0; i < 44100; ++i)
+        in.set(0, i, sine[i]);
+
+    SamplesBuffer out(2);
+    SamplesBufferResampler::resample(in, out, 44100, 48000);
+
+    QVERIFY(out.isMono());
+    QCOMPARE(out.getFrameLenght(), 48000u);
+
+    std::vector<float> output(out.getSamplesArray(0), out.getSamplesArray(0) + out.getFrameLenght());
+    QVERIFY(computeThdPlusNoise(output, 1000, 48000) < -105.0);
+}
+
+void TestResampler::tablesArePreparedOutsideAudioThread()
+{
+    const int sourceSampleRate = 37800; // unusual ratio, not precomputed
+    const int targetSampleRate = 48000;
+
+    Resampler resampler(44100, 48000, ResamplerQuality::Fast);
+    QVERIFY(!Resampler::hasTables(sourceSampleRate, targetSampleRate, ResamplerQuality::Fast));
+    QVERIFY(!resampler.trySetSampleRates(sourceSampleRate, targetSampleRate));
+    QCOMPARE(resampler.getSourceSampleRate(), 44100); // unchanged
+
+    Resampler::prepareTables(sourceSampleRate, targetSampleRate, ResamplerQuality::Fast);
+    QVERIFY(Resampler::hasTables(sourceSampleRate, targetSampleRate, ResamplerQuality::Fast));
+    QVERIFY(resampler.trySetSampleRates(sourceSampleRate, targetSampleRate));
+    QCOMPARE(resampler.getSourceSampleRate(), sourceSampleRate);
+
+    const auto output = resample(resampler, createSine(1000, sourceSampleRate, sourceSampleRate), BLOCK_SIZE);
+    QVERIFY(!output.empty());
+}
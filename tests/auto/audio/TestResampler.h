@@ -0,0 +1,23 @@
+#ifndef TESTRESAMPLER_H
+#define TESTRESAMPLER_H
+
+#include <QObject>
+
+class TestResampler: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void distortionPlusNoise(); // THD+N of resampled sine waves
+    void distortionPlusNoise_data();
+
+    void sameSampleRateIsIdentity();
+    void outputIsIndependentOfBlockSize();
+    void requiredInputFramesFollowTheRatio(); // no drift in long sessions
+    void shortInputProducesLessFrames();
+    void strongDownsamplingUsesReservedHistory(); // more than 4x, the filter is shorter
+    void resampleCompleteBuffer();
+    void tablesArePreparedOutsideAudioThread(); // the audio thread only look up the tables
+};
+
+#endif // TESTRESAMPLER_H
@@ -2,7 +2,10 @@
 
 #include <QString>
 #include "audio/core/SamplesBuffer.h"
+#include "audio/core/SamplesKernels.h"
 #include <QTest>
+#include <vector>
+#include <cmath>
 
 using namespace audio;
 
@@ -28,6 +31,231 @@ void TestSamplesBuffer::copy_data()
 
 }
 
+void TestSamplesBuffer::view()
+{
+    QFETCH(QString, samples);
+    QFETCH(int, offset);
+    QFETCH(int, frames);
+    QFETCH(QString, expectedSamples);
+
+    auto buffer = createBuffer(samples);
+    auto view = buffer.getView(offset, frames);
+
+    SamplesBuffer copy(1, view.getFrameLenght());
+    copy.set(view);
+    checkExpectedValues(expectedSamples, copy);
+
+    QCOMPARE(view.getSamplesArray(0), buffer.getSamplesArray(0) + qMin(offset, static_cast<int>(buffer.getFrameLenght()))); // no copy
+}
+
+void TestSamplesBuffer::view_data()
+{
+    QTest::addColumn<QString>("samples");
+    QTest::addColumn<int>("offset");
+    QTest::addColumn<int>("frames");
+    QTest::addColumn<QString>("expectedSamples");
+
+    QTest::newRow("Full view") << "1,2,3" << 0 << 3 << "1,2,3";
+    QTest::newRow("Middle slice") << "1,2,3,4" << 1 << 2 << "2,3";
+    QTest::newRow("Slice is clamped") << "1,2,3" << 2 << 10 << "3";
+    QTest::newRow("Empty slice") << "1,2,3" << 3 << 1 << "";
+}
+
+void TestSamplesBuffer::reserveIsPreservingSamples()
+{
+    SamplesBuffer buffer = createBuffer("1,2,3");
+    buffer.reserve(1024);
+
+    QVERIFY(buffer.getCapacity() >= 1024);
+    QCOMPARE(buffer.getFrameLenght(), 3u);
+    checkExpectedValues("1,2,3", buffer);
+
+    float *samples = buffer.getSamplesArray(0);
+    buffer.setFrameLenght(1024);
+    QCOMPARE(buffer.getSamplesArray(0), samples); // no reallocation inside the reserved capacity
+    checkExpectedValues("1,2,3,0,0", buffer);
+}
+
+void TestSamplesBuffer::samplesAreAligned()
+{
+    SamplesBuffer buffer(4, 33);
+    for (int c = 0; c < buffer.getChannels(); ++c)
+        QCOMPARE(reinterpret_cast<quintptr>(buffer.getSamplesArray(c)) % 64, quintptr(0));
+}
+
+void TestSamplesBuffer::kernelsMatchScalarReference()
+{
+    QFETCH(int, kernelsIndex);
+    QFETCH(int, samples);
+
+    const auto &kernels = *SamplesKernels::getSupported().at(kernelsIndex);
+    const auto &scalar = SamplesKernels::getScalar();
+
+    std::vector<float> input(samples);
+    for (int i = 0; i < samples; ++i)
+        input[i] = std::sin(i * 0.1f) * (i % 3 ? 1.0f : -0.7f);
+
+    auto expected = input;
+    auto actual = input;
+
+    scalar.scale(expected.data(), samples, 0.5f);
+    kernels.scale(actual.data(), samples, 0.5f);
+    for (int i = 0; i < samples; ++i)
+        QCOMPARE(actual[i], expected[i]);
+
+    scalar.ramp(expected.data(), samples, 0.0f, 1.0f/samples);
+    kernels.ramp(actual.data(), samples, 0.0f, 1.0f/samples);
+    for (int i = 0; i < samples; ++i)
+        QVERIFY(qAbs(actual[i] - expected[i]) < 1e-5f);
+
+    actual = expected;
+    scalar.add(expected.data(), input.data(), samples);
+    kernels.add(actual.data(), input.data(), samples);
+    for (int i = 0; i < samples; ++i)
+        QCOMPARE(actual[i], expected[i]);
+
+    float expectedSum = 0;
+    float actualSum = 0;
+    QCOMPARE(kernels.peak(input.data(), samples, &actualSum), scalar.peak(input.data(), samples, &expectedSum));
+    QVERIFY(qAbs(actualSum - expectedSum) <= expectedSum * 1e-5f);
+
+    expectedSum = actualSum = 0;
+    actual = expected = input;
+    QCOMPARE(kernels.scaleAndPeak(actual.data(), samples, 2.0f, &actualSum), scalar.scaleAndPeak(expected.data(), samples, 2.0f, &expectedSum));
+    QVERIFY(qAbs(actualSum - expectedSum) <= expectedSum * 1e-5f);
+    for (int i = 0; i < samples; ++i)
+        QCOMPARE(actual[i], expected[i]);
+
+    const float expectedDot = scalar.dotProduct(input.data(), expected.data(), samples); // summing order is different in SIMD
+    QVERIFY(qAbs(kernels.dotProduct(input.data(), expected.data(), samples) - expectedDot) <= 1e-4f * (1.0f + qAbs(expectedDot)));
+}
+
+void TestSamplesBuffer::kernelsMatchScalarReference_data()
+{
+    QTest::addColumn<int>("kernelsIndex");
+    QTest::addColumn<int>("samples");
+
+    const auto supported = SamplesKernels::getSupported();
+    for (uint k = 0; k < supported.size(); ++k) {
+        for (int samples : {0, 1, 7, 32, 253}) { // check the tail processing too
+            auto rowName = QString("%1 - %2 samples").arg(supported[k]->name).arg(samples);
+            QTest::newRow(qPrintable(rowName)) << static_cast<int>(k) << samples;
+        }
+    }
+}
+
+void TestSamplesBuffer::conversionKernelsMatchScalarReference()
+{
+    QFETCH(int, kernelsIndex);
+    QFETCH(int, channels);
+    QFETCH(int, frames);
+
+    const auto &kernels = *SamplesKernels::getSupported().at(kernelsIndex);
+    const auto &scalar = SamplesKernels::getScalar();
+
+    const int samples = channels * frames;
+    std::vector<qint16> input16(samples);
+    std::vector<qint32> input32(samples);
+    std::vector<float> inputFloat(samples);
+    for (int i = 0; i < samples; ++i) {
+        input16[i] = static_cast<qint16>(i % 2 ? -32768 + i * 7 : 32767 - i * 5); // the limits are included
+        input32[i] = static_cast<qint32>(input16[i]) * 65536 + i;
+        inputFloat[i] = std::sin(i * 0.1f);
+    }
+
+    const int outputsCount = qMin(channels, 2);
+    std::vector<std::vector<float>> expected(outputsCount, std::vector<float>(frames));
+    std::vector<std::vector<float>> actual(outputsCount, std::vector<float>(frames));
+    float *expectedOutputs[2];
+    float *actualOutputs[2];
+    for (int c = 0; c < outputsCount; ++c) {
+        expectedOutputs[c] = expected[c].data();
+        actualOutputs[c] = actual[c].data();
+    }
+
+    scalar.int16ToFloat(input16.data(), channels, expectedOutputs, outputsCount, frames);
+    kernels.int16ToFloat(input16.data(), channels, actualOutputs, outputsCount, frames);
+    QCOMPARE(actual, expected);
+    if (frames > 0)
+        QCOMPARE(actual[0][0], 32767.0f / 32768.0f);
+
+    scalar.int32ToFloat(input32.data(), channels, expectedOutputs, outputsCount, frames);
+    kernels.int32ToFloat(input32.data(), channels, actualOutputs, outputsCount, frames);
+    QCOMPARE(actual, expected);
+
+    scalar.deinterleave(inputFloat.data(), channels, expectedOutputs, outputsCount, frames);
+    kernels.deinterleave(inputFloat.data(), channels, actualOutputs, outputsCount, frames);
+    QCOMPARE(actual, expected);
+
+    // planar float to interleaved samples (writing wave files), including samples to be clipped
+    std::vector<std::vector<float>> planar(channels, std::vector<float>(frames));
+    std::vector<const float *> inputs(channels);
+    for (int c = 0; c < channels; ++c) {
+        for (int s = 0; s < frames; ++s)
+            planar[c][s] = std::sin((s * channels + c) * 0.1f) * 1.2f;
+        inputs[c] = planar[c].data();
+    }
+
+    std::vector<qint32> expectedInterleaved(samples);
+    std::vector<qint32> actualInterleaved(samples);
+
+    scalar.floatToInt32(inputs.data(), channels, expectedInterleaved.data(), frames);
+    kernels.floatToInt32(inputs.data(), channels, actualInterleaved.data(), frames);
+    QCOMPARE(actualInterleaved, expectedInterleaved);
+
+    scalar.interleave(inputs.data(), channels, expectedInterleaved.data(), frames);
+    kernels.interleave(inputs.data(), channels, actualInterleaved.data(), frames);
+    QCOMPARE(actualInterleaved, expectedInterleaved);
+
+    std::vector<qint16> expectedInt16(samples);
+    std::vector<qint16> actualInt16(samples);
+    scalar.floatToInt16(inputs.data(), channels, expectedInt16.data(), frames);
+    kernels.floatToInt16(inputs.data(), channels, actualInt16.data(), frames);
+    QCOMPARE(actualInt16, expectedInt16);
+}
+
+void TestSamplesBuffer::conversionKernelsMatchScalarReference_data()
+{
+    QTest::addColumn<int>("kernelsIndex");
+    QTest::addColumn<int>("channels");
+    QTest::addColumn<int>("frames");
+
+    const auto supported = SamplesKernels::getSupported();
+    for (uint k = 0; k < supported.size(); ++k) {
+        for (int channels : {1, 2, 3}) { // 3 channels: only the first 2 are converted
+            for (int frames : {0, 1, 7, 32, 253}) {
+                auto rowName = QString("%1 - %2 channels - %3 frames").arg(supported[k]->name).arg(channels).arg(frames);
+                QTest::newRow(qPrintable(rowName)) << static_cast<int>(k) << channels << frames;
+            }
+        }
+    }
+}
+
+void TestSamplesBuffer::applyGainAndComputePeak()
+{
+    SamplesBuffer expected(2, 100);
+    for (uint s = 0; s < expected.getFrameLenght(); ++s) {
+        expected.set(0, s, std::sin(s * 0.2f));
+        expected.set(1, s, std::cos(s * 0.3f));
+    }
+    expected.setRmsWindowSize(50);
+
+    SamplesBuffer actual(expected);
+
+    expected.applyGain(0.8f, 0.3f, 0.9f, 2.0f);
+    auto expectedPeak = expected.computePeak();
+    auto actualPeak = actual.applyGainAndComputePeak(0.8f, 0.3f, 0.9f, 2.0f);
+
+    QCOMPARE(actualPeak.getLeftPeak(), expectedPeak.getLeftPeak());
+    QCOMPARE(actualPeak.getRightPeak(), expectedPeak.getRightPeak());
+    QVERIFY(qAbs(actualPeak.getLeftRMS() - expectedPeak.getLeftRMS()) < 1e-5f);
+    QVERIFY(qAbs(actualPeak.getRightRMS() - expectedPeak.getRightRMS()) < 1e-5f);
+    for (uint s = 0; s < expected.getFrameLenght(); ++s) {
+        QCOMPARE(actual.get(0, s), expected.get(0, s));
+        QCOMPARE(actual.get(1, s), expected.get(1, s));
+    }
+}
+
 SamplesBuffer TestSamplesBuffer::createBuffer(QString comaSeparatedValues)
 {
     QStringList values;
@@ -34,6 +34,22 @@ private slots:
     void copy();
     void copy_data();
 
+    void view();
+    void view_data();
+
+    void reserveIsPreservingSamples();
+
+    void samplesAreAligned();
+
+    // every SIMD implementation supported by the CPU is compared with the scalar reference
+    void kernelsMatchScalarReference();
+    void kernelsMatchScalarReference_data();
+
+    void conversionKernelsMatchScalarReference(); // interleaved wave file samples to planar float and back
+    void conversionKernelsMatchScalarReference_data();
+
+    void applyGainAndComputePeak(); // fused pass produce the same result of applyGain() + computePeak()
+
 private:
     audio::SamplesBuffer createBuffer(QString comaSeparatedValues);
     void checkExpectedValues(QString comaSeparatedExpectedValues, const audio::SamplesBuffer &buffer);
@@ -0,0 +1,133 @@
+#include "TestSamplesRingBuffer.h"
+
+#include <QTest>
+#include <atomic>
+#include <thread>
+
+#include "audio/core/SamplesRingBuffer.h"
+
+using audio::SamplesRingBuffer;
+using audio::SamplesBuffer;
+
+namespace {
+
+SamplesBuffer createRamp(uint frames, float firstValue) // left channel = ramp, right channel = -ramp
+{
+    SamplesBuffer buffer(2, frames);
+    for (uint i = 0; i < frames; ++i) {
+        buffer.set(0, i, firstValue + i);
+        buffer.set(1, i, -(firstValue + i));
+    }
+    return buffer;
+}
+
+} // namespace
+
+void TestSamplesRingBuffer::capacityIsRoundedToPowerOfTwo()
+{
+    QCOMPARE(SamplesRingBuffer(2, 1000).getCapacity(), 1024u);
+    QCOMPARE(SamplesRingBuffer(2, 1024).getCapacity(), 1024u);
+    QCOMPARE(SamplesRingBuffer(2, 0).getCapacity(), 1u);
+}
+
+void TestSamplesRingBuffer::writeIsLimitedByFreeFrames()
+{
+    SamplesRingBuffer ring(2, 64);
+
+    QCOMPARE(ring.write(createRamp(48, 0)), 48u);
+    QCOMPARE(ring.getFreeFrames(), 16u);
+
+    QCOMPARE(ring.write(createRamp(48, 48)), 16u);
+    QCOMPARE(ring.getFreeFrames(), 0u);
+    QCOMPARE(ring.getAvailableFrames(), 64u);
+
+    QCOMPARE(ring.write(createRamp(8, 0)), 0u);
+}
+
+void TestSamplesRingBuffer::readIsLimitedByAvailableFrames()
+{
+    SamplesRingBuffer ring(2, 64);
+    ring.write(createRamp(10, 1));
+
+    SamplesBuffer out(2, 32);
+    out.zero();
+    QCOMPARE(ring.read(out, 32), 10u);
+    QCOMPARE(ring.getAvailableFrames(), 0u);
+
+    for (uint i = 0; i < 10; ++i) {
+        QCOMPARE(out.get(0, i), 1.0f + i);
+        QCOMPARE(out.get(1, i), -(1.0f + i));
+    }
+    QCOMPARE(out.get(0, 10), 0.0f); // not touched
+
+    QCOMPARE(ring.read(out, 32), 0u);
+}
+
+void TestSamplesRingBuffer::readAndWriteWrappingAround()
+{
+    SamplesRingBuffer ring(2, 16);
+    SamplesBuffer out(2, 16);
+
+    float nextWritten = 0;
+    float nextRead = 0;
+    for (int i = 0; i < 100; ++i) { // writing 11 and reading 11 frames, the positions are wrapping around in different points
+        nextWritten += ring.write(createRamp(11, nextWritten));
+
+        const uint read = ring.read(out, 11);
+        QCOMPARE(read, 11u);
+        for (uint f = 0; f < read; ++f) {
+            QCOMPARE(out.get(0, f), nextRead);
+            QCOMPARE(out.get(1, f), -nextRead);
+            nextRead++;
+        }
+    }
+}
+
+void TestSamplesRingBuffer::monoSamplesAreCopiedToAllChannels()
+{
+    SamplesRingBuffer ring(2, 8);
+
+    SamplesBuffer monoSamples(1, 4);
+    for (uint i = 0; i < 4; ++i)
+        monoSamples.set(0, i, 0.5f);
+
+    ring.write(monoSamples);
+
+    SamplesBuffer out(2, 4);
+    QCOMPARE(ring.read(out, 4), 4u);
+    QCOMPARE(out.get(0, 3), 0.5f);
+    QCOMPARE(out.get(1, 3), 0.5f);
+}
+
+void TestSamplesRingBuffer::concurrentProducerAndConsumer()
+{
+    const uint totalFrames = 1 << 20;
+
+    SamplesRingBuffer ring(2, 1000);
+
+    std::thread decodingThread([&]() {
+        uint written = 0;
+        while (written < totalFrames) {
+            const uint frames = qMin(97u, totalFrames - written);
+            written += ring.write(createRamp(frames, written));
+            std::this_thread::yield();
+        }
+    });
+
+    SamplesBuffer out(2, 128);
+    uint read = 0;
+    int wrongFrames = 0;
+    while (read < totalFrames) { // the 'audio thread'
+        const uint frames = ring.read(out, 128);
+        for (uint f = 0; f < frames; ++f) {
+            if (out.get(0, f) != static_cast<float>(read + f) || out.get(1, f) != -static_cast<float>(read + f))
+                wrongFrames++;
+        }
+        read += frames;
+    }
+
+    decodingThread.join();
+
+    QCOMPARE(wrongFrames, 0);
+    QCOMPARE(ring.getAvailableFrames(), 0u);
+}
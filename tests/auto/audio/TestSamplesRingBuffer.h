@@ -0,0 +1,19 @@
+#ifndef TESTSAMPLESRINGBUFFER_H
+#define TESTSAMPLESRINGBUFFER_H
+
+#include <QObject>
+
+class TestSamplesRingBuffer: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void capacityIsRoundedToPowerOfTwo();
+    void writeIsLimitedByFreeFrames();
+    void readIsLimitedByAvailableFrames();
+    void readAndWriteWrappingAround();
+    void monoSamplesAreCopiedToAllChannels();
+    void concurrentProducerAndConsumer();
+};
+
+#endif // TESTSAMPLESRINGBUFFER_H
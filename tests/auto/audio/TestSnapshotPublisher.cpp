@@ -0,0 +1,128 @@
+#include "TestSnapshotPublisher.h"
+
+#include <QTest>
+#include <QVector>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "audio/core/SnapshotPublisher.h"
+
+using audio::SnapshotPublisher;
+using audio::SnapshotReadSection;
+
+namespace {
+
+struct Topology // a fake audio graph, the destructor is invalidating the data to detect reads after release
+{
+    static const int ALIVE = 0x600DF00D;
+
+    explicit Topology(int nodes = 0) :
+        nodes(nodes, nodes),
+        magic(ALIVE)
+    {
+
+    }
+
+    ~Topology()
+    {
+        magic = 0;
+        nodes.fill(-1);
+    }
+
+    bool isValid() const
+    {
+        if (magic != ALIVE)
+            return false;
+
+        for (int value : nodes) {
+            if (value != nodes.size())
+                return false;
+        }
+
+        return true;
+    }
+
+    QVector<int> nodes;
+    int magic;
+};
+
+} // namespace
+
+void TestSnapshotPublisher::publishedValueIsVisibleInNextReadSection()
+{
+    SnapshotPublisher<QVector<int>> publisher;
+
+    {
+        SnapshotReadSection readSection;
+        QVERIFY(publisher.read().isEmpty());
+    }
+
+    publisher.publish(QVector<int>() << 1 << 2 << 3);
+
+    {
+        SnapshotReadSection readSection;
+        QCOMPARE(publisher.read(), QVector<int>() << 1 << 2 << 3);
+    }
+}
+
+void TestSnapshotPublisher::waitForReadersIsBlockedByOpenedReadSection()
+{
+    std::atomic<bool> readSectionOpened(false);
+    std::atomic<bool> closeReadSection(false);
+    std::atomic<bool> writerFinished(false);
+
+    std::thread reader([&]() {
+        SnapshotReadSection readSection;
+        readSectionOpened = true;
+        while (!closeReadSection)
+            std::this_thread::yield();
+    });
+
+    while (!readSectionOpened)
+        std::this_thread::yield();
+
+    std::thread writer([&]() {
+        SnapshotReadSection::waitForReaders();
+        writerFinished = true;
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    QVERIFY(!writerFinished); // the reader is still in the read section
+
+    closeReadSection = true;
+    reader.join();
+    writer.join();
+
+    QVERIFY(writerFinished);
+}
+
+void TestSnapshotPublisher::concurrentReaderNeverSeeReleasedSnapshots()
+{
+    SnapshotPublisher<Topology> publisher;
+
+    std::atomic<bool> stop(false);
+    std::atomic<int> invalidReads(0);
+    std::atomic<int> totalReads(0);
+
+    std::thread audioThread([&]() {
+        while (!stop) {
+            SnapshotReadSection readSection;
+            const Topology &topology = publisher.read();
+            for (int i = 0; i < 10; ++i) { // reading more than one time in the same section
+                if (!topology.isValid())
+                    invalidReads++;
+            }
+            totalReads++;
+        }
+    });
+
+    for (int i = 1; i <= 1000; ++i)
+        publisher.publish(Topology(i % 64));
+
+    stop = true;
+    audioThread.join();
+
+    QVERIFY(totalReads > 0);
+    QCOMPARE(invalidReads.load(), 0);
+}
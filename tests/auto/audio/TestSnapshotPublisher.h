@@ -0,0 +1,16 @@
+#ifndef TESTSNAPSHOTPUBLISHER_H
+#define TESTSNAPSHOTPUBLISHER_H
+
+#include <QObject>
+
+class TestSnapshotPublisher: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void publishedValueIsVisibleInNextReadSection();
+    void waitForReadersIsBlockedByOpenedReadSection();
+    void concurrentReaderNeverSeeReleasedSnapshots();
+};
+
+#endif // TESTSNAPSHOTPUBLISHER_H
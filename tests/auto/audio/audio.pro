@@ -11,16 +11,60 @@ VPATH += ../../../src/Common
 
 HEADERS += TestSamplesBuffer.h
 HEADERS += TestLooper.h
+HEADERS += TestSnapshotPublisher.h
+HEADERS += TestSamplesRingBuffer.h
+HEADERS += TestResampler.h
+HEADERS += TestEncodingService.h
+HEADERS += TestPeaksPyramid.h
+HEADERS += TestLooperMixer.h
+HEADERS += TestPluginBridge.h
 HEADERS += audio/core/SamplesBuffer.h
+HEADERS += audio/core/SamplesBufferView.h
+HEADERS += audio/core/SamplesKernels.h
+HEADERS += audio/core/SnapshotPublisher.h
+HEADERS += audio/core/SamplesRingBuffer.h
 HEADERS += audio/core/AudioPeak.h
+HEADERS += audio/Resampler.h
+HEADERS += audio/SamplesBufferResampler.h
+HEADERS += audio/EncodingService.h
+HEADERS += audio/core/WakeupNotifier.h
+HEADERS += audio/bridge/BridgeProtocol.h
+HEADERS += audio/bridge/BridgeSignal.h
+HEADERS += audio/bridge/PluginBridgeHost.h
+HEADERS += audio/bridge/PluginBridgeChild.h
+HEADERS += audio/bridge/BridgeTestProcessor.h
+HEADERS += midi/MidiMessage.h
 HEADERS += looper/Looper.h
+HEADERS += looper/PeaksPyramid.h
+HEADERS += looper/LooperMixer.h
 
 SOURCES += TestSamplesBuffer.cpp
 SOURCES += TestLooper.cpp
+SOURCES += TestSnapshotPublisher.cpp
+SOURCES += TestSamplesRingBuffer.cpp
+SOURCES += TestResampler.cpp
+SOURCES += TestEncodingService.cpp
+SOURCES += TestPeaksPyramid.cpp
+SOURCES += TestLooperMixer.cpp
+SOURCES += TestPluginBridge.cpp
 SOURCES += audio/core/SamplesBuffer.cpp
+SOURCES += audio/core/SamplesKernels.cpp
+SOURCES += audio/core/SnapshotPublisher.cpp
+SOURCES += audio/core/SamplesRingBuffer.cpp
 SOURCES += audio/core/AudioPeak.cpp
+SOURCES += audio/Resampler.cpp
+SOURCES += audio/SamplesBufferResampler.cpp
+SOURCES += audio/EncodingService.cpp
+SOURCES += audio/core/WakeupNotifier.cpp
+SOURCES += audio/bridge/BridgeSignal.cpp
+SOURCES += audio/bridge/PluginBridgeHost.cpp
+SOURCES += audio/bridge/PluginBridgeChild.cpp
+SOURCES += audio/bridge/BridgeTestProcessor.cpp
+SOURCES += midi/MidiMessage.cpp
 SOURCES += looper/Looper.cpp
 SOURCES += looper/LooperStates.cpp
 SOURCES += looper/LooperLayer.cpp
+SOURCES += looper/PeaksPyramid.cpp
+SOURCES += looper/LooperMixer.cpp
 
 SOURCES += test_Audio.cpp
@@ -0,0 +1,59 @@
+# micro benchmarks, not executed in 'make check'. Run in release mode to get meaningful numbers.
+
+QT += testlib
+QT -= gui
+CONFIG += c++11
+TEMPLATE = app
+TARGET = audioBenchmark
+
+INCLUDEPATH += .
+INCLUDEPATH += ../../../src/Common
+VPATH += ../../../src/Common
+
+HEADERS += BenchmarkSamplesBuffer.h
+HEADERS += BenchmarkAudioMixer.h
+HEADERS += BenchmarkResampler.h
+HEADERS += BenchmarkPluginBridge.h
+HEADERS += audio/core/SamplesBuffer.h
+HEADERS += audio/core/SamplesBufferView.h
+HEADERS += audio/core/SamplesKernels.h
+HEADERS += audio/core/AudioPeak.h
+HEADERS += audio/core/AudioNode.h
+HEADERS += audio/core/AudioNodeProcessor.h
+HEADERS += audio/core/AudioMixer.h
+HEADERS += audio/core/SnapshotPublisher.h
+HEADERS += audio/core/RenderWorkers.h
+HEADERS += audio/core/WakeupNotifier.h
+HEADERS += audio/SamplesBufferResampler.h
+HEADERS += audio/Resampler.h
+HEADERS += audio/bridge/BridgeProtocol.h
+HEADERS += audio/bridge/BridgeSignal.h
+HEADERS += audio/bridge/PluginBridgeHost.h
+HEADERS += audio/bridge/PluginBridgeChild.h
+HEADERS += audio/bridge/BridgeTestProcessor.h
+HEADERS += midi/MidiMessage.h
+HEADERS += log/Logging.h
+
+SOURCES += BenchmarkSamplesBuffer.cpp
+SOURCES += BenchmarkAudioMixer.cpp
+SOURCES += BenchmarkResampler.cpp
+SOURCES += BenchmarkPluginBridge.cpp
+SOURCES += audio/core/SamplesBuffer.cpp
+SOURCES += audio/core/SamplesKernels.cpp
+SOURCES += audio/core/AudioPeak.cpp
+SOURCES += audio/core/AudioNode.cpp
+SOURCES += audio/core/AudioNodeProcessor.cpp
+SOURCES += audio/core/AudioMixer.cpp
+SOURCES += audio/core/SnapshotPublisher.cpp
+SOURCES += audio/core/RenderWorkers.cpp
+SOURCES += audio/core/WakeupNotifier.cpp
+SOURCES += audio/SamplesBufferResampler.cpp
+SOURCES += audio/Resampler.cpp
+SOURCES += audio/bridge/BridgeSignal.cpp
+SOURCES += audio/bridge/PluginBridgeHost.cpp
+SOURCES += audio/bridge/PluginBridgeChild.cpp
+SOURCES += audio/bridge/BridgeTestProcessor.cpp
+SOURCES += midi/MidiMessage.cpp
+SOURCES += log/logging.cpp
+
+SOURCES += benchmark_Audio.cpp
@@ -0,0 +1,31 @@
+#include <QObject>
+
+#include <QtTest>
+#include <QCoreApplication>
+#include "BenchmarkSamplesBuffer.h"
+#include "BenchmarkAudioMixer.h"
+#include "BenchmarkResampler.h"
+#include "BenchmarkPluginBridge.h"
+
+int main(int argc, char *argv[])
+{
+    if (argc == 3 && BenchmarkPluginBridge::CHILD_ARGUMENT == argv[1])
+        return BenchmarkPluginBridge::runChild(argv[2]);
+
+    QCoreApplication app(argc, argv); // the bridged process benchmark is starting this executable again
+
+    BenchmarkSamplesBuffer benchmarkSamplesBuffer;
+    BenchmarkAudioMixer benchmarkAudioMixer;
+    BenchmarkResampler benchmarkResampler;
+    BenchmarkPluginBridge benchmarkPluginBridge;
+
+    int result = QTest::qExec(&benchmarkSamplesBuffer, argc, argv);
+
+    result |= QTest::qExec(&benchmarkAudioMixer, argc, argv);
+
+    result |= QTest::qExec(&benchmarkResampler, argc, argv);
+
+    result |= QTest::qExec(&benchmarkPluginBridge, argc, argv);
+
+    return result;
+}
@@ -3,15 +3,43 @@
 #include <QtTest>
 #include "TestSamplesBuffer.h"
 #include "TestLooper.h"
+#include "TestSnapshotPublisher.h"
+#include "TestSamplesRingBuffer.h"
+#include "TestResampler.h"
+#include "TestEncodingService.h"
+#include "TestPeaksPyramid.h"
+#include "TestLooperMixer.h"
+#include "TestPluginBridge.h"
 
 int main(int argc, char *argv[])
 {
     TestSamplesBuffer testSamplesBuffer;
     TestLooper testLooper;
+    TestSnapshotPublisher testSnapshotPublisher;
+    TestSamplesRingBuffer testSamplesRingBuffer;
+    TestResampler testResampler;
+    TestEncodingService testEncodingService;
+    TestPeaksPyramid testPeaksPyramid;
+    TestLooperMixer testLooperMixer;
+    TestPluginBridge testPluginBridge;
 
     int result = QTest::qExec(&testSamplesBuffer, argc, argv);
 
     result |= QTest::qExec(&testLooper, argc, argv);
 
+    result |= QTest::qExec(&testSnapshotPublisher, argc, argv);
+
+    result |= QTest::qExec(&testSamplesRingBuffer, argc, argv);
+
+    result |= QTest::qExec(&testResampler, argc, argv);
+
+    result |= QTest::qExec(&testEncodingService, argc, argv);
+
+    result |= QTest::qExec(&testPeaksPyramid, argc, argv);
+
+    result |= QTest::qExec(&testLooperMixer, argc, argv);
+
+    result |= QTest::qExec(&testPluginBridge, argc, argv);
+
     return result;
 }
@@ -9,3 +9,17 @@ SUBDIRS += geo
 SUBDIRS += midi
 SUBDIRS += ninjam
 SUBDIRS += persistence
+SUBDIRS += recorder
+SUBDIRS += video
+
+SUBDIRS += audioBenchmark
+audioBenchmark.file = audio/audioBenchmark.pro
+audioBenchmark.makefile = Makefile.benchmark
+
+SUBDIRS += fileBenchmark
+fileBenchmark.file = file/fileBenchmark.pro
+fileBenchmark.makefile = Makefile.benchmark
+
+SUBDIRS += ninjamBenchmark
+ninjamBenchmark.file = ninjam/ninjamBenchmark.pro
+ninjamBenchmark.makefile = Makefile.benchmark
@@ -0,0 +1,241 @@
+#include "BenchmarkWaveFileReader.h"
+
+#include "file/WaveFileReader.h"
+#include "audio/core/SamplesBuffer.h"
+#include "audio/core/SamplesKernels.h"
+#include "audio/SamplesBufferResampler.h"
+#include <QElapsedTimer>
+#include <QDataStream>
+#include <QFile>
+#include <QTest>
+#include <QDebug>
+#include <QtEndian>
+#include <vector>
+#include <cmath>
+#include <cstring>
+
+using namespace audio;
+
+namespace {
+
+const int SAMPLE_RATE = 44100;
+const int FILE_FRAMES = SAMPLE_RATE * 60; // a long loop
+const int KERNEL_FRAMES = 4096;
+const int ITERATIONS = 20000;
+
+void writeStereoWaveFile(const QString &filePath, quint16 bitsPerSample)
+{
+    const quint16 formatTag = bitsPerSample == 32 ? 3 : 1; // 32 bits files are float, as in the previous reader
+    const quint16 bytesPerSample = bitsPerSample / 8;
+    const quint32 dataSize = FILE_FRAMES * 2 * bytesPerSample;
+
+    QByteArray data(static_cast<int>(dataSize), 0);
+    uchar *dest = reinterpret_cast<uchar *>(data.data());
+    for (int s = 0; s < FILE_FRAMES * 2; ++s, dest += bytesPerSample) {
+        const float sample = std::sin(s * 0.001f) * 0.9f;
+        if (bitsPerSample == 32) {
+            std::memcpy(dest, &sample, sizeof(float));
+        }
+        else {
+            const qint32 value = static_cast<qint32>(sample * 2147483647.0f) >> (32 - bitsPerSample);
+            for (int b = 0; b < bytesPerSample; ++b)
+                dest[b] = static_cast<uchar>(value >> (b * 8));
+        }
+    }
+
+    QFile file(filePath);
+    file.open(QFile::WriteOnly);
+    QDataStream stream(&file);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream.writeRawData("RIFF", 4);
+    stream << quint32(36 + dataSize);
+    stream.writeRawData("WAVEfmt ", 8);
+    stream << quint32(16) << formatTag << quint16(2) << quint32(SAMPLE_RATE) << quint32(SAMPLE_RATE * 2 * bytesPerSample);
+    stream << quint16(2 * bytesPerSample) << bitsPerSample;
+    stream.writeRawData("data", 4);
+    stream << dataSize;
+    stream.writeRawData(data.constData(), data.size());
+}
+
+// the WaveFileReader before the memory mapped version: one QDataStream read per sample
+bool readWithDataStream(const QString &filePath, SamplesBuffer &outBuffer)
+{
+    QFile wavFile(filePath);
+    if (!wavFile.open(QFile::ReadOnly))
+        return false;
+
+    QByteArray wavFileContent = wavFile.readAll();
+    QDataStream stream(&wavFileContent, QIODevice::ReadOnly);
+    stream.setByteOrder(QDataStream::LittleEndian);
+
+    quint16 channels;
+    quint16 bitsPerSample;
+    quint32 dataSize;
+    stream.skipRawData(22);
+    stream >> channels;
+    stream.skipRawData(10);
+    stream >> bitsPerSample;
+    stream.skipRawData(4);
+    stream >> dataSize;
+
+    const uint samples = dataSize / channels / (bitsPerSample / 8);
+    outBuffer.setToStereo();
+    outBuffer.setFrameLenght(samples);
+
+    for (uint s = 0; s < samples; ++s) {
+        for (int c = 0; c < channels; ++c) {
+            float sample = 0;
+            if (bitsPerSample == 16) {
+                qint16 sampleValue;
+                stream >> sampleValue;
+                sample = sampleValue / 32767.0f;
+            }
+            else if (bitsPerSample == 24) {
+                char buffer[3];
+                stream.readRawData(buffer, 3);
+                sample = ((buffer[0] & 0xFF) | ((buffer[1] & 0xFF) << 8) | (buffer[2] << 16)) / 8388606.0F;
+            }
+            else {
+                char buffer[4];
+                stream.readRawData(buffer, 4);
+                std::memcpy(&sample, &buffer, sizeof(sample));
+            }
+            outBuffer.set(c, s, sample);
+        }
+    }
+
+    return true;
+}
+
+} // namespace
+
+void BenchmarkWaveFileReader::initTestCase()
+{
+    QVERIFY(dir.isValid());
+
+    for (int bitsPerSample : {16, 24, 32})
+        writeStereoWaveFile(getFilePath(bitsPerSample), static_cast<quint16>(bitsPerSample));
+}
+
+QString BenchmarkWaveFileReader::getFilePath(int bitsPerSample) const
+{
+    return dir.filePath(QString("stereo_%1.wav").arg(bitsPerSample));
+}
+
+void BenchmarkWaveFileReader::conversionKernels()
+{
+    std::vector<qint16> input16(KERNEL_FRAMES * 2);
+    std::vector<qint32> input32(KERNEL_FRAMES * 2);
+    std::vector<float> inputFloat(KERNEL_FRAMES * 2);
+    for (int i = 0; i < KERNEL_FRAMES * 2; ++i) {
+        inputFloat[i] = std::sin(i * 0.01f);
+        input32[i] = static_cast<qint32>(inputFloat[i] * 2147483647.0f);
+        input16[i] = static_cast<qint16>(input32[i] >> 16);
+    }
+
+    std::vector<float> left(KERNEL_FRAMES);
+    std::vector<float> right(KERNEL_FRAMES);
+    float *outputs[2] = {left.data(), right.data()};
+
+    typedef void (*Conversion)(const void *, uint, float * const *, uint, uint);
+    struct Benchmark
+    {
+        const char *name;
+        Conversion SamplesKernels::*conversion;
+        const void *input;
+    };
+
+    const Benchmark benchmarks[] = {
+        {"int16ToFloat", &SamplesKernels::int16ToFloat, input16.data()},
+        {"int32ToFloat", &SamplesKernels::int32ToFloat, input32.data()},
+        {"deinterleave", &SamplesKernels::deinterleave, inputFloat.data()}
+    };
+
+    for (const auto &benchmark : benchmarks) {
+        double scalarNanosPerSample = 0;
+        for (auto kernels : SamplesKernels::getSupported()) {
+            const Conversion conversion = kernels->*benchmark.conversion;
+            QElapsedTimer timer;
+            timer.start();
+            for (int i = 0; i < ITERATIONS; ++i)
+                conversion(benchmark.input, 2, outputs, 2, KERNEL_FRAMES);
+
+            const double nanosPerSample = static_cast<double>(timer.nsecsElapsed()) / (static_cast<double>(KERNEL_FRAMES) * 2 * ITERATIONS);
+            if (kernels == &SamplesKernels::getScalar())
+                scalarNanosPerSample = nanosPerSample;
+
+            qInfo().noquote() << QString("%1 stereo %2: %3 ns/sample (%4x scalar)")
+                                 .arg(benchmark.name)
+                                 .arg(kernels->name, -6)
+                                 .arg(nanosPerSample, 0, 'f', 4)
+                                 .arg(scalarNanosPerSample / nanosPerSample, 0, 'f', 2);
+        }
+    }
+}
+
+void BenchmarkWaveFileReader::read()
+{
+    QFETCH(int, bitsPerSample);
+    QFETCH(bool, dataStream);
+
+    const QString filePath = getFilePath(bitsPerSample);
+    SamplesBuffer buffer(2);
+
+    QBENCHMARK {
+        buffer.setFrameLenght(0); // the entire file
+        if (dataStream) {
+            readWithDataStream(filePath, buffer);
+        }
+        else {
+            WaveFileReader reader;
+            quint32 sampleRate;
+            reader.read(filePath, buffer, sampleRate);
+        }
+    }
+
+    QCOMPARE(buffer.getFrameLenght(), uint(FILE_FRAMES));
+}
+
+void BenchmarkWaveFileReader::read_data()
+{
+    QTest::addColumn<int>("bitsPerSample");
+    QTest::addColumn<bool>("dataStream");
+
+    for (int bitsPerSample : {16, 24, 32}) {
+        QTest::newRow(qPrintable(QString("QDataStream %1 bits").arg(bitsPerSample))) << bitsPerSample << true;
+        QTest::newRow(qPrintable(QString("WaveFileReader %1 bits").arg(bitsPerSample))) << bitsPerSample << false;
+    }
+}
+
+void BenchmarkWaveFileReader::readResampled()
+{
+    QFETCH(bool, resampleWhileReading);
+
+    const QString filePath = getFilePath(16);
+    const int targetSampleRate = 48000;
+    SamplesBuffer buffer(2);
+
+    QBENCHMARK {
+        buffer.setFrameLenght(0);
+        WaveFileReader reader;
+        if (resampleWhileReading) {
+            reader.readResampled(filePath, buffer, targetSampleRate);
+        }
+        else {
+            quint32 sampleRate;
+            reader.read(filePath, buffer, sampleRate);
+            const SamplesBuffer originalBuffer(buffer);
+            SamplesBufferResampler::resample(originalBuffer, buffer, static_cast<int>(sampleRate), targetSampleRate);
+        }
+    }
+
+    QCOMPARE(buffer.getFrameLenght(), uint(static_cast<qint64>(FILE_FRAMES) * targetSampleRate / SAMPLE_RATE));
+}
+
+void BenchmarkWaveFileReader::readResampled_data()
+{
+    QTest::addColumn<bool>("resampleWhileReading");
+
+    QTest::newRow("read + resample") << false;
+    QTest::newRow("resample while reading") << true;
+}
@@ -0,0 +1,28 @@
+#ifndef BENCHMARKWAVEFILEREADER_H
+#define BENCHMARKWAVEFILEREADER_H
+
+#include <QObject>
+#include <QTemporaryDir>
+
+class BenchmarkWaveFileReader: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase(); // write the test files
+
+    void conversionKernels(); // interleaved file samples to planar float, ns/sample in all supported implementations
+
+    void read(); // previous QDataStream reader vs WaveFileReader
+    void read_data();
+
+    void readResampled(); // read + resample the whole buffer (as LoopLoader did before) vs resampling while reading
+    void readResampled_data();
+
+private:
+    QString getFilePath(int bitsPerSample) const;
+
+    QTemporaryDir dir;
+};
+
+#endif // BENCHMARKWAVEFILEREADER_H
@@ -0,0 +1,200 @@
+#include "BenchmarkWaveFileWriter.h"
+
+#include "file/WaveFileWriter.h"
+#include "audio/core/SamplesBuffer.h"
+#include "audio/core/SamplesKernels.h"
+#include <QElapsedTimer>
+#include <QDataStream>
+#include <QFile>
+#include <QFileInfo>
+#include <QTest>
+#include <QDebug>
+#include <vector>
+#include <cmath>
+#include <climits>
+
+using namespace audio;
+
+namespace {
+
+const int SAMPLE_RATE = 44100;
+const int LAYERS = 8;
+const int LAYER_FRAMES = SAMPLE_RATE * 16; // 8 bars at 120 BPM
+const int KERNEL_FRAMES = 4096;
+const int ITERATIONS = 20000;
+const int APPEND_BLOCK_SIZE = 256; // audio callback size
+
+void fill(SamplesBuffer &buffer)
+{
+    for (int c = 0; c < buffer.getChannels(); ++c) {
+        float *samples = buffer.getSamplesArray(c);
+        for (uint s = 0; s < buffer.getFrameLenght(); ++s)
+            samples[s] = std::sin((s + c) * 0.001f) * 0.9f;
+    }
+}
+
+// the WaveFileWriter before the staging buffer: one QDataStream write per sample
+void writeWithDataStream(const QString &filePath, const SamplesBuffer &buffer, quint32 sampleRate, quint8 bitDepth)
+{
+    QFile wavFile(filePath);
+    if (!wavFile.open(QFile::WriteOnly))
+        return;
+
+    const uint samples = buffer.getFrameLenght();
+    const uint dataChunkSize = buffer.getChannels() * buffer.getFrameLenght() * bitDepth/8;
+
+    QDataStream out(&wavFile);
+    out.setByteOrder(QDataStream::LittleEndian);
+
+    out.writeRawData("RIFF", 4);
+    out << quint32(dataChunkSize + 36);
+    out.writeRawData("WAVE", 4);
+    out.writeRawData("fmt ", 4);
+    out << quint32(16);
+    out << quint16(bitDepth == 16 ? 1 : 3);
+    out << quint16(buffer.getChannels());
+    out << quint32(sampleRate);
+    out << quint32(sampleRate * buffer.getChannels() * bitDepth / 8);
+    out << quint16(buffer.getChannels() * bitDepth / 8);
+    out << quint16(bitDepth);
+    out.writeRawData("data", 4);
+    out << quint32(dataChunkSize);
+
+    if (bitDepth == 32)
+        out.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+    const uint channels = buffer.getChannels();
+    for (uint s = 0; s < samples; ++s) {
+        for (uint c = 0; c < channels; ++c) {
+            if (bitDepth == 16) {
+                int sample = buffer.get(c, s) * SHRT_MAX;
+                if (sample > SHRT_MAX)
+                    sample = SHRT_MAX;
+                else if (sample < SHRT_MIN)
+                    sample = SHRT_MIN;
+
+                out << quint16(sample);
+            }
+            else {
+                out << buffer.get(c, s);
+            }
+        }
+    }
+}
+
+} // namespace
+
+void BenchmarkWaveFileWriter::conversionKernels()
+{
+    std::vector<float> left(KERNEL_FRAMES);
+    std::vector<float> right(KERNEL_FRAMES);
+    for (int i = 0; i < KERNEL_FRAMES; ++i) {
+        left[i] = std::sin(i * 0.01f);
+        right[i] = std::cos(i * 0.01f);
+    }
+
+    const float *inputs[2] = {left.data(), right.data()};
+    std::vector<qint32> output(KERNEL_FRAMES * 2);
+
+    typedef void (*Conversion)(const float * const *, uint, void *, uint);
+    struct Benchmark
+    {
+        const char *name;
+        Conversion SamplesKernels::*conversion;
+    };
+
+    const Benchmark benchmarks[] = {
+        {"floatToInt16", &SamplesKernels::floatToInt16},
+        {"floatToInt32", &SamplesKernels::floatToInt32},
+        {"interleave", &SamplesKernels::interleave}
+    };
+
+    for (const auto &benchmark : benchmarks) {
+        double scalarNanosPerSample = 0;
+        for (auto kernels : SamplesKernels::getSupported()) {
+            const Conversion conversion = kernels->*benchmark.conversion;
+            QElapsedTimer timer;
+            timer.start();
+            for (int i = 0; i < ITERATIONS; ++i)
+                conversion(inputs, 2, output.data(), KERNEL_FRAMES);
+
+            const double nanosPerSample = static_cast<double>(timer.nsecsElapsed()) / (static_cast<double>(KERNEL_FRAMES) * 2 * ITERATIONS);
+            if (kernels == &SamplesKernels::getScalar())
+                scalarNanosPerSample = nanosPerSample;
+
+            qInfo().noquote() << QString("%1 stereo %2: %3 ns/sample (%4x scalar)")
+                                 .arg(benchmark.name)
+                                 .arg(kernels->name, -6)
+                                 .arg(nanosPerSample, 0, 'f', 4)
+                                 .arg(scalarNanosPerSample / nanosPerSample, 0, 'f', 2);
+        }
+    }
+}
+
+void BenchmarkWaveFileWriter::writeLayers()
+{
+    QFETCH(int, bitDepth);
+    QFETCH(bool, dataStream);
+
+    QVERIFY(dir.isValid());
+
+    SamplesBuffer layer(2, LAYER_FRAMES);
+    fill(layer);
+
+    QBENCHMARK {
+        for (int l = 0; l < LAYERS; ++l) {
+            const QString filePath = dir.filePath(QString("layer_%1.wav").arg(l));
+            if (dataStream) {
+                writeWithDataStream(filePath, layer, SAMPLE_RATE, static_cast<quint8>(bitDepth));
+            }
+            else {
+                WaveFileWriter writer;
+                writer.write(filePath, layer, SAMPLE_RATE, static_cast<quint8>(bitDepth));
+            }
+        }
+    }
+
+    QCOMPARE(QFileInfo(dir.filePath("layer_0.wav")).size(), qint64(WaveFileWriter::HEADER_SIZE + LAYER_FRAMES * 2 * bitDepth / 8));
+}
+
+void BenchmarkWaveFileWriter::writeLayers_data()
+{
+    QTest::addColumn<int>("bitDepth");
+    QTest::addColumn<bool>("dataStream");
+
+    for (int bitDepth : {16, 32}) {
+        QTest::newRow(qPrintable(QString("QDataStream %1 bits").arg(bitDepth))) << bitDepth << true;
+        QTest::newRow(qPrintable(QString("WaveFileWriter %1 bits").arg(bitDepth))) << bitDepth << false;
+    }
+}
+
+void BenchmarkWaveFileWriter::append()
+{
+    QFETCH(int, format);
+
+    QVERIFY(dir.isValid());
+
+    SamplesBuffer block(2, APPEND_BLOCK_SIZE);
+    fill(block);
+
+    const int blocks = LAYER_FRAMES / APPEND_BLOCK_SIZE;
+    const QString filePath = dir.filePath("recording.wav");
+
+    QBENCHMARK {
+        WaveFileWriter writer;
+        writer.open(filePath, SAMPLE_RATE, 2, static_cast<WaveFileWriter::SampleFormat>(format));
+        for (int b = 0; b < blocks; ++b)
+            writer.append(block, 0, APPEND_BLOCK_SIZE);
+        writer.finalize();
+    }
+}
+
+void BenchmarkWaveFileWriter::append_data()
+{
+    QTest::addColumn<int>("format");
+
+    QTest::newRow("16 bits") << static_cast<int>(WaveFileWriter::SampleFormat::Int16);
+    QTest::newRow("24 bits") << static_cast<int>(WaveFileWriter::SampleFormat::Int24);
+    QTest::newRow("32 bits") << static_cast<int>(WaveFileWriter::SampleFormat::Int32);
+    QTest::newRow("float") << static_cast<int>(WaveFileWriter::SampleFormat::Float32);
+}
@@ -0,0 +1,24 @@
+#ifndef BENCHMARKWAVEFILEWRITER_H
+#define BENCHMARKWAVEFILEWRITER_H
+
+#include <QObject>
+#include <QTemporaryDir>
+
+class BenchmarkWaveFileWriter: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void conversionKernels(); // planar float to interleaved file samples, ns/sample in all supported implementations
+
+    void writeLayers(); // saving an 8 layers loop, previous QDataStream writer vs WaveFileWriter
+    void writeLayers_data();
+
+    void append(); // streaming mode, small blocks appended as in a recording
+    void append_data();
+
+private:
+    QTemporaryDir dir;
+};
+
+#endif // BENCHMARKWAVEFILEWRITER_H
@@ -0,0 +1,17 @@
+#include <QObject>
+
+#include <QtTest>
+#include "BenchmarkWaveFileReader.h"
+#include "BenchmarkWaveFileWriter.h"
+
+int main(int argc, char *argv[])
+{
+    BenchmarkWaveFileReader benchmarkWaveFileReader;
+    BenchmarkWaveFileWriter benchmarkWaveFileWriter;
+
+    int result = QTest::qExec(&benchmarkWaveFileReader, argc, argv);
+
+    result |= QTest::qExec(&benchmarkWaveFileWriter, argc, argv);
+
+    return result;
+}
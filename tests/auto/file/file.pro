@@ -9,6 +9,23 @@ INCLUDEPATH += ../../../src/Common
 VPATH += ../../../src/Common
 
 HEADERS += file/FileUtils.h
+HEADERS += file/StreamingWaveFileWriter.h
+HEADERS += file/FileReader.h
+HEADERS += file/WaveFileReader.h
+HEADERS += file/WaveFileWriter.h
+HEADERS += audio/core/SamplesBuffer.h
+HEADERS += audio/core/SamplesKernels.h
+HEADERS += audio/core/AudioPeak.h
+HEADERS += audio/SamplesBufferResampler.h
+HEADERS += audio/Resampler.h
 
 SOURCES += file/FileUtils.cpp
+SOURCES += file/StreamingWaveFileWriter.cpp
+SOURCES += file/WaveFileReader.cpp
+SOURCES += file/WaveFileWriter.cpp
+SOURCES += audio/core/SamplesBuffer.cpp
+SOURCES += audio/core/SamplesKernels.cpp
+SOURCES += audio/core/AudioPeak.cpp
+SOURCES += audio/SamplesBufferResampler.cpp
+SOURCES += audio/Resampler.cpp
 SOURCES += test_File.cpp
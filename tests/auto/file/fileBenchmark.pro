@@ -0,0 +1,34 @@
+# micro benchmarks, not executed in 'make check'. Run in release mode to get meaningful numbers.
+
+QT += testlib
+QT -= gui
+CONFIG += c++11
+TEMPLATE = app
+TARGET = fileBenchmark
+
+INCLUDEPATH += .
+INCLUDEPATH += ../../../src/Common
+VPATH += ../../../src/Common
+
+HEADERS += BenchmarkWaveFileReader.h
+HEADERS += BenchmarkWaveFileWriter.h
+HEADERS += file/FileReader.h
+HEADERS += file/WaveFileReader.h
+HEADERS += file/WaveFileWriter.h
+HEADERS += audio/core/SamplesBuffer.h
+HEADERS += audio/core/SamplesKernels.h
+HEADERS += audio/core/AudioPeak.h
+HEADERS += audio/SamplesBufferResampler.h
+HEADERS += audio/Resampler.h
+
+SOURCES += BenchmarkWaveFileReader.cpp
+SOURCES += BenchmarkWaveFileWriter.cpp
+SOURCES += file/WaveFileReader.cpp
+SOURCES += file/WaveFileWriter.cpp
+SOURCES += audio/core/SamplesBuffer.cpp
+SOURCES += audio/core/SamplesKernels.cpp
+SOURCES += audio/core/AudioPeak.cpp
+SOURCES += audio/SamplesBufferResampler.cpp
+SOURCES += audio/Resampler.cpp
+
+SOURCES += benchmark_File.cpp
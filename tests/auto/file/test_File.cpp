@@ -1,7 +1,14 @@
 #include <QObject>
 #include <QString>
 #include <QtTest/QtTest>
+#include <QTemporaryDir>
+#include <QtEndian>
+#include <cstring>
 #include "file/FileUtils.h"
+#include "file/StreamingWaveFileWriter.h"
+#include "file/WaveFileReader.h"
+#include "file/WaveFileWriter.h"
+#include "audio/core/SamplesBuffer.h"
 
 class TestFile: public QObject
 {
@@ -10,6 +17,26 @@ class TestFile: public QObject
 private slots:
     void sanitizeFileName();
     void sanitizeFileName_data();
+    void streamingWaveFileHeader();
+    void streamingWaveFileResume();
+    void streamingWaveFileRf64Promotion();
+    void waveFileReaderFormats();
+    void waveFileReaderFormats_data();
+    void waveFileReaderStreaming(); // partial reads, seek and truncated files
+    void waveFileReaderRf64();
+    void waveFileReaderResampled();
+    void waveFileWriterRoundtrip(); // written by WaveFileWriter and read by WaveFileReader
+    void waveFileWriterRoundtrip_data();
+    void waveFileWriterStreaming(); // append in blocks, header updated in every flush
+
+private:
+    static QByteArray readFile(const QString &filePath);
+    static void writeWaveFile(const QString &filePath, quint16 formatTag, quint16 bitsPerSample, quint16 channels, const QByteArray &data, quint32 sampleRate = 44100, bool extensible = false);
+    static QByteArray encodeSamples(quint16 bitsPerSample, bool floatSamples, quint16 channels, int frames);
+    static float testSample(int frame, int channel); // exact values in all formats
+    static quint16 readUInt16(const QByteArray &bytes, int offset);
+    static quint32 readUInt32(const QByteArray &bytes, int offset);
+    static quint64 readUInt64(const QByteArray &bytes, int offset);
 };
 
 void TestFile::sanitizeFileName()
@@ -38,6 +65,462 @@ void TestFile::sanitizeFileName_data()
 
 }
 
+QByteArray TestFile::readFile(const QString &filePath)
+{
+    QFile file(filePath);
+    file.open(QFile::ReadOnly);
+    return file.readAll();
+}
+
+quint16 TestFile::readUInt16(const QByteArray &bytes, int offset)
+{
+    return qFromLittleEndian<quint16>(reinterpret_cast<const uchar *>(bytes.constData() + offset));
+}
+
+quint32 TestFile::readUInt32(const QByteArray &bytes, int offset)
+{
+    return qFromLittleEndian<quint32>(reinterpret_cast<const uchar *>(bytes.constData() + offset));
+}
+
+quint64 TestFile::readUInt64(const QByteArray &bytes, int offset)
+{
+    return qFromLittleEndian<quint64>(reinterpret_cast<const uchar *>(bytes.constData() + offset));
+}
+
+void TestFile::writeWaveFile(const QString &filePath, quint16 formatTag, quint16 bitsPerSample, quint16 channels, const QByteArray &data, quint32 sampleRate, bool extensible)
+{
+    auto uint16Bytes = [](quint16 value) {
+        QByteArray bytes(2, 0);
+        qToLittleEndian(value, reinterpret_cast<uchar *>(bytes.data()));
+        return bytes;
+    };
+
+    auto uint32Bytes = [](quint32 value) {
+        QByteArray bytes(4, 0);
+        qToLittleEndian(value, reinterpret_cast<uchar *>(bytes.data()));
+        return bytes;
+    };
+
+    const quint16 blockAlign = channels * bitsPerSample / 8;
+
+    QByteArray fmt;
+    fmt.append(uint16Bytes(extensible ? 0xFFFE : formatTag));
+    fmt.append(uint16Bytes(channels));
+    fmt.append(uint32Bytes(sampleRate));
+    fmt.append(uint32Bytes(sampleRate * blockAlign));
+    fmt.append(uint16Bytes(blockAlign));
+    fmt.append(uint16Bytes(bitsPerSample));
+    if (extensible) {
+        fmt.append(uint16Bytes(22));
+        fmt.append(uint16Bytes(bitsPerSample)); // valid bits
+        fmt.append(uint32Bytes(0)); // channel mask
+        fmt.append(uint16Bytes(formatTag)); // subformat GUID
+        fmt.append(QByteArray::fromHex("000000001000800000AA00389B71"));
+    }
+
+    QByteArray content("WAVE");
+    content.append("fmt ").append(uint32Bytes(fmt.size())).append(fmt);
+    content.append("LIST").append(uint32Bytes(3)).append("abc").append('\0'); // odd chunk size, padded
+    content.append("data").append(uint32Bytes(data.size())).append(data);
+
+    QFile file(filePath);
+    file.open(QFile::WriteOnly);
+    file.write("RIFF");
+    file.write(uint32Bytes(content.size()));
+    file.write(content);
+}
+
+float TestFile::testSample(int frame, int channel)
+{
+    return ((frame * 3 + channel * 5) % 16 - 8) / 8.0f;
+}
+
+QByteArray TestFile::encodeSamples(quint16 bitsPerSample, bool floatSamples, quint16 channels, int frames)
+{
+    QByteArray data;
+    for (int s = 0; s < frames; ++s) {
+        for (int c = 0; c < channels; ++c) {
+            const float sample = testSample(s, c);
+            uchar bytes[4];
+            if (floatSamples) {
+                quint32 bits;
+                std::memcpy(&bits, &sample, sizeof(float));
+                qToLittleEndian(bits, bytes);
+            }
+            else if (bitsPerSample == 8) {
+                bytes[0] = static_cast<uchar>(128 + sample * 128);
+            }
+            else if (bitsPerSample == 16) {
+                qToLittleEndian(static_cast<qint16>(sample * 32768), bytes);
+            }
+            else {
+                qToLittleEndian(static_cast<qint32>(sample * 2147483648.0), bytes); // 24 bits are the 3 high bytes
+                if (bitsPerSample == 24) {
+                    bytes[0] = bytes[1];
+                    bytes[1] = bytes[2];
+                    bytes[2] = bytes[3];
+                }
+            }
+            data.append(reinterpret_cast<const char *>(bytes), bitsPerSample / 8);
+        }
+    }
+
+    return data;
+}
+
+void TestFile::streamingWaveFileHeader()
+{
+    QTemporaryDir dir;
+    const QString filePath = dir.filePath("track.wav");
+
+    audio::SamplesBuffer samples(2, 1000);
+    for (uint s = 0; s < samples.getFrameLenght(); ++s) {
+        samples.set(0, s, s / 1000.0f);
+        samples.set(1, s, -(s / 1000.0f));
+    }
+
+    audio::StreamingWaveFileWriter writer;
+    QVERIFY(writer.open(filePath, 48000, 2));
+    writer.write(samples, 0, 1000);
+    writer.writeSilence(200000); // bigger than the write buffer
+    writer.write(samples, 500, 10);
+    QCOMPARE(writer.getFrames(), quint64(201010));
+    QVERIFY(writer.flush());
+
+    const quint64 dataSize = 201010 * 2 * sizeof(float);
+    QByteArray bytes = readFile(filePath);
+    QCOMPARE(quint64(bytes.size()), audio::StreamingWaveFileWriter::HEADER_SIZE + dataSize);
+    QCOMPARE(bytes.left(4), QByteArray("RIFF"));
+    QCOMPARE(readUInt32(bytes, 4), quint32(bytes.size() - 8));
+    QCOMPARE(bytes.mid(12, 4), QByteArray("JUNK"));
+    QCOMPARE(bytes.mid(48, 4), QByteArray("fmt "));
+    QCOMPARE(readUInt32(bytes, 52), quint32(18));
+    QCOMPARE(readUInt16(bytes, 56), quint16(3)); // IEEE float
+    QCOMPARE(readUInt16(bytes, 72), quint16(0)); // cbSize
+    QCOMPARE(bytes.mid(74, 4), QByteArray("fact"));
+    QCOMPARE(readUInt32(bytes, 78), quint32(4));
+    QCOMPARE(readUInt32(bytes, 82), quint32(201010));
+    QCOMPARE(bytes.mid(86, 4), QByteArray("data"));
+    QCOMPARE(quint64(readUInt32(bytes, 90)), dataSize);
+
+    float sample;
+    std::memcpy(&sample, bytes.constData() + 94 + 8 * 10 + 4, sizeof(float)); // frame 10, right channel
+    QCOMPARE(sample, -0.01f);
+    std::memcpy(&sample, bytes.constData() + 94 + 8 * 201000, sizeof(float)); // first frame after silence
+    QCOMPARE(sample, 0.5f);
+}
+
+void TestFile::streamingWaveFileResume()
+{
+    QTemporaryDir dir;
+    const QString filePath = dir.filePath("track.wav");
+
+    audio::SamplesBuffer samples(2, 1000);
+    {
+        audio::StreamingWaveFileWriter writer;
+        QVERIFY(writer.open(filePath, 44100, 2));
+        writer.write(samples, 0, 1000);
+        writer.flush();
+        writer.write(samples, 0, 1000); // not in the session index
+    }
+
+    audio::StreamingWaveFileWriter writer;
+    QVERIFY(writer.open(filePath, 44100, 2, 1000));
+    QCOMPARE(writer.getFrames(), quint64(1000));
+    writer.write(samples, 0, 10);
+    writer.close();
+
+    QByteArray bytes = readFile(filePath);
+    QCOMPARE(bytes.size(), audio::StreamingWaveFileWriter::HEADER_SIZE + 1010 * 8);
+    QCOMPARE(readUInt32(bytes, 82), quint32(1010));
+    QCOMPARE(readUInt32(bytes, 90), quint32(1010 * 8));
+}
+
+void TestFile::streamingWaveFileRf64Promotion()
+{
+    QTemporaryDir dir;
+    const QString filePath = dir.filePath("track.wav");
+
+    const quint64 maxRiffSize = audio::StreamingWaveFileWriter::HEADER_SIZE - 8 + 8000; // 1000 stereo frames
+    audio::StreamingWaveFileWriter writer(maxRiffSize);
+    QVERIFY(writer.open(filePath, 44100, 2));
+
+    audio::SamplesBuffer samples(2, 1001);
+    writer.write(samples, 0, 1000);
+    writer.flush();
+    QVERIFY(!writer.isRf64());
+
+    writer.write(samples, 0, 1);
+    writer.flush();
+    QVERIFY(writer.isRf64());
+
+    QByteArray bytes = readFile(filePath);
+    QCOMPARE(bytes.left(4), QByteArray("RF64"));
+    QCOMPARE(readUInt32(bytes, 4), quint32(0xFFFFFFFF));
+    QCOMPARE(bytes.mid(12, 4), QByteArray("ds64"));
+    QCOMPARE(readUInt64(bytes, 20), quint64(bytes.size() - 8)); // RIFF size
+    QCOMPARE(readUInt64(bytes, 28), quint64(1001 * 8)); // data size
+    QCOMPARE(readUInt64(bytes, 36), quint64(1001)); // sample count
+    QCOMPARE(readUInt32(bytes, 82), quint32(0xFFFFFFFF)); // fact sample count
+    QCOMPARE(readUInt32(bytes, 90), quint32(0xFFFFFFFF));
+}
+
+void TestFile::waveFileReaderFormats()
+{
+    QFETCH(quint16, formatTag);
+    QFETCH(quint16, bitsPerSample);
+    QFETCH(quint16, channels);
+    QFETCH(bool, extensible);
+
+    QTemporaryDir dir;
+    const QString filePath = dir.filePath("samples.wav");
+    const int frames = 37; // SIMD blocks + tail
+    writeWaveFile(filePath, formatTag, bitsPerSample, channels, encodeSamples(bitsPerSample, formatTag == 3, channels, frames), 44100, extensible);
+
+    audio::WaveFileReader reader;
+    audio::SamplesBuffer buffer(2);
+    quint32 sampleRate = 0;
+    QVERIFY(reader.read(filePath, buffer, sampleRate));
+    QCOMPARE(sampleRate, quint32(44100));
+    QCOMPARE(buffer.getFrameLenght(), uint(frames));
+    QCOMPARE(buffer.isMono(), channels == 1);
+    for (int s = 0; s < frames; ++s) {
+        for (int c = 0; c < qMin(buffer.getChannels(), int(channels)); ++c)
+            QCOMPARE(buffer.get(c, s), testSample(s, c));
+    }
+
+    audio::SamplesBuffer limitedBuffer(2, 10); // load only 10 frames
+    QVERIFY(reader.read(filePath, limitedBuffer, sampleRate));
+    QCOMPARE(limitedBuffer.getFrameLenght(), uint(10));
+}
+
+void TestFile::waveFileReaderFormats_data()
+{
+    QTest::addColumn<quint16>("formatTag");
+    QTest::addColumn<quint16>("bitsPerSample");
+    QTest::addColumn<quint16>("channels");
+    QTest::addColumn<bool>("extensible");
+
+    for (quint16 channels : {1, 2, 3}) {
+        const QString suffix = QString(" - %1 channels").arg(channels);
+        QTest::newRow(qPrintable("8 bits" + suffix)) << quint16(1) << quint16(8) << channels << false;
+        QTest::newRow(qPrintable("16 bits" + suffix)) << quint16(1) << quint16(16) << channels << false;
+        QTest::newRow(qPrintable("24 bits" + suffix)) << quint16(1) << quint16(24) << channels << false;
+        QTest::newRow(qPrintable("32 bits" + suffix)) << quint16(1) << quint16(32) << channels << false;
+        QTest::newRow(qPrintable("float" + suffix)) << quint16(3) << quint16(32) << channels << false;
+        QTest::newRow(qPrintable("extensible 24 bits" + suffix)) << quint16(1) << quint16(24) << channels << true;
+        QTest::newRow(qPrintable("extensible float" + suffix)) << quint16(3) << quint16(32) << channels << true;
+    }
+}
+
+void TestFile::waveFileReaderStreaming()
+{
+    QTemporaryDir dir;
+    const QString filePath = dir.filePath("mono.wav");
+    writeWaveFile(filePath, 1, 16, 1, encodeSamples(16, false, 1, 1000));
+
+    audio::WaveFileReader reader;
+    QVERIFY(reader.open(filePath));
+    QCOMPARE(reader.getFrames(), quint64(1000));
+    QCOMPARE(reader.getChannels(), quint16(1));
+    QCOMPARE(reader.getBitsPerSample(), quint16(16));
+    QVERIFY(!reader.isFloat());
+
+    QVERIFY(!reader.seek(1001));
+    QVERIFY(reader.seek(990));
+
+    audio::SamplesBuffer buffer(2, 20);
+    QCOMPARE(reader.readFrames(buffer, 5, 20), uint(10)); // end of file
+    for (int s = 0; s < 10; ++s) {
+        QCOMPARE(buffer.get(0, 5 + s), testSample(990 + s, 0));
+        QCOMPARE(buffer.get(1, 5 + s), testSample(990 + s, 0)); // mono file in stereo buffer
+    }
+    QCOMPARE(reader.getPosition(), quint64(1000));
+    QCOMPARE(reader.readFrames(buffer, 0, 20), uint(0));
+    reader.close();
+
+    // crash while recording, the data chunk size is bigger than the file
+    QFile file(filePath);
+    QVERIFY(file.resize(file.size() - 101));
+    QVERIFY(reader.open(filePath));
+    QCOMPARE(reader.getFrames(), quint64(949));
+    reader.close();
+
+    QFile invalidFile(dir.filePath("invalid.wav"));
+    invalidFile.open(QFile::WriteOnly);
+    invalidFile.write("RIFF");
+    invalidFile.close();
+    QVERIFY(!reader.open(invalidFile.fileName()));
+}
+
+void TestFile::waveFileReaderRf64()
+{
+    QTemporaryDir dir;
+    const QString filePath = dir.filePath("track.wav");
+
+    audio::SamplesBuffer samples(2, 1001);
+    for (uint s = 0; s < samples.getFrameLenght(); ++s) {
+        samples.set(0, s, testSample(s, 0));
+        samples.set(1, s, testSample(s, 1));
+    }
+
+    audio::StreamingWaveFileWriter writer(audio::StreamingWaveFileWriter::HEADER_SIZE - 8 + 8000);
+    QVERIFY(writer.open(filePath, 48000, 2));
+    writer.write(samples, 0, 1001);
+    writer.close();
+
+    audio::WaveFileReader reader;
+    audio::SamplesBuffer buffer(2);
+    quint32 sampleRate = 0;
+    QVERIFY(reader.read(filePath, buffer, sampleRate));
+    QCOMPARE(sampleRate, quint32(48000));
+    QCOMPARE(buffer.getFrameLenght(), uint(1001));
+    for (uint s = 0; s < buffer.getFrameLenght(); ++s) {
+        QCOMPARE(buffer.get(0, s), samples.get(0, s));
+        QCOMPARE(buffer.get(1, s), samples.get(1, s));
+    }
+}
+
+void TestFile::waveFileReaderResampled()
+{
+    QTemporaryDir dir;
+    const QString filePath = dir.filePath("dc.wav");
+
+    QByteArray data;
+    for (int s = 0; s < 44100 * 2; ++s) {
+        uchar bytes[2];
+        qToLittleEndian(static_cast<qint16>(16384), bytes); // 0.5
+        data.append(reinterpret_cast<const char *>(bytes), 2);
+    }
+    writeWaveFile(filePath, 1, 16, 2, data);
+
+    audio::WaveFileReader reader;
+    audio::SamplesBuffer buffer(2);
+    QVERIFY(reader.readResampled(filePath, buffer, 48000));
+    QCOMPARE(buffer.getFrameLenght(), uint(48000));
+    QVERIFY(qAbs(buffer.get(0, 24000) - 0.5f) < 1e-3f);
+    QVERIFY(qAbs(buffer.get(1, 24000) - 0.5f) < 1e-3f);
+
+    audio::SamplesBuffer limitedBuffer(2, 1000); // max lenght in the target sample rate
+    QVERIFY(reader.readResampled(filePath, limitedBuffer, 22050));
+    QCOMPARE(limitedBuffer.getFrameLenght(), uint(1000));
+
+    audio::SamplesBuffer sameRateBuffer(2);
+    QVERIFY(reader.readResampled(filePath, sameRateBuffer, 44100));
+    QCOMPARE(sameRateBuffer.getFrameLenght(), uint(44100));
+    QCOMPARE(sameRateBuffer.get(0, 100), 0.5f);
+}
+
+void TestFile::waveFileWriterRoundtrip()
+{
+    QFETCH(int, format);
+    QFETCH(int, channels);
+
+    const auto sampleFormat = static_cast<audio::WaveFileWriter::SampleFormat>(format);
+
+    QTemporaryDir dir;
+    const QString filePath = dir.filePath("layer.wav");
+
+    const int frames = 300000; // bigger than the staging buffer
+    audio::SamplesBuffer samples(channels, frames);
+    for (int s = 0; s < frames; ++s) {
+        for (int c = 0; c < channels; ++c)
+            samples.set(c, s, testSample(s, c));
+    }
+    samples.set(0, 1, 1.5f); // clipped
+    samples.set(0, 2, -1.5f);
+
+    audio::WaveFileWriter writer;
+    QVERIFY(writer.open(filePath, 48000, static_cast<quint8>(channels), sampleFormat));
+    QVERIFY(writer.append(samples, 0, frames));
+    QVERIFY(writer.finalize());
+    QVERIFY(!writer.isOpen());
+
+    const int bytesPerSample = audio::WaveFileWriter::getBitsPerSample(sampleFormat) / 8;
+    QCOMPARE(QFileInfo(filePath).size(), qint64(audio::WaveFileWriter::HEADER_SIZE + frames * channels * bytesPerSample));
+
+    audio::WaveFileReader reader;
+    QVERIFY(reader.open(filePath));
+    QCOMPARE(reader.getFrames(), quint64(frames));
+    QCOMPARE(reader.getSampleRate(), quint32(48000));
+    QCOMPARE(reader.getChannels(), quint16(channels));
+    QCOMPARE(reader.isFloat(), sampleFormat == audio::WaveFileWriter::SampleFormat::Float32);
+
+    audio::SamplesBuffer buffer(channels, frames);
+    QCOMPARE(reader.readFrames(buffer, 0, frames), uint(frames));
+    for (int s = 3; s < frames; ++s) {
+        for (int c = 0; c < channels; ++c)
+            QCOMPARE(buffer.get(c, s), testSample(s, c)); // exact values in all formats
+    }
+
+    float maxValue = 1.5f; // float samples are not clipped
+    if (sampleFormat == audio::WaveFileWriter::SampleFormat::Int16)
+        maxValue = 32767.0f / 32768.0f;
+    else if (sampleFormat == audio::WaveFileWriter::SampleFormat::Int24)
+        maxValue = 8388607.0f / 8388608.0f;
+    else if (sampleFormat == audio::WaveFileWriter::SampleFormat::Int32)
+        maxValue = 2147483520.0f / 2147483648.0f; // the max float value below 2^31
+
+    QCOMPARE(buffer.get(0, 1), maxValue);
+    QCOMPARE(buffer.get(0, 2), sampleFormat == audio::WaveFileWriter::SampleFormat::Float32 ? -1.5f : -1.0f);
+}
+
+void TestFile::waveFileWriterRoundtrip_data()
+{
+    QTest::addColumn<int>("format");
+    QTest::addColumn<int>("channels");
+
+    for (int channels : {1, 2}) {
+        const QString suffix = QString(" - %1 channels").arg(channels);
+        QTest::newRow(qPrintable("16 bits" + suffix)) << static_cast<int>(audio::WaveFileWriter::SampleFormat::Int16) << channels;
+        QTest::newRow(qPrintable("24 bits" + suffix)) << static_cast<int>(audio::WaveFileWriter::SampleFormat::Int24) << channels;
+        QTest::newRow(qPrintable("32 bits" + suffix)) << static_cast<int>(audio::WaveFileWriter::SampleFormat::Int32) << channels;
+        QTest::newRow(qPrintable("float" + suffix)) << static_cast<int>(audio::WaveFileWriter::SampleFormat::Float32) << channels;
+    }
+}
+
+void TestFile::waveFileWriterStreaming()
+{
+    QTemporaryDir dir;
+    const QString filePath = dir.filePath("recording.wav");
+
+    audio::SamplesBuffer samples(1, 1000); // mono buffer in stereo file
+    for (uint s = 0; s < samples.getFrameLenght(); ++s)
+        samples.set(0, s, testSample(s, 0));
+
+    audio::WaveFileWriter writer;
+    QVERIFY(writer.open(filePath, 44100, 2, audio::WaveFileWriter::SampleFormat::Int16));
+    QCOMPARE(readFile(filePath).size(), audio::WaveFileWriter::HEADER_SIZE);
+
+    QVERIFY(writer.append(samples, 0, 1000));
+    QVERIFY(writer.append(samples, 500, 1000)); // only 500 frames available
+    QCOMPARE(writer.getFrames(), quint64(1500));
+    QVERIFY(writer.flush());
+
+    QByteArray bytes = readFile(filePath);
+    QCOMPARE(bytes.size(), audio::WaveFileWriter::HEADER_SIZE + 1500 * 4);
+    QCOMPARE(readUInt32(bytes, 4), quint32(bytes.size() - 8));
+    QCOMPARE(readUInt32(bytes, 40), quint32(1500 * 4));
+
+    QVERIFY(writer.append(samples, 0, 10));
+    QVERIFY(writer.finalize());
+
+    audio::WaveFileReader reader;
+    audio::SamplesBuffer buffer(2);
+    quint32 sampleRate = 0;
+    QVERIFY(reader.read(filePath, buffer, sampleRate));
+    QCOMPARE(buffer.getFrameLenght(), uint(1510));
+    QCOMPARE(buffer.get(0, 1000), testSample(500, 0));
+    QCOMPARE(buffer.get(1, 1000), testSample(500, 0));
+    QCOMPARE(buffer.get(1, 1509), testSample(9, 0));
+
+    // the previous WaveFileWriter::write() API, 32 bits are float
+    audio::WaveFileWriter layerWriter;
+    QVERIFY(layerWriter.write(filePath, samples, 44100, 32));
+    QVERIFY(reader.open(filePath));
+    QVERIFY(reader.isFloat());
+    QCOMPARE(reader.getFrames(), quint64(1000));
+}
 
 int main(int argc, char *argv[])
 {
@@ -0,0 +1,140 @@
+#include "TestMidiInputQueue.h"
+#include "midi/MidiInputQueue.h"
+
+#include <QtTest/QtTest>
+
+using namespace midi;
+
+namespace {
+
+const int SAMPLE_RATE = 48000;
+const quint32 FRAMES = 480; // 10 ms
+const qint64 BLOCK_PERIOD = 10000000; // ns
+const qint64 NOW = Q_INT64_C(1000000000);
+
+MidiMessage noteOn(quint8 note, int device = 0)
+{
+    return MidiMessage(0x90 | (note << 8) | (100 << 16), device);
+}
+
+} // namespace
+
+void TestMidiInputQueue::sampleOffset()
+{
+    QFETCH(qint64, timestamp);
+    QFETCH(quint32, expectedOffset);
+
+    MidiInputQueue queue;
+    QVERIFY(queue.push(noteOn(60, 3), timestamp));
+
+    std::vector<MidiMessage> messages;
+    messages.reserve(MAX_MESSAGES_PER_BUFFER);
+    queue.consume(messages, NOW, FRAMES, SAMPLE_RATE);
+
+    QCOMPARE(messages.size(), size_t(1));
+    QCOMPARE(messages.front().getSampleOffset(), expectedOffset);
+    QCOMPARE(messages.front().getSourceDeviceIndex(), 3);
+    QCOMPARE(messages.front().getData1(), 60);
+}
+
+void TestMidiInputQueue::sampleOffset_data()
+{
+    QTest::addColumn<qint64>("timestamp");
+    QTest::addColumn<quint32>("expectedOffset");
+
+    QTest::newRow("Received in block start") << NOW - BLOCK_PERIOD << quint32(0);
+    QTest::newRow("Received in block middle") << NOW - BLOCK_PERIOD / 2 << FRAMES / 2;
+    QTest::newRow("Received 1 ms after block start") << NOW - BLOCK_PERIOD + 1000000 << quint32(48);
+    QTest::newRow("Received now") << NOW << FRAMES - 1;
+    QTest::newRow("Received before the last block") << NOW - BLOCK_PERIOD * 10 << quint32(0);
+}
+
+void TestMidiInputQueue::futureMessages()
+{
+    MidiInputQueue queue;
+    QVERIFY(queue.push(noteOn(60), NOW - 1000));
+    QVERIFY(queue.push(noteOn(61), NOW + 1000)); // received after the audio thread read the clock
+
+    std::vector<MidiMessage> messages;
+    messages.reserve(MAX_MESSAGES_PER_BUFFER);
+    queue.consume(messages, NOW, FRAMES, SAMPLE_RATE);
+    QCOMPARE(messages.size(), size_t(1));
+    QCOMPARE(messages.front().getData1(), 60);
+
+    messages.clear();
+    queue.consume(messages, NOW + BLOCK_PERIOD, FRAMES, SAMPLE_RATE);
+    QCOMPARE(messages.size(), size_t(1));
+    QCOMPARE(messages.front().getData1(), 61);
+    QCOMPARE(messages.front().getSampleOffset(), quint32(0)); // 1 us after the block start
+}
+
+void TestMidiInputQueue::devicesOrdering()
+{
+    MidiInputQueue firstDevice;
+    MidiInputQueue secondDevice;
+
+    QVERIFY(firstDevice.push(noteOn(60, 0), NOW - BLOCK_PERIOD * 3 / 4));
+    QVERIFY(firstDevice.push(noteOn(62, 0), NOW - BLOCK_PERIOD / 4));
+    QVERIFY(secondDevice.push(noteOn(61, 1), NOW - BLOCK_PERIOD / 2));
+    QVERIFY(secondDevice.push(noteOn(63, 1), NOW - BLOCK_PERIOD / 8));
+
+    std::vector<MidiMessage> messages;
+    messages.reserve(MAX_MESSAGES_PER_BUFFER);
+    firstDevice.consume(messages, NOW, FRAMES, SAMPLE_RATE);
+    secondDevice.consume(messages, NOW, FRAMES, SAMPLE_RATE);
+
+    QCOMPARE(messages.size(), size_t(4));
+    for (size_t m = 0; m < messages.size(); ++m)
+        QCOMPARE(messages[m].getData1(), static_cast<int>(60 + m));
+
+    for (size_t m = 1; m < messages.size(); ++m)
+        QVERIFY(messages[m - 1].getSampleOffset() <= messages[m].getSampleOffset());
+}
+
+void TestMidiInputQueue::reservedCapacity()
+{
+    MidiInputQueue queue;
+    for (quint8 note = 60; note < 64; ++note)
+        QVERIFY(queue.push(noteOn(note), NOW - BLOCK_PERIOD / 2));
+
+    std::vector<MidiMessage> messages;
+    messages.reserve(3);
+    const size_t capacity = messages.capacity();
+    queue.consume(messages, NOW, FRAMES, SAMPLE_RATE);
+    QCOMPARE(messages.size(), capacity);
+    QCOMPARE(messages.capacity(), capacity); // not reallocated
+
+    if (capacity < 4) {
+        messages.clear();
+        queue.consume(messages, NOW + BLOCK_PERIOD, FRAMES, SAMPLE_RATE);
+        QCOMPARE(messages.size(), size_t(4) - capacity);
+        QCOMPARE(messages.back().getData1(), 63);
+    }
+}
+
+void TestMidiInputQueue::fullQueue()
+{
+    const size_t capacity = 8;
+    MidiInputQueue queue(capacity);
+
+    size_t pushed = 0;
+    while (pushed < capacity * 4 && queue.push(noteOn(60), NOW))
+        pushed++;
+
+    QVERIFY(pushed >= capacity);
+    QVERIFY(pushed < capacity * 4); // the queue never grows (allocation) in the MIDI thread
+}
+
+void TestMidiInputQueue::invalidBlock()
+{
+    MidiInputQueue queue;
+    QVERIFY(queue.push(noteOn(60), NOW));
+
+    std::vector<MidiMessage> messages;
+    messages.reserve(MAX_MESSAGES_PER_BUFFER);
+    queue.consume(messages, NOW, 0, SAMPLE_RATE);
+    QVERIFY(messages.empty()); // the message is kept to the next block
+
+    queue.consume(messages, NOW, FRAMES, SAMPLE_RATE);
+    QCOMPARE(messages.size(), size_t(1));
+}
@@ -0,0 +1,20 @@
+#ifndef TEST_MIDI_INPUT_QUEUE_H
+#define TEST_MIDI_INPUT_QUEUE_H
+
+#include <QObject>
+
+class TestMidiInputQueue: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void sampleOffset(); // the receiving time is mapped to a sample offset in the next block
+    void sampleOffset_data();
+    void futureMessages(); // messages received while consuming are played in the next block
+    void devicesOrdering(); // messages of all devices are sorted by sample offset
+    void reservedCapacity(); // no allocations, the remaining messages are consumed in the next block
+    void fullQueue();
+    void invalidBlock();
+};
+
+#endif // TEST_MIDI_INPUT_QUEUE_H
@@ -9,6 +9,10 @@ INCLUDEPATH += ../../../src/Common
 VPATH += ../../../src/Common
 
 HEADERS += midi/MidiMessage.h
+HEADERS += midi/MidiInputQueue.h
+HEADERS += TestMidiInputQueue.h
 SOURCES += midi/MidiMessage.cpp
+SOURCES += midi/MidiInputQueue.cpp
+SOURCES += TestMidiInputQueue.cpp
 
 SOURCES += test_MidiMessage.cpp
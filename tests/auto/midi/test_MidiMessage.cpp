@@ -2,6 +2,7 @@
 #include <QtTest/QtTest>
 #include <QString>
 #include "midi/MidiMessage.h"
+#include "TestMidiInputQueue.h"
 
 using namespace midi;
 
@@ -43,8 +44,19 @@ void TestMidiMessage::transpose_data()
 
 int main(int argc, char *argv[])
 {
-    TestMidiMessage test;
-    return QTest::qExec(&test, argc, argv);
+    int status = 0;
+
+    {
+        TestMidiMessage test;
+        status |= QTest::qExec(&test, argc, argv);
+    }
+
+    {
+        TestMidiInputQueue test;
+        status |= QTest::qExec(&test, argc, argv);
+    }
+
+    return status;
 }
 
 #include "test_MidiMessage.moc"
@@ -0,0 +1,124 @@
+#include "AllocationCounter.h"
+
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+thread_local bool counting = false;
+thread_local quint64 allocations = 0;
+thread_local quint64 allocatedBytes = 0;
+
+inline void countAllocation(std::size_t size)
+{
+    if (counting) {
+        allocations++;
+        allocatedBytes += size;
+    }
+}
+
+} // namespace
+
+AllocationCounter::AllocationCounter() :
+    initialAllocations(allocations),
+    initialAllocatedBytes(allocatedBytes),
+    wasCounting(counting)
+{
+    counting = true;
+}
+
+AllocationCounter::~AllocationCounter()
+{
+    counting = wasCounting;
+}
+
+quint64 AllocationCounter::getAllocations() const
+{
+    return allocations - initialAllocations;
+}
+
+quint64 AllocationCounter::getAllocatedBytes() const
+{
+    return allocatedBytes - initialAllocatedBytes;
+}
+
+#ifdef __GLIBC__
+
+// ++++++++++++++++ replaced C allocation functions (operator new is using malloc) ++++++++++++++++
+
+extern "C" {
+
+void *__libc_malloc(std::size_t size);
+void *__libc_calloc(std::size_t count, std::size_t size);
+void *__libc_realloc(void *pointer, std::size_t size);
+
+void *malloc(std::size_t size)
+{
+    countAllocation(size);
+    return __libc_malloc(size);
+}
+
+void *calloc(std::size_t count, std::size_t size)
+{
+    countAllocation(count * size);
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *pointer, std::size_t size)
+{
+    countAllocation(size);
+    return __libc_realloc(pointer, size);
+}
+
+} // extern "C"
+
+bool AllocationCounter::isCountingQtContainers()
+{
+    return true;
+}
+
+#else
+
+// ++++++++++++++++ replaced global allocation functions ++++++++++++++++
+
+void *operator new(std::size_t size)
+{
+    countAllocation(size);
+    void *pointer = std::malloc(size ? size : 1);
+    if (!pointer)
+        throw std::bad_alloc();
+
+    return pointer;
+}
+
+void *operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void *pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete[](void *pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void *pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete[](void *pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+
+bool AllocationCounter::isCountingQtContainers()
+{
+    return false;
+}
+
+#endif // __GLIBC__
@@ -0,0 +1,33 @@
+#ifndef ALLOCATION_COUNTER_H
+#define ALLOCATION_COUNTER_H
+
+#include <QtGlobal>
+
+/**
+    Count the heap allocations made in the current thread while an AllocationCounter is alive.
+
+    With glibc malloc(), calloc() and realloc() are replaced in the benchmark executable, so the
+    allocations made by Qt containers (QByteArray, QString, ...) are counted. In other platforms
+    only the global operator new is replaced and the Qt containers allocations are not counted.
+*/
+
+class AllocationCounter
+{
+public:
+    AllocationCounter();
+    ~AllocationCounter();
+
+    quint64 getAllocations() const;
+    quint64 getAllocatedBytes() const;
+
+    static bool isCountingQtContainers();
+
+private:
+    Q_DISABLE_COPY(AllocationCounter)
+
+    quint64 initialAllocations;
+    quint64 initialAllocatedBytes;
+    bool wasCounting; // counters can be nested
+};
+
+#endif // ALLOCATION_COUNTER_H
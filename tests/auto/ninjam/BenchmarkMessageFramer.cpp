@@ -0,0 +1,134 @@
+#include "BenchmarkMessageFramer.h"
+
+#include "AllocationCounter.h"
+#include "ReplayCapture.h"
+#include "ninjam/MessageFramer.h"
+#include "ninjam/client/ServerMessages.h"
+#include "ninjam/common/CommonMessages.h"
+
+#include <QTest>
+#include <QFile>
+#include <QElapsedTimer>
+#include <QDebug>
+
+using namespace ninjam;
+using namespace ninjam::client;
+
+namespace {
+
+const qint64 MIN_REPLAYED_BYTES = 256 * 1024 * 1024; // the small capture is replayed many times
+
+template<class MessageClazz>
+bool parse(const MessageView &message)
+{
+    MessageClazz msg;
+    NinjamInputDataStream stream(message.getPayload(), message.getPayloadSize());
+    return msg.unserializeFrom(stream);
+}
+
+bool parseMessage(const MessageView &message) // the same messages handled by ServerMessagesHandler
+{
+    switch (message.getMessageType()) {
+    case MessageType::AuthChallenge:
+        return parse<AuthChallengeMessage>(message);
+    case MessageType::AuthReply:
+        return parse<AuthReplyMessage>(message);
+    case MessageType::ServerConfigChangeNotify:
+        return parse<ConfigChangeNotifyMessage>(message);
+    case MessageType::UserInfoChangeNorify:
+        return parse<UserInfoChangeNotifyMessage>(message);
+    case MessageType::KeepAlive:
+        return parse<common::KeepAliveMessage>(message);
+    case MessageType::ChatMessage:
+        return parse<ServerToClientChatMessage>(message);
+    case MessageType::DownloadIntervalBegin:
+        return parse<DownloadIntervalBegin>(message);
+    case MessageType::DownloadIntervalWrite:
+        return parse<DownloadIntervalWrite>(message);
+    default:
+        return false;
+    }
+}
+
+QByteArray loadCapture(const QString &fileName)
+{
+    QFile file(":/wireshark data/" + fileName);
+    if (!file.open(QFile::ReadOnly))
+        return QByteArray();
+
+    return file.readAll();
+}
+
+} // namespace
+
+void BenchmarkMessageFramer::initTestCase()
+{
+    fullServerCapture = loadCapture("full server.data");
+    playersCapture = loadCapture("ninbot 4 players connected.data");
+    roomCapture = ReplayCapture::generate(16, 2, 128, 2).getData();
+
+    QVERIFY(!fullServerCapture.isEmpty());
+    QVERIFY(!playersCapture.isEmpty());
+}
+
+void BenchmarkMessageFramer::replay()
+{
+    QFETCH(int, captureIndex);
+    QFETCH(int, segmentSize);
+    QFETCH(bool, parseMessages);
+
+    const QByteArray *captures[] = {&fullServerCapture, &playersCapture, &roomCapture};
+    const QByteArray &capture = *captures[captureIndex];
+    const int replays = static_cast<int>(qMax(MIN_REPLAYED_BYTES / capture.size(), qint64(1)));
+
+    MessageFramer framer;
+    quint64 messages = 0;
+    bool parsed = true;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    AllocationCounter allocationCounter;
+    for (int r = 0; r < replays; ++r) {
+        framer.clear();
+        for (int offset = 0; offset < capture.size(); offset += segmentSize) {
+            framer.append(capture.constData() + offset, qMin(segmentSize, capture.size() - offset)); // one socket read
+            MessageView message;
+            while (framer.next(message)) {
+                messages++;
+                if (parseMessages)
+                    parsed = parseMessage(message) && parsed;
+            }
+        }
+    }
+
+    const quint64 allocations = allocationCounter.getAllocations();
+    const quint64 allocatedBytes = allocationCounter.getAllocatedBytes();
+    const double seconds = timer.nsecsElapsed() / 1000000000.0;
+
+    QVERIFY(parsed);
+    QVERIFY(messages > 0);
+
+    qInfo().noquote() << QString("%1 messages/s, %2 MB/s, %3 allocations and %4 bytes allocated per message%5")
+                         .arg(messages / seconds, 0, 'f', 0)
+                         .arg(static_cast<double>(capture.size()) * replays / (seconds * 1024 * 1024), 0, 'f', 1)
+                         .arg(static_cast<double>(allocations) / messages, 0, 'f', 2)
+                         .arg(static_cast<double>(allocatedBytes) / messages, 0, 'f', 1)
+                         .arg(AllocationCounter::isCountingQtContainers() ? "" : " (Qt containers not counted)");
+}
+
+void BenchmarkMessageFramer::replay_data()
+{
+    QTest::addColumn<int>("captureIndex");
+    QTest::addColumn<int>("segmentSize");
+    QTest::addColumn<bool>("parseMessages");
+
+    const QStringList captures = {"full server", "4 players", "16 users x 2 channels room"};
+    for (int captureIndex = 0; captureIndex < captures.size(); ++captureIndex) {
+        const QString &capture = captures.at(captureIndex);
+        for (int segmentSize : {1460, 64 * 1024}) { // one TCP segment, one big socket read
+            QTest::newRow(qPrintable(QString("%1, %2 bytes reads, framing").arg(capture).arg(segmentSize))) << captureIndex << segmentSize << false;
+            QTest::newRow(qPrintable(QString("%1, %2 bytes reads, framing + parsing").arg(capture).arg(segmentSize))) << captureIndex << segmentSize << true;
+        }
+    }
+}
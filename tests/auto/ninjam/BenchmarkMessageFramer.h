@@ -0,0 +1,23 @@
+#ifndef BENCHMARKMESSAGEFRAMER_H
+#define BENCHMARKMESSAGEFRAMER_H
+
+#include <QObject>
+#include <QByteArray>
+
+class BenchmarkMessageFramer: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase(); // load the Wireshark captures and generate a synthetic room
+
+    void replay(); // the captures splitted in TCP segments, messages/s and bytes allocated per message
+    void replay_data();
+
+private:
+    QByteArray fullServerCapture;
+    QByteArray playersCapture; // handshake followed by the intervals of 4 players
+    QByteArray roomCapture; // synthetic, 16 users x 2 channels
+};
+
+#endif // BENCHMARKMESSAGEFRAMER_H
@@ -0,0 +1,337 @@
+#include "BenchmarkServer.h"
+
+#include "ClientSwarm.h"
+#include "CpuTime.h"
+#include "ReplayCapture.h"
+#include "ninjam/server/Server.h"
+
+#include <QTest>
+#include <QThread>
+#include <QElapsedTimer>
+#include <QDebug>
+#include <algorithm>
+#include <functional>
+
+using ninjam::server::Server;
+
+namespace {
+
+const int CHUNKS = 100;
+const int CHUNK_SIZE = 1024; // similar to the vorbis chunks sent by the clients
+const int CHUNK_PERIOD = 10; // ms
+const int TIMEOUT = 30000; // ms
+const double LATENCY_BUDGET = 50.0; // ms, the p99 fan-out latency accepted in maxUsers test
+const int ROOM_INTERVALS = 2;
+const qint64 MAX_SPEED_QUEUED_BYTES = 256 * 1024 * 1024; // the clients are not evicted when all intervals are sent at once
+
+// client and server sockets are in the same process, more users can reach the file descriptors limit
+const QList<int> RAMP_USERS = {16, 32, 64, 128, 192, 256, 320, 384, 448};
+
+struct LoadTestResult
+{
+    bool completed = false; // all users received all chunks
+    double averageLatency = 0; // ms
+    double p99Latency = 0;
+    double maxLatency = 0;
+};
+
+bool waitFor(std::function<bool()> condition, int timeout)
+{
+    QElapsedTimer timer;
+    timer.start();
+    while (!condition()) {
+        if (timer.elapsed() > timeout)
+            return false;
+
+        QTest::qWait(5); // processing the server events
+    }
+
+    return true;
+}
+
+/**
+    The fake clients are distributed in some threads, so the clients are not the bottleneck.
+*/
+class Swarms
+{
+public:
+    Swarms(const QElapsedTimer &clock, quint16 port, int users, int channels)
+    {
+        const int swarmsCount = qBound(1, QThread::idealThreadCount() / 2, 4);
+        int firstClientIndex = 0;
+        for (int s = 0; s < swarmsCount; ++s) {
+            auto thread = new QThread();
+            auto swarm = new ClientSwarm(clock);
+            swarm->moveToThread(thread);
+            thread->start();
+
+            const int clients = users / swarmsCount + (s < users % swarmsCount ? 1 : 0);
+            QMetaObject::invokeMethod(swarm, "connectClients", Qt::QueuedConnection,
+                                      Q_ARG(quint16, port), Q_ARG(int, clients), Q_ARG(int, firstClientIndex), Q_ARG(int, channels));
+            firstClientIndex += clients;
+
+            threads.append(thread);
+            swarms.append(swarm);
+        }
+    }
+
+    ~Swarms()
+    {
+        stop();
+    }
+
+    int sum(std::function<int(const ClientSwarm *)> getter) const
+    {
+        int total = 0;
+        for (auto swarm : swarms)
+            total += getter(swarm);
+        return total;
+    }
+
+    qint64 getCpuTime() const
+    {
+        qint64 total = 0;
+        for (auto swarm : swarms)
+            total += swarm->getCpuTime();
+        return total;
+    }
+
+    inline const QList<ClientSwarm *> &getSwarms() const
+    {
+        return swarms;
+    }
+
+    QVector<qint64> stop() // disconnect the clients and return the latencies
+    {
+        for (auto swarm : swarms)
+            QMetaObject::invokeMethod(swarm, "disconnectClients", Qt::QueuedConnection);
+
+        QVector<qint64> latencies;
+        for (int s = 0; s < swarms.size(); ++s) {
+            threads[s]->quit();
+            threads[s]->wait();
+            latencies += swarms[s]->getLatencies();
+            delete swarms[s];
+            delete threads[s];
+        }
+
+        swarms.clear();
+        threads.clear();
+
+        return latencies;
+    }
+
+private:
+    QList<QThread *> threads;
+    QList<ClientSwarm *> swarms;
+};
+
+void computeLatencies(QVector<qint64> &latencies, LoadTestResult &result)
+{
+    if (latencies.isEmpty())
+        return;
+
+    std::sort(latencies.begin(), latencies.end());
+    qint64 total = 0;
+    for (auto latency : latencies)
+        total += latency;
+
+    result.averageLatency = total / (latencies.size() * 1000000.0);
+    result.p99Latency = latencies.at(latencies.size() * 99 / 100) / 1000000.0;
+    result.maxLatency = latencies.last() / 1000000.0;
+}
+
+LoadTestResult runLoadTest(int users, int ioThreads)
+{
+    LoadTestResult result;
+
+    Server server;
+    server.setMaxUsers(users);
+    server.setIOThreads(ioThreads);
+    server.start(0); // any available port
+    if (!server.isStarted())
+        return result;
+
+    QElapsedTimer clock; // shared by all clients, the chunks are timestamped with this clock
+    clock.start();
+
+    Swarms swarms(clock, server.getPort(), users, 1);
+
+    const bool authenticated = waitFor([&]() {
+        return swarms.sum(&ClientSwarm::getAuthenticatedClients) >= users;
+    }, TIMEOUT);
+
+    if (authenticated) {
+        QMetaObject::invokeMethod(swarms.getSwarms().first(), "startUpload", Qt::QueuedConnection,
+                                  Q_ARG(int, CHUNKS), Q_ARG(int, CHUNK_SIZE), Q_ARG(int, CHUNK_PERIOD));
+
+        const int expectedChunks = CHUNKS * (users - 1); // the uploader is not receiving the chunks
+        result.completed = waitFor([&]() {
+            return swarms.sum(&ClientSwarm::getReceivedChunks) >= expectedChunks;
+        }, TIMEOUT);
+    }
+
+    auto latencies = swarms.stop();
+    computeLatencies(latencies, result);
+
+    return result;
+}
+
+} // namespace
+
+void BenchmarkServer::fanOutLatency()
+{
+    QFETCH(int, users);
+    QFETCH(int, ioThreads);
+
+    const auto result = runLoadTest(users, ioThreads);
+
+    QVERIFY(result.completed);
+
+    qInfo().noquote() << QString("%1 users, %2 I/O threads: average %3 ms, p99 %4 ms, max %5 ms")
+                         .arg(users)
+                         .arg(ioThreads)
+                         .arg(result.averageLatency, 0, 'f', 3)
+                         .arg(result.p99Latency, 0, 'f', 3)
+                         .arg(result.maxLatency, 0, 'f', 3);
+}
+
+void BenchmarkServer::fanOutLatency_data()
+{
+    QTest::addColumn<int>("users");
+    QTest::addColumn<int>("ioThreads");
+
+    for (int users : {16, 64, 128}) {
+        for (int ioThreads : {0, 2, 4})
+            QTest::newRow(qPrintable(QString("%1 users, %2 threads").arg(users).arg(ioThreads))) << users << ioThreads;
+    }
+}
+
+void BenchmarkServer::maxUsers()
+{
+    QFETCH(int, ioThreads);
+
+    int maxUsers = 0;
+    for (int users : RAMP_USERS) {
+        const auto result = runLoadTest(users, ioThreads);
+        if (!result.completed || result.p99Latency > LATENCY_BUDGET)
+            break;
+
+        maxUsers = users;
+    }
+
+    qInfo().noquote() << QString("%1 I/O threads: %2 users with p99 fan-out latency < %3 ms (max tested: %4)")
+                         .arg(ioThreads)
+                         .arg(maxUsers)
+                         .arg(LATENCY_BUDGET)
+                         .arg(RAMP_USERS.last());
+}
+
+void BenchmarkServer::maxUsers_data()
+{
+    QTest::addColumn<int>("ioThreads");
+
+    for (int ioThreads : {0, 2, 4})
+        QTest::newRow(qPrintable(QString("%1 threads").arg(ioThreads))) << ioThreads;
+}
+
+void BenchmarkServer::roomReplay()
+{
+    QFETCH(int, users);
+    QFETCH(int, channels);
+    QFETCH(int, bitrate);
+    QFETCH(bool, wallClock);
+    QFETCH(int, ioThreads);
+
+    const qint64 intervalPeriod = ReplayCapture::getIntervalPeriod(ReplayCapture::BPM, ReplayCapture::BPI);
+    const int chunksPerInterval = static_cast<int>(intervalPeriod / (ReplayCapture::CHUNK_PERIOD * Q_INT64_C(1000000)));
+    const int chunkSize = bitrate * ReplayCapture::CHUNK_PERIOD / 8; // kbps * ms / 8 = bytes
+
+    Server server;
+    server.setMaxUsers(users);
+    server.setIOThreads(ioThreads);
+    if (!wallClock)
+        server.setMaxQueuedBytesPerClient(MAX_SPEED_QUEUED_BYTES);
+
+    server.start(0);
+    QVERIFY(server.isStarted());
+
+    QElapsedTimer clock;
+    clock.start();
+
+    Swarms swarms(clock, server.getPort(), users, channels);
+
+    QVERIFY(waitFor([&]() {
+        return swarms.sum(&ClientSwarm::getAuthenticatedClients) >= users;
+    }, TIMEOUT));
+
+    const qint64 initialProcessCpuTime = CpuTime::getProcessTime();
+    const qint64 initialSwarmsCpuTime = swarms.getCpuTime();
+    const qint64 startTime = clock.nsecsElapsed();
+
+    for (auto swarm : swarms.getSwarms()) {
+        QMetaObject::invokeMethod(swarm, "startRoomUpload", Qt::QueuedConnection,
+                                  Q_ARG(int, channels), Q_ARG(int, ROOM_INTERVALS), Q_ARG(int, chunksPerInterval),
+                                  Q_ARG(int, chunkSize), Q_ARG(int, wallClock ? ReplayCapture::CHUNK_PERIOD : 0));
+    }
+
+    const int expectedChunks = users * (users - 1) * channels * chunksPerInterval * ROOM_INTERVALS; // everybody receives the other users chunks
+    const bool completed = waitFor([&]() {
+        return swarms.sum(&ClientSwarm::getReceivedChunks) >= expectedChunks;
+    }, TIMEOUT + static_cast<int>(intervalPeriod * ROOM_INTERVALS / 1000000));
+
+    const double seconds = (clock.nsecsElapsed() - startTime) / 1000000000.0;
+    const qint64 serverCpuTime = (CpuTime::getProcessTime() - initialProcessCpuTime) - (swarms.getCpuTime() - initialSwarmsCpuTime); // the fake clients are in the same process
+    const int disconnectedClients = swarms.sum(&ClientSwarm::getDisconnectedClients);
+
+    LoadTestResult result;
+    auto latencies = swarms.stop();
+    computeLatencies(latencies, result);
+
+    QVERIFY(completed);
+    QCOMPARE(disconnectedClients, 0);
+
+    const double cpuUsage = serverCpuTime / (seconds * 10000000.0); // % of one core
+    const double deliveredBytes = static_cast<double>(expectedChunks) * (chunkSize + ReplayCapture::TIMESTAMP_OFFSET);
+
+    qInfo().noquote() << QString("%1 chunks/s, %2 MB/s delivered, latency average %3 ms, p99 %4 ms, max %5 ms, server CPU %6% (%7% per user)")
+                         .arg(expectedChunks / seconds, 0, 'f', 0)
+                         .arg(deliveredBytes / (seconds * 1024 * 1024), 0, 'f', 1)
+                         .arg(result.averageLatency, 0, 'f', 3)
+                         .arg(result.p99Latency, 0, 'f', 3)
+                         .arg(result.maxLatency, 0, 'f', 3)
+                         .arg(cpuUsage, 0, 'f', 1)
+                         .arg(cpuUsage / users, 0, 'f', 3);
+}
+
+void BenchmarkServer::roomReplay_data()
+{
+    QTest::addColumn<int>("users");
+    QTest::addColumn<int>("channels");
+    QTest::addColumn<int>("bitrate"); // kbps
+    QTest::addColumn<bool>("wallClock");
+    QTest::addColumn<int>("ioThreads");
+
+    struct Room
+    {
+        int users;
+        int channels;
+        int bitrate;
+    };
+
+    const Room rooms[] = {{8, 1, 64}, {16, 2, 128}, {32, 2, 128}};
+
+    for (bool wallClock : {true, false}) {
+        for (const auto &room : rooms) {
+            for (int ioThreads : {0, 4}) {
+                QTest::newRow(qPrintable(QString("%1 users x %2 channels, %3 kbps, %4, %5 threads")
+                                         .arg(room.users)
+                                         .arg(room.channels)
+                                         .arg(room.bitrate)
+                                         .arg(wallClock ? "wall-clock" : "max speed")
+                                         .arg(ioThreads)))
+                        << room.users << room.channels << room.bitrate << wallClock << ioThreads;
+            }
+        }
+    }
+}
@@ -0,0 +1,21 @@
+#ifndef BENCHMARKSERVER_H
+#define BENCHMARKSERVER_H
+
+#include <QObject>
+
+class BenchmarkServer: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void fanOutLatency(); // one user uploading an interval, the chunks are broadcasted to all other users
+    void fanOutLatency_data();
+
+    void maxUsers(); // increasing the users until the fan-out latency is bigger than the budget
+    void maxUsers_data();
+
+    void roomReplay(); // N users x M channels uploading intervals in some bitrate, in wall-clock or max speed
+    void roomReplay_data();
+};
+
+#endif // BENCHMARKSERVER_H
@@ -0,0 +1,164 @@
+#include "BenchmarkService.h"
+
+#include "AllocationCounter.h"
+#include "CaptureServer.h"
+#include "CpuTime.h"
+#include "ReplayCapture.h"
+#include "ninjam/client/Service.h"
+#include "ninjam/client/Types.h"
+
+#include <QTest>
+#include <QFile>
+#include <QThread>
+#include <QElapsedTimer>
+#include <QDebug>
+#include <QtEndian>
+#include <algorithm>
+
+using ninjam::client::Service;
+using ninjam::client::ChannelMetadata;
+
+namespace {
+
+const int TIMEOUT = 30000; // ms, added to the capture duration
+const int SYNTHETIC_INTERVALS = 2;
+
+QByteArray loadCapture(const QString &fileName)
+{
+    QFile file(":/wireshark data/" + fileName);
+    if (!file.open(QFile::ReadOnly))
+        return QByteArray();
+
+    return file.readAll();
+}
+
+} // namespace
+
+void BenchmarkService::initTestCase()
+{
+    playersCapture = loadCapture("ninbot 4 players connected.data");
+
+    QVERIFY(!playersCapture.isEmpty());
+}
+
+void BenchmarkService::replay()
+{
+    QFETCH(int, users); // 0 is the Wireshark capture
+    QFETCH(int, channels);
+    QFETCH(int, bitrate);
+    QFETCH(bool, wallClock);
+
+    const ReplayCapture capture = users ? ReplayCapture::generate(users, channels, bitrate, SYNTHETIC_INTERVALS)
+                                        : ReplayCapture::fromWiresharkData(playersCapture);
+
+    QElapsedTimer clock; // shared with the capture server, the chunks are timestamped with this clock
+    clock.start();
+
+    QThread serverThread;
+    auto captureServer = new CaptureServer(capture, clock, wallClock);
+    captureServer->moveToThread(&serverThread);
+    connect(&serverThread, &QThread::finished, captureServer, &QObject::deleteLater);
+    serverThread.start();
+
+    QMetaObject::invokeMethod(captureServer, "listen", Qt::BlockingQueuedConnection);
+    if (!captureServer->getPort()) {
+        serverThread.quit();
+        serverThread.wait();
+        QFAIL("Capture server is not listening");
+    }
+
+    Service service;
+
+    QVector<qint64> latencies;
+    int chunks = 0;
+    bool closed = false;
+
+    connect(&service, &Service::audioIntervalDownloading, this, [&](const ninjam::client::User &, quint8, const QByteArray &encodedData, bool, bool) {
+        chunks++;
+        if (wallClock && encodedData.size() >= static_cast<int>(sizeof(qint64))) {
+            const qint64 timestamp = qFromLittleEndian<qint64>(reinterpret_cast<const uchar *>(encodedData.constData()));
+            latencies.append(clock.nsecsElapsed() - timestamp);
+        }
+    });
+
+    // the server closing the connection after the last message is reported as an error
+    connect(&service, &Service::error, this, [&]() { closed = true; });
+    connect(&service, &Service::disconnectedFromServer, this, [&]() { closed = true; });
+
+    const qint64 initialCpuTime = CpuTime::getThreadTime(); // the Service is running in this thread
+    const qint64 startTime = clock.nsecsElapsed();
+
+    AllocationCounter allocationCounter; // the Service thread allocations, including the Qt event loop and sockets
+    service.startServerConnection("127.0.0.1", captureServer->getPort(), "benchmark", {ChannelMetadata{"channel", false}});
+
+    const qint64 timeout = TIMEOUT + capture.getDuration() / 1000000;
+    while (!closed && (clock.nsecsElapsed() - startTime) / 1000000 < timeout)
+        QTest::qWait(1);
+
+    const quint64 allocations = allocationCounter.getAllocations();
+    const quint64 allocatedBytes = allocationCounter.getAllocatedBytes();
+    const double seconds = (clock.nsecsElapsed() - startTime) / 1000000000.0;
+    const qint64 cpuTime = CpuTime::getThreadTime() - initialCpuTime;
+    const bool finished = captureServer->isFinished();
+
+    QMetaObject::invokeMethod(captureServer, "stop", Qt::BlockingQueuedConnection);
+    serverThread.quit();
+    serverThread.wait();
+
+    QVERIFY(closed);
+    QVERIFY(finished);
+    if (users)
+        QCOMPARE(chunks, capture.getIntervalWrites()); // all synthetic chunks are in active channels
+
+    const int messages = capture.getMessages().size();
+    const double cpuUsage = cpuTime / (seconds * 10000000.0); // % of one core
+
+    qInfo().noquote() << QString("%1 messages/s, %2 MB/s, %3 allocations and %4 bytes allocated per message%5, Service CPU %6% (%7% per remote user)")
+                         .arg(messages / seconds, 0, 'f', 0)
+                         .arg(capture.getData().size() / (seconds * 1024 * 1024), 0, 'f', 2)
+                         .arg(static_cast<double>(allocations) / messages, 0, 'f', 2)
+                         .arg(static_cast<double>(allocatedBytes) / messages, 0, 'f', 1)
+                         .arg(AllocationCounter::isCountingQtContainers() ? "" : " (Qt containers not counted)")
+                         .arg(cpuUsage, 0, 'f', 1)
+                         .arg(cpuUsage / qMax(capture.getUsers(), 1), 0, 'f', 3);
+
+    if (!latencies.isEmpty()) {
+        std::sort(latencies.begin(), latencies.end());
+        qint64 total = 0;
+        for (auto latency : latencies)
+            total += latency;
+
+        qInfo().noquote() << QString("%1 chunks, latency average %2 ms, p99 %3 ms, max %4 ms")
+                             .arg(latencies.size())
+                             .arg(total / (latencies.size() * 1000000.0), 0, 'f', 3)
+                             .arg(latencies.at(latencies.size() * 99 / 100) / 1000000.0, 0, 'f', 3)
+                             .arg(latencies.last() / 1000000.0, 0, 'f', 3);
+    }
+}
+
+void BenchmarkService::replay_data()
+{
+    QTest::addColumn<int>("users");
+    QTest::addColumn<int>("channels");
+    QTest::addColumn<int>("bitrate"); // kbps
+    QTest::addColumn<bool>("wallClock");
+
+    struct Room
+    {
+        int users;
+        int channels;
+        int bitrate;
+    };
+
+    const Room rooms[] = {{0, 0, 0}, {4, 1, 64}, {8, 2, 128}, {32, 2, 128}};
+
+    for (bool wallClock : {true, false}) {
+        const QString speed = wallClock ? "wall-clock" : "max speed";
+        for (const auto &room : rooms) {
+            const QString name = room.users ? QString("%1 users x %2 channels, %3 kbps").arg(room.users).arg(room.channels).arg(room.bitrate)
+                                            : QString("4 players capture");
+
+            QTest::newRow(qPrintable(QString("%1, %2").arg(name, speed))) << room.users << room.channels << room.bitrate << wallClock;
+        }
+    }
+}
@@ -0,0 +1,22 @@
+#ifndef BENCHMARKSERVICE_H
+#define BENCHMARKSERVICE_H
+
+#include <QObject>
+#include <QByteArray>
+
+class BenchmarkService: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase(); // load the Wireshark captures
+
+    // the capture or a synthetic room (N users x M channels x bitrate) replayed to the ninjam::client::Service over loopback
+    void replay();
+    void replay_data();
+
+private:
+    QByteArray playersCapture;
+};
+
+#endif // BENCHMARKSERVICE_H
@@ -0,0 +1,118 @@
+#include "CaptureServer.h"
+
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QtEndian>
+
+namespace {
+
+const int REPLAY_PERIOD = 1; // ms
+
+} // namespace
+
+CaptureServer::CaptureServer(const ReplayCapture &capture, const QElapsedTimer &clock, bool wallClock) :
+    capture(capture),
+    clock(clock),
+    wallClock(wallClock),
+    server(nullptr),
+    socket(nullptr),
+    replayTimer(nullptr),
+    nextMessage(0),
+    startTime(0),
+    port(0),
+    finished(false)
+{
+
+}
+
+quint16 CaptureServer::getPort() const
+{
+    return port.load();
+}
+
+bool CaptureServer::isFinished() const
+{
+    return finished.load();
+}
+
+void CaptureServer::listen()
+{
+    server = new QTcpServer(this);
+
+    connect(server, &QTcpServer::newConnection, this, [=]() {
+        if (socket) // only one client
+            return;
+
+        socket = server->nextPendingConnection();
+        socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+        connect(socket, &QTcpSocket::readyRead, socket, [=]() {
+            socket->readAll(); // the client messages are not used
+        });
+
+        startReplay();
+    });
+
+    if (server->listen(QHostAddress::LocalHost, 0))
+        port = server->serverPort();
+}
+
+void CaptureServer::startReplay()
+{
+    nextMessage = 0;
+    startTime = clock.nsecsElapsed();
+
+    if (!wallClock) {
+        socket->write(capture.getData());
+        nextMessage = capture.getMessages().size();
+        socket->disconnectFromHost(); // the written bytes are sent before closing
+        finished = true;
+        return;
+    }
+
+    replayTimer = new QTimer(this);
+    replayTimer->setTimerType(Qt::PreciseTimer);
+    connect(replayTimer, &QTimer::timeout, this, &CaptureServer::replayMessages);
+    replayTimer->start(REPLAY_PERIOD);
+
+    replayMessages(); // the handshake
+}
+
+void CaptureServer::replayMessages()
+{
+    const auto &messages = capture.getMessages();
+    const qint64 replayTime = clock.nsecsElapsed() - startTime;
+
+    QByteArray messagesData;
+    while (nextMessage < messages.size() && messages.at(nextMessage).time <= replayTime) {
+        const auto &message = messages.at(nextMessage++);
+        const int position = messagesData.size();
+        messagesData.append(capture.getData().constData() + message.offset, message.size);
+
+        if (message.intervalWrite && message.size >= ReplayCapture::TIMESTAMP_OFFSET + static_cast<int>(sizeof(qint64))) {
+            uchar *encodedData = reinterpret_cast<uchar *>(messagesData.data() + position + ReplayCapture::TIMESTAMP_OFFSET);
+            qToLittleEndian<qint64>(clock.nsecsElapsed(), encodedData);
+        }
+    }
+
+    if (!messagesData.isEmpty())
+        socket->write(messagesData);
+
+    if (nextMessage >= messages.size()) {
+        replayTimer->stop();
+        socket->disconnectFromHost();
+        finished = true;
+    }
+}
+
+void CaptureServer::stop()
+{
+    if (replayTimer)
+        replayTimer->stop();
+
+    if (socket)
+        socket->abort();
+
+    if (server)
+        server->close();
+}
@@ -0,0 +1,56 @@
+#ifndef CAPTURESERVER_H
+#define CAPTURESERVER_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <atomic>
+
+#include "ReplayCapture.h"
+
+class QTcpServer;
+class QTcpSocket;
+class QTimer;
+
+/**
+    Fake ninjam server used to replay a ReplayCapture to a ninjam::client::Service over loopback.
+    The server lives in a separated thread, the bytes sent by the client are discarded.
+
+    In wall-clock replays the messages are sent in the capture times and the DownloadIntervalWrite
+    encoded data is timestamped (ns) when the message is written in the socket. In max speed
+    replays the entire capture is written at once. The connection is closed after the last message.
+*/
+
+class CaptureServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    CaptureServer(const ReplayCapture &capture, const QElapsedTimer &clock, bool wallClock);
+
+    quint16 getPort() const; // thread safe, valid after listen()
+    bool isFinished() const; // thread safe, all messages are written
+
+public slots:
+    void listen(); // loopback, any available port
+    void stop();
+
+private:
+    void startReplay();
+    void replayMessages(); // write the messages until the current time
+
+    const ReplayCapture &capture;
+    const QElapsedTimer &clock;
+    const bool wallClock;
+
+    QTcpServer *server;
+    QTcpSocket *socket;
+    QTimer *replayTimer;
+
+    int nextMessage;
+    qint64 startTime;
+
+    std::atomic<quint16> port;
+    std::atomic<bool> finished;
+};
+
+#endif // CAPTURESERVER_H
@@ -0,0 +1,261 @@
+#include "ClientSwarm.h"
+
+#include <QTcpSocket>
+#include <QTimer>
+#include <QtEndian>
+
+#include "ninjam/Ninjam.h"
+#include "ninjam/client/ClientMessages.h"
+#include "ninjam/client/Types.h"
+#include "CpuTime.h"
+
+using ninjam::MessageType;
+using ninjam::MessageGuid;
+using ninjam::client::ClientAuthUserMessage;
+using ninjam::client::ClientSetChannel;
+using ninjam::client::ChannelMetadata;
+using ninjam::client::UploadIntervalBegin;
+using ninjam::client::UploadIntervalWrite;
+
+namespace {
+
+const int HEADER_SIZE = 5;
+const int GUID_SIZE = 16;
+const int TIMESTAMP_OFFSET = GUID_SIZE + 1; // DownloadIntervalWrite payload = GUID + flags + encoded data
+
+MessageGuid buildGuid(int clientIndex, int channel, int interval)
+{
+    MessageGuid guid;
+    guid.fill('g'); // first and last bytes are not '0', the '0' GUIDs are used to stop the download
+    qToLittleEndian<qint32>(clientIndex, reinterpret_cast<uchar *>(guid.data() + 1));
+    qToLittleEndian<qint32>(channel, reinterpret_cast<uchar *>(guid.data() + 5));
+    qToLittleEndian<qint32>(interval, reinterpret_cast<uchar *>(guid.data() + 9));
+    return guid;
+}
+
+} // namespace
+
+ClientSwarm::ClientSwarm(const QElapsedTimer &clock) :
+    clock(clock),
+    uploadTimer(nullptr),
+    authenticatedClients(0),
+    receivedChunks(0),
+    disconnectedClients(0),
+    cpuTime(0)
+{
+
+}
+
+ClientSwarm::~ClientSwarm()
+{
+    qDeleteAll(clients);
+}
+
+int ClientSwarm::getAuthenticatedClients() const
+{
+    return authenticatedClients.load();
+}
+
+int ClientSwarm::getReceivedChunks() const
+{
+    return receivedChunks.load();
+}
+
+int ClientSwarm::getDisconnectedClients() const
+{
+    return disconnectedClients.load();
+}
+
+qint64 ClientSwarm::getCpuTime() const
+{
+    return cpuTime.load();
+}
+
+void ClientSwarm::sampleCpuTime()
+{
+    cpuTime = CpuTime::getThreadTime();
+}
+
+QVector<qint64> ClientSwarm::getLatencies() const
+{
+    return latencies;
+}
+
+void ClientSwarm::connectClients(quint16 port, int clientsCount, int firstClientIndex, int channels)
+{
+    for (int c = 0; c < clientsCount; ++c) {
+        auto client = new Client{new QTcpSocket(this), firstClientIndex + c, 0, 0, false};
+        clients.append(client);
+
+        connect(client->socket, &QTcpSocket::connected, this, [=]() {
+            sendAuthentication(client, channels);
+        });
+
+        connect(client->socket, &QTcpSocket::readyRead, this, [=]() {
+            readMessages(client);
+        });
+
+        connect(client->socket, &QTcpSocket::disconnected, this, [=]() {
+            disconnectedClients++;
+        });
+
+        client->socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+        client->socket->connectToHost("127.0.0.1", port);
+    }
+}
+
+void ClientSwarm::sendAuthentication(Client *client, int channels)
+{
+    QList<ChannelMetadata> channelsMetadata;
+    for (int c = 0; c < channels; ++c)
+        channelsMetadata.append(ChannelMetadata{QString("channel %1").arg(c), false});
+
+    // the server is not checking the challenge and the password
+    QByteArray messagesData;
+    ClientAuthUserMessage(QString("user%1").arg(client->index), QByteArray(8, 'x'), 0x00020000, QString()).serializeToBuffer(messagesData);
+    ClientSetChannel(channelsMetadata).serializeToBuffer(messagesData);
+
+    client->socket->write(messagesData);
+}
+
+void ClientSwarm::readMessages(Client *client)
+{
+    QTcpSocket *socket = client->socket;
+
+    forever {
+        if (!client->waitingPayload) {
+            if (socket->bytesAvailable() < HEADER_SIZE)
+                break;
+
+            uchar header[HEADER_SIZE];
+            socket->read(reinterpret_cast<char *>(header), HEADER_SIZE);
+            client->messageType = header[0];
+            client->payload = qFromLittleEndian<quint32>(header + 1);
+            client->waitingPayload = true;
+        }
+
+        if (socket->bytesAvailable() < client->payload)
+            break;
+
+        const QByteArray payload = socket->read(client->payload);
+        client->waitingPayload = false;
+
+        switch (static_cast<MessageType>(client->messageType)) {
+        case MessageType::AuthReply:
+            authenticatedClients++;
+            break;
+        case MessageType::DownloadIntervalWrite:
+            if (payload.size() >= TIMESTAMP_OFFSET + static_cast<int>(sizeof(qint64))) {
+                const qint64 timestamp = qFromLittleEndian<qint64>(reinterpret_cast<const uchar *>(payload.constData() + TIMESTAMP_OFFSET));
+                latencies.append(clock.nsecsElapsed() - timestamp);
+                receivedChunks++;
+            }
+            break;
+        default:
+            break; // other messages are ignored
+        }
+    }
+
+    sampleCpuTime();
+}
+
+void ClientSwarm::startUpload(int chunks, int chunkSize, int chunkPeriod)
+{
+    if (clients.isEmpty())
+        return;
+
+    QTcpSocket *socket = clients.first()->socket;
+
+    MessageGuid guid(QByteArray(GUID_SIZE, 'g'));
+    QByteArray beginData;
+    UploadIntervalBegin(guid, 0, true).serializeToBuffer(beginData);
+    socket->write(beginData);
+
+    if (!uploadTimer) {
+        uploadTimer = new QTimer(this);
+        uploadTimer->setTimerType(Qt::PreciseTimer);
+    }
+
+    uploadTimer->disconnect();
+
+    int sentChunks = 0;
+    connect(uploadTimer, &QTimer::timeout, this, [=]() mutable {
+        QByteArray encodedData(qMax(chunkSize, static_cast<int>(sizeof(qint64))), 'v');
+        qToLittleEndian<qint64>(clock.nsecsElapsed(), reinterpret_cast<uchar *>(encodedData.data()));
+
+        QByteArray messageData;
+        const bool lastPart = ++sentChunks >= chunks;
+        UploadIntervalWrite(guid, encodedData, lastPart).serializeToBuffer(messageData);
+        socket->write(messageData);
+
+        if (lastPart)
+            uploadTimer->stop();
+    });
+
+    uploadTimer->start(chunkPeriod);
+}
+
+void ClientSwarm::startRoomUpload(int channels, int intervals, int chunksPerInterval, int chunkSize, int chunkPeriod)
+{
+    const int chunks = intervals * chunksPerInterval;
+
+    if (chunkPeriod <= 0) { // max speed, all intervals are written in the sockets now
+        for (int chunk = 0; chunk < chunks; ++chunk)
+            uploadRoomChunk(chunk, channels, chunksPerInterval, chunkSize);
+
+        sampleCpuTime();
+        return;
+    }
+
+    if (!uploadTimer) {
+        uploadTimer = new QTimer(this);
+        uploadTimer->setTimerType(Qt::PreciseTimer);
+    }
+
+    uploadTimer->disconnect();
+
+    int sentChunks = 0;
+    connect(uploadTimer, &QTimer::timeout, this, [=]() mutable {
+        uploadRoomChunk(sentChunks, channels, chunksPerInterval, chunkSize);
+        if (++sentChunks >= chunks)
+            uploadTimer->stop();
+
+        sampleCpuTime();
+    });
+
+    uploadTimer->start(chunkPeriod);
+}
+
+void ClientSwarm::uploadRoomChunk(int chunk, int channels, int chunksPerInterval, int chunkSize)
+{
+    const int interval = chunk / chunksPerInterval;
+    const bool firstPart = chunk % chunksPerInterval == 0;
+    const bool lastPart = chunk % chunksPerInterval == chunksPerInterval - 1;
+
+    QByteArray encodedData(qMax(chunkSize, static_cast<int>(sizeof(qint64))), 'v');
+
+    for (auto client : qAsConst(clients)) {
+        QByteArray messagesData;
+        for (int c = 0; c < channels; ++c) {
+            const MessageGuid guid = buildGuid(client->index, c, interval);
+            if (firstPart)
+                UploadIntervalBegin(guid, static_cast<quint8>(c), true).serializeToBuffer(messagesData);
+
+            qToLittleEndian<qint64>(clock.nsecsElapsed(), reinterpret_cast<uchar *>(encodedData.data()));
+            UploadIntervalWrite(guid, encodedData, lastPart).serializeToBuffer(messagesData);
+        }
+
+        client->socket->write(messagesData);
+    }
+}
+
+void ClientSwarm::disconnectClients()
+{
+    if (uploadTimer)
+        uploadTimer->stop();
+
+    for (auto client : clients) {
+        client->socket->disconnect(this);
+        client->socket->abort();
+    }
+}
@@ -0,0 +1,73 @@
+#ifndef CLIENTSWARM_H
+#define CLIENTSWARM_H
+
+#include <QObject>
+#include <QVector>
+#include <QList>
+#include <QElapsedTimer>
+#include <atomic>
+
+class QTcpSocket;
+class QTimer;
+
+/**
+    Fake ninjam clients used in server load tests. The swarm lives in a separated thread and
+    speaks just the necessary protocol: authentication, channel setup and interval upload.
+
+    The first client of a swarm can upload an interval, or all clients can upload all channels
+    (a room replay). The chunks carry a timestamp (ns) in the first bytes and the other clients
+    (in all swarms) compute the fan-out latency when the DownloadIntervalWrite is received.
+*/
+
+class ClientSwarm : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ClientSwarm(const QElapsedTimer &clock);
+    ~ClientSwarm();
+
+    // thread safe, used to wait the swarm
+    int getAuthenticatedClients() const;
+    int getReceivedChunks() const;
+    int getDisconnectedClients() const;
+    qint64 getCpuTime() const; // ns, the swarm thread CPU time sampled after each socket read and upload
+
+
+    QVector<qint64> getLatencies() const; // call when the expected chunks are received
+
+public slots:
+    void connectClients(quint16 port, int clients, int firstClientIndex, int channels); // the index is used in user names
+    void startUpload(int chunks, int chunkSize, int chunkPeriod); // ms
+    void startRoomUpload(int channels, int intervals, int chunksPerInterval, int chunkSize, int chunkPeriod); // all clients, chunkPeriod 0 is max speed
+    void disconnectClients();
+
+private:
+    struct Client
+    {
+        QTcpSocket *socket;
+        int index;
+        quint8 messageType;
+        quint32 payload; // payload of the current incomplete message
+        bool waitingPayload;
+    };
+
+    void sendAuthentication(Client *client, int channels);
+    void readMessages(Client *client);
+    void uploadRoomChunk(int chunk, int channels, int chunksPerInterval, int chunkSize);
+    void sampleCpuTime();
+
+    const QElapsedTimer &clock;
+
+    QList<Client *> clients;
+    QTimer *uploadTimer;
+
+    QVector<qint64> latencies;
+
+    std::atomic<int> authenticatedClients;
+    std::atomic<int> receivedChunks;
+    std::atomic<int> disconnectedClients;
+    std::atomic<qint64> cpuTime;
+};
+
+#endif // CLIENTSWARM_H
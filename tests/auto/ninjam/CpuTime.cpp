@@ -0,0 +1,65 @@
+#include "CpuTime.h"
+
+#ifdef Q_OS_WIN
+    #include <windows.h>
+#else
+    #include <time.h>
+#endif
+
+namespace {
+
+#ifdef Q_OS_WIN
+
+qint64 toNanoseconds(const FILETIME &kernelTime, const FILETIME &userTime) // FILETIME is in 100 ns units
+{
+    ULARGE_INTEGER kernel;
+    kernel.LowPart = kernelTime.dwLowDateTime;
+    kernel.HighPart = kernelTime.dwHighDateTime;
+
+    ULARGE_INTEGER user;
+    user.LowPart = userTime.dwLowDateTime;
+    user.HighPart = userTime.dwHighDateTime;
+
+    return static_cast<qint64>(kernel.QuadPart + user.QuadPart) * 100;
+}
+
+#else
+
+qint64 getClockTime(clockid_t clock)
+{
+    timespec time;
+    if (clock_gettime(clock, &time) != 0)
+        return -1;
+
+    return static_cast<qint64>(time.tv_sec) * 1000000000 + time.tv_nsec;
+}
+
+#endif
+
+} // namespace
+
+qint64 CpuTime::getProcessTime()
+{
+#ifdef Q_OS_WIN
+    FILETIME creationTime, exitTime, kernelTime, userTime;
+    if (!GetProcessTimes(GetCurrentProcess(), &creationTime, &exitTime, &kernelTime, &userTime))
+        return -1;
+
+    return toNanoseconds(kernelTime, userTime);
+#else
+    return getClockTime(CLOCK_PROCESS_CPUTIME_ID);
+#endif
+}
+
+qint64 CpuTime::getThreadTime()
+{
+#ifdef Q_OS_WIN
+    FILETIME creationTime, exitTime, kernelTime, userTime;
+    if (!GetThreadTimes(GetCurrentThread(), &creationTime, &exitTime, &kernelTime, &userTime))
+        return -1;
+
+    return toNanoseconds(kernelTime, userTime);
+#else
+    return getClockTime(CLOCK_THREAD_CPUTIME_ID);
+#endif
+}
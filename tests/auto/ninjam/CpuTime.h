@@ -0,0 +1,18 @@
+#ifndef CPUTIME_H
+#define CPUTIME_H
+
+#include <QtGlobal>
+
+/**
+    CPU time (user + system) consumed by the process or by the calling thread, used to compute
+    the CPU per connected user in the load benchmarks. Returns -1 when not supported.
+*/
+
+class CpuTime
+{
+public:
+    static qint64 getProcessTime(); // ns
+    static qint64 getThreadTime(); // ns, the calling thread
+};
+
+#endif // CPUTIME_H
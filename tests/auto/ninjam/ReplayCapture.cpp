@@ -0,0 +1,196 @@
+#include "ReplayCapture.h"
+
+#include "ninjam/MessageFramer.h"
+#include "ninjam/client/ServerMessages.h"
+#include "ninjam/client/UserChannel.h"
+#include "ninjam/common/CommonMessages.h"
+
+#include <QMap>
+#include <QSet>
+#include <QtEndian>
+
+using namespace ninjam;
+using namespace ninjam::client;
+
+const quint16 ReplayCapture::BPM = 120;
+const quint16 ReplayCapture::BPI = 8;
+const int ReplayCapture::CHUNK_PERIOD = 50;
+const int ReplayCapture::TIMESTAMP_OFFSET = 5 + 16 + 1;
+
+namespace {
+
+const quint16 DEFAULT_BPM = 120; // captures without ConfigChangeNotify
+const quint16 DEFAULT_BPI = 16;
+
+template<class MessageClazz>
+MessageClazz parse(const MessageView &message)
+{
+    MessageClazz msg;
+    NinjamInputDataStream stream(message.getPayload(), message.getPayloadSize());
+    msg.unserializeFrom(stream);
+    return msg;
+}
+
+MessageGuid buildGuid(int interval, int user, int channel)
+{
+    MessageGuid guid;
+    guid.fill('g'); // first and last bytes are not '0', the '0' GUIDs are used to stop the download
+    qToLittleEndian<qint32>(interval, reinterpret_cast<uchar *>(guid.data() + 1));
+    qToLittleEndian<qint32>(user, reinterpret_cast<uchar *>(guid.data() + 5));
+    qToLittleEndian<qint32>(channel, reinterpret_cast<uchar *>(guid.data() + 9));
+    return guid;
+}
+
+QByteArray buildEncodedData(int size) // not compressible, as the Vorbis data
+{
+    QByteArray encodedData(size, 0);
+    quint32 seed = 0x12345678;
+    for (int i = 0; i < size; ++i) {
+        seed = seed * 1664525 + 1013904223;
+        encodedData[i] = static_cast<char>(seed >> 24);
+    }
+    return encodedData;
+}
+
+QByteArray serialize(const INetworkMessage &message)
+{
+    QByteArray messageData;
+    message.serializeToBuffer(messageData);
+    return messageData;
+}
+
+} // namespace
+
+ReplayCapture::ReplayCapture() :
+    intervalWrites(0),
+    users(0)
+{
+
+}
+
+qint64 ReplayCapture::getIntervalPeriod(quint16 bpm, quint16 bpi)
+{
+    return Q_INT64_C(60000000000) * bpi / qMax(bpm, quint16(1));
+}
+
+void ReplayCapture::append(qint64 time, const QByteArray &messageData, bool intervalWrite)
+{
+    messages.append(Message{time, data.size(), messageData.size(), intervalWrite});
+    data.append(messageData);
+
+    if (intervalWrite)
+        intervalWrites++;
+}
+
+ReplayCapture ReplayCapture::fromWiresharkData(const QByteArray &data)
+{
+    ReplayCapture capture;
+
+    // first pass: message boundaries, intervals and the bytes used to spread the messages in the intervals
+    MessageFramer framer;
+    framer.append(data.constData(), data.size());
+
+    quint16 bpm = DEFAULT_BPM;
+    quint16 bpi = DEFAULT_BPI;
+    QMap<QString, int> intervals; // user name + channel index
+    QSet<QString> users;
+    qint64 intervalBytes = 0;
+    int offset = 0;
+
+    MessageView message;
+    while (framer.next(message)) {
+        const int size = MessageFramer::HEADER_SIZE + static_cast<int>(message.getPayloadSize());
+        const bool intervalWrite = message.getMessageType() == MessageType::DownloadIntervalWrite;
+
+        if (message.getMessageType() == MessageType::ServerConfigChangeNotify) {
+            const auto msg = parse<ConfigChangeNotifyMessage>(message);
+            if (msg.getBpm() && msg.getBpi()) {
+                bpm = msg.getBpm();
+                bpi = msg.getBpi();
+            }
+        }
+        else if (message.getMessageType() == MessageType::DownloadIntervalBegin) {
+            const auto msg = parse<DownloadIntervalBegin>(message);
+            intervals[QString("%1/%2").arg(msg.getUserName()).arg(msg.getChannelIndex())]++;
+            users.insert(msg.getUserName());
+        }
+        else if (intervalWrite) {
+            intervalBytes += size;
+        }
+
+        capture.messages.append(Message{0, offset, size, intervalWrite});
+        offset += size;
+    }
+
+    int capturedIntervals = 1;
+    for (int channelIntervals : intervals)
+        capturedIntervals = qMax(capturedIntervals, channelIntervals);
+
+    const qint64 duration = getIntervalPeriod(bpm, bpi) * capturedIntervals;
+
+    qint64 sentIntervalBytes = 0;
+    for (auto &msg : capture.messages) {
+        if (msg.intervalWrite) {
+            sentIntervalBytes += msg.size;
+            capture.intervalWrites++;
+        }
+
+        msg.time = intervalBytes ? duration * sentIntervalBytes / intervalBytes : 0;
+    }
+
+    capture.data = data.left(offset); // the last incomplete message is discarded
+    capture.users = users.size();
+
+    return capture;
+}
+
+ReplayCapture ReplayCapture::generate(int users, int channels, int bitrate, int intervals)
+{
+    ReplayCapture capture;
+    capture.users = users;
+
+    const qint64 intervalPeriod = getIntervalPeriod(BPM, BPI);
+    const qint64 chunkPeriod = CHUNK_PERIOD * Q_INT64_C(1000000);
+    const int chunks = static_cast<int>(intervalPeriod / chunkPeriod);
+    const QByteArray encodedData = buildEncodedData(qMax(bitrate * CHUNK_PERIOD / 8, 8)); // kbps * ms / 8 = bytes
+
+    auto getUserName = [](int user) {
+        return QString("user%1@127.0.0.1").arg(user);
+    };
+
+    // handshake, as in the ninjam::server::Server
+    UserInfoChangeNotifyMessage usersInfo;
+    for (int u = 0; u < users; ++u) {
+        for (int c = 0; c < channels; ++c)
+            usersInfo.addUserChannel(getUserName(u), UserChannel(QString("channel %1").arg(c), static_cast<quint8>(c), UserChannel::Flags::Intervalic, true));
+    }
+
+    capture.append(0, serialize(AuthChallengeMessage(QByteArray("abcdabcd"), QString(), 30 << 8, 0x00020000)), false);
+    capture.append(0, serialize(AuthReplyMessage(1, "benchmark@127.0.0.1", 32)), false);
+    capture.append(0, serialize(ConfigChangeNotifyMessage(BPM, BPI)), false);
+    capture.append(0, serialize(usersInfo), false);
+    capture.append(0, serialize(ServerToClientChatMessage::buildTopicMessage("synthetic room")), false);
+
+    const MessageFourCC fourCC = {'O', 'G', 'G', 'v'};
+    for (int i = 0; i < intervals; ++i) {
+        const qint64 intervalStart = intervalPeriod * i;
+
+        capture.append(intervalStart, serialize(common::KeepAliveMessage()), false);
+
+        for (int u = 0; u < users; ++u) {
+            for (int c = 0; c < channels; ++c)
+                capture.append(intervalStart, serialize(DownloadIntervalBegin(buildGuid(i, u, c), 0, fourCC, static_cast<quint8>(c), getUserName(u))), false);
+        }
+
+        for (int chunk = 0; chunk < chunks; ++chunk) {
+            const qint64 time = intervalStart + chunkPeriod * (chunk + 1);
+            const quint8 flags = chunk == chunks - 1 ? 1 : 0; // the last chunk completes the interval
+            for (int u = 0; u < users; ++u) {
+                for (int c = 0; c < channels; ++c)
+                    capture.append(time, serialize(DownloadIntervalWrite(buildGuid(i, u, c), flags, encodedData)), true);
+            }
+        }
+    }
+
+    return capture;
+}
@@ -0,0 +1,77 @@
+#ifndef REPLAYCAPTURE_H
+#define REPLAYCAPTURE_H
+
+#include <QByteArray>
+#include <QVector>
+
+/**
+    A server to client NINJAM stream (the bytes received by ninjam::client::Service) used in the
+    replay benchmarks. Every message has a time (ns, relative to the replay start) to replay the
+    stream in wall-clock speed.
+
+    The Wireshark captures have no timestamps, the messages are spread in the captured intervals
+    (using the captured BPM and BPI) proportionally to the interval data sent before them, as in a
+    constant bitrate stream.
+
+    The synthetic captures are a room with N users x M channels streaming Vorbis intervals in some
+    bitrate, the DownloadIntervalWrite messages are generated in a fixed CHUNK_PERIOD.
+*/
+
+class ReplayCapture
+{
+public:
+    struct Message
+    {
+        qint64 time; // ns
+        int offset; // in getData()
+        int size; // header + payload
+        bool intervalWrite; // DownloadIntervalWrite, the encoded data is timestamped in wall-clock replays
+    };
+
+    static ReplayCapture fromWiresharkData(const QByteArray &data);
+    static ReplayCapture generate(int users, int channels, int bitrate, int intervals); // bitrate in kbps
+
+    inline const QByteArray &getData() const
+    {
+        return data;
+    }
+
+    inline const QVector<Message> &getMessages() const
+    {
+        return messages;
+    }
+
+    inline int getIntervalWrites() const
+    {
+        return intervalWrites;
+    }
+
+    inline int getUsers() const // remote users in the room
+    {
+        return users;
+    }
+
+    inline qint64 getDuration() const // ns
+    {
+        return messages.isEmpty() ? 0 : messages.last().time;
+    }
+
+    static qint64 getIntervalPeriod(quint16 bpm, quint16 bpi); // ns
+
+    static const quint16 BPM; // synthetic rooms
+    static const quint16 BPI;
+    static const int CHUNK_PERIOD; // ms, synthetic DownloadIntervalWrite period
+    static const int TIMESTAMP_OFFSET; // the encoded data offset in DownloadIntervalWrite messages (header + GUID + flags)
+
+private:
+    ReplayCapture();
+
+    void append(qint64 time, const QByteArray &messageData, bool intervalWrite);
+
+    QByteArray data;
+    QVector<Message> messages;
+    int intervalWrites;
+    int users;
+};
+
+#endif // REPLAYCAPTURE_H
@@ -0,0 +1,112 @@
+#include "TestByteRope.h"
+#include "ninjam/ByteRope.h"
+#include <QBuffer>
+#include <QTest>
+
+using ninjam::ByteRope;
+using ninjam::ByteRopeReader;
+
+void TestByteRope::appendSharesChunks()
+{
+    QByteArray chunk("ogg data");
+
+    ByteRope rope;
+    rope.append(chunk);
+    rope.append(QByteArray()); // empty chunks are ignored
+    rope.append(chunk);
+
+    QCOMPARE(rope.size(), chunk.size() * 2);
+    QCOMPARE(rope.getChunks().size(), 2);
+    QVERIFY(rope.getChunks().first().constData() == chunk.constData()); // no copy
+
+    ByteRope copy(rope);
+    QVERIFY(copy.getChunks().last().constData() == chunk.constData());
+}
+
+void TestByteRope::toByteArray()
+{
+    ByteRope rope;
+    QVERIFY(rope.toByteArray().isEmpty());
+
+    rope.append(QByteArray("abc"));
+    QCOMPARE(rope.toByteArray(), QByteArray("abc"));
+
+    rope.append(QByteArray("def"));
+    rope.append(QByteArray("g"));
+    QCOMPARE(rope.toByteArray(), QByteArray("abcdefg"));
+}
+
+void TestByteRope::writeTo()
+{
+    ByteRope rope;
+    rope.append(QByteArray("first "));
+    rope.append(QByteArray("second"));
+
+    QByteArray output;
+    QBuffer buffer(&output);
+    buffer.open(QIODevice::WriteOnly);
+    QVERIFY(rope.writeTo(&buffer));
+
+    QCOMPARE(output, QByteArray("first second"));
+}
+
+void TestByteRope::readAcrossChunks()
+{
+    ByteRope rope;
+    rope.append(QByteArray("0123"));
+    rope.append(QByteArray("45"));
+    rope.append(QByteArray("6789"));
+
+    ByteRopeReader reader(rope);
+    QCOMPARE(reader.bytesAvailable(), 10);
+
+    char data[16];
+    QCOMPARE(reader.read(data, 3), 3);
+    QCOMPARE(QByteArray(data, 3), QByteArray("012"));
+
+    QCOMPARE(reader.read(data, 5), 5); // 3 chunks
+    QCOMPARE(QByteArray(data, 5), QByteArray("34567"));
+    QCOMPARE(reader.bytesAvailable(), 2);
+
+    QCOMPARE(reader.read(data, 16), 2); // limited by available bytes
+    QCOMPARE(QByteArray(data, 2), QByteArray("89"));
+    QCOMPARE(reader.bytesAvailable(), 0);
+    QCOMPARE(reader.read(data, 16), 0);
+
+    QCOMPARE(rope.toByteArray(), QByteArray("0123456789")); // the reader is not changing the shared rope
+}
+
+void TestByteRope::readWhileAppending()
+{
+    ByteRopeReader reader;
+    char data[16];
+
+    reader.append(QByteArray("abc"));
+    QCOMPARE(reader.read(data, 16), 3);
+
+    reader.append(QByteArray("de")); // voice chat chunks received after the previous chunks are consumed
+    reader.append(QByteArray("fg"));
+    QCOMPARE(reader.read(data, 3), 3);
+    QCOMPARE(QByteArray(data, 3), QByteArray("def"));
+
+    reader.append(ByteRope(QByteArray("hi")));
+    QCOMPARE(reader.bytesAvailable(), 3);
+    QCOMPARE(reader.read(data, 16), 3);
+    QCOMPARE(QByteArray(data, 3), QByteArray("ghi"));
+}
+
+void TestByteRope::readReleasesConsumedChunks()
+{
+    QByteArray chunk(1024, 'x');
+    QVERIFY(chunk.isDetached());
+
+    ByteRopeReader reader{ByteRope(chunk)};
+    QVERIFY(!chunk.isDetached()); // shared with the reader
+
+    char data[1024];
+    QCOMPARE(reader.read(data, 1000), 1000);
+    QVERIFY(!chunk.isDetached()); // partially consumed
+
+    QCOMPARE(reader.read(data, 1000), 24);
+    QVERIFY(chunk.isDetached()); // the reader released the chunk
+}
@@ -0,0 +1,20 @@
+#ifndef TEST_BYTE_ROPE_H
+#define TEST_BYTE_ROPE_H
+
+#include <QObject>
+
+class TestByteRope : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void appendSharesChunks();
+    void toByteArray();
+    void writeTo();
+
+    void readAcrossChunks();
+    void readWhileAppending();
+    void readReleasesConsumedChunks();
+};
+
+#endif
@@ -0,0 +1,184 @@
+#include "TestMessageFramer.h"
+#include "ninjam/MessageFramer.h"
+#include "ninjam/client/ServerMessages.h"
+#include <QBuffer>
+#include <QTest>
+#include <QtEndian>
+
+using ninjam::MessageFramer;
+using ninjam::MessageView;
+using ninjam::MessageType;
+using ninjam::MessageGuid;
+using ninjam::NinjamInputDataStream;
+using ninjam::client::ConfigChangeNotifyMessage;
+using ninjam::client::ServerToClientChatMessage;
+using ninjam::client::DownloadIntervalWrite;
+
+namespace {
+
+QByteArray createMessages(int encodedDataSize = 100)
+{
+    QByteArray data;
+    ConfigChangeNotifyMessage(120, 16).serializeToBuffer(data);
+    ServerToClientChatMessage::buildPublicMessage("user", "hello").serializeToBuffer(data);
+    DownloadIntervalWrite(MessageGuid(QByteArray(16, 'g')), 0, QByteArray(encodedDataSize, 'x')).serializeToBuffer(data);
+    return data;
+}
+
+} // namespace
+
+void TestMessageFramer::framesMessagesReceivedByteByByte()
+{
+    const QByteArray data = createMessages();
+
+    MessageFramer framer;
+    QList<MessageType> types;
+    QList<quint32> payloads;
+    for (int i = 0; i < data.size(); ++i) {
+        framer.append(data.constData() + i, 1);
+
+        MessageView message;
+        while (framer.next(message)) {
+            types.append(message.getMessageType());
+            payloads.append(message.getPayloadSize());
+        }
+    }
+
+    QCOMPARE(types, QList<MessageType>({MessageType::ServerConfigChangeNotify, MessageType::ChatMessage, MessageType::DownloadIntervalWrite}));
+    QCOMPARE(payloads.first(), quint32(4));
+    QCOMPARE(payloads.last(), quint32(16 + 1 + 100));
+    QCOMPARE(framer.getBufferedBytes(), 0);
+    QVERIFY(!framer.hasError());
+}
+
+void TestMessageFramer::readFromDevice()
+{
+    QByteArray data;
+    for (int i = 0; i < 1000; ++i)
+        data.append(createMessages(i));
+
+    data.append(createMessages(MessageFramer::READ_BLOCK_SIZE * 3)); // bigger than the read block
+
+    QBuffer device(&data);
+    QVERIFY(device.open(QIODevice::ReadOnly));
+
+    MessageFramer framer;
+    int messages = 0;
+    int intervalBytes = 0;
+    int reads = 0;
+    while (framer.readFrom(&device) > 0) {
+        reads++;
+        MessageView message;
+        while (framer.next(message)) {
+            messages++;
+            if (message.getMessageType() == MessageType::DownloadIntervalWrite) {
+                DownloadIntervalWrite msg;
+                NinjamInputDataStream stream(message.getPayload(), message.getPayloadSize());
+                QVERIFY(msg.unserializeFrom(stream));
+                QCOMPARE(msg.getEncodedData(), QByteArray(msg.getEncodedData().size(), 'x'));
+                intervalBytes += msg.getEncodedData().size();
+            }
+        }
+    }
+
+    QCOMPARE(messages, 1001 * 3);
+    QCOMPARE(intervalBytes, 999 * 1000 / 2 + MessageFramer::READ_BLOCK_SIZE * 3);
+    QVERIFY(reads < data.size() / MessageFramer::READ_BLOCK_SIZE + 10); // big reads, not one read per message
+    QCOMPARE(framer.getBufferedBytes(), 0);
+}
+
+void TestMessageFramer::viewsPointToReceiveBuffer()
+{
+    const QByteArray data = createMessages();
+
+    MessageFramer framer;
+    framer.append(data.constData(), data.size());
+
+    MessageView first;
+    MessageView second;
+    QVERIFY(framer.next(first));
+    QVERIFY(framer.next(second));
+
+    QVERIFY(second.getPayload() == first.getPayload() + first.getPayloadSize() + MessageFramer::HEADER_SIZE); // not copied
+    QCOMPARE(first.toByteArray(), data.mid(MessageFramer::HEADER_SIZE, 4));
+}
+
+void TestMessageFramer::invalidPayload()
+{
+    QByteArray data = createMessages();
+    QByteArray header(MessageFramer::HEADER_SIZE, Qt::Uninitialized);
+    header[0] = static_cast<char>(MessageType::ChatMessage);
+    qToLittleEndian<quint32>(1024 * 1024 + 1, reinterpret_cast<uchar *>(header.data() + 1));
+    data.append(header);
+
+    MessageFramer framer(1024 * 1024);
+    framer.append(data.constData(), data.size());
+
+    MessageView message;
+    int messages = 0;
+    while (framer.next(message))
+        messages++;
+
+    QCOMPARE(messages, 3); // the messages before the invalid header
+    QVERIFY(framer.hasError());
+
+    framer.clear();
+    QVERIFY(!framer.hasError());
+    QCOMPARE(framer.getBufferedBytes(), 0);
+}
+
+void TestMessageFramer::parseInPlace()
+{
+    QByteArray payload;
+    payload.append('\x01');
+    payload.append("\x02\x01", 2); // 0x0102
+    payload.append("\x04\x03\x02\x01", 4); // 0x01020304
+    payload.append("abc", 4); // NUL terminated
+
+    NinjamInputDataStream stream(payload.constData(), static_cast<quint32>(payload.size()));
+
+    quint8 byte;
+    quint16 word;
+    quint32 dword;
+    QString string;
+    QVERIFY(stream.read<quint8>(byte));
+    QVERIFY(stream.read<quint16>(word));
+    QVERIFY(stream.getData() == payload.constData() + 3);
+    QVERIFY(stream.read<quint32>(dword));
+    QVERIFY(stream.readUtf8String(string));
+
+    QCOMPARE(byte, quint8(1));
+    QCOMPARE(word, quint16(0x0102));
+    QCOMPARE(dword, quint32(0x01020304));
+    QCOMPARE(string, QString("abc"));
+    QCOMPARE(stream.getRemainingPayload(), quint32(0));
+
+    QVERIFY(!stream.read<quint8>(byte)); // end of payload
+    QVERIFY(!stream.skip(1));
+}
+
+void TestMessageFramer::parseStrings()
+{
+    QFETCH(QByteArray, payload);
+    QFETCH(QStringList, strings);
+
+    NinjamInputDataStream stream(payload, static_cast<quint32>(payload.size()));
+    QStringList parsed;
+    QVERIFY(stream.readUtf8Strings(parsed, stream.getRemainingPayload()));
+    QCOMPARE(parsed, strings);
+
+    NinjamInputDataStream fixedStream(payload, static_cast<quint32>(payload.size()));
+    QString fixed;
+    QVERIFY(fixedStream.readUtf8StringFixed(fixed, fixedStream.getRemainingPayload()));
+    QCOMPARE(fixed, strings.first()); // stop in the first NUL
+}
+
+void TestMessageFramer::parseStrings_data()
+{
+    QTest::addColumn<QByteArray>("payload");
+    QTest::addColumn<QStringList>("strings");
+
+    QTest::newRow("chat") << QByteArray("MSG\0user\0text\0\0\0", 16) << QStringList({"MSG", "user", "text", "", ""});
+    QTest::newRow("utf8") << QByteArray("TOPIC\0\0\xF0\x9F\x98\x80\0", 12) << QStringList({"TOPIC", "", QString::fromUtf8("\xF0\x9F\x98\x80")});
+    QTest::newRow("not terminated last string") << QByteArray("JOIN\0user", 9) << QStringList({"JOIN"});
+}
@@ -0,0 +1,21 @@
+#ifndef TEST_MESSAGE_FRAMER_H
+#define TEST_MESSAGE_FRAMER_H
+
+#include <QObject>
+
+class TestMessageFramer : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void framesMessagesReceivedByteByByte();
+    void readFromDevice(); // many messages in one read, messages bigger than the read block
+    void viewsPointToReceiveBuffer();
+    void invalidPayload();
+
+    void parseInPlace(); // NinjamInputDataStream reading from the payload bytes
+    void parseStrings();
+    void parseStrings_data();
+};
+
+#endif
@@ -0,0 +1,147 @@
+#include "TestOutgoingMessagesQueue.h"
+#include "ninjam/client/OutgoingMessagesQueue.h"
+#include "ninjam/client/ClientMessages.h"
+#include "ninjam/common/CommonMessages.h"
+#include <QBuffer>
+#include <QTest>
+
+using ninjam::client::OutgoingMessagesQueue;
+using ninjam::client::UploadIntervalBegin;
+using ninjam::client::UploadIntervalWrite;
+using ninjam::client::ClientToServerChatMessage;
+using ninjam::common::KeepAliveMessage;
+using ninjam::MessageGuid;
+using ninjam::MessageType;
+using ninjam::INetworkMessage;
+
+Q_DECLARE_METATYPE(OutgoingMessagesQueue::Priority)
+Q_DECLARE_METATYPE(ninjam::MessageType)
+
+namespace {
+
+QByteArray serialize(const INetworkMessage &message)
+{
+    QByteArray data;
+    message.serializeToBuffer(data);
+    return data;
+}
+
+} // namespace
+
+void TestOutgoingMessagesQueue::coalesceMessages()
+{
+    QByteArray deviceData;
+    QBuffer device(&deviceData);
+    device.open(QIODevice::WriteOnly);
+
+    OutgoingMessagesQueue queue;
+    queue.setDevice(&device);
+
+    const MessageGuid guid(QByteArray(16, 'g'));
+    QByteArray expected;
+    for (int i = 0; i < 4; ++i) { // 4 channels uploading in the same event loop iteration
+        UploadIntervalWrite message(guid, QByteArray(32, static_cast<char>('a' + i)), false);
+        queue.enqueue(message);
+        expected.append(serialize(message));
+    }
+
+    QVERIFY(deviceData.isEmpty()); // nothing is written before the flush
+    QCOMPARE(queue.getQueuedBytes(), static_cast<qint64>(expected.size()));
+
+    queue.flush();
+
+    QCOMPARE(deviceData, expected);
+    QVERIFY(queue.isEmpty());
+
+    const auto &statistics = queue.getStatistics();
+    QCOMPARE(statistics.messages, quint64(4));
+    QCOMPARE(statistics.flushes, quint64(1));
+    QCOMPARE(statistics.getSavedFlushes(), quint64(3));
+    QCOMPARE(statistics.coalescedMessages, quint64(4));
+    QCOMPARE(statistics.bytes, static_cast<quint64>(expected.size()));
+
+    queue.flush(); // empty queue, no flush
+    QCOMPARE(queue.getStatistics().flushes, quint64(1));
+}
+
+void TestOutgoingMessagesQueue::controlMessagesAreWrittenFirst()
+{
+    QByteArray deviceData;
+    QBuffer device(&deviceData);
+    device.open(QIODevice::WriteOnly);
+
+    OutgoingMessagesQueue queue;
+    queue.setDevice(&device);
+
+    const MessageGuid guid(QByteArray(16, 'g'));
+    UploadIntervalBegin begin(guid, 0, true);
+    UploadIntervalWrite write(guid, QByteArray(64, 'v'), true);
+    auto chat = ClientToServerChatMessage::buildPublicMessage("hello");
+    KeepAliveMessage keepAlive;
+
+    queue.enqueue(begin);
+    queue.enqueue(write);
+    queue.enqueue(chat);
+    queue.enqueue(keepAlive);
+    queue.flush();
+
+    // keep alive, chat and the interval data in the enqueued order
+    QCOMPARE(deviceData, serialize(keepAlive) + serialize(chat) + serialize(begin) + serialize(write));
+}
+
+void TestOutgoingMessagesQueue::messagesAreKeptUntilDeviceIsOpen()
+{
+    QByteArray deviceData;
+    QBuffer device(&deviceData);
+
+    OutgoingMessagesQueue queue;
+    queue.setDevice(&device);
+
+    KeepAliveMessage keepAlive;
+    queue.enqueue(keepAlive);
+    queue.flush(); // device is not open (not connected)
+
+    QVERIFY(deviceData.isEmpty());
+    QVERIFY(!queue.isEmpty());
+
+    device.open(QIODevice::WriteOnly);
+    queue.flush();
+
+    QCOMPARE(deviceData, serialize(keepAlive));
+}
+
+void TestOutgoingMessagesQueue::clear()
+{
+    OutgoingMessagesQueue queue;
+    queue.enqueue(KeepAliveMessage());
+    queue.enqueue(ClientToServerChatMessage::buildPublicMessage("hello"));
+
+    QVERIFY(!queue.isEmpty());
+
+    queue.clear();
+
+    QVERIFY(queue.isEmpty());
+    QCOMPARE(queue.getQueuedBytes(), qint64(0));
+}
+
+void TestOutgoingMessagesQueue::priority()
+{
+    QFETCH(MessageType, messageType);
+    QFETCH(OutgoingMessagesQueue::Priority, expectedPriority);
+
+    QCOMPARE(OutgoingMessagesQueue::getPriority(messageType), expectedPriority);
+}
+
+void TestOutgoingMessagesQueue::priority_data()
+{
+    QTest::addColumn<MessageType>("messageType");
+    QTest::addColumn<OutgoingMessagesQueue::Priority>("expectedPriority");
+
+    QTest::newRow("Keep alive") << MessageType::KeepAlive << OutgoingMessagesQueue::Priority::Control;
+    QTest::newRow("Authentication") << MessageType::ClientAuthUser << OutgoingMessagesQueue::Priority::Control;
+    QTest::newRow("Channels") << MessageType::ClientSetChannel << OutgoingMessagesQueue::Priority::Control;
+    QTest::newRow("User mask") << MessageType::ClientSetUserMask << OutgoingMessagesQueue::Priority::Control;
+    QTest::newRow("Chat") << MessageType::ChatMessage << OutgoingMessagesQueue::Priority::Chat;
+    QTest::newRow("Interval begin") << MessageType::UploadIntervalBegin << OutgoingMessagesQueue::Priority::IntervalData;
+    QTest::newRow("Interval write") << MessageType::UploadIntervalWrite << OutgoingMessagesQueue::Priority::IntervalData;
+}
@@ -0,0 +1,20 @@
+#ifndef TEST_OUTGOING_MESSAGES_QUEUE_H
+#define TEST_OUTGOING_MESSAGES_QUEUE_H
+
+#include <QObject>
+
+class TestOutgoingMessagesQueue : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void coalesceMessages();
+    void controlMessagesAreWrittenFirst();
+    void messagesAreKeptUntilDeviceIsOpen();
+    void clear();
+
+    void priority();
+    void priority_data();
+};
+
+#endif
@@ -1,6 +1,7 @@
 #include "TestServerMessagesHandler.h"
-#include "ninjam/client/ServerMessagesHandler.h"
+#include "ninjam/MessageFramer.h"
 #include "ninjam/client/ServerMessages.h"
+#include "ninjam/client/UserChannel.h"
 #include <QFile>
 #include <QFileInfo>
 #include <QDir>
@@ -8,42 +9,64 @@
 using namespace ninjam::client;
 using namespace ninjam;
 
+namespace {
+
 /**
-Simulate the connection in a full server using data collected with Wireshark. The sequence of received message are a
-ServerAuthChallenge followed by a ServerAuthReply containing a error message "server full".
+    Read the data collected with Wireshark in a MessageFramer, the messages are parsed in the same
+    order they are received in ServerMessagesHandler.
 */
 
-class FullServerMessagesHandler : public ServerMessagesHandler
+class CapturedMessages
 {
 public:
-    FullServerMessagesHandler():
-        ServerMessagesHandler(nullptr){
-
+    explicit CapturedMessages(const QString &filePath)
+    {
+        QFile wiresharkFile(filePath);
+        opened = wiresharkFile.open(QIODevice::ReadOnly);
+        while (opened && framer.readFrom(&wiresharkFile) > 0)
+            ; // the capture is small, all bytes are buffered
     }
 
-    void handleAllMessages() override
+    template<class MessageClazz>
+    bool next(MessageClazz &msg)
     {
-        currentHeader = MessageHeader::from(device);
-        auto authChallenge = AuthChallengeMessage::from(device, currentHeader.getPayload());
-
-        QVERIFY(authChallenge.serverHasLicenceAgreement());//just a simple check
+        MessageView message;
+        if (!framer.next(message) || message.getMessageType() != msg.getMsgType())
+            return false;
 
-        currentHeader = MessageHeader::from(device);
-        auto replyMessage = AuthReplyMessage::from(device, currentHeader.getPayload());
+        NinjamInputDataStream stream(message.getPayload(), message.getPayloadSize());
+        return msg.unserializeFrom(stream);
+    }
 
-        QCOMPARE(replyMessage.getErrorMessage(), QString("server full"));
+    bool isOpened() const
+    {
+        return opened;
     }
+
+private:
+    MessageFramer framer;
+    bool opened;
 };
 
+} // namespace
+
+/**
+Simulate the connection in a full server using data collected with Wireshark. The sequence of received message are a
+ServerAuthChallenge followed by a ServerAuthReply containing a error message "server full".
+*/
+
 void TestServerMessagesHandler::connectInFullServer()
 {
-    FullServerMessagesHandler messagesHandler;
-    QFile wiresharkFile(":/wireshark data/full server.data");
-    //check if the wireshark data file can be opened
-    QVERIFY2( wiresharkFile.open(QIODevice::ReadOnly), wiresharkFile.errorString().toStdString().c_str());
+    CapturedMessages messages(":/wireshark data/full server.data");
+    QVERIFY(messages.isOpened()); //check if the wireshark data file can be opened
 
-    messagesHandler.initialize(&wiresharkFile);
-    messagesHandler.handleAllMessages();
+    AuthChallengeMessage authChallenge;
+    QVERIFY(messages.next(authChallenge));
+    QVERIFY(authChallenge.serverHasLicenceAgreement());//just a simple check
+
+    AuthReplyMessage replyMessage;
+    QVERIFY(messages.next(replyMessage));
+    QCOMPARE(replyMessage.getErrorMessage(), QString("server full"));
 }
 
 
@@ -54,81 +77,52 @@ this test is reading some data extracted from a real ninjam server communication
 This test check if the first messages (handshake) are readed in the correct order.
 */
 
-class HandshakeMessagesHandler : public ServerMessagesHandler
-{
-public:
-    HandshakeMessagesHandler():
-        ServerMessagesHandler(nullptr){
-
-    }
-
-    void handleAllMessages() override
-    {
-        //auth challenge
-        currentHeader = MessageHeader::from(device);
-        auto authChallenge = AuthChallengeMessage::from(device, currentHeader.getPayload());
-
-        QVERIFY(authChallenge.serverHasLicenceAgreement());//just a simple check
-
-        //auth reply
-        currentHeader = MessageHeader::from(device);
-        auto replyMessage = AuthReplyMessage::from(device,currentHeader.getPayload());
-
-        QVERIFY(replyMessage.getNewUserName().startsWith("wiresharker"));
-        QVERIFY(replyMessage.getMaxChannels() == 2);
-        QVERIFY(replyMessage.userIsAuthenticated());
-
-        //serverConfigChangeNotify
-        currentHeader = MessageHeader::from(device);
-        auto serverConfig = ConfigChangeNotifyMessage::from(device, currentHeader.getPayload());
-
-        QVERIFY(serverConfig.getBpi() == 16);
-        QVERIFY(serverConfig.getBpm() == 125);
-
-        //userInfoChangeNotify
-        currentHeader = MessageHeader::from(device);
-        auto userInfo = UserInfoChangeNotifyMessage::from(device, currentHeader.getPayload());
-
-        //check if all expected users and the user channels are in the list
-        QMap<QString, QStringList> expectedUsersChannels;
-        QStringList ninbotChannels("recording 10:25");
-        ninbotChannels.append("channel0");
-        expectedUsersChannels.insert("ninbot", ninbotChannels);
-        expectedUsersChannels.insert("PowaCord@98.215.146.x", QStringList("toothcup"));
-        expectedUsersChannels.insert("Torben_Scharling@185.10.223.x", QStringList("new channel"));
-        expectedUsersChannels.insert("meilo@91.39.197.x", QStringList("default channel"));
-
-        QList<User> connectedUsers = userInfo.getUsers();
-        QVERIFY(connectedUsers.size() == expectedUsersChannels.size());
-        foreach (const User &user, connectedUsers) {
-            QVERIFY(expectedUsersChannels.contains(user.getFullName()));
-            QStringList expectedChannels = expectedUsersChannels[user.getFullName()];
-            QVERIFY(!expectedChannels.isEmpty());
-            foreach (const UserChannel &channel, user.getChannels()) {
-                QVERIFY( expectedChannels.contains(channel.getName()));
-            }
-        }
-
-
-        //check the topic message
-        currentHeader = MessageHeader::from(device);
-        auto topicMessage = ServerToClientChatMessage::from(device, currentHeader.getPayload());
-
-        QVERIFY(topicMessage.getCommand() == ChatCommandType::TOPIC);
-        QCOMPARE(topicMessage.getArguments().at(1), QString("\"Happy New Year 2016 ALL!!\""));
-    }
-};
-
 void TestServerMessagesHandler::handShakeMessages()
 {
-    HandshakeMessagesHandler messagesHandler;
-    QFile wiresharkFile(":/wireshark data/ninbot 4 players connected.data");
-    //check if the wireshark data file can be opened
-    QVERIFY2( wiresharkFile.open(QIODevice::ReadOnly), wiresharkFile.errorString().toStdString().c_str());
-
-    messagesHandler.initialize(&wiresharkFile);
-    messagesHandler.handleAllMessages();
+    CapturedMessages messages(":/wireshark data/ninbot 4 players connected.data");
+    QVERIFY(messages.isOpened());
+
+    //auth challenge
+    AuthChallengeMessage authChallenge;
+    QVERIFY(messages.next(authChallenge));
+    QVERIFY(authChallenge.serverHasLicenceAgreement());//just a simple check
+
+    //auth reply
+    AuthReplyMessage replyMessage;
+    QVERIFY(messages.next(replyMessage));
+    QVERIFY(replyMessage.getNewUserName().startsWith("wiresharker"));
+    QVERIFY(replyMessage.getMaxChannels() == 2);
+    QVERIFY(replyMessage.userIsAuthenticated());
+
+    //serverConfigChangeNotify
+    ConfigChangeNotifyMessage serverConfig;
+    QVERIFY(messages.next(serverConfig));
+    QVERIFY(serverConfig.getBpi() == 16);
+    QVERIFY(serverConfig.getBpm() == 125);
+
+    //userInfoChangeNotify
+    UserInfoChangeNotifyMessage userInfo;
+    QVERIFY(messages.next(userInfo));
+
+    //check if all expected users and the user channels are in the list
+    QMap<QString, QStringList> expectedUsersChannels;
+    QStringList ninbotChannels("recording 10:25");
+    ninbotChannels.append("channel0");
+    expectedUsersChannels.insert("ninbot", ninbotChannels);
+    expectedUsersChannels.insert("PowaCord@98.215.146.x", QStringList("toothcup"));
+    expectedUsersChannels.insert("Torben_Scharling@185.10.223.x", QStringList("new channel"));
+    expectedUsersChannels.insert("meilo@91.39.197.x", QStringList("default channel"));
+
+    const auto &usersChannels = userInfo.getUsers();
+    QCOMPARE(usersChannels.uniqueKeys().size(), expectedUsersChannels.size());
+    for (auto iterator = usersChannels.begin(); iterator != usersChannels.end(); ++iterator) {
+        QVERIFY(expectedUsersChannels.contains(iterator.key()));
+        QVERIFY(expectedUsersChannels[iterator.key()].contains(iterator.value().getName()));
+    }
 
+    //check the topic message
+    ServerToClientChatMessage topicMessage;
+    QVERIFY(messages.next(topicMessage));
+    QVERIFY(topicMessage.getCommand() == ChatCommandType::TOPIC);
+    QCOMPARE(topicMessage.getArguments().at(1), QString("\"Happy New Year 2016 ALL!!\""));
 }
-
-
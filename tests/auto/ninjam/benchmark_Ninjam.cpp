@@ -0,0 +1,23 @@
+#include <QCoreApplication>
+
+#include <QtTest>
+#include "BenchmarkServer.h"
+#include "BenchmarkMessageFramer.h"
+#include "BenchmarkService.h"
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv); // the server and the fake clients are using event loops
+
+    BenchmarkMessageFramer benchmarkMessageFramer;
+    BenchmarkService benchmarkService;
+    BenchmarkServer benchmarkServer;
+
+    int result = QTest::qExec(&benchmarkMessageFramer, argc, argv);
+
+    result |= QTest::qExec(&benchmarkService, argc, argv);
+
+    result |= QTest::qExec(&benchmarkServer, argc, argv);
+
+    return result;
+}
@@ -13,6 +13,9 @@ VPATH += ../../../src/Common
 HEADERS += TestMessagesSerialization.h
 HEADERS += TestServerMessagesHandler.h
 HEADERS += TestServerClientCommunication.h
+HEADERS += TestByteRope.h
+HEADERS += TestOutgoingMessagesQueue.h
+HEADERS += TestMessageFramer.h
 
 HEADERS += log/logging.h
 HEADERS += TestServerInfo.h
@@ -20,24 +23,37 @@ HEADERS += ninjam/client/ServerInfo.h
 HEADERS += ninjam/client/User.h
 HEADERS += ninjam/client/UserChannel.h
 HEADERS += ninjam/client/Service.h
+HEADERS += ninjam/client/OutgoingMessagesQueue.h
+HEADERS += ninjam/common/CommonMessages.h
 HEADERS += ninjam/Ninjam.h
+HEADERS += ninjam/ByteRope.h
+HEADERS += ninjam/MessageFramer.h
 HEADERS += ninjam/server/Server.h
+HEADERS += ninjam/server/ClientConnection.h
 
 SOURCES += log/logging.cpp
 SOURCES += ninjam/Ninjam.cpp
+SOURCES += ninjam/ByteRope.cpp
+SOURCES += ninjam/MessageFramer.cpp
 SOURCES += TestServerInfo.cpp
 SOURCES += ninjam/client/ServerInfo.cpp
 SOURCES += ninjam/client/User.cpp
 SOURCES += ninjam/client/UserChannel.cpp
 SOURCES += ninjam/client/Service.cpp
+SOURCES += ninjam/client/OutgoingMessagesQueue.cpp
+SOURCES += ninjam/common/CommonMessages.cpp
 SOURCES += ninjam/client/ServerMessages.cpp
 SOURCES += ninjam/client/ServerMessagesHandler.cpp
 SOURCES += ninjam/client/ClientMessages.cpp
 SOURCES += ninjam/server/Server.cpp
+SOURCES += ninjam/server/ClientConnection.cpp
 
 SOURCES += TestServerMessagesHandler.cpp
 SOURCES += TestMessagesSerialization.cpp
 SOURCES += TestServerClientCommunication.cpp
+SOURCES += TestByteRope.cpp
+SOURCES += TestOutgoingMessagesQueue.cpp
+SOURCES += TestMessageFramer.cpp
 
 SOURCES += test_Ninjam.cpp
 
@@ -0,0 +1,60 @@
+# server load tests and protocol replays, not executed in 'make check'. Run in release mode to get meaningful numbers.
+
+QT += testlib network
+QT -= gui
+CONFIG += c++11
+TEMPLATE = app
+TARGET = ninjamBenchmark
+
+INCLUDEPATH += .
+INCLUDEPATH += ../../../src/Common
+VPATH += ../../../src/Common
+
+HEADERS += BenchmarkServer.h
+HEADERS += ClientSwarm.h
+HEADERS += BenchmarkMessageFramer.h
+HEADERS += AllocationCounter.h
+HEADERS += BenchmarkService.h
+HEADERS += CaptureServer.h
+HEADERS += ReplayCapture.h
+HEADERS += CpuTime.h
+HEADERS += log/Logging.h
+HEADERS += ninjam/Ninjam.h
+HEADERS += ninjam/MessageFramer.h
+HEADERS += ninjam/common/CommonMessages.h
+HEADERS += ninjam/client/User.h
+HEADERS += ninjam/client/UserChannel.h
+HEADERS += ninjam/client/ServerInfo.h
+HEADERS += ninjam/client/Service.h
+HEADERS += ninjam/client/OutgoingMessagesQueue.h
+HEADERS += ninjam/ByteRope.h
+HEADERS += ninjam/server/Server.h
+HEADERS += ninjam/server/ClientConnection.h
+
+SOURCES += BenchmarkServer.cpp
+SOURCES += ClientSwarm.cpp
+SOURCES += BenchmarkMessageFramer.cpp
+SOURCES += AllocationCounter.cpp
+SOURCES += BenchmarkService.cpp
+SOURCES += CaptureServer.cpp
+SOURCES += ReplayCapture.cpp
+SOURCES += CpuTime.cpp
+SOURCES += log/logging.cpp
+SOURCES += ninjam/Ninjam.cpp
+SOURCES += ninjam/MessageFramer.cpp
+SOURCES += ninjam/common/CommonMessages.cpp
+SOURCES += ninjam/client/User.cpp
+SOURCES += ninjam/client/UserChannel.cpp
+SOURCES += ninjam/client/ServerInfo.cpp
+SOURCES += ninjam/client/Service.cpp
+SOURCES += ninjam/client/ServerMessagesHandler.cpp
+SOURCES += ninjam/client/OutgoingMessagesQueue.cpp
+SOURCES += ninjam/ByteRope.cpp
+SOURCES += ninjam/client/ClientMessages.cpp
+SOURCES += ninjam/client/ServerMessages.cpp
+SOURCES += ninjam/server/Server.cpp
+SOURCES += ninjam/server/ClientConnection.cpp
+
+SOURCES += benchmark_Ninjam.cpp
+
+RESOURCES += ninjamTestsResources.qrc
@@ -3,18 +3,27 @@
 #include "TestMessagesSerialization.h"
 #include "TestServerMessagesHandler.h"
 #include "TestServerClientCommunication.h"
+#include "TestByteRope.h"
+#include "TestOutgoingMessagesQueue.h"
+#include "TestMessageFramer.h"
 
 int main(int argc, char *argv[])
 {
     TestMessagesSerialization testServerMessages;
     TestServerInfo testServer;
     TestServerMessagesHandler testServerMessagesHandler;
+    TestByteRope testByteRope;
+    TestOutgoingMessagesQueue testOutgoingMessagesQueue;
+    TestMessageFramer testMessageFramer;
     //TestServerClientCommunication testServerClientCommunication;
 
     int testResults = 0;
     testResults |= QTest::qExec(&testServerMessages, argc, argv);
     testResults |= QTest::qExec(&testServer, argc, argv);
     testResults |= QTest::qExec(&testServerMessagesHandler, argc, argv);
+    testResults |= QTest::qExec(&testByteRope, argc, argv);
+    testResults |= QTest::qExec(&testOutgoingMessagesQueue, argc, argv);
+    testResults |= QTest::qExec(&testMessageFramer, argc, argv);
     //testResults |= QTest::qExec(&testServerClientCommunication, argc, argv);
     return testResults;
 }
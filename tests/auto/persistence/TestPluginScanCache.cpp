@@ -0,0 +1,170 @@
+#include "TestPluginScanCache.h"
+#include "persistence/PluginScanCache.h"
+#include "persistence/CacheHeader.h"
+
+#include <QtTest/QtTest>
+#include <QFile>
+#include <QDateTime>
+
+using namespace persistence;
+
+void TestPluginScanCache::init()
+{
+    tempDir = new QTemporaryDir();
+    QVERIFY(tempDir->isValid());
+
+    pluginPath = QDir(tempDir->path()).absoluteFilePath("plugin.dll");
+    writePlugin("first version");
+}
+
+void TestPluginScanCache::cleanup()
+{
+    delete tempDir;
+    tempDir = nullptr;
+}
+
+void TestPluginScanCache::writePlugin(const QByteArray &content)
+{
+    QFile file(pluginPath);
+    QVERIFY(file.open(QFile::WriteOnly | QFile::Truncate));
+    QCOMPARE(file.write(content), qint64(content.size()));
+}
+
+void TestPluginScanCache::unchangedPlugin()
+{
+    PluginScanCache cache(QDir(tempDir->path()));
+    cache.store(PluginScanResult(pluginPath, true, "plugin", "manufacturer"), PluginScanCache::computeHash(pluginPath));
+
+    PluginScanResult result;
+    QVERIFY(cache.lookup(pluginPath, result));
+    QCOMPARE(result.getPath(), pluginPath);
+    QVERIFY(result.isValid());
+    QCOMPARE(result.getName(), QString("plugin"));
+    QCOMPARE(result.getManufacturer(), QString("manufacturer"));
+    QCOMPARE(result.getFileSize(), QFileInfo(pluginPath).size());
+    QCOMPARE(result.getHash(), PluginScanCache::computeHash(pluginPath));
+}
+
+void TestPluginScanCache::missingPlugin()
+{
+    PluginScanCache cache(QDir(tempDir->path()));
+    cache.store(PluginScanResult(pluginPath, true, "plugin"));
+
+    PluginScanResult result;
+    QVERIFY(!cache.lookup(pluginPath + ".other", result));
+
+    QVERIFY(QFile::remove(pluginPath));
+    QVERIFY(!cache.lookup(pluginPath, result)); // uninstalled
+}
+
+void TestPluginScanCache::changedPlugin()
+{
+    PluginScanCache cache(QDir(tempDir->path()));
+    cache.store(PluginScanResult(pluginPath, true, "plugin"), PluginScanCache::computeHash(pluginPath));
+
+    writePlugin("other version"); // same size
+    QFile file(pluginPath);
+    QVERIFY(file.open(QFile::ReadWrite));
+    QVERIFY(file.setFileTime(QDateTime::currentDateTime().addSecs(60), QFileDevice::FileModificationTime));
+    file.close();
+
+    PluginScanResult result;
+    QVERIFY(!cache.lookup(pluginPath, result));
+}
+
+void TestPluginScanCache::resizedPlugin()
+{
+    PluginScanCache cache(QDir(tempDir->path()));
+    cache.store(PluginScanResult(pluginPath, true, "plugin"));
+
+    writePlugin("a bigger second version");
+
+    PluginScanResult result;
+    QVERIFY(!cache.lookup(pluginPath, result));
+}
+
+void TestPluginScanCache::touchedPlugin()
+{
+    PluginScanCache cache(QDir(tempDir->path()));
+    cache.store(PluginScanResult(pluginPath, true, "plugin"), PluginScanCache::computeHash(pluginPath)); // hashed by the scanner process
+
+    const QDateTime newTime = QDateTime::currentDateTime().addSecs(60);
+    QFile file(pluginPath);
+    QVERIFY(file.open(QFile::ReadWrite));
+    QVERIFY(file.setFileTime(newTime, QFileDevice::FileModificationTime));
+    file.close();
+
+    PluginScanResult result;
+    QVERIFY(cache.lookup(pluginPath, result));
+    QCOMPARE(result.getLastModified(), QFileInfo(pluginPath).lastModified().toMSecsSinceEpoch()); // the fingerprint is updated
+}
+
+void TestPluginScanCache::touchedPluginWithoutHash()
+{
+    PluginScanCache cache(QDir(tempDir->path()));
+    cache.store(PluginScanResult(pluginPath, true, "plugin")); // the binary is not hashed in store()
+
+    PluginScanResult result;
+    QVERIFY(cache.lookup(pluginPath, result));
+    QVERIFY(result.getHash().isEmpty());
+
+    QFile file(pluginPath);
+    QVERIFY(file.open(QFile::ReadWrite));
+    QVERIFY(file.setFileTime(QDateTime::currentDateTime().addSecs(60), QFileDevice::FileModificationTime));
+    file.close();
+
+    QVERIFY(!cache.lookup(pluginPath, result)); // no hash to compare, scanned again
+}
+
+void TestPluginScanCache::invalidPlugin()
+{
+    PluginScanCache cache(QDir(tempDir->path()));
+    cache.store(PluginScanResult(pluginPath, false));
+
+    PluginScanResult result;
+    QVERIFY(!cache.lookup(pluginPath, result)); // scanned again in the next scan, the failure can be temporary
+    QCOMPARE(cache.size(), 0);
+
+    cache.store(PluginScanResult(pluginPath, true, "plugin"));
+    cache.store(PluginScanResult(pluginPath, false)); // failing after a valid scan
+    QVERIFY(!cache.lookup(pluginPath, result));
+}
+
+void TestPluginScanCache::persistedResults()
+{
+    {
+        PluginScanCache cache(QDir(tempDir->path()));
+        cache.store(PluginScanResult(pluginPath, true, "plugin", "manufacturer"));
+        QCOMPARE(cache.size(), 1);
+    } // saved in destructor
+
+    PluginScanCache cache(QDir(tempDir->path()));
+    QCOMPARE(cache.size(), 1);
+
+    PluginScanResult result;
+    QVERIFY(cache.lookup(pluginPath, result));
+    QCOMPARE(result.getName(), QString("plugin"));
+    QCOMPARE(result.getManufacturer(), QString("manufacturer"));
+
+    cache.remove(pluginPath);
+    QCOMPARE(cache.size(), 0);
+    QVERIFY(!cache.lookup(pluginPath, result));
+}
+
+void TestPluginScanCache::invalidCacheRevision()
+{
+    {
+        PluginScanCache cache(QDir(tempDir->path()));
+        cache.store(PluginScanResult(pluginPath, true, "plugin"));
+    }
+
+    // overwrite the header with an old revision, the cached results are discarded
+    QFile cacheFile(QDir(tempDir->path()).absoluteFilePath("plugins_scan_cache.bin"));
+    QVERIFY(cacheFile.open(QFile::ReadWrite));
+    QDataStream stream(&cacheFile);
+    stream << CacheHeader(PluginScanCacheHeader::REVISION + 1);
+    cacheFile.close();
+
+    PluginScanCache cache(QDir(tempDir->path()));
+    QCOMPARE(cache.size(), 0);
+}
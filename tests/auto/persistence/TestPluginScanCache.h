@@ -0,0 +1,32 @@
+#ifndef TEST_PLUGIN_SCAN_CACHE_H
+#define TEST_PLUGIN_SCAN_CACHE_H
+
+#include <QObject>
+#include <QTemporaryDir>
+
+class TestPluginScanCache: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init(); // a fresh cache dir and a fake plugin binary in every test
+    void cleanup();
+
+    void unchangedPlugin();
+    void missingPlugin();
+    void changedPlugin(); // same size, different content
+    void resizedPlugin();
+    void touchedPlugin(); // new modification time but same content, not scanned again
+    void touchedPluginWithoutHash();
+    void invalidPlugin(); // failed scans are not cached
+    void persistedResults();
+    void invalidCacheRevision();
+
+private:
+    QTemporaryDir *tempDir;
+    QString pluginPath;
+
+    void writePlugin(const QByteArray &content);
+};
+
+#endif // TEST_PLUGIN_SCAN_CACHE_H
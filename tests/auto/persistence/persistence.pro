@@ -12,8 +12,12 @@ VPATH += ../../../src/Common
 HEADERS += log/logging.h
 HEADERS += persistence/UsersDataCache.h
 HEADERS += persistence/CacheHeader.h
+HEADERS += persistence/PluginScanCache.h
+HEADERS += TestPluginScanCache.h
 
 SOURCES += log/logging.cpp
 SOURCES += persistence/UsersDataCache.cpp
 SOURCES += persistence/CacheHeader.cpp
+SOURCES += persistence/PluginScanCache.cpp
+SOURCES += TestPluginScanCache.cpp
 SOURCES += tst_UsersDataCache.cpp
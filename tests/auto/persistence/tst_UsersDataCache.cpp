@@ -4,6 +4,7 @@
 #include <QtTest/QtTest>
 #include "persistence/UsersDataCache.h"
 #include "persistence/CacheHeader.h"
+#include "TestPluginScanCache.h"
 
 using namespace persistence;
 
@@ -199,6 +200,11 @@ int main(int argc, char *argv[])
         status |= QTest::qExec(&test, argc, argv);
     }
 
+    {
+        TestPluginScanCache test;
+        status |= QTest::qExec(&test, argc, argv);
+    }
+
     return status;
 }
 
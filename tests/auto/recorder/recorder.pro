@@ -0,0 +1,17 @@
+QT += testlib
+QT -= gui
+CONFIG += testcase c++11
+TEMPLATE = app
+TARGET = testRecorder
+INCLUDEPATH += .
+INCLUDEPATH += ../../../src/Common
+VPATH += ../../../src/Common
+
+HEADERS += recorder/RecorderIOExecutor.h
+HEADERS += ninjam/ByteRope.h
+HEADERS += log/Logging.h
+
+SOURCES += recorder/RecorderIOExecutor.cpp
+SOURCES += ninjam/ByteRope.cpp
+SOURCES += log/logging.cpp
+SOURCES += test_RecorderIOExecutor.cpp
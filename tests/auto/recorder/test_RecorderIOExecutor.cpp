@@ -0,0 +1,103 @@
+#include <QObject>
+#include <QString>
+#include <QtTest/QtTest>
+#include <QTemporaryDir>
+#include "recorder/RecorderIOExecutor.h"
+
+using recorder::RecorderIOExecutor;
+
+class TestRecorderIOExecutor: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void writesAreOrdered();
+    void smallChunksAreCoalesced();
+    void bigWrites();
+    void executorIsSharedInSameDisk();
+
+private:
+    static QByteArray readFile(const QString &filePath);
+};
+
+QByteArray TestRecorderIOExecutor::readFile(const QString &filePath)
+{
+    QFile file(filePath);
+    file.open(QFile::ReadOnly);
+    return file.readAll();
+}
+
+void TestRecorderIOExecutor::writesAreOrdered()
+{
+    QTemporaryDir dir;
+    const QString filePath = dir.filePath("interval.ogg");
+
+    RecorderIOExecutor executor(dir.path());
+    for (int i = 0; i < 100; ++i)
+        QVERIFY(executor.write(filePath, ninjam::ByteRope(QByteArray::number(i)))); // the file is replaced in each write
+
+    executor.waitForPendingWrites();
+
+    QCOMPARE(readFile(filePath), QByteArray("99"));
+
+    auto metrics = executor.getMetrics();
+    QCOMPARE(metrics.queuedBytes, quint64(0));
+    QCOMPARE(metrics.droppedWrites, quint64(0));
+}
+
+void TestRecorderIOExecutor::smallChunksAreCoalesced()
+{
+    QTemporaryDir dir;
+    const QString filePath = dir.filePath("interval.ogg");
+
+    QByteArray expected;
+    ninjam::ByteRope chunks;
+    for (int i = 0; i < 5000; ++i) { // small chunks, like the ninjam messages payloads, more than one coalescing buffer
+        QByteArray chunk(100 + i % 4, static_cast<char>('a' + i % 26));
+        chunks.append(chunk);
+        expected.append(chunk);
+    }
+
+    RecorderIOExecutor executor(dir.path());
+    QVERIFY(executor.write(filePath, chunks));
+    executor.waitForPendingWrites();
+
+    QCOMPARE(readFile(filePath), expected);
+    QCOMPARE(executor.getMetrics().writtenBytes, quint64(expected.size()));
+}
+
+void TestRecorderIOExecutor::bigWrites()
+{
+    QTemporaryDir dir;
+    const QString filePath = dir.filePath("big.ogg");
+
+    QByteArray bigChunk(RecorderIOExecutor::COALESCING_BUFFER_SIZE * 2 + 10, 'x');
+    ninjam::ByteRope data(QByteArray("header"));
+    data.append(bigChunk);
+    data.append(QByteArray("tail"));
+
+    RecorderIOExecutor executor(dir.path(), 1024); // a write bigger than the queue is accepted when the queue is empty
+    QVERIFY(executor.write(filePath, data));
+    executor.waitForPendingWrites();
+
+    QCOMPARE(readFile(filePath), data.toByteArray());
+}
+
+void TestRecorderIOExecutor::executorIsSharedInSameDisk()
+{
+    QTemporaryDir dir;
+    QDir(dir.path()).mkpath("a");
+    QDir(dir.path()).mkpath("b");
+
+    auto executorA = RecorderIOExecutor::getExecutor(dir.filePath("a"));
+    auto executorB = RecorderIOExecutor::getExecutor(dir.filePath("b"));
+    QCOMPARE(executorA.get(), executorB.get());
+}
+
+int main(int argc, char *argv[])
+{
+    TestRecorderIOExecutor test;
+    return QTest::qExec(&test, argc, argv);
+}
+
+#include "test_RecorderIOExecutor.moc"
@@ -0,0 +1,218 @@
+#include <QObject>
+#include <QtTest/QtTest>
+#include <QImage>
+#include <vector>
+#include "video/VideoFrameConverter.h"
+
+class TestVideoFrameConverter: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void knownColors();
+    void rgbToYuvSimdMatchesScalar();
+    void yuvToRgbSimdMatchesScalar();
+    void roundTrip();
+    void scaledEncoding();
+    void scaledDecoding();
+
+private:
+    struct Picture
+    {
+        Picture(int width, int height) :
+            width(width),
+            height(height)
+        {
+            strides[0] = width + 5; // padding like the ffmpeg aligned pictures
+            strides[1] = strides[2] = (width + 1) / 2 + 3;
+            const int chromaHeight = (height + 1) / 2;
+            buffers[0].assign(strides[0] * height, 0);
+            buffers[1].assign(strides[1] * chromaHeight, 0);
+            buffers[2].assign(strides[2] * chromaHeight, 0);
+            for (int p = 0; p < 3; ++p)
+                planes[p] = buffers[p].data();
+        }
+
+        bool operator==(const Picture &other) const
+        {
+            return buffers[0] == other.buffers[0] && buffers[1] == other.buffers[1] && buffers[2] == other.buffers[2];
+        }
+
+        int width;
+        int height;
+        int strides[3];
+        uint8_t *planes[3];
+        std::vector<uint8_t> buffers[3];
+    };
+
+    static QImage createRandomImage(int width, int height);
+};
+
+QImage TestVideoFrameConverter::createRandomImage(int width, int height)
+{
+    QImage image(width, height, QImage::Format_RGB32);
+    quint32 seed = 12345;
+    for (int y = 0; y < height; ++y) {
+        quint32 *pixels = reinterpret_cast<quint32 *>(image.scanLine(y));
+        for (int x = 0; x < width; ++x) {
+            seed = seed * 1664525u + 1013904223u;
+            pixels[x] = 0xFF000000u | (seed >> 8);
+        }
+    }
+
+    return image;
+}
+
+void TestVideoFrameConverter::knownColors()
+{
+    QImage image(4, 2, QImage::Format_RGB32);
+    quint32 *first = reinterpret_cast<quint32 *>(image.scanLine(0));
+    quint32 *second = reinterpret_cast<quint32 *>(image.scanLine(1));
+    first[0] = first[1] = second[0] = second[1] = 0xFFFFFFFF; // white
+    first[2] = first[3] = second[2] = second[3] = 0xFF000000; // black
+
+    VideoFrameConverter converter;
+    Picture picture(4, 2);
+    converter.rgbToYuv420(image, picture.planes, picture.strides, 4, 2);
+
+    QCOMPARE(picture.planes[0][0], static_cast<uint8_t>(235));
+    QCOMPARE(picture.planes[0][3], static_cast<uint8_t>(16));
+    QCOMPARE(picture.planes[1][0], static_cast<uint8_t>(128));
+    QCOMPARE(picture.planes[2][0], static_cast<uint8_t>(128));
+    QCOMPARE(picture.planes[1][1], static_cast<uint8_t>(128));
+    QCOMPARE(picture.planes[2][1], static_cast<uint8_t>(128));
+
+    QImage decoded(4, 2, QImage::Format_RGB32);
+    converter.yuv420ToRgb(picture.planes, picture.strides, 4, 2, decoded);
+    QCOMPARE(reinterpret_cast<const quint32 *>(decoded.constScanLine(1))[0], 0xFFFFFFFF);
+    QCOMPARE(reinterpret_cast<const quint32 *>(decoded.constScanLine(1))[3], 0xFF000000);
+}
+
+void TestVideoFrameConverter::rgbToYuvSimdMatchesScalar()
+{
+    if (!VideoFrameConverter::simdIsSupported())
+        QSKIP("SIMD is not supported");
+
+    const QSize sizes[] = { QSize(320, 240), QSize(33, 17), QSize(16, 2), QSize(7, 3) };
+    for (const QSize &size : sizes) {
+        const QImage image = createRandomImage(size.width(), size.height());
+
+        Picture simdPicture(size.width(), size.height());
+        Picture scalarPicture(size.width(), size.height());
+        VideoFrameConverter(true).rgbToYuv420(image, simdPicture.planes, simdPicture.strides, size.width(), size.height());
+        VideoFrameConverter(false).rgbToYuv420(image, scalarPicture.planes, scalarPicture.strides, size.width(), size.height());
+
+        QVERIFY2(simdPicture == scalarPicture, qPrintable(QString("%1x%2").arg(size.width()).arg(size.height())));
+    }
+}
+
+void TestVideoFrameConverter::yuvToRgbSimdMatchesScalar()
+{
+    if (!VideoFrameConverter::simdIsSupported())
+        QSKIP("SIMD is not supported");
+
+    const QSize sizes[] = { QSize(320, 240), QSize(33, 17), QSize(16, 2), QSize(7, 3) };
+    for (const QSize &size : sizes) {
+        Picture picture(size.width(), size.height());
+        quint32 seed = 42;
+        for (int p = 0; p < 3; ++p) {
+            for (auto &value : picture.buffers[p]) {
+                seed = seed * 1664525u + 1013904223u;
+                value = static_cast<uint8_t>(seed >> 24); // out of the limited range values are clamped
+            }
+        }
+
+        QImage simdImage(size, QImage::Format_RGB32);
+        QImage scalarImage(size, QImage::Format_RGB32);
+        VideoFrameConverter(true).yuv420ToRgb(picture.planes, picture.strides, size.width(), size.height(), simdImage);
+        VideoFrameConverter(false).yuv420ToRgb(picture.planes, picture.strides, size.width(), size.height(), scalarImage);
+
+        QVERIFY2(simdImage == scalarImage, qPrintable(QString("%1x%2").arg(size.width()).arg(size.height())));
+    }
+}
+
+void TestVideoFrameConverter::roundTrip()
+{
+    // the colors are constant in each 2x2 block, so the chroma subsampling is not losing information
+    const int width = 64;
+    const int height = 32;
+    QImage image(width, height, QImage::Format_RGB32);
+    const QImage blocks = createRandomImage(width / 2, height / 2);
+    for (int y = 0; y < height; ++y) {
+        quint32 *pixels = reinterpret_cast<quint32 *>(image.scanLine(y));
+        for (int x = 0; x < width; ++x)
+            pixels[x] = reinterpret_cast<const quint32 *>(blocks.constScanLine(y / 2))[x / 2];
+    }
+
+    VideoFrameConverter converter;
+    Picture picture(width, height);
+    converter.rgbToYuv420(image, picture.planes, picture.strides, width, height);
+
+    QImage decoded(width, height, QImage::Format_RGB32);
+    converter.yuv420ToRgb(picture.planes, picture.strides, width, height, decoded);
+
+    int maxError = 0;
+    for (int y = 0; y < height; ++y) {
+        const quint32 *original = reinterpret_cast<const quint32 *>(image.constScanLine(y));
+        const quint32 *converted = reinterpret_cast<const quint32 *>(decoded.constScanLine(y));
+        for (int x = 0; x < width; ++x) {
+            for (int shift = 0; shift <= 16; shift += 8) {
+                const int error = qAbs(static_cast<int>((original[x] >> shift) & 0xFF) - static_cast<int>((converted[x] >> shift) & 0xFF));
+                maxError = qMax(maxError, error);
+            }
+        }
+    }
+
+    QVERIFY2(maxError <= 4, qPrintable(QString("max error %1").arg(maxError)));
+}
+
+void TestVideoFrameConverter::scaledEncoding()
+{
+    // downscaling 2x a image where each 2x2 block has the same color is the same as converting the small image
+    const QImage small = createRandomImage(40, 30);
+    QImage big(80, 60, QImage::Format_RGB32);
+    for (int y = 0; y < big.height(); ++y) {
+        quint32 *pixels = reinterpret_cast<quint32 *>(big.scanLine(y));
+        for (int x = 0; x < big.width(); ++x)
+            pixels[x] = reinterpret_cast<const quint32 *>(small.constScanLine(y / 2))[x / 2];
+    }
+
+    VideoFrameConverter converter;
+    Picture fromSmall(40, 30);
+    Picture fromBig(40, 30);
+    converter.rgbToYuv420(small, fromSmall.planes, fromSmall.strides, 40, 30);
+    converter.rgbToYuv420(big, fromBig.planes, fromBig.strides, 40, 30);
+
+    QVERIFY(fromSmall == fromBig);
+}
+
+void TestVideoFrameConverter::scaledDecoding()
+{
+    const QImage image = createRandomImage(40, 30);
+
+    VideoFrameConverter converter;
+    Picture picture(40, 30);
+    converter.rgbToYuv420(image, picture.planes, picture.strides, 40, 30);
+
+    QImage decoded(40, 30, QImage::Format_RGB32);
+    converter.yuv420ToRgb(picture.planes, picture.strides, 40, 30, decoded);
+
+    QImage upscaled(80, 60, QImage::Format_RGB32);
+    converter.yuv420ToRgb(picture.planes, picture.strides, 40, 30, upscaled);
+
+    // upscaling 2x is repeating each pixel in a 2x2 block
+    for (int y = 0; y < upscaled.height(); ++y) {
+        const quint32 *upscaledPixels = reinterpret_cast<const quint32 *>(upscaled.constScanLine(y));
+        const quint32 *decodedPixels = reinterpret_cast<const quint32 *>(decoded.constScanLine(y / 2));
+        for (int x = 0; x < upscaled.width(); x += 2) // the chroma of each pair is from the first pixel
+            QCOMPARE(upscaledPixels[x], decodedPixels[x / 2]);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    TestVideoFrameConverter test;
+    return QTest::qExec(&test, argc, argv);
+}
+
+#include "test_VideoFrameConverter.moc"
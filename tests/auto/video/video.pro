@@ -0,0 +1,13 @@
+QT += testlib gui
+CONFIG += testcase
+TEMPLATE = app
+TARGET = video
+
+INCLUDEPATH += .
+INCLUDEPATH += ../../../src/Common
+VPATH += ../../../src/Common
+
+HEADERS += video/VideoFrameConverter.h
+SOURCES += video/VideoFrameConverter.cpp
+
+SOURCES += test_VideoFrameConverter.cpp
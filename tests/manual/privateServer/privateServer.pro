@@ -14,12 +14,15 @@ VPATH += $$ROOT_PATH/src/Common
 
 HEADERS += gui/PrivateServerWindow.h
 HEADERS += ninjam/server/Server.h
+HEADERS += ninjam/server/ClientConnection.h
 HEADERS += upnp/UPnPManager.h
 
 SOURCES += gui/PrivateServerWindow.cpp
 
 SOURCES += ninjam/server/Server.cpp
+SOURCES += ninjam/server/ClientConnection.cpp
 SOURCES += ninjam/Ninjam.cpp
+SOURCES += ninjam/MessageFramer.cpp
 SOURCES += ninjam/client/ClientMessages.cpp
 SOURCES += ninjam/client/ServerMessages.cpp
 SOURCES += ninjam/client/User.cpp
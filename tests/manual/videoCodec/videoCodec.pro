@@ -17,9 +17,13 @@ TEMPLATE = app
 SOURCES += main.cpp
 SOURCES += video/FFMpegDemuxer.cpp
 SOURCES += video/FFMpegMuxer.cpp
+SOURCES += video/VideoFrameConverter.cpp
+SOURCES += video/VideoFramesPool.cpp
 SOURCES += MainWindow.cpp
 
 HEADERS += video/FFMpegMuxer.h
 HEADERS += video/FFMpegCommon.h
 HEADERS += video/FFMpegDemuxer.h
+HEADERS += video/VideoFrameConverter.h
+HEADERS += video/VideoFramesPool.h
 HEADERS += MainWindow.h
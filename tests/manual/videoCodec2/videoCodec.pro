@@ -18,6 +18,10 @@ SOURCES += tst_VideoCodec.cpp
 
 SOURCES += video/FFMpegDemuxer.cpp
 SOURCES += video/FFMpegMuxer.cpp
+SOURCES += video/VideoFrameConverter.cpp
+SOURCES += video/VideoFramesPool.cpp
 
 HEADERS += video/FFMpegMuxer.h
 HEADERS += video/FFMpegDemuxer.h
+HEADERS += video/VideoFrameConverter.h
+HEADERS += video/VideoFramesPool.h
@@ -27,6 +27,7 @@ SOURCES += ninjam/ClientMessages.cpp
 SOURCES += ninjam/ServerMessagesHandler.cpp
 
 SOURCES += audio/core/SamplesBuffer.cpp
+SOURCES += audio/core/SamplesKernels.cpp
 SOURCES += audio/core/AudioPeak.cpp
 SOURCES += audio/vorbis/VorbisEncoder.cpp
 